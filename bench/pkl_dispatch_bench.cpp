@@ -0,0 +1,125 @@
+/**
+ * @brief PickleVM dispatch microbenchmark
+ *
+ * Compares the opcode listing (parse) with load() under each dispatch strategy on
+ *  - a pickle shaped like test/parse_pkl.txt (ResNet encoder, ~4.4k opcodes)
+ *  - a synthetic module tree of ~100MB, plain and split into 64KB FRAMEs
+ *
+ * usage: tfe_pkl_bench [synthetic_mb]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "pkl_writer.h"
+#include "vm/vm_pkl.h"
+
+namespace {
+
+/**
+ * @brief Conv2d/BatchNorm2d blocks under one wrapper, with the memoized attribute names that
+ *        torch.jit.save emits (first use BINPUT, later uses BINGET).
+ */
+PickleWriter makeModuleTree(size_t target_bytes) {
+  PickleWriter w;
+  w.proto(2);
+  w.beginModule("__torch__", "EncoderWrapper", 0);
+  w.str("training").put(1).boolean(false);
+  w.str("_is_full_backward_hook").put(2).none();
+  w.str("weight").put(3).none();
+  w.str("bias").put(4).none();
+
+  size_t block = 0;
+  while (w.bytes().size() < target_bytes) {
+    std::string conv = "conv" + std::to_string(block);
+    std::string bn   = "bn" + std::to_string(block);
+
+    w.str(conv).beginModule("__torch__.torch.nn.modules.conv", "Conv2d");
+    w.get(1).boolean(false).get(2).none();
+    w.get(3).tensor(std::to_string(block * 5), {64, 64, 3, 3});
+    w.get(4).none();
+    w.str("stride").intTuple({1, 1});
+    w.str("padding").intTuple({1, 1});
+    w.endModule();
+
+    w.str(bn).beginModule("__torch__.torch.nn.modules.batchnorm", "BatchNorm2d");
+    w.get(1).boolean(false).get(2).none();
+    w.get(3).tensor(std::to_string(block * 5 + 1), {64});
+    w.get(4).tensor(std::to_string(block * 5 + 2), {64});
+    w.str("running_mean").tensor(std::to_string(block * 5 + 3), {64});
+    w.str("running_var").tensor(std::to_string(block * 5 + 4), {64});
+    w.str("eps").real(1e-5);
+    w.str("momentum").real(0.1);
+    w.endModule();
+
+    ++block;
+  }
+
+  w.endModule();
+  w.stop();
+  return w;
+}
+
+double bestMillis(int repeats, const std::function<void()>& fn) {
+  std::vector<double> times;
+  for (int i = 0; i < repeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  return *std::min_element(times.begin(), times.end());
+}
+
+void report(const char* name, const std::vector<char>& data, double ms) {
+  double mb = static_cast<double>(data.size()) / (1024.0 * 1024.0);
+  std::printf("  %-22s %10.3f ms %10.1f MB/s\n", name, ms, mb / (ms / 1000.0));
+}
+
+void runSuite(const char* title, const std::vector<char>& data, int repeats) {
+  std::printf("%s (%zu bytes)\n", title, data.size());
+
+  report("parse (listing)", data, bestMillis(repeats, [&] {
+           tfe::vm::PickleVM vm(data);
+           auto opcodes = vm.parse();
+         }));
+
+  using Dispatch = tfe::vm::PickleVM::Dispatch;
+  const std::pair<const char*, Dispatch> modes[] = {
+      {"load switch", Dispatch::SWITCH},
+      {"load table", Dispatch::TABLE},
+      {"load computed goto", Dispatch::COMPUTED_GOTO},
+  };
+  for (const auto& mode : modes) {
+    if (!tfe::vm::PickleVM::supports(mode.second)) {
+      std::printf("  %-22s (not built, configure with -DTFE_PKL_COMPUTED_GOTO=ON)\n", mode.first);
+      continue;
+    }
+    report(mode.first, data, bestMillis(repeats, [&] {
+             tfe::vm::PickleVM vm(data);
+             vm.load(mode.second);
+           }));
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t synthetic_mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+
+  // test/parse_pkl.txt: 4384 opcodes, roughly 11 conv/bn blocks
+  runSuite("encoder-sized pickle", makeModuleTree(40 * 1024).data(), 200);
+
+  PickleWriter synthetic = makeModuleTree(synthetic_mb * 1024 * 1024);
+  runSuite("synthetic pickle", synthetic.data(), 3);
+
+  std::string framed = synthetic.framedBytes();
+  runSuite("synthetic pickle, protocol 4 frames",
+           std::vector<char>(framed.begin(), framed.end()), 3);
+  return 0;
+}
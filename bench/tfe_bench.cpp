@@ -0,0 +1,369 @@
+/**
+ * @brief End-to-end benchmark: load, unpickle, tensor materialization and inference
+ *
+ * Writes a synthetic TorchScript archive (N Conv2d + ReLU blocks, M tensors per block) and times
+ * each stage of bringing it up separately, repeats times each:
+ *  - read         TorchParser::read (mmap + central directory + section lookup)
+ *  - unpickle     PickleVM::load of data.pkl
+ *  - materialize  TensorLoader::collect + load (storage records -> tensor buffers)
+ *  - prepare      Engine construction (lowering, layout / fusion passes, weight packing)
+ *  - inference    Engine::run on a fixed input, after one warm-up run
+ * The archive is read from the page cache after the first repeat, so the numbers are warm-cache
+ * numbers. Results go to stdout (or --out) as one JSON object with per-stage percentiles and the
+ * process peak RSS.
+ *
+ * usage: tfe_bench [--modules N] [--tensors M] [--channels C] [--buffer-elems E] [--size HxW]
+ *                  [--repeats R] [--threads T] [--model file.pt --input NxCxHxW] [--out file]
+ */
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "engine/engine.h"
+#include "model/script_model.h"
+#include "parser/parser_torch.h"
+#include "pkl_writer.h"
+#include "tensor/tensor_loader.h"
+#include "vm/vm_pkl.h"
+#include "zip_writer.h"
+
+namespace {
+
+struct Config {
+  int64_t modules      = 8;    // Conv2d + ReLU blocks
+  int64_t tensors      = 2;    // tensors per block: weight, bias, then unused buffers
+  int64_t channels     = 64;
+  int64_t buffer_elems = 4096;  // floats per extra buffer
+  int64_t height       = 56;
+  int64_t width        = 56;
+  int repeats          = 20;
+  size_t threads       = 0;  // TensorLoader workers, 0 = hardware_concurrency
+  std::string model;         // benchmark this archive instead of a synthetic one
+  std::vector<int64_t> input;
+  std::string out;
+};
+
+/**
+ * @brief Root module without code/ source: lowering chains its children in order, and the
+ *        Conv2d leaves are lowered from their pickled stride / padding attributes.
+ */
+void writeSyntheticModel(const Config& config, const std::string& path) {
+  const int64_t c = config.channels;
+  PickleWriter data;
+  data.proto();
+  data.beginModule("__torch__", "Net");
+  data.str("training").boolean(false);
+
+  std::vector<std::vector<float>> storages;
+  auto addTensor = [&](const std::vector<int64_t>& sizes) {
+    int64_t numel = 1;
+    for (int64_t s : sizes) {
+      numel *= s;
+    }
+    std::vector<float> values(numel);
+    for (int64_t i = 0; i < numel; ++i) {
+      values[i] = std::sin(static_cast<float>(i + storages.size())) * 0.05f;
+    }
+    data.tensor(std::to_string(storages.size()), sizes, "FloatStorage", 0, true);
+    storages.push_back(std::move(values));
+  };
+
+  for (int64_t block = 0; block < config.modules; ++block) {
+    data.str("conv" + std::to_string(block));
+    data.beginModule("__torch__.torch.nn.modules.conv", "Conv2d");
+    data.str("training").boolean(false);
+    data.str("weight");
+    addTensor({c, c, 3, 3});
+    data.str("bias");
+    addTensor({c});
+    for (int64_t t = 2; t < config.tensors; ++t) {
+      data.str("buffer" + std::to_string(t));
+      addTensor({config.buffer_elems});
+    }
+    data.str("stride").intTuple({1, 1});
+    data.str("padding").intTuple({1, 1});
+    data.endModule();
+
+    data.str("relu" + std::to_string(block));
+    data.beginModule("__torch__.torch.nn.modules.activation", "ReLU");
+    data.str("training").boolean(false);
+    data.endModule();
+  }
+  data.endModule();
+  data.stop();
+
+  ZipWriter writer;
+  writer.add("net/version", "6\n");
+  writer.add("net/byteorder", "little");
+  writer.add("net/data.pkl", data.bytes());
+  for (size_t i = 0; i < storages.size(); ++i) {
+    writer.add("net/data/" + std::to_string(i),
+               std::string(reinterpret_cast<const char*>(storages[i].data()),
+                           storages[i].size() * sizeof(float)));
+  }
+  writer.save(path);
+}
+
+struct Stage {
+  std::string name;
+  std::vector<double> millis;
+};
+
+/**
+ * @brief Nearest-rank percentile of sorted samples
+ */
+double percentile(const std::vector<double>& sorted, double p) {
+  const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+  return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/**
+ * @brief Times fn() repeats times. setup() runs before each sample and is not timed.
+ */
+Stage measure(const std::string& name, int repeats, const std::function<void()>& fn,
+              const std::function<void()>& setup = nullptr) {
+  Stage stage{name, {}};
+  for (int i = 0; i < repeats; ++i) {
+    if (setup) {
+      setup();
+    }
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    stage.millis.push_back(millisSince(start));
+  }
+  return stage;
+}
+
+int64_t peakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+std::string shapeJson(const std::vector<int64_t>& shape) {
+  std::string out = "[";
+  for (size_t i = 0; i < shape.size(); ++i) {
+    out += (i ? ", " : "") + std::to_string(shape[i]);
+  }
+  return out + "]";
+}
+
+std::string escapeJson(const std::string& s) {
+  std::string out;
+  for (char ch : s) {
+    if (ch == '"' || ch == '\\') {
+      out += '\\';
+    }
+    out += ch;
+  }
+  return out;
+}
+
+std::string toJson(const Config& config, const std::string& model, uintmax_t archive_bytes,
+                   const std::vector<Stage>& stages) {
+  char line[512];
+  std::string out = "{\n  \"config\": {\n";
+  out += "    \"model\": \"" + escapeJson(config.model.empty() ? "synthetic" : model) + "\",\n";
+  if (config.model.empty()) {
+    std::snprintf(line, sizeof(line),
+                  "    \"modules\": %lld,\n    \"tensors_per_module\": %lld,\n"
+                  "    \"channels\": %lld,\n    \"buffer_elems\": %lld,\n",
+                  static_cast<long long>(config.modules), static_cast<long long>(config.tensors),
+                  static_cast<long long>(config.channels),
+                  static_cast<long long>(config.buffer_elems));
+    out += line;
+  }
+  out += "    \"input\": " + shapeJson(config.input) + ",\n";
+  std::snprintf(line, sizeof(line),
+                "    \"repeats\": %d,\n    \"threads\": %zu,\n    \"archive_bytes\": %ju\n  },\n",
+                config.repeats, config.threads, archive_bytes);
+  out += line;
+
+  out += "  \"stages\": {\n";
+  for (size_t i = 0; i < stages.size(); ++i) {
+    std::vector<double> sorted = stages[i].millis;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double ms : sorted) {
+      sum += ms;
+    }
+    std::snprintf(line, sizeof(line),
+                  "    \"%s\": {\"samples\": %zu, \"min_ms\": %.4f, \"mean_ms\": %.4f, "
+                  "\"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f}%s\n",
+                  stages[i].name.c_str(), sorted.size(), sorted.front(), sum / sorted.size(),
+                  percentile(sorted, 50), percentile(sorted, 90), percentile(sorted, 99),
+                  sorted.back(), i + 1 < stages.size() ? "," : "");
+    out += line;
+  }
+  std::snprintf(line, sizeof(line), "  },\n  \"peak_rss_kb\": %lld\n}\n",
+                static_cast<long long>(peakRssKb()));
+  return out + line;
+}
+
+std::vector<int64_t> parseShape(const std::string& text) {
+  std::vector<int64_t> shape;
+  size_t pos = 0;
+  while (pos <= text.size()) {
+    size_t x = text.find('x', pos);
+    shape.push_back(std::strtoll(text.substr(pos, x - pos).c_str(), nullptr, 10));
+    if (x == std::string::npos) {
+      break;
+    }
+    pos = x + 1;
+  }
+  return shape;
+}
+
+bool parseArgs(int argc, char** argv, Config* config) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const std::string value = argv[++i];
+    if (arg == "--modules") {
+      config->modules = std::strtoll(value.c_str(), nullptr, 10);
+    } else if (arg == "--tensors") {
+      config->tensors = std::max<int64_t>(2, std::strtoll(value.c_str(), nullptr, 10));
+    } else if (arg == "--channels") {
+      config->channels = std::strtoll(value.c_str(), nullptr, 10);
+    } else if (arg == "--buffer-elems") {
+      config->buffer_elems = std::strtoll(value.c_str(), nullptr, 10);
+    } else if (arg == "--size") {
+      std::vector<int64_t> hw = parseShape(value);
+      if (hw.size() != 2) {
+        return false;
+      }
+      config->height = hw[0];
+      config->width  = hw[1];
+    } else if (arg == "--repeats") {
+      config->repeats = std::max(1, std::atoi(value.c_str()));
+    } else if (arg == "--threads") {
+      config->threads = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (arg == "--model") {
+      config->model = value;
+    } else if (arg == "--input") {
+      config->input = parseShape(value);
+    } else if (arg == "--out") {
+      config->out = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Config config;
+  if (!parseArgs(argc, argv, &config)) {
+    std::fprintf(stderr,
+                 "usage: %s [--modules N] [--tensors M] [--channels C] [--buffer-elems E] "
+                 "[--size HxW] [--repeats R] [--threads T] [--model file.pt --input NxCxHxW] "
+                 "[--out file]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  std::string path = config.model;
+  if (path.empty()) {
+    path = (std::filesystem::temp_directory_path() /
+            ("tfe_bench_" + std::to_string(getpid()) + ".pt"))
+               .string();
+    writeSyntheticModel(config, path);
+    config.input = {1, config.channels, config.height, config.width};
+  }
+
+  std::vector<Stage> stages;
+  try {
+    stages.push_back(measure("read", config.repeats, [&] {
+      tfe::parser::TorchParser parser;
+      parser.read(path);
+    }));
+
+    tfe::parser::TorchParser parser;
+    parser.read(path);
+    stages.push_back(measure("unpickle", config.repeats, [&] {
+      tfe::vm::PickleVM vm(parser.getDataView());
+      vm.load();
+    }));
+
+    tfe::vm::PickleVM vm(parser.getDataView());
+    const tfe::vm::Value root = vm.load();
+    std::unique_ptr<tfe::tensor::TensorLoader> loader;
+    stages.push_back(measure(
+        "materialize", config.repeats,
+        [&] {
+          loader->collect(root);
+          loader->load();
+        },
+        [&] {
+          loader.reset();
+          loader = std::make_unique<tfe::tensor::TensorLoader>(parser, config.threads);
+        }));
+    loader.reset();
+
+    if (!config.input.empty()) {
+      tfe::model::ScriptModel model(path, config.threads);
+      std::unique_ptr<tfe::engine::Engine> engine;
+      stages.push_back(measure(
+          "prepare", config.repeats,
+          [&] {
+            engine = std::make_unique<tfe::engine::Engine>(
+                model, std::vector<std::vector<int64_t>>{config.input});
+          },
+          [&] { engine.reset(); }));
+
+      tfe::tensor::Tensor input = tfe::tensor::empty(config.input);
+      for (int64_t i = 0; i < input.numel(); ++i) {
+        input.data<float>()[i] = static_cast<float>(i % 17) * 0.1f - 0.8f;
+      }
+      engine->run({input});
+      stages.push_back(measure("inference", config.repeats, [&] { engine->run({input}); }));
+    }
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "tfe_bench: %s\n", e.what());
+    if (config.model.empty()) {
+      std::filesystem::remove(path);
+    }
+    return 1;
+  }
+
+  const uintmax_t archive_bytes = std::filesystem::file_size(path);
+  if (config.model.empty()) {
+    std::filesystem::remove(path);
+  }
+  const std::string json = toJson(config, path, archive_bytes, stages);
+  if (config.out.empty()) {
+    std::fputs(json.c_str(), stdout);
+  } else if (FILE* file = std::fopen(config.out.c_str(), "w")) {
+    std::fputs(json.c_str(), file);
+    std::fclose(file);
+  } else {
+    std::fprintf(stderr, "tfe_bench: cannot write %s\n", config.out.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+#ifndef TFE_ENGINE_BATCHER_H_
+#define TFE_ENGINE_BATCHER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/engine.h"
+#include "engine/graph.h"
+#include "model/script_model.h"
+#include "tensor/tensor.h"
+
+namespace tfe {
+namespace engine {
+
+struct BatcherOptions {
+  /**
+   * @brief 한 번에 돌리는 최대 요청 수. 1, 2, 4, ... 와 max_batch 크기의 Engine 을 미리 만든다
+   */
+  size_t max_batch = 8;
+  /**
+   * @brief 가장 먼저 온 요청이 배치가 차기를 기다리는 최대 시간
+   */
+  std::chrono::microseconds max_delay{2000};
+  EngineOptions engine;
+};
+
+/**
+ * @brief 배치 크기가 늘어난 input_shapes 로 그래프를 만든다 (e.g. lower(model, shapes))
+ */
+using GraphFactory = std::function<Graph(const std::vector<std::vector<int64_t>>& input_shapes)>;
+
+struct BatcherStats {
+  uint64_t requests = 0;
+  uint64_t batches  = 0;
+  uint64_t padded   = 0;  // bucket 을 채우려고 0 으로 돌린 자리 수
+};
+
+/**
+ * @brief 동시에 들어오는 batch 1 요청을 모아 Engine 한 번으로 돌린다 (dynamic batching)
+ *
+ * 요청은 큐에 쌓이고 worker 스레드 하나가 가장 오래된 요청부터 max_batch 개까지 꺼낸다. 큐가 max_batch
+ * 만큼 차거나 가장 오래된 요청이 max_delay 를 기다렸으면 바로 돈다. n 개를 꺼내면 n 이상인 가장 작은
+ * bucket Engine 에 넣고 남는 자리는 0 으로 채운다. 입력과 출력은 모두 0 번 차원이 batch 여야 한다.
+ * bucket 마다 Engine 이 weight 를 따로 묶으므로 메모리는 bucket 수만큼 든다.
+ */
+class Batcher {
+ public:
+  /**
+   * @param sample_shapes 입력마다 batch 1 shape (0 번 차원이 1)
+   */
+  Batcher(GraphFactory factory, std::vector<std::vector<int64_t>> sample_shapes,
+          BatcherOptions options = BatcherOptions());
+  /**
+   * @brief model 은 Batcher 보다 오래 살아 있어야 한다
+   */
+  Batcher(const model::ScriptModel& model, std::vector<std::vector<int64_t>> sample_shapes,
+          BatcherOptions options = BatcherOptions());
+  /**
+   * @brief 큐에 남은 요청까지 돌린 뒤 worker 를 멈춘다
+   */
+  ~Batcher();
+
+  Batcher(const Batcher&)            = delete;
+  Batcher& operator=(const Batcher&) = delete;
+
+  /**
+   * @brief inputs 는 sample_shapes 와 같은 float32 텐서들. 맞지 않으면 바로 std::invalid_argument
+   * @return 출력마다 batch 1 텐서 (Engine arena 와 상관없는 복사본)
+   */
+  std::future<std::vector<tensor::Tensor>> submit(std::vector<tensor::Tensor> inputs);
+
+  const std::vector<std::vector<int64_t>>& sampleShapes() const { return sample_shapes_; }
+  /**
+   * @brief batch 1 출력 shape 들
+   */
+  const std::vector<std::vector<int64_t>>& outputShapes() const { return output_shapes_; }
+  const BatcherOptions& options() const { return options_; }
+  BatcherStats stats() const;
+
+ private:
+  struct Request {
+    std::vector<tensor::Tensor> inputs;
+    std::promise<std::vector<tensor::Tensor>> promise;
+    std::chrono::steady_clock::time_point arrival;
+  };
+  struct Bucket {
+    size_t size;
+    std::unique_ptr<Engine> engine;
+    std::vector<tensor::Tensor> inputs;
+  };
+
+  void loop();
+  void runBatch(std::vector<Request>& batch);
+
+  BatcherOptions options_;
+  std::vector<std::vector<int64_t>> sample_shapes_;
+  std::vector<std::vector<int64_t>> output_shapes_;
+  std::vector<Bucket> buckets_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<Request> queue_;
+  bool stop_ = false;
+  BatcherStats stats_;
+  std::thread worker_;
+};
+
+/**
+ * @brief fd 에서 요청 frame 을 읽어 batcher 에 넣고, 응답 frame 을 요청 순서대로 out_fd 에 쓴다.
+ *        in_fd 가 EOF 가 되면 남은 응답을 모두 쓰고 돌아온다
+ *
+ * 요청: [uint32 bytes][입력들을 순서대로 이어 붙인 float32]
+ * 응답: [uint32 status][uint32 bytes][payload]. status 0 이면 출력들을 이어 붙인 float32, 1 이면 오류
+ * 메시지. 모두 little endian. 응답을 기다리는 동안에도 다음 요청을 읽으므로 한 연결이 요청을 몰아서
+ * 보내면 (pipelining) 한 배치로 묶인다. 읽고도 답하지 못한 요청이 max_inflight 개면 읽기를 멈춘다.
+ */
+void serveStream(Batcher& batcher, int in_fd, int out_fd, size_t max_inflight = 64);
+
+/**
+ * @brief Unix domain socket 에서 연결마다 스레드 하나로 serveStream() 을 돈다. 연결들의 요청이 같은
+ *        batcher 로 모인다. 이미 있는 socket 파일은 지우고 만든다. accept 가 실패할 때까지 돌아오지 않고,
+ *        실패하면 listener 를 닫고 남은 연결을 끊어 연결 스레드를 모두 join 한 뒤 던진다
+ */
+void serveUnixSocket(Batcher& batcher, const std::string& path);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_BATCHER_H_
@@ -0,0 +1,127 @@
+#ifndef TFE_ENGINE_COMPILED_MODEL_H_
+#define TFE_ENGINE_COMPILED_MODEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/conv.h"
+#include "engine/cpu_features.h"
+#include "engine/engine.h"
+#include "engine/graph.h"
+#include "engine/memory_planner.h"
+#include "engine/scheduler.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief compiled model 에 저장한 conv 커널 하나. packed 는 파일 매핑 안을 가리킨다
+ */
+struct CompiledConv {
+  ConvAlgo algo = ConvAlgo::AUTO;
+  std::vector<PackedWeight> packed;
+};
+
+/**
+ * @brief 준비를 마친 Engine 을 담은 flat 파일 (.tfe) 을 mmap 한 것
+ *
+ * 파일은 64 byte 헤더 (magic, 버전, byte order, ISA, 원본 hash), 메타데이터 (pass 를 마친 Graph,
+ * Schedule, MemoryPlan, op 별 conv algo), 64 byte 정렬 blob (상수 텐서, ConvKernel 이 묶은 weight)
+ * 순서다. 여는 일은 mmap, 헤더 / 메타데이터 hash 검사, 메타데이터를 읽어 blob offset 을 매핑 안의
+ * 주소로 바꾸는 것뿐이고 상수와 묶은 weight 는 복사하지 않는다. 매핑은 읽기 전용이라 commit charge 를
+ * 잡지 않는다. 상수에 쓰려면 Storage::mutableData() 로 복사본을 만든다.
+ * 헤더가 맞지 않거나 (버전, byte order, 이 CPU 가 못 돌리는 ISA) 파일이 잘렸으면 ParserException 을
+ * 던진다.
+ */
+class CompiledModel {
+ public:
+  static constexpr uint32_t kVersion = 1;
+
+  explicit CompiledModel(const std::string& file_name);
+  ~CompiledModel();
+
+  CompiledModel(const CompiledModel&)            = delete;
+  CompiledModel& operator=(const CompiledModel&) = delete;
+
+  uint64_t sourceHash() const { return source_hash_; }
+  size_t fileSize() const;
+  /**
+   * @brief 저장한 Engine 의 isa / blocked_layout / fuse / inter_op. pool 과 quantize 는 비어 있다
+   *        (quantize 는 이미 그래프에 들어가 있다)
+   */
+  const EngineOptions& options() const { return options_; }
+  const Graph& graph() const { return graph_; }
+  const Schedule& schedule() const { return schedule_; }
+  const MemoryPlan& memoryPlan() const { return plan_; }
+  /**
+   * @brief ops[index] 의 conv 커널. Engine::convKernel() 이 nullptr 이었던 op 는 nullptr
+   */
+  const CompiledConv* conv(size_t index) const {
+    return conv_index_[index] < 0 ? nullptr : &convs_[conv_index_[index]];
+  }
+
+ private:
+  struct Mapping;
+
+  std::shared_ptr<Mapping> mapping_;
+  uint64_t source_hash_ = 0;
+  EngineOptions options_;
+  Graph graph_;
+  Schedule schedule_;
+  MemoryPlan plan_;
+  std::vector<CompiledConv> convs_;
+  std::vector<int32_t> conv_index_;  // op -> convs_ 의 index. conv 가 없으면 -1
+};
+
+/**
+ * @brief 파일 바이트의 64 bit hash (compiled model cache 의 key). 파일을 mmap 해 8 byte 씩 섞는다
+ */
+uint64_t hashFile(const std::string& file_name);
+
+/**
+ * @brief compiled model cache 의 원본 key. hashFile() 과 달리 파일 내용을 읽지 않는다
+ *
+ * ZIP (.pt) 은 central directory 만 읽고 엔트리마다 이름, CRC32, 압축 방식, 크기를 섞는다. 엔트리 내용이
+ * 바뀌면 CRC32 가 바뀐다. ZIP 이 아니면 (.tflite) (device, inode, 크기, mtime) 을 섞으므로 같은 내용이라도
+ * 다시 쓴 파일은 cache 를 새로 만든다.
+ */
+uint64_t sourceKey(const std::string& model_file);
+
+/**
+ * @brief engine 을 .tfe 로 쓴다. 임시 파일에 다 쓴 뒤 rename 하므로 다른 프로세스가 반쯤 쓴 파일을
+ *        열지 않는다
+ *
+ * 아무 커널도 읽지 않는 상수 (묶은 weight 로 대신하는 conv 의 float / int8 weight, int8 weight scale)
+ * 는 저장하지 않는다.
+ */
+void saveCompiledModel(const Engine& engine, const std::string& file_name,
+                       uint64_t source_hash = 0);
+
+/**
+ * @brief cache 파일 경로 <cache_dir>/<key 16 진수>.tfe. key 는 source_hash, 파일 버전, isa, 입력
+ *        shape, 그래프를 바꾸는 옵션 (blocked_layout, fuse, inter_op, calibration) 을 섞는다
+ */
+std::string compiledModelPath(const std::string& cache_dir, uint64_t source_hash,
+                              const std::vector<std::vector<int64_t>>& input_shapes,
+                              const EngineOptions& options);
+
+/**
+ * @brief sourceKey(model_file) 로 찾은 compiled model 이 cache_dir 에 있으면 mmap 해 Engine 을
+ *        만들고, 없거나 읽지 못하면 model_file 을 읽어 lowering 한 뒤 cache 에 저장하고 저장한 파일로
+ *        Engine 을 만든다
+ *
+ * model_file 이 .tflite 로 끝나면 TFLiteParser 로, 아니면 ScriptModel 로 읽는다.
+ * 어느 쪽이든 돌려준 Engine 의 상수는 cache 파일 매핑을 가리키므로 ScriptModel 을 들고 있지 않아도
+ * 된다. cache_dir 이 없으면 만든다.
+ */
+std::unique_ptr<Engine> loadEngine(const std::string& model_file,
+                                   const std::vector<std::vector<int64_t>>& input_shapes,
+                                   const EngineOptions& options, const std::string& cache_dir);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_COMPILED_MODEL_H_
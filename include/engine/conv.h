@@ -0,0 +1,195 @@
+#ifndef TFE_ENGINE_CONV_H_
+#define TFE_ENGINE_CONV_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "engine/cpu_features.h"
+#include "engine/gemm.h"
+#include "engine/gemm_int8.h"
+#include "engine/graph.h"
+#include "tensor/layout.h"
+#include "tensor/tensor.h"
+#include "util/work_stealing_pool.h"
+
+namespace tfe {
+namespace engine {
+
+enum class ConvAlgo : uint8_t {
+  AUTO,
+  REFERENCE,     // kernels::conv2d (scalar, 검증용)
+  IM2COL_GEMM,   // 일반 경우
+  DIRECT_1X1,    // 1x1 / stride 1 / pad 0: 입력이 곧 GEMM 의 B
+  DEPTHWISE,     // groups == in == out channels
+  WINOGRAD_3X3,  // F(2x2, 3x3), stride 1 / dilation 1 / groups 1
+  DIRECT_NCHWC,  // 묶인 layout 출력 (groups 1 또는 depthwise). layout 을 준 ConvKernel 만 쓴다
+  INT8_GEMM,     // u8 im2col x int8 weight 정수 GEMM. int8 weight 를 준 ConvKernel 만 쓴다
+};
+
+const char* convAlgoToString(ConvAlgo algo);
+
+/**
+ * @brief algo 가 NCHW 입출력으로 이 모양의 conv 를 계산할 수 있는가
+ *        (AUTO, REFERENCE, IM2COL_GEMM 은 항상 된다. DIRECT_NCHWC 는 convLayoutApplies 로 본다)
+ */
+bool convAlgoApplies(ConvAlgo algo, const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+                     const OpParams& params);
+
+/**
+ * @brief 모양만 보고 고르는 기본 algo
+ */
+ConvAlgo selectConvAlgo(const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+                        const OpParams& params);
+
+/**
+ * @brief isa 의 벡터 하나에 채널 묶음이 들어가는 layout (AVX-512 는 NCHW16C, 나머지는 NCHW8C)
+ */
+tensor::Layout blockedLayoutFor(Isa isa);
+
+/**
+ * @brief DIRECT_NCHWC 가 in_layout 입력을 받아 out_layout 으로 쓸 수 있는가
+ *
+ * 출력은 묶인 layout 이어야 하고 채널 수가 묶음의 배수여야 한다. 입력은 NCHW (첫 conv 처럼 채널이
+ * 적은 경우) 이거나 출력과 같은 layout 이다. depthwise 는 입력도 묶여 있어야 한다.
+ */
+bool convLayoutApplies(const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+                       const OpParams& params, tensor::Layout in_layout,
+                       tensor::Layout out_layout);
+
+/**
+ * @brief ConvKernel 이 생성 시점에 묶어 둔 weight 덩어리 하나 (ConvKernel::packedWeights)
+ */
+struct PackedWeight {
+  const void* data;
+  size_t bytes;
+};
+
+/**
+ * @brief 모양이 고정된 Conv2d 하나
+ *
+ * weight 는 생성 시점에 algo 에 맞게 한 번 변환 / 묶어 둔다 (GEMM panel, Winograd U = G g G^T,
+ * NCHWc 의 [O/ob][I/ib][KH][KW][ib][ob]). REFERENCE / DEPTHWISE 의 weight 와 bias, 그리고 모든 algo 의
+ * bias 는 빌려 쓰므로 커널보다 오래 살아 있어야 한다. run() 은 workspaceBytes() 크기의 작업 버퍼를 받고
+ * 할당하지 않는다.
+ * in_layout / out_layout 중 하나라도 묶인 layout 이면 algo 는 DIRECT_NCHWC 다.
+ *
+ * params 의 epilogue (activation / upsample / offset, fuseOps 참고) 는 algo 마다 막 계산한 출력
+ * 덩어리 (GEMM 열 블록, 채널 평면, 묶인 출력 행) 가 cache 에 있을 때 건다. target 은 epilogue 가 쓰는
+ * 텐서의 논리 shape 로, upsample 이나 cat 으로 conv 출력과 달라질 때만 준다.
+ *
+ * pool 을 주면 run() 은 출력 채널 묶음과 공간 tile (GEMM 열 블록, 출력 행, 평면) 로 나눠 pool 에서
+ * 돈다. 작업 버퍼에는 worker 마다 따로 쓰는 몫이 pool->concurrency() 개 들어간다.
+ *
+ * isa 는 GEMM micro kernel, 묶인 tile 커널, depthwise tap (axpy / axpyStrided) 과 Winograd 변환
+ * (winogradTransforms) 을 고른다. im2col 과 int8 의 양자화 / 열 모으기는 복사에 가까워 scalar 다.
+ */
+class ConvKernel {
+ public:
+  ConvKernel(const std::vector<int64_t>& in, const std::vector<int64_t>& w, const float* weight,
+             const float* bias, const OpParams& params, ConvAlgo algo = ConvAlgo::AUTO,
+             Isa isa = bestIsa(), tensor::Layout in_layout = tensor::Layout::NCHW,
+             tensor::Layout out_layout = tensor::Layout::NCHW,
+             const std::vector<int64_t>& target = {}, util::WorkStealingPool* pool = nullptr);
+  /**
+   * @brief INT8_GEMM conv (groups 1, NCHW 입출력). weight 는 출력 채널 o 마다 weight_scale[o] 로
+   *        대칭 양자화한 int8 이고, 입력은 params.input_scale / input_zero 로 im2col 하면서 u8 로
+   *        바꾼다. int32 누적을 input_scale * weight_scale[o] 로 float 로 되돌린 뒤 bias 와 epilogue
+   *        를 건다. weight 는 생성 시점에 묶어 두므로 빌려 쓰지 않는다 (bias 는 빌려 쓴다)
+   */
+  ConvKernel(const std::vector<int64_t>& in, const std::vector<int64_t>& w, const int8_t* weight,
+             const float* weight_scale, const float* bias, const OpParams& params,
+             Isa isa = bestIsa(), const std::vector<int64_t>& target = {},
+             util::WorkStealingPool* pool = nullptr);
+
+  /**
+   * @brief packedWeights() 로 저장해 둔 덩어리를 복사하지 않고 빌려 다시 만든다 (묶는 일을 건너뛴다).
+   *        algo 와 나머지 인자는 저장한 커널과 같아야 하고, 덩어리 수와 크기가 다르면 던진다.
+   *        packed 는 커널보다 오래 살아 있어야 한다. weight 는 REFERENCE / DEPTHWISE 만 읽는다
+   */
+  ConvKernel(const std::vector<int64_t>& in, const std::vector<int64_t>& w, ConvAlgo algo,
+             const std::vector<PackedWeight>& packed, const float* weight, const float* bias,
+             const OpParams& params, Isa isa, tensor::Layout in_layout, tensor::Layout out_layout,
+             const std::vector<int64_t>& target, util::WorkStealingPool* pool);
+
+  ConvKernel(const ConvKernel&)            = delete;
+  ConvKernel& operator=(const ConvKernel&) = delete;
+
+  ConvAlgo algo() const { return algo_; }
+  Isa isa() const { return isa_; }
+  tensor::Layout inLayout() const { return in_layout_; }
+  tensor::Layout outLayout() const { return out_layout_; }
+  const std::vector<int64_t>& outputShape() const { return out_; }
+  size_t workspaceBytes() const;
+  /**
+   * @brief 생성 시점에 묶은 weight 덩어리들. GEMM 은 group 마다, Winograd 는 좌표 16 개, NCHWc 는 하나,
+   *        INT8_GEMM 은 묶은 weight 와 출력 채널별 scale 이다. REFERENCE / DEPTHWISE 는 없다
+   */
+  std::vector<PackedWeight> packedWeights() const;
+
+  /**
+   * @brief residual 은 conv 출력과 같은 shape / layout 으로, activation 전에 더한다 (없으면 nullptr)
+   */
+  void run(const float* input, float* output, float* workspace,
+           const float* residual = nullptr) const;
+
+ private:
+  // 각 algo 는 conv + bias 를 dst 에 쓰고 덩어리마다 finish() 로 epilogue 를 건다.
+  // staging 이 없으면 dst 가 곧 output 이다
+  void runGemm(const float* input, float* dst, float* workspace, const float* residual,
+               float* output) const;
+  void runDepthwise(const float* input, float* dst, const float* residual, float* output) const;
+  void runWinograd(const float* input, float* dst, float* workspace, const float* residual,
+                   float* output) const;
+  void runBlocked(const float* input, float* dst, const float* residual, float* output) const;
+  void runInt8(const float* input, float* dst, float* workspace, const float* residual,
+               float* output) const;
+
+  /**
+   * @brief 출력 shape 와 epilogue target 을 정하고 검사한다 (두 생성자가 같이 쓴다)
+   */
+  void shapeOutput(const std::vector<int64_t>& target);
+  /**
+   * @brief algo 가 묶는 weight 덩어리들의 byte 수 (packedWeights() 순서)
+   */
+  std::vector<size_t> packedBytes() const;
+  /**
+   * @brief worker 수와 worker 하나의 작업 버퍼 크기를 정한다
+   */
+  void planScratch();
+
+  /**
+   * @brief 배치 n, 출력 채널 (묶인 layout 은 채널 묶음) c 의 픽셀 [p0, p1) 에 epilogue 를 건다.
+   *        src 는 그 구간의 conv 결과이고 staging 이 없으면 제자리에서 고친다
+   */
+  void finish(float* src, const float* residual, float* output, int64_t n, int64_t c, int64_t p0,
+              int64_t p1) const;
+
+  std::vector<int64_t> in_;
+  std::vector<int64_t> w_;
+  std::vector<int64_t> out_;
+  OpParams params_;
+  ConvAlgo algo_;
+  Isa isa_;
+  tensor::Layout in_layout_;
+  tensor::Layout out_layout_;
+  const float* weight_;
+  const float* bias_;
+  std::vector<int64_t> target_;
+  bool epilogue_   = false;  // activation 이나 staging 이 있다
+  int64_t staging_ = 0;      // conv 결과를 target 에 옮겨 쓰기 전에 두는 작업 버퍼 float 수
+  util::WorkStealingPool* pool_;
+  int64_t workers_ = 1;  // worker 별 작업 버퍼 수
+  int64_t scratch_ = 0;  // worker 하나의 작업 버퍼 float 수 (gemm 묶음, Winograd 행 버퍼)
+  std::vector<PackedMatrix> packed_;       // group 마다 (GEMM), 또는 Winograd 좌표 16 개
+  tensor::AlignedBuffer blocked_;          // DIRECT_NCHWC 의 묶인 weight
+  const float* blocked_weight_ = nullptr;  // blocked_ 이거나 빌린 덩어리
+  QuantizedMatrix quantized_;              // INT8_GEMM 의 묶인 weight
+  std::vector<float> scales_;              // INT8_GEMM 의 출력 채널별 input_scale * weight_scale
+  const float* scale_ = nullptr;           // scales_ 이거나 빌린 덩어리
+};
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_CONV_H_
@@ -0,0 +1,49 @@
+#ifndef TFE_ENGINE_CONV_NCHWC_H_
+#define TFE_ENGINE_CONV_NCHWC_H_
+
+#include <cstdint>
+
+#include "engine/cpu_features.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief 묶인 (NCHWc) conv 에서 같은 출력 행, 같은 출력 채널 묶음의 픽셀 몇 개를 계산하는 인자
+ *
+ * 입력 (n, 채널 묶음 b, y, x, lane i) 는 input + b * plane_stride + y * row_stride + x * ib + i.
+ * weight 는 [in_blocks][KH][KW][ib][ob] (depthwise 는 [KH][KW][ob]), 출력 픽셀 r 은 output + r * ob.
+ * 픽셀 r 의 입력 열은 ix0 + r * stride + kx * dx 이고 [kx0, kx1), [ky0, ky1) 밖의 tap 은 건너뛴다.
+ */
+struct BlockedTile {
+  const float* input;
+  const float* weight;
+  const float* bias;  // ob 개, 없으면 nullptr
+  float* output;
+  int64_t in_blocks;
+  int64_t ib;
+  int64_t plane_stride;
+  int64_t row_stride;
+  int64_t pixel_step;     // stride * ib
+  int64_t weight_stride;  // 입력 채널 묶음 하나의 weight 크기
+  int64_t kw;
+  int64_t iy0, ky0, ky1, dy;
+  int64_t ix0, kx0, kx1, dx;
+};
+
+using BlockedKernel = void (*)(const BlockedTile& tile);
+
+/**
+ * @brief isa 와 출력 묶음 크기 ob 에 맞는 tile 커널 표
+ *
+ * tiles[r] (1 <= r <= *max_pixels) 는 출력 픽셀 r 개를 register 에 쌓아 계산한다. ISA 의 벡터 폭과
+ * 맞지 않는 ob 는 scalar 커널로 떨어진다. pixel_step 이 ob 와 같으면 (stride 1 의 묶인 입력) 픽셀
+ * 간격을 상수로 박아 둔 커널을 돌려준다.
+ */
+void blockedTiles(Isa isa, int64_t ob, bool depthwise, int64_t pixel_step,
+                  const BlockedKernel** tiles, int64_t* max_pixels);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_CONV_NCHWC_H_
@@ -0,0 +1,48 @@
+#ifndef TFE_ENGINE_CONV_WINOGRAD_H_
+#define TFE_ENGINE_CONV_WINOGRAD_H_
+
+#include <cstdint>
+
+#include "engine/cpu_features.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief Winograd F(2x2, 3x3) 의 입력 / 출력 변환을 tile 행 하나씩 거는 커널들
+ *
+ * 입력 쪽은 B^T = [[1, 0, -1, 0], [0, 1, 1, 0], [0, -1, 1, 0], [0, 1, 0, -1]], 출력 쪽은
+ * A^T = [[1, 1, 1, 0], [0, 1, -1, -1]]. 행 방향 변환은 연속된 열끼리의 덧셈이고, tile 방향 변환은
+ * 짝수 / 홀수 열을 나눠 (출력은 다시 엮어) 벡터 폭만큼 tile 을 한 번에 계산한다.
+ */
+struct WinogradTransforms {
+  /**
+   * @brief t[k][x] = (B^T d)[k][x]. d 와 t 는 width 간격의 4 행
+   */
+  void (*input_rows)(const float* d, int64_t width, float* t);
+  /**
+   * @brief 행 e (폭 2 * tiles + 2) 의 tile 마다 (e B)[k] 를 v[k][tx] 에 쓴다
+   */
+  void (*input_tiles)(const float* e, int64_t tiles, float* v0, float* v1, float* v2, float* v3);
+  /**
+   * @brief r0 = s0 + s1 + s2, r1 = s1 - s2 - s3 (n 개)
+   */
+  void (*output_rows)(const float* s0, const float* s1, const float* s2, const float* s3,
+                      int64_t n, float* r0, float* r1);
+  /**
+   * @brief tile n 개의 출력 2 열: out[2 tx] = q0 + q1 + q2 + bias, out[2 tx + 1] = q1 - q2 - q3 + bias
+   */
+  void (*output_tiles)(const float* q0, const float* q1, const float* q2, const float* q3,
+                       int64_t n, float bias, float* out);
+};
+
+/**
+ * @brief isa 에 맞는 변환 커널. AVX-512 는 AVX2 커널을 쓴다 (덧셈뿐인 변환은 폭보다 load / store 가
+ *        비용이다)
+ */
+const WinogradTransforms& winogradTransforms(Isa isa);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_CONV_WINOGRAD_H_
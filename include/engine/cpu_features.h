@@ -0,0 +1,49 @@
+#ifndef TFE_ENGINE_CPU_FEATURES_H_
+#define TFE_ENGINE_CPU_FEATURES_H_
+
+#include <cstdint>
+#include <vector>
+
+#if defined(TFE_SIMD) && TFE_SIMD && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define TFE_HAS_X86_SIMD 1
+#else
+#define TFE_HAS_X86_SIMD 0
+#endif
+
+#if defined(TFE_SIMD) && TFE_SIMD && defined(__ARM_NEON)
+#define TFE_HAS_NEON 1
+#else
+#define TFE_HAS_NEON 0
+#endif
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief 커널 명령어 집합. SCALAR 는 어디서나 되는 참조 경로
+ */
+enum class Isa : uint8_t {
+  SCALAR,
+  AVX2,    // AVX2 + FMA
+  AVX512,  // AVX-512F
+  NEON,
+};
+
+const char* isaToString(Isa isa);
+
+/**
+ * @brief 이 빌드가 넣은 경로 중 이 CPU 가 실행할 수 있는 것 (SCALAR 가 맨 앞)
+ */
+const std::vector<Isa>& supportedIsas();
+
+/**
+ * @brief 실행할 ISA. cpuid 로 가장 넓은 것을 고르고, TFE_ISA=scalar|avx2|avx512|neon 환경 변수로
+ *        (지원되는 범위 안에서) 낮출 수 있다. 처음 한 번만 결정한다
+ */
+Isa bestIsa();
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_CPU_FEATURES_H_
@@ -0,0 +1,151 @@
+#ifndef TFE_ENGINE_ENGINE_H_
+#define TFE_ENGINE_ENGINE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "engine/conv.h"
+#include "engine/graph.h"
+#include "engine/memory_planner.h"
+#include "engine/profiler.h"
+#include "engine/scheduler.h"
+#include "model/script_model.h"
+#include "tensor/tensor.h"
+#include "util/work_stealing_pool.h"
+
+namespace tfe {
+namespace engine {
+
+struct Calibration;
+class CompiledModel;
+
+/**
+ * @brief Engine 생성 옵션
+ */
+struct EngineOptions {
+  Isa isa = bestIsa();
+  /**
+   * @brief conv 사이 활성값을 blockedLayoutFor(isa) 로 둔다 (assignLayouts). 끄면 전부 NCHW
+   */
+  bool blocked_layout = true;
+  /**
+   * @brief batch_norm / activation / residual add / upsample+cat 을 conv 에 접는다 (fuseOps)
+   */
+  bool fuse = true;
+  /**
+   * @brief conv 를 나눠 돌릴 pool. 비워 두면 WorkStealingPool::shared() 를 쓴다. 모델 여러 개가 한
+   *        pool 을 같이 쓰면 코어를 넘치게 쓰지 않는다. 한 스레드로만 돌리려면 크기 1 인 pool 을 준다
+   */
+  std::shared_ptr<util::WorkStealingPool> pool;
+  /**
+   * @brief 서로 기다리지 않는 op 들 (skip 연결, multi-scale head) 을 pool 에서 동시에 돌린다
+   *        (scheduleOps). 끄면 op 열 순서대로 하나씩 돈다
+   */
+  bool inter_op = true;
+  /**
+   * @brief 주면 범위가 있는 conv / linear 를 int8 로 돌린다 (quantization.h 의 Calibrator 로 만든다).
+   *        나머지 op 와 op 사이 활성값은 float 그대로다
+   */
+  std::shared_ptr<const Calibration> quantize;
+};
+
+/**
+ * @brief lowering 된 Graph 를 고정 입력 shape 로 실행한다
+ *
+ * 활성값은 planMemory() 가 정한 offset 으로 arena 하나에 들어가고, arena 와 출력 view 는 생성 시점에
+ * 한 번 만들어 두므로 run() 은 heap 할당을 하지 않는다.
+ * 상수 slot 은 모델 텐서를 그대로 가리킨다 (ScriptModel 이 Engine 보다 오래 살아 있어야 한다).
+ * CONV2D 는 op 마다 ConvKernel 을 만들어 weight 를 미리 묶고, 작업 버퍼는 가장 큰 것 하나를 같이 쓴다.
+ * conv 는 options.pool 에서 출력 채널 / 공간 tile 로 나눠 돈다. op 는 scheduleOps() 의 stage 순서로
+ * 돌고, 동시에 도는 stage 의 op 는 arena 자리와 작업 버퍼를 나눠 쓰지 않는다.
+ * 입력과 출력은 NCHW 로 주고받고, 안쪽 layout 변환은 그래프에 REORDER 로 들어간다.
+ * 그래프는 생성 시점에 [planQuantization() ->] assignLayouts() -> fuseOps() [-> convertQuantizedWeights()]
+ * 순서로 고친 뒤 메모리를 계획한다. int8 LINEAR 는 1x1 conv 로 ConvKernel 이 돈다.
+ * CompiledModel 로 만들면 pass, 계획, weight 묶기를 건너뛰고 저장한 것을 그대로 쓴다
+ * (compiled_model.h).
+ * enableProfiling() 뒤의 run() 은 op 마다 시간을 Profiler 에 남긴다 (profiler.h).
+ */
+class Engine {
+ public:
+  Engine(const model::ScriptModel& model, const std::vector<std::vector<int64_t>>& input_shapes,
+         const EngineOptions& options = EngineOptions());
+  explicit Engine(Graph graph, const EngineOptions& options = EngineOptions());
+  /**
+   * @brief saveCompiledModel() 로 저장한 Engine 을 되살린다. 옵션은 compiled->options() 이고, 상수와
+   *        묶은 weight 는 파일 매핑을 가리킨다. pool 을 비워 두면 WorkStealingPool::shared() 를 쓴다
+   */
+  explicit Engine(std::shared_ptr<const CompiledModel> compiled,
+                  std::shared_ptr<util::WorkStealingPool> pool = nullptr);
+
+  Engine(const Engine&)            = delete;
+  Engine& operator=(const Engine&) = delete;
+
+  const Graph& graph() const { return graph_; }
+  const EngineOptions& options() const { return options_; }
+  const MemoryPlan& memoryPlan() const { return plan_; }
+  const Schedule& schedule() const { return schedule_; }
+  /**
+   * @brief 이 Engine 을 되살린 compiled model. 그래프에서 만들었으면 nullptr
+   */
+  const std::shared_ptr<const CompiledModel>& compiled() const { return compiled_; }
+  /**
+   * @brief ops[index] 의 conv 커널. CONV2D 나 int8 LINEAR 가 아니면 nullptr
+   */
+  const ConvKernel* convKernel(size_t index) const { return convs_[index].get(); }
+
+  /**
+   * @brief inputs 는 lowering 때 준 shape 와 같아야 한다 (float32)
+   * @return forward 의 출력 텐서들. arena 를 가리키므로 다음 run() 전까지만 유효하다
+   */
+  const std::vector<tensor::Tensor>& run(const std::vector<tensor::Tensor>& inputs);
+  /**
+   * @brief run() 과 같되 op 를 schedule 순서대로 하나씩 돌리며, ops[index] 를 돌리기 직전에
+   *        observer(index) 를 부른다. observer 는 value() 로 op 의 입력을 읽는다 (calibration)
+   */
+  const std::vector<tensor::Tensor>& run(const std::vector<tensor::Tensor>& inputs,
+                                         const std::function<void(size_t)>& observer);
+  /**
+   * @brief slot 의 지금 값 (slot 의 layout 그대로). 죽은 slot 은 nullptr
+   */
+  const float* value(int32_t slot) const { return values_[slot]; }
+
+  /**
+   * @brief 이후 run() 의 op 마다 시간을 기록한다. 이미 켜져 있으면 기록을 비우고 새로 만든다.
+   *        꺼져 있을 때 run() 이 내는 비용은 op 마다 포인터 비교 하나다
+   */
+  Profiler& enableProfiling(size_t capacity = Profiler::kDefaultCapacity);
+  void disableProfiling() { profiler_.reset(); }
+  /**
+   * @brief 켜져 있지 않으면 nullptr
+   */
+  const Profiler* profiler() const { return profiler_.get(); }
+
+ private:
+  void prepare();
+  /**
+   * @brief 계획을 마친 그래프로 arena, conv 커널, 작업 버퍼, 출력 view 를 만든다
+   */
+  void instantiate();
+  void load(const std::vector<tensor::Tensor>& inputs);
+  void runOp(size_t index, float* workspace, size_t worker);
+
+  EngineOptions options_;
+  std::shared_ptr<const CompiledModel> compiled_;
+  Graph graph_;
+  Schedule schedule_;
+  MemoryPlan plan_;
+  tensor::Tensor arena_;
+  std::vector<float*> values_;
+  std::vector<tensor::Tensor> outputs_;
+  std::vector<std::unique_ptr<ConvKernel>> convs_;
+  tensor::AlignedBuffer workspace_;
+  std::vector<size_t> workspace_offsets_;  // op -> 작업 버퍼 안의 byte offset
+  std::unique_ptr<Profiler> profiler_;
+};
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_ENGINE_H_
@@ -0,0 +1,27 @@
+#ifndef TFE_ENGINE_FUSION_H_
+#define TFE_ENGINE_FUSION_H_
+
+#include "engine/graph.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief conv 바로 뒤의 연산을 conv 에 접어 넣어 활성값을 한 번 덜 읽고 쓰게 한다
+ *
+ * - BATCH_NORM: 채널별 scale / shift 를 weight 와 bias 에 곱해 둔 새 상수로 바꾼다 (적재 때 한 번).
+ * - ADD: 다른 피연산자를 residual (inputs[3]) 로 붙인다. 두 피연산자가 모두 conv 면 나중에 도는
+ *   쪽에 붙이므로 ResNet 의 downsample 경로도 접힌다. residual 이 conv 보다 뒤에 만들어지면 conv 를
+ *   add 자리로 옮긴다 (conv 출력은 add 만 읽으므로 언제나 된다).
+ * - RELU / ELU / SIGMOID: epilogue 의 activation.
+ * - 정수 배 UPSAMPLE_NEAREST2D, 그리고 채널 CAT 의 앞 / 뒤 입력: conv 가 cat 출력의 제 채널에 바로
+ *   쓰고 CAT 은 나머지 입력만 잇는다 (depth decoder 의 upconv -> upsample -> cat).
+ * 접히는 conv 출력은 그 연산 하나만 읽고 그래프 출력이 아니어야 하며, layout 이 같아야 한다.
+ * assignLayouts() 뒤, planMemory() 전에 부른다.
+ */
+void fuseOps(Graph& graph);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_FUSION_H_
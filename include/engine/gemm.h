@@ -0,0 +1,81 @@
+#ifndef TFE_ENGINE_GEMM_H_
+#define TFE_ENGINE_GEMM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/cpu_features.h"
+#include "tensor/tensor.h"
+
+namespace tfe {
+namespace engine {
+
+constexpr int64_t kGemmKC = 256;  // B 블록 행 수
+constexpr int64_t kGemmNC = 512;  // B 블록 열 수: 묶은 블록 (512 KB) 이 L2 에 머문다
+constexpr int64_t kMaxNR  = 32;   // micro kernel 의 가장 넓은 열 폭 (AVX-512)
+
+/**
+ * @brief gemm() 의 pack 인자에 필요한 float 수 (ISA 와 무관한 상한)
+ */
+constexpr int64_t kGemmPackFloats = kGemmKC * ((kGemmNC + kMaxNR - 1) / kMaxNR * kMaxNR);
+
+/**
+ * @brief GEMM 의 왼쪽 행렬 (conv weight) 을 kMR 행 panel 로 미리 묶어 둔 것
+ *
+ * panel p 는 k 마다 행 p*kMR .. p*kMR+kMR-1 의 값이 붙어 있어 micro kernel 이 한 번에 broadcast 한다.
+ * 마지막 panel 의 모자란 행은 0 으로 채운다.
+ */
+class PackedMatrix {
+ public:
+  static constexpr int64_t kMR = 6;
+
+  PackedMatrix() = default;
+  PackedMatrix(const float* a, int64_t rows, int64_t cols, int64_t lda);
+
+  /**
+   * @brief 이미 묶어 둔 panel 들 (bytes(rows, cols) 크기) 을 복사하지 않고 가리킨다 (compiled model).
+   *        packed 는 이 행렬보다 오래 살아 있어야 한다
+   */
+  static PackedMatrix view(const float* packed, int64_t rows, int64_t cols);
+  /**
+   * @brief rows x cols 를 묶은 panel 들의 byte 수
+   */
+  static size_t bytes(int64_t rows, int64_t cols);
+
+  int64_t rows() const { return rows_; }
+  int64_t cols() const { return cols_; }
+  const float* data() const { return data_; }
+  const float* panel(int64_t p) const { return data_ + p * kMR * cols_; }
+
+ private:
+  tensor::AlignedBuffer buffer_;
+  const float* data_ = nullptr;  // buffer_ 이거나 빌린 panel
+  int64_t rows_ = 0;
+  int64_t cols_ = 0;
+};
+
+/**
+ * @brief C[M x N] = A[M x K] * B[K x N] (+ bias[m]). B, C 는 row-major 이고 ldb/ldc 는 행 간격
+ *
+ * B 를 kGemmKC x kGemmNC 블록으로 나눠 NR 열 panel 로 묶은 뒤 (pack, kGemmPackFloats 이상),
+ * kMR x NR 블록을 ISA 별 micro kernel 로 계산한다.
+ * A 의 panel [panel_begin, panel_end) (행 panel_begin * kMR 부터) 만 계산할 수도 있다. -1 은 끝까지.
+ */
+void gemm(Isa isa, const PackedMatrix& a, const float* b, int64_t ldb, int64_t n, float* c,
+          int64_t ldc, const float* bias, float* pack, int64_t panel_begin = 0,
+          int64_t panel_end = -1);
+
+/**
+ * @brief y[i] += alpha * x[i]
+ */
+void axpy(Isa isa, int64_t n, float alpha, const float* x, float* y);
+
+/**
+ * @brief y[i] += alpha * x[i * stride] (stride 가 있는 depthwise conv 의 tap 하나)
+ */
+void axpyStrided(Isa isa, int64_t n, float alpha, const float* x, int64_t stride, float* y);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_GEMM_H_
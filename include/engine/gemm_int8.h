@@ -0,0 +1,97 @@
+#ifndef TFE_ENGINE_GEMM_INT8_H_
+#define TFE_ENGINE_GEMM_INT8_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/cpu_features.h"
+#include "tensor/tensor.h"
+
+namespace tfe {
+namespace engine {
+
+constexpr int64_t kInt8NR = 32;  // B 열 panel 폭. micro kernel 하나가 이만큼 열을 계산한다
+
+/**
+ * @brief 정수 GEMM 의 B (u8 활성값, K x N) 를 두는 byte 수
+ *
+ * B[k][j] 는 [j / kInt8NR][k / 4][j % kInt8NR][k % 4] 자리에 둔다. 열 하나의 k 4 개가 32 bit 하나라
+ * dot-product 명령 한 번이 4 개를 곱해 더한다. 열은 kInt8NR 배수로, k 는 4 의 배수로 올려 잡으며
+ * 남는 자리는 채우지 않아도 된다 (남는 k 의 weight 는 0, 남는 열의 결과는 버린다).
+ */
+inline int64_t int8ColumnsBytes(int64_t k, int64_t n) {
+  return (n + kInt8NR - 1) / kInt8NR * kInt8NR * ((k + 3) / 4 * 4);
+}
+
+/**
+ * @brief int8ColumnsBytes 배치에서 B[k][j] 의 byte 위치
+ */
+inline int64_t int8ColumnsOffset(int64_t k, int64_t j, int64_t quads) {
+  return ((j / kInt8NR * quads + k / 4) * kInt8NR + j % kInt8NR) * 4 + k % 4;
+}
+
+/**
+ * @brief 정수 GEMM 의 왼쪽 행렬 (int8 weight) 을 kMR 행 panel 로 미리 묶어 둔 것
+ *
+ * panel p 는 k 4 개 묶음마다 행 p*kMR .. p*kMR+kMR-1 의 4 byte 가 붙어 있어 micro kernel 이 행마다
+ * 32 bit 하나를 broadcast 한다. 모자란 행과 k 는 0 으로 채운다. rowSums() 는 zero point 보정에 쓰는
+ * 행별 weight 합으로, panel 들 바로 뒤에 둔다 (묶은 것 전체가 byte 덩어리 하나).
+ */
+class QuantizedMatrix {
+ public:
+  static constexpr int64_t kMR = 8;
+
+  QuantizedMatrix() = default;
+  QuantizedMatrix(const int8_t* a, int64_t rows, int64_t cols, int64_t lda);
+
+  /**
+   * @brief 이미 묶어 둔 덩어리 (bytes(rows, cols) 크기) 를 복사하지 않고 가리킨다 (compiled model).
+   *        packed 는 이 행렬보다 오래 살아 있어야 한다
+   */
+  static QuantizedMatrix view(const void* packed, int64_t rows, int64_t cols);
+  /**
+   * @brief rows x cols 를 묶은 panel 들과 행 합의 byte 수
+   */
+  static size_t bytes(int64_t rows, int64_t cols);
+
+  int64_t rows() const { return rows_; }
+  int64_t cols() const { return cols_; }
+  int64_t quads() const { return (cols_ + 3) / 4; }
+  const void* data() const { return data_; }
+  const int8_t* panel(int64_t p) const { return data_ + p * kMR * quads() * 4; }
+  const int32_t* rowSums() const {
+    return reinterpret_cast<const int32_t*>(data_ + (rows_ + kMR - 1) / kMR * kMR * quads() * 4);
+  }
+
+ private:
+  tensor::AlignedBuffer buffer_;
+  const int8_t* data_ = nullptr;  // buffer_ 이거나 빌린 덩어리
+  int64_t rows_ = 0;
+  int64_t cols_ = 0;
+};
+
+/**
+ * @brief 이 CPU 에서 gemmInt8() 이 쓰는 micro kernel 이름
+ *        ("avx512_vnni", "avx_vnni", "neon_dot", "scalar")
+ *
+ * AVX-512 는 VNNI (vpdpbusd) 가 있을 때, AVX2 는 AVX-VNNI 가 있을 때만 SIMD 로 돌고, NEON 은
+ * dot-product 확장 (SDOT) 으로 빌드했을 때만 돈다. 나머지는 scalar 다.
+ */
+const char* int8KernelName(Isa isa);
+
+/**
+ * @brief C = scale[m] * (A * (B - zero)) + bias[m]. A 는 int8, B 는 u8 (int8ColumnsBytes 배치)
+ *
+ * 누적은 int32 로 하고 (zero point 는 rowSums() 로 한 번에 뺀다), 끝난 블록을 float 로 되돌려
+ * c[m * ldc + j] 에 쓴다. A 의 panel [panel_begin, panel_end) 와 열 [col_begin, col_end)
+ * 만 계산할 수 있다 (-1 은 끝까지). col_begin 은 kInt8NR 의 배수여야 한다.
+ */
+void gemmInt8(Isa isa, const QuantizedMatrix& a, const uint8_t* b, int64_t n, int32_t zero,
+              const float* scale, const float* bias, float* c, int64_t ldc,
+              int64_t panel_begin = 0, int64_t panel_end = -1, int64_t col_begin = 0,
+              int64_t col_end = -1);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_GEMM_INT8_H_
@@ -0,0 +1,131 @@
+#ifndef TFE_ENGINE_GRAPH_H_
+#define TFE_ENGINE_GRAPH_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensor/layout.h"
+#include "tensor/tensor.h"
+
+namespace tfe {
+namespace engine {
+
+enum class OpKind : uint8_t {
+  CONV2D,
+  BATCH_NORM,
+  RELU,
+  ELU,
+  SIGMOID,
+  MAX_POOL2D,
+  ADAPTIVE_AVG_POOL2D,
+  LINEAR,
+  ADD,
+  SUB,
+  MUL,
+  DIV,
+  CAT,
+  UPSAMPLE_NEAREST2D,
+  PAD,
+  RESHAPE,
+  REORDER,  // layout 변환. assignLayouts() 만 넣는다
+};
+
+const char* opKindToString(OpKind kind);
+
+/**
+ * @brief conv epilogue 에 접어 넣을 수 있는 활성 함수
+ */
+enum class Activation : uint8_t { NONE, RELU, ELU, SIGMOID };
+
+const char* activationToString(Activation activation);
+
+/**
+ * @brief 연산 종류별 정적 파라미터. 쓰지 않는 필드는 기본값 그대로 둔다
+ */
+struct OpParams {
+  enum class PadMode : uint8_t { CONSTANT, REFLECT };
+
+  int64_t kernel[2]   = {1, 1};
+  int64_t stride[2]   = {1, 1};
+  int64_t padding[2]  = {0, 0};
+  int64_t dilation[2] = {1, 1};
+  int64_t groups      = 1;
+  bool ceil_mode      = false;
+  int64_t pads[4]     = {0, 0, 0, 0};  // left, right, top, bottom
+  PadMode pad_mode    = PadMode::CONSTANT;
+  int64_t axis        = 1;
+  float alpha         = 1.0f;  // ADD/SUB 의 alpha, ELU 의 alpha
+  float value         = 0.0f;  // PAD 상수
+  bool has_scalar     = false;  // 두 번째 피연산자가 스칼라인 이항 연산
+  float scalar        = 0.0f;
+
+  // fuseOps() 가 붙이는 epilogue. CONV2D 는 y = activation(conv + bias [+ inputs[3]]) 를 upsample 배
+  // nearest 로 키워 출력 slot 의 채널 offset 부터 쓴다 (ELU 의 alpha 는 위의 alpha).
+  // CAT 은 첫 입력을 axis 의 offset 자리부터 잇는다 (앞자리는 conv 가 이미 썼다)
+  Activation activation = Activation::NONE;
+  int64_t upsample      = 1;
+  int64_t offset        = 0;
+
+  // planQuantization() 이 붙이는 int8 경로 (CONV2D / LINEAR). input_scale > 0 이면 입력을
+  // q = clamp(round(x / input_scale) + input_zero, 0, 255) 로 읽는다. convertQuantizedWeights() 뒤에는
+  // weight 가 INT8 상수이고 weight_scale 은 출력 채널별 scale 을 담은 상수 slot 이다
+  float input_scale    = 0.0f;
+  int32_t input_zero   = 0;
+  int32_t weight_scale = -1;
+};
+
+/**
+ * @brief 텐서 자리 하나. constant 는 weight 같은 모델 텐서, 나머지는 Engine 이 미리 잡아 둔다
+ *
+ * sizes 는 layout 과 상관없이 논리 NCHW shape 다. 상수는 항상 NCHW 로 둔다.
+ */
+struct Slot {
+  std::string name;
+  std::vector<int64_t> sizes;
+  tensor::Layout layout = tensor::Layout::NCHW;
+  bool constant         = false;
+  tensor::Tensor tensor;
+
+  /**
+   * @brief 실제 배치의 원소 수 (묶인 layout 의 남는 lane 포함)
+   */
+  int64_t numel() const;
+};
+
+/**
+ * @brief outputs[0] = kind(inputs...). 입력은 모두 이 op 보다 앞에서 만들어진 slot 이다
+ */
+struct Op {
+  OpKind kind;
+  std::vector<int32_t> inputs;
+  int32_t output = -1;
+  OpParams params;
+  std::string name;  // 만든 모듈 경로 (e.g. "encoder.layer1.0.conv1")
+};
+
+/**
+ * @brief 위상 정렬된 flat op 열. lowering 이 실행 순서대로 쌓으므로 ops 순서가 곧 실행 순서다
+ */
+class Graph {
+ public:
+  int32_t addSlot(std::string name, std::vector<int64_t> sizes);
+  int32_t addConstant(std::string name, tensor::Tensor tensor);
+  Op& addOp(OpKind kind, std::vector<int32_t> inputs, int32_t output, std::string name);
+
+  /**
+   * @brief outputs 에 닿지 않는 op 를 지운다
+   */
+  void eliminateDeadOps();
+  std::string dump() const;
+
+  std::vector<Slot> slots;
+  std::vector<Op> ops;
+  std::vector<int32_t> inputs;
+  std::vector<int32_t> outputs;
+};
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_GRAPH_H_
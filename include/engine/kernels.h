@@ -0,0 +1,68 @@
+#ifndef TFE_ENGINE_KERNELS_H_
+#define TFE_ENGINE_KERNELS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "engine/graph.h"
+
+namespace tfe {
+namespace engine {
+namespace kernels {
+
+using Shape = std::vector<int64_t>;
+
+/**
+ * @brief broadcast 이항 연산이 다루는 최대 rank (커널이 스택 배열만 쓰도록)
+ */
+constexpr size_t kMaxRank = 8;
+/**
+ * @brief 묶인 layout (NCHW8C / NCHW16C) 의 최대 lane 수
+ */
+constexpr int64_t kMaxLanes = 16;
+
+/**
+ * @brief 모든 커널은 연속 float32 를 받는 scalar 참조 구현이다
+ *
+ * lanes 를 받는 커널은 채널이 lanes 개씩 묶인 [N][C/lanes][H][W][lanes] 배치도 다룬다 (lanes = 1 이
+ * NCHW). 원소별 연산은 배치와 상관없다. conv2d 는 NCHW 만 받고, 묶인 conv 는 ConvKernel 이 한다.
+ */
+void conv2d(const float* input, const Shape& in, const float* weight, const Shape& w,
+            const float* bias, float* output, const Shape& out, const OpParams& params);
+void batchNorm(const float* input, const Shape& in, const float* scale, const float* shift,
+               float* output, int64_t lanes = 1);
+void relu(const float* input, int64_t n, float* output);
+void elu(const float* input, int64_t n, float alpha, float* output);
+void sigmoid(const float* input, int64_t n, float* output);
+void maxPool2d(const float* input, const Shape& in, float* output, const Shape& out,
+               const OpParams& params, int64_t lanes = 1);
+void adaptiveAvgPool2d(const float* input, const Shape& in, float* output, const Shape& out,
+                       int64_t lanes = 1);
+void linear(const float* input, int64_t rows, int64_t in_features, const float* weight,
+            int64_t out_features, const float* bias, float* output);
+/**
+ * @brief numpy 규칙으로 broadcast 하는 이항 연산. ADD/SUB 의 b 에는 alpha 가 곱해진다
+ */
+void binary(OpKind kind, const float* a, const Shape& as, const float* b, const Shape& bs,
+            float alpha, float* output, const Shape& out);
+void binaryScalar(OpKind kind, const float* a, int64_t n, float scalar, float alpha,
+                  float* output);
+/**
+ * @brief cat 의 입력 하나를 출력의 제 열에 복사한다. outer 는 axis 앞 차원들의 곱
+ */
+void catSlice(const float* input, int64_t outer, int64_t chunk, int64_t out_chunk, float* output);
+void upsampleNearest2d(const float* input, const Shape& in, float* output, const Shape& out,
+                       int64_t lanes = 1);
+void pad(const float* input, const Shape& in, float* output, const Shape& out,
+         const OpParams& params, int64_t lanes = 1);
+
+/**
+ * @brief op 하나를 실행한다. values[slot] 은 slot 의 데이터 (상수 포함). heap 할당을 하지 않는다
+ */
+void run(const Op& op, const Graph& graph, const std::vector<float*>& values);
+
+}  // namespace kernels
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_KERNELS_H_
@@ -0,0 +1,28 @@
+#ifndef TFE_ENGINE_LAYOUT_PASS_H_
+#define TFE_ENGINE_LAYOUT_PASS_H_
+
+#include "engine/graph.h"
+#include "tensor/layout.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief 활성값 slot 마다 layout 을 정하고 필요한 곳에만 REORDER 를 넣는다
+ *
+ * 묶을 수 있는 conv (convLayoutApplies) 는 blocked layout 으로 쓰고, 원소별 연산 / batch_norm /
+ * pooling / upsample / pad / 채널 cat 은 입력의 layout 을 그대로 잇는다. 묶인 layout 을 모르는 연산
+ * (linear, reshape, broadcast 이항 연산 등) 과 그래프 출력 앞에서만 NCHW 로 되돌리므로, 연속된 conv
+ * 사이에는 변환이 생기지 않는다. 그래프 입력은 NCHW 그대로 첫 conv 가 읽는다.
+ * 채널 수가 묶음의 배수가 아닌 텐서는 NCHW 로 둔다 (남는 lane 을 원소별 연산이 건드리지 않도록).
+ * int8 로 돌 conv (params.input_scale > 0) 도 NCHW 로 둔다. 묶음이 8 (AVX2 / NEON) 이면 NCHW 에서
+ * WINOGRAD_3X3 를 고를 conv (selectConvAlgo) 도 NCHW 로 두고, 16 (AVX-512) 일 때만 DIRECT_NCHWC 로
+ * 바꾼다.
+ * lower() 직후, planMemory() 전에 한 번 부른다.
+ */
+void assignLayouts(Graph& graph, tensor::Layout blocked);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_LAYOUT_PASS_H_
@@ -0,0 +1,52 @@
+#ifndef TFE_ENGINE_LOWERING_H_
+#define TFE_ENGINE_LOWERING_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "engine/graph.h"
+#include "model/script_model.h"
+#include "parser/parser_tflite.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief lowering 할 수 없는 코드 (제어 흐름, 모르는 연산 등)
+ */
+class LoweringError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief ScriptModel 의 forward 를 고정 입력 shape 로 기호 실행해서 flat op 열로 만든다
+ *
+ * code/ 의 forward 소스를 한 줄씩 따라가며 서브모듈 호출은 인라인하고 torch.* 호출은 Op 로 바꾼다.
+ * shape 는 이 시점에 모두 정해지므로 torch.size 같은 스칼라 식은 상수로 접힌다.
+ * 소스가 없거나 분기가 있는 잘 알려진 leaf 모듈 (Conv2d, BatchNorm2d, ReLU, MaxPool2d ...) 은
+ * 모듈 속성 / 클래스 상수로 바로 lowering 한다.
+ */
+Graph lower(const model::ScriptModel& model, const std::vector<std::vector<int64_t>>& input_shapes);
+
+/**
+ * @brief TFLite 모델의 첫 subgraph (main) 를 같은 flat op 열로 옮긴다
+ *
+ * TFLite 활성값은 NHWC 지만 Graph 는 논리 NCHW 라 4 차원 텐서의 축을 옮긴다 (Engine 입력 / 출력도
+ * NCHW 다). input_shapes 는 NCHW 로 주고, 비우면 파일에 적힌 입력 shape 를 쓴다.
+ * 상수는 parser 매핑을 가리키는 view 이고 (Storage::adopt, 매핑은 상수가 쥐므로 parser 보다 오래 산다)
+ * 축을 바꿔야 하는 4 차원 상수 (OHWI conv weight 등) 만 한 번 OIHW 로 옮긴다.
+ * float32 모델의 CONV_2D, DEPTHWISE_CONV_2D, FULLY_CONNECTED, MAX_POOL_2D, 전역 AVERAGE_POOL_2D /
+ * MEAN, ADD / SUB / MUL / DIV, CONCATENATION, RELU / LOGISTIC / ELU, RESHAPE, PAD,
+ * RESIZE_NEAREST_NEIGHBOR 를 다룬다. fused activation 은 NONE / RELU 만 되고, 양자화 텐서와 그 밖의
+ * op 는 LoweringError 다.
+ */
+Graph lower(const parser::TFLiteParser& model,
+            const std::vector<std::vector<int64_t>>& input_shapes = {});
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_LOWERING_H_
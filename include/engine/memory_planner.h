@@ -0,0 +1,42 @@
+#ifndef TFE_ENGINE_MEMORY_PLANNER_H_
+#define TFE_ENGINE_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/graph.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief 활성값 slot 들을 arena 하나에 배치한 결과
+ */
+struct MemoryPlan {
+  std::vector<int64_t> offsets;  // slot -> arena 안의 byte offset. 상수와 죽은 slot 은 -1
+  size_t arena_bytes = 0;        // 계획된 peak
+  size_t naive_bytes = 0;        // slot 마다 따로 잡았을 때의 합
+
+  /**
+   * @brief e.g. "arena 3.1 MB for 42 activations (naive 18.4 MB, 17%)"
+   */
+  std::string summary() const;
+};
+
+/**
+ * @brief op 열에서 slot 수명을 구해 greedy-by-size 로 offset 을 재사용한다
+ *
+ * 큰 slot 부터, 수명이 겹치는 이미 배치된 slot 들 사이의 가장 낮은 빈 자리에 넣는다.
+ * op 의 출력은 같은 op 의 입력과 수명이 겹치는 것으로 보므로 커널은 in-place 를 가정하지 않아도 된다.
+ * RESHAPE 출력은 입력과 같은 바이트이므로 입력 자리를 그대로 쓴다 (복사 없음).
+ * steps[i] 는 ops[i] 가 도는 시각이다 (Schedule::steps, 비우면 op 순서). 같은 시각의 op 들은 동시에
+ * 돌 수 있으므로 그 입출력은 서로 자리를 나누지 않는다.
+ */
+MemoryPlan planMemory(const Graph& graph, const std::vector<int64_t>& steps = {});
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_MEMORY_PLANNER_H_
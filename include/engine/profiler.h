@@ -0,0 +1,122 @@
+#ifndef TFE_ENGINE_PROFILER_H_
+#define TFE_ENGINE_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/graph.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief op 한 번 실행. 시각은 Profiler 를 만든 때부터의 ns
+ */
+struct OpEvent {
+  int32_t op      = -1;  // graph.ops 의 index
+  uint32_t worker = 0;   // 돈 pool worker (호출 스레드는 0)
+  int64_t begin   = 0;
+  int64_t end     = 0;
+};
+
+/**
+ * @brief 모듈 경로 (op.name, e.g. "encoder.layer3.1.conv2") 하나로 모은 실행 기록
+ */
+struct ModuleProfile {
+  std::string module;
+  size_t calls    = 0;
+  int64_t total   = 0;  // ns
+  int64_t longest = 0;  // ns
+  double flops    = 0.0;
+  double bytes    = 0.0;  // 읽고 쓴 slot 바이트 (상수 포함)
+};
+
+/**
+ * @brief Engine::run() 의 op 별 시간 기록
+ *
+ * worker 마다 고정 크기 ring 하나를 두고, 같은 순간 한 worker 로 도는 op 는 하나뿐이므로 (Engine 의
+ * run() 은 재진입하지 않는다) 쓰는 쪽은 lock 도 CAS 도 없이 제 ring 에 쓰고 head 만 올린다. ring 이 차면
+ * 가장 오래된 기록부터 덮는다. 읽는 함수들은 run() 사이에 부른다.
+ * op 별 flop 과 바이트는 생성 시점에 그래프에서 한 번 계산해 둔다 (opCost(), slot 크기).
+ */
+class Profiler {
+ public:
+  static constexpr size_t kDefaultCapacity = 1 << 14;
+
+  /**
+   * @param workers ring 수. Engine 이 쓰는 pool 의 concurrency()
+   * @param capacity worker 마다 남길 기록 수. 2 의 거듭제곱으로 올린다
+   */
+  Profiler(const Graph& graph, size_t workers, size_t capacity = kDefaultCapacity);
+
+  Profiler(const Profiler&)            = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  int64_t now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+               .count() -
+           origin_;
+  }
+
+  void record(size_t op, size_t worker, int64_t begin, int64_t end) {
+    Ring& ring          = rings_[worker];
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ring.events[head & mask_] = {static_cast<int32_t>(op), static_cast<uint32_t>(worker), begin,
+                                 end};
+    ring.head.store(head + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief ring 에 남은 기록을 시작 시각 순으로
+   */
+  std::vector<OpEvent> events() const;
+  /**
+   * @brief ring 이 덮어쓴 기록 수
+   */
+  uint64_t dropped() const;
+  void clear();
+
+  /**
+   * @brief 모듈 경로별 합계, 시간이 긴 것부터. 이름 없는 op (layout REORDER) 는 op 종류로 묶는다
+   */
+  std::vector<ModuleProfile> modules() const;
+  /**
+   * @brief modules() 를 사람이 읽을 표로 (module, calls, total ms, %, avg us, GFLOP/s, GB/s)
+   */
+  std::string table() const;
+  /**
+   * @brief chrome://tracing / Perfetto 가 읽는 trace_event JSON. op 하나가 "X" 이벤트 하나이고
+   *        tid 는 worker 번호다
+   */
+  std::string chromeTrace() const;
+  void saveChromeTrace(const std::string& file_name) const;
+
+ private:
+  struct OpInfo {
+    std::string name;
+    OpKind kind;
+    double flops;
+    double bytes;
+  };
+  struct alignas(64) Ring {
+    std::vector<OpEvent> events;
+    std::atomic<uint64_t> head{0};
+  };
+
+  std::vector<OpInfo> ops_;
+  std::unique_ptr<Ring[]> rings_;
+  size_t workers_;
+  uint64_t mask_;
+  int64_t origin_ = 0;
+};
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_PROFILER_H_
@@ -0,0 +1,125 @@
+#ifndef TFE_ENGINE_QUANTIZATION_H_
+#define TFE_ENGINE_QUANTIZATION_H_
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "engine/engine.h"
+#include "engine/graph.h"
+#include "tensor/tensor.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief calibration 이 본 활성값 하나의 범위
+ *
+ * int8 GEMM 은 입력 전체를 scale / zero point 하나로 읽으므로 텐서 단위로만 모은다 (weight 는
+ * convertQuantizedWeights() 가 출력 채널별로 따로 양자화한다).
+ */
+struct ActivationRange {
+  float min       = std::numeric_limits<float>::infinity();
+  float max       = -std::numeric_limits<float>::infinity();
+  int64_t samples = 0;  // 본 run() 수
+
+  /**
+   * @brief 0 을 항상 포함한 범위 (padding 의 0 을 정확히 나타내도록)
+   */
+  float low() const;
+  float high() const;
+};
+
+/**
+ * @brief post-training 양자화 표. conv / linear 가 읽는 값 (lowering 이 만든 slot id) -> 그 범위
+ *
+ * layout pass 가 넣은 REORDER 는 원래 값으로 거슬러 올라가 세고 fusion 은 입력 slot 을 바꾸지 않으므로,
+ * 같은 Graph 에서 만든 Engine 이면 pass 와 상관없이 같은 값을 가리킨다. 한 모듈을 두 번 부르면 입력마다
+ * 따로 잡힌다. 표에 없는 op 는 float 로 남는다.
+ */
+struct Calibration {
+  std::map<int32_t, ActivationRange> ranges;
+};
+
+/**
+ * @brief 대표 입력으로 float Engine 을 돌리며 conv / linear 입력의 범위를 모은다
+ *
+ *   Engine fp32(model, shapes);
+ *   Calibrator calibrator(fp32);
+ *   for (auto& sample : samples) calibrator.observe(sample);
+ *   options.quantize = std::make_shared<Calibration>(calibrator.calibration());
+ *   Engine int8(model, shapes, options);
+ */
+class Calibrator {
+ public:
+  explicit Calibrator(Engine& engine) : engine_(engine) {}
+
+  /**
+   * @brief inputs 로 engine 을 한 번 돌리며 범위를 넓힌다
+   */
+  void observe(const std::vector<tensor::Tensor>& inputs);
+  const Calibration& calibration() const { return calibration_; }
+
+ private:
+  Engine& engine_;
+  Calibration calibration_;
+};
+
+/**
+ * @brief 범위를 u8 로 나누는 scale 과 zero point (비대칭). ReLU 뒤처럼 음수가 없으면 zero 는 0 이다
+ */
+void activationQuantization(const ActivationRange& range, float* scale, int32_t* zero);
+
+/**
+ * @brief 행마다 대칭 int8 양자화: scale[r] = max|a[r]| / 127, q = round(a / scale[r])
+ */
+void quantizeRows(const float* a, int64_t rows, int64_t cols, int8_t* q, float* scale);
+
+/**
+ * @brief calibration 에 범위가 있는 CONV2D (groups 1) / LINEAR 에 input_scale / input_zero 를 붙인다
+ *
+ * 붙인 conv 는 assignLayouts() 가 NCHW 로 둔다. assignLayouts() 전에 부른다.
+ */
+void planQuantization(Graph& graph, const Calibration& calibration);
+
+/**
+ * @brief planQuantization() 이 고른 op 의 float weight 를 출력 채널별 int8 상수와 scale 상수로 바꾼다
+ *
+ * batch_norm 을 접은 weight 를 양자화하도록 fuseOps() 뒤에 부른다.
+ */
+void convertQuantizedWeights(Graph& graph);
+
+/**
+ * @brief 출력 하나에 대한 float 경로와의 차이
+ */
+struct OutputDiff {
+  double max_abs  = 0.0;
+  double mean_abs = 0.0;
+  double snr_db   = 0.0;  // 10 log10(sum ref^2 / sum (ref - out)^2). 같으면 inf
+  int64_t count   = 0;    // 비교한 원소 수
+};
+
+/**
+ * @brief compareOutputs() 의 결과. 출력 순서대로
+ */
+struct AccuracyReport {
+  std::vector<OutputDiff> outputs;
+
+  /**
+   * @brief 출력마다 한 줄, e.g. "output 0: max abs 0.0123, mean abs 0.00110, SNR 38.2 dB"
+   */
+  std::string summary() const;
+};
+
+/**
+ * @brief 같은 입력들로 두 Engine (보통 float 와 int8) 을 돌려 출력 차이를 모은다
+ */
+AccuracyReport compareOutputs(Engine& reference, Engine& candidate,
+                              const std::vector<std::vector<tensor::Tensor>>& samples);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_QUANTIZATION_H_
@@ -0,0 +1,63 @@
+#ifndef TFE_ENGINE_SCHEDULER_H_
+#define TFE_ENGINE_SCHEDULER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/graph.h"
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief 서로 기다리지 않는 op 묶음. 앞 stage 가 모두 끝나야 시작한다
+ */
+struct Stage {
+  std::vector<int32_t> ops;  // graph.ops 의 index, 비용이 큰 것부터
+  /**
+   * @brief true 면 op 들을 pool 에서 동시에 (op 하나는 스레드 하나로) 돌리고, false 면 차례로 돌며
+   *        op 마다 pool 로 나눈다 (intra-op)
+   */
+  bool concurrent = false;
+};
+
+/**
+ * @brief Engine 이 op 를 도는 순서
+ */
+struct Schedule {
+  std::vector<Stage> stages;
+  std::vector<int64_t> steps;  // op -> stage 번호. planMemory() 의 시각
+
+  /**
+   * @brief e.g. "14 stages for 20 ops, 3 concurrent (7 ops)"
+   */
+  std::string summary() const;
+};
+
+/**
+ * @brief op 마다 먼저 끝나야 하는 op 들: 입력 slot 을 쓰는 op 와, 같은 출력 slot 을 먼저 쓰는 op
+ *        (cat 출력에 제자리로 쓰는 conv)
+ */
+std::vector<std::vector<int32_t>> opDependencies(const Graph& graph);
+
+/**
+ * @brief op 의 대략적인 비용. 계산하는 op 는 flop 수, 옮기기만 하는 op 는 원소 수
+ */
+double opCost(const Graph& graph, const Op& op);
+
+/**
+ * @brief 의존 DAG 의 ASAP level 로 op 를 stage 로 나누고, stage 마다 inter-op 와 intra-op 중 빠른
+ *        쪽을 고른다
+ *
+ * inter-op 는 op 하나가 스레드 하나라 가장 비싼 op 가 끝날 때까지 걸리고 (max(최대 비용, 합 / P)),
+ * intra-op 는 op 마다 나눌 수 있는 만큼만 빨라지며 (conv 만 pool 로 나눈다) 한 번씩 동기화 비용을 낸다.
+ * concurrency 가 1 이면 op 열 순서 그대로 op 하나가 stage 하나다.
+ */
+Schedule scheduleOps(const Graph& graph, size_t concurrency);
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_SCHEDULER_H_
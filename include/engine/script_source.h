@@ -0,0 +1,99 @@
+#ifndef TFE_ENGINE_SCRIPT_SOURCE_H_
+#define TFE_ENGINE_SCRIPT_SOURCE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tfe {
+namespace engine {
+
+/**
+ * @brief code/ 아래 TorchScript 소스의 식 하나
+ *
+ * torch.jit.save 가 쓰는 소스는 (특히 trace 결과는) 분기 없는 직선 코드라
+ * 이름/리터럴/속성/호출/첨자/산술 정도만 있으면 forward 를 따라갈 수 있다.
+ */
+struct Expr {
+  enum class Kind : uint8_t {
+    NAME,
+    INT,
+    FLOAT,
+    STRING,
+    NONE,
+    BOOL,
+    LIST,
+    TUPLE,
+    ATTR,       // args[0].text
+    CALL,       // args[0](args[1..]), keywords 는 뒤쪽 인자 이름
+    SUBSCRIPT,  // args[0][args[1]]
+    NEG,
+    BINARY,     // args[0] op args[1]
+  };
+
+  Kind kind    = Kind::NONE;
+  std::string text;
+  int64_t i    = 0;
+  double f     = 0.0;
+  bool b       = false;
+  char op      = 0;
+  std::vector<std::unique_ptr<Expr>> args;
+  std::vector<std::string> keywords;
+};
+
+struct Stmt {
+  enum class Kind : uint8_t { ASSIGN, RETURN, EXPR, UNSUPPORTED };
+
+  Kind kind = Kind::EXPR;
+  std::vector<std::string> targets;
+  std::unique_ptr<Expr> value;
+  int line = 0;
+  std::string text;  // UNSUPPORTED 일 때 원문 (오류 메시지용)
+};
+
+struct Method {
+  std::string name;
+  std::vector<std::string> params;  // self 포함
+  std::vector<Stmt> body;
+};
+
+/**
+ * @brief class 하나. qualified name 은 파일 경로에서 온 qualifier + "." + 클래스 이름
+ */
+struct ClassDef {
+  std::string name;
+  std::unordered_map<std::string, Method> methods;
+  std::unordered_map<std::string, std::unique_ptr<Expr>> constants;  // stride : Final[...] = (1, 1)
+
+  const Method* method(const std::string& name) const;
+  const Expr* constant(const std::string& name) const;
+};
+
+/**
+ * @brief code/ 아래 소스들을 클래스 단위로 파싱해 둔 것
+ */
+class ScriptSource {
+ public:
+  /**
+   * @param path 모델 디렉터리 기준 경로 (e.g. "code/__torch__/torch/nn/modules/conv.py")
+   */
+  void add(const std::string& path, std::string_view text);
+  const ClassDef* find(std::string_view qualified_name) const;
+  size_t size() const { return classes_.size(); }
+
+  /**
+   * @brief "code/__torch__/a/b.py" -> "__torch__.a.b"
+   */
+  static std::string qualifierOf(const std::string& path);
+
+ private:
+  std::unordered_map<std::string, std::unique_ptr<ClassDef>> classes_;
+};
+
+}  // namespace engine
+}  // namespace tfe
+
+#endif  // TFE_ENGINE_SCRIPT_SOURCE_H_
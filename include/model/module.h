@@ -0,0 +1,167 @@
+#ifndef TFE_MODEL_MODULE_H_
+#define TFE_MODEL_MODULE_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "model/string_table.h"
+#include "tensor/tensor.h"
+#include "tensor/tensor_loader.h"
+#include "vm/value_pkl.h"
+
+namespace tfe {
+namespace model {
+
+/**
+ * @brief 모듈 state 중 텐서/서브모듈이 아닌 값 (training, stride, padding 같은 하이퍼파라미터)
+ */
+struct Attribute {
+  enum class Kind : uint8_t { NONE, BOOL, INT, FLOAT, STRING, INT_LIST, FLOAT_LIST, OTHER };
+
+  Kind kind   = Kind::NONE;
+  bool b      = false;
+  int64_t i   = 0;
+  double f    = 0.0;
+  Symbol s    = StringTable::kInvalid;
+  std::vector<int64_t> ints;
+  std::vector<double> floats;
+};
+
+/**
+ * @brief pickle 값 하나를 Attribute 로. 문자열은 strings 에 intern 한다
+ */
+Attribute toAttribute(const vm::Value& value, StringTable& strings);
+
+/**
+ * @brief string_view 로 찾을 수 있는 이름 집합 (찾을 때 std::string 을 만들지 않는다)
+ */
+using NameSet = std::set<std::string, std::less<>>;
+
+/**
+ * @brief code/ 의 class 본문에 선언된 __parameters__ / __buffers__ 이름들
+ */
+struct ClassMembers {
+  NameSet parameters;
+  NameSet buffers;
+};
+
+/**
+ * @brief "__torch__.torch.nn.modules.conv.Conv2d" 처럼 data.pkl 의 클래스 이름 -> ClassMembers
+ */
+using ClassMemberTable = std::unordered_map<std::string, ClassMembers>;
+
+class ModuleGraph;
+
+/**
+ * @brief __torch__.* 객체 하나. 이름은 모두 ModuleGraph 의 StringTable Symbol 이다.
+ *
+ * state dict 의 값은 종류에 따라 children / parameters / buffers / attributes 로 나뉘고,
+ * slot() 은 이름 하나를 O(1) 로 그 중 하나에 연결한다.
+ * 클래스의 __parameters__ 에 든 텐서를 parameter, 나머지 (running_mean, num_batches_tracked 등) 를 buffer
+ * 로 본다. code/ 가 없어 클래스 선언을 모르면 requires_grad 로 나눈다 (requires_grad_(False) 로 얼린
+ * 모델은 이때 모든 weight 가 buffer 가 된다).
+ */
+class Module {
+ public:
+  enum class SlotKind : uint8_t { CHILD, PARAMETER, BUFFER, ATTRIBUTE };
+  struct Slot {
+    SlotKind kind;
+    uint32_t index;
+  };
+
+  Symbol name() const { return name_; }
+  Symbol type() const { return type_; }
+  const Module* parent() const { return parent_; }
+  bool training() const { return training_; }
+
+  const std::vector<std::pair<Symbol, Module*>>& children() const { return children_; }
+  const std::vector<std::pair<Symbol, tensor::Tensor>>& parameters() const { return parameters_; }
+  const std::vector<std::pair<Symbol, tensor::Tensor>>& buffers() const { return buffers_; }
+  const std::vector<std::pair<Symbol, Attribute>>& attributes() const { return attributes_; }
+
+  const Slot* slot(Symbol name) const;
+  const Module* child(Symbol name) const;
+  const tensor::Tensor* tensor(Symbol name) const;
+  const Attribute* attribute(Symbol name) const;
+
+ private:
+  friend class ModuleGraph;
+
+  void add(Symbol name, SlotKind kind, uint32_t index) { slots_[name] = Slot{kind, index}; }
+
+  Symbol name_          = StringTable::kInvalid;
+  Symbol type_          = StringTable::kInvalid;
+  const Module* parent_ = nullptr;
+  bool training_        = false;
+  std::vector<std::pair<Symbol, Module*>> children_;
+  std::vector<std::pair<Symbol, tensor::Tensor>> parameters_;
+  std::vector<std::pair<Symbol, tensor::Tensor>> buffers_;
+  std::vector<std::pair<Symbol, Attribute>> attributes_;
+  std::unordered_map<Symbol, Slot> slots_;
+};
+
+/**
+ * @brief data.pkl 의 루트 객체에서 만든 모듈 트리
+ *
+ * 모든 Module 을 소유하고 (std::deque 라 주소가 고정), "encoder.conv1.weight" 같은 점 경로는
+ * 구간마다 StringTable::find + Module::slot 한 번씩이라 경로 길이에 비례한다.
+ * 텐서는 TensorLoader 의 lazy storage 를 그대로 들고 있으므로 바이트는 처음 쓸 때 읽힌다.
+ */
+class ModuleGraph {
+ public:
+  /**
+   * @param members code/ 에서 읽은 클래스 선언 (readClassMembers()). nullptr 이거나 클래스가 없으면
+   *        requires_grad 로 parameter 와 buffer 를 나눈다
+   */
+  ModuleGraph(const vm::Value& root, tensor::TensorLoader& loader,
+              const ClassMemberTable* members = nullptr);
+
+  ModuleGraph(const ModuleGraph&)            = delete;
+  ModuleGraph& operator=(const ModuleGraph&) = delete;
+
+  const Module& root() const { return modules_.front(); }
+  size_t size() const { return modules_.size(); }
+  const StringTable& strings() const { return strings_; }
+  std::string_view str(Symbol symbol) const { return strings_.str(symbol); }
+
+  /**
+   * @brief "" 는 루트. 경로가 모듈이 아니면 nullptr
+   */
+  const Module* findModule(std::string_view path) const;
+  const tensor::Tensor* findTensor(std::string_view path) const;
+  const Attribute* findAttribute(std::string_view path) const;
+  std::string path(const Module& module) const;
+
+  /**
+   * @brief path 서브트리의 parameter/buffer storage 를 미리 읽는다
+   * @return 이번에 새로 읽은 storage 수
+   */
+  size_t prefetch(std::string_view path);
+
+ private:
+  Module* build(const vm::Value& value, Symbol name, const Module* parent);
+  bool isModule(const vm::Value& value) const;
+  /**
+   * @brief 마지막 구간 직전까지 내려가서 그 모듈과 마지막 이름의 slot 을 돌려준다
+   */
+  const Module::Slot* resolve(std::string_view path, const Module** owner) const;
+
+  tensor::TensorLoader& loader_;
+  const ClassMemberTable* members_;
+  StringTable strings_;
+  std::deque<Module> modules_;
+  std::unordered_map<const vm::Object*, Module*> built_;
+  Symbol training_symbol_;
+};
+
+}  // namespace model
+}  // namespace tfe
+
+#endif  // TFE_MODEL_MODULE_H_
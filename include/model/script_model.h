@@ -0,0 +1,126 @@
+#ifndef TFE_MODEL_SCRIPT_MODEL_H_
+#define TFE_MODEL_SCRIPT_MODEL_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model/module.h"
+#include "model/string_table.h"
+#include "parser/parser_torch.h"
+#include "tensor/tensor.h"
+#include "tensor/tensor_loader.h"
+#include "vm/value_pkl.h"
+
+namespace tfe {
+namespace model {
+
+/**
+ * @brief code/ 아래 TorchScript 소스 하나. path 는 모델 디렉터리 기준 (e.g. "code/__torch__.py")
+ */
+struct SourceFile {
+  std::string path;
+  std::string text;
+};
+
+/**
+ * @brief constants.pkl / bytecode constants 의 원소. 텐서가 아니면 value 에 담긴다
+ */
+struct Constant {
+  bool isTensor() const { return tensor.defined(); }
+
+  tensor::Tensor tensor;
+  Attribute value;
+};
+
+struct Instruction {
+  std::string op;
+  int32_t x = 0;
+  int32_t n = 0;
+};
+
+struct OperatorRef {
+  std::string name;
+  std::string overload;
+  int64_t num_args = -1;
+};
+
+/**
+ * @brief bytecode.pkl 의 함수 하나 ("__torch__.M.forward" 와 그 instructions/operators/... 테이블)
+ */
+struct BytecodeFunction {
+  std::string name;
+  std::vector<Instruction> instructions;
+  std::vector<OperatorRef> operators;
+  std::vector<Constant> constants;
+  std::vector<std::string> types;
+  int64_t register_size = 0;
+};
+
+struct Bytecode {
+  int64_t version = 0;
+  std::vector<BytecodeFunction> functions;
+  StringTable strings;
+
+  const BytecodeFunction* find(std::string_view name) const;
+};
+
+/**
+ * @brief constants.pkl 루트 튜플. 텐서는 loader 의 record_dir (보통 "constants") 에서 찾는다
+ */
+std::vector<Constant> decodeConstants(const vm::Value& root, tensor::TensorLoader& loader,
+                                      StringTable& strings);
+Bytecode decodeBytecode(const vm::Value& root, tensor::TensorLoader& loader);
+std::vector<SourceFile> readSources(const parser::TorchParser& parser);
+/**
+ * @brief 소스마다 class 본문의 __parameters__ = [...] / __buffers__ = [...] 를 모은다.
+ *        "code/__torch__/a/b.py" 의 class C 는 "__torch__.a.b.C"
+ */
+ClassMemberTable readClassMembers(const std::vector<SourceFile>& sources);
+
+/**
+ * @brief TorchScript 아카이브 하나의 모든 섹션
+ *
+ * data.pkl (ModuleGraph), constants.pkl, bytecode.pkl, code/ 를 각자의 PickleVM / TensorLoader 로
+ * 동시에 디코딩한다 (std::async). constants.pkl 과 bytecode.pkl 은 같은 TensorLoader 로 storage 를
+ * 공유하므로 두 섹션이 동시에 storage 를 만들 수 있고, 이는 TensorLoader 의 storages_mutex_ 가 지킨다.
+ * data.pkl 은 PrefetchVisitor 를 붙여 실행하므로 persistent id 가 나오는 대로 storage 읽기가 시작되고,
+ * DEFLATED 면 통째로 풀지 않고 inflate 되는 chunk 를 바로 feed() 한다.
+ */
+class ScriptModel {
+ public:
+  explicit ScriptModel(const std::string& file_name, size_t num_threads = 0);
+  ~ScriptModel();
+
+  ScriptModel(const ScriptModel&)            = delete;
+  ScriptModel& operator=(const ScriptModel&) = delete;
+
+  const parser::TorchParser& parser() const { return *parser_; }
+  ModuleGraph& modules() { return *graph_; }
+  const ModuleGraph& modules() const { return *graph_; }
+  tensor::TensorLoader& tensors() { return *data_loader_; }
+
+  const std::vector<Constant>& constants() const { return constants_; }
+  bool hasBytecode() const { return parser_->hasBytecode(); }
+  const Bytecode& bytecode() const { return bytecode_; }
+  const std::vector<SourceFile>& sources() const { return sources_; }
+  const SourceFile* source(std::string_view path) const;
+
+ private:
+  std::unique_ptr<parser::TorchParser> parser_;
+  std::unique_ptr<tensor::TensorLoader> data_loader_;
+  std::unique_ptr<tensor::TensorLoader> constants_loader_;  // constants.pkl, bytecode.pkl 이 같이 쓴다
+  std::unique_ptr<ModuleGraph> graph_;
+  ClassMemberTable class_members_;
+  StringTable constant_strings_;
+  std::vector<Constant> constants_;
+  Bytecode bytecode_;
+  std::vector<SourceFile> sources_;
+};
+
+}  // namespace model
+}  // namespace tfe
+
+#endif  // TFE_MODEL_SCRIPT_MODEL_H_
@@ -0,0 +1,45 @@
+#ifndef TFE_MODEL_STRING_TABLE_H_
+#define TFE_MODEL_STRING_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace tfe {
+namespace model {
+
+using Symbol = uint32_t;
+
+/**
+ * @brief 모듈/속성 이름 intern 테이블
+ *
+ * "training", "weight" 같은 이름은 서브모듈 수만큼 반복되므로 한 번만 저장하고 Symbol 로 가리킨다.
+ * 문자열은 std::deque 에 두어 push_back 후에도 주소가 바뀌지 않는다 (index_ 의 key 가 그 view).
+ */
+class StringTable {
+ public:
+  static constexpr Symbol kInvalid = UINT32_MAX;
+
+  Symbol intern(std::string_view s);
+  /**
+   * @brief 추가하지 않고 찾기만 한다. 없으면 kInvalid
+   */
+  Symbol find(std::string_view s) const;
+  std::string_view str(Symbol symbol) const { return strings_[symbol]; }
+
+  size_t size() const { return strings_.size(); }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  std::deque<std::string> strings_;
+  std::unordered_map<std::string_view, Symbol> index_;
+  size_t bytes_ = 0;
+};
+
+}  // namespace model
+}  // namespace tfe
+
+#endif  // TFE_MODEL_STRING_TABLE_H_
@@ -0,0 +1,223 @@
+#ifndef TFE_PARSER_TFLITE_H_
+#define TFE_PARSER_TFLITE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser/parser_base.h"
+
+namespace tfe {
+namespace parser {
+
+/**
+ * @brief flatbuffer 의 [uint32 length][T ...] 벡터를 매핑 안에서 바로 읽는 view
+ *
+ * 원소는 4 byte 정렬만 보장되므로 memcpy 로 읽는다 (little endian 호스트 기준).
+ */
+template <typename T>
+class FlatVector {
+ public:
+  FlatVector() = default;
+  FlatVector(const char* data, uint32_t size) : data_(data), size_(size) {}
+
+  uint32_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const char* data() const { return data_; }
+  T operator[](uint32_t index) const {
+    T value;
+    std::memcpy(&value, data_ + static_cast<size_t>(index) * sizeof(T), sizeof(T));
+    return value;
+  }
+
+ private:
+  const char* data_ = nullptr;
+  uint32_t size_    = 0;
+};
+
+/**
+ * @brief flatbuffer table 하나. 필드는 vtable 을 따라 매핑 안에서 바로 읽는다
+ *
+ * offset 은 읽을 때마다 파일 크기 안인지 확인하고, 벗어나면 ParserException (PARSE_ERROR) 을 던진다.
+ * 필드가 없거나 (vtable 이 짧거나 0) table 자체가 없으면 기본값을 돌려준다.
+ */
+class FlatTable {
+ public:
+  FlatTable() = default;
+  FlatTable(const char* base, size_t size, uint32_t offset);
+
+  bool valid() const { return base_ != nullptr; }
+
+  template <typename T>
+  T scalar(uint16_t field, T fallback) const {
+    const uint32_t at = fieldOffset(field, sizeof(T));
+    if (at == 0) {
+      return fallback;
+    }
+    T value;
+    std::memcpy(&value, base_ + at, sizeof(T));
+    return value;
+  }
+  FlatTable table(uint16_t field) const;
+  std::string_view string(uint16_t field) const;
+  template <typename T>
+  FlatVector<T> vector(uint16_t field) const {
+    uint32_t size    = 0;
+    const char* data = vectorData(field, sizeof(T), &size);
+    return FlatVector<T>(data, size);
+  }
+  /**
+   * @brief table 들의 벡터 (e.g. Model.subgraphs)
+   */
+  std::vector<FlatTable> tables(uint16_t field) const;
+
+ private:
+  /**
+   * @brief 필드 값의 파일 offset. 필드가 없으면 0
+   */
+  uint32_t fieldOffset(uint16_t field, size_t bytes) const;
+  /**
+   * @brief uoffset 필드가 가리키는 곳의 파일 offset. 필드가 없으면 0
+   */
+  uint32_t indirect(uint16_t field) const;
+  const char* vectorData(uint16_t field, size_t element, uint32_t* size) const;
+
+  const char* base_     = nullptr;
+  size_t size_          = 0;
+  uint32_t offset_      = 0;
+  uint32_t vtable_      = 0;
+  uint16_t vtable_size_ = 0;
+};
+
+/**
+ * @brief schema.fbs 의 TensorType
+ */
+enum class TFLiteType : int8_t {
+  FLOAT32 = 0,
+  FLOAT16 = 1,
+  INT32   = 2,
+  UINT8   = 3,
+  INT64   = 4,
+  STRING  = 5,
+  BOOL    = 6,
+  INT16   = 7,
+  INT8    = 9,
+  FLOAT64 = 10,
+};
+
+const char* tfliteTypeToString(TFLiteType type);
+
+/**
+ * @brief schema.fbs 의 BuiltinOperator 중 이름을 붙여 쓰는 것
+ */
+enum TFLiteBuiltin : int32_t {
+  kTFLiteAdd                   = 0,
+  kTFLiteAveragePool2d         = 1,
+  kTFLiteConcatenation         = 2,
+  kTFLiteConv2d                = 3,
+  kTFLiteDepthwiseConv2d       = 4,
+  kTFLiteFullyConnected        = 9,
+  kTFLiteLogistic              = 14,
+  kTFLiteMaxPool2d             = 17,
+  kTFLiteMul                   = 18,
+  kTFLiteRelu                  = 19,
+  kTFLiteRelu6                 = 21,
+  kTFLiteReshape               = 22,
+  kTFLitePad                   = 34,
+  kTFLiteMean                  = 40,
+  kTFLiteSub                   = 41,
+  kTFLiteDiv                   = 42,
+  kTFLiteResizeNearestNeighbor = 97,
+  kTFLiteElu                   = 111,
+};
+
+/**
+ * @brief SubGraph.tensors 의 원소. name / shape 는 매핑을 가리킨다
+ */
+struct TFLiteTensor {
+  std::string_view name;
+  FlatVector<int32_t> shape;
+  TFLiteType type = TFLiteType::FLOAT32;
+  uint32_t buffer = 0;      // Model.buffers 의 index. 0 은 빈 buffer (활성값)
+  bool quantized  = false;  // quantization.scale 이 있다
+};
+
+/**
+ * @brief SubGraph.operators 의 원소. options 는 builtin_options table (없으면 invalid)
+ */
+struct TFLiteOperator {
+  int32_t builtin = 0;  // BuiltinOperator. deprecated_builtin_code 와 builtin_code 중 큰 값
+  std::string_view custom_code;
+  FlatVector<int32_t> inputs;  // -1 은 생략한 optional 입력 (e.g. bias 없는 conv)
+  FlatVector<int32_t> outputs;
+  FlatTable options;
+};
+
+struct TFLiteSubgraph {
+  std::string_view name;
+  std::vector<TFLiteTensor> tensors;
+  FlatVector<int32_t> inputs;
+  FlatVector<int32_t> outputs;
+  std::vector<TFLiteOperator> operators;
+};
+
+/**
+ * @brief TensorFlow Lite (.tflite) 디코딩 파서 클래스
+ *
+ * 파일 전체를 읽기 전용으로 매핑하고 flatbuffer (Model -> subgraphs / operator_codes / buffers) 를
+ * 제자리에서 읽는다. 만드는 것은 table 위치를 담은 작은 목록뿐이고 이름, shape, weight 바이트는
+ * 모두 매핑을 가리키는 view 다. view 는 mapping() 을 붙잡고 있는 동안 유효하다 (파서보다 오래 살
+ * 수 있다).
+ */
+class TFLiteParser : public BaseParser {
+ public:
+  TFLiteParser();
+  ~TFLiteParser() override;
+
+  void read(const std::string& file_name) override;
+
+  /**
+   * @brief Model.version (schema 버전, 보통 3)
+   */
+  std::string getVersion() const override;
+  std::string getByteOrder() const override;
+  std::string getFileSize() const override;
+  /**
+   * @brief Model.description (e.g. "MLIR Converted.")
+   */
+  std::string getData() const override;
+
+  const std::vector<TFLiteSubgraph>& subgraphs() const { return subgraphs_; }
+  /**
+   * @brief Model.buffers[index] 의 바이트. data 벡터나 (2GB 가 넘는 모델의) offset / size 를 따른다.
+   *        빈 buffer 면 빈 view
+   */
+  std::string_view buffer(uint32_t index) const;
+  size_t bufferCount() const { return buffers_.size(); }
+
+  const char* base() const;
+  size_t size() const;
+  /**
+   * @brief 매핑의 수명을 쥔 handle. view 를 tensor::Storage::adopt() 로 넘길 때 owner 로 쓴다
+   */
+  std::shared_ptr<const void> mapping() const { return mapping_; }
+
+ private:
+  struct Mapping;
+
+  void parse();
+
+  std::string file_name_;
+  std::shared_ptr<Mapping> mapping_;
+  std::vector<FlatTable> buffers_;
+  std::vector<TFLiteSubgraph> subgraphs_;
+};
+
+}  // namespace parser
+}  // namespace tfe
+
+#endif  // TFE_PARSER_TFLITE_H_
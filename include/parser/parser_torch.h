@@ -1,13 +1,14 @@
 #ifndef TFE_PARSER_TORCH_H_
 #define TFE_PARSER_TORCH_H_
 
-#include <unzip.h>
-
-#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "parser/parser_base.h"
+#include "parser/zip_archive.h"
 
 namespace tfe {
 namespace parser {
@@ -27,14 +28,51 @@ class TorchParser : public BaseParser {
   std::string getFileSize() const override;
   std::string getData() const override;
 
+  /**
+   * @brief data.pkl 바이트. DEFLATED 면 처음 부를 때 통째로 푼다 (스트리밍하려면 streamRecord())
+   */
+  std::string_view getDataView() const;
+  const ZipEntry& getDataEntry() const { return *data_entry_; }
+  std::string_view getConstantsView() const { return constants_record_.view(); }
+  bool hasConstants() const { return has_constants_; }
+  /**
+   * @brief _save_for_lite_interpreter 로 저장한 모델에만 있다
+   */
+  std::string_view getBytecodeView() const { return bytecode_record_.view(); }
+  bool hasBytecode() const { return has_bytecode_; }
+  /**
+   * @brief code/ 아래 TorchScript 소스 엔트리 (.py). 경로는 모델 디렉터리 기준 "code/__torch__/x.py"
+   */
+  const std::vector<const ZipEntry*>& getCodeEntries() const { return code_entries_; }
+  const std::string& getModelName() const { return model_name_; }
+  const ZipArchive& getArchive() const { return *archive_; }
+  /**
+   * @brief 매핑을 가리키는 Storage 가 파서보다 오래 살 수 있도록 아카이브 수명을 나눠 준다
+   */
+  std::shared_ptr<const ZipArchive> shareArchive() const { return archive_; }
+  const std::vector<ZipEntry>& getEntries() const { return archive_->entries(); }
+  const ZipEntry* findRecord(const std::string& internal_path) const;
+  ZipRecord getRecord(const std::string& internal_path) const;
+  const ZipEntry& getRecordEntry(const std::string& internal_path) const;
+  void streamRecord(const std::string& internal_path, const ZipArchive::ChunkSink& sink) const;
+
  private:
-  void parse(unzFile);
-  std::string read_file_from_zip(unzFile uf, const std::string& internal_path);
+  void parse();
+  std::string read_file_from_zip(const std::string& internal_path);
 
   
   std::string version_;
   std::string byte_order_;
   std::string model_name_;
+  std::shared_ptr<ZipArchive> archive_;
+  const ZipEntry* data_entry_ = nullptr;
+  mutable std::mutex data_mutex_;
+  mutable ZipRecord data_record_;
+  ZipRecord constants_record_;
+  ZipRecord bytecode_record_;
+  bool has_constants_ = false;
+  bool has_bytecode_  = false;
+  std::vector<const ZipEntry*> code_entries_;
 };
 
 }  // namespace parser
@@ -0,0 +1,155 @@
+#ifndef TFE_PARSER_ZIP_ARCHIVE_H_
+#define TFE_PARSER_ZIP_ARCHIVE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tfe {
+namespace parser {
+
+/**
+ * @brief ZIP central directory 의 엔트리 하나
+ *
+ * data_offset 은 local header 를 건너뛴 실제 payload 위치 (ZipArchive 가 open 시점에 채움)
+ */
+struct ZipEntry {
+  static constexpr uint16_t kStored   = 0;
+  static constexpr uint16_t kDeflated = 8;
+
+  std::string name;
+  uint64_t local_header_offset = 0;
+  uint64_t data_offset         = 0;
+  uint64_t compressed_size     = 0;
+  uint64_t uncompressed_size   = 0;
+  uint32_t crc32               = 0;
+  uint16_t method              = kStored;
+
+  bool isStored() const { return method == kStored; }
+};
+
+/**
+ * @brief 엔트리 하나의 바이트
+ *
+ * STORED 엔트리는 mmap 영역을 그대로 가리키고 (zero-copy), DEFLATED 엔트리만 inflate 한 버퍼를 소유한다.
+ * view 가 소유 버퍼를 가리키므로 복사는 막고, move 는 버퍼를 넘긴 뒤 원본을 비운다.
+ */
+class ZipRecord {
+ public:
+  ZipRecord() = default;
+  explicit ZipRecord(std::string_view mapped) : view_(mapped) {}
+  explicit ZipRecord(std::vector<char>&& owned)
+      : owned_(std::move(owned)), view_(owned_.data(), owned_.size()) {}
+
+  ZipRecord(const ZipRecord&)            = delete;
+  ZipRecord& operator=(const ZipRecord&) = delete;
+  ZipRecord(ZipRecord&& other) noexcept
+      : owned_(std::move(other.owned_)), view_(std::exchange(other.view_, std::string_view())) {}
+  ZipRecord& operator=(ZipRecord&& other) noexcept {
+    owned_ = std::move(other.owned_);
+    view_  = std::exchange(other.view_, std::string_view());
+    return *this;
+  }
+
+  std::string_view view() const { return view_; }
+  const char* data() const { return view_.data(); }
+  size_t size() const { return view_.size(); }
+  bool empty() const { return view_.empty(); }
+  bool isMapped() const { return owned_.empty() && !view_.empty(); }
+
+ private:
+  std::vector<char> owned_;
+  std::string_view view_;
+};
+
+class ZipArchive;
+
+/**
+ * @brief raw deflate 스트림 하나를 재사용하는 inflater
+ *
+ * z_stream 은 스레드 간에 공유할 수 없으므로 worker 마다 하나씩 둔다. 엔트리 사이에는 inflateReset 만
+ * 하므로 inflateInit2 의 32KB window 할당이 엔트리마다 반복되지 않는다.
+ */
+class ZipInflater {
+ public:
+  ZipInflater();
+  ~ZipInflater();
+
+  ZipInflater(const ZipInflater&)            = delete;
+  ZipInflater& operator=(const ZipInflater&) = delete;
+
+  /**
+   * @brief entry 를 dst 에 바로 inflate 한다. dst 는 uncompressed_size 이상이어야 한다
+   */
+  void inflate(const ZipArchive& archive, const ZipEntry& entry, char* dst);
+
+ private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+/**
+ * @brief mmap 기반 ZIP 리더
+ *
+ * 아카이브 전체를 읽기 전용으로 매핑하고 central directory (ZIP64 포함) 를 직접 파싱한다. 쓰기 권한이
+ * 없으므로 매핑이 commit charge 를 잡지 않는다 (overcommit_memory=2 에서도 큰 아카이브를 연다).
+ * minizip 처럼 엔트리마다 복사하지 않고 STORED 엔트리는 매핑을 그대로 넘겨준다.
+ */
+class ZipArchive {
+ public:
+  static constexpr size_t kStreamChunkSize = 64 * 1024;
+  using ChunkSink = std::function<void(const char* data, size_t size)>;
+
+  explicit ZipArchive(const std::string& file_name);
+  ~ZipArchive();
+
+  ZipArchive(const ZipArchive&)            = delete;
+  ZipArchive& operator=(const ZipArchive&) = delete;
+
+  /**
+   * @brief central directory 순서 그대로의 엔트리 목록
+   */
+  const std::vector<ZipEntry>& entries() const { return entries_; }
+  /**
+   * @brief open 시점에 만든 이름 -> 엔트리 hash 색인으로 O(1) 조회. 없으면 nullptr
+   */
+  const ZipEntry* find(std::string_view name) const;
+
+  ZipRecord read(const ZipEntry& entry) const;
+  ZipRecord read(const std::string& name) const;
+  std::string_view view(const ZipEntry& entry) const;
+  /**
+   * @brief 엔트리를 미리 할당된 dst 에 바로 풀어 쓴다 (중간 버퍼 없음). 스레드마다 inflater 를 따로 넘긴다.
+   */
+  void readInto(const ZipEntry& entry, char* dst, ZipInflater& inflater) const;
+  void stream(const ZipEntry& entry, const ChunkSink& sink,
+              size_t chunk_size = kStreamChunkSize) const;
+
+  const char* base() const { return base_; }
+  size_t size() const { return size_; }
+
+ private:
+  void readCentralDirectory();
+  uint64_t resolveDataOffset(const ZipEntry& entry) const;
+  std::vector<char> inflateEntry(const ZipEntry& entry) const;
+
+  friend class ZipInflater;
+
+  std::string file_name_;
+  int fd_           = -1;
+  const char* base_ = nullptr;
+  size_t size_      = 0;
+  std::vector<ZipEntry> entries_;
+  std::unordered_map<std::string_view, size_t> index_;
+};
+
+}  // namespace parser
+}  // namespace tfe
+
+#endif  // TFE_PARSER_ZIP_ARCHIVE_H_
@@ -0,0 +1,66 @@
+#ifndef TFE_TENSOR_LAYOUT_H_
+#define TFE_TENSOR_LAYOUT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "tensor/tensor.h"
+
+namespace tfe {
+namespace tensor {
+
+/**
+ * @brief 4 차원 활성값의 메모리 배치. 논리 shape 는 어느 쪽이든 NCHW 로 부른다
+ *
+ * NCHW8C / NCHW16C 는 채널을 8 / 16 개씩 묶어 [N][C/b][H][W][b] 로 둔다. 한 픽셀의 채널 묶음이
+ * 벡터 레지스터 하나에 들어가므로 conv 가 출력 채널 방향으로 바로 벡터화된다.
+ * 채널 수가 b 의 배수가 아니면 마지막 묶음의 남는 lane 을 0 으로 채운다.
+ */
+enum class Layout : uint8_t {
+  NCHW,
+  NHWC,
+  NCHW8C,
+  NCHW16C,
+};
+
+const char* layoutToString(Layout layout);
+
+/**
+ * @brief 채널 묶음 크기. 묶지 않는 layout 은 1
+ */
+int64_t layoutBlock(Layout layout);
+inline bool isBlocked(Layout layout) { return layoutBlock(layout) > 1; }
+
+/**
+ * @brief 논리 NCHW shape 의 실제 배치 shape. e.g. {1, 20, 7, 7} NCHW8C -> {1, 3, 7, 7, 8}
+ */
+std::vector<int64_t> physicalSizes(const std::vector<int64_t>& sizes, Layout layout);
+int64_t physicalNumel(const std::vector<int64_t>& sizes, Layout layout);
+
+/**
+ * @brief float32 4 차원 텐서를 from 배치에서 to 배치로 옮긴다. sizes 는 논리 NCHW shape
+ *
+ * dst 는 physicalNumel(sizes, to) 만큼 있어야 하고 src 와 겹치면 안 된다. 할당하지 않는다.
+ */
+void reorder(const float* src, Layout from, float* dst, Layout to,
+             const std::vector<int64_t>& sizes);
+
+/**
+ * @brief 연속 NCHW 텐서를 layout 배치의 새 텐서로 복사한다 (sizes() 는 physicalSizes)
+ */
+Tensor toLayout(const Tensor& src, Layout layout);
+
+/**
+ * @brief OIHW conv weight 를 [O/ob][I/ib][H][W][ib][ob] 로 묶는다 (모자라는 채널은 0)
+ *
+ * 묶인 conv 는 입력 픽셀의 한 채널을 broadcast 하고 ob 개 출력 채널 weight 를 벡터로 읽는다.
+ * NCHW 입력은 ib = 1 로 묶는다.
+ */
+std::vector<int64_t> blockedWeightSizes(const std::vector<int64_t>& w, int64_t ib, int64_t ob);
+void packConvWeight(const float* weight, const std::vector<int64_t>& w, int64_t ib, int64_t ob,
+                    float* dst);
+
+}  // namespace tensor
+}  // namespace tfe
+
+#endif  // TFE_TENSOR_LAYOUT_H_
@@ -1,5 +1,219 @@
-namespace tensord {
-namespace te {
+#ifndef TFE_TENSOR_TENSOR_H_
+#define TFE_TENSOR_TENSOR_H_
 
-}
-}
\ No newline at end of file
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser/zip_archive.h"
+
+namespace tfe {
+namespace tensor {
+
+enum class DType : uint8_t {
+  FLOAT32,
+  FLOAT64,
+  FLOAT16,
+  BFLOAT16,
+  INT64,
+  INT32,
+  INT16,
+  INT8,
+  UINT8,
+  BOOL,
+};
+
+size_t dtypeSize(DType dtype);
+const char* dtypeToString(DType dtype);
+
+/**
+ * @brief torch.<Name>Storage 클래스 이름 -> DType. e.g. "FloatStorage" -> FLOAT32
+ * @return 모르는 이름이면 false
+ */
+bool dtypeFromStorageName(std::string_view name, DType* dtype);
+
+/**
+ * @brief 64 byte 정렬 버퍼 (AVX-512 한 레지스터 / 캐시 라인 단위)
+ *
+ * 크기도 64 의 배수로 올려서 할당하므로 커널이 마지막 벡터를 마스크 없이 읽어도 된다.
+ */
+class AlignedBuffer {
+ public:
+  static constexpr size_t kAlignment = 64;
+
+  AlignedBuffer() = default;
+  explicit AlignedBuffer(size_t size);
+
+  void* data() { return data_.get(); }
+  const void* data() const { return data_.get(); }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  struct Free {
+    void operator()(void* p) const { std::free(p); }
+  };
+
+  std::unique_ptr<void, Free> data_;
+  size_t size_ = 0;
+};
+
+/**
+ * @brief data/<key> 레코드 하나. 같은 key 를 쓰는 텐서들은 Storage 하나를 공유한다
+ *
+ * setSource() 로 아카이브 엔트리 (offset/size) 만 기록해 두고, 바이트는 data() 가 처음 불릴 때
+ * 읽는다. 여러 스레드가 동시에 data() 를 불러도 한 번만 읽는다 (std::call_once).
+ * 64 byte 정렬된 STORED 레코드는 읽지 않고 아카이브 매핑을 그대로 가리키고 (PyTorch 는 data/ 를 정렬해
+ * 쓴다), DEFLATED 이거나 정렬이 어긋난 레코드만 버퍼에 풀어 쓴다. Storage 가 아카이브를 붙잡고 있으므로
+ * TorchParser 가 먼저 사라져도 된다.
+ * adopt() 한 Storage 는 버퍼를 잡지 않고 남의 메모리 (mmap 한 compiled model) 를 가리킨다.
+ * 매핑은 모두 읽기 전용이므로 매핑이나 adopt() 한 메모리를 가리키는 Storage 의 data() 에는 쓰면 안 된다.
+ * 쓸 Storage 만 mutableData() 로 자기 버퍼에 복사한다.
+ */
+class Storage {
+ public:
+  using Filler = std::function<void(char* dst)>;
+
+  Storage(std::string key, DType dtype, int64_t numel, std::string device);
+
+  const std::string& key() const { return key_; }
+  DType dtype() const { return dtype_; }
+  int64_t numel() const { return numel_; }
+  size_t nbytes() const { return static_cast<size_t>(numel_) * dtypeSize(dtype_); }
+  const std::string& device() const { return device_; }
+
+  void setSource(std::shared_ptr<const parser::ZipArchive> archive, const parser::ZipEntry* entry);
+  const parser::ZipEntry* source() const { return entry_; }
+  /**
+   * @brief 복사 없이 아카이브 매핑을 가리킬 레코드인가 (STORED + 64 byte 정렬)
+   */
+  bool mapsSource() const;
+  uint64_t archiveOffset() const { return entry_ ? entry_->data_offset : 0; }
+  uint64_t archiveSize() const { return entry_ ? entry_->compressed_size : 0; }
+
+  void* data() {
+    materialize();
+    return data_;
+  }
+  const void* data() const {
+    materialize();
+    return data_;
+  }
+  bool loaded() const { return loaded_.load(std::memory_order_acquire); }
+  /**
+   * @brief 쓸 수 있는 바이트. 매핑이나 adopt() 한 메모리를 가리키면 처음 한 번 자기 버퍼로 복사한다.
+   *        복사는 다른 스레드가 이 Storage 를 읽지 않을 때 불러야 한다
+   */
+  void* mutableData();
+  /**
+   * @brief 바이트가 자기 버퍼에 있는가 (false 면 읽기 전용 매핑이나 adopt() 한 메모리)
+   */
+  bool ownsData() const { return loaded() && data_ == buffer_.data(); }
+
+  /**
+   * @brief 한 번만 버퍼를 잡고 채운다. fill 이 던지면 다음 호출이 다시 시도한다
+   */
+  void materialize(const Filler& fill) const;
+  /**
+   * @brief 복사하지 않고 data 를 바이트로 쓴다. owner 가 살아 있는 동안 data 가 유효해야 한다.
+   *        이미 채워졌으면 아무 일도 하지 않는다
+   */
+  void adopt(const void* data, std::shared_ptr<const void> owner);
+  void materialize(parser::ZipInflater& inflater) const;
+  void materialize() const {
+    if (!loaded()) {
+      materializeSlow();
+    }
+  }
+
+ private:
+  void materializeSlow() const;
+
+  std::string key_;
+  DType dtype_;
+  int64_t numel_;
+  std::string device_;
+  std::shared_ptr<const parser::ZipArchive> archive_;
+  const parser::ZipEntry* entry_ = nullptr;
+  mutable AlignedBuffer buffer_;
+  // buffer_, 아카이브 매핑, adopt() 한 메모리 중 하나. 매핑과 adopt() 한 메모리는 읽기 전용이다
+  mutable void* data_ = nullptr;
+  std::shared_ptr<const void> owner_;
+  mutable std::once_flag once_;
+  mutable std::atomic<bool> loaded_{false};
+};
+
+/**
+ * @brief Storage 위의 strided view (torch._utils._rebuild_tensor_v2 의 offset/sizes/strides)
+ */
+class Tensor {
+ public:
+  Tensor() = default;
+  Tensor(std::shared_ptr<Storage> storage, int64_t offset, std::vector<int64_t> sizes,
+         std::vector<int64_t> strides, bool requires_grad = false);
+
+  bool defined() const { return storage_ != nullptr; }
+  DType dtype() const { return storage_->dtype(); }
+  int64_t offset() const { return offset_; }
+  const std::vector<int64_t>& sizes() const { return sizes_; }
+  const std::vector<int64_t>& strides() const { return strides_; }
+  int64_t dim() const { return static_cast<int64_t>(sizes_.size()); }
+  int64_t size(int64_t d) const { return sizes_[d < 0 ? d + dim() : d]; }
+  int64_t numel() const;
+  bool requiresGrad() const { return requires_grad_; }
+  bool isContiguous() const;
+
+  void* data();
+  const void* data() const;
+  template <typename T>
+  T* data() {
+    return static_cast<T*>(data());
+  }
+  template <typename T>
+  const T* data() const {
+    return static_cast<const T*>(data());
+  }
+  /**
+   * @brief 쓸 수 있는 바이트 (Storage::mutableData()). 모델에서 읽은 텐서에 쓸 때는 이것을 쓴다
+   */
+  void* mutableData();
+  template <typename T>
+  T* mutableData() {
+    return static_cast<T*>(mutableData());
+  }
+
+  const std::shared_ptr<Storage>& storage() const { return storage_; }
+  bool sharesStorage(const Tensor& other) const { return storage_ == other.storage_; }
+
+ private:
+  std::shared_ptr<Storage> storage_;
+  int64_t offset_ = 0;
+  std::vector<int64_t> sizes_;
+  std::vector<int64_t> strides_;
+  bool requires_grad_ = false;
+};
+
+std::vector<int64_t> contiguousStrides(const std::vector<int64_t>& sizes);
+
+/**
+ * @brief 아카이브와 무관한 새 텐서 (연산 결과, 상수 변환). 버퍼는 바로 잡힌다
+ */
+Tensor empty(const std::vector<int64_t>& sizes, DType dtype = DType::FLOAT32,
+             const std::string& name = "");
+
+/**
+ * @brief 연속이면 그대로, 아니면 연속 복사본
+ */
+Tensor contiguous(const Tensor& src);
+
+}  // namespace tensor
+}  // namespace tfe
+
+#endif  // TFE_TENSOR_TENSOR_H_
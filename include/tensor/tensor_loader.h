@@ -0,0 +1,130 @@
+#ifndef TFE_TENSOR_TENSOR_LOADER_H_
+#define TFE_TENSOR_TENSOR_LOADER_H_
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "parser/parser_torch.h"
+#include "tensor/tensor.h"
+#include "util/thread_pool.h"
+#include "vm/value_pkl.h"
+#include "vm/visitor_pkl.h"
+
+namespace tfe {
+namespace tensor {
+
+/**
+ * @brief PickleVM::load() 결과에서 텐서를 복원한다
+ *
+ * BINPERSID 의 ('storage', torch.<Name>Storage, key, device, numel) 튜플은 <model>/data/<key>
+ * 레코드 하나로 매핑되고, key 가 같은 텐서는 같은 Storage 를 공유한다 (복사하지 않음).
+ * torch._utils._rebuild_tensor_v2 의 (storage, offset, sizes, strides, requires_grad, hooks) 가
+ * 그 위의 view 가 된다.
+ *
+ * storage() 는 엔트리 위치만 기록하고 바이트는 읽지 않는다. 텐서의 data() 를 처음 부를 때 읽히거나,
+ * load()/prefetch() 가 worker pool 에 나눠서 미리 채운다. worker 마다 ZipInflater 를 따로 가지므로
+ * DEFLATED 엔트리도 락 없이 동시에 풀린다.
+ *
+ * storage() 는 여러 스레드에서 불러도 된다 (constants.pkl 과 bytecode.pkl 을 동시에 디코딩하며 한
+ * loader 를 같이 쓴다). 같은 key 는 어느 스레드에서 먼저 보든 같은 Storage 가 된다.
+ */
+class TensorLoader {
+ public:
+  using NamedTensors = std::vector<std::pair<std::string, Tensor>>;
+
+  /**
+   * @brief 매핑을 쓸 수 없는 (정렬이 어긋난) STORED 레코드가 이보다 크면 memcpy 를 여러 worker 로 쪼갠다
+   */
+  static constexpr size_t kSplitBytes = 8 << 20;
+
+  /**
+   * @param num_threads 0 이면 hardware_concurrency(), 1 이면 호출 스레드에서만 읽는다
+   * @param record_dir storage key 가 가리키는 디렉터리. data.pkl 은 "data", constants.pkl 은 "constants"
+   */
+  explicit TensorLoader(const parser::TorchParser& parser, size_t num_threads = 0,
+                        std::string record_dir = "data");
+  ~TensorLoader();
+
+  std::shared_ptr<Storage> storage(const vm::Value& persistent_id);
+  Tensor tensor(const vm::Value& value);
+  bool isTensor(const vm::Value& value) const;
+
+  /**
+   * @brief 아직 읽지 않은 storage 를 모두 읽는다. worker 예외는 모두 끝난 뒤 첫 번째 것을 다시 던진다
+   */
+  void load();
+
+  /**
+   * @brief collect() 로 이름 붙은 텐서 중 prefix 서브트리 ("encoder" 면 encoder.*) 의 storage 만 읽는다
+   * @return 이번에 새로 읽은 storage 수
+   */
+  size_t prefetch(const std::string& prefix);
+  /**
+   * @brief 주어진 storage 중 아직 읽지 않은 것만 pool 로 읽는다 (e.g. ModuleGraph 서브트리)
+   */
+  size_t prefetch(std::vector<Storage*> storages);
+  /**
+   * @brief storages 읽기를 pool 에 걸고 바로 돌아온다. num_threads 가 1 이면 아무것도 하지 않는다.
+   *        실패한 storage 는 data() 가 다시 읽으므로 wait() 를 부르지 않아도 된다
+   */
+  void prefetchAsync(std::vector<Storage*> storages);
+  /**
+   * @brief prefetchAsync() 로 건 읽기가 모두 끝날 때까지 기다린다. 첫 예외를 다시 던진다
+   */
+  void wait();
+  size_t pending() const;
+
+  /**
+   * @brief 모듈 트리를 따라가며 텐서마다 "encoder.conv1.weight" 같은 점 경로 이름을 붙인다.
+   *        바이트는 읽지 않는다.
+   */
+  NamedTensors collect(const vm::Value& root);
+
+  /**
+   * @brief storage() 를 부르는 스레드가 없을 때만 쓴다
+   */
+  const std::unordered_map<std::string, std::shared_ptr<Storage>>& storages() const {
+    return storages_;
+  }
+
+ private:
+  void collect(const vm::Value& value, const std::string& prefix, NamedTensors* out);
+  /**
+   * @brief 처음 부를 때 pool 과 worker 마다의 ZipInflater 를 만든다
+   */
+  util::ThreadPool& pool();
+
+  const parser::TorchParser& parser_;
+  size_t num_threads_;
+  std::string record_dir_;
+  std::unique_ptr<util::ThreadPool> pool_;
+  std::vector<std::unique_ptr<parser::ZipInflater>> inflaters_;
+  std::vector<std::future<void>> inflight_;
+  mutable std::mutex storages_mutex_;  // storages_ 를 지킨다
+  std::unordered_map<std::string, std::shared_ptr<Storage>> storages_;
+  std::vector<std::pair<std::string, Storage*>> named_;
+};
+
+/**
+ * @brief PickleVM 이 persistent id 를 실행하는 대로 storage 를 잡고 prefetchAsync() 에 건다.
+ *        data.pkl 을 feed() 로 흘려 넣는 동안 앞쪽 텐서는 이미 읽히고 있다
+ */
+class PrefetchVisitor : public vm::PickleVisitor {
+ public:
+  explicit PrefetchVisitor(TensorLoader& loader) : loader_(loader) {}
+
+  void onPersistentId(const vm::Value& pid) override;
+
+ private:
+  TensorLoader& loader_;
+};
+
+}  // namespace tensor
+}  // namespace tfe
+
+#endif  // TFE_TENSOR_TENSOR_LOADER_H_
@@ -0,0 +1,179 @@
+#ifndef TFE_UTIL_LOAD_STATS_H_
+#define TFE_UTIL_LOAD_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tfe {
+namespace util {
+
+/**
+ * @brief 모델을 올리는 단계. 아카이브 하나를 읽으면 대략 이 순서로 지나간다
+ */
+enum class LoadPhase : uint8_t {
+  OPEN,               // open(2)
+  STAT,               // fstat(2)
+  MMAP,               // 아카이브 매핑
+  CENTRAL_DIRECTORY,  // EOCD 탐색 + central directory 파싱. bytes_in 은 directory 크기
+  SECTIONS,           // TorchParser::parse(): version / byteorder / *.pkl / code/ 찾기 (inflate 포함)
+  INFLATE,            // DEFLATED 엔트리 하나. bytes_in 은 압축, bytes_out 은 푼 크기
+  UNPICKLE,           // PickleVM::load() 한 번. bytes_in 은 pickle 크기
+  MATERIALIZE,        // TensorLoader 가 storage 묶음을 채운 한 번. bytes_out 은 storage 바이트
+  kCount,
+};
+
+enum class LoadCounter : uint8_t {
+  ZIP_ENTRIES,     // central directory 의 엔트리 수
+  PICKLE_OPCODES,  // 실행한 opcode 수 (STOP 포함)
+  PICKLE_MEMO,     // load() 가 끝났을 때 memo 크기의 합
+  STORAGES,        // 채운 storage 수
+  kCount,
+};
+
+const char* loadPhaseToString(LoadPhase phase);
+const char* loadCounterToString(LoadCounter counter);
+
+/**
+ * @brief 단계 하나의 합계
+ */
+struct PhaseStats {
+  uint64_t count     = 0;
+  int64_t nanos      = 0;
+  uint64_t bytes_in  = 0;
+  uint64_t bytes_out = 0;
+};
+
+/**
+ * @brief 단계 한 번. detail 은 엔트리 / 파일 이름
+ */
+struct LoadSpan {
+  LoadPhase phase;
+  std::string detail;
+  int64_t begin      = 0;  // global() 을 만든 때부터의 ns
+  int64_t nanos      = 0;
+  uint64_t bytes_in  = 0;
+  uint64_t bytes_out = 0;
+};
+
+/**
+ * @brief 콜드 스타트의 단계별 시간 / 바이트 / 카운터
+ *
+ * 단계 합계와 카운터는 atomic 이라 TensorLoader worker 들이 동시에 더해도 된다. 단계 한 번 한 번은
+ * kMaxSpans 개까지 span 으로도 남긴다 (이것만 mutex). 꺼져 있으면 (기본값) 기록하는 쪽은 enabled()
+ * 하나만 보고 돌아가므로 시각도 읽지 않는다.
+ */
+class LoadStats {
+ public:
+  static constexpr size_t kMaxSpans = 4096;
+
+  /**
+   * @brief 프로세스에 하나인 기록. parser / vm / tensor 는 모두 여기에 쓴다
+   */
+  static LoadStats& global();
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+  int64_t now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+               .count() -
+           origin_;
+  }
+
+  void record(LoadPhase phase, int64_t begin, int64_t nanos, uint64_t bytes_in = 0,
+              uint64_t bytes_out = 0, const std::string& detail = std::string());
+  void count(LoadCounter counter, uint64_t value) {
+    if (enabled()) {
+      counters_[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+  }
+
+  PhaseStats phase(LoadPhase phase) const;
+  uint64_t counter(LoadCounter counter) const {
+    return counters_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+  }
+  /**
+   * @brief 남긴 span 들, 시작 순
+   */
+  std::vector<LoadSpan> spans() const;
+  /**
+   * @brief span 자리가 차서 남기지 못한 단계 수 (합계에는 들어 있다)
+   */
+  uint64_t droppedSpans() const { return dropped_.load(std::memory_order_relaxed); }
+  void reset();
+
+  /**
+   * @brief 단계별 (count, ms, MB in / out, MB/s) 표와 카운터
+   */
+  std::string report() const;
+
+ private:
+  LoadStats();
+
+  struct Totals {
+    std::atomic<uint64_t> count{0};
+    std::atomic<int64_t> nanos{0};
+    std::atomic<uint64_t> bytes_in{0};
+    std::atomic<uint64_t> bytes_out{0};
+  };
+
+  std::atomic<bool> enabled_{false};
+  int64_t origin_ = 0;
+  std::array<Totals, static_cast<size_t>(LoadPhase::kCount)> phases_;
+  std::array<std::atomic<uint64_t>, static_cast<size_t>(LoadCounter::kCount)> counters_{};
+  mutable std::mutex spans_mutex_;
+  std::vector<LoadSpan> spans_;
+  std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * @brief 범위를 단계 한 번으로 LoadStats::global() 에 남긴다. 만들 때 꺼져 있으면 아무것도 하지 않는다
+ */
+class ScopedLoadPhase {
+ public:
+  explicit ScopedLoadPhase(LoadPhase phase, uint64_t bytes_in = 0, uint64_t bytes_out = 0)
+      : stats_(LoadStats::global()), phase_(phase), bytes_in_(bytes_in), bytes_out_(bytes_out) {
+    if (stats_.enabled()) {
+      begin_ = stats_.now();
+    }
+  }
+  ~ScopedLoadPhase() {
+    if (begin_ >= 0) {
+      stats_.record(phase_, begin_, stats_.now() - begin_, bytes_in_, bytes_out_, detail_);
+    }
+  }
+
+  ScopedLoadPhase(const ScopedLoadPhase&)            = delete;
+  ScopedLoadPhase& operator=(const ScopedLoadPhase&) = delete;
+
+  bool active() const { return begin_ >= 0; }
+  void setBytes(uint64_t bytes_in, uint64_t bytes_out) {
+    bytes_in_  = bytes_in;
+    bytes_out_ = bytes_out;
+  }
+  /**
+   * @brief 켜져 있을 때만 부른다 (문자열 복사)
+   */
+  void setDetail(std::string detail) { detail_ = std::move(detail); }
+
+ private:
+  LoadStats& stats_;
+  LoadPhase phase_;
+  int64_t begin_ = -1;
+  uint64_t bytes_in_;
+  uint64_t bytes_out_;
+  std::string detail_;
+};
+
+}  // namespace util
+}  // namespace tfe
+
+#endif  // TFE_UTIL_LOAD_STATS_H_
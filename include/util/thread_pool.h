@@ -0,0 +1,69 @@
+#ifndef TFE_UTIL_THREAD_POOL_H_
+#define TFE_UTIL_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tfe {
+namespace util {
+
+/**
+ * @brief 고정 크기 worker pool
+ *
+ * 각 worker 는 0..size()-1 의 고정 index 를 가지므로 task 가 worker 별 자원 (e.g. ZipInflater) 을
+ * 락 없이 골라 쓸 수 있다.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @param num_threads 0 이면 hardware_concurrency()
+   */
+  explicit ThreadPool(size_t num_threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&)            = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t size() const { return workers_.size(); }
+
+  /**
+   * @brief fn(worker_index) 를 큐에 넣는다. 예외는 future 로 전달된다.
+   */
+  template <typename Fn>
+  auto submit(Fn&& fn) -> std::future<std::invoke_result_t<Fn, size_t>> {
+    using Result = std::invoke_result_t<Fn, size_t>;
+    auto task    = std::make_shared<std::packaged_task<Result(size_t)>>(std::forward<Fn>(fn));
+    std::future<Result> future = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.emplace([task](size_t worker) { (*task)(worker); });
+    }
+    cv_.notify_one();
+    return future;
+  }
+
+  static size_t defaultThreads();
+
+ private:
+  void run(size_t worker);
+
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void(size_t)>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopping_ = false;
+};
+
+}  // namespace util
+}  // namespace tfe
+
+#endif  // TFE_UTIL_THREAD_POOL_H_
@@ -0,0 +1,123 @@
+#ifndef TFE_UTIL_WORK_STEALING_POOL_H_
+#define TFE_UTIL_WORK_STEALING_POOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tfe {
+namespace util {
+
+/**
+ * @brief 연산 하나 (conv, GEMM) 를 코어 여러 개로 나눠 도는 intra-op pool
+ *
+ * parallelFor() 는 [begin, end) 를 grain 크기 덩어리로 잘라 호출 스레드와 worker 에게 고르게 나눠 주고,
+ * 제 몫을 먼저 끝낸 쪽은 다른 쪽 몫의 뒤 절반을 훔쳐 온다. 호출 스레드도 worker 0 으로 같이 돈다.
+ * worker 는 일이 끝나면 spin 동안 다음 parallelFor 를 바쁘게 기다린 뒤에야 잠든다 (연달아 도는 layer
+ * 사이에 깨우는 지연이 없게).
+ * 여러 모델이 shared() 하나를 같이 쓰면 CPU 를 넘치게 쓰지 않는다. 다른 스레드가 pool 을 쓰는 중이면 그
+ * parallelFor 가 끝나기를 기다리고, parallelFor 안에서 다시 부르면 그 스레드 혼자 제 worker 번호로 돈다.
+ */
+class WorkStealingPool {
+ public:
+  /**
+   * @param num_threads 호출 스레드를 포함한 동시 실행 수. 0 이면 hardware_concurrency()
+   * @param pin worker i 를 허용된 CPU 중 i 번째에 고정한다 (Linux). 프로세스의 다른 pool 과 같은 CPU 에
+   *        겹쳐 고정될 수 있으므로 기본은 끄고 shared() 만 켠다
+   * @param spin 잠들기 전에 다음 일을 바쁘게 기다리는 시간
+   */
+  explicit WorkStealingPool(size_t num_threads = 0, bool pin = false,
+                            std::chrono::microseconds spin = std::chrono::microseconds(200));
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&)            = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  size_t concurrency() const { return concurrency_; }
+
+  /**
+   * @brief [begin, end) 를 겹치지 않게 덮는 구간 [lo, hi) 마다 fn(lo, hi, worker) 를 부르고 모두
+   *        끝나면 돌아온다
+   *
+   * 구간 길이는 grain 이다 (마지막 것만 짧을 수 있고, 혼자 돌 때는 전체가 한 번에 온다).
+   * worker 는 [0, concurrency()) 이고 같은 순간 같은 worker 로 도는 호출은 없으므로 worker 별 작업
+   * 버퍼를 고르는 데 쓴다. fn 의 첫 예외는 모든 구간이 끝난 뒤 다시 던진다.
+   */
+  template <typename Fn>
+  void parallelFor(int64_t begin, int64_t end, int64_t grain, Fn&& fn) {
+    using F = std::remove_reference_t<Fn>;
+    run(begin, end, grain,
+        [](const void* ctx, int64_t lo, int64_t hi, size_t worker) {
+          (*static_cast<F*>(const_cast<void*>(ctx)))(lo, hi, worker);
+        },
+        &fn);
+  }
+
+  static size_t defaultThreads();
+  /**
+   * @brief 프로세스에 하나인 pool (defaultThreads(), 고정, 기본 spin). 처음 부를 때 만든다
+   */
+  static std::shared_ptr<WorkStealingPool> shared();
+
+ private:
+  using Body = void (*)(const void* ctx, int64_t lo, int64_t hi, size_t worker);
+
+  /**
+   * @brief 덩어리 번호 [lo, hi) 를 64 bit 하나에 담는다. 주인은 앞에서, 도둑은 뒤에서 CAS 로 뗀다
+   */
+  struct alignas(64) Queue {
+    std::atomic<uint64_t> range{0};
+  };
+
+  void run(int64_t begin, int64_t end, int64_t grain, Body body, const void* ctx);
+  void work(size_t self);
+  /**
+   * @brief 제 queue 가 빌 때까지 돌고, 그다음 훔칠 것이 없을 때까지 훔친다
+   */
+  void drain(size_t self);
+  /**
+   * @brief 제 queue 의 맨 앞 덩어리. 비었으면 그때 본 값을 empty 에 남긴다
+   */
+  bool pop(size_t self, int64_t* chunk, uint64_t* empty);
+  /**
+   * @brief victim queue 의 뒤 절반을 가져온다. empty 는 pop() 이 마지막으로 본 제 queue 값
+   */
+  bool steal(size_t self, size_t victim, uint64_t empty, int64_t* chunk);
+  void execute(int64_t chunk, size_t self);
+
+  size_t concurrency_;
+  bool pin_;
+  std::chrono::microseconds spin_;
+  std::unique_ptr<Queue[]> queues_;
+  std::vector<std::thread> workers_;
+
+  // 지금 도는 parallelFor. job_mutex_ 를 잡은 호출 스레드만 쓰고, worker 는 덩어리를 뗀 뒤에 읽는다
+  std::mutex job_mutex_;
+  Body body_       = nullptr;
+  const void* ctx_ = nullptr;
+  int64_t begin_   = 0;
+  int64_t end_     = 0;
+  int64_t grain_   = 1;
+  std::atomic<int64_t> remaining_{0};  // 아직 끝나지 않은 덩어리 수
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+
+  std::atomic<uint64_t> epoch_{0};  // parallelFor 마다 1 씩. worker 는 바뀌기를 기다린다
+  std::atomic<bool> stopping_{false};
+  std::atomic<int> sleeping_{0};
+  std::mutex park_mutex_;
+  std::condition_variable park_cv_;
+};
+
+}  // namespace util
+}  // namespace tfe
+
+#endif  // TFE_UTIL_WORK_STEALING_POOL_H_
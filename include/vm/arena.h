@@ -0,0 +1,105 @@
+/**
+ * @brief Bump allocator owned by the pickle VM
+ */
+
+#ifndef TFE_VM_ARENA_H
+#define TFE_VM_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tfe {
+namespace vm {
+
+/**
+ * @brief Block based bump allocator. Everything is released at once by reset() or the destructor,
+ *        so only trivially destructible objects may live here.
+ */
+class Arena {
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit Arena(size_t block_size = kDefaultBlockSize) : block_size_(block_size) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    // the source is left empty; a defaulted move would keep its cur_/end_ pointing into blocks
+    // that now belong to this arena
+    Arena(Arena&& other) noexcept
+        : block_size_(other.block_size_),
+          bytes_reserved_(std::exchange(other.bytes_reserved_, 0)),
+          cur_(std::exchange(other.cur_, nullptr)),
+          end_(std::exchange(other.end_, nullptr)),
+          blocks_(std::move(other.blocks_)) {
+        other.blocks_.clear();
+    }
+    Arena& operator=(Arena&& other) noexcept {
+        if (this != &other) {
+            block_size_ = other.block_size_;
+            bytes_reserved_ = std::exchange(other.bytes_reserved_, 0);
+            cur_ = std::exchange(other.cur_, nullptr);
+            end_ = std::exchange(other.end_, nullptr);
+            blocks_ = std::move(other.blocks_);
+            other.blocks_.clear();
+        }
+        return *this;
+    }
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        uintptr_t cur = reinterpret_cast<uintptr_t>(cur_);
+        uintptr_t aligned = (cur + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        if (cur_ == nullptr || aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+            return allocateSlow(size, align);
+        }
+        cur_ = reinterpret_cast<char*>(aligned + size);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "arena arrays are relocated by memcpy");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    std::string_view copy(std::string_view bytes) {
+        if (bytes.empty()) {
+            return std::string_view();
+        }
+        char* dst = static_cast<char*>(allocate(bytes.size(), 1));
+        std::memcpy(dst, bytes.data(), bytes.size());
+        return std::string_view(dst, bytes.size());
+    }
+
+    void reset();
+
+    size_t bytesReserved() const { return bytes_reserved_; }
+    size_t blockCount() const { return blocks_.size(); }
+
+private:
+    void* allocateSlow(size_t size, size_t align);
+
+    size_t block_size_;
+    size_t bytes_reserved_ = 0;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+};
+
+} // namespace vm
+} // namespace tfe
+
+#endif // TFE_VM_ARENA_H
@@ -0,0 +1,198 @@
+/**
+ * @brief Tagged values materialized by the pickle VM
+ */
+
+#ifndef TFE_VM_VALUE_PKL_H
+#define TFE_VM_VALUE_PKL_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "vm/arena.h"
+
+namespace tfe {
+namespace vm {
+
+enum class ValueType : uint8_t {
+    NONE,
+    BOOL,
+    INT,
+    FLOAT,
+    STRING,
+    BYTES,
+    TUPLE,
+    LIST,
+    DICT,
+    GLOBAL,
+    OBJECT,
+    PERSISTENT_ID,
+};
+
+const char* valueTypeToString(ValueType type);
+
+struct Sequence;
+struct Dict;
+struct Global;
+struct Object;
+struct PersistentId;
+
+/**
+ * @brief 16 byte tagged value. Payloads that do not fit live in the VM's arena, so a Value is only
+ *        valid while the PickleVM that produced it is alive.
+ */
+class Value {
+public:
+    Value() : type_(ValueType::NONE), length_(0), i_(0) {}
+
+    static Value none() { return Value(); }
+    static Value boolean(bool b) { Value v(ValueType::BOOL); v.b_ = b; return v; }
+    static Value integer(int64_t i) { Value v(ValueType::INT); v.i_ = i; return v; }
+    static Value real(double f) { Value v(ValueType::FLOAT); v.f_ = f; return v; }
+    static Value string(std::string_view s) { return bytesOf(ValueType::STRING, s); }
+    static Value bytes(std::string_view s) { return bytesOf(ValueType::BYTES, s); }
+    static Value tuple(Sequence* seq) { Value v(ValueType::TUPLE); v.seq_ = seq; return v; }
+    static Value list(Sequence* seq) { Value v(ValueType::LIST); v.seq_ = seq; return v; }
+    static Value dict(Dict* dict) { Value v(ValueType::DICT); v.dict_ = dict; return v; }
+    static Value global(Global* g) { Value v(ValueType::GLOBAL); v.global_ = g; return v; }
+    static Value object(Object* o) { Value v(ValueType::OBJECT); v.object_ = o; return v; }
+    static Value persistentId(PersistentId* p) {
+        Value v(ValueType::PERSISTENT_ID);
+        v.pid_ = p;
+        return v;
+    }
+
+    ValueType type() const { return type_; }
+    const char* typeName() const { return valueTypeToString(type_); }
+
+    bool isNone() const { return type_ == ValueType::NONE; }
+    bool isBool() const { return type_ == ValueType::BOOL; }
+    bool isInt() const { return type_ == ValueType::INT; }
+    bool isFloat() const { return type_ == ValueType::FLOAT; }
+    bool isString() const { return type_ == ValueType::STRING; }
+    bool isBytes() const { return type_ == ValueType::BYTES; }
+    bool isTuple() const { return type_ == ValueType::TUPLE; }
+    bool isList() const { return type_ == ValueType::LIST; }
+    bool isDict() const { return type_ == ValueType::DICT; }
+    bool isGlobal() const { return type_ == ValueType::GLOBAL; }
+    bool isObject() const { return type_ == ValueType::OBJECT; }
+    bool isPersistentId() const { return type_ == ValueType::PERSISTENT_ID; }
+
+    bool toBool() const { expect(ValueType::BOOL); return b_; }
+    int64_t toInt() const { expect(ValueType::INT); return i_; }
+    double toDouble() const;
+    std::string_view toStringView() const { expect(ValueType::STRING); return {str_, length_}; }
+    std::string_view toBytes() const { expect(ValueType::BYTES); return {str_, length_}; }
+    Sequence& toTuple() const { expect(ValueType::TUPLE); return *seq_; }
+    Sequence& toList() const { expect(ValueType::LIST); return *seq_; }
+    Sequence& toSequence() const;
+    Dict& toDict() const { expect(ValueType::DICT); return *dict_; }
+    Global& toGlobal() const { expect(ValueType::GLOBAL); return *global_; }
+    Object& toObject() const { expect(ValueType::OBJECT); return *object_; }
+    PersistentId& toPersistentId() const { expect(ValueType::PERSISTENT_ID); return *pid_; }
+
+    /**
+     * @brief Identity for containers, equality for scalars/strings (used for dict keys).
+     */
+    bool equals(const Value& other) const;
+
+private:
+    explicit Value(ValueType type) : type_(type), length_(0), i_(0) {}
+
+    static Value bytesOf(ValueType type, std::string_view s) {
+        if (s.size() > UINT32_MAX) {
+            throw std::runtime_error("Pickle string larger than 4GB");
+        }
+        Value v(type);
+        v.str_ = s.data();
+        v.length_ = static_cast<uint32_t>(s.size());
+        return v;
+    }
+
+    void expect(ValueType type) const {
+        if (type_ != type) {
+            throw std::runtime_error(std::string("Expected pickle ") + valueTypeToString(type) +
+                                     " but got " + valueTypeToString(type_));
+        }
+    }
+
+    ValueType type_;
+    uint32_t length_;
+    union {
+        bool b_;
+        int64_t i_;
+        double f_;
+        const char* str_;
+        Sequence* seq_;
+        Dict* dict_;
+        Global* global_;
+        Object* object_;
+        PersistentId* pid_;
+    };
+};
+
+static_assert(sizeof(Value) == 16, "Value is expected to stay compact");
+
+/**
+ * @brief Backing store of tuple/list (and set/frozenset, which we never need to hash)
+ */
+struct Sequence {
+    Value* items = nullptr;
+    uint32_t size = 0;
+    uint32_t capacity = 0;
+
+    const Value& operator[](size_t i) const { return items[i]; }
+    const Value* begin() const { return items; }
+    const Value* end() const { return items + size; }
+    bool empty() const { return size == 0; }
+
+    void push(Arena& arena, const Value& value);
+};
+
+/**
+ * @brief Insertion ordered dict. Module state dicts are small, so lookups are a linear scan.
+ */
+struct Dict {
+    Value* keys = nullptr;
+    Value* values = nullptr;
+    uint32_t size = 0;
+    uint32_t capacity = 0;
+
+    /**
+     * @brief Append without a duplicate check, for callers that know the key is new
+     */
+    void append(Arena& arena, const Value& key, const Value& value);
+    /**
+     * @brief Overwrite the value of an equal key or append. The VM uses this so that a repeated
+     *        key keeps the last value, as Python's unpickler does.
+     */
+    void set(Arena& arena, const Value& key, const Value& value);
+    const Value* find(std::string_view key) const;
+};
+
+struct Global {
+    std::string_view module;
+    std::string_view name;
+
+    bool is(std::string_view m, std::string_view n) const { return module == m && name == n; }
+};
+
+/**
+ * @brief Result of REDUCE/NEWOBJ: the callable and its arguments, plus the BUILD state if any.
+ *        Interpreting these (e.g. torch._utils._rebuild_tensor_v2) is left to the caller.
+ */
+struct Object {
+    Value cls;
+    Value args;
+    Value state;
+};
+
+struct PersistentId {
+    Value id;
+};
+
+} // namespace vm
+} // namespace tfe
+
+#endif // TFE_VM_VALUE_PKL_H
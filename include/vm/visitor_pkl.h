@@ -0,0 +1,38 @@
+/**
+ * @brief Event callbacks of the pickle VM
+ */
+
+#ifndef TFE_VM_VISITOR_PKL_H
+#define TFE_VM_VISITOR_PKL_H
+
+#include "vm/value_pkl.h"
+
+namespace tfe {
+namespace vm {
+
+/**
+ * @brief Called while opcodes execute, so consumers can act before the pickle is complete
+ *        (e.g. start reading data/<key> as soon as its persistent id shows up). Values are only
+ *        valid as long as the emitting PickleVM.
+ */
+class PickleVisitor {
+public:
+    virtual ~PickleVisitor() = default;
+
+    // GLOBAL / STACK_GLOBAL / INST
+    virtual void onGlobal(const Global& /*global*/) {}
+    // BINPERSID / PERSID, e.g. ('storage', torch.FloatStorage, '0', 'cpu', 64)
+    virtual void onPersistentId(const Value& /*pid*/) {}
+    // REDUCE / NEWOBJ result, e.g. torch._utils._rebuild_tensor_v2(...)
+    virtual void onObject(const Value& /*object*/) {}
+    // SETITEM / SETITEMS / DICT
+    virtual void onDictEntry(const Value& /*dict*/, const Value& /*key*/, const Value& /*value*/) {}
+    // BUILD, after the state has been attached
+    virtual void onBuild(const Value& /*object*/) {}
+    virtual void onStop(const Value& /*root*/) {}
+};
+
+} // namespace vm
+} // namespace tfe
+
+#endif // TFE_VM_VISITOR_PKL_H
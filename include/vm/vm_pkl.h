@@ -5,32 +5,192 @@
 #ifndef TFE_VM_VM_PKL_H
 #define TFE_VM_VM_PKL_H
 
+#include "vm/arena.h"
 #include "vm/op_pkl.h"
+#include "vm/value_pkl.h"
+#include "vm/visitor_pkl.h"
+#include <algorithm>
+#include <initializer_list>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <stdexcept>
+
+#if defined(TFE_PKL_COMPUTED_GOTO) && TFE_PKL_COMPUTED_GOTO && \
+    (defined(__GNUC__) || defined(__clang__))
+#define TFE_PKL_HAS_COMPUTED_GOTO 1
+#else
+#define TFE_PKL_HAS_COMPUTED_GOTO 0
+#endif
 
 namespace tfe {
 namespace vm {
 
+/**
+ * @brief Raised when an opcode needs more bytes than are available. In streaming mode it only
+ *        means "wait for the next chunk"; otherwise it is an ordinary truncated-pickle error.
+ */
+class PickleUnderflow : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
 class PickleVM {
 public:
-    PickleVM(const std::vector<char>& data) : data_(data), pos_(0) {}
+    /**
+     * @brief Opcode dispatch strategy of load(). All three run the same handlers; COMPUTED_GOTO
+     *        falls back to TABLE when the build does not enable TFE_PKL_COMPUTED_GOTO.
+     */
+    enum class Dispatch : uint8_t {
+        SWITCH,
+        TABLE,
+        COMPUTED_GOTO,
+    };
+
+    static constexpr Dispatch kDefaultDispatch =
+        TFE_PKL_HAS_COMPUTED_GOTO ? Dispatch::COMPUTED_GOTO : Dispatch::TABLE;
 
+
+    PickleVM(const std::vector<char>& data) : data_(data.data()), size_(data.size()), pos_(0) {}
+    explicit PickleVM(std::string_view data) : data_(data.data()), size_(data.size()), pos_(0) {}
+
+    /**
+     * @brief Streaming mode: no input up front, bytes arrive through feed(). Strings are copied
+     *        into the arena since the input chunks are not retained.
+     */
+    explicit PickleVM(PickleVisitor* visitor)
+        : data_(nullptr), size_(0), pos_(0), visitor_(visitor), streaming_(true) {}
+
+    /**
+     * @brief Disassemble the pickle into one display string per opcode
+     */
     std::vector<std::string> parse();
 
+    /**
+     * @brief Execute the pickle and return the object left by STOP. Returned values point into
+     *        this VM's arena and into the input buffer (strings are not copied), so both must
+     *        outlive them.
+     */
+    Value load(Dispatch dispatch = kDefaultDispatch);
+
+    static bool supports(Dispatch dispatch);
+
+    /**
+     * @brief Push the next chunk (streaming mode). Every complete opcode is executed right away;
+     *        a partial opcode, or a FRAME that is not fully buffered yet, waits for more input.
+     */
+    void feed(const char* bytes, size_t size);
+
+    /**
+     * @brief End of input (streaming mode). Throws unless STOP has been executed.
+     */
+    Value finish();
+
+    bool done() const { return stopped_; }
+    size_t bufferedBytes() const { return size_ - pos_; }
+
+    void setVisitor(PickleVisitor* visitor) { visitor_ = visitor; }
+
+    Arena& arena() { return arena_; }
+    size_t memoSize() const { return memo_.size(); }
+    /**
+     * @brief Opcodes executed by the last load() (or fed so far in streaming mode), STOP included
+     */
+    size_t opcodeCount() const { return opcodes_; }
+
 private:
-    const std::vector<char>& data_;
+    // longest fixed size operand (FRAME, BINUNICODE8, ...) an unchecked handler may read
+    static constexpr size_t kMaxFixedOperand = 8;
+
+    const char* data_;
+    size_t size_;
     size_t pos_;
+    // inside a validated FRAME, opcodes before this offset run without bounds checks
+    size_t fast_end_ = 0;
+
+    Arena arena_;
+    std::vector<Value> stack_;
+    std::vector<size_t> marks_;
+    std::vector<Value> memo_;
+    Value result_;
+    bool stopped_ = false;
+    size_t opcodes_ = 0;
+
+    PickleVisitor* visitor_ = nullptr;
+    bool streaming_ = false;
+    std::vector<char> stream_buf_;
+
+    void pump();
+
+    using Handler = void (PickleVM::*)();
+    struct DispatchTable {
+        Handler handlers[256];
+    };
+    template <bool kChecked>
+    static constexpr DispatchTable makeDispatchTable();
+    static const DispatchTable kCheckedTable;
+    static const DispatchTable kUncheckedTable;
+
+    template <bool kChecked>
+    void stepSwitch();
+    void runSwitch();
+    void runTable();
+    void runComputedGoto();
+
+    // one handler per opcode, generated from TFE_PKL_OPCODES
+#define TFE_PKL_DECLARE_HANDLER(name, code) \
+    template <bool kChecked>                \
+    void exec##name();
+    TFE_PKL_OPCODES(TFE_PKL_DECLARE_HANDLER)
+#undef TFE_PKL_DECLARE_HANDLER
+    void execUnknown();
+
+    /**
+     * @brief Little endian fixed width read with a single bounds check (none when kChecked is
+     *        false, i.e. inside a frame validated by FRAME).
+     */
+    template <typename T, bool kChecked = true>
+    T readLE() {
+        if (kChecked && sizeof(T) > size_ - pos_) {
+            throw PickleUnderflow("Unexpected end of pickle data");
+        }
+        T value;
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        value = byteSwap(value);
+#endif
+        return value;
+    }
+
+    template <typename T>
+    static T byteSwap(T value) {
+        T swapped;
+        const char* src = reinterpret_cast<const char*>(&value);
+        char* dst = reinterpret_cast<char*>(&swapped);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            dst[i] = src[sizeof(T) - 1 - i];
+        }
+        return swapped;
+    }
+
+    static uint64_t byteSwap64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_bswap64(value);
+#else
+        return byteSwap(value);
+#endif
+    }
 
     // read byte per type (cstdint)
     uint8_t readByte();
     uint16_t readUint16();
     uint32_t readUint32();
     int32_t readInt32();
-    std::string readLine();
-    std::string readBytes(size_t count);
+    std::string_view readLine();
+    std::string_view readBytes(size_t count);
+    int64_t parseInteger(std::string_view text) const;
 
     // parse logic by opcode
     std::string parseProto();
@@ -58,9 +218,30 @@ private:
     std::string parseFrame();
     std::string parseMemoize();
 
+    // execution helpers
+    void push(const Value& value) { stack_.push_back(value); }
+    Value pop();
+    Value& top();
+    size_t popMark();
+    Sequence* collect(size_t from);
+    std::string_view keep(std::string_view bytes) {
+        return streaming_ ? arena_.copy(bytes) : bytes;
+    }
+    Value makeString(std::string_view bytes) { return Value::string(keep(bytes)); }
+    Value makeBytes(std::string_view bytes) { return Value::bytes(keep(bytes)); }
+    Value makeGlobal(std::string_view module, std::string_view name);
+    Value makeObject(const Value& cls, const Value& args);
+    Value makeTuple(std::initializer_list<Value> items);
+    void memoPut(size_t index);
+    Value memoGet(size_t index) const;
+    void setItems(size_t from);
+    void appendItems(size_t from);
+    void build();
+    int64_t decodeLong(std::string_view bytes) const;
+
     // Utility
-    std::string bytesToHex(const std::string& bytes);
-    bool hasMore() const { return pos_ < data_.size(); }
+    std::string bytesToHex(std::string_view bytes);
+    bool hasMore() const { return pos_ < size_; }
 };
 
 } // namespace vm
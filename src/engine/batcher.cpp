@@ -0,0 +1,465 @@
+#include "engine/batcher.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "engine/lowering.h"
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+int64_t numel(const std::vector<int64_t>& sizes) {
+  int64_t n = 1;
+  for (int64_t s : sizes) {
+    n *= s;
+  }
+  return n;
+}
+
+std::vector<std::vector<int64_t>> withBatch(std::vector<std::vector<int64_t>> shapes,
+                                            size_t batch) {
+  for (std::vector<int64_t>& shape : shapes) {
+    shape[0] = static_cast<int64_t>(batch);
+  }
+  return shapes;
+}
+
+/**
+ * @return n 바이트를 다 읽었으면 true, 그 전에 EOF 면 false
+ */
+bool readAll(int fd, void* data, size_t n) {
+  char* p = static_cast<char*>(data);
+  while (n > 0) {
+    const ssize_t got = ::read(fd, p, n);
+    if (got < 0 && errno == EINTR) {
+      continue;
+    }
+    if (got <= 0) {
+      return false;
+    }
+    p += got;
+    n -= static_cast<size_t>(got);
+  }
+  return true;
+}
+
+bool writeAll(int fd, const void* data, size_t n) {
+  const char* p = static_cast<const char*>(data);
+  while (n > 0) {
+    const ssize_t put = ::write(fd, p, n);
+    if (put < 0 && errno == EINTR) {
+      continue;
+    }
+    if (put <= 0) {
+      return false;
+    }
+    p += put;
+    n -= static_cast<size_t>(put);
+  }
+  return true;
+}
+
+bool writeFrame(int fd, uint32_t status, const void* payload, size_t bytes) {
+  const uint32_t header[2] = {status, static_cast<uint32_t>(bytes)};
+  return writeAll(fd, header, sizeof(header)) && writeAll(fd, payload, bytes);
+}
+
+/**
+ * @brief serveUnixSocket() 의 연결 스레드들. 스레드가 batcher 를 참조하므로 detach 하지 않고,
+ *        serveUnixSocket() 이 돌아오기 전에 남은 연결을 끊고 모두 join 한다
+ */
+class ConnectionThreads {
+ public:
+  ~ConnectionThreads() { stopAll(); }
+
+  void start(Batcher& batcher, int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reapFinished();
+    connections_.emplace_back();
+    Connection* connection = &connections_.back();
+    connection->fd         = fd;
+    try {
+      connection->thread = std::thread([this, &batcher, connection] {
+        serveStream(batcher, connection->fd, connection->fd);
+        std::lock_guard<std::mutex> lock(mutex_);
+        ::close(connection->fd);
+        connection->finished = true;
+      });
+    } catch (...) {
+      connections_.pop_back();
+      throw;
+    }
+  }
+
+  /**
+   * @brief 아직 열린 연결을 shutdown 해 serveStream() 의 읽기와 쓰기를 끝내고 모두 join 한다
+   */
+  void stopAll() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (Connection& connection : connections_) {
+        if (!connection.finished) {
+          ::shutdown(connection.fd, SHUT_RDWR);
+        }
+      }
+    }
+    for (Connection& connection : connections_) {
+      connection.thread.join();
+    }
+    connections_.clear();
+  }
+
+ private:
+  struct Connection {
+    int fd        = -1;
+    bool finished = false;  // fd 를 닫았다. mutex_ 로 지킨다
+    std::thread thread;
+  };
+
+  // mutex_ 를 잡고 부른다. finished 인 스레드는 곧 끝나므로 join 이 오래 걸리지 않는다
+  void reapFinished() {
+    for (auto it = connections_.begin(); it != connections_.end();) {
+      if (it->finished) {
+        it->thread.join();
+        it = connections_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::list<Connection> connections_;
+};
+
+}  // namespace
+
+Batcher::Batcher(GraphFactory factory, std::vector<std::vector<int64_t>> sample_shapes,
+                 BatcherOptions options)
+    : options_(std::move(options)), sample_shapes_(std::move(sample_shapes)) {
+  if (options_.max_batch == 0 || sample_shapes_.empty()) {
+    throw std::invalid_argument("Batcher needs max_batch >= 1 and at least one input");
+  }
+  for (const std::vector<int64_t>& shape : sample_shapes_) {
+    if (shape.empty() || shape[0] != 1) {
+      throw std::invalid_argument("Batcher input shapes must have batch 1 in dimension 0");
+    }
+  }
+  // bucket 들이 pool 하나를 같이 써야 코어를 넘치게 쓰지 않는다
+  if (!options_.engine.pool) {
+    options_.engine.pool = util::WorkStealingPool::shared();
+  }
+
+  std::vector<size_t> sizes;
+  for (size_t size = 1; size < options_.max_batch; size *= 2) {
+    sizes.push_back(size);
+  }
+  sizes.push_back(options_.max_batch);
+
+  for (size_t size : sizes) {
+    const std::vector<std::vector<int64_t>> shapes = withBatch(sample_shapes_, size);
+    Bucket bucket;
+    bucket.size   = size;
+    bucket.engine = std::make_unique<Engine>(factory(shapes), options_.engine);
+    for (const std::vector<int64_t>& shape : shapes) {
+      bucket.inputs.push_back(tensor::empty(shape));
+    }
+    const Graph& graph = bucket.engine->graph();
+    for (int32_t output : graph.outputs) {
+      const std::vector<int64_t>& sizes_out = graph.slots[output].sizes;
+      if (sizes_out.empty() || sizes_out[0] != static_cast<int64_t>(size)) {
+        throw std::invalid_argument("Batcher output " + graph.slots[output].name +
+                                    " does not have the batch in dimension 0");
+      }
+      if (size == 1) {
+        output_shapes_.push_back(sizes_out);
+      }
+    }
+    buckets_.push_back(std::move(bucket));
+  }
+
+  worker_ = std::thread([this] { loop(); });
+}
+
+Batcher::Batcher(const model::ScriptModel& model, std::vector<std::vector<int64_t>> sample_shapes,
+                 BatcherOptions options)
+    : Batcher([&model](const std::vector<std::vector<int64_t>>& shapes) {
+                return lower(model, shapes);
+              },
+              std::move(sample_shapes), std::move(options)) {}
+
+Batcher::~Batcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  ready_.notify_all();
+  worker_.join();
+}
+
+std::future<std::vector<tensor::Tensor>> Batcher::submit(std::vector<tensor::Tensor> inputs) {
+  if (inputs.size() != sample_shapes_.size()) {
+    throw std::invalid_argument("Batcher expects " + std::to_string(sample_shapes_.size()) +
+                                " inputs, got " + std::to_string(inputs.size()));
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (inputs[i].dtype() != tensor::DType::FLOAT32 || inputs[i].sizes() != sample_shapes_[i]) {
+      throw std::invalid_argument("Batcher input " + std::to_string(i) +
+                                  " does not match the batch 1 float32 shape");
+    }
+  }
+
+  Request request;
+  request.inputs  = std::move(inputs);
+  request.arrival = std::chrono::steady_clock::now();
+  std::future<std::vector<tensor::Tensor>> result = request.promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(request));
+  }
+  ready_.notify_one();
+  return result;
+}
+
+BatcherStats Batcher::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void Batcher::loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    ready_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    // 가장 오래된 요청의 기한까지 배치가 차기를 기다린다. 멈출 때는 기다리지 않고 남은 것을 돌린다
+    const auto deadline = queue_.front().arrival + options_.max_delay;
+    ready_.wait_until(lock, deadline,
+                      [this] { return stop_ || queue_.size() >= options_.max_batch; });
+
+    std::vector<Request> batch;
+    const size_t count = std::min(queue_.size(), options_.max_batch);
+    for (size_t i = 0; i < count; ++i) {
+      batch.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    lock.unlock();
+    runBatch(batch);
+    lock.lock();
+  }
+}
+
+void Batcher::runBatch(std::vector<Request>& batch) {
+  Bucket* bucket = &buckets_.back();
+  for (Bucket& b : buckets_) {
+    if (b.size >= batch.size()) {
+      bucket = &b;
+      break;
+    }
+  }
+
+  std::vector<std::vector<tensor::Tensor>> results(batch.size());
+  try {
+    for (size_t k = 0; k < sample_shapes_.size(); ++k) {
+      const size_t sample = static_cast<size_t>(numel(sample_shapes_[k]));
+      float* dst          = bucket->inputs[k].data<float>();
+      for (size_t r = 0; r < batch.size(); ++r) {
+        const tensor::Tensor& input = batch[r].inputs[k];
+        const tensor::Tensor packed = input.isContiguous() ? input : tensor::contiguous(input);
+        std::memcpy(dst + r * sample, packed.data(), sample * sizeof(float));
+      }
+      std::fill(dst + batch.size() * sample, dst + bucket->size * sample, 0.0f);
+    }
+
+    const std::vector<tensor::Tensor>& outputs = bucket->engine->run(bucket->inputs);
+    for (size_t k = 0; k < outputs.size(); ++k) {
+      const size_t sample = static_cast<size_t>(numel(output_shapes_[k]));
+      const float* src    = outputs[k].data<float>();
+      for (size_t r = 0; r < batch.size(); ++r) {
+        tensor::Tensor out = tensor::empty(output_shapes_[k]);
+        std::memcpy(out.data(), src + r * sample, sample * sizeof(float));
+        results[r].push_back(std::move(out));
+      }
+    }
+  } catch (...) {
+    const std::exception_ptr error = std::current_exception();
+    for (Request& request : batch) {
+      request.promise.set_exception(error);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.requests += batch.size();
+    stats_.batches += 1;
+    stats_.padded += bucket->size - batch.size();
+  }
+  for (size_t r = 0; r < batch.size(); ++r) {
+    batch[r].promise.set_value(std::move(results[r]));
+  }
+}
+
+void serveStream(Batcher& batcher, int in_fd, int out_fd, size_t max_inflight) {
+  struct Pending {
+    std::future<std::vector<tensor::Tensor>> result;
+    std::string error;  // 비어 있지 않으면 batcher 에 넣지 못한 요청
+  };
+
+  size_t request_bytes = 0;
+  for (const std::vector<int64_t>& shape : batcher.sampleShapes()) {
+    request_bytes += static_cast<size_t>(numel(shape)) * sizeof(float);
+  }
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<Pending> pending;
+  bool done = false;
+
+  // 응답은 요청 순서대로 쓴다. 쓰기가 끊겨도 future 는 끝까지 받아 batcher 를 막지 않는다
+  std::thread writer([&] {
+    bool broken = false;
+    std::vector<float> payload;
+    while (true) {
+      Pending next;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return done || !pending.empty(); });
+        if (pending.empty()) {
+          return;
+        }
+        next = std::move(pending.front());
+        pending.pop_front();
+      }
+      changed.notify_all();
+
+      std::string error = next.error;
+      payload.clear();
+      if (error.empty()) {
+        try {
+          for (const tensor::Tensor& out : next.result.get()) {
+            const float* data = out.data<float>();
+            payload.insert(payload.end(), data, data + out.numel());
+          }
+        } catch (const std::exception& e) {
+          error = e.what();
+        }
+      }
+      if (!broken) {
+        broken = error.empty()
+                     ? !writeFrame(out_fd, 0, payload.data(), payload.size() * sizeof(float))
+                     : !writeFrame(out_fd, 1, error.data(), error.size());
+      }
+    }
+  });
+
+  std::vector<char> buffer(request_bytes);
+  while (true) {
+    uint32_t bytes = 0;
+    if (!readAll(in_fd, &bytes, sizeof(bytes))) {
+      break;
+    }
+    Pending request;
+    if (bytes != request_bytes) {
+      // frame 경계를 지키려고 payload 는 읽어서 버린다. 요청 크기가 0 이어도 진행하도록 버퍼를 따로 둔다
+      char discard[4096];
+      bool eof = false;
+      for (uint32_t left = bytes; left > 0 && !eof;) {
+        const size_t chunk = std::min<size_t>(left, sizeof(discard));
+        eof                = !readAll(in_fd, discard, chunk);
+        left -= static_cast<uint32_t>(chunk);
+      }
+      if (eof) {
+        break;
+      }
+      request.error = "request has " + std::to_string(bytes) + " bytes, expected " +
+                      std::to_string(request_bytes);
+    } else {
+      if (!readAll(in_fd, buffer.data(), buffer.size())) {
+        break;
+      }
+      std::vector<tensor::Tensor> inputs;
+      size_t offset = 0;
+      for (const std::vector<int64_t>& shape : batcher.sampleShapes()) {
+        tensor::Tensor input = tensor::empty(shape);
+        const size_t size    = static_cast<size_t>(input.numel()) * sizeof(float);
+        std::memcpy(input.data(), buffer.data() + offset, size);
+        offset += size;
+        inputs.push_back(std::move(input));
+      }
+      request.result = batcher.submit(std::move(inputs));
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return pending.size() < max_inflight; });
+    pending.push_back(std::move(request));
+    lock.unlock();
+    changed.notify_all();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  changed.notify_all();
+  writer.join();
+}
+
+void serveUnixSocket(Batcher& batcher, const std::string& path) {
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+    throw std::invalid_argument("Invalid unix socket path: " + path);
+  }
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to create socket: " + std::string(std::strerror(errno)));
+  }
+  ::unlink(path.c_str());
+  if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      ::listen(fd, SOMAXCONN) != 0) {
+    const std::string reason = std::strerror(errno);
+    ::close(fd);
+    throw std::runtime_error("Failed to listen on " + path + ": " + reason);
+  }
+
+  ConnectionThreads threads;
+  while (true) {
+    const int connection = ::accept(fd, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      const std::string reason = std::strerror(errno);
+      ::close(fd);
+      threads.stopAll();
+      throw std::runtime_error("Failed to accept on " + path + ": " + reason);
+    }
+    try {
+      threads.start(batcher, connection);
+    } catch (...) {
+      ::close(connection);
+      ::close(fd);
+      throw;
+    }
+  }
+}
+
+}  // namespace engine
+}  // namespace tfe
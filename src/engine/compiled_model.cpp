@@ -0,0 +1,654 @@
+#include "engine/compiled_model.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+#include <utility>
+
+#include "engine/lowering.h"
+#include "engine/quantization.h"
+#include "error/error.h"
+#include "model/script_model.h"
+#include "parser/zip_archive.h"
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+constexpr char kMagic[8]        = {'T', 'F', 'E', 'M', 'O', 'D', 'E', 'L'};
+constexpr uint32_t kByteOrder   = 0x01020304;
+constexpr size_t kBlobAlignment = tensor::AlignedBuffer::kAlignment;
+
+/**
+ * @brief 파일 맨 앞 64 byte. 메타데이터는 바로 뒤, blob 은 data_offset 부터 온다
+ */
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;  // kByteOrder 를 쓴 host 순서 그대로
+  uint64_t source_hash;
+  uint64_t file_size;
+  uint64_t meta_size;
+  uint64_t meta_hash;
+  uint64_t data_offset;
+  uint8_t isa;
+  uint8_t reserved[7];
+};
+static_assert(sizeof(FileHeader) == 64, "compiled model header must stay 64 bytes");
+
+size_t alignBlob(size_t n) { return (n + kBlobAlignment - 1) / kBlobAlignment * kBlobAlignment; }
+
+uint64_t mix(uint64_t h, uint64_t v) {
+  h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+  return h;
+}
+
+/**
+ * @brief 8 byte 씩 FNV-1a 처럼 섞고 murmur3 fmix64 로 마무리한다
+ */
+uint64_t hashBytes(const char* data, size_t size) {
+  uint64_t h = 0xcbf29ce484222325ull ^ size;
+  size_t i   = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    h = (h ^ word) * 0x100000001b3ull;
+  }
+  for (; i < size; ++i) {
+    h = (h ^ static_cast<uint8_t>(data[i])) * 0x100000001b3ull;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+[[noreturn]] void corrupt(const std::string& file_name, const std::string& what) {
+  throw error::ParserException(error::PARSE_ERROR,
+                               "Invalid compiled model " + file_name + ": " + what);
+}
+
+/**
+ * @return sizes 의 원소 수. 음수인 크기가 있거나 limit 를 넘으면 (곱이 넘치기 전에) -1
+ */
+int64_t checkedNumel(const std::vector<int64_t>& sizes, uint64_t limit) {
+  uint64_t numel = 1;
+  for (int64_t s : sizes) {
+    if (s < 0) {
+      return -1;
+    }
+    if (s != 0 && numel > limit / static_cast<uint64_t>(s)) {
+      return -1;
+    }
+    numel *= static_cast<uint64_t>(s);
+  }
+  return numel > limit ? -1 : static_cast<int64_t>(numel);
+}
+
+/**
+ * @brief 메타데이터를 쌓는다. 값은 host byte order 그대로다 (헤더의 byte_order 로 검사)
+ */
+class MetaWriter {
+ public:
+  template <typename T>
+  void pod(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "metadata must be trivially copyable");
+    bytes_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  template <typename T>
+  void array(const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable<T>::value, "metadata must be trivially copyable");
+    pod<uint64_t>(values.size());
+    bytes_.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+  }
+  void str(const std::string& s) {
+    pod<uint64_t>(s.size());
+    bytes_ += s;
+  }
+  const std::string& bytes() const { return bytes_; }
+
+ private:
+  std::string bytes_;
+};
+
+/**
+ * @brief MetaWriter 가 쓴 것을 같은 순서로 읽는다. 넘쳐 읽으면 던진다
+ */
+class MetaReader {
+ public:
+  MetaReader(const char* data, size_t size, const std::string& file_name)
+      : p_(data), end_(data + size), file_name_(file_name) {}
+
+  template <typename T>
+  T pod() {
+    need(sizeof(T));
+    T value;
+    std::memcpy(&value, p_, sizeof(T));
+    p_ += sizeof(T);
+    return value;
+  }
+  template <typename T>
+  std::vector<T> array() {
+    const uint64_t n = pod<uint64_t>();
+    if (n > static_cast<uint64_t>(end_ - p_) / sizeof(T)) {
+      corrupt(file_name_, "metadata is truncated");
+    }
+    std::vector<T> values(n);
+    std::memcpy(values.data(), p_, n * sizeof(T));
+    p_ += n * sizeof(T);
+    return values;
+  }
+  std::string str() {
+    const uint64_t n = pod<uint64_t>();
+    need(n);
+    std::string s(p_, n);
+    p_ += n;
+    return s;
+  }
+  /**
+   * @brief uint8_t 로 쓴 enum. last 를 넘으면 던진다
+   */
+  template <typename E>
+  E enumeration(E last, const char* what) {
+    const uint8_t raw = pod<uint8_t>();
+    if (raw > static_cast<uint8_t>(last)) {
+      corrupt(file_name_, std::string(what) + " " + std::to_string(raw) + " is out of range");
+    }
+    return static_cast<E>(raw);
+  }
+  bool done() const { return p_ == end_; }
+
+ private:
+  void need(uint64_t n) {
+    if (n > static_cast<uint64_t>(end_ - p_)) {
+      corrupt(file_name_, "metadata is truncated");
+    }
+  }
+
+  const char* p_;
+  const char* end_;
+  const std::string& file_name_;
+};
+
+/**
+ * @brief 파일 전체를 읽기 전용으로 mmap 한다
+ */
+std::pair<char*, size_t> mapFile(const std::string& file_name) {
+  const int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw error::ParserException(error::OPEN_FAILED, "Failed to open file: " + file_name);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw error::ParserException(error::OPEN_FAILED, "Failed to stat file: " + file_name);
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  if (size == 0) {
+    ::close(fd);
+    return {nullptr, 0};
+  }
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    throw error::ParserException(error::OPEN_FAILED, "Failed to mmap file: " + file_name);
+  }
+  return {static_cast<char*>(mapped), size};
+}
+
+/**
+ * @brief 쓸 blob 들. 메타데이터에는 data_offset 기준 offset 이 들어간다
+ */
+class BlobTable {
+ public:
+  uint64_t add(const void* data, size_t bytes) {
+    const uint64_t offset = size_;
+    blobs_.push_back({data, bytes});
+    size_ += alignBlob(bytes);
+    return offset;
+  }
+  const std::vector<PackedWeight>& blobs() const { return blobs_; }
+
+ private:
+  std::vector<PackedWeight> blobs_;
+  uint64_t size_ = 0;
+};
+
+}  // namespace
+
+struct CompiledModel::Mapping {
+  char* base  = nullptr;
+  size_t size = 0;
+
+  ~Mapping() {
+    if (base) {
+      munmap(base, size);
+    }
+  }
+};
+
+CompiledModel::CompiledModel(const std::string& file_name)
+    : mapping_(std::make_shared<Mapping>()) {
+  const std::pair<char*, size_t> mapped = mapFile(file_name);
+  mapping_->base                        = mapped.first;
+  mapping_->size                        = mapped.second;
+  const char* base                      = mapped.first;
+  const size_t size                     = mapped.second;
+
+  FileHeader header;
+  if (size < sizeof(header)) {
+    corrupt(file_name, "file is too small");
+  }
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    corrupt(file_name, "bad magic");
+  }
+  if (header.version != kVersion || header.byte_order != kByteOrder) {
+    corrupt(file_name, "version " + std::to_string(header.version) + " / byte order mismatch");
+  }
+  if (header.file_size != size || header.meta_size > size - sizeof(header) ||
+      header.data_offset > size || header.data_offset % kBlobAlignment != 0) {
+    corrupt(file_name, "file is truncated");
+  }
+  const char* meta = base + sizeof(header);
+  if (hashBytes(meta, header.meta_size) != header.meta_hash) {
+    corrupt(file_name, "metadata hash mismatch");
+  }
+  const std::vector<Isa>& isas = supportedIsas();
+  if (std::find(isas.begin(), isas.end(), static_cast<Isa>(header.isa)) == isas.end()) {
+    corrupt(file_name, std::string("this CPU cannot run ") +
+                           isaToString(static_cast<Isa>(header.isa)) + " kernels");
+  }
+  source_hash_             = header.source_hash;
+  options_.isa             = static_cast<Isa>(header.isa);
+  const char* data         = mapping_->base + header.data_offset;
+  const uint64_t data_size = size - header.data_offset;
+
+  // blob offset -> 매핑 안의 주소
+  MetaReader in(meta, header.meta_size, file_name);
+  auto blob = [&](uint64_t offset, uint64_t bytes) {
+    if (offset % kBlobAlignment != 0 || offset > data_size || bytes > data_size - offset) {
+      corrupt(file_name, "blob is out of range");
+    }
+    return data + offset;
+  };
+
+  options_.blocked_layout = in.pod<uint8_t>() != 0;
+  options_.fuse           = in.pod<uint8_t>() != 0;
+  options_.inter_op       = in.pod<uint8_t>() != 0;
+
+  const uint64_t slots = in.pod<uint64_t>();
+  for (uint64_t i = 0; i < slots; ++i) {
+    Slot slot;
+    slot.name     = in.str();
+    slot.sizes    = in.array<int64_t>();
+    slot.layout   = in.enumeration(tensor::Layout::NCHW16C, "layout");
+    slot.constant = in.pod<uint8_t>() != 0;
+    if (slot.constant && in.pod<uint8_t>() != 0) {
+      const auto dtype                 = in.enumeration(tensor::DType::BOOL, "dtype");
+      const std::vector<int64_t> sizes = in.array<int64_t>();
+      const uint64_t offset            = in.pod<uint64_t>();
+      const uint64_t bytes             = in.pod<uint64_t>();
+      const int64_t numel              = checkedNumel(sizes, data_size);
+      if (numel < 0 || bytes != numel * tensor::dtypeSize(dtype)) {
+        corrupt(file_name, "constant " + slot.name + " has a wrong size");
+      }
+      auto storage = std::make_shared<tensor::Storage>(slot.name, dtype, numel, "cpu");
+      storage->adopt(blob(offset, bytes), mapping_);
+      slot.tensor = tensor::Tensor(std::move(storage), 0, sizes, tensor::contiguousStrides(sizes));
+    }
+    graph_.slots.push_back(std::move(slot));
+  }
+  auto checkSlot = [&](int32_t id) {
+    if (id < 0 || static_cast<uint64_t>(id) >= slots) {
+      corrupt(file_name, "slot index is out of range");
+    }
+  };
+
+  const uint64_t ops = in.pod<uint64_t>();
+  for (uint64_t i = 0; i < ops; ++i) {
+    Op op;
+    op.kind   = in.enumeration(OpKind::REORDER, "op kind");
+    op.inputs = in.array<int32_t>();
+    op.output = in.pod<int32_t>();
+    op.params = in.pod<OpParams>();
+    op.name   = in.str();
+    for (int32_t id : op.inputs) {
+      checkSlot(id);
+    }
+    checkSlot(op.output);
+    if (static_cast<uint8_t>(op.params.activation) > static_cast<uint8_t>(Activation::SIGMOID) ||
+        static_cast<uint8_t>(op.params.pad_mode) >
+            static_cast<uint8_t>(OpParams::PadMode::REFLECT)) {
+      corrupt(file_name, "op " + op.name + " has an unknown activation or pad mode");
+    }
+    if (op.params.weight_scale >= 0) {
+      checkSlot(op.params.weight_scale);
+    }
+    graph_.ops.push_back(std::move(op));
+  }
+  graph_.inputs  = in.array<int32_t>();
+  graph_.outputs = in.array<int32_t>();
+  for (int32_t id : graph_.inputs) {
+    checkSlot(id);
+  }
+  for (int32_t id : graph_.outputs) {
+    checkSlot(id);
+  }
+
+  const uint64_t stages = in.pod<uint64_t>();
+  for (uint64_t s = 0; s < stages; ++s) {
+    Stage stage;
+    stage.ops        = in.array<int32_t>();
+    stage.concurrent = in.pod<uint8_t>() != 0;
+    for (int32_t i : stage.ops) {
+      if (i < 0 || static_cast<uint64_t>(i) >= ops) {
+        corrupt(file_name, "scheduled op is out of range");
+      }
+    }
+    schedule_.stages.push_back(std::move(stage));
+  }
+  schedule_.steps   = in.array<int64_t>();
+  plan_.offsets     = in.array<int64_t>();
+  plan_.arena_bytes = in.pod<uint64_t>();
+  plan_.naive_bytes = in.pod<uint64_t>();
+  if (plan_.offsets.size() != slots) {
+    corrupt(file_name, "memory plan does not cover the slots");
+  }
+  // Engine 은 offset 을 그대로 arena 주소로 쓰므로 자리마다 arena 안에 들어오는지 본다
+  for (uint64_t i = 0; i < slots; ++i) {
+    const Slot& slot     = graph_.slots[i];
+    const int64_t offset = plan_.offsets[i];
+    if (slot.constant || offset < 0) {
+      continue;
+    }
+    const uint64_t limit = plan_.arena_bytes / sizeof(float);
+    if (checkedNumel(slot.sizes, limit) < 0 ||
+        (slot.layout != tensor::Layout::NCHW && slot.sizes.size() != 4)) {
+      corrupt(file_name, "slot " + slot.name + " has a bad shape");
+    }
+    const int64_t numel  = checkedNumel(tensor::physicalSizes(slot.sizes, slot.layout), limit);
+    const uint64_t bytes = static_cast<uint64_t>(numel) * sizeof(float);
+    if (numel < 0 || offset % sizeof(float) != 0 ||
+        static_cast<uint64_t>(offset) > plan_.arena_bytes ||
+        bytes > plan_.arena_bytes - static_cast<uint64_t>(offset)) {
+      corrupt(file_name, "slot " + slot.name + " does not fit in the arena");
+    }
+  }
+
+  conv_index_.assign(ops, -1);
+  const uint64_t convs = in.pod<uint64_t>();
+  for (uint64_t c = 0; c < convs; ++c) {
+    const uint64_t op = in.pod<uint64_t>();
+    if (op >= ops || conv_index_[op] >= 0) {
+      corrupt(file_name, "conv kernel index is out of range");
+    }
+    CompiledConv conv;
+    conv.algo            = in.enumeration(ConvAlgo::INT8_GEMM, "conv algo");
+    const uint64_t blobs = in.pod<uint64_t>();
+    for (uint64_t b = 0; b < blobs; ++b) {
+      const uint64_t offset = in.pod<uint64_t>();
+      const uint64_t bytes  = in.pod<uint64_t>();
+      conv.packed.push_back({blob(offset, bytes), static_cast<size_t>(bytes)});
+    }
+    conv_index_[op] = static_cast<int32_t>(convs_.size());
+    convs_.push_back(std::move(conv));
+  }
+  for (uint64_t i = 0; i < ops; ++i) {
+    const Op& op = graph_.ops[i];
+    if ((op.kind == OpKind::CONV2D ||
+         (op.kind == OpKind::LINEAR && op.params.input_scale > 0.0f)) &&
+        conv_index_[i] < 0) {
+      corrupt(file_name, "conv " + op.name + " has no kernel");
+    }
+  }
+  if (!in.done()) {
+    corrupt(file_name, "metadata has trailing bytes");
+  }
+}
+
+CompiledModel::~CompiledModel() = default;
+
+size_t CompiledModel::fileSize() const { return mapping_->size; }
+
+uint64_t hashFile(const std::string& file_name) {
+  std::pair<char*, size_t> mapped = mapFile(file_name);
+  const uint64_t h                = hashBytes(mapped.first, mapped.second);
+  if (mapped.first) {
+    munmap(mapped.first, mapped.second);
+  }
+  return h;
+}
+
+void saveCompiledModel(const Engine& engine, const std::string& file_name, uint64_t source_hash) {
+  const Graph& graph     = engine.graph();
+  const size_t op_count  = graph.ops.size();
+  const EngineOptions& o = engine.options();
+
+  // 묶은 weight 로 대신하는 conv weight 는 어느 커널도 읽지 않는다
+  std::vector<bool> needed(graph.slots.size(), false);
+  for (size_t i = 0; i < op_count; ++i) {
+    const Op& op           = graph.ops[i];
+    const ConvKernel* conv = engine.convKernel(i);
+    for (size_t k = 0; k < op.inputs.size(); ++k) {
+      if (k == 1 && conv && !conv->packedWeights().empty()) {
+        continue;
+      }
+      needed[op.inputs[k]] = true;
+    }
+  }
+  for (int32_t id : graph.outputs) {
+    needed[id] = true;
+  }
+
+  MetaWriter meta;
+  BlobTable blobs;
+  std::vector<tensor::Tensor> keep;  // 연속 복사본이 쓸 때까지 살아 있게
+  meta.pod<uint8_t>(o.blocked_layout);
+  meta.pod<uint8_t>(o.fuse);
+  meta.pod<uint8_t>(o.inter_op);
+
+  meta.pod<uint64_t>(graph.slots.size());
+  for (size_t i = 0; i < graph.slots.size(); ++i) {
+    const Slot& slot = graph.slots[i];
+    meta.str(slot.name);
+    meta.array(slot.sizes);
+    meta.pod<uint8_t>(static_cast<uint8_t>(slot.layout));
+    meta.pod<uint8_t>(slot.constant);
+    if (!slot.constant) {
+      continue;
+    }
+    const bool stored = needed[i] && slot.tensor.defined();
+    meta.pod<uint8_t>(stored);
+    if (!stored) {
+      continue;
+    }
+    keep.push_back(tensor::contiguous(slot.tensor));
+    const tensor::Tensor& t = keep.back();
+    const size_t bytes      = t.numel() * tensor::dtypeSize(t.dtype());
+    meta.pod<uint8_t>(static_cast<uint8_t>(t.dtype()));
+    meta.array(t.sizes());
+    meta.pod<uint64_t>(blobs.add(t.data(), bytes));
+    meta.pod<uint64_t>(bytes);
+  }
+
+  meta.pod<uint64_t>(op_count);
+  for (const Op& op : graph.ops) {
+    meta.pod<uint8_t>(static_cast<uint8_t>(op.kind));
+    meta.array(op.inputs);
+    meta.pod<int32_t>(op.output);
+    meta.pod<OpParams>(op.params);
+    meta.str(op.name);
+  }
+  meta.array(graph.inputs);
+  meta.array(graph.outputs);
+
+  const Schedule& schedule = engine.schedule();
+  meta.pod<uint64_t>(schedule.stages.size());
+  for (const Stage& stage : schedule.stages) {
+    meta.array(stage.ops);
+    meta.pod<uint8_t>(stage.concurrent);
+  }
+  meta.array(schedule.steps);
+  const MemoryPlan& plan = engine.memoryPlan();
+  meta.array(plan.offsets);
+  meta.pod<uint64_t>(plan.arena_bytes);
+  meta.pod<uint64_t>(plan.naive_bytes);
+
+  uint64_t convs = 0;
+  for (size_t i = 0; i < op_count; ++i) {
+    convs += engine.convKernel(i) != nullptr;
+  }
+  meta.pod<uint64_t>(convs);
+  for (size_t i = 0; i < op_count; ++i) {
+    const ConvKernel* conv = engine.convKernel(i);
+    if (!conv) {
+      continue;
+    }
+    const std::vector<PackedWeight> packed = conv->packedWeights();
+    meta.pod<uint64_t>(i);
+    meta.pod<uint8_t>(static_cast<uint8_t>(conv->algo()));
+    meta.pod<uint64_t>(packed.size());
+    for (const PackedWeight& p : packed) {
+      meta.pod<uint64_t>(blobs.add(p.data, p.bytes));
+      meta.pod<uint64_t>(p.bytes);
+    }
+  }
+
+  FileHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version     = CompiledModel::kVersion;
+  header.byte_order  = kByteOrder;
+  header.source_hash = source_hash;
+  header.meta_size   = meta.bytes().size();
+  header.meta_hash   = hashBytes(meta.bytes().data(), meta.bytes().size());
+  header.data_offset = alignBlob(sizeof(header) + meta.bytes().size());
+  header.isa         = static_cast<uint8_t>(o.isa);
+  header.file_size   = header.data_offset;
+  for (const PackedWeight& b : blobs.blobs()) {
+    header.file_size += alignBlob(b.bytes);
+  }
+
+  // 같은 프로세스의 여러 스레드가 같은 cache 를 동시에 써도 임시 파일이 겹치지 않게 번호를 붙인다
+  static std::atomic<uint64_t> next_temp{0};
+  const std::string temp = file_name + ".tmp" + std::to_string(::getpid()) + "." +
+                           std::to_string(next_temp.fetch_add(1, std::memory_order_relaxed));
+  std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw error::ParserException(error::OPEN_FAILED, "Failed to create file: " + temp);
+  }
+  static const char kZeros[kBlobAlignment] = {};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(meta.bytes().data(), meta.bytes().size());
+  out.write(kZeros, header.data_offset - sizeof(header) - meta.bytes().size());
+  for (const PackedWeight& b : blobs.blobs()) {
+    out.write(static_cast<const char*>(b.data), b.bytes);
+    out.write(kZeros, alignBlob(b.bytes) - b.bytes);
+  }
+  out.close();
+  if (!out || std::rename(temp.c_str(), file_name.c_str()) != 0) {
+    std::remove(temp.c_str());
+    throw error::ParserException(error::OPEN_FAILED, "Failed to write file: " + file_name);
+  }
+}
+
+std::string compiledModelPath(const std::string& cache_dir, uint64_t source_hash,
+                              const std::vector<std::vector<int64_t>>& input_shapes,
+                              const EngineOptions& options) {
+  uint64_t key = mix(source_hash, CompiledModel::kVersion);
+  key          = mix(key, static_cast<uint64_t>(options.isa));
+  key          = mix(key, (options.blocked_layout ? 1 : 0) | (options.fuse ? 2 : 0) |
+                              (options.inter_op ? 4 : 0));
+  for (const std::vector<int64_t>& shape : input_shapes) {
+    key = mix(key, shape.size());
+    for (int64_t s : shape) {
+      key = mix(key, static_cast<uint64_t>(s));
+    }
+  }
+  if (options.quantize) {
+    for (const auto& entry : options.quantize->ranges) {
+      const float range[2] = {entry.second.min, entry.second.max};
+      const uint64_t bytes = hashBytes(reinterpret_cast<const char*>(range), sizeof(range));
+      key                  = mix(mix(key, static_cast<uint64_t>(entry.first)), bytes);
+    }
+  }
+  char name[24];
+  std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+  return (std::filesystem::path(cache_dir) / (std::string(name) + ".tfe")).string();
+}
+
+uint64_t sourceKey(const std::string& model_file) {
+  try {
+    // 엔트리 내용이 바뀌면 CRC32 가 바뀐다. 읽는 것은 central directory 와 local header 뿐이다
+    parser::ZipArchive archive(model_file);
+    uint64_t key = mix(0, archive.entries().size());
+    for (const parser::ZipEntry& entry : archive.entries()) {
+      key = mix(key, hashBytes(entry.name.data(), entry.name.size()));
+      key = mix(key, entry.crc32);
+      key = mix(key, entry.method);
+      key = mix(key, entry.compressed_size);
+      key = mix(key, entry.uncompressed_size);
+    }
+    return key;
+  } catch (const error::ParserException&) {
+    // ZIP 이 아니다 (.tflite). 아래의 stat 이 없는 파일을 알린다
+  }
+
+  struct stat st;
+  if (::stat(model_file.c_str(), &st) != 0) {
+    throw error::ParserException(error::OPEN_FAILED, "Failed to stat file: " + model_file);
+  }
+  uint64_t key = mix(1, static_cast<uint64_t>(st.st_dev));
+  key          = mix(key, static_cast<uint64_t>(st.st_ino));
+  key          = mix(key, static_cast<uint64_t>(st.st_size));
+  key          = mix(key, static_cast<uint64_t>(st.st_mtim.tv_sec));
+  key          = mix(key, static_cast<uint64_t>(st.st_mtim.tv_nsec));
+  return key;
+}
+
+std::unique_ptr<Engine> loadEngine(const std::string& model_file,
+                                   const std::vector<std::vector<int64_t>>& input_shapes,
+                                   const EngineOptions& options, const std::string& cache_dir) {
+  const uint64_t source_hash = sourceKey(model_file);
+  const std::string path     = compiledModelPath(cache_dir, source_hash, input_shapes, options);
+  if (std::filesystem::exists(path)) {
+    try {
+      auto compiled = std::make_shared<const CompiledModel>(path);
+      if (compiled->sourceHash() == source_hash) {
+        return std::make_unique<Engine>(std::move(compiled), options.pool);
+      }
+    } catch (const error::ParserException&) {
+      // 깨졌거나 다른 버전이 쓴 cache 는 새로 만든다
+    }
+  }
+
+  std::filesystem::create_directories(cache_dir);
+  const std::string suffix = ".tflite";
+  if (model_file.size() > suffix.size() &&
+      model_file.compare(model_file.size() - suffix.size(), suffix.size(), suffix) == 0) {
+    parser::TFLiteParser parser;
+    parser.read(model_file);
+    Engine engine(lower(parser, input_shapes), options);
+    saveCompiledModel(engine, path, source_hash);
+  } else {
+    model::ScriptModel model(model_file);
+    Engine engine(model, input_shapes, options);
+    saveCompiledModel(engine, path, source_hash);
+  }
+  return std::make_unique<Engine>(std::make_shared<const CompiledModel>(path), options.pool);
+}
+
+}  // namespace engine
+}  // namespace tfe
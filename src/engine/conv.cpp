@@ -0,0 +1,900 @@
+#include "engine/conv.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "engine/conv_nchwc.h"
+#include "engine/conv_winograd.h"
+#include "engine/kernels.h"
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+constexpr int kWinogradTile = 4;  // F(2x2, 3x3) 의 입력 tile
+constexpr int kWinogradOut  = 2;
+constexpr int kWinogradSize = kWinogradTile * kWinogradTile;
+
+bool isWinograd(const std::vector<int64_t>& w, const OpParams& params) {
+  return w[2] == 3 && w[3] == 3 && params.stride[0] == 1 && params.stride[1] == 1 &&
+         params.dilation[0] == 1 && params.dilation[1] == 1 && params.groups == 1;
+}
+
+/**
+ * @brief 그룹 g 의 입력을 [icg*kh*kw] x [oh*ow] 열 행렬로 편다. 입력 채널 [c0, c1) 의 행만 쓴다
+ */
+void im2col(const float* input, const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+            const std::vector<int64_t>& out, const OpParams& params, int64_t c0, int64_t c1,
+            float* columns) {
+  const int64_t kh = w[2], kw = w[3];
+  const int64_t n  = out[2] * out[3];
+  for (int64_t c = c0; c < c1; ++c) {
+    const float* plane = input + c * in[2] * in[3];
+    for (int64_t ky = 0; ky < kh; ++ky) {
+      for (int64_t kx = 0; kx < kw; ++kx) {
+        float* row          = columns + ((c * kh + ky) * kw + kx) * n;
+        const int64_t off_x = kx * params.dilation[1] - params.padding[1];
+        // 유효한 ox 범위 [ox0, ox1): 0 <= ox*stride + off_x < W
+        int64_t ox0 = off_x < 0 ? (-off_x + params.stride[1] - 1) / params.stride[1] : 0;
+        int64_t ox1 =
+            in[3] - off_x <= 0 ? 0 : (in[3] - off_x + params.stride[1] - 1) / params.stride[1];
+        ox0 = std::min(ox0, out[3]);
+        ox1 = std::max(ox0, std::min(ox1, out[3]));
+        for (int64_t oy = 0; oy < out[2]; ++oy) {
+          float* dst = row + oy * out[3];
+          int64_t iy = oy * params.stride[0] - params.padding[0] + ky * params.dilation[0];
+          if (iy < 0 || iy >= in[2]) {
+            std::fill(dst, dst + out[3], 0.0f);
+            continue;
+          }
+          const float* src = plane + iy * in[3] + off_x;
+          std::fill(dst, dst + ox0, 0.0f);
+          if (params.stride[1] == 1) {
+            std::memcpy(dst + ox0, src + ox0, (ox1 - ox0) * sizeof(float));
+          } else {
+            for (int64_t ox = ox0; ox < ox1; ++ox) {
+              dst[ox] = src[ox * params.stride[1]];
+            }
+          }
+          std::fill(dst + ox1, dst + out[3], 0.0f);
+        }
+      }
+    }
+  }
+}
+
+uint8_t quantizeU8(float x, float inv_scale, float zero) {
+  return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, x * inv_scale + zero)) + 0.5f);
+}
+
+/**
+ * @brief 입력 채널 [c0, c1) 을 params 의 input_scale / input_zero 로 u8 로 바꿔 padding 을 두른 평면
+ *        [C][H + 2 * pad_h][W + 2 * pad_w] 에 쓴다. padding 자리는 0 을 양자화한 input_zero 다
+ */
+void quantizePlanes(const float* input, const std::vector<int64_t>& in, const OpParams& params,
+                    int64_t c0, int64_t c1, uint8_t* planes) {
+  const int64_t ph = in[2] + 2 * params.padding[0], pw = in[3] + 2 * params.padding[1];
+  const float inv  = 1.0f / params.input_scale;
+  const float zero = static_cast<float>(params.input_zero);
+  for (int64_t c = c0; c < c1; ++c) {
+    uint8_t* plane = planes + c * ph * pw;
+    std::fill(plane, plane + ph * pw, static_cast<uint8_t>(params.input_zero));
+    for (int64_t y = 0; y < in[2]; ++y) {
+      const float* src = input + (c * in[2] + y) * in[3];
+      uint8_t* dst     = plane + (y + params.padding[0]) * pw + params.padding[1];
+      for (int64_t x = 0; x < in[3]; ++x) {
+        dst[x] = quantizeU8(src[x], inv, zero);
+      }
+    }
+  }
+}
+
+/**
+ * @brief quantizePlanes() 의 평면에서 k 4 개 묶음 [q0, q1) 의 열을 int8ColumnsBytes 배치로 모은다
+ *        (u8 im2col). padding 을 평면에 둘렀으므로 경계 검사가 없다
+ */
+void gatherColumns(const uint8_t* planes, const std::vector<int64_t>& in,
+                   const std::vector<int64_t>& w, const std::vector<int64_t>& out,
+                   const OpParams& params, int64_t q0, int64_t q1, int64_t quads,
+                   uint8_t* columns) {
+  const int64_t ph = in[2] + 2 * params.padding[0], pw = in[3] + 2 * params.padding[1];
+  const int64_t kh = w[2], kw = w[3];
+  const int64_t k  = w[1] * kh * kw;
+  const int64_t n  = out[2] * out[3];
+  const int64_t sy = params.stride[0] * pw, sx = params.stride[1];
+  for (int64_t q = q0; q < q1; ++q) {
+    // 묶음의 k 4 개가 읽는 평면 위치. K 를 넘는 k 는 weight 가 0 이라 아무 값이나 읽어도 된다
+    const uint8_t* src[4];
+    for (int64_t t = 0; t < 4; ++t) {
+      const int64_t kk = std::min(q * 4 + t, k - 1);
+      const int64_t ky = kk / kw % kh, kx = kk % kw;
+      src[t] = planes + kk / (kh * kw) * ph * pw + ky * params.dilation[0] * pw +
+               kx * params.dilation[1];
+    }
+    int64_t oy = 0, ox = 0;
+    for (int64_t j = 0; j < n; j += kInt8NR) {
+      uint8_t* dst       = columns + (j / kInt8NR * quads + q) * kInt8NR * 4;
+      const int64_t cols = std::min(kInt8NR, n - j);
+      for (int64_t jj = 0; jj < cols; ++jj) {
+        const int64_t p = oy * sy + ox * sx;
+        dst[jj * 4]     = src[0][p];
+        dst[jj * 4 + 1] = src[1][p];
+        dst[jj * 4 + 2] = src[2][p];
+        dst[jj * 4 + 3] = src[3][p];
+        if (++ox == out[3]) {
+          ox = 0;
+          ++oy;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief GEMM task 하나가 맡는 행 panel 수. 열 블록 (chunks) 이 worker 보다 적으면 출력 채널도
+ *        나누되, task 마다 B 블록을 다시 읽으므로 panel 2 개 아래로는 자르지 않는다
+ */
+int64_t panelStep(int64_t panels, int64_t chunks, int64_t workers) {
+  const int64_t want = workers * 4;
+  return workers == 1 || chunks >= want
+             ? panels
+             : std::min(panels, std::max<int64_t>(2, panels * chunks / want));
+}
+
+/**
+ * @brief [0, n) 을 grain 덩어리로 pool 에 나눠 fn(lo, hi, worker) 를 부른다. pool 이 없으면 한 번에 돈다
+ */
+template <typename Fn>
+void parallelFor(util::WorkStealingPool* pool, int64_t n, int64_t grain, Fn&& fn) {
+  if (pool) {
+    pool->parallelFor(0, n, grain, fn);
+  } else if (n > 0) {
+    fn(int64_t{0}, n, size_t{0});
+  }
+}
+
+/**
+ * @brief 입력 좌표 origin + k * step 이 [0, size) 안에 드는 tap k 의 범위 [k0, k1)
+ */
+void tapRange(int64_t origin, int64_t step, int64_t taps, int64_t size, int64_t* k0,
+              int64_t* k1) {
+  *k0 = origin < 0 ? (-origin + step - 1) / step : 0;
+  *k1 = size - origin <= 0 ? 0 : std::min(taps, (size - origin + step - 1) / step);
+  *k1 = std::max(*k0, *k1);
+}
+
+}  // namespace
+
+const char* convAlgoToString(ConvAlgo algo) {
+  switch (algo) {
+    case ConvAlgo::AUTO:
+      return "auto";
+    case ConvAlgo::REFERENCE:
+      return "reference";
+    case ConvAlgo::IM2COL_GEMM:
+      return "im2col_gemm";
+    case ConvAlgo::DIRECT_1X1:
+      return "direct_1x1";
+    case ConvAlgo::DEPTHWISE:
+      return "depthwise";
+    case ConvAlgo::WINOGRAD_3X3:
+      return "winograd_3x3";
+    case ConvAlgo::DIRECT_NCHWC:
+      return "direct_nchwc";
+    case ConvAlgo::INT8_GEMM:
+      return "int8_gemm";
+  }
+  return "unknown";
+}
+
+bool convAlgoApplies(ConvAlgo algo, const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+                     const OpParams& params) {
+  switch (algo) {
+    case ConvAlgo::DIRECT_1X1:
+      return w[2] == 1 && w[3] == 1 && params.stride[0] == 1 && params.stride[1] == 1 &&
+             params.padding[0] == 0 && params.padding[1] == 0;
+    case ConvAlgo::DEPTHWISE:
+      return params.groups > 1 && params.groups == in[1] && params.groups == w[0];
+    case ConvAlgo::WINOGRAD_3X3:
+      return isWinograd(w, params);
+    case ConvAlgo::DIRECT_NCHWC:
+    case ConvAlgo::INT8_GEMM:
+      return false;
+    default:
+      return true;
+  }
+}
+
+ConvAlgo selectConvAlgo(const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+                        const OpParams& params) {
+  if (convAlgoApplies(ConvAlgo::DEPTHWISE, in, w, params)) {
+    return ConvAlgo::DEPTHWISE;
+  }
+  if (convAlgoApplies(ConvAlgo::DIRECT_1X1, in, w, params)) {
+    return ConvAlgo::DIRECT_1X1;
+  }
+  // 채널이 적으면 변환 비용이 GEMM 절약분보다 크다
+  if (isWinograd(w, params) && in[1] >= 16 && w[0] >= 16) {
+    return ConvAlgo::WINOGRAD_3X3;
+  }
+  return ConvAlgo::IM2COL_GEMM;
+}
+
+tensor::Layout blockedLayoutFor(Isa isa) {
+  return isa == Isa::AVX512 ? tensor::Layout::NCHW16C : tensor::Layout::NCHW8C;
+}
+
+bool convLayoutApplies(const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+                       const OpParams& params, tensor::Layout in_layout,
+                       tensor::Layout out_layout) {
+  const int64_t ob = tensor::layoutBlock(out_layout);
+  const int64_t ib = tensor::layoutBlock(in_layout);
+  if (in.size() != 4 || w.size() != 4 || ob == 1 || w[0] % ob != 0 ||
+      (in_layout != tensor::Layout::NCHW && in_layout != out_layout)) {
+    return false;
+  }
+  if (params.groups == 1) {
+    return in[1] % ib == 0;
+  }
+  return convAlgoApplies(ConvAlgo::DEPTHWISE, in, w, params) && in_layout == out_layout;
+}
+
+ConvKernel::ConvKernel(const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+                       const float* weight, const float* bias, const OpParams& params,
+                       ConvAlgo algo, Isa isa, tensor::Layout in_layout,
+                       tensor::Layout out_layout, const std::vector<int64_t>& target,
+                       util::WorkStealingPool* pool)
+    : in_(in),
+      w_(w),
+      params_(params),
+      algo_(algo),
+      isa_(isa),
+      in_layout_(in_layout),
+      out_layout_(out_layout),
+      weight_(weight),
+      bias_(bias),
+      pool_(pool) {
+  if (in.size() != 4 || w.size() != 4 || in[1] != w[1] * params.groups) {
+    throw std::invalid_argument("ConvKernel: input/weight shape mismatch");
+  }
+  shapeOutput(target);
+
+  if (tensor::isBlocked(in_layout) || tensor::isBlocked(out_layout)) {
+    if ((algo_ != ConvAlgo::AUTO && algo_ != ConvAlgo::DIRECT_NCHWC) ||
+        !convLayoutApplies(in, w, params, in_layout, out_layout)) {
+      throw std::invalid_argument(std::string("ConvKernel: cannot run ") +
+                                  tensor::layoutToString(in_layout) + " -> " +
+                                  tensor::layoutToString(out_layout) + " with " +
+                                  convAlgoToString(algo_));
+    }
+    algo_ = ConvAlgo::DIRECT_NCHWC;
+  } else if (algo_ == ConvAlgo::AUTO) {
+    algo_ = selectConvAlgo(in, w, params);
+  } else if (!convAlgoApplies(algo_, in, w, params)) {
+    throw std::invalid_argument(std::string("ConvKernel: ") + convAlgoToString(algo_) +
+                                " does not apply to this convolution");
+  }
+
+  const int64_t groups = params.groups;
+  const int64_t ocg    = w[0] / groups;
+  const int64_t k      = w[1] * w[2] * w[3];
+  if (algo_ == ConvAlgo::IM2COL_GEMM || algo_ == ConvAlgo::DIRECT_1X1) {
+    for (int64_t g = 0; g < groups; ++g) {
+      packed_.emplace_back(weight + g * ocg * k, ocg, k, k);
+    }
+  } else if (algo_ == ConvAlgo::WINOGRAD_3X3) {
+    // U = G g G^T, G = [[1, 0, 0], [.5, .5, .5], [.5, -.5, .5], [0, 0, 1]]
+    const int64_t oc = w[0], ic = w[1];
+    std::vector<float> u(kWinogradSize * oc * ic);
+    for (int64_t o = 0; o < oc; ++o) {
+      for (int64_t i = 0; i < ic; ++i) {
+        const float* g = weight + (o * ic + i) * 9;
+        float gg[4][3];
+        for (int c = 0; c < 3; ++c) {
+          gg[0][c] = g[c];
+          gg[1][c] = 0.5f * (g[c] + g[3 + c] + g[6 + c]);
+          gg[2][c] = 0.5f * (g[c] - g[3 + c] + g[6 + c]);
+          gg[3][c] = g[6 + c];
+        }
+        for (int r = 0; r < 4; ++r) {
+          float row[4] = {gg[r][0], 0.5f * (gg[r][0] + gg[r][1] + gg[r][2]),
+                          0.5f * (gg[r][0] - gg[r][1] + gg[r][2]), gg[r][2]};
+          for (int c = 0; c < 4; ++c) {
+            u[((r * 4 + c) * oc + o) * ic + i] = row[c];
+          }
+        }
+      }
+    }
+    for (int e = 0; e < kWinogradSize; ++e) {
+      packed_.emplace_back(u.data() + e * oc * ic, oc, ic, ic);
+    }
+  } else if (algo_ == ConvAlgo::DIRECT_NCHWC) {
+    // depthwise weight {C, 1, KH, KW} 는 ib = 1 로 묶으면 [C/ob][KH][KW][ob] 가 된다
+    const int64_t ib = groups == 1 ? tensor::layoutBlock(in_layout) : 1;
+    const int64_t ob = tensor::layoutBlock(out_layout);
+    blocked_         = tensor::AlignedBuffer(packedBytes()[0]);
+    blocked_weight_  = static_cast<const float*>(blocked_.data());
+    tensor::packConvWeight(weight, w, ib, ob, static_cast<float*>(blocked_.data()));
+  }
+  planScratch();
+}
+
+ConvKernel::ConvKernel(const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+                       ConvAlgo algo, const std::vector<PackedWeight>& packed,
+                       const float* weight, const float* bias, const OpParams& params, Isa isa,
+                       tensor::Layout in_layout, tensor::Layout out_layout,
+                       const std::vector<int64_t>& target, util::WorkStealingPool* pool)
+    : in_(in),
+      w_(w),
+      params_(params),
+      algo_(algo),
+      isa_(isa),
+      in_layout_(in_layout),
+      out_layout_(out_layout),
+      weight_(weight),
+      bias_(bias),
+      pool_(pool) {
+  if (in.size() != 4 || w.size() != 4 || in[1] != w[1] * params.groups) {
+    throw std::invalid_argument("ConvKernel: input/weight shape mismatch");
+  }
+  shapeOutput(target);
+
+  const bool blocked = tensor::isBlocked(in_layout) || tensor::isBlocked(out_layout);
+  bool applies       = false;
+  if (algo == ConvAlgo::DIRECT_NCHWC) {
+    applies = blocked && convLayoutApplies(in, w, params, in_layout, out_layout);
+  } else if (algo == ConvAlgo::INT8_GEMM) {
+    applies = !blocked && params.groups == 1 && params.input_scale > 0.0f &&
+              params.input_zero >= 0 && params.input_zero <= 255;
+  } else if (algo != ConvAlgo::AUTO) {
+    applies = !blocked && convAlgoApplies(algo, in, w, params);
+  }
+  const std::vector<size_t> bytes = packedBytes();
+  bool matches                    = applies && packed.size() == bytes.size();
+  for (size_t i = 0; matches && i < bytes.size(); ++i) {
+    matches = packed[i].data != nullptr && packed[i].bytes == bytes[i];
+  }
+  if (!matches) {
+    throw std::invalid_argument(std::string("ConvKernel: packed weights do not match ") +
+                                convAlgoToString(algo));
+  }
+
+  const int64_t ocg = w[0] / params.groups;
+  const int64_t k   = w[1] * w[2] * w[3];
+  if (algo_ == ConvAlgo::IM2COL_GEMM || algo_ == ConvAlgo::DIRECT_1X1) {
+    for (const PackedWeight& p : packed) {
+      packed_.push_back(PackedMatrix::view(static_cast<const float*>(p.data), ocg, k));
+    }
+  } else if (algo_ == ConvAlgo::WINOGRAD_3X3) {
+    for (const PackedWeight& p : packed) {
+      packed_.push_back(PackedMatrix::view(static_cast<const float*>(p.data), w[0], w[1]));
+    }
+  } else if (algo_ == ConvAlgo::DIRECT_NCHWC) {
+    blocked_weight_ = static_cast<const float*>(packed[0].data);
+  } else if (algo_ == ConvAlgo::INT8_GEMM) {
+    quantized_ = QuantizedMatrix::view(packed[0].data, w[0], k);
+    scale_     = static_cast<const float*>(packed[1].data);
+  }
+  planScratch();
+}
+
+ConvKernel::ConvKernel(const std::vector<int64_t>& in, const std::vector<int64_t>& w,
+                       const int8_t* weight, const float* weight_scale, const float* bias,
+                       const OpParams& params, Isa isa, const std::vector<int64_t>& target,
+                       util::WorkStealingPool* pool)
+    : in_(in),
+      w_(w),
+      params_(params),
+      algo_(ConvAlgo::INT8_GEMM),
+      isa_(isa),
+      in_layout_(tensor::Layout::NCHW),
+      out_layout_(tensor::Layout::NCHW),
+      weight_(nullptr),
+      bias_(bias),
+      pool_(pool) {
+  if (in.size() != 4 || w.size() != 4 || in[1] != w[1] || params.groups != 1 ||
+      !(params.input_scale > 0.0f) || params.input_zero < 0 || params.input_zero > 255) {
+    throw std::invalid_argument("ConvKernel: int8 conv needs groups 1 and u8 input quantization");
+  }
+  shapeOutput(target);
+
+  const int64_t k = w[1] * w[2] * w[3];
+  quantized_      = QuantizedMatrix(weight, w[0], k, k);
+  scales_.resize(w[0]);
+  for (int64_t o = 0; o < w[0]; ++o) {
+    scales_[o] = params.input_scale * weight_scale[o];
+  }
+  scale_ = scales_.data();
+  planScratch();
+}
+
+std::vector<size_t> ConvKernel::packedBytes() const {
+  const int64_t k = w_[1] * w_[2] * w_[3];
+  switch (algo_) {
+    case ConvAlgo::IM2COL_GEMM:
+    case ConvAlgo::DIRECT_1X1:
+      return std::vector<size_t>(params_.groups, PackedMatrix::bytes(w_[0] / params_.groups, k));
+    case ConvAlgo::WINOGRAD_3X3:
+      return std::vector<size_t>(kWinogradSize, PackedMatrix::bytes(w_[0], w_[1]));
+    case ConvAlgo::DIRECT_NCHWC: {
+      const int64_t ib = params_.groups == 1 ? tensor::layoutBlock(in_layout_) : 1;
+      int64_t count    = 1;
+      for (int64_t s : tensor::blockedWeightSizes(w_, ib, tensor::layoutBlock(out_layout_))) {
+        count *= s;
+      }
+      return {count * sizeof(float)};
+    }
+    case ConvAlgo::INT8_GEMM:
+      return {QuantizedMatrix::bytes(w_[0], k), w_[0] * sizeof(float)};
+    default:
+      return {};
+  }
+}
+
+std::vector<PackedWeight> ConvKernel::packedWeights() const {
+  const std::vector<size_t> bytes = packedBytes();
+  std::vector<PackedWeight> packed;
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    const void* data = nullptr;
+    if (algo_ == ConvAlgo::DIRECT_NCHWC) {
+      data = blocked_weight_;
+    } else if (algo_ == ConvAlgo::INT8_GEMM) {
+      data = i == 0 ? quantized_.data() : scale_;
+    } else {
+      data = packed_[i].data();
+    }
+    packed.push_back({data, bytes[i]});
+  }
+  return packed;
+}
+
+void ConvKernel::planScratch() {
+  workers_ = pool_ ? static_cast<int64_t>(pool_->concurrency()) : 1;
+  if (algo_ == ConvAlgo::IM2COL_GEMM || algo_ == ConvAlgo::DIRECT_1X1) {
+    scratch_ = kGemmPackFloats;
+  } else if (algo_ == ConvAlgo::WINOGRAD_3X3) {
+    // gemm 묶음 + 입력 행 [4][2*tw+2], B^T d [4][2*tw+2], A^T M [2][4][tw]
+    const int64_t tw = (out_[3] + 1) / 2;
+    scratch_         = (kGemmPackFloats + 8 * (2 * tw + 2) + 8 * tw + 15) / 16 * 16;
+  }
+}
+
+void ConvKernel::shapeOutput(const std::vector<int64_t>& target) {
+  params_.kernel[0] = w_[2];
+  params_.kernel[1] = w_[3];
+  out_              = {in_[0], w_[0], 0, 0};
+  for (int d = 0; d < 2; ++d) {
+    out_[2 + d] =
+        (in_[2 + d] + 2 * params_.padding[d] - params_.dilation[d] * (w_[2 + d] - 1) - 1) /
+            params_.stride[d] +
+        1;
+  }
+
+  // epilogue 는 conv 출력을 upsample 배 키워 target 의 채널 offset 부터 쓴다
+  target_            = target.empty() ? out_ : target;
+  const int64_t up   = params_.upsample;
+  const int64_t lane = tensor::layoutBlock(out_layout_);
+  if (target_.size() != 4 || up < 1 || target_[0] != out_[0] || target_[2] != out_[2] * up ||
+      target_[3] != out_[3] * up || params_.offset < 0 || params_.offset + out_[1] > target_[1] ||
+      params_.offset % lane != 0 || target_[1] % lane != 0) {
+    throw std::invalid_argument("ConvKernel: epilogue target does not fit the conv output");
+  }
+  if (target_ != out_) {
+    staging_ = (out_[0] * out_[1] * out_[2] * out_[3] + 15) / 16 * 16;  // 뒤 작업 버퍼 정렬
+  }
+  epilogue_ = params_.activation != Activation::NONE || staging_ > 0;
+}
+
+size_t ConvKernel::workspaceBytes() const {
+  // 맨 앞은 staging, 그다음 worker 마다 scratch_, 그 뒤는 worker 가 나눠 채우는 버퍼
+  int64_t shared = 0;
+  if (algo_ == ConvAlgo::IM2COL_GEMM) {
+    shared = w_[1] * w_[2] * w_[3] * out_[2] * out_[3];
+  } else if (algo_ == ConvAlgo::WINOGRAD_3X3) {
+    shared = kWinogradSize * (in_[1] + out_[1]) * ((out_[2] + 1) / 2) * ((out_[3] + 1) / 2);
+  } else if (algo_ == ConvAlgo::INT8_GEMM) {
+    // u8 열 행렬 뒤에 padding 을 두른 u8 입력 평면
+    const int64_t planes = in_[1] * (in_[2] + 2 * params_.padding[0]) *
+                           (in_[3] + 2 * params_.padding[1]);
+    shared = (int8ColumnsBytes(w_[1] * w_[2] * w_[3], out_[2] * out_[3]) + planes + 3) / 4;
+  }
+  return static_cast<size_t>(staging_ + workers_ * scratch_ + shared) * sizeof(float);
+}
+
+void ConvKernel::run(const float* input, float* output, float* workspace,
+                     const float* residual) const {
+  float* dst = staging_ ? workspace : output;
+  workspace += staging_;
+  switch (algo_) {
+    case ConvAlgo::IM2COL_GEMM:
+    case ConvAlgo::DIRECT_1X1:
+      runGemm(input, dst, workspace, residual, output);
+      return;
+    case ConvAlgo::DEPTHWISE:
+      runDepthwise(input, dst, residual, output);
+      return;
+    case ConvAlgo::WINOGRAD_3X3:
+      runWinograd(input, dst, workspace, residual, output);
+      return;
+    case ConvAlgo::DIRECT_NCHWC:
+      runBlocked(input, dst, residual, output);
+      return;
+    case ConvAlgo::INT8_GEMM:
+      runInt8(input, dst, workspace, residual, output);
+      return;
+    default:
+      kernels::conv2d(input, in_, weight_, w_, bias_, dst, out_, params_);
+      if (epilogue_ || residual) {
+        const int64_t plane = out_[2] * out_[3];
+        for (int64_t n = 0; n < out_[0]; ++n) {
+          for (int64_t c = 0; c < out_[1]; ++c) {
+            finish(dst + (n * out_[1] + c) * plane, residual, output, n, c, 0, plane);
+          }
+        }
+      }
+      return;
+  }
+}
+
+void ConvKernel::finish(float* src, const float* residual, float* output, int64_t n, int64_t c,
+                        int64_t p0, int64_t p1) const {
+  const int64_t lanes = tensor::layoutBlock(out_layout_);
+  const int64_t count = (p1 - p0) * lanes;
+  if (residual) {
+    const float* r = residual + ((n * (out_[1] / lanes) + c) * out_[2] * out_[3] + p0) * lanes;
+    for (int64_t i = 0; i < count; ++i) {
+      src[i] += r[i];
+    }
+  }
+  switch (params_.activation) {
+    case Activation::RELU:
+      kernels::relu(src, count, src);
+      break;
+    case Activation::ELU:
+      kernels::elu(src, count, params_.alpha, src);
+      break;
+    case Activation::SIGMOID:
+      kernels::sigmoid(src, count, src);
+      break;
+    default:
+      break;
+  }
+  if (!staging_) {
+    return;
+  }
+
+  // 픽셀 하나를 target 의 s x s 자리에 (cat 이면 채널 offset 만큼 밀어서) 쓴다
+  const int64_t s  = params_.upsample;
+  const int64_t ow = out_[3], tw = target_[3];
+  float* plane     = output + (n * (target_[1] / lanes) + c + params_.offset / lanes) *
+                              target_[2] * tw * lanes;
+  for (int64_t p = p0; p < p1; ++p) {
+    const float* pixel = src + (p - p0) * lanes;
+    float* corner      = plane + ((p / ow) * s * tw + (p % ow) * s) * lanes;
+    for (int64_t dy = 0; dy < s; ++dy) {
+      for (int64_t dx = 0; dx < s; ++dx) {
+        float* to = corner + (dy * tw + dx) * lanes;
+        for (int64_t l = 0; l < lanes; ++l) {
+          to[l] = pixel[l];
+        }
+      }
+    }
+  }
+}
+
+void ConvKernel::runGemm(const float* input, float* dst, float* workspace, const float* residual,
+                         float* output) const {
+  constexpr int64_t kMR = PackedMatrix::kMR;
+  const int64_t groups  = params_.groups;
+  const int64_t icg     = w_[1];
+  const int64_t ocg     = w_[0] / groups;
+  const int64_t plane   = in_[2] * in_[3];
+  const int64_t n       = out_[2] * out_[3];
+  const bool direct     = algo_ == ConvAlgo::DIRECT_1X1;
+  float* columns        = workspace + workers_ * scratch_;
+
+  // task 는 (kMR 행 panel step 개, kGemmNC 열 블록) 하나. gemm 이 어차피 kGemmNC 열씩 나눠 도는
+  // 경계대로 잘라, 블록이 cache 에 있을 때 epilogue 를 건다
+  const int64_t panels = (ocg + kMR - 1) / kMR;
+  const int64_t chunks = (n + kGemmNC - 1) / kGemmNC;
+  const int64_t step   = panelStep(panels, chunks, workers_);
+  const int64_t blocks = (panels + step - 1) / step;
+
+  for (int64_t b = 0; b < in_[0]; ++b) {
+    for (int64_t g = 0; g < groups; ++g) {
+      const float* src = input + (b * in_[1] + g * icg) * plane;
+      if (!direct) {
+        parallelFor(pool_, icg, 1, [&](int64_t c0, int64_t c1, size_t) {
+          im2col(src, in_, w_, out_, params_, c0, c1, columns);
+        });
+        src = columns;
+      }
+      float* out        = dst + (b * out_[1] + g * ocg) * n;
+      const float* bias = bias_ ? bias_ + g * ocg : nullptr;
+      // 같은 panel 묶음의 열 블록이 이어지므로 한 worker 가 연달아 받은 task 는 A 를 cache 에 둔다
+      parallelFor(pool_, blocks * chunks, 1, [&](int64_t lo, int64_t hi, size_t worker) {
+        float* pack = workspace + worker * scratch_;
+        for (int64_t t = lo; t < hi; ++t) {
+          const int64_t p0   = t / chunks * step;
+          const int64_t p1   = std::min(panels, p0 + step);
+          const int64_t j    = t % chunks * kGemmNC;
+          const int64_t cols = std::min(kGemmNC, n - j);
+          gemm(isa_, packed_[g], src + j, n, cols, out + j, n, bias, pack, p0, p1);
+          if (epilogue_ || residual) {
+            for (int64_t o = p0 * kMR; o < std::min(ocg, p1 * kMR); ++o) {
+              finish(out + o * n + j, residual, output, b, g * ocg + o, j, j + cols);
+            }
+          }
+        }
+      });
+    }
+  }
+}
+
+void ConvKernel::runDepthwise(const float* input, float* dst, const float* residual,
+                              float* output) const {
+  const int64_t kh = w_[2], kw = w_[3];
+  const int64_t sy = params_.stride[0], sx = params_.stride[1];
+  const int64_t py = params_.padding[0], px = params_.padding[1];
+  const int64_t dy = params_.dilation[0], dx = params_.dilation[1];
+
+  // 채널 평면 하나가 task 하나
+  parallelFor(pool_, in_[0] * in_[1], 1, [&](int64_t lo, int64_t hi, size_t) {
+    for (int64_t bc = lo; bc < hi; ++bc) {
+      const int64_t b  = bc / in_[1];
+      const int64_t c  = bc % in_[1];
+      const float* src = input + (b * in_[1] + c) * in_[2] * in_[3];
+      float* plane     = dst + (b * out_[1] + c) * out_[2] * out_[3];
+      const float* k   = weight_ + c * kh * kw;
+      std::fill(plane, plane + out_[2] * out_[3], bias_ ? bias_[c] : 0.0f);
+
+      for (int64_t ky = 0; ky < kh; ++ky) {
+        for (int64_t kx = 0; kx < kw; ++kx) {
+          const float wv    = k[ky * kw + kx];
+          const int64_t off = kx * dx - px;
+          int64_t ox0 = off < 0 ? (-off + sx - 1) / sx : 0;
+          int64_t ox1 = in_[3] - off <= 0 ? 0 : (in_[3] - off + sx - 1) / sx;
+          ox0         = std::min(ox0, out_[3]);
+          ox1         = std::max(ox0, std::min(ox1, out_[3]));
+          for (int64_t oy = 0; oy < out_[2]; ++oy) {
+            int64_t iy = oy * sy - py + ky * dy;
+            if (iy < 0 || iy >= in_[2]) {
+              continue;
+            }
+            const float* row = src + iy * in_[3] + off;
+            float* out_row   = plane + oy * out_[3];
+            axpyStrided(isa_, ox1 - ox0, wv, row + ox0 * sx, sx, out_row + ox0);
+          }
+        }
+      }
+      if (epilogue_ || residual) {
+        finish(plane, residual, output, b, c, 0, out_[2] * out_[3]);
+      }
+    }
+  });
+}
+
+void ConvKernel::runWinograd(const float* input, float* dst, float* workspace,
+                             const float* residual, float* output) const {
+  const int64_t ic = in_[1], oc = out_[1];
+  const int64_t th = (out_[2] + 1) / 2, tw = (out_[3] + 1) / 2;
+  const int64_t tiles = th * tw;
+  const int64_t width = 2 * tw + 2;  // tile 행 하나가 덮는 (padding 포함) 입력 폭
+  float* v            = workspace + workers_ * scratch_;  // [16][ic][tiles]
+  float* m            = v + kWinogradSize * ic * tiles;   // [16][oc][tiles]
+  // worker 별 작업 버퍼는 gemm 묶음 뒤에 [4][width] padding 을 채운 입력 행, [4][width] B^T d,
+  // [2][4][tw] A^T M 순서
+  auto scratch = [&](size_t worker) { return workspace + worker * scratch_; };
+  auto rowsOf  = [&](size_t worker) { return scratch(worker) + kGemmPackFloats; };
+  const WinogradTransforms& transforms = winogradTransforms(isa_);
+
+  for (int64_t b = 0; b < in_[0]; ++b) {
+    // V = B^T d B, B^T = [[1, 0, -1, 0], [0, 1, 1, 0], [0, -1, 1, 0], [0, 1, 0, -1]].
+    // tile 행 단위로 B^T 를 입력 행 전체에 먼저 걸고 (열 방향으로 연속), 그다음 tile 마다 B 를 건다.
+    // 입력 채널 하나가 task 하나
+    parallelFor(pool_, ic, 1, [&](int64_t c0, int64_t c1, size_t worker) {
+      float* rows = rowsOf(worker);
+      float* t    = rows + 4 * width;
+      for (int64_t c = c0; c < c1; ++c) {
+        const float* plane = input + (b * ic + c) * in_[2] * in_[3];
+        for (int64_t ty = 0; ty < th; ++ty) {
+          for (int y = 0; y < 4; ++y) {
+            float* row = rows + y * width;
+            int64_t iy = ty * kWinogradOut + y - params_.padding[0];
+            std::fill(row, row + width, 0.0f);
+            if (iy >= 0 && iy < in_[2]) {
+              int64_t x0 = params_.padding[1];
+              int64_t n  = std::min(in_[3], width - x0);
+              std::memcpy(row + x0, plane + iy * in_[3], n * sizeof(float));
+            }
+          }
+          transforms.input_rows(rows, width, t);
+          for (int y = 0; y < 4; ++y) {
+            float* v0 = v + ((y * 4 + 0) * ic + c) * tiles + ty * tw;
+            float* v1 = v + ((y * 4 + 1) * ic + c) * tiles + ty * tw;
+            float* v2 = v + ((y * 4 + 2) * ic + c) * tiles + ty * tw;
+            float* v3 = v + ((y * 4 + 3) * ic + c) * tiles + ty * tw;
+            transforms.input_tiles(t + y * width, tw, v0, v1, v2, v3);
+          }
+        }
+      }
+    });
+
+    // 좌표 16 개마다 M = U V. task 는 (좌표, kGemmNC 열 블록) 하나
+    const int64_t chunks = (tiles + kGemmNC - 1) / kGemmNC;
+    parallelFor(pool_, kWinogradSize * chunks, 1, [&](int64_t lo, int64_t hi, size_t worker) {
+      for (int64_t task = lo; task < hi; ++task) {
+        const int64_t e    = task / chunks;
+        const int64_t j    = task % chunks * kGemmNC;
+        const int64_t cols = std::min(kGemmNC, tiles - j);
+        gemm(isa_, packed_[e], v + e * ic * tiles + j, tiles, cols, m + e * oc * tiles + j,
+             tiles, nullptr, scratch(worker));
+      }
+    });
+
+    // Y = A^T M A, A^T = [[1, 1, 1, 0], [0, 1, -1, -1]]. 역시 tile 행 단위로 tx 방향 연속.
+    // 출력 채널 하나가 task 하나
+    parallelFor(pool_, oc, 1, [&](int64_t o0, int64_t o1, size_t worker) {
+      float* r = rowsOf(worker) + 8 * width;
+      for (int64_t o = o0; o < o1; ++o) {
+        float* plane     = dst + (b * oc + o) * out_[2] * out_[3];
+        const float bias = bias_ ? bias_[o] : 0.0f;
+        for (int64_t ty = 0; ty < th; ++ty) {
+          for (int x = 0; x < 4; ++x) {
+            const float* s0 = m + ((0 * 4 + x) * oc + o) * tiles + ty * tw;
+            const float* s1 = m + ((1 * 4 + x) * oc + o) * tiles + ty * tw;
+            const float* s2 = m + ((2 * 4 + x) * oc + o) * tiles + ty * tw;
+            const float* s3 = m + ((3 * 4 + x) * oc + o) * tiles + ty * tw;
+            transforms.output_rows(s0, s1, s2, s3, tw, r + x * tw, r + (4 + x) * tw);
+          }
+          for (int y = 0; y < kWinogradOut; ++y) {
+            int64_t oy = ty * kWinogradOut + y;
+            if (oy >= out_[2]) {
+              break;
+            }
+            const float* q0    = r + (y * 4 + 0) * tw;
+            const float* q1    = r + (y * 4 + 1) * tw;
+            const float* q2    = r + (y * 4 + 2) * tw;
+            const float* q3    = r + (y * 4 + 3) * tw;
+            float* out_row     = plane + oy * out_[3];
+            const int64_t full = out_[3] / 2;
+            transforms.output_tiles(q0, q1, q2, q3, full, bias, out_row);
+            if (full < tw) {
+              out_row[2 * full] = q0[full] + q1[full] + q2[full] + bias;
+            }
+          }
+        }
+        if (epilogue_ || residual) {
+          finish(plane, residual, output, b, o, 0, out_[2] * out_[3]);
+        }
+      }
+    });
+  }
+}
+
+void ConvKernel::runBlocked(const float* input, float* dst, const float* residual,
+                            float* output) const {
+  const bool depthwise = params_.groups > 1;
+  const int64_t ib     = tensor::layoutBlock(in_layout_);
+  const int64_t ob     = tensor::layoutBlock(out_layout_);
+  const int64_t ih = in_[2], iw = in_[3];
+  const int64_t oh = out_[2], ow = out_[3];
+  const int64_t kh = w_[2], kw = w_[3];
+  const int64_t sy = params_.stride[0], sx = params_.stride[1];
+  const int64_t py = params_.padding[0], px = params_.padding[1];
+  const int64_t dy = params_.dilation[0], dx = params_.dilation[1];
+  const int64_t in_blocks  = in_[1] / ib;
+  const int64_t out_blocks = out_[1] / ob;
+
+  const BlockedKernel* tiles;
+  int64_t max_pixels;
+  blockedTiles(isa_, ob, depthwise, sx * ib, &tiles, &max_pixels);
+
+  BlockedTile t;
+  t.in_blocks     = depthwise ? 1 : in_blocks;
+  t.ib            = ib;
+  t.plane_stride  = ih * iw * ib;
+  t.row_stride    = iw * ib;
+  t.pixel_step    = sx * ib;
+  t.weight_stride = kh * kw * (depthwise ? 1 : ib) * ob;
+  t.kw            = kw;
+  t.dy            = dy;
+  t.dx            = dx;
+
+  // 모든 kx 가 입력 안에 드는 출력 열 [lo, hi). 나머지 가장자리 픽셀은 하나씩 tap 범위를 잘라 계산한다
+  const int64_t lo   = std::min(ow, (px + sx - 1) / sx);
+  const int64_t last = iw - 1 + px - (kw - 1) * dx;
+  const int64_t hi   = std::max(lo, std::min(ow, last < 0 ? 0 : last / sx + 1));
+  auto edge         = [&](BlockedTile& tile, int64_t ox, float* row_out) {
+    tile.ix0    = ox * sx - px;
+    tile.output = row_out + ox * ob;
+    tapRange(tile.ix0, dx, kw, iw, &tile.kx0, &tile.kx1);
+    tiles[1](tile);
+  };
+
+  // 출력 행 하나 (배치, 출력 채널 묶음, oy) 가 task 하나. 이어진 행은 같은 weight 묶음을 쓴다
+  const float* weight = blocked_weight_;
+  parallelFor(pool_, in_[0] * out_blocks * oh, 1, [&](int64_t row0, int64_t row1, size_t) {
+    BlockedTile tile = t;
+    for (int64_t row = row0; row < row1; ++row) {
+      const int64_t n  = row / (out_blocks * oh);
+      const int64_t b  = row / oh % out_blocks;
+      const int64_t oy = row % oh;
+      tile.input       = depthwise ? input + (n * in_blocks + b) * t.plane_stride
+                                   : input + n * in_blocks * t.plane_stride;
+      tile.weight      = weight + b * t.in_blocks * t.weight_stride;
+      tile.bias        = bias_ ? bias_ + b * ob : nullptr;
+      float* row_out   = dst + ((n * out_blocks + b) * oh + oy) * ow * ob;
+      tile.iy0         = oy * sy - py;
+      tapRange(tile.iy0, dy, kh, ih, &tile.ky0, &tile.ky1);
+
+      for (int64_t ox = 0; ox < lo; ++ox) {
+        edge(tile, ox, row_out);
+      }
+      tile.kx0 = 0;
+      tile.kx1 = kw;
+      for (int64_t ox = lo; ox < hi;) {
+        const int64_t count = std::min(max_pixels, hi - ox);
+        tile.ix0            = ox * sx - px;
+        tile.output         = row_out + ox * ob;
+        tiles[count](tile);
+        ox += count;
+      }
+      for (int64_t ox = hi; ox < ow; ++ox) {
+        edge(tile, ox, row_out);
+      }
+      if (epilogue_ || residual) {
+        finish(row_out, residual, output, n, b, oy * ow, (oy + 1) * ow);
+      }
+    }
+  });
+}
+
+void ConvKernel::runInt8(const float* input, float* dst, float* workspace, const float* residual,
+                         float* output) const {
+  constexpr int64_t kMR = QuantizedMatrix::kMR;
+  const int64_t plane   = in_[2] * in_[3];
+  const int64_t n       = out_[2] * out_[3];
+  const int64_t quads   = quantized_.quads();
+  auto* columns         = reinterpret_cast<uint8_t*>(workspace + workers_ * scratch_);
+  uint8_t* planes       = columns + int8ColumnsBytes(w_[1] * w_[2] * w_[3], n);
+
+  // runGemm 과 같이 (kMR 행 panel step 개, kGemmNC 열 블록) 이 task 하나
+  const int64_t panels = (out_[1] + kMR - 1) / kMR;
+  const int64_t chunks = (n + kGemmNC - 1) / kGemmNC;
+  const int64_t step   = panelStep(panels, chunks, workers_);
+  const int64_t blocks = (panels + step - 1) / step;
+
+  for (int64_t b = 0; b < in_[0]; ++b) {
+    const float* src = input + b * in_[1] * plane;
+    // 입력을 한 번만 양자화하고 (3x3 이면 im2col 원소의 1/9), 열은 u8 그대로 모은다
+    parallelFor(pool_, in_[1], 1, [&](int64_t c0, int64_t c1, size_t) {
+      quantizePlanes(src, in_, params_, c0, c1, planes);
+    });
+    parallelFor(pool_, quads, 4, [&](int64_t q0, int64_t q1, size_t) {
+      gatherColumns(planes, in_, w_, out_, params_, q0, q1, quads, columns);
+    });
+    float* out = dst + b * out_[1] * n;
+    parallelFor(pool_, blocks * chunks, 1, [&](int64_t lo, int64_t hi, size_t) {
+      for (int64_t t = lo; t < hi; ++t) {
+        const int64_t p0   = t / chunks * step;
+        const int64_t p1   = std::min(panels, p0 + step);
+        const int64_t j    = t % chunks * kGemmNC;
+        const int64_t cols = std::min(kGemmNC, n - j);
+        gemmInt8(isa_, quantized_, columns, n, params_.input_zero, scale_, bias_, out, n,
+                 p0, p1, j, j + cols);
+        if (epilogue_ || residual) {
+          for (int64_t o = p0 * kMR; o < std::min(out_[1], p1 * kMR); ++o) {
+            finish(out + o * n + j, residual, output, b, o, j, j + cols);
+          }
+        }
+      }
+    });
+  }
+}
+
+}  // namespace engine
+}  // namespace tfe
@@ -0,0 +1,413 @@
+#include "engine/conv_nchwc.h"
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+#if TFE_HAS_X86_SIMD
+#include <immintrin.h>
+#endif
+#if TFE_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+/**
+ * @brief 픽셀 간격. STEP 이 0 이 아니면 컴파일 시간 상수라 픽셀 r 의 주소가 immediate offset 으로 접힌다
+ *        (GPR 이 모자라 주소를 spill 하지 않도록)
+ */
+template <int STEP>
+inline int64_t pixelStep(const BlockedTile& t) {
+  return STEP ? STEP : t.pixel_step;
+}
+
+/**
+ * @brief 픽셀이 적은 tile 은 FMA latency 가 드러나므로 입력 lane 을 몇 갈래로 나눠 따로 쌓는다
+ */
+constexpr int splitsFor(int pixels) { return pixels < 4 ? 4 / pixels : 1; }
+
+/**
+ * @brief Kernel::run<R, STEP> 을 R = 1..N 으로 편 표 (0 번은 비워 둔다)
+ */
+template <class Kernel, int STEP, int... R>
+constexpr std::array<BlockedKernel, sizeof...(R) + 1> makeTiles(std::integer_sequence<int, R...>) {
+  return {{nullptr, &Kernel::template run<R + 1, STEP>...}};
+}
+
+template <class Kernel, int STEP, int N>
+constexpr std::array<BlockedKernel, N + 1> kTiles =
+    makeTiles<Kernel, STEP>(std::make_integer_sequence<int, N>());
+
+constexpr int kScalarPixels = 4;
+
+template <int OB>
+struct ScalarTile {
+  template <int R, int STEP>
+  static void run(const BlockedTile& t) {
+    const int64_t step = pixelStep<STEP>(t);
+    float acc[R][OB];
+    for (int r = 0; r < R; ++r) {
+      for (int o = 0; o < OB; ++o) {
+        acc[r][o] = t.bias ? t.bias[o] : 0.0f;
+      }
+    }
+    for (int64_t b = 0; b < t.in_blocks; ++b) {
+      const float* plane = t.input + b * t.plane_stride;
+      const float* wb    = t.weight + b * t.weight_stride;
+      for (int64_t ky = t.ky0; ky < t.ky1; ++ky) {
+        const float* row = plane + (t.iy0 + ky * t.dy) * t.row_stride;
+        for (int64_t kx = t.kx0; kx < t.kx1; ++kx) {
+          const float* x = row + (t.ix0 + kx * t.dx) * t.ib;
+          const float* w = wb + (ky * t.kw + kx) * t.ib * OB;
+          for (int64_t i = 0; i < t.ib; ++i) {
+            for (int r = 0; r < R; ++r) {
+              const float xv = x[r * step + i];
+              for (int o = 0; o < OB; ++o) {
+                acc[r][o] += xv * w[i * OB + o];
+              }
+            }
+          }
+        }
+      }
+    }
+    for (int r = 0; r < R; ++r) {
+      std::memcpy(t.output + r * OB, acc[r], sizeof(acc[r]));
+    }
+  }
+};
+
+template <int OB>
+struct ScalarDepthwise {
+  template <int R, int STEP>
+  static void run(const BlockedTile& t) {
+    const int64_t step = pixelStep<STEP>(t);
+    float acc[R][OB];
+    for (int r = 0; r < R; ++r) {
+      for (int o = 0; o < OB; ++o) {
+        acc[r][o] = t.bias ? t.bias[o] : 0.0f;
+      }
+    }
+    for (int64_t ky = t.ky0; ky < t.ky1; ++ky) {
+      const float* row = t.input + (t.iy0 + ky * t.dy) * t.row_stride;
+      for (int64_t kx = t.kx0; kx < t.kx1; ++kx) {
+        const float* x = row + (t.ix0 + kx * t.dx) * OB;
+        const float* w = t.weight + (ky * t.kw + kx) * OB;
+        for (int r = 0; r < R; ++r) {
+          for (int o = 0; o < OB; ++o) {
+            acc[r][o] += x[r * step + o] * w[o];
+          }
+        }
+      }
+    }
+    for (int r = 0; r < R; ++r) {
+      std::memcpy(t.output + r * OB, acc[r], sizeof(acc[r]));
+    }
+  }
+};
+
+#if TFE_HAS_X86_SIMD
+constexpr int kAvx2Pixels = 12;  // 누산기 12 + weight 1 + broadcast 1 (ymm 16 개)
+
+struct Avx2Tile {
+  template <int R, int STEP>
+  __attribute__((target("avx2,fma"))) static void run(const BlockedTile& t) {
+    constexpr int S    = splitsFor(R);
+    const int64_t step = pixelStep<STEP>(t);
+    __m256 acc[R][S];
+#pragma GCC unroll 16
+    for (int r = 0; r < R; ++r) {
+      acc[r][0] = t.bias ? _mm256_loadu_ps(t.bias) : _mm256_setzero_ps();
+      for (int s = 1; s < S; ++s) {
+        acc[r][s] = _mm256_setzero_ps();
+      }
+    }
+    for (int64_t b = 0; b < t.in_blocks; ++b) {
+      const float* plane = t.input + b * t.plane_stride;
+      const float* wb    = t.weight + b * t.weight_stride;
+      for (int64_t ky = t.ky0; ky < t.ky1; ++ky) {
+        const float* row = plane + (t.iy0 + ky * t.dy) * t.row_stride;
+        for (int64_t kx = t.kx0; kx < t.kx1; ++kx) {
+          const float* x = row + (t.ix0 + kx * t.dx) * t.ib;
+          const float* w = wb + (ky * t.kw + kx) * t.ib * 8;
+          int64_t i      = 0;
+          for (; i + S <= t.ib; i += S) {
+#pragma GCC unroll 4
+            for (int s = 0; s < S; ++s) {
+              const __m256 wv = _mm256_loadu_ps(w + (i + s) * 8);
+#pragma GCC unroll 16
+              for (int r = 0; r < R; ++r) {
+                acc[r][s] =
+                    _mm256_fmadd_ps(_mm256_broadcast_ss(x + r * step + i + s), wv, acc[r][s]);
+              }
+            }
+          }
+          for (; i < t.ib; ++i) {
+            const __m256 wv = _mm256_loadu_ps(w + i * 8);
+#pragma GCC unroll 16
+            for (int r = 0; r < R; ++r) {
+              acc[r][0] = _mm256_fmadd_ps(_mm256_broadcast_ss(x + r * step + i), wv, acc[r][0]);
+            }
+          }
+        }
+      }
+    }
+#pragma GCC unroll 16
+    for (int r = 0; r < R; ++r) {
+      for (int s = 1; s < S; ++s) {
+        acc[r][0] = _mm256_add_ps(acc[r][0], acc[r][s]);
+      }
+      _mm256_storeu_ps(t.output + r * 8, acc[r][0]);
+    }
+  }
+};
+
+struct Avx2Depthwise {
+  template <int R, int STEP>
+  __attribute__((target("avx2,fma"))) static void run(const BlockedTile& t) {
+    const int64_t step = pixelStep<STEP>(t);
+    __m256 acc[R];
+    const __m256 bias = t.bias ? _mm256_loadu_ps(t.bias) : _mm256_setzero_ps();
+#pragma GCC unroll 16
+    for (int r = 0; r < R; ++r) {
+      acc[r] = bias;
+    }
+    for (int64_t ky = t.ky0; ky < t.ky1; ++ky) {
+      const float* row = t.input + (t.iy0 + ky * t.dy) * t.row_stride;
+      for (int64_t kx = t.kx0; kx < t.kx1; ++kx) {
+        const float* x  = row + (t.ix0 + kx * t.dx) * 8;
+        const __m256 wv = _mm256_loadu_ps(t.weight + (ky * t.kw + kx) * 8);
+#pragma GCC unroll 16
+        for (int r = 0; r < R; ++r) {
+          acc[r] = _mm256_fmadd_ps(_mm256_loadu_ps(x + r * step), wv, acc[r]);
+        }
+      }
+    }
+#pragma GCC unroll 16
+    for (int r = 0; r < R; ++r) {
+      _mm256_storeu_ps(t.output + r * 8, acc[r]);
+    }
+  }
+};
+
+constexpr int kAvx512Pixels = 14;  // 56 / 28 / 14 / 7 폭의 행이 나머지 없이 나뉜다
+
+struct Avx512Tile {
+  template <int R, int STEP>
+  __attribute__((target("avx512f"))) static void run(const BlockedTile& t) {
+    constexpr int S    = splitsFor(R);
+    const int64_t step = pixelStep<STEP>(t);
+    __m512 acc[R][S];
+#pragma GCC unroll 16
+    for (int r = 0; r < R; ++r) {
+      acc[r][0] = t.bias ? _mm512_loadu_ps(t.bias) : _mm512_setzero_ps();
+      for (int s = 1; s < S; ++s) {
+        acc[r][s] = _mm512_setzero_ps();
+      }
+    }
+    for (int64_t b = 0; b < t.in_blocks; ++b) {
+      const float* plane = t.input + b * t.plane_stride;
+      const float* wb    = t.weight + b * t.weight_stride;
+      for (int64_t ky = t.ky0; ky < t.ky1; ++ky) {
+        const float* row = plane + (t.iy0 + ky * t.dy) * t.row_stride;
+        for (int64_t kx = t.kx0; kx < t.kx1; ++kx) {
+          const float* x = row + (t.ix0 + kx * t.dx) * t.ib;
+          const float* w = wb + (ky * t.kw + kx) * t.ib * 16;
+          int64_t i      = 0;
+          for (; i + S <= t.ib; i += S) {
+#pragma GCC unroll 4
+            for (int s = 0; s < S; ++s) {
+              const __m512 wv = _mm512_loadu_ps(w + (i + s) * 16);
+#pragma GCC unroll 16
+              for (int r = 0; r < R; ++r) {
+                acc[r][s] = _mm512_fmadd_ps(_mm512_set1_ps(x[r * step + i + s]), wv, acc[r][s]);
+              }
+            }
+          }
+          for (; i < t.ib; ++i) {
+            const __m512 wv = _mm512_loadu_ps(w + i * 16);
+#pragma GCC unroll 16
+            for (int r = 0; r < R; ++r) {
+              acc[r][0] = _mm512_fmadd_ps(_mm512_set1_ps(x[r * step + i]), wv, acc[r][0]);
+            }
+          }
+        }
+      }
+    }
+#pragma GCC unroll 16
+    for (int r = 0; r < R; ++r) {
+      for (int s = 1; s < S; ++s) {
+        acc[r][0] = _mm512_add_ps(acc[r][0], acc[r][s]);
+      }
+      _mm512_storeu_ps(t.output + r * 16, acc[r][0]);
+    }
+  }
+};
+
+struct Avx512Depthwise {
+  template <int R, int STEP>
+  __attribute__((target("avx512f"))) static void run(const BlockedTile& t) {
+    const int64_t step = pixelStep<STEP>(t);
+    __m512 acc[R];
+    const __m512 bias = t.bias ? _mm512_loadu_ps(t.bias) : _mm512_setzero_ps();
+#pragma GCC unroll 16
+    for (int r = 0; r < R; ++r) {
+      acc[r] = bias;
+    }
+    for (int64_t ky = t.ky0; ky < t.ky1; ++ky) {
+      const float* row = t.input + (t.iy0 + ky * t.dy) * t.row_stride;
+      for (int64_t kx = t.kx0; kx < t.kx1; ++kx) {
+        const float* x  = row + (t.ix0 + kx * t.dx) * 16;
+        const __m512 wv = _mm512_loadu_ps(t.weight + (ky * t.kw + kx) * 16);
+#pragma GCC unroll 16
+        for (int r = 0; r < R; ++r) {
+          acc[r] = _mm512_fmadd_ps(_mm512_loadu_ps(x + r * step), wv, acc[r]);
+        }
+      }
+    }
+#pragma GCC unroll 16
+    for (int r = 0; r < R; ++r) {
+      _mm512_storeu_ps(t.output + r * 16, acc[r]);
+    }
+  }
+};
+#endif  // TFE_HAS_X86_SIMD
+
+#if TFE_HAS_NEON
+constexpr int kNeonPixels = 8;  // 누산기 16 + weight 2 (q 레지스터 32 개)
+
+struct NeonTile {
+  template <int R, int STEP>
+  static void run(const BlockedTile& t) {
+    constexpr int S    = splitsFor(R);
+    const int64_t step = pixelStep<STEP>(t);
+    float32x4_t acc[R][S][2];
+    for (int r = 0; r < R; ++r) {
+      acc[r][0][0] = t.bias ? vld1q_f32(t.bias) : vdupq_n_f32(0.0f);
+      acc[r][0][1] = t.bias ? vld1q_f32(t.bias + 4) : vdupq_n_f32(0.0f);
+      for (int s = 1; s < S; ++s) {
+        acc[r][s][0] = acc[r][s][1] = vdupq_n_f32(0.0f);
+      }
+    }
+    for (int64_t b = 0; b < t.in_blocks; ++b) {
+      const float* plane = t.input + b * t.plane_stride;
+      const float* wb    = t.weight + b * t.weight_stride;
+      for (int64_t ky = t.ky0; ky < t.ky1; ++ky) {
+        const float* row = plane + (t.iy0 + ky * t.dy) * t.row_stride;
+        for (int64_t kx = t.kx0; kx < t.kx1; ++kx) {
+          const float* x = row + (t.ix0 + kx * t.dx) * t.ib;
+          const float* w = wb + (ky * t.kw + kx) * t.ib * 8;
+          int64_t i      = 0;
+          for (; i + S <= t.ib; i += S) {
+            for (int s = 0; s < S; ++s) {
+              const float32x4_t w0 = vld1q_f32(w + (i + s) * 8);
+              const float32x4_t w1 = vld1q_f32(w + (i + s) * 8 + 4);
+              for (int r = 0; r < R; ++r) {
+                const float xv = x[r * step + i + s];
+                acc[r][s][0]   = vfmaq_n_f32(acc[r][s][0], w0, xv);
+                acc[r][s][1]   = vfmaq_n_f32(acc[r][s][1], w1, xv);
+              }
+            }
+          }
+          for (; i < t.ib; ++i) {
+            const float32x4_t w0 = vld1q_f32(w + i * 8);
+            const float32x4_t w1 = vld1q_f32(w + i * 8 + 4);
+            for (int r = 0; r < R; ++r) {
+              const float xv = x[r * step + i];
+              acc[r][0][0]   = vfmaq_n_f32(acc[r][0][0], w0, xv);
+              acc[r][0][1]   = vfmaq_n_f32(acc[r][0][1], w1, xv);
+            }
+          }
+        }
+      }
+    }
+    for (int r = 0; r < R; ++r) {
+      for (int s = 1; s < S; ++s) {
+        acc[r][0][0] = vaddq_f32(acc[r][0][0], acc[r][s][0]);
+        acc[r][0][1] = vaddq_f32(acc[r][0][1], acc[r][s][1]);
+      }
+      vst1q_f32(t.output + r * 8, acc[r][0][0]);
+      vst1q_f32(t.output + r * 8 + 4, acc[r][0][1]);
+    }
+  }
+};
+
+struct NeonDepthwise {
+  template <int R, int STEP>
+  static void run(const BlockedTile& t) {
+    const int64_t step = pixelStep<STEP>(t);
+    float32x4_t acc[R][2];
+    for (int r = 0; r < R; ++r) {
+      acc[r][0] = t.bias ? vld1q_f32(t.bias) : vdupq_n_f32(0.0f);
+      acc[r][1] = t.bias ? vld1q_f32(t.bias + 4) : vdupq_n_f32(0.0f);
+    }
+    for (int64_t ky = t.ky0; ky < t.ky1; ++ky) {
+      const float* row = t.input + (t.iy0 + ky * t.dy) * t.row_stride;
+      for (int64_t kx = t.kx0; kx < t.kx1; ++kx) {
+        const float* x       = row + (t.ix0 + kx * t.dx) * 8;
+        const float* w       = t.weight + (ky * t.kw + kx) * 8;
+        const float32x4_t w0 = vld1q_f32(w);
+        const float32x4_t w1 = vld1q_f32(w + 4);
+        for (int r = 0; r < R; ++r) {
+          acc[r][0] = vfmaq_f32(acc[r][0], vld1q_f32(x + r * step), w0);
+          acc[r][1] = vfmaq_f32(acc[r][1], vld1q_f32(x + r * step + 4), w1);
+        }
+      }
+    }
+    for (int r = 0; r < R; ++r) {
+      vst1q_f32(t.output + r * 8, acc[r][0]);
+      vst1q_f32(t.output + r * 8 + 4, acc[r][1]);
+    }
+  }
+};
+#endif  // TFE_HAS_NEON
+
+/**
+ * @brief 픽셀 간격이 묶음 하나 (stride 1 의 묶인 입력) 이면 상수 간격 표, 아니면 일반 표
+ */
+template <class Tile, class Depthwise, int OB, int N>
+const BlockedKernel* pick(bool depthwise, bool unit_step) {
+  if (depthwise) {
+    return unit_step ? kTiles<Depthwise, OB, N>.data() : kTiles<Depthwise, 0, N>.data();
+  }
+  return unit_step ? kTiles<Tile, OB, N>.data() : kTiles<Tile, 0, N>.data();
+}
+
+}  // namespace
+
+void blockedTiles(Isa isa, int64_t ob, bool depthwise, int64_t pixel_step,
+                  const BlockedKernel** tiles, int64_t* max_pixels) {
+  const bool unit = pixel_step == ob;
+#if TFE_HAS_X86_SIMD
+  // AVX-512F 를 갖춘 CPU 는 AVX2 / FMA 도 갖고 있다
+  if (ob == 16 && isa == Isa::AVX512) {
+    *tiles      = pick<Avx512Tile, Avx512Depthwise, 16, kAvx512Pixels>(depthwise, unit);
+    *max_pixels = kAvx512Pixels;
+    return;
+  }
+  if (ob == 8 && (isa == Isa::AVX2 || isa == Isa::AVX512)) {
+    *tiles      = pick<Avx2Tile, Avx2Depthwise, 8, kAvx2Pixels>(depthwise, unit);
+    *max_pixels = kAvx2Pixels;
+    return;
+  }
+#endif
+#if TFE_HAS_NEON
+  if (ob == 8 && isa == Isa::NEON) {
+    *tiles      = pick<NeonTile, NeonDepthwise, 8, kNeonPixels>(depthwise, unit);
+    *max_pixels = kNeonPixels;
+    return;
+  }
+#endif
+  if (ob == 16) {
+    *tiles = pick<ScalarTile<16>, ScalarDepthwise<16>, 16, kScalarPixels>(depthwise, unit);
+  } else {
+    *tiles = pick<ScalarTile<8>, ScalarDepthwise<8>, 8, kScalarPixels>(depthwise, unit);
+  }
+  *max_pixels = kScalarPixels;
+}
+
+}  // namespace engine
+}  // namespace tfe
@@ -0,0 +1,224 @@
+#include "engine/conv_winograd.h"
+
+#if TFE_HAS_X86_SIMD
+#include <immintrin.h>
+#endif
+#if TFE_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+// 벡터 폭으로 나누고 남은 열 [x, n) 을 scalar 로 마저 계산한다
+void inputRowsTail(const float* d, int64_t width, float* t, int64_t x) {
+  const float *d0 = d, *d1 = d + width, *d2 = d + 2 * width, *d3 = d + 3 * width;
+  for (; x < width; ++x) {
+    t[x]             = d0[x] - d2[x];
+    t[width + x]     = d1[x] + d2[x];
+    t[2 * width + x] = d2[x] - d1[x];
+    t[3 * width + x] = d1[x] - d3[x];
+  }
+}
+
+void inputTilesTail(const float* e, int64_t tiles, float* v0, float* v1, float* v2, float* v3,
+                    int64_t tx) {
+  for (; tx < tiles; ++tx) {
+    const float* p = e + 2 * tx;
+    v0[tx]         = p[0] - p[2];
+    v1[tx]         = p[1] + p[2];
+    v2[tx]         = p[2] - p[1];
+    v3[tx]         = p[1] - p[3];
+  }
+}
+
+void outputRowsTail(const float* s0, const float* s1, const float* s2, const float* s3, int64_t n,
+                    float* r0, float* r1, int64_t i) {
+  for (; i < n; ++i) {
+    r0[i] = s0[i] + s1[i] + s2[i];
+    r1[i] = s1[i] - s2[i] - s3[i];
+  }
+}
+
+void outputTilesTail(const float* q0, const float* q1, const float* q2, const float* q3,
+                     int64_t n, float bias, float* out, int64_t tx) {
+  for (; tx < n; ++tx) {
+    out[2 * tx]     = q0[tx] + q1[tx] + q2[tx] + bias;
+    out[2 * tx + 1] = q1[tx] - q2[tx] - q3[tx] + bias;
+  }
+}
+
+void inputRowsScalar(const float* d, int64_t width, float* t) { inputRowsTail(d, width, t, 0); }
+
+void inputTilesScalar(const float* e, int64_t tiles, float* v0, float* v1, float* v2, float* v3) {
+  inputTilesTail(e, tiles, v0, v1, v2, v3, 0);
+}
+
+void outputRowsScalar(const float* s0, const float* s1, const float* s2, const float* s3,
+                      int64_t n, float* r0, float* r1) {
+  outputRowsTail(s0, s1, s2, s3, n, r0, r1, 0);
+}
+
+void outputTilesScalar(const float* q0, const float* q1, const float* q2, const float* q3,
+                       int64_t n, float bias, float* out) {
+  outputTilesTail(q0, q1, q2, q3, n, bias, out, 0);
+}
+
+#if TFE_HAS_X86_SIMD
+__attribute__((target("avx2"))) void inputRowsAvx2(const float* d, int64_t width, float* t) {
+  const float *d0 = d, *d1 = d + width, *d2 = d + 2 * width, *d3 = d + 3 * width;
+  int64_t x       = 0;
+  for (; x + 8 <= width; x += 8) {
+    const __m256 a = _mm256_loadu_ps(d0 + x), b = _mm256_loadu_ps(d1 + x);
+    const __m256 c = _mm256_loadu_ps(d2 + x), e = _mm256_loadu_ps(d3 + x);
+    _mm256_storeu_ps(t + x, _mm256_sub_ps(a, c));
+    _mm256_storeu_ps(t + width + x, _mm256_add_ps(b, c));
+    _mm256_storeu_ps(t + 2 * width + x, _mm256_sub_ps(c, b));
+    _mm256_storeu_ps(t + 3 * width + x, _mm256_sub_ps(b, e));
+  }
+  inputRowsTail(d, width, t, x);
+}
+
+/**
+ * @brief p[0..15] 의 짝수 / 홀수 열 8 개씩
+ */
+__attribute__((target("avx2"))) inline void splitAvx2(const float* p, __m256* even, __m256* odd) {
+  const __m256 lo = _mm256_loadu_ps(p), hi = _mm256_loadu_ps(p + 8);
+  // shuffle 은 128 bit 반쪽 안에서만 고르므로 64 bit 단위로 다시 늘어놓는다
+  *even = _mm256_castpd_ps(
+      _mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(lo, hi, 0x88)), 0xD8));
+  *odd = _mm256_castpd_ps(
+      _mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(lo, hi, 0xDD)), 0xD8));
+}
+
+__attribute__((target("avx2"))) void inputTilesAvx2(const float* e, int64_t tiles, float* v0,
+                                                    float* v1, float* v2, float* v3) {
+  int64_t tx = 0;
+  // tile tx .. tx+7 은 e[2 tx .. 2 tx + 17] 을 읽는다 (행 폭 2 * tiles + 2 안)
+  for (; tx + 8 <= tiles; tx += 8) {
+    __m256 e0, e1, e2, e3;
+    splitAvx2(e + 2 * tx, &e0, &e1);
+    splitAvx2(e + 2 * tx + 2, &e2, &e3);
+    _mm256_storeu_ps(v0 + tx, _mm256_sub_ps(e0, e2));
+    _mm256_storeu_ps(v1 + tx, _mm256_add_ps(e1, e2));
+    _mm256_storeu_ps(v2 + tx, _mm256_sub_ps(e2, e1));
+    _mm256_storeu_ps(v3 + tx, _mm256_sub_ps(e1, e3));
+  }
+  inputTilesTail(e, tiles, v0, v1, v2, v3, tx);
+}
+
+__attribute__((target("avx2"))) void outputRowsAvx2(const float* s0, const float* s1,
+                                                    const float* s2, const float* s3, int64_t n,
+                                                    float* r0, float* r1) {
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256 a = _mm256_loadu_ps(s0 + i), b = _mm256_loadu_ps(s1 + i);
+    const __m256 c = _mm256_loadu_ps(s2 + i), d = _mm256_loadu_ps(s3 + i);
+    _mm256_storeu_ps(r0 + i, _mm256_add_ps(_mm256_add_ps(a, b), c));
+    _mm256_storeu_ps(r1 + i, _mm256_sub_ps(_mm256_sub_ps(b, c), d));
+  }
+  outputRowsTail(s0, s1, s2, s3, n, r0, r1, i);
+}
+
+__attribute__((target("avx2"))) void outputTilesAvx2(const float* q0, const float* q1,
+                                                     const float* q2, const float* q3, int64_t n,
+                                                     float bias, float* out) {
+  const __m256 vb = _mm256_set1_ps(bias);
+  int64_t tx      = 0;
+  for (; tx + 8 <= n; tx += 8) {
+    const __m256 a  = _mm256_loadu_ps(q0 + tx), b = _mm256_loadu_ps(q1 + tx);
+    const __m256 c  = _mm256_loadu_ps(q2 + tx), d = _mm256_loadu_ps(q3 + tx);
+    const __m256 y0 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(a, b), c), vb);
+    const __m256 y1 = _mm256_add_ps(_mm256_sub_ps(_mm256_sub_ps(b, c), d), vb);
+    // unpack 은 128 bit 반쪽마다 엮으므로 반쪽을 바꿔 끼워 순서대로 쓴다
+    const __m256 lo = _mm256_unpacklo_ps(y0, y1), hi = _mm256_unpackhi_ps(y0, y1);
+    _mm256_storeu_ps(out + 2 * tx, _mm256_permute2f128_ps(lo, hi, 0x20));
+    _mm256_storeu_ps(out + 2 * tx + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+  }
+  outputTilesTail(q0, q1, q2, q3, n, bias, out, tx);
+}
+#endif  // TFE_HAS_X86_SIMD
+
+#if TFE_HAS_NEON
+void inputRowsNeon(const float* d, int64_t width, float* t) {
+  const float *d0 = d, *d1 = d + width, *d2 = d + 2 * width, *d3 = d + 3 * width;
+  int64_t x       = 0;
+  for (; x + 4 <= width; x += 4) {
+    const float32x4_t a = vld1q_f32(d0 + x), b = vld1q_f32(d1 + x);
+    const float32x4_t c = vld1q_f32(d2 + x), e = vld1q_f32(d3 + x);
+    vst1q_f32(t + x, vsubq_f32(a, c));
+    vst1q_f32(t + width + x, vaddq_f32(b, c));
+    vst1q_f32(t + 2 * width + x, vsubq_f32(c, b));
+    vst1q_f32(t + 3 * width + x, vsubq_f32(b, e));
+  }
+  inputRowsTail(d, width, t, x);
+}
+
+void inputTilesNeon(const float* e, int64_t tiles, float* v0, float* v1, float* v2, float* v3) {
+  int64_t tx = 0;
+  // vld2q 가 짝수 / 홀수 열을 나눠 읽는다. tile tx .. tx+3 은 e[2 tx .. 2 tx + 9] 까지
+  for (; tx + 4 <= tiles; tx += 4) {
+    const float32x4x2_t a = vld2q_f32(e + 2 * tx);
+    const float32x4x2_t b = vld2q_f32(e + 2 * tx + 2);
+    vst1q_f32(v0 + tx, vsubq_f32(a.val[0], b.val[0]));
+    vst1q_f32(v1 + tx, vaddq_f32(a.val[1], b.val[0]));
+    vst1q_f32(v2 + tx, vsubq_f32(b.val[0], a.val[1]));
+    vst1q_f32(v3 + tx, vsubq_f32(a.val[1], b.val[1]));
+  }
+  inputTilesTail(e, tiles, v0, v1, v2, v3, tx);
+}
+
+void outputRowsNeon(const float* s0, const float* s1, const float* s2, const float* s3, int64_t n,
+                    float* r0, float* r1) {
+  int64_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const float32x4_t a = vld1q_f32(s0 + i), b = vld1q_f32(s1 + i);
+    const float32x4_t c = vld1q_f32(s2 + i), d = vld1q_f32(s3 + i);
+    vst1q_f32(r0 + i, vaddq_f32(vaddq_f32(a, b), c));
+    vst1q_f32(r1 + i, vsubq_f32(vsubq_f32(b, c), d));
+  }
+  outputRowsTail(s0, s1, s2, s3, n, r0, r1, i);
+}
+
+void outputTilesNeon(const float* q0, const float* q1, const float* q2, const float* q3,
+                     int64_t n, float bias, float* out) {
+  const float32x4_t vb = vdupq_n_f32(bias);
+  int64_t tx           = 0;
+  for (; tx + 4 <= n; tx += 4) {
+    const float32x4_t a = vld1q_f32(q0 + tx), b = vld1q_f32(q1 + tx);
+    const float32x4_t c = vld1q_f32(q2 + tx), d = vld1q_f32(q3 + tx);
+    float32x4x2_t y;
+    y.val[0] = vaddq_f32(vaddq_f32(vaddq_f32(a, b), c), vb);
+    y.val[1] = vaddq_f32(vsubq_f32(vsubq_f32(b, c), d), vb);
+    vst2q_f32(out + 2 * tx, y);
+  }
+  outputTilesTail(q0, q1, q2, q3, n, bias, out, tx);
+}
+#endif  // TFE_HAS_NEON
+
+}  // namespace
+
+const WinogradTransforms& winogradTransforms(Isa isa) {
+  static const WinogradTransforms kScalar = {inputRowsScalar, inputTilesScalar,
+                                             outputRowsScalar, outputTilesScalar};
+#if TFE_HAS_X86_SIMD
+  static const WinogradTransforms kAvx2 = {inputRowsAvx2, inputTilesAvx2, outputRowsAvx2,
+                                           outputTilesAvx2};
+  if (isa == Isa::AVX2 || isa == Isa::AVX512) {
+    return kAvx2;
+  }
+#endif
+#if TFE_HAS_NEON
+  static const WinogradTransforms kNeon = {inputRowsNeon, inputTilesNeon, outputRowsNeon,
+                                           outputTilesNeon};
+  if (isa == Isa::NEON) {
+    return kNeon;
+  }
+#endif
+  return kScalar;
+}
+
+}  // namespace engine
+}  // namespace tfe
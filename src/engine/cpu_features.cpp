@@ -0,0 +1,59 @@
+#include "engine/cpu_features.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace tfe {
+namespace engine {
+
+const char* isaToString(Isa isa) {
+  switch (isa) {
+    case Isa::SCALAR:
+      return "scalar";
+    case Isa::AVX2:
+      return "avx2";
+    case Isa::AVX512:
+      return "avx512";
+    case Isa::NEON:
+      return "neon";
+  }
+  return "unknown";
+}
+
+const std::vector<Isa>& supportedIsas() {
+  static const std::vector<Isa> isas = [] {
+    std::vector<Isa> out = {Isa::SCALAR};
+#if TFE_HAS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      out.push_back(Isa::AVX2);
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+      out.push_back(Isa::AVX512);
+    }
+#endif
+#if TFE_HAS_NEON
+    out.push_back(Isa::NEON);
+#endif
+    return out;
+  }();
+  return isas;
+}
+
+Isa bestIsa() {
+  static const Isa isa = [] {
+    const std::vector<Isa>& isas = supportedIsas();
+    if (const char* env = std::getenv("TFE_ISA")) {
+      for (Isa candidate : isas) {
+        if (std::strcmp(env, isaToString(candidate)) == 0) {
+          return candidate;
+        }
+      }
+    }
+    return isas.back();
+  }();
+  return isa;
+}
+
+}  // namespace engine
+}  // namespace tfe
@@ -0,0 +1,219 @@
+#include "engine/engine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "engine/compiled_model.h"
+#include "engine/fusion.h"
+#include "engine/kernels.h"
+#include "engine/layout_pass.h"
+#include "engine/lowering.h"
+#include "engine/quantization.h"
+
+namespace tfe {
+namespace engine {
+
+Engine::Engine(const model::ScriptModel& model,
+               const std::vector<std::vector<int64_t>>& input_shapes,
+               const EngineOptions& options)
+    : options_(options), graph_(lower(model, input_shapes)) {
+  prepare();
+}
+
+Engine::Engine(Graph graph, const EngineOptions& options)
+    : options_(options), graph_(std::move(graph)) {
+  prepare();
+}
+
+Engine::Engine(std::shared_ptr<const CompiledModel> compiled,
+               std::shared_ptr<util::WorkStealingPool> pool)
+    : options_(compiled->options()),
+      compiled_(std::move(compiled)),
+      graph_(compiled_->graph()),
+      schedule_(compiled_->schedule()),
+      plan_(compiled_->memoryPlan()) {
+  options_.pool = pool ? std::move(pool) : util::WorkStealingPool::shared();
+  instantiate();
+}
+
+void Engine::prepare() {
+  if (!options_.pool) {
+    options_.pool = util::WorkStealingPool::shared();
+  }
+  if (options_.quantize) {
+    planQuantization(graph_, *options_.quantize);
+  }
+  if (options_.blocked_layout) {
+    assignLayouts(graph_, blockedLayoutFor(options_.isa));
+  }
+  if (options_.fuse) {
+    fuseOps(graph_);
+  }
+  if (options_.quantize) {
+    convertQuantizedWeights(graph_);
+  }
+  schedule_ = scheduleOps(graph_, options_.inter_op ? options_.pool->concurrency() : 1);
+  plan_     = planMemory(graph_, schedule_.steps);
+  instantiate();
+}
+
+void Engine::instantiate() {
+  arena_ = tensor::empty({static_cast<int64_t>(plan_.arena_bytes / sizeof(float))},
+                         tensor::DType::FLOAT32, "arena");
+  char* base = static_cast<char*>(arena_.data());
+
+  values_.assign(graph_.slots.size(), nullptr);
+  for (size_t i = 0; i < graph_.slots.size(); ++i) {
+    Slot& slot = graph_.slots[i];
+    if (slot.constant) {
+      // compiled model 은 아무 커널도 읽지 않는 상수를 저장하지 않는다
+      values_[i] = slot.tensor.defined() ? slot.tensor.data<float>() : nullptr;
+    } else if (plan_.offsets[i] >= 0) {
+      values_[i] = reinterpret_cast<float*>(base + plan_.offsets[i]);
+    }
+  }
+
+  convs_.resize(graph_.ops.size());
+  for (size_t i = 0; i < graph_.ops.size(); ++i) {
+    const Op& op    = graph_.ops[i];
+    const bool int8 = op.params.input_scale > 0.0f;
+    if (op.kind != OpKind::CONV2D && !(op.kind == OpKind::LINEAR && int8)) {
+      continue;
+    }
+    const Slot& x     = graph_.slots[op.inputs[0]];
+    const Slot& y     = graph_.slots[op.output];
+    const Slot& w     = graph_.slots[op.inputs[1]];
+    const float* bias = op.inputs.size() > 2 ? values_[op.inputs[2]] : nullptr;
+    // linear 는 행 하나가 배치 하나인 1x1 conv 다 ([rows][in] == NCHW {rows, in, 1, 1})
+    const bool linear = op.kind == OpKind::LINEAR;
+    const std::vector<int64_t> in =
+        linear ? std::vector<int64_t>{x.numel() / w.sizes[1], w.sizes[1], 1, 1} : x.sizes;
+    const std::vector<int64_t> kernel =
+        linear ? std::vector<int64_t>{w.sizes[0], w.sizes[1], 1, 1} : w.sizes;
+    const std::vector<int64_t> target = linear ? std::vector<int64_t>{} : y.sizes;
+    if (const CompiledConv* compiled = compiled_ ? compiled_->conv(i) : nullptr) {
+      convs_[i] = std::make_unique<ConvKernel>(in, kernel, compiled->algo, compiled->packed,
+                                               values_[op.inputs[1]], bias, op.params,
+                                               options_.isa, x.layout, y.layout, target,
+                                               options_.pool.get());
+    } else if (!int8) {
+      convs_[i] = std::make_unique<ConvKernel>(in, kernel, values_[op.inputs[1]], bias, op.params,
+                                               ConvAlgo::AUTO, options_.isa, x.layout, y.layout,
+                                               target, options_.pool.get());
+    } else {
+      convs_[i] = std::make_unique<ConvKernel>(
+          in, kernel, w.tensor.data<int8_t>(), values_[op.params.weight_scale], bias, op.params,
+          options_.isa, target, options_.pool.get());
+    }
+  }
+
+  // 작업 버퍼는 stage 끼리 같이 쓰고, 동시에 도는 stage 안에서는 op 마다 따로 잡는다
+  size_t workspace = 0;
+  workspace_offsets_.assign(graph_.ops.size(), 0);
+  for (const Stage& stage : schedule_.stages) {
+    size_t offset = 0;
+    for (int32_t i : stage.ops) {
+      const size_t bytes = convs_[i] ? convs_[i]->workspaceBytes() : 0;
+      if (!stage.concurrent) {
+        workspace = std::max(workspace, bytes);
+        continue;
+      }
+      constexpr size_t kAlign = tensor::AlignedBuffer::kAlignment;
+      workspace_offsets_[i]   = offset;
+      offset += (bytes + kAlign - 1) / kAlign * kAlign;
+    }
+    workspace = std::max(workspace, offset);
+  }
+  workspace_ = tensor::AlignedBuffer(workspace);
+
+  for (int32_t output : graph_.outputs) {
+    const Slot& slot = graph_.slots[output];
+    if (slot.constant) {
+      outputs_.push_back(slot.tensor);
+    } else {
+      outputs_.emplace_back(arena_.storage(), plan_.offsets[output] / sizeof(float), slot.sizes,
+                            tensor::contiguousStrides(slot.sizes));
+    }
+  }
+}
+
+void Engine::load(const std::vector<tensor::Tensor>& inputs) {
+  if (inputs.size() != graph_.inputs.size()) {
+    throw std::invalid_argument("Engine expects " + std::to_string(graph_.inputs.size()) +
+                                " inputs, got " + std::to_string(inputs.size()));
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const Slot& slot = graph_.slots[graph_.inputs[i]];
+    if (inputs[i].dtype() != tensor::DType::FLOAT32 || inputs[i].sizes() != slot.sizes) {
+      throw std::invalid_argument("Engine input " + std::to_string(i) +
+                                  " does not match the lowered float32 shape");
+    }
+    size_t bytes = slot.numel() * sizeof(float);
+    if (inputs[i].isContiguous()) {
+      std::memcpy(values_[graph_.inputs[i]], inputs[i].data(), bytes);
+    } else {
+      std::memcpy(values_[graph_.inputs[i]], tensor::contiguous(inputs[i]).data(), bytes);
+    }
+  }
+}
+
+const std::vector<tensor::Tensor>& Engine::run(const std::vector<tensor::Tensor>& inputs) {
+  load(inputs);
+  float* workspace = static_cast<float*>(workspace_.data());
+  for (const Stage& stage : schedule_.stages) {
+    if (!stage.concurrent) {
+      for (int32_t i : stage.ops) {
+        runOp(i, workspace, 0);
+      }
+      continue;
+    }
+    // pool 안에서 도는 op 의 conv 는 중첩 parallelFor 라 제 스레드에서만 돈다
+    options_.pool->parallelFor(0, static_cast<int64_t>(stage.ops.size()), 1,
+                               [&](int64_t lo, int64_t hi, size_t worker) {
+                                 for (int64_t k = lo; k < hi; ++k) {
+                                   runOp(stage.ops[k], workspace, worker);
+                                 }
+                               });
+  }
+  return outputs_;
+}
+
+const std::vector<tensor::Tensor>& Engine::run(const std::vector<tensor::Tensor>& inputs,
+                                               const std::function<void(size_t)>& observer) {
+  load(inputs);
+  // 동시에 도는 stage 의 op 도 작업 버퍼 자리가 따로라 하나씩 돌려도 된다
+  float* workspace = static_cast<float*>(workspace_.data());
+  for (const Stage& stage : schedule_.stages) {
+    for (int32_t i : stage.ops) {
+      observer(i);
+      runOp(i, workspace, 0);
+    }
+  }
+  return outputs_;
+}
+
+Profiler& Engine::enableProfiling(size_t capacity) {
+  profiler_ = std::make_unique<Profiler>(graph_, options_.pool->concurrency(), capacity);
+  return *profiler_;
+}
+
+void Engine::runOp(size_t index, float* workspace, size_t worker) {
+  const Op& op        = graph_.ops[index];
+  const int64_t begin = profiler_ ? profiler_->now() : 0;
+  if (convs_[index]) {
+    const float* residual = op.inputs.size() > 3 ? values_[op.inputs[3]] : nullptr;
+    convs_[index]->run(values_[op.inputs[0]], values_[op.output],
+                       workspace + workspace_offsets_[index] / sizeof(float), residual);
+  } else {
+    kernels::run(op, graph_, values_);
+  }
+  if (profiler_) {
+    profiler_->record(index, worker, begin, profiler_->now());
+  }
+}
+
+}  // namespace engine
+}  // namespace tfe
@@ -0,0 +1,215 @@
+#include "engine/fusion.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+/**
+ * @brief epilogue 가 아직 없는 conv
+ */
+bool plain(const Op& conv) {
+  return conv.params.activation == Activation::NONE && conv.inputs.size() <= 3 &&
+         conv.params.upsample == 1;
+}
+
+bool isFloatConstant(const Slot& slot) {
+  return slot.constant && slot.tensor.dtype() == tensor::DType::FLOAT32;
+}
+
+}  // namespace
+
+void fuseOps(Graph& graph) {
+  // slot 을 읽는 op 수. 그래프 출력도 하나로 센다
+  std::vector<int32_t> uses(graph.slots.size(), 0);
+  for (const Op& op : graph.ops) {
+    for (int32_t input : op.inputs) {
+      ++uses[input];
+    }
+  }
+  for (int32_t output : graph.outputs) {
+    ++uses[output];
+  }
+
+  std::vector<Op> ops = std::move(graph.ops);
+  graph.ops.clear();
+  // slot 을 쓰는 op 의 graph.ops 안 위치. 그래프 입력과 상수는 -1 (어느 op 보다 먼저 있다)
+  std::vector<int32_t> producer(graph.slots.size(), -1);
+
+  auto addConstant = [&](const std::string& name, tensor::Tensor t) {
+    int32_t slot = graph.addConstant(name, std::move(t));
+    uses.resize(graph.slots.size(), 0);
+    producer.resize(graph.slots.size(), -1);
+    return slot;
+  };
+  // slot 이 conv 하나의 출력이고 consumer 하나만 읽으면 그 conv
+  auto fusable = [&](int32_t slot, int32_t consumer) -> Op* {
+    const int32_t at = producer[slot];
+    if (at < 0 || uses[slot] != 1) {
+      return nullptr;
+    }
+    Op& op = graph.ops[at];
+    if (op.kind != OpKind::CONV2D || graph.slots[slot].layout != graph.slots[consumer].layout) {
+      return nullptr;
+    }
+    return &op;
+  };
+  // residual 을 붙일 conv 는 bias 자리 (inputs[2]) 가 있어야 한다
+  auto ensureBias = [&](Op& conv) {
+    if (conv.inputs.size() > 2) {
+      return;
+    }
+    const int64_t oc = graph.slots[conv.inputs[1]].sizes[0];
+    tensor::Tensor zero = tensor::empty({oc}, tensor::DType::FLOAT32, conv.name + ".bias");
+    std::fill(zero.data<float>(), zero.data<float>() + oc, 0.0f);
+    int32_t bias = addConstant(conv.name + ".bias", std::move(zero));
+    conv.inputs.push_back(bias);
+  };
+  // graph.ops[at] 을 맨 뒤로 옮긴다. 입력은 모두 그보다 앞에서 만들어졌으므로 언제나 된다
+  auto moveToBack = [&](int32_t at) -> Op& {
+    Op moved = std::move(graph.ops[at]);
+    graph.ops.erase(graph.ops.begin() + at);
+    for (int32_t& p : producer) {
+      p = p > at ? p - 1 : p;
+    }
+    producer[moved.output] = static_cast<int32_t>(graph.ops.size());
+    graph.ops.push_back(std::move(moved));
+    return graph.ops.back();
+  };
+  // conv 가 consumer 의 출력을 대신 쓴다
+  auto absorb = [&](Op& conv, int32_t output) {
+    producer[output] = producer[conv.output];
+    conv.output      = output;
+  };
+
+  for (Op& op : ops) {
+    switch (op.kind) {
+      case OpKind::BATCH_NORM: {
+        Op* conv = fusable(op.inputs[0], op.output);
+        if (!conv || !plain(*conv) || !isFloatConstant(graph.slots[conv->inputs[1]]) ||
+            (conv->inputs.size() > 2 && !isFloatConstant(graph.slots[conv->inputs[2]]))) {
+          break;
+        }
+        // w' = w * scale[o], b' = b * scale[o] + shift[o]
+        const Slot& w       = graph.slots[conv->inputs[1]];
+        const int64_t oc    = w.sizes[0];
+        const int64_t taps  = w.tensor.numel() / oc;
+        tensor::Tensor src  = tensor::contiguous(w.tensor);
+        tensor::Tensor bias = tensor::empty({oc}, tensor::DType::FLOAT32, conv->name + ".bias");
+        tensor::Tensor weight =
+            tensor::empty(w.sizes, tensor::DType::FLOAT32, conv->name + ".weight");
+        const float* scale = graph.slots[op.inputs[1]].tensor.data<float>();
+        const float* shift = graph.slots[op.inputs[2]].tensor.data<float>();
+        const float* old_bias =
+            conv->inputs.size() > 2 ? graph.slots[conv->inputs[2]].tensor.data<float>() : nullptr;
+        for (int64_t o = 0; o < oc; ++o) {
+          for (int64_t k = 0; k < taps; ++k) {
+            weight.data<float>()[o * taps + k] = src.data<float>()[o * taps + k] * scale[o];
+          }
+          bias.data<float>()[o] = (old_bias ? old_bias[o] : 0.0f) * scale[o] + shift[o];
+        }
+        const std::string name = conv->name;
+        conv->inputs.resize(2);
+        conv->inputs[1] = addConstant(name + ".weight.bn_folded", std::move(weight));
+        conv->inputs.push_back(addConstant(name + ".bias.bn_folded", std::move(bias)));
+        absorb(*conv, op.output);
+        continue;
+      }
+      case OpKind::ADD: {
+        const int32_t a = op.inputs[0];
+        if (op.params.has_scalar || op.params.alpha != 1.0f ||
+            graph.slots[a].sizes != graph.slots[op.output].sizes ||
+            graph.slots[op.inputs[1]].sizes != graph.slots[op.output].sizes) {
+          break;
+        }
+        // 나중에 만들어진 쪽의 conv 부터 본다. residual 이 그 conv 보다 뒤에 만들어지면 (e.g. 입력의
+        // REORDER) conv 를 이 add 자리로 옮긴다
+        int k = producer[op.inputs[0]] > producer[op.inputs[1]] ? 0 : 1;
+        Op* conv = fusable(op.inputs[k], op.output);
+        if (!conv || !plain(*conv)) {
+          k    = 1 - k;
+          conv = fusable(op.inputs[k], op.output);
+        }
+        if (!conv || !plain(*conv)) {
+          break;
+        }
+        const int32_t residual = op.inputs[1 - k];
+        if (producer[residual] > producer[op.inputs[k]]) {
+          conv = &moveToBack(producer[op.inputs[k]]);
+        }
+        ensureBias(*conv);
+        conv->inputs.push_back(residual);
+        absorb(*conv, op.output);
+        continue;
+      }
+      case OpKind::RELU:
+      case OpKind::ELU:
+      case OpKind::SIGMOID: {
+        Op* conv = fusable(op.inputs[0], op.output);
+        if (!conv || conv->params.activation != Activation::NONE || conv->params.upsample != 1) {
+          break;
+        }
+        conv->params.activation = op.kind == OpKind::RELU  ? Activation::RELU
+                                  : op.kind == OpKind::ELU ? Activation::ELU
+                                                           : Activation::SIGMOID;
+        conv->params.alpha      = op.params.alpha;
+        absorb(*conv, op.output);
+        continue;
+      }
+      case OpKind::UPSAMPLE_NEAREST2D: {
+        Op* conv = fusable(op.inputs[0], op.output);
+        const std::vector<int64_t>& in  = graph.slots[op.inputs[0]].sizes;
+        const std::vector<int64_t>& out = graph.slots[op.output].sizes;
+        // nearest 의 정수 배만 픽셀 복제와 같다
+        if (!conv || conv->params.upsample != 1 || out[2] % in[2] != 0 ||
+            out[2] / in[2] != out[3] / in[3] || out[3] % in[3] != 0) {
+          break;
+        }
+        conv->params.upsample = out[2] / in[2];
+        absorb(*conv, op.output);
+        continue;
+      }
+      case OpKind::CAT: {
+        if (op.params.axis != 1 || graph.slots[op.output].sizes.size() != 4) {
+          break;
+        }
+        auto channels = [&](int32_t slot) { return graph.slots[slot].sizes[1]; };
+        auto place    = [&](int32_t input, int64_t offset) {
+          Op* conv = fusable(input, op.output);
+          if (!conv) {
+            return false;
+          }
+          conv->params.offset = offset;
+          conv->output        = op.output;
+          return true;
+        };
+        // 앞에서부터, 그리고 뒤에서부터 conv 출력을 제자리에 쓰게 한다. CAT 에는 입력이 하나 이상 남는다
+        size_t first = 0, last = op.inputs.size();
+        int64_t front = 0, back = channels(op.output);
+        while (first + 1 < last && place(op.inputs[first], front)) {
+          front += channels(op.inputs[first++]);
+        }
+        while (first + 1 < last &&
+               place(op.inputs[last - 1], back - channels(op.inputs[last - 1]))) {
+          back -= channels(op.inputs[--last]);
+        }
+        op.inputs.erase(op.inputs.begin() + last, op.inputs.end());
+        op.inputs.erase(op.inputs.begin(), op.inputs.begin() + first);
+        op.params.offset = front;
+        break;
+      }
+      default:
+        break;
+    }
+    producer[op.output] = static_cast<int32_t>(graph.ops.size());
+    graph.ops.push_back(std::move(op));
+  }
+}
+
+}  // namespace engine
+}  // namespace tfe
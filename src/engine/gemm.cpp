@@ -0,0 +1,443 @@
+#include "engine/gemm.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if TFE_HAS_X86_SIMD
+#include <immintrin.h>
+#endif
+#if TFE_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+constexpr int64_t kMR = PackedMatrix::kMR;
+
+/**
+ * @brief kMR x NR 블록 하나. first 면 bias (없으면 0) 에서, 아니면 C 에 누적한다.
+ *        rows < kMR 인 마지막 panel 은 앞 rows 행만 읽고 쓴다
+ */
+using MicroKernel = void (*)(int64_t kc, const float* a, const float* b, int64_t ldb, float* c,
+                             int64_t ldc, int64_t rows, bool first, const float* bias);
+
+constexpr int64_t kScalarNR = 8;
+
+void microScalar(int64_t kc, const float* a, const float* b, int64_t ldb, float* c, int64_t ldc,
+                 int64_t rows, bool first, const float* bias) {
+  float acc[kMR][kScalarNR];
+  for (int64_t r = 0; r < kMR; ++r) {
+    for (int64_t j = 0; j < kScalarNR; ++j) {
+      acc[r][j] = r >= rows ? 0.0f : first ? (bias ? bias[r] : 0.0f) : c[r * ldc + j];
+    }
+  }
+  for (int64_t k = 0; k < kc; ++k) {
+    const float* bk = b + k * ldb;
+    for (int64_t r = 0; r < kMR; ++r) {
+      float ar = a[k * kMR + r];
+      for (int64_t j = 0; j < kScalarNR; ++j) {
+        acc[r][j] += ar * bk[j];
+      }
+    }
+  }
+  for (int64_t r = 0; r < rows; ++r) {
+    std::memcpy(c + r * ldc, acc[r], sizeof(acc[r]));
+  }
+}
+
+#if TFE_HAS_X86_SIMD
+constexpr int64_t kAvx2NR = 16;
+
+__attribute__((target("avx2,fma"))) void microAvx2(int64_t kc, const float* a, const float* b,
+                                                   int64_t ldb, float* c, int64_t ldc,
+                                                   int64_t rows, bool first, const float* bias) {
+  __m256 acc[kMR][2];
+#pragma GCC unroll 6
+  for (int64_t r = 0; r < kMR; ++r) {
+    if (r >= rows) {
+      acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+    } else if (first) {
+      acc[r][0] = acc[r][1] = _mm256_set1_ps(bias ? bias[r] : 0.0f);
+    } else {
+      acc[r][0] = _mm256_loadu_ps(c + r * ldc);
+      acc[r][1] = _mm256_loadu_ps(c + r * ldc + 8);
+    }
+  }
+  for (int64_t k = 0; k < kc; ++k) {
+    __m256 b0 = _mm256_loadu_ps(b + k * ldb);
+    __m256 b1 = _mm256_loadu_ps(b + k * ldb + 8);
+#pragma GCC unroll 6
+    for (int64_t r = 0; r < kMR; ++r) {
+      __m256 ar = _mm256_broadcast_ss(a + k * kMR + r);
+      acc[r][0] = _mm256_fmadd_ps(ar, b0, acc[r][0]);
+      acc[r][1] = _mm256_fmadd_ps(ar, b1, acc[r][1]);
+    }
+  }
+#pragma GCC unroll 6
+  for (int64_t r = 0; r < kMR; ++r) {
+    if (r < rows) {
+      _mm256_storeu_ps(c + r * ldc, acc[r][0]);
+      _mm256_storeu_ps(c + r * ldc + 8, acc[r][1]);
+    }
+  }
+}
+
+__attribute__((target("avx2,fma"))) void axpyAvx2(int64_t n, float alpha, const float* x,
+                                                  float* y) {
+  __m256 va = _mm256_set1_ps(alpha);
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] += alpha * x[i];
+  }
+}
+
+/**
+ * @brief y[i] += alpha * x[i * stride]. stride 2 는 두 벡터에서 짝수 열을 골라 내고, 나머지는 gather
+ */
+__attribute__((target("avx2,fma"))) void axpyStridedAvx2(int64_t n, float alpha, const float* x,
+                                                         int64_t stride, float* y) {
+  const __m256 va = _mm256_set1_ps(alpha);
+  int64_t i       = 0;
+  if (stride == 2) {
+    // 마지막 벡터의 홀수 열은 x 끝을 넘으므로 마지막 묶음은 scalar 로 남긴다
+    for (; i + 8 < n; i += 8) {
+      const __m256 lo = _mm256_loadu_ps(x + 2 * i), hi = _mm256_loadu_ps(x + 2 * i + 8);
+      // shuffle 은 128 bit 반쪽 안에서만 고르므로 64 bit 단위로 다시 늘어놓는다
+      const __m256 even = _mm256_castpd_ps(
+          _mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(lo, hi, 0x88)), 0xD8));
+      _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, even, _mm256_loadu_ps(y + i)));
+    }
+  } else {
+    const __m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                             _mm256_set1_epi32(static_cast<int32_t>(stride)));
+    for (; i + 8 <= n; i += 8) {
+      const __m256 xs = _mm256_i32gather_ps(x + i * stride, index, 4);
+      _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, xs, _mm256_loadu_ps(y + i)));
+    }
+  }
+  for (; i < n; ++i) {
+    y[i] += alpha * x[i * stride];
+  }
+}
+
+constexpr int64_t kAvx512NR = 32;
+
+__attribute__((target("avx512f"))) void microAvx512(int64_t kc, const float* a, const float* b,
+                                                    int64_t ldb, float* c, int64_t ldc,
+                                                    int64_t rows, bool first,
+                                                    const float* bias) {
+  __m512 acc[kMR][2];
+#pragma GCC unroll 6
+  for (int64_t r = 0; r < kMR; ++r) {
+    if (r >= rows) {
+      acc[r][0] = acc[r][1] = _mm512_setzero_ps();
+    } else if (first) {
+      acc[r][0] = acc[r][1] = _mm512_set1_ps(bias ? bias[r] : 0.0f);
+    } else {
+      acc[r][0] = _mm512_loadu_ps(c + r * ldc);
+      acc[r][1] = _mm512_loadu_ps(c + r * ldc + 16);
+    }
+  }
+  for (int64_t k = 0; k < kc; ++k) {
+    __m512 b0 = _mm512_loadu_ps(b + k * ldb);
+    __m512 b1 = _mm512_loadu_ps(b + k * ldb + 16);
+#pragma GCC unroll 6
+    for (int64_t r = 0; r < kMR; ++r) {
+      __m512 ar = _mm512_set1_ps(a[k * kMR + r]);
+      acc[r][0] = _mm512_fmadd_ps(ar, b0, acc[r][0]);
+      acc[r][1] = _mm512_fmadd_ps(ar, b1, acc[r][1]);
+    }
+  }
+#pragma GCC unroll 6
+  for (int64_t r = 0; r < kMR; ++r) {
+    if (r < rows) {
+      _mm512_storeu_ps(c + r * ldc, acc[r][0]);
+      _mm512_storeu_ps(c + r * ldc + 16, acc[r][1]);
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) void axpyAvx512(int64_t n, float alpha, const float* x,
+                                                   float* y) {
+  __m512 va = _mm512_set1_ps(alpha);
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+  }
+  if (i < n) {
+    __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+    __m512 vy      = _mm512_maskz_loadu_ps(mask, y + i);
+    _mm512_mask_storeu_ps(y + i, mask, _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(mask, x + i), vy));
+  }
+}
+
+__attribute__((target("avx512f"))) void axpyStridedAvx512(int64_t n, float alpha, const float* x,
+                                                          int64_t stride, float* y) {
+  const __m512 va = _mm512_set1_ps(alpha);
+  int64_t i       = 0;
+  if (stride == 2) {
+    const __m512i even =
+        _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    for (; i + 16 < n; i += 16) {
+      const __m512 xs = _mm512_permutex2var_ps(_mm512_loadu_ps(x + 2 * i), even,
+                                               _mm512_loadu_ps(x + 2 * i + 16));
+      _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, xs, _mm512_loadu_ps(y + i)));
+    }
+  } else {
+    const __m512i index =
+        _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                           _mm512_set1_epi32(static_cast<int32_t>(stride)));
+    for (; i + 16 <= n; i += 16) {
+      // 마스크 없는 gather 는 GCC 가 미정의 원본을 경고하므로 0 에서 시작한다
+      const __m512 xs =
+          _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, index, x + i * stride, 4);
+      _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, xs, _mm512_loadu_ps(y + i)));
+    }
+  }
+  for (; i < n; ++i) {
+    y[i] += alpha * x[i * stride];
+  }
+}
+#endif  // TFE_HAS_X86_SIMD
+
+#if TFE_HAS_NEON
+constexpr int64_t kNeonNR = 8;
+
+void microNeon(int64_t kc, const float* a, const float* b, int64_t ldb, float* c, int64_t ldc,
+               int64_t rows, bool first, const float* bias) {
+  float32x4_t acc[kMR][2];
+  for (int64_t r = 0; r < kMR; ++r) {
+    if (r >= rows) {
+      acc[r][0] = acc[r][1] = vdupq_n_f32(0.0f);
+    } else if (first) {
+      acc[r][0] = acc[r][1] = vdupq_n_f32(bias ? bias[r] : 0.0f);
+    } else {
+      acc[r][0] = vld1q_f32(c + r * ldc);
+      acc[r][1] = vld1q_f32(c + r * ldc + 4);
+    }
+  }
+  for (int64_t k = 0; k < kc; ++k) {
+    float32x4_t b0 = vld1q_f32(b + k * ldb);
+    float32x4_t b1 = vld1q_f32(b + k * ldb + 4);
+    for (int64_t r = 0; r < kMR; ++r) {
+      float32x4_t ar = vdupq_n_f32(a[k * kMR + r]);
+      acc[r][0]      = vfmaq_f32(acc[r][0], ar, b0);
+      acc[r][1]      = vfmaq_f32(acc[r][1], ar, b1);
+    }
+  }
+  for (int64_t r = 0; r < rows; ++r) {
+    vst1q_f32(c + r * ldc, acc[r][0]);
+    vst1q_f32(c + r * ldc + 4, acc[r][1]);
+  }
+}
+
+void axpyNeon(int64_t n, float alpha, const float* x, float* y) {
+  float32x4_t va = vdupq_n_f32(alpha);
+  int64_t i      = 0;
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32(y + i, vfmaq_f32(vld1q_f32(y + i), va, vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] += alpha * x[i];
+  }
+}
+
+void axpyStridedNeon(int64_t n, float alpha, const float* x, int64_t stride, float* y) {
+  float32x4_t va = vdupq_n_f32(alpha);
+  int64_t i      = 0;
+  // vld2q / vld3q 가 stride 2 / 3 의 열을 나눠 읽는다. 그 밖의 stride 는 scalar.
+  // 마지막 묶음은 x 끝을 넘어 읽으므로 scalar 로 남긴다
+  if (stride == 2) {
+    for (; i + 4 < n; i += 4) {
+      vst1q_f32(y + i, vfmaq_f32(vld1q_f32(y + i), va, vld2q_f32(x + 2 * i).val[0]));
+    }
+  } else if (stride == 3) {
+    for (; i + 4 < n; i += 4) {
+      vst1q_f32(y + i, vfmaq_f32(vld1q_f32(y + i), va, vld3q_f32(x + 3 * i).val[0]));
+    }
+  }
+  for (; i < n; ++i) {
+    y[i] += alpha * x[i * stride];
+  }
+}
+#endif  // TFE_HAS_NEON
+
+void microFor(Isa isa, MicroKernel* micro, int64_t* nr) {
+  switch (isa) {
+#if TFE_HAS_X86_SIMD
+    case Isa::AVX2:
+      *micro = microAvx2;
+      *nr    = kAvx2NR;
+      return;
+    case Isa::AVX512:
+      *micro = microAvx512;
+      *nr    = kAvx512NR;
+      return;
+#endif
+#if TFE_HAS_NEON
+    case Isa::NEON:
+      *micro = microNeon;
+      *nr    = kNeonNR;
+      return;
+#endif
+    default:
+      *micro = microScalar;
+      *nr    = kScalarNR;
+      return;
+  }
+}
+
+/**
+ * @brief B[kc x nc] 블록을 NR 열 panel 로 묶는다. 마지막 panel 의 모자란 열은 0
+ */
+void packB(const float* b, int64_t ldb, int64_t kc, int64_t nc, int64_t nr, float* dst) {
+  for (int64_t j = 0; j < nc; j += nr) {
+    const int64_t cols = std::min(nr, nc - j);
+    for (int64_t k = 0; k < kc; ++k) {
+      std::memcpy(dst, b + k * ldb + j, cols * sizeof(float));
+      std::fill(dst + cols, dst + nr, 0.0f);
+      dst += nr;
+    }
+  }
+}
+
+}  // namespace
+
+PackedMatrix::PackedMatrix(const float* a, int64_t rows, int64_t cols, int64_t lda)
+    : rows_(rows), cols_(cols) {
+  const int64_t panels = (rows + kMR - 1) / kMR;
+  buffer_              = tensor::AlignedBuffer(bytes(rows, cols));
+  float* dst           = static_cast<float*>(buffer_.data());
+  data_                = dst;
+  for (int64_t p = 0; p < panels; ++p) {
+    for (int64_t k = 0; k < cols; ++k) {
+      for (int64_t r = 0; r < kMR; ++r) {
+        int64_t row = p * kMR + r;
+        *dst++      = row < rows ? a[row * lda + k] : 0.0f;
+      }
+    }
+  }
+}
+
+PackedMatrix PackedMatrix::view(const float* packed, int64_t rows, int64_t cols) {
+  PackedMatrix m;
+  m.data_ = packed;
+  m.rows_ = rows;
+  m.cols_ = cols;
+  return m;
+}
+
+size_t PackedMatrix::bytes(int64_t rows, int64_t cols) {
+  return static_cast<size_t>((rows + kMR - 1) / kMR * kMR * cols) * sizeof(float);
+}
+
+void gemm(Isa isa, const PackedMatrix& a, const float* b, int64_t ldb, int64_t n, float* c,
+          int64_t ldc, const float* bias, float* pack, int64_t panel_begin, int64_t panel_end) {
+  MicroKernel micro;
+  int64_t nr;
+  microFor(isa, &micro, &nr);
+
+  const int64_t m      = a.rows();
+  const int64_t k      = a.cols();
+  const int64_t panels = panel_end < 0 ? (m + kMR - 1) / kMR : panel_end;
+
+  if (k == 0) {
+    for (int64_t r = panel_begin * kMR; r < std::min(m, panels * kMR); ++r) {
+      std::fill(c + r * ldc, c + r * ldc + n, bias ? bias[r] : 0.0f);
+    }
+    return;
+  }
+
+  // 오른쪽 끝 panel 은 NR 보다 좁으므로 C 를 tile 에 옮겨 계산하고 되돌린다
+  alignas(64) float tile[kMR * kMaxNR];
+
+  for (int64_t n0 = 0; n0 < n; n0 += kGemmNC) {
+    const int64_t nc = std::min(kGemmNC, n - n0);
+    for (int64_t k0 = 0; k0 < k; k0 += kGemmKC) {
+      const int64_t kc = std::min(kGemmKC, k - k0);
+      const bool first = k0 == 0;
+      packB(b + k0 * ldb + n0, ldb, kc, nc, nr, pack);
+
+      for (int64_t p = panel_begin; p < panels; ++p) {
+        const int64_t rows  = std::min(kMR, m - p * kMR);
+        const float* a_blk  = a.panel(p) + k0 * kMR;
+        const float* bias_p = bias ? bias + p * kMR : nullptr;
+        float* c_blk        = c + p * kMR * ldc + n0;
+        for (int64_t j = 0; j < nc; j += nr) {
+          const float* b_panel = pack + j * kc;
+          const int64_t cols   = std::min(nr, nc - j);
+          if (cols == nr) {
+            micro(kc, a_blk, b_panel, nr, c_blk + j, ldc, rows, first, bias_p);
+            continue;
+          }
+          for (int64_t r = 0; r < rows && !first; ++r) {
+            std::memcpy(tile + r * nr, c_blk + r * ldc + j, cols * sizeof(float));
+          }
+          micro(kc, a_blk, b_panel, nr, tile, nr, rows, first, bias_p);
+          for (int64_t r = 0; r < rows; ++r) {
+            std::memcpy(c_blk + r * ldc + j, tile + r * nr, cols * sizeof(float));
+          }
+        }
+      }
+    }
+  }
+}
+
+void axpy(Isa isa, int64_t n, float alpha, const float* x, float* y) {
+  switch (isa) {
+#if TFE_HAS_X86_SIMD
+    case Isa::AVX2:
+      axpyAvx2(n, alpha, x, y);
+      return;
+    case Isa::AVX512:
+      axpyAvx512(n, alpha, x, y);
+      return;
+#endif
+#if TFE_HAS_NEON
+    case Isa::NEON:
+      axpyNeon(n, alpha, x, y);
+      return;
+#endif
+    default:
+      for (int64_t i = 0; i < n; ++i) {
+        y[i] += alpha * x[i];
+      }
+      return;
+  }
+}
+
+void axpyStrided(Isa isa, int64_t n, float alpha, const float* x, int64_t stride, float* y) {
+  if (stride == 1) {
+    axpy(isa, n, alpha, x, y);
+    return;
+  }
+  switch (isa) {
+#if TFE_HAS_X86_SIMD
+    case Isa::AVX2:
+      axpyStridedAvx2(n, alpha, x, stride, y);
+      return;
+    case Isa::AVX512:
+      axpyStridedAvx512(n, alpha, x, stride, y);
+      return;
+#endif
+#if TFE_HAS_NEON
+    case Isa::NEON:
+      axpyStridedNeon(n, alpha, x, stride, y);
+      return;
+#endif
+    default:
+      for (int64_t i = 0; i < n; ++i) {
+        y[i] += alpha * x[i * stride];
+      }
+      return;
+  }
+}
+
+}  // namespace engine
+}  // namespace tfe
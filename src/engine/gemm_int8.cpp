@@ -0,0 +1,240 @@
+#include "engine/gemm_int8.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if TFE_HAS_X86_SIMD
+#include <immintrin.h>
+#endif
+#if TFE_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+constexpr int64_t kMR = QuantizedMatrix::kMR;
+
+/**
+ * @brief kMR x kInt8NR 블록 하나의 sum_k a[r][k] * (b[k][j] - shift) 를 acc[r][j] 에 쓴다.
+ *        a 는 panel 하나, b 는 열 panel 하나
+ */
+using Int8MicroKernel = void (*)(int64_t quads, const int8_t* a, const uint8_t* b, int32_t* acc);
+
+struct Int8Kernel {
+  Int8MicroKernel micro;
+  int32_t shift;  // micro kernel 이 b 에서 빼고 곱하는 값 (s8 x s8 명령은 u8 을 128 내려 읽는다)
+  const char* name;
+};
+
+int32_t loadWord(const int8_t* p) {
+  int32_t word;
+  std::memcpy(&word, p, sizeof(word));
+  return word;
+}
+
+void microScalar(int64_t quads, const int8_t* a, const uint8_t* b, int32_t* acc) {
+  std::fill(acc, acc + kMR * kInt8NR, 0);
+  for (int64_t q = 0; q < quads; ++q) {
+    const int8_t* aq  = a + q * kMR * 4;
+    const uint8_t* bq = b + q * kInt8NR * 4;
+    for (int64_t r = 0; r < kMR; ++r) {
+      int32_t* row = acc + r * kInt8NR;
+      for (int64_t j = 0; j < kInt8NR; ++j) {
+        for (int64_t t = 0; t < 4; ++t) {
+          row[j] += aq[r * 4 + t] * bq[j * 4 + t];
+        }
+      }
+    }
+  }
+}
+
+#if TFE_HAS_X86_SIMD
+__attribute__((target("avx512f,avx512vnni"))) void microAvx512Vnni(int64_t quads,
+                                                                   const int8_t* a,
+                                                                   const uint8_t* b,
+                                                                   int32_t* acc) {
+  __m512i c[kMR][2];
+#pragma GCC unroll 8
+  for (int64_t r = 0; r < kMR; ++r) {
+    c[r][0] = c[r][1] = _mm512_setzero_si512();
+  }
+  for (int64_t q = 0; q < quads; ++q) {
+    const __m512i b0 = _mm512_loadu_si512(b + q * kInt8NR * 4);
+    const __m512i b1 = _mm512_loadu_si512(b + q * kInt8NR * 4 + 64);
+    const int8_t* aq = a + q * kMR * 4;
+#pragma GCC unroll 8
+    for (int64_t r = 0; r < kMR; ++r) {
+      const __m512i ar = _mm512_set1_epi32(loadWord(aq + r * 4));
+      c[r][0]          = _mm512_dpbusd_epi32(c[r][0], b0, ar);
+      c[r][1]          = _mm512_dpbusd_epi32(c[r][1], b1, ar);
+    }
+  }
+#pragma GCC unroll 8
+  for (int64_t r = 0; r < kMR; ++r) {
+    _mm512_storeu_si512(acc + r * kInt8NR, c[r][0]);
+    _mm512_storeu_si512(acc + r * kInt8NR + 16, c[r][1]);
+  }
+}
+
+// 레지스터가 16 개라 8 열씩 네 번 돈다
+__attribute__((target("avx2,avxvnni"))) void microAvxVnni(int64_t quads, const int8_t* a,
+                                                          const uint8_t* b, int32_t* acc) {
+  for (int64_t s = 0; s < kInt8NR; s += 8) {
+    __m256i c[kMR];
+#pragma GCC unroll 8
+    for (int64_t r = 0; r < kMR; ++r) {
+      c[r] = _mm256_setzero_si256();
+    }
+    for (int64_t q = 0; q < quads; ++q) {
+      const __m256i bq =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + (q * kInt8NR + s) * 4));
+      const int8_t* aq = a + q * kMR * 4;
+#pragma GCC unroll 8
+      for (int64_t r = 0; r < kMR; ++r) {
+        c[r] = _mm256_dpbusd_avx_epi32(c[r], bq, _mm256_set1_epi32(loadWord(aq + r * 4)));
+      }
+    }
+#pragma GCC unroll 8
+    for (int64_t r = 0; r < kMR; ++r) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + r * kInt8NR + s), c[r]);
+    }
+  }
+}
+#endif  // TFE_HAS_X86_SIMD
+
+#if TFE_HAS_NEON && defined(__ARM_FEATURE_DOTPROD)
+#define TFE_HAS_NEON_DOT 1
+
+// SDOT 은 s8 x s8 이라 u8 활성값의 부호 bit 를 뒤집어 (b - 128) 로 읽는다
+void microNeonDot(int64_t quads, const int8_t* a, const uint8_t* b, int32_t* acc) {
+  const uint8x16_t flip = vdupq_n_u8(0x80);
+  for (int64_t s = 0; s < kInt8NR; s += 8) {
+    int32x4_t c[kMR][2];
+    for (int64_t r = 0; r < kMR; ++r) {
+      c[r][0] = c[r][1] = vdupq_n_s32(0);
+    }
+    for (int64_t q = 0; q < quads; ++q) {
+      const uint8_t* bq = b + (q * kInt8NR + s) * 4;
+      const int8x16_t b0 = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(bq), flip));
+      const int8x16_t b1 = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(bq + 16), flip));
+      const int8_t* aq   = a + q * kMR * 4;
+      for (int64_t r = 0; r < kMR; ++r) {
+        const int8x16_t ar = vreinterpretq_s8_s32(vdupq_n_s32(loadWord(aq + r * 4)));
+        c[r][0]            = vdotq_s32(c[r][0], b0, ar);
+        c[r][1]            = vdotq_s32(c[r][1], b1, ar);
+      }
+    }
+    for (int64_t r = 0; r < kMR; ++r) {
+      vst1q_s32(acc + r * kInt8NR + s, c[r][0]);
+      vst1q_s32(acc + r * kInt8NR + s + 4, c[r][1]);
+    }
+  }
+}
+#else
+#define TFE_HAS_NEON_DOT 0
+#endif
+
+Int8Kernel kernelFor(Isa isa) {
+#if TFE_HAS_X86_SIMD
+  __builtin_cpu_init();
+  if (isa == Isa::AVX512 && __builtin_cpu_supports("avx512vnni")) {
+    return {microAvx512Vnni, 0, "avx512_vnni"};
+  }
+  if ((isa == Isa::AVX512 || isa == Isa::AVX2) && __builtin_cpu_supports("avxvnni")) {
+    return {microAvxVnni, 0, "avx_vnni"};
+  }
+#endif
+#if TFE_HAS_NEON_DOT
+  if (isa == Isa::NEON) {
+    return {microNeonDot, 128, "neon_dot"};
+  }
+#endif
+  (void)isa;
+  return {microScalar, 0, "scalar"};
+}
+
+}  // namespace
+
+QuantizedMatrix::QuantizedMatrix(const int8_t* a, int64_t rows, int64_t cols, int64_t lda)
+    : rows_(rows), cols_(cols) {
+  const int64_t panels = (rows + kMR - 1) / kMR;
+  const int64_t q4     = quads() * 4;
+  buffer_              = tensor::AlignedBuffer(bytes(rows, cols));
+  int8_t* dst          = static_cast<int8_t*>(buffer_.data());
+  data_                = dst;
+  for (int64_t p = 0; p < panels; ++p) {
+    for (int64_t k0 = 0; k0 < q4; k0 += 4) {
+      for (int64_t r = 0; r < kMR; ++r) {
+        const int64_t row = p * kMR + r;
+        for (int64_t k = k0; k < k0 + 4; ++k) {
+          *dst++ = row < rows && k < cols ? a[row * lda + k] : 0;
+        }
+      }
+    }
+  }
+  // panel 들은 kMR * 4 byte 의 배수라 행 합이 4 byte 정렬된다
+  int32_t* sums = reinterpret_cast<int32_t*>(dst);
+  for (int64_t r = 0; r < rows; ++r) {
+    sums[r] = 0;
+    for (int64_t k = 0; k < cols; ++k) {
+      sums[r] += a[r * lda + k];
+    }
+  }
+}
+
+QuantizedMatrix QuantizedMatrix::view(const void* packed, int64_t rows, int64_t cols) {
+  QuantizedMatrix m;
+  m.data_ = static_cast<const int8_t*>(packed);
+  m.rows_ = rows;
+  m.cols_ = cols;
+  return m;
+}
+
+size_t QuantizedMatrix::bytes(int64_t rows, int64_t cols) {
+  const int64_t panels = (rows + kMR - 1) / kMR;
+  return static_cast<size_t>(panels * kMR * ((cols + 3) / 4 * 4) + rows * 4);
+}
+
+const char* int8KernelName(Isa isa) { return kernelFor(isa).name; }
+
+void gemmInt8(Isa isa, const QuantizedMatrix& a, const uint8_t* b, int64_t n, int32_t zero,
+              const float* scale, const float* bias, float* c, int64_t ldc, int64_t panel_begin,
+              int64_t panel_end, int64_t col_begin, int64_t col_end) {
+  static const Int8Kernel kernels[] = {kernelFor(Isa::SCALAR), kernelFor(Isa::AVX2),
+                                       kernelFor(Isa::AVX512), kernelFor(Isa::NEON)};
+  const Int8Kernel& kernel = kernels[static_cast<int>(isa)];
+
+  const int64_t m      = a.rows();
+  const int64_t quads  = a.quads();
+  const int64_t panels = panel_end < 0 ? (m + kMR - 1) / kMR : panel_end;
+  const int32_t* sums  = a.rowSums();
+  col_end              = col_end < 0 ? n : col_end;
+
+  // 열 panel 하나를 (L2 에 둔 채) 모든 행 panel 과 곱하고, int32 블록을 곧바로 float 로 되돌린다
+  alignas(64) int32_t acc[kMR * kInt8NR];
+  for (int64_t j = col_begin; j < col_end; j += kInt8NR) {
+    const uint8_t* b_panel = b + j / kInt8NR * quads * kInt8NR * 4;
+    const int64_t cols     = std::min(kInt8NR, col_end - j);
+    for (int64_t p = panel_begin; p < panels; ++p) {
+      kernel.micro(quads, a.panel(p), b_panel, acc);
+      const int64_t rows = std::min(kMR, m - p * kMR);
+      for (int64_t r = 0; r < rows; ++r) {
+        const int64_t o      = p * kMR + r;
+        const int32_t offset = (zero - kernel.shift) * sums[o];
+        const float s        = scale[o];
+        const float shift    = bias ? bias[o] : 0.0f;
+        const int32_t* src   = acc + r * kInt8NR;
+        float* dst           = c + o * ldc + j;
+        for (int64_t jj = 0; jj < cols; ++jj) {
+          dst[jj] = s * static_cast<float>(src[jj] - offset) + shift;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace engine
+}  // namespace tfe
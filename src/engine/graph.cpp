@@ -0,0 +1,179 @@
+#include "engine/graph.h"
+
+#include <sstream>
+#include <utility>
+
+namespace tfe {
+namespace engine {
+
+const char* opKindToString(OpKind kind) {
+  switch (kind) {
+    case OpKind::CONV2D:
+      return "conv2d";
+    case OpKind::BATCH_NORM:
+      return "batch_norm";
+    case OpKind::RELU:
+      return "relu";
+    case OpKind::ELU:
+      return "elu";
+    case OpKind::SIGMOID:
+      return "sigmoid";
+    case OpKind::MAX_POOL2D:
+      return "max_pool2d";
+    case OpKind::ADAPTIVE_AVG_POOL2D:
+      return "adaptive_avg_pool2d";
+    case OpKind::LINEAR:
+      return "linear";
+    case OpKind::ADD:
+      return "add";
+    case OpKind::SUB:
+      return "sub";
+    case OpKind::MUL:
+      return "mul";
+    case OpKind::DIV:
+      return "div";
+    case OpKind::CAT:
+      return "cat";
+    case OpKind::UPSAMPLE_NEAREST2D:
+      return "upsample_nearest2d";
+    case OpKind::PAD:
+      return "pad";
+    case OpKind::RESHAPE:
+      return "reshape";
+    case OpKind::REORDER:
+      return "reorder";
+  }
+  return "unknown";
+}
+
+const char* activationToString(Activation activation) {
+  switch (activation) {
+    case Activation::NONE:
+      return "none";
+    case Activation::RELU:
+      return "relu";
+    case Activation::ELU:
+      return "elu";
+    case Activation::SIGMOID:
+      return "sigmoid";
+  }
+  return "unknown";
+}
+
+int64_t Slot::numel() const {
+  if (layout != tensor::Layout::NCHW) {
+    return tensor::physicalNumel(sizes, layout);
+  }
+  int64_t n = 1;
+  for (int64_t s : sizes) {
+    n *= s;
+  }
+  return n;
+}
+
+int32_t Graph::addSlot(std::string name, std::vector<int64_t> sizes) {
+  Slot slot;
+  slot.name  = std::move(name);
+  slot.sizes = std::move(sizes);
+  slots.push_back(std::move(slot));
+  return static_cast<int32_t>(slots.size() - 1);
+}
+
+int32_t Graph::addConstant(std::string name, tensor::Tensor tensor) {
+  Slot slot;
+  slot.name     = std::move(name);
+  slot.sizes    = tensor.sizes();
+  slot.constant = true;
+  slot.tensor   = std::move(tensor);
+  slots.push_back(std::move(slot));
+  return static_cast<int32_t>(slots.size() - 1);
+}
+
+Op& Graph::addOp(OpKind kind, std::vector<int32_t> inputs, int32_t output, std::string name) {
+  Op op;
+  op.kind   = kind;
+  op.inputs = std::move(inputs);
+  op.output = output;
+  op.name   = std::move(name);
+  ops.push_back(std::move(op));
+  return ops.back();
+}
+
+void Graph::eliminateDeadOps() {
+  std::vector<bool> live(slots.size(), false);
+  for (int32_t output : outputs) {
+    live[output] = true;
+  }
+  std::vector<bool> keep(ops.size(), false);
+  for (size_t i = ops.size(); i-- > 0;) {
+    if (!live[ops[i].output]) {
+      continue;
+    }
+    keep[i] = true;
+    for (int32_t input : ops[i].inputs) {
+      live[input] = true;
+    }
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (!keep[i]) {
+      continue;
+    }
+    if (kept != i) {
+      ops[kept] = std::move(ops[i]);
+    }
+    ++kept;
+  }
+  ops.resize(kept);
+}
+
+std::string Graph::dump() const {
+  std::ostringstream out;
+  auto shape = [&](int32_t id) {
+    std::ostringstream s;
+    s << '%' << id << '[';
+    for (size_t i = 0; i < slots[id].sizes.size(); ++i) {
+      s << (i ? "," : "") << slots[id].sizes[i];
+    }
+    s << ']';
+    if (slots[id].layout != tensor::Layout::NCHW) {
+      s << ':' << tensor::layoutToString(slots[id].layout);
+    }
+    return s.str();
+  };
+  for (const Op& op : ops) {
+    out << shape(op.output) << " = " << opKindToString(op.kind);
+    // conv epilogue 는 접어 넣은 연산 이름을 잇는다 (e.g. conv2d+add+relu)
+    if (op.kind == OpKind::CONV2D) {
+      if (op.inputs.size() > 3) {
+        out << "+add";
+      }
+      if (op.params.activation != Activation::NONE) {
+        out << '+' << activationToString(op.params.activation);
+      }
+      if (op.params.upsample > 1) {
+        out << "+upsample_nearest2d";
+      }
+      if (slots[op.output].sizes[1] != slots[op.inputs[1]].sizes[0]) {
+        out << "+cat";
+      }
+    }
+    if (op.params.input_scale > 0.0f) {
+      out << ":int8";
+    }
+    out << '(';
+    for (size_t i = 0; i < op.inputs.size(); ++i) {
+      out << (i ? ", " : "") << shape(op.inputs[i]);
+    }
+    out << ')';
+    if (!op.name.empty()) {
+      out << "  # " << op.name;
+    }
+    out << '\n';
+  }
+  return out.str();
+}
+
+}  // namespace engine
+}  // namespace tfe
@@ -0,0 +1,405 @@
+#include "engine/kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "tensor/layout.h"
+
+namespace tfe {
+namespace engine {
+namespace kernels {
+
+namespace {
+
+int64_t numel(const Shape& shape) {
+  int64_t n = 1;
+  for (int64_t s : shape) {
+    n *= s;
+  }
+  return n;
+}
+
+/**
+ * @brief lanes 개씩 묶인 채널의 묶음 수 (NCHW 는 lanes = 1 이라 채널 수 그대로)
+ */
+int64_t channelBlocks(const Shape& shape, int64_t lanes) { return (shape[1] + lanes - 1) / lanes; }
+
+inline float apply(OpKind kind, float a, float b) {
+  switch (kind) {
+    case OpKind::ADD:
+      return a + b;
+    case OpKind::SUB:
+      return a - b;
+    case OpKind::MUL:
+      return a * b;
+    default:
+      return a / b;
+  }
+}
+
+}  // namespace
+
+void conv2d(const float* input, const Shape& in, const float* weight, const Shape& w,
+            const float* bias, float* output, const Shape& out, const OpParams& params) {
+  const int64_t groups      = params.groups;
+  const int64_t in_per_grp  = in[1] / groups;
+  const int64_t out_per_grp = out[1] / groups;
+  const int64_t kh = w[2], kw = w[3];
+
+  for (int64_t n = 0; n < out[0]; ++n) {
+    for (int64_t oc = 0; oc < out[1]; ++oc) {
+      const int64_t g = oc / out_per_grp;
+      float* dst      = output + (n * out[1] + oc) * out[2] * out[3];
+      for (int64_t oy = 0; oy < out[2]; ++oy) {
+        for (int64_t ox = 0; ox < out[3]; ++ox) {
+          float acc = bias ? bias[oc] : 0.0f;
+          for (int64_t ic = 0; ic < in_per_grp; ++ic) {
+            const float* src = input + (n * in[1] + g * in_per_grp + ic) * in[2] * in[3];
+            const float* k   = weight + (oc * in_per_grp + ic) * kh * kw;
+            for (int64_t ky = 0; ky < kh; ++ky) {
+              int64_t iy = oy * params.stride[0] - params.padding[0] + ky * params.dilation[0];
+              if (iy < 0 || iy >= in[2]) {
+                continue;
+              }
+              for (int64_t kx = 0; kx < kw; ++kx) {
+                int64_t ix = ox * params.stride[1] - params.padding[1] + kx * params.dilation[1];
+                if (ix < 0 || ix >= in[3]) {
+                  continue;
+                }
+                acc += src[iy * in[3] + ix] * k[ky * kw + kx];
+              }
+            }
+          }
+          dst[oy * out[3] + ox] = acc;
+        }
+      }
+    }
+  }
+}
+
+void batchNorm(const float* input, const Shape& in, const float* scale, const float* shift,
+               float* output, int64_t lanes) {
+  int64_t inner = 1;
+  for (size_t d = 2; d < in.size(); ++d) {
+    inner *= in[d];
+  }
+  const int64_t blocks = channelBlocks(in, lanes);
+  float s[kMaxLanes], t[kMaxLanes];
+  for (int64_t n = 0; n < in[0]; ++n) {
+    for (int64_t cb = 0; cb < blocks; ++cb) {
+      const float* src = input + (n * blocks + cb) * inner * lanes;
+      float* dst       = output + (n * blocks + cb) * inner * lanes;
+      for (int64_t l = 0; l < lanes; ++l) {
+        int64_t c = cb * lanes + l;
+        s[l]      = c < in[1] ? scale[c] : 0.0f;
+        t[l]      = c < in[1] ? shift[c] : 0.0f;
+      }
+      for (int64_t i = 0; i < inner; ++i) {
+        for (int64_t l = 0; l < lanes; ++l) {
+          dst[i * lanes + l] = src[i * lanes + l] * s[l] + t[l];
+        }
+      }
+    }
+  }
+}
+
+void relu(const float* input, int64_t n, float* output) {
+  for (int64_t i = 0; i < n; ++i) {
+    output[i] = input[i] > 0.0f ? input[i] : 0.0f;
+  }
+}
+
+void elu(const float* input, int64_t n, float alpha, float* output) {
+  for (int64_t i = 0; i < n; ++i) {
+    output[i] = input[i] > 0.0f ? input[i] : alpha * std::expm1(input[i]);
+  }
+}
+
+void sigmoid(const float* input, int64_t n, float* output) {
+  for (int64_t i = 0; i < n; ++i) {
+    output[i] = 1.0f / (1.0f + std::exp(-input[i]));
+  }
+}
+
+void maxPool2d(const float* input, const Shape& in, float* output, const Shape& out,
+               const OpParams& params, int64_t lanes) {
+  for (int64_t plane = 0; plane < in[0] * channelBlocks(in, lanes); ++plane) {
+    const float* src = input + plane * in[2] * in[3] * lanes;
+    float* dst       = output + plane * out[2] * out[3] * lanes;
+    for (int64_t oy = 0; oy < out[2]; ++oy) {
+      for (int64_t ox = 0; ox < out[3]; ++ox) {
+        float* best = dst + (oy * out[3] + ox) * lanes;
+        std::fill(best, best + lanes, -std::numeric_limits<float>::infinity());
+        for (int64_t ky = 0; ky < params.kernel[0]; ++ky) {
+          int64_t iy = oy * params.stride[0] - params.padding[0] + ky * params.dilation[0];
+          if (iy < 0 || iy >= in[2]) {
+            continue;
+          }
+          for (int64_t kx = 0; kx < params.kernel[1]; ++kx) {
+            int64_t ix = ox * params.stride[1] - params.padding[1] + kx * params.dilation[1];
+            if (ix < 0 || ix >= in[3]) {
+              continue;
+            }
+            const float* pixel = src + (iy * in[3] + ix) * lanes;
+            for (int64_t l = 0; l < lanes; ++l) {
+              best[l] = std::max(best[l], pixel[l]);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+void adaptiveAvgPool2d(const float* input, const Shape& in, float* output, const Shape& out,
+                       int64_t lanes) {
+  for (int64_t plane = 0; plane < in[0] * channelBlocks(in, lanes); ++plane) {
+    const float* src = input + plane * in[2] * in[3] * lanes;
+    float* dst       = output + plane * out[2] * out[3] * lanes;
+    for (int64_t oy = 0; oy < out[2]; ++oy) {
+      // PyTorch 와 같은 창: [floor(o*H/OH), ceil((o+1)*H/OH))
+      int64_t y0 = oy * in[2] / out[2];
+      int64_t y1 = ((oy + 1) * in[2] + out[2] - 1) / out[2];
+      for (int64_t ox = 0; ox < out[3]; ++ox) {
+        int64_t x0 = ox * in[3] / out[3];
+        int64_t x1 = ((ox + 1) * in[3] + out[3] - 1) / out[3];
+
+        float sum[kMaxLanes] = {};
+        for (int64_t y = y0; y < y1; ++y) {
+          for (int64_t x = x0; x < x1; ++x) {
+            const float* pixel = src + (y * in[3] + x) * lanes;
+            for (int64_t l = 0; l < lanes; ++l) {
+              sum[l] += pixel[l];
+            }
+          }
+        }
+        const float area = static_cast<float>((y1 - y0) * (x1 - x0));
+        for (int64_t l = 0; l < lanes; ++l) {
+          dst[(oy * out[3] + ox) * lanes + l] = sum[l] / area;
+        }
+      }
+    }
+  }
+}
+
+void linear(const float* input, int64_t rows, int64_t in_features, const float* weight,
+            int64_t out_features, const float* bias, float* output) {
+  for (int64_t r = 0; r < rows; ++r) {
+    const float* x = input + r * in_features;
+    for (int64_t o = 0; o < out_features; ++o) {
+      const float* w = weight + o * in_features;
+      float acc      = bias ? bias[o] : 0.0f;
+      for (int64_t i = 0; i < in_features; ++i) {
+        acc += x[i] * w[i];
+      }
+      output[r * out_features + o] = acc;
+    }
+  }
+}
+
+void binary(OpKind kind, const float* a, const Shape& as, const float* b, const Shape& bs,
+            float alpha, float* output, const Shape& out) {
+  const bool scaled = kind == OpKind::ADD || kind == OpKind::SUB;
+  const int64_t n   = numel(out);
+  if (as == out && bs == out) {
+    for (int64_t i = 0; i < n; ++i) {
+      output[i] = apply(kind, a[i], scaled ? alpha * b[i] : b[i]);
+    }
+    return;
+  }
+
+  // broadcast 되는 차원은 stride 0 으로 두고 출력 좌표를 odometer 처럼 센다
+  const size_t rank = out.size();
+  int64_t a_stride[kMaxRank] = {};
+  int64_t b_stride[kMaxRank] = {};
+  int64_t index[kMaxRank]    = {};
+  int64_t sa = 1, sb = 1;
+  for (size_t i = 0; i < rank; ++i) {
+    size_t d = rank - 1 - i;
+    if (i < as.size()) {
+      int64_t s   = as[as.size() - 1 - i];
+      a_stride[d] = s == 1 ? 0 : sa;
+      sa *= s;
+    }
+    if (i < bs.size()) {
+      int64_t s   = bs[bs.size() - 1 - i];
+      b_stride[d] = s == 1 ? 0 : sb;
+      sb *= s;
+    }
+  }
+
+  int64_t ia = 0, ib = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    output[i] = apply(kind, a[ia], scaled ? alpha * b[ib] : b[ib]);
+    for (size_t d = rank; d-- > 0;) {
+      ia += a_stride[d];
+      ib += b_stride[d];
+      if (++index[d] < out[d]) {
+        break;
+      }
+      ia -= a_stride[d] * out[d];
+      ib -= b_stride[d] * out[d];
+      index[d] = 0;
+    }
+  }
+}
+
+void binaryScalar(OpKind kind, const float* a, int64_t n, float scalar, float alpha,
+                  float* output) {
+  float b = kind == OpKind::ADD || kind == OpKind::SUB ? alpha * scalar : scalar;
+  for (int64_t i = 0; i < n; ++i) {
+    output[i] = apply(kind, a[i], b);
+  }
+}
+
+void catSlice(const float* input, int64_t outer, int64_t chunk, int64_t out_chunk,
+              float* output) {
+  for (int64_t o = 0; o < outer; ++o) {
+    std::memcpy(output + o * out_chunk, input + o * chunk, chunk * sizeof(float));
+  }
+}
+
+void upsampleNearest2d(const float* input, const Shape& in, float* output, const Shape& out,
+                       int64_t lanes) {
+  for (int64_t plane = 0; plane < in[0] * channelBlocks(in, lanes); ++plane) {
+    const float* src = input + plane * in[2] * in[3] * lanes;
+    float* dst       = output + plane * out[2] * out[3] * lanes;
+    for (int64_t oy = 0; oy < out[2]; ++oy) {
+      const float* row = src + std::min(oy * in[2] / out[2], in[2] - 1) * in[3] * lanes;
+      float* out_row   = dst + oy * out[3] * lanes;
+      for (int64_t ox = 0; ox < out[3]; ++ox) {
+        const float* pixel = row + std::min(ox * in[3] / out[3], in[3] - 1) * lanes;
+        for (int64_t l = 0; l < lanes; ++l) {
+          out_row[ox * lanes + l] = pixel[l];
+        }
+      }
+    }
+  }
+}
+
+void pad(const float* input, const Shape& in, float* output, const Shape& out,
+         const OpParams& params, int64_t lanes) {
+  const int64_t left = params.pads[0];
+  const int64_t top  = params.pads[2];
+  const bool reflect = params.pad_mode == OpParams::PadMode::REFLECT;
+  auto mirror        = [](int64_t i, int64_t n) {
+    if (i < 0) {
+      return -i;
+    }
+    return i >= n ? 2 * (n - 1) - i : i;
+  };
+
+  for (int64_t plane = 0; plane < in[0] * channelBlocks(in, lanes); ++plane) {
+    const float* src = input + plane * in[2] * in[3] * lanes;
+    float* dst       = output + plane * out[2] * out[3] * lanes;
+    for (int64_t oy = 0; oy < out[2]; ++oy) {
+      int64_t iy = oy - top;
+      for (int64_t ox = 0; ox < out[3]; ++ox) {
+        int64_t ix   = ox - left;
+        float* pixel = dst + (oy * out[3] + ox) * lanes;
+        if (reflect) {
+          std::memcpy(pixel, src + (mirror(iy, in[2]) * in[3] + mirror(ix, in[3])) * lanes,
+                      lanes * sizeof(float));
+        } else if (iy < 0 || iy >= in[2] || ix < 0 || ix >= in[3]) {
+          std::fill(pixel, pixel + lanes, params.value);
+        } else {
+          std::memcpy(pixel, src + (iy * in[3] + ix) * lanes, lanes * sizeof(float));
+        }
+      }
+    }
+  }
+}
+
+void run(const Op& op, const Graph& graph, const std::vector<float*>& values) {
+  const Shape& out = graph.slots[op.output].sizes;
+  float* dst       = values[op.output];
+  auto src         = [&](size_t i) { return values[op.inputs[i]]; };
+  auto shape       = [&](size_t i) -> const Shape& { return graph.slots[op.inputs[i]].sizes; };
+  auto optional    = [&](size_t i) -> const float* {
+    return i < op.inputs.size() ? values[op.inputs[i]] : nullptr;
+  };
+  // 원소별 연산은 layout 과 상관없이 실제 원소 수만큼 돈다
+  const int64_t count = graph.slots[op.output].numel();
+  const int64_t lanes = tensor::layoutBlock(graph.slots[op.output].layout);
+
+  switch (op.kind) {
+    case OpKind::CONV2D:
+      if (op.params.activation != Activation::NONE || op.params.upsample != 1 ||
+          op.inputs.size() > 3 || out[1] != shape(1)[0]) {
+        throw std::invalid_argument("conv2d with a fused epilogue needs ConvKernel");
+      }
+      conv2d(src(0), shape(0), src(1), shape(1), optional(2), dst, out, op.params);
+      break;
+    case OpKind::BATCH_NORM:
+      batchNorm(src(0), shape(0), src(1), src(2), dst, lanes);
+      break;
+    case OpKind::RELU:
+      relu(src(0), count, dst);
+      break;
+    case OpKind::ELU:
+      elu(src(0), count, op.params.alpha, dst);
+      break;
+    case OpKind::SIGMOID:
+      sigmoid(src(0), count, dst);
+      break;
+    case OpKind::MAX_POOL2D:
+      maxPool2d(src(0), shape(0), dst, out, op.params, lanes);
+      break;
+    case OpKind::ADAPTIVE_AVG_POOL2D:
+      adaptiveAvgPool2d(src(0), shape(0), dst, out, lanes);
+      break;
+    case OpKind::LINEAR: {
+      const Shape& w = shape(1);
+      linear(src(0), numel(shape(0)) / w[1], w[1], src(1), w[0], optional(2), dst);
+      break;
+    }
+    case OpKind::ADD:
+    case OpKind::SUB:
+    case OpKind::MUL:
+    case OpKind::DIV:
+      if (op.params.has_scalar) {
+        binaryScalar(op.kind, src(0), count, op.params.scalar, op.params.alpha, dst);
+      } else {
+        binary(op.kind, src(0), shape(0), src(1), shape(1), op.params.alpha, dst, out);
+      }
+      break;
+    case OpKind::CAT: {
+      // 입력마다 axis 아래 덩어리를 출력의 제 열에 복사한다 (임시 배열 없이).
+      // 묶인 layout 의 채널 cat 도 묶음 단위로 같은 모양이다
+      int64_t outer = 1;
+      for (int64_t d = 0; d < op.params.axis; ++d) {
+        outer *= out[d];
+      }
+      const int64_t out_chunk = numel(out) / outer;
+      float* column           = dst + op.params.offset * (out_chunk / out[op.params.axis]);
+      for (size_t i = 0; i < op.inputs.size(); ++i) {
+        int64_t chunk = numel(shape(i)) / outer;
+        catSlice(src(i), outer, chunk, out_chunk, column);
+        column += chunk;
+      }
+      break;
+    }
+    case OpKind::UPSAMPLE_NEAREST2D:
+      upsampleNearest2d(src(0), shape(0), dst, out, lanes);
+      break;
+    case OpKind::PAD:
+      pad(src(0), shape(0), dst, out, op.params, lanes);
+      break;
+    case OpKind::RESHAPE:
+      if (dst != src(0)) {
+        std::memcpy(dst, src(0), numel(out) * sizeof(float));
+      }
+      break;
+    case OpKind::REORDER:
+      tensor::reorder(src(0), graph.slots[op.inputs[0]].layout, dst,
+                      graph.slots[op.output].layout, out);
+      break;
+  }
+}
+
+}  // namespace kernels
+}  // namespace engine
+}  // namespace tfe
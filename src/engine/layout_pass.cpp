@@ -0,0 +1,126 @@
+#include "engine/layout_pass.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "engine/conv.h"
+
+namespace tfe {
+namespace engine {
+
+void assignLayouts(Graph& graph, tensor::Layout blocked) {
+  using tensor::Layout;
+  const int64_t block = tensor::layoutBlock(blocked);
+
+  std::vector<Op> ops = std::move(graph.ops);
+  graph.ops.clear();
+
+  // slot 을 layout 으로 바꾼 사본. 같은 변환은 한 번만 넣는다
+  std::map<std::pair<int32_t, Layout>, int32_t> converted;
+  auto as = [&](int32_t slot, Layout layout) {
+    if (graph.slots[slot].layout == layout) {
+      return slot;
+    }
+    auto it = converted.find({slot, layout});
+    if (it != converted.end()) {
+      return it->second;
+    }
+    int32_t copy = graph.addSlot(graph.slots[slot].name + "." + tensor::layoutToString(layout),
+                                 graph.slots[slot].sizes);
+    graph.slots[copy].layout = layout;
+    graph.addOp(OpKind::REORDER, {slot}, copy, "");
+    converted[{slot, layout}] = copy;
+    return copy;
+  };
+  auto layoutOf  = [&](int32_t slot) { return graph.slots[slot].layout; };
+  auto blockable = [&](int32_t slot) {
+    const Slot& s = graph.slots[slot];
+    return !s.constant && s.sizes.size() == 4 && s.sizes[1] % block == 0;
+  };
+  // 모든 입력을 layout 으로 맞춘다
+  auto convertAll = [&](Op& op, Layout layout) {
+    for (int32_t& input : op.inputs) {
+      input = as(input, layout);
+    }
+  };
+
+  for (Op& op : ops) {
+    Layout out = Layout::NCHW;
+    switch (op.kind) {
+      case OpKind::CONV2D: {
+        const std::vector<int64_t> x = graph.slots[op.inputs[0]].sizes;
+        const std::vector<int64_t> w = graph.slots[op.inputs[1]].sizes;
+        const Layout in              = layoutOf(op.inputs[0]);
+        if (op.params.input_scale > 0.0f) {
+          // int8 conv 는 NCHW 만 받는다
+          convertAll(op, Layout::NCHW);
+        } else if (block < 16 && selectConvAlgo(x, w, op.params) == ConvAlgo::WINOGRAD_3X3) {
+          // 8 lane 직접 conv (AVX2 / NEON) 는 Winograd 보다 느리다. 앞뒤 REORDER 를 감수한다
+          convertAll(op, Layout::NCHW);
+        } else if (convLayoutApplies(x, w, op.params, in, blocked)) {
+          out = blocked;
+        } else if (in == Layout::NCHW && blockable(op.inputs[0]) &&
+                   convLayoutApplies(x, w, op.params, blocked, blocked)) {
+          // NCHW 입력을 받지 못하는 depthwise
+          op.inputs[0] = as(op.inputs[0], blocked);
+          out          = blocked;
+        } else {
+          convertAll(op, Layout::NCHW);
+        }
+        break;
+      }
+      case OpKind::RELU:
+      case OpKind::ELU:
+      case OpKind::SIGMOID:
+      case OpKind::BATCH_NORM:
+      case OpKind::MAX_POOL2D:
+      case OpKind::ADAPTIVE_AVG_POOL2D:
+      case OpKind::UPSAMPLE_NEAREST2D:
+      case OpKind::PAD:
+        out = layoutOf(op.inputs[0]);
+        break;
+      case OpKind::ADD:
+      case OpKind::SUB:
+      case OpKind::MUL:
+      case OpKind::DIV: {
+        if (op.params.has_scalar) {
+          out = layoutOf(op.inputs[0]);
+          break;
+        }
+        // 같은 shape 끼리면 원소별이라 배치가 같기만 하면 된다. broadcast 는 NCHW 에서만
+        const int32_t a = op.inputs[0], b = op.inputs[1];
+        const bool same = graph.slots[a].sizes == graph.slots[b].sizes &&
+                          graph.slots[a].sizes == graph.slots[op.output].sizes;
+        if (same && blockable(a) && blockable(b) &&
+            (layoutOf(a) == blocked || layoutOf(b) == blocked)) {
+          out = blocked;
+        }
+        convertAll(op, out);
+        break;
+      }
+      case OpKind::CAT: {
+        bool all = op.params.axis == 1, any = false;
+        for (int32_t input : op.inputs) {
+          all = all && blockable(input);
+          any = any || layoutOf(input) == blocked;
+        }
+        out = all && any ? blocked : Layout::NCHW;
+        convertAll(op, out);
+        break;
+      }
+      default:
+        convertAll(op, Layout::NCHW);
+        break;
+    }
+    graph.slots[op.output].layout = out;
+    graph.ops.push_back(std::move(op));
+  }
+
+  for (int32_t& output : graph.outputs) {
+    output = as(output, Layout::NCHW);
+  }
+}
+
+}  // namespace engine
+}  // namespace tfe
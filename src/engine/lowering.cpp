@@ -0,0 +1,1238 @@
+#include "engine/lowering.h"
+
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+#include "engine/kernels.h"
+#include "engine/script_source.h"
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+constexpr int kMaxCallDepth = 256;
+
+/**
+ * @brief 기호 실행 중의 값. TENSOR 는 graph slot 을 가리키고 스칼라/리스트는 그 자리에서 접힌다
+ */
+struct Value {
+  enum class Kind : uint8_t {
+    NONE,
+    BOOL,
+    INT,
+    FLOAT,
+    STRING,
+    TENSOR,
+    LIST,
+    MODULE,
+    NAMESPACE,
+    METHOD
+  };
+
+  Kind kind = Kind::NONE;
+  bool b    = false;
+  int64_t i = 0;
+  double f  = 0.0;
+  std::string s;
+  int32_t slot                 = -1;
+  std::vector<Value> items;
+  const model::Module* module = nullptr;
+
+  static Value none() { return Value(); }
+  static Value boolean(bool v) {
+    Value value;
+    value.kind = Kind::BOOL;
+    value.b    = v;
+    return value;
+  }
+  static Value integer(int64_t v) {
+    Value value;
+    value.kind = Kind::INT;
+    value.i    = v;
+    return value;
+  }
+  static Value real(double v) {
+    Value value;
+    value.kind = Kind::FLOAT;
+    value.f    = v;
+    return value;
+  }
+  static Value string(std::string v) {
+    Value value;
+    value.kind = Kind::STRING;
+    value.s    = std::move(v);
+    return value;
+  }
+  static Value tensor(int32_t slot) {
+    Value value;
+    value.kind = Kind::TENSOR;
+    value.slot = slot;
+    return value;
+  }
+  static Value list(std::vector<Value> items) {
+    Value value;
+    value.kind  = Kind::LIST;
+    value.items = std::move(items);
+    return value;
+  }
+  static Value ofModule(const model::Module* module) {
+    Value value;
+    value.kind   = Kind::MODULE;
+    value.module = module;
+    return value;
+  }
+  static Value ns(std::string name) {
+    Value value;
+    value.kind = Kind::NAMESPACE;
+    value.s    = std::move(name);
+    return value;
+  }
+  static Value method(const model::Module* module, std::string name) {
+    Value value;
+    value.kind   = Kind::METHOD;
+    value.module = module;
+    value.s      = std::move(name);
+    return value;
+  }
+
+  bool isNone() const { return kind == Kind::NONE; }
+  bool isTensor() const { return kind == Kind::TENSOR; }
+  bool isScalar() const { return kind == Kind::INT || kind == Kind::FLOAT || kind == Kind::BOOL; }
+
+  double number() const {
+    switch (kind) {
+      case Kind::INT:
+        return static_cast<double>(i);
+      case Kind::FLOAT:
+        return f;
+      case Kind::BOOL:
+        return b ? 1.0 : 0.0;
+      default:
+        throw LoweringError("expected a number");
+    }
+  }
+  int64_t toInt() const {
+    return kind == Kind::INT ? i : static_cast<int64_t>(number());
+  }
+  bool truthy() const { return kind == Kind::BOOL ? b : number() != 0.0; }
+};
+
+/**
+ * @brief 호출 인자. keyword 는 schema 의 이름으로, positional 은 위치로 찾는다
+ */
+struct Args {
+  std::vector<Value> positional;
+  std::vector<std::pair<std::string, Value>> keywords;
+
+  const Value* get(size_t index, const char* name) const {
+    if (index < positional.size()) {
+      return &positional[index];
+    }
+    for (const auto& keyword : keywords) {
+      if (keyword.first == name) {
+        return &keyword.second;
+      }
+    }
+    return nullptr;
+  }
+};
+
+using Env = std::unordered_map<std::string, Value>;
+
+std::string lastComponent(const std::string& qualified) {
+  size_t dot = qualified.rfind('.');
+  return dot == std::string::npos ? qualified : qualified.substr(dot + 1);
+}
+
+int64_t normalizeDim(int64_t dim, size_t rank) {
+  int64_t r = static_cast<int64_t>(rank);
+  if (dim < -r || dim >= r) {
+    throw LoweringError("dimension " + std::to_string(dim) + " out of range");
+  }
+  return dim < 0 ? dim + r : dim;
+}
+
+class Interpreter {
+ public:
+  Interpreter(const model::ScriptModel& model, Graph& graph)
+      : model_(model), modules_(model.modules()), graph_(graph) {
+    for (const model::SourceFile& file : model.sources()) {
+      source_.add(file.path, file.text);
+    }
+  }
+
+  void run(const std::vector<std::vector<int64_t>>& input_shapes) {
+    std::vector<Value> args;
+    for (size_t i = 0; i < input_shapes.size(); ++i) {
+      int32_t slot = graph_.addSlot("input" + std::to_string(i), input_shapes[i]);
+      graph_.inputs.push_back(slot);
+      args.push_back(Value::tensor(slot));
+    }
+
+    Value result = call(modules_.root(), "forward", args, 0);
+    collectOutputs(result);
+    if (graph_.outputs.empty()) {
+      throw LoweringError("forward returns no tensor");
+    }
+    graph_.eliminateDeadOps();
+  }
+
+ private:
+  void collectOutputs(const Value& value) {
+    if (value.isTensor()) {
+      graph_.outputs.push_back(value.slot);
+    } else if (value.kind == Value::Kind::LIST) {
+      for (const Value& item : value.items) {
+        collectOutputs(item);
+      }
+    }
+  }
+
+  // ---------------------------------------------------------------- calls
+
+  Value call(const model::Module& module, const std::string& name, const std::vector<Value>& args,
+             int depth) {
+    if (depth > kMaxCallDepth) {
+      throw LoweringError("call depth exceeded at " + modules_.path(module));
+    }
+
+    const std::string type = std::string(modules_.str(module.type()));
+    const ClassDef* cls    = source_.find(type);
+    const Method* method   = cls ? cls->method(name) : nullptr;
+
+    if (method) {
+      size_t slots = graph_.slots.size();
+      size_t ops   = graph_.ops.size();
+      try {
+        return interpret(module, *cls, *method, args, depth);
+      } catch (const LoweringError&) {
+        // scripted leaf 의 분기 있는 forward 는 되돌리고 속성 기반 lowering 으로 대신한다
+        if (name != "forward" || !isLeaf(type)) {
+          throw;
+        }
+        rollback(slots, ops);
+      }
+    }
+
+    if (name == "forward") {
+      if (isLeaf(type)) {
+        return lowerLeaf(module, type, args);
+      }
+      if (!method && !module.children().empty()) {
+        // 소스 없는 Sequential 류: 자식을 순서대로 잇는다
+        std::vector<Value> current = args;
+        for (const auto& child : module.children()) {
+          current = {call(*child.second, "forward", current, depth + 1)};
+        }
+        return current[0];
+      }
+    }
+    throw LoweringError("no lowering for " + type + "." + name + " at '" + modules_.path(module) +
+                        "'");
+  }
+
+  Value interpret(const model::Module& module, const ClassDef& cls, const Method& method,
+                  const std::vector<Value>& args, int depth) {
+    if (method.params.size() != args.size() + 1) {
+      throw LoweringError(cls.name + "." + method.name + " expects " +
+                          std::to_string(method.params.size() - 1) + " arguments");
+    }
+    Env env;
+    env[method.params[0]] = Value::ofModule(&module);
+    for (size_t i = 0; i < args.size(); ++i) {
+      env[method.params[i + 1]] = args[i];
+    }
+
+    for (const Stmt& stmt : method.body) {
+      switch (stmt.kind) {
+        case Stmt::Kind::UNSUPPORTED:
+          throw LoweringError(cls.name + "." + method.name + " line " + std::to_string(stmt.line) +
+                              ": unsupported statement '" + stmt.text + "'");
+        case Stmt::Kind::RETURN:
+          return eval(*stmt.value, env, module, depth);
+        case Stmt::Kind::EXPR:
+          eval(*stmt.value, env, module, depth);
+          break;
+        case Stmt::Kind::ASSIGN: {
+          Value value = eval(*stmt.value, env, module, depth);
+          if (stmt.targets.size() == 1) {
+            env[stmt.targets[0]] = std::move(value);
+            break;
+          }
+          if (value.kind != Value::Kind::LIST || value.items.size() != stmt.targets.size()) {
+            throw LoweringError(cls.name + "." + method.name + " line " +
+                                std::to_string(stmt.line) + ": cannot unpack");
+          }
+          for (size_t i = 0; i < stmt.targets.size(); ++i) {
+            env[stmt.targets[i]] = value.items[i];
+          }
+          break;
+        }
+      }
+    }
+    return Value::none();
+  }
+
+  void rollback(size_t slots, size_t ops) {
+    graph_.slots.resize(slots);
+    graph_.ops.resize(ops);
+    for (auto it = constants_.begin(); it != constants_.end();) {
+      it = it->second >= static_cast<int32_t>(slots) ? constants_.erase(it) : std::next(it);
+    }
+  }
+
+  // ---------------------------------------------------------------- expressions
+
+  Value eval(const Expr& expr, Env& env, const model::Module& self, int depth) {
+    switch (expr.kind) {
+      case Expr::Kind::NAME: {
+        auto it = env.find(expr.text);
+        return it != env.end() ? it->second : Value::ns(expr.text);
+      }
+      case Expr::Kind::INT:
+        return Value::integer(expr.i);
+      case Expr::Kind::FLOAT:
+        return Value::real(expr.f);
+      case Expr::Kind::STRING:
+        return Value::string(expr.text);
+      case Expr::Kind::NONE:
+        return Value::none();
+      case Expr::Kind::BOOL:
+        return Value::boolean(expr.b);
+      case Expr::Kind::LIST:
+      case Expr::Kind::TUPLE: {
+        std::vector<Value> items;
+        for (const auto& arg : expr.args) {
+          items.push_back(eval(*arg, env, self, depth));
+        }
+        return Value::list(std::move(items));
+      }
+      case Expr::Kind::ATTR:
+        return attribute(eval(*expr.args[0], env, self, depth), expr.text);
+      case Expr::Kind::SUBSCRIPT: {
+        Value base  = eval(*expr.args[0], env, self, depth);
+        Value index = eval(*expr.args[1], env, self, depth);
+        if (base.kind == Value::Kind::NAMESPACE) {
+          return base;  // List[Tensor] 같은 타입 식
+        }
+        if (base.kind == Value::Kind::LIST) {
+          int64_t i = normalizeDim(index.toInt(), base.items.size());
+          return base.items[i];
+        }
+        if (base.kind == Value::Kind::MODULE && index.kind == Value::Kind::STRING) {
+          return member(*base.module, index.s);
+        }
+        throw LoweringError("unsupported subscript");
+      }
+      case Expr::Kind::NEG: {
+        Value operand = eval(*expr.args[0], env, self, depth);
+        if (operand.kind == Value::Kind::INT) {
+          return Value::integer(-operand.i);
+        }
+        if (operand.isScalar()) {
+          return Value::real(-operand.number());
+        }
+        return binary(OpKind::MUL, operand, Value::real(-1.0), 1.0, scope(self));
+      }
+      case Expr::Kind::BINARY:
+        return arithmetic(expr.op, eval(*expr.args[0], env, self, depth),
+                          eval(*expr.args[1], env, self, depth), scope(self));
+      case Expr::Kind::CALL: {
+        Value callee = eval(*expr.args[0], env, self, depth);
+        Args args;
+        size_t num_positional = expr.args.size() - 1 - expr.keywords.size();
+        for (size_t i = 1; i < expr.args.size(); ++i) {
+          Value value = eval(*expr.args[i], env, self, depth);
+          if (i - 1 < num_positional) {
+            args.positional.push_back(std::move(value));
+          } else {
+            args.keywords.emplace_back(expr.keywords[i - 1 - num_positional], std::move(value));
+          }
+        }
+        if (callee.kind == Value::Kind::METHOD) {
+          if (!args.keywords.empty()) {
+            throw LoweringError("keyword arguments to module methods are not supported");
+          }
+          return call(*callee.module, callee.s, args.positional, depth + 1);
+        }
+        if (callee.kind == Value::Kind::NAMESPACE) {
+          return callBuiltin(callee.s, args, scope(self));
+        }
+        throw LoweringError("call of a non-callable value");
+      }
+    }
+    throw LoweringError("unknown expression");
+  }
+
+  Value arithmetic(char op, const Value& lhs, const Value& rhs, const std::string& where) {
+    if (lhs.isScalar() && rhs.isScalar()) {
+      bool ints = lhs.kind == Value::Kind::INT && rhs.kind == Value::Kind::INT;
+      switch (op) {
+        case '+':
+          return ints ? Value::integer(lhs.i + rhs.i) : Value::real(lhs.number() + rhs.number());
+        case '-':
+          return ints ? Value::integer(lhs.i - rhs.i) : Value::real(lhs.number() - rhs.number());
+        case '*':
+          return ints ? Value::integer(lhs.i * rhs.i) : Value::real(lhs.number() * rhs.number());
+        case '/':
+          return Value::real(lhs.number() / rhs.number());
+        case 'f':
+          return ints ? Value::integer(lhs.i / rhs.i)
+                      : Value::real(std::floor(lhs.number() / rhs.number()));
+        default:
+          throw LoweringError(std::string("unsupported operator ") + op);
+      }
+    }
+    switch (op) {
+      case '+':
+        return binary(OpKind::ADD, lhs, rhs, 1.0, where);
+      case '-':
+        return binary(OpKind::SUB, lhs, rhs, 1.0, where);
+      case '*':
+        return binary(OpKind::MUL, lhs, rhs, 1.0, where);
+      case '/':
+        return binary(OpKind::DIV, lhs, rhs, 1.0, where);
+      default:
+        throw LoweringError(std::string("unsupported tensor operator ") + op);
+    }
+  }
+
+  Value attribute(const Value& base, const std::string& name) {
+    if (base.kind == Value::Kind::NAMESPACE) {
+      if (base.s == "CONSTANTS" && name.size() > 1 && name[0] == 'c') {
+        return constant(std::stoul(name.substr(1)));
+      }
+      return Value::ns(base.s + "." + name);
+    }
+    if (base.kind == Value::Kind::MODULE) {
+      return member(*base.module, name);
+    }
+    throw LoweringError("attribute '" + name + "' of a non-module value");
+  }
+
+  /**
+   * @brief self.<name>: 서브모듈, 텐서, 속성, 클래스 상수 순. 아무것도 아니면 메서드로 본다
+   */
+  Value member(const model::Module& module, const std::string& name) {
+    bool found  = false;
+    Value value = lookup(module, name, &found);
+    return found ? value : Value::method(&module, name);
+  }
+
+  Value lookup(const model::Module& module, const std::string& name, bool* found) {
+    *found               = true;
+    model::Symbol symbol = modules_.strings().find(name);
+    if (symbol != model::StringTable::kInvalid) {
+      if (const model::Module* child = module.child(symbol)) {
+        return Value::ofModule(child);
+      }
+      if (const tensor::Tensor* t = module.tensor(symbol)) {
+        return Value::tensor(constantSlot(*t, modules_.path(module) + "." + name));
+      }
+      if (const model::Attribute* attr = module.attribute(symbol)) {
+        return toValue(*attr, modules_.strings());
+      }
+    }
+    if (const ClassDef* cls = source_.find(std::string(modules_.str(module.type())))) {
+      if (const Expr* expr = cls->constant(name)) {
+        Env env;
+        return eval(*expr, env, module, 0);
+      }
+    }
+    *found = false;
+    return Value::none();
+  }
+
+  static Value toValue(const model::Attribute& attr, const model::StringTable& strings) {
+    switch (attr.kind) {
+      case model::Attribute::Kind::BOOL:
+        return Value::boolean(attr.b);
+      case model::Attribute::Kind::INT:
+        return Value::integer(attr.i);
+      case model::Attribute::Kind::FLOAT:
+        return Value::real(attr.f);
+      case model::Attribute::Kind::STRING:
+        return Value::string(std::string(strings.str(attr.s)));
+      case model::Attribute::Kind::INT_LIST: {
+        std::vector<Value> items;
+        for (int64_t v : attr.ints) {
+          items.push_back(Value::integer(v));
+        }
+        return Value::list(std::move(items));
+      }
+      case model::Attribute::Kind::FLOAT_LIST: {
+        std::vector<Value> items;
+        for (double v : attr.floats) {
+          items.push_back(Value::real(v));
+        }
+        return Value::list(std::move(items));
+      }
+      default:
+        return Value::none();
+    }
+  }
+
+  Value constant(size_t index) {
+    const auto& constants = model_.constants();
+    if (index >= constants.size()) {
+      throw LoweringError("CONSTANTS.c" + std::to_string(index) + " out of range");
+    }
+    const model::Constant& c = constants[index];
+    if (c.isTensor()) {
+      return Value::tensor(constantSlot(c.tensor, "CONSTANTS.c" + std::to_string(index)));
+    }
+    return toValue(c.value, model::StringTable());
+  }
+
+  std::string scope(const model::Module& module) const { return modules_.path(module); }
+
+  // ---------------------------------------------------------------- slots
+
+  /**
+   * @brief 모델 텐서를 상수 slot 으로. 커널은 연속 float32 만 받으므로 필요하면 여기서 변환한다
+   */
+  int32_t constantSlot(const tensor::Tensor& t, const std::string& name) {
+    auto it = constants_.find(&t);
+    if (it != constants_.end()) {
+      return it->second;
+    }
+    int32_t slot   = graph_.addConstant(name, toFloat(t));
+    constants_[&t] = slot;
+    return slot;
+  }
+
+  static tensor::Tensor toFloat(const tensor::Tensor& t) {
+    tensor::Tensor src = tensor::contiguous(t);
+    if (src.dtype() == tensor::DType::FLOAT32) {
+      return src;
+    }
+    tensor::Tensor dst = tensor::empty(src.sizes(), tensor::DType::FLOAT32, src.storage()->key());
+    float* out         = dst.data<float>();
+    for (int64_t i = 0; i < src.numel(); ++i) {
+      switch (src.dtype()) {
+        case tensor::DType::FLOAT64:
+          out[i] = static_cast<float>(src.data<double>()[i]);
+          break;
+        case tensor::DType::INT64:
+          out[i] = static_cast<float>(src.data<int64_t>()[i]);
+          break;
+        case tensor::DType::INT32:
+          out[i] = static_cast<float>(src.data<int32_t>()[i]);
+          break;
+        default:
+          throw LoweringError(std::string("unsupported constant dtype ") +
+                              tensor::dtypeToString(src.dtype()));
+      }
+    }
+    return dst;
+  }
+
+  int32_t newConstant(const std::string& name, const std::vector<int64_t>& sizes,
+                      const std::vector<float>& values) {
+    tensor::Tensor t = tensor::empty(sizes, tensor::DType::FLOAT32, name);
+    std::memcpy(t.data(), values.data(), values.size() * sizeof(float));
+    return graph_.addConstant(name, std::move(t));
+  }
+
+  // graph_.slots 는 op 을 만들 때마다 자랄 수 있으므로 참조가 아니라 사본을 돌려준다
+  std::vector<int64_t> sizesOf(int32_t slot) const { return graph_.slots[slot].sizes; }
+
+  const float* constantData(int32_t slot, const char* what) const {
+    const Slot& s = graph_.slots[slot];
+    if (!s.constant) {
+      throw LoweringError(std::string(what) + " must be a model constant");
+    }
+    return s.tensor.data<float>();
+  }
+
+  int32_t emit(OpKind kind, std::vector<int32_t> inputs, std::vector<int64_t> sizes,
+               const OpParams& params, const std::string& where) {
+    int32_t output = graph_.addSlot(where.empty() ? opKindToString(kind)
+                                                  : where + "/" + opKindToString(kind),
+                                    std::move(sizes));
+    Op& op    = graph_.addOp(kind, std::move(inputs), output, where);
+    op.params = params;
+    return output;
+  }
+
+  static int32_t tensorArg(const Value* value, const char* what) {
+    if (!value || !value->isTensor()) {
+      throw LoweringError(std::string(what) + " must be a tensor");
+    }
+    return value->slot;
+  }
+
+  static std::vector<int64_t> intList(const Value* value, size_t n, int64_t fallback) {
+    if (!value || value->isNone() ||
+        (value->kind == Value::Kind::LIST && value->items.empty())) {
+      return std::vector<int64_t>(n, fallback);
+    }
+    if (value->isScalar()) {
+      return std::vector<int64_t>(n, value->toInt());
+    }
+    if (value->kind != Value::Kind::LIST) {
+      throw LoweringError("expected an int list");
+    }
+    std::vector<int64_t> out;
+    for (const Value& item : value->items) {
+      out.push_back(item.toInt());
+    }
+    if (out.size() == 1 && n > 1) {
+      out.resize(n, out[0]);
+    }
+    return out;
+  }
+
+  static std::vector<int64_t> intList(const Value& value, size_t n, int64_t fallback) {
+    return intList(&value, n, fallback);
+  }
+
+  static double number(const Value* value, double fallback) {
+    return value && !value->isNone() ? value->number() : fallback;
+  }
+
+  // ---------------------------------------------------------------- builtins
+
+  Value callBuiltin(const std::string& name, const Args& args, const std::string& where) {
+    const Value* first = args.get(0, "self");
+    if (name == "annotate") {
+      return args.positional.at(1);
+    }
+    if (name == "int") {
+      return Value::integer(first->toInt());
+    }
+    if (name == "float") {
+      return Value::real(first->number());
+    }
+    if (name == "bool") {
+      return Value::boolean(first->truthy());
+    }
+    if (name == "len") {
+      return Value::integer(static_cast<int64_t>(first->items.size()));
+    }
+    if (name == "getattr") {
+      return member(*first->module, args.positional.at(1).s);
+    }
+    if (name == "uninitialized") {
+      return Value::none();
+    }
+    if (name == "ops.prim.NumToTensor") {
+      return *first;
+    }
+    if (name.compare(0, 6, "torch.") == 0) {
+      return lowerTorch(name.substr(6), args, where);
+    }
+    throw LoweringError("unsupported call " + name);
+  }
+
+  Value lowerTorch(std::string op, const Args& args, const std::string& where) {
+    // 결과를 항상 새 slot 에 쓰므로 in-place 변형은 out-of-place 와 같다
+    if (op.size() > 1 && op.back() == '_' && op.compare(0, 2, "__") != 0) {
+      op.pop_back();
+    }
+    const Value* self = args.get(0, "self");
+
+    if (op == "_convolution" || op == "conv2d") {
+      bool legacy = op == "_convolution";
+      if (legacy && args.get(6, "transposed") && args.get(6, "transposed")->truthy()) {
+        throw LoweringError("transposed convolution is not supported");
+      }
+      OpParams params;
+      std::vector<int64_t> stride   = intList(args.get(3, "stride"), 2, 1);
+      std::vector<int64_t> padding  = intList(args.get(4, "padding"), 2, 0);
+      std::vector<int64_t> dilation = intList(args.get(5, "dilation"), 2, 1);
+      const Value* groups           = legacy ? args.get(8, "groups") : args.get(6, "groups");
+      for (int d = 0; d < 2; ++d) {
+        params.stride[d]   = stride[d];
+        params.padding[d]  = padding[d];
+        params.dilation[d] = dilation[d];
+      }
+      params.groups = groups ? groups->toInt() : 1;
+      return Value::tensor(conv2d(tensorArg(self, "conv input"), tensorArg(args.get(1, "weight"),
+                                  "conv weight"), args.get(2, "bias"), params, where));
+    }
+    if (op == "batch_norm") {
+      return Value::tensor(batchNorm(tensorArg(self, "batch_norm input"), args.get(1, "weight"),
+                                     args.get(2, "bias"), args.get(3, "running_mean"),
+                                     args.get(4, "running_var"), number(args.get(7, "eps"), 1e-5),
+                                     where));
+    }
+    if (op == "relu" || op == "sigmoid") {
+      int32_t input = tensorArg(self, op.c_str());
+      return Value::tensor(emit(op == "relu" ? OpKind::RELU : OpKind::SIGMOID, {input},
+                                sizesOf(input), OpParams(), where));
+    }
+    if (op == "elu") {
+      if (number(args.get(2, "scale"), 1.0) != 1.0 ||
+          number(args.get(3, "input_scale"), 1.0) != 1.0) {
+        throw LoweringError("elu with scale is not supported");
+      }
+      OpParams params;
+      params.alpha  = static_cast<float>(number(args.get(1, "alpha"), 1.0));
+      int32_t input = tensorArg(self, "elu input");
+      return Value::tensor(emit(OpKind::ELU, {input}, sizesOf(input), params, where));
+    }
+    if (op == "max_pool2d") {
+      OpParams params;
+      std::vector<int64_t> kernel = intList(args.get(1, "kernel_size"), 2, 1);
+      std::vector<int64_t> stride = intList(args.get(2, "stride"), 2, 0);
+      if (stride[0] == 0) {
+        stride = kernel;
+      }
+      std::vector<int64_t> padding  = intList(args.get(3, "padding"), 2, 0);
+      std::vector<int64_t> dilation = intList(args.get(4, "dilation"), 2, 1);
+      for (int d = 0; d < 2; ++d) {
+        params.kernel[d]   = kernel[d];
+        params.stride[d]   = stride[d];
+        params.padding[d]  = padding[d];
+        params.dilation[d] = dilation[d];
+      }
+      const Value* ceil = args.get(5, "ceil_mode");
+      params.ceil_mode  = ceil && ceil->truthy();
+      return Value::tensor(maxPool2d(tensorArg(self, "max_pool2d input"), params, where));
+    }
+    if (op == "adaptive_avg_pool2d") {
+      std::vector<int64_t> size = intList(args.get(1, "output_size"), 2, 1);
+      return Value::tensor(adaptiveAvgPool2d(tensorArg(self, "pool input"), size, where));
+    }
+    if (op == "mean") {
+      // x.mean([2, 3], keepdim) 는 global average pool
+      std::vector<int64_t> dims = intList(args.get(1, "dim"), 0, 0);
+      int32_t input             = tensorArg(self, "mean input");
+      const auto in             = sizesOf(input);
+      if (in.size() != 4 || dims.size() != 2 || normalizeDim(dims[0], 4) != 2 ||
+          normalizeDim(dims[1], 4) != 3) {
+        throw LoweringError("mean is only supported over the spatial dims of NCHW");
+      }
+      int32_t pooled    = adaptiveAvgPool2d(input, {1, 1}, where);
+      const Value* keep = args.get(2, "keepdim");
+      if (keep && keep->truthy()) {
+        return Value::tensor(pooled);
+      }
+      return Value::tensor(reshape(pooled, {in[0], in[1]}, where));
+    }
+    if (op == "flatten") {
+      int32_t input = tensorArg(self, "flatten input");
+      const auto in = sizesOf(input);
+      int64_t start = normalizeDim(number(args.get(1, "start_dim"), 0), in.size());
+      int64_t end   = normalizeDim(number(args.get(2, "end_dim"), -1), in.size());
+      std::vector<int64_t> out(in.begin(), in.begin() + start);
+      int64_t merged = 1;
+      for (int64_t d = start; d <= end; ++d) {
+        merged *= in[d];
+      }
+      out.push_back(merged);
+      out.insert(out.end(), in.begin() + end + 1, in.end());
+      return Value::tensor(reshape(input, out, where));
+    }
+    if (op == "reshape" || op == "view") {
+      int32_t input              = tensorArg(self, "reshape input");
+      std::vector<int64_t> shape = intList(args.get(1, "shape"), 0, 0);
+      int64_t known              = 1;
+      int64_t infer              = -1;
+      for (size_t d = 0; d < shape.size(); ++d) {
+        if (shape[d] == -1) {
+          infer = static_cast<int64_t>(d);
+        } else {
+          known *= shape[d];
+        }
+      }
+      if (infer >= 0) {
+        shape[infer] = graph_.slots[input].numel() / known;
+      }
+      return Value::tensor(reshape(input, shape, where));
+    }
+    if (op == "linear") {
+      return Value::tensor(linear(tensorArg(self, "linear input"),
+                                  tensorArg(args.get(1, "weight"), "linear weight"),
+                                  args.get(2, "bias"), false, where));
+    }
+    if (op == "addmm") {
+      // trace 된 nn.Linear: addmm(bias, x, weight.t())
+      if (number(args.get(3, "beta"), 1.0) != 1.0 || number(args.get(4, "alpha"), 1.0) != 1.0) {
+        throw LoweringError("addmm with beta/alpha is not supported");
+      }
+      return Value::tensor(linear(tensorArg(args.get(1, "mat1"), "addmm input"),
+                                  tensorArg(args.get(2, "mat2"), "addmm weight"), self, true,
+                                  where));
+    }
+    if (op == "t") {
+      int32_t input = tensorArg(self, "t input");
+      const auto in = sizesOf(input);
+      if (in.size() != 2) {
+        throw LoweringError("t() expects a matrix");
+      }
+      const float* src = constantData(input, "t() input");
+      std::vector<float> values(in[0] * in[1]);
+      for (int64_t r = 0; r < in[0]; ++r) {
+        for (int64_t c = 0; c < in[1]; ++c) {
+          values[c * in[0] + r] = src[r * in[1] + c];
+        }
+      }
+      return Value::tensor(newConstant(graph_.slots[input].name + ".t", {in[1], in[0]}, values));
+    }
+    if (op == "add" || op == "sub") {
+      return binary(op == "add" ? OpKind::ADD : OpKind::SUB, *self, *args.get(1, "other"),
+                    number(args.get(2, "alpha"), 1.0), where);
+    }
+    if (op == "mul" || op == "div") {
+      if (args.get(2, "rounding_mode") && !args.get(2, "rounding_mode")->isNone()) {
+        throw LoweringError("div with rounding_mode is not supported");
+      }
+      return binary(op == "mul" ? OpKind::MUL : OpKind::DIV, *self, *args.get(1, "other"), 1.0,
+                    where);
+    }
+    if (op == "cat") {
+      const Value* tensors = args.get(0, "tensors");
+      if (!tensors || tensors->kind != Value::Kind::LIST || tensors->items.empty()) {
+        throw LoweringError("cat expects a tensor list");
+      }
+      std::vector<int32_t> inputs;
+      for (const Value& item : tensors->items) {
+        inputs.push_back(tensorArg(&item, "cat input"));
+      }
+      return Value::tensor(cat(inputs, number(args.get(1, "dim"), 0), where));
+    }
+    if (op == "upsample_nearest2d") {
+      int32_t input = tensorArg(self, "upsample input");
+      std::vector<int64_t> size;
+      const Value* output_size = args.get(1, "output_size");
+      if (output_size && output_size->kind == Value::Kind::LIST && !output_size->items.empty()) {
+        size = intList(output_size, 2, 0);
+      } else {
+        const auto in       = sizesOf(input);
+        const Value* scales = args.get(2, "scale_factors");
+        double scale[2]     = {0.0, 0.0};
+        if (scales && scales->kind == Value::Kind::LIST && scales->items.size() == 2) {
+          scale[0] = scales->items[0].number();
+          scale[1] = scales->items[1].number();
+        } else {
+          scale[0] = number(args.get(2, "scales_h"), 0.0);
+          scale[1] = number(args.get(3, "scales_w"), 0.0);
+        }
+        if (scale[0] <= 0.0 || scale[1] <= 0.0) {
+          throw LoweringError("upsample_nearest2d needs output_size or scale factors");
+        }
+        size = {static_cast<int64_t>(std::floor(in[2] * scale[0])),
+                static_cast<int64_t>(std::floor(in[3] * scale[1]))};
+      }
+      return Value::tensor(upsampleNearest(input, size, where));
+    }
+    if (op == "reflection_pad2d") {
+      return Value::tensor(pad(tensorArg(self, "pad input"), intList(args.get(1, "padding"), 4, 0),
+                               OpParams::PadMode::REFLECT, 0.0f, where));
+    }
+    if (op == "constant_pad_nd" || op == "pad") {
+      OpParams::PadMode mode = OpParams::PadMode::CONSTANT;
+      float value            = 0.0f;
+      if (op == "pad") {
+        const Value* m = args.get(2, "mode");
+        if (m && m->kind == Value::Kind::STRING && m->s == "reflect") {
+          mode = OpParams::PadMode::REFLECT;
+        } else if (m && m->kind == Value::Kind::STRING && m->s != "constant") {
+          throw LoweringError("pad mode " + m->s + " is not supported");
+        }
+        value = static_cast<float>(number(args.get(3, "value"), 0.0));
+      } else {
+        value = static_cast<float>(number(args.get(2, "value"), 0.0));
+      }
+      return Value::tensor(
+          pad(tensorArg(self, "pad input"), intList(args.get(1, "pad"), 0, 0), mode, value, where));
+    }
+    if (op == "dropout" || op == "feature_dropout" || op == "contiguous" || op == "detach" ||
+        op == "clone") {
+      return *self;
+    }
+    if (op == "size") {
+      const auto in    = sizesOf(tensorArg(self, "size input"));
+      const Value* dim = args.get(1, "dim");
+      if (dim && !dim->isNone()) {
+        return Value::integer(in[normalizeDim(dim->toInt(), in.size())]);
+      }
+      std::vector<Value> items;
+      for (int64_t s : in) {
+        items.push_back(Value::integer(s));
+      }
+      return Value::list(std::move(items));
+    }
+    throw LoweringError("unsupported operator torch." + op);
+  }
+
+  // ---------------------------------------------------------------- leaf modules
+
+  static bool isLeaf(const std::string& type) {
+    static const char* kLeaves[] = {"Conv2d",    "BatchNorm2d",       "ReLU",    "ELU",
+                                    "Sigmoid",   "MaxPool2d",         "Linear",  "Identity",
+                                    "Dropout",   "AdaptiveAvgPool2d", "Flatten", "ReflectionPad2d",
+                                    "Upsample"};
+    std::string name = lastComponent(type);
+    for (const char* leaf : kLeaves) {
+      if (name == leaf) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  Value option(const model::Module& module, const std::string& name) {
+    bool found  = false;
+    Value value = lookup(module, name, &found);
+    return found ? value : Value::none();
+  }
+
+  Value lowerLeaf(const model::Module& module, const std::string& type,
+                  const std::vector<Value>& args) {
+    if (args.size() != 1 || !args[0].isTensor()) {
+      throw LoweringError(type + ".forward expects one tensor");
+    }
+    const std::string name  = lastComponent(type);
+    const std::string where = modules_.path(module);
+    int32_t input           = args[0].slot;
+
+    if (name == "Identity" || name == "Dropout") {
+      return args[0];
+    }
+    if (name == "ReLU" || name == "Sigmoid") {
+      return Value::tensor(emit(name == "ReLU" ? OpKind::RELU : OpKind::SIGMOID, {input},
+                                sizesOf(input), OpParams(), where));
+    }
+    if (name == "ELU") {
+      OpParams params;
+      Value alpha  = option(module, "alpha");
+      params.alpha = alpha.isNone() ? 1.0f : static_cast<float>(alpha.number());
+      return Value::tensor(emit(OpKind::ELU, {input}, sizesOf(input), params, where));
+    }
+    if (name == "Conv2d") {
+      Value weight = option(module, "weight");
+      Value bias   = option(module, "bias");
+      Value mode   = option(module, "padding_mode");
+      OpParams params;
+      std::vector<int64_t> stride   = intList(option(module, "stride"), 2, 1);
+      std::vector<int64_t> padding  = intList(option(module, "padding"), 2, 0);
+      std::vector<int64_t> dilation = intList(option(module, "dilation"), 2, 1);
+      Value groups                  = option(module, "groups");
+      for (int d = 0; d < 2; ++d) {
+        params.stride[d]   = stride[d];
+        params.dilation[d] = dilation[d];
+      }
+      params.groups = groups.isNone() ? 1 : groups.toInt();
+      if (mode.kind == Value::Kind::STRING && mode.s != "zeros") {
+        if (mode.s != "reflect") {
+          throw LoweringError("padding_mode " + mode.s + " is not supported");
+        }
+        input = pad(input, {padding[1], padding[1], padding[0], padding[0]},
+                    OpParams::PadMode::REFLECT, 0.0f, where);
+      } else {
+        params.padding[0] = padding[0];
+        params.padding[1] = padding[1];
+      }
+      return Value::tensor(
+          conv2d(input, tensorArg(&weight, "Conv2d.weight"), &bias, params, where));
+    }
+    if (name == "BatchNorm2d") {
+      Value weight = option(module, "weight");
+      Value bias   = option(module, "bias");
+      Value mean   = option(module, "running_mean");
+      Value var    = option(module, "running_var");
+      Value eps    = option(module, "eps");
+      return Value::tensor(batchNorm(input, &weight, &bias, &mean, &var,
+                                     eps.isNone() ? 1e-5 : eps.number(), where));
+    }
+    if (name == "MaxPool2d") {
+      OpParams params;
+      Value kernel_v                = option(module, "kernel_size");
+      Value stride_v                = option(module, "stride");
+      std::vector<int64_t> kernel   = intList(&kernel_v, 2, 1);
+      std::vector<int64_t> stride   = stride_v.isNone() ? kernel : intList(&stride_v, 2, 1);
+      std::vector<int64_t> padding  = intList(option(module, "padding"), 2, 0);
+      std::vector<int64_t> dilation = intList(option(module, "dilation"), 2, 1);
+      for (int d = 0; d < 2; ++d) {
+        params.kernel[d]   = kernel[d];
+        params.stride[d]   = stride[d];
+        params.padding[d]  = padding[d];
+        params.dilation[d] = dilation[d];
+      }
+      Value ceil       = option(module, "ceil_mode");
+      params.ceil_mode = !ceil.isNone() && ceil.truthy();
+      return Value::tensor(maxPool2d(input, params, where));
+    }
+    if (name == "AdaptiveAvgPool2d") {
+      Value size = option(module, "output_size");
+      return Value::tensor(adaptiveAvgPool2d(input, intList(&size, 2, 1), where));
+    }
+    if (name == "Linear") {
+      Value weight = option(module, "weight");
+      Value bias   = option(module, "bias");
+      return Value::tensor(linear(input, tensorArg(&weight, "Linear.weight"), &bias, false, where));
+    }
+    if (name == "Flatten") {
+      Value start = option(module, "start_dim");
+      Value end   = option(module, "end_dim");
+      Args flatten;
+      flatten.positional = {args[0], start.isNone() ? Value::integer(1) : start,
+                            end.isNone() ? Value::integer(-1) : end};
+      return lowerTorch("flatten", flatten, where);
+    }
+    if (name == "ReflectionPad2d") {
+      return Value::tensor(pad(input, intList(option(module, "padding"), 4, 0),
+                               OpParams::PadMode::REFLECT, 0.0f, where));
+    }
+    if (name == "Upsample") {
+      Value mode = option(module, "mode");
+      if (mode.kind == Value::Kind::STRING && mode.s != "nearest") {
+        throw LoweringError("Upsample mode " + mode.s + " is not supported");
+      }
+      Value size  = option(module, "size");
+      Value scale = option(module, "scale_factor");
+      Args upsample;
+      upsample.positional = {args[0], size, Value::none()};
+      if (scale.isScalar()) {
+        upsample.positional[2] = Value::list({scale, scale});
+      } else {
+        upsample.positional[2] = scale;
+      }
+      return lowerTorch("upsample_nearest2d", upsample, where);
+    }
+    throw LoweringError("no lowering for leaf " + type);
+  }
+
+  // ---------------------------------------------------------------- op builders
+
+  int32_t conv2d(int32_t input, int32_t weight, const Value* bias, OpParams params,
+                 const std::string& where) {
+    const auto in = sizesOf(input);
+    const auto w  = sizesOf(weight);
+    constantData(weight, "conv weight");
+    if (in.size() != 4 || w.size() != 4 || in[1] != w[1] * params.groups) {
+      throw LoweringError("conv2d shape mismatch at '" + where + "'");
+    }
+    params.kernel[0]         = w[2];
+    params.kernel[1]         = w[3];
+    std::vector<int64_t> out = {in[0], w[0], 0, 0};
+    for (int d = 0; d < 2; ++d) {
+      out[2 + d] = (in[2 + d] + 2 * params.padding[d] - params.dilation[d] * (w[2 + d] - 1) - 1) /
+                       params.stride[d] +
+                   1;
+    }
+    std::vector<int32_t> inputs = {input, weight};
+    if (bias && !bias->isNone()) {
+      inputs.push_back(tensorArg(bias, "conv bias"));
+    }
+    return emit(OpKind::CONV2D, inputs, out, params, where);
+  }
+
+  /**
+   * @brief eval 모드 batch norm 은 채널별 y = x * scale + shift 로 미리 접어 둔다
+   */
+  int32_t batchNorm(int32_t input, const Value* weight, const Value* bias, const Value* mean,
+                    const Value* var, double eps, const std::string& where) {
+    const auto in = sizesOf(input);
+    if (in.size() < 2) {
+      throw LoweringError("batch_norm expects NC[HW] input");
+    }
+    int64_t channels = in[1];
+    const float* m   = constantData(tensorArg(mean, "running_mean"), "running_mean");
+    const float* v   = constantData(tensorArg(var, "running_var"), "running_var");
+    const float* w =
+        weight && !weight->isNone() ? constantData(weight->slot, "weight") : nullptr;
+    const float* b = bias && !bias->isNone() ? constantData(bias->slot, "bias") : nullptr;
+    std::vector<float> scale(channels);
+    std::vector<float> shift(channels);
+    for (int64_t c = 0; c < channels; ++c) {
+      float s  = static_cast<float>(1.0 / std::sqrt(static_cast<double>(v[c]) + eps));
+      s        = w ? s * w[c] : s;
+      scale[c] = s;
+      shift[c] = (b ? b[c] : 0.0f) - m[c] * s;
+    }
+    int32_t scale_slot = newConstant(where + ".bn_scale", {channels}, scale);
+    int32_t shift_slot = newConstant(where + ".bn_shift", {channels}, shift);
+    return emit(OpKind::BATCH_NORM, {input, scale_slot, shift_slot}, in, OpParams(), where);
+  }
+
+  int32_t maxPool2d(int32_t input, const OpParams& params, const std::string& where) {
+    const auto in = sizesOf(input);
+    if (in.size() != 4) {
+      throw LoweringError("max_pool2d expects NCHW input");
+    }
+    std::vector<int64_t> out = {in[0], in[1], 0, 0};
+    for (int d = 0; d < 2; ++d) {
+      int64_t span =
+          in[2 + d] + 2 * params.padding[d] - params.dilation[d] * (params.kernel[d] - 1) - 1;
+      int64_t n = (params.ceil_mode ? (span + params.stride[d] - 1) : span) / params.stride[d] + 1;
+      // ceil_mode 에서 마지막 창이 padding 안에서만 시작하면 버린다
+      if (params.ceil_mode && (n - 1) * params.stride[d] >= in[2 + d] + params.padding[d]) {
+        --n;
+      }
+      out[2 + d] = n;
+    }
+    return emit(OpKind::MAX_POOL2D, {input}, out, params, where);
+  }
+
+  int32_t adaptiveAvgPool2d(int32_t input, const std::vector<int64_t>& size,
+                            const std::string& where) {
+    const auto in = sizesOf(input);
+    if (in.size() != 4) {
+      throw LoweringError("adaptive_avg_pool2d expects NCHW input");
+    }
+    return emit(OpKind::ADAPTIVE_AVG_POOL2D, {input}, {in[0], in[1], size[0], size[1]}, OpParams(),
+                where);
+  }
+
+  int32_t linear(int32_t input, int32_t weight, const Value* bias, bool transposed,
+                 const std::string& where) {
+    const auto in     = sizesOf(input);
+    auto w            = sizesOf(weight);
+    const float* data = constantData(weight, "linear weight");
+    if (transposed) {
+      // addmm 의 mat2 는 [in, out] 이므로 [out, in] 으로 되돌린다
+      std::vector<float> values(w[0] * w[1]);
+      for (int64_t r = 0; r < w[0]; ++r) {
+        for (int64_t c = 0; c < w[1]; ++c) {
+          values[c * w[0] + r] = data[r * w[1] + c];
+        }
+      }
+      weight = newConstant(graph_.slots[weight].name + ".t", {w[1], w[0]}, values);
+      w      = sizesOf(weight);
+    }
+    if (w.size() != 2 || in.empty() || in.back() != w[1]) {
+      throw LoweringError("linear shape mismatch at '" + where + "'");
+    }
+    std::vector<int64_t> out    = in;
+    out.back()                  = w[0];
+    std::vector<int32_t> inputs = {input, weight};
+    if (bias && !bias->isNone()) {
+      inputs.push_back(tensorArg(bias, "linear bias"));
+    }
+    return emit(OpKind::LINEAR, inputs, out, OpParams(), where);
+  }
+
+  Value binary(OpKind kind, const Value& lhs, const Value& rhs, double alpha,
+               const std::string& where) {
+    if (lhs.isScalar() && rhs.isScalar()) {
+      double a = lhs.number();
+      double b = rhs.number() * alpha;
+      switch (kind) {
+        case OpKind::ADD:
+          return Value::real(a + b);
+        case OpKind::SUB:
+          return Value::real(a - b);
+        case OpKind::MUL:
+          return Value::real(a * rhs.number());
+        default:
+          return Value::real(a / rhs.number());
+      }
+    }
+    int32_t a = tensorArg(&lhs, opKindToString(kind));
+    OpParams params;
+    params.alpha = static_cast<float>(alpha);
+    if (rhs.isScalar()) {
+      params.has_scalar = true;
+      params.scalar     = static_cast<float>(rhs.number());
+      return Value::tensor(emit(kind, {a}, sizesOf(a), params, where));
+    }
+    int32_t b = tensorArg(&rhs, opKindToString(kind));
+    return Value::tensor(emit(kind, {a, b}, broadcast(sizesOf(a), sizesOf(b)), params, where));
+  }
+
+  static std::vector<int64_t> broadcast(const std::vector<int64_t>& a,
+                                        const std::vector<int64_t>& b) {
+    std::vector<int64_t> out(std::max(a.size(), b.size()), 1);
+    if (out.size() > kernels::kMaxRank) {
+      throw LoweringError("broadcast rank above " + std::to_string(kernels::kMaxRank));
+    }
+    for (size_t i = 0; i < out.size(); ++i) {
+      int64_t da = i < a.size() ? a[a.size() - 1 - i] : 1;
+      int64_t db = i < b.size() ? b[b.size() - 1 - i] : 1;
+      if (da != db && da != 1 && db != 1) {
+        throw LoweringError("shapes do not broadcast");
+      }
+      out[out.size() - 1 - i] = std::max(da, db);
+    }
+    return out;
+  }
+
+  int32_t cat(const std::vector<int32_t>& inputs, int64_t dim, const std::string& where) {
+    std::vector<int64_t> out = sizesOf(inputs[0]);
+    int64_t axis             = normalizeDim(dim, out.size());
+    for (size_t i = 1; i < inputs.size(); ++i) {
+      const auto in = sizesOf(inputs[i]);
+      if (in.size() != out.size()) {
+        throw LoweringError("cat rank mismatch");
+      }
+      for (size_t d = 0; d < in.size(); ++d) {
+        if (static_cast<int64_t>(d) != axis && in[d] != out[d]) {
+          throw LoweringError("cat shape mismatch");
+        }
+      }
+      out[axis] += in[axis];
+    }
+    OpParams params;
+    params.axis = axis;
+    return emit(OpKind::CAT, inputs, out, params, where);
+  }
+
+  int32_t upsampleNearest(int32_t input, const std::vector<int64_t>& size,
+                          const std::string& where) {
+    const auto in = sizesOf(input);
+    if (in.size() != 4) {
+      throw LoweringError("upsample_nearest2d expects NCHW input");
+    }
+    return emit(OpKind::UPSAMPLE_NEAREST2D, {input}, {in[0], in[1], size[0], size[1]}, OpParams(),
+                where);
+  }
+
+  int32_t pad(int32_t input, const std::vector<int64_t>& pads, OpParams::PadMode mode, float value,
+              const std::string& where) {
+    const auto in = sizesOf(input);
+    if (in.size() != 4 || (pads.size() != 2 && pads.size() != 4)) {
+      throw LoweringError("pad expects NCHW input and 2 or 4 pads");
+    }
+    OpParams params;
+    params.pad_mode = mode;
+    params.value    = value;
+    for (size_t i = 0; i < pads.size(); ++i) {
+      params.pads[i] = pads[i];
+    }
+    if (mode == OpParams::PadMode::REFLECT &&
+        (params.pads[0] >= in[3] || params.pads[1] >= in[3] || params.pads[2] >= in[2] ||
+         params.pads[3] >= in[2])) {
+      throw LoweringError("reflection pad larger than the input");
+    }
+    std::vector<int64_t> out = {in[0], in[1], in[2] + params.pads[2] + params.pads[3],
+                                in[3] + params.pads[0] + params.pads[1]};
+    return emit(OpKind::PAD, {input}, out, params, where);
+  }
+
+  int32_t reshape(int32_t input, const std::vector<int64_t>& sizes, const std::string& where) {
+    int64_t numel = 1;
+    for (int64_t s : sizes) {
+      numel *= s;
+    }
+    if (numel != graph_.slots[input].numel()) {
+      throw LoweringError("reshape changes the element count");
+    }
+    return emit(OpKind::RESHAPE, {input}, sizes, OpParams(), where);
+  }
+
+  const model::ScriptModel& model_;
+  const model::ModuleGraph& modules_;
+  Graph& graph_;
+  ScriptSource source_;
+  std::unordered_map<const tensor::Tensor*, int32_t> constants_;
+};
+
+}  // namespace
+
+Graph lower(const model::ScriptModel& model,
+            const std::vector<std::vector<int64_t>>& input_shapes) {
+  Graph graph;
+  Interpreter interpreter(model, graph);
+  interpreter.run(input_shapes);
+  return graph;
+}
+
+}  // namespace engine
+}  // namespace tfe
@@ -0,0 +1,661 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "engine/kernels.h"
+#include "engine/lowering.h"
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+// schema.fbs 의 builtin_options 필드 id
+constexpr uint16_t kConvPadding    = 0;
+constexpr uint16_t kConvStrideW    = 1;
+constexpr uint16_t kConvStrideH    = 2;
+constexpr uint16_t kConvActivation = 3;
+constexpr uint16_t kConvDilationW  = 4;
+constexpr uint16_t kConvDilationH  = 5;
+
+constexpr uint16_t kDepthwiseActivation = 4;
+constexpr uint16_t kDepthwiseDilationW  = 5;
+constexpr uint16_t kDepthwiseDilationH  = 6;
+
+constexpr uint16_t kPoolPadding    = 0;
+constexpr uint16_t kPoolStrideW    = 1;
+constexpr uint16_t kPoolStrideH    = 2;
+constexpr uint16_t kPoolFilterW    = 3;
+constexpr uint16_t kPoolFilterH    = 4;
+constexpr uint16_t kPoolActivation = 5;
+
+constexpr uint16_t kFullyConnectedActivation = 0;
+constexpr uint16_t kFullyConnectedKeepDims   = 2;
+
+constexpr uint16_t kConcatAxis         = 0;
+constexpr uint16_t kConcatActivation   = 1;
+constexpr uint16_t kBinaryActivation   = 0;  // Add / Sub / Mul / DivOptions
+constexpr uint16_t kReshapeNewShape    = 0;
+constexpr uint16_t kReducerKeepDims    = 0;
+constexpr uint16_t kResizeAlignCorners = 0;
+constexpr uint16_t kResizeHalfPixel    = 1;
+
+constexpr int8_t kPaddingSame = 0;
+
+// ActivationFunctionType
+constexpr int8_t kActivationNone = 0;
+constexpr int8_t kActivationRelu = 1;
+
+using parser::TFLiteOperator;
+using parser::TFLiteTensor;
+using parser::TFLiteType;
+
+/**
+ * @brief NHWC 축 -> NCHW 축
+ */
+int64_t nchwAxis(int64_t axis) {
+  static constexpr int64_t kAxes[4] = {0, 2, 3, 1};
+  return kAxes[axis];
+}
+
+std::vector<int64_t> toNCHW(std::vector<int64_t> sizes) {
+  if (sizes.size() == 4) {
+    sizes = {sizes[0], sizes[3], sizes[1], sizes[2]};
+  }
+  return sizes;
+}
+
+/**
+ * @brief SAME padding 의 앞 / 뒤 칸. 전체가 홀수면 뒤쪽이 한 칸 더 많다 (TFLite 규칙)
+ */
+std::pair<int64_t, int64_t> samePadding(int64_t in, int64_t kernel, int64_t stride,
+                                        int64_t dilation) {
+  const int64_t out   = (in + stride - 1) / stride;
+  const int64_t span  = (kernel - 1) * dilation + 1;
+  const int64_t total = std::max<int64_t>((out - 1) * stride + span - in, 0);
+  return {total / 2, total - total / 2};
+}
+
+class TFLiteLowering {
+ public:
+  TFLiteLowering(const parser::TFLiteParser& model, Graph& graph)
+      : model_(model), subgraph_(model.subgraphs().front()), graph_(graph) {
+    slots_.assign(subgraph_.tensors.size(), -1);
+  }
+
+  void run(const std::vector<std::vector<int64_t>>& input_shapes) {
+    if (!input_shapes.empty() && input_shapes.size() != subgraph_.inputs.size()) {
+      throw LoweringError("tflite model has " + std::to_string(subgraph_.inputs.size()) +
+                          " inputs but " + std::to_string(input_shapes.size()) + " shapes given");
+    }
+    for (uint32_t i = 0; i < subgraph_.inputs.size(); ++i) {
+      const int32_t t = subgraph_.inputs[i];
+      checkFloat(t);
+      std::vector<int64_t> sizes = input_shapes.empty() ? toNCHW(fileShape(t)) : input_shapes[i];
+      slots_[t]                  = graph_.addSlot(name(t), std::move(sizes));
+      graph_.inputs.push_back(slots_[t]);
+    }
+    for (const TFLiteOperator& op : subgraph_.operators) {
+      if (op.outputs.size() != 1) {
+        throw LoweringError("tflite op " + std::to_string(op.builtin) + " has " +
+                            std::to_string(op.outputs.size()) + " outputs");
+      }
+      slots_[op.outputs[0]] = lowerOp(op, name(op.outputs[0]));
+    }
+    for (uint32_t i = 0; i < subgraph_.outputs.size(); ++i) {
+      graph_.outputs.push_back(slot(subgraph_.outputs[i]));
+    }
+    graph_.eliminateDeadOps();
+  }
+
+ private:
+  int32_t lowerOp(const TFLiteOperator& op, const std::string& where) {
+    const parser::FlatTable& options = op.options;
+    switch (op.builtin) {
+      case parser::kTFLiteConv2d:
+        return activation(conv2d(op, false, where),
+                          options.scalar<int8_t>(kConvActivation, kActivationNone), where);
+      case parser::kTFLiteDepthwiseConv2d:
+        return activation(conv2d(op, true, where),
+                          options.scalar<int8_t>(kDepthwiseActivation, kActivationNone), where);
+      case parser::kTFLiteFullyConnected:
+        return activation(fullyConnected(op, where),
+                          options.scalar<int8_t>(kFullyConnectedActivation, kActivationNone),
+                          where);
+      case parser::kTFLiteMaxPool2d:
+      case parser::kTFLiteAveragePool2d:
+        return activation(pool2d(op, where),
+                          options.scalar<int8_t>(kPoolActivation, kActivationNone), where);
+      case parser::kTFLiteAdd:
+        return activation(binary(OpKind::ADD, op, where),
+                          options.scalar<int8_t>(kBinaryActivation, kActivationNone), where);
+      case parser::kTFLiteSub:
+        return activation(binary(OpKind::SUB, op, where),
+                          options.scalar<int8_t>(kBinaryActivation, kActivationNone), where);
+      case parser::kTFLiteMul:
+        return activation(binary(OpKind::MUL, op, where),
+                          options.scalar<int8_t>(kBinaryActivation, kActivationNone), where);
+      case parser::kTFLiteDiv:
+        return activation(binary(OpKind::DIV, op, where),
+                          options.scalar<int8_t>(kBinaryActivation, kActivationNone), where);
+      case parser::kTFLiteConcatenation:
+        return activation(concatenation(op, where),
+                          options.scalar<int8_t>(kConcatActivation, kActivationNone), where);
+      case parser::kTFLiteRelu:
+      case parser::kTFLiteLogistic:
+      case parser::kTFLiteElu: {
+        const int32_t input = slot(op.inputs[0]);
+        const OpKind kind   = op.builtin == parser::kTFLiteRelu       ? OpKind::RELU
+                              : op.builtin == parser::kTFLiteLogistic ? OpKind::SIGMOID
+                                                                      : OpKind::ELU;
+        return emit(kind, {input}, sizesOf(input), OpParams(), where);
+      }
+      case parser::kTFLiteReshape:
+        return reshape(op, where);
+      case parser::kTFLitePad:
+        return pad(op, where);
+      case parser::kTFLiteMean:
+        return mean(op, where);
+      case parser::kTFLiteResizeNearestNeighbor:
+        return resizeNearest(op, where);
+    }
+    if (!op.custom_code.empty()) {
+      throw LoweringError("tflite custom op " + std::string(op.custom_code) + " is not supported");
+    }
+    throw LoweringError("tflite builtin op " + std::to_string(op.builtin) + " is not supported");
+  }
+
+  // ---------------------------------------------------------------- tensors
+
+  std::string name(int32_t t) const {
+    const TFLiteTensor& tensor = subgraph_.tensors[t];
+    return tensor.name.empty() ? "t" + std::to_string(t) : std::string(tensor.name);
+  }
+
+  std::vector<int64_t> fileShape(int32_t t) const {
+    const TFLiteTensor& tensor = subgraph_.tensors[t];
+    std::vector<int64_t> shape(tensor.shape.size());
+    for (uint32_t d = 0; d < tensor.shape.size(); ++d) {
+      shape[d] = tensor.shape[d];
+    }
+    return shape;
+  }
+
+  void checkFloat(int32_t t) const {
+    const TFLiteTensor& tensor = subgraph_.tensors[t];
+    if (tensor.type != TFLiteType::FLOAT32 || tensor.quantized) {
+      throw LoweringError("tflite tensor " + name(t) + " is " +
+                          (tensor.quantized ? "quantized " : "") +
+                          parser::tfliteTypeToString(tensor.type) + ", only float32 is supported");
+    }
+  }
+
+  bool isConstant(int32_t t) const {
+    return slots_[t] < 0 && !model_.buffer(subgraph_.tensors[t].buffer).empty();
+  }
+
+  /**
+   * @brief 상수 텐서를 파일 순서 그대로 매핑 위에 얹은 연속 view. 복사하지 않는다
+   */
+  tensor::Tensor mapped(int32_t t) const {
+    checkFloat(t);
+    const std::vector<int64_t> shape = fileShape(t);
+    int64_t numel                    = 1;
+    for (int64_t s : shape) {
+      numel *= s;
+    }
+    const std::string_view bytes = model_.buffer(subgraph_.tensors[t].buffer);
+    if (bytes.size() != static_cast<size_t>(numel) * sizeof(float)) {
+      throw LoweringError("tflite tensor " + name(t) + " buffer size does not match its shape");
+    }
+    auto storage = std::make_shared<tensor::Storage>(name(t), tensor::DType::FLOAT32, numel, "cpu");
+    if (reinterpret_cast<uintptr_t>(bytes.data()) % alignof(float) == 0) {
+      storage->adopt(bytes.data(), model_.mapping());
+    } else {
+      // flatbuffer 는 buffer 를 16 byte 에 맞추지만 손으로 만든 파일은 아닐 수 있다
+      storage->materialize([&](char* dst) { std::memcpy(dst, bytes.data(), bytes.size()); });
+    }
+    return tensor::Tensor(storage, 0, shape, tensor::contiguousStrides(shape));
+  }
+
+  /**
+   * @brief 파일 순서 shape 로 읽은 상수를 축을 바꿔 (sizes[d] 는 shape[perm[d]]) 본 slot. 바꾼 배치가
+   *        그대로 연속이면 매핑 view 로 두고, 아니면 한 번 연속으로 옮긴다
+   */
+  int32_t permutedConstant(int32_t t, const std::vector<int64_t>& shape,
+                           const std::vector<int64_t>& sizes, const std::vector<int64_t>& perm) {
+    const std::vector<int64_t> file_strides = tensor::contiguousStrides(shape);
+    std::vector<int64_t> strides(perm.size());
+    for (size_t d = 0; d < perm.size(); ++d) {
+      strides[d] = file_strides[perm[d]];
+    }
+    tensor::Tensor permuted(mapped(t).storage(), 0, sizes, strides);
+    return graph_.addConstant(name(t), tensor::contiguous(permuted));
+  }
+
+  /**
+   * @brief 텐서 index 의 slot. 상수는 처음 쓸 때 만든다 (4 차원은 NHWC -> NCHW)
+   */
+  int32_t slot(int32_t t) {
+    if (t < 0) {
+      throw LoweringError("required tflite input is missing");
+    }
+    if (slots_[t] >= 0) {
+      return slots_[t];
+    }
+    if (!isConstant(t)) {
+      throw LoweringError("tflite tensor " + name(t) + " is used before it is produced");
+    }
+    const std::vector<int64_t> shape = fileShape(t);
+    slots_[t] = shape.size() == 4 ? permutedConstant(t, shape, toNCHW(shape), {0, 3, 1, 2})
+                                  : graph_.addConstant(name(t), mapped(t));
+    return slots_[t];
+  }
+
+  /**
+   * @brief 정수 상수 (shape, axis, padding). 작은 텐서라 값으로 읽는다
+   */
+  std::vector<int64_t> intConstant(int32_t t) const {
+    const TFLiteTensor& tensor   = subgraph_.tensors[t];
+    const std::string_view bytes = model_.buffer(tensor.buffer);
+    const size_t width           = tensor.type == TFLiteType::INT32   ? 4
+                                   : tensor.type == TFLiteType::INT64 ? 8
+                                                                      : 0;
+    if (width == 0 || slots_[t] >= 0 || bytes.size() % width != 0) {
+      throw LoweringError("tflite tensor " + name(t) + " must be an int32 / int64 constant");
+    }
+    std::vector<int64_t> values(bytes.size() / width);
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (width == 4) {
+        int32_t v;
+        std::memcpy(&v, bytes.data() + i * 4, 4);
+        values[i] = v;
+      } else {
+        std::memcpy(&values[i], bytes.data() + i * 8, 8);
+      }
+    }
+    return values;
+  }
+
+  std::vector<int64_t> sizesOf(int32_t slot) const { return graph_.slots[slot].sizes; }
+
+  int32_t emit(OpKind kind, std::vector<int32_t> inputs, std::vector<int64_t> sizes,
+               const OpParams& params, const std::string& where) {
+    int32_t output = graph_.addSlot(where + "/" + opKindToString(kind), std::move(sizes));
+    Op& op         = graph_.addOp(kind, std::move(inputs), output, where);
+    op.params      = params;
+    return output;
+  }
+
+  // ---------------------------------------------------------------- ops
+
+  /**
+   * @brief fused_activation_function. RELU 는 따로 op 로 두고 fuseOps() 가 conv 에 접는다
+   */
+  int32_t activation(int32_t input, int8_t function, const std::string& where) {
+    if (function == kActivationNone) {
+      return input;
+    }
+    if (function != kActivationRelu) {
+      throw LoweringError("tflite fused activation " + std::to_string(function) + " at '" + where +
+                          "' is not supported");
+    }
+    return emit(OpKind::RELU, {input}, sizesOf(input), OpParams(), where);
+  }
+
+  /**
+   * @brief SAME 이 앞뒤로 다르게 채우면 (짝수 kernel, stride 2 ...) PAD 를 앞에 두고 padding 0 으로
+   *        돌린다. 채우는 값은 conv 가 0, max pool 이 -inf
+   */
+  int32_t padSame(int32_t input, bool same, OpParams& params, float fill,
+                  const std::string& where) {
+    if (!same) {
+      return input;
+    }
+    const auto in = sizesOf(input);
+    std::pair<int64_t, int64_t> pads[2];
+    for (int d = 0; d < 2; ++d) {
+      pads[d] = samePadding(in[2 + d], params.kernel[d], params.stride[d], params.dilation[d]);
+    }
+    if (pads[0].first == pads[0].second && pads[1].first == pads[1].second) {
+      params.padding[0] = pads[0].first;
+      params.padding[1] = pads[1].first;
+      return input;
+    }
+    OpParams pad;
+    pad.value   = fill;
+    pad.pads[0] = pads[1].first;
+    pad.pads[1] = pads[1].second;
+    pad.pads[2] = pads[0].first;
+    pad.pads[3] = pads[0].second;
+    return emit(OpKind::PAD, {input},
+                {in[0], in[1], in[2] + pads[0].first + pads[0].second,
+                 in[3] + pads[1].first + pads[1].second},
+                pad, where);
+  }
+
+  static std::vector<int64_t> windowOutput(const std::vector<int64_t>& in, int64_t channels,
+                                           const OpParams& params) {
+    std::vector<int64_t> out = {in[0], channels, 0, 0};
+    for (int d = 0; d < 2; ++d) {
+      out[2 + d] = (in[2 + d] + 2 * params.padding[d] -
+                    params.dilation[d] * (params.kernel[d] - 1) - 1) /
+                       params.stride[d] +
+                   1;
+    }
+    return out;
+  }
+
+  /**
+   * @brief CONV_2D 의 weight 는 OHWI, DEPTHWISE_CONV_2D 는 [1, KH, KW, C * multiplier] 다. 둘 다
+   *        OIHW 로 옮겨 둔다 (ConvKernel 이 어차피 다시 묶으므로 복사는 한 번 더 느는 것뿐이다)
+   */
+  int32_t conv2d(const TFLiteOperator& op, bool depthwise, const std::string& where) {
+    int32_t input = slot(op.inputs[0]);
+    const auto in = sizesOf(input);
+    const auto w  = fileShape(op.inputs[1]);
+    if (in.size() != 4 || w.size() != 4 || !isConstant(op.inputs[1])) {
+      throw LoweringError("conv2d at '" + where + "' expects NHWC input and constant weight");
+    }
+    const parser::FlatTable& options = op.options;
+    OpParams params;
+    const uint16_t dilation_h = depthwise ? kDepthwiseDilationH : kConvDilationH;
+    const uint16_t dilation_w = depthwise ? kDepthwiseDilationW : kConvDilationW;
+    params.stride[0]          = options.scalar<int32_t>(kConvStrideH, 1);
+    params.stride[1]          = options.scalar<int32_t>(kConvStrideW, 1);
+    params.dilation[0]        = options.scalar<int32_t>(dilation_h, 1);
+    params.dilation[1]        = options.scalar<int32_t>(dilation_w, 1);
+    params.kernel[0]          = w[1];
+    params.kernel[1]          = w[2];
+
+    int32_t weight;
+    int64_t channels;
+    if (depthwise) {
+      channels      = w[3];
+      params.groups = in[1];
+      weight        = permutedConstant(op.inputs[1], w, {w[3], 1, w[1], w[2]}, {3, 0, 1, 2});
+    } else {
+      channels      = w[0];
+      params.groups = w[3] > 0 ? in[1] / w[3] : 0;
+      weight        = permutedConstant(op.inputs[1], w, {w[0], w[3], w[1], w[2]}, {0, 3, 1, 2});
+    }
+    if (params.groups <= 0 || in[1] != (depthwise ? 1 : w[3]) * params.groups ||
+        channels % params.groups != 0) {
+      throw LoweringError("conv2d shape mismatch at '" + where + "'");
+    }
+
+    const bool same = options.scalar<int8_t>(kConvPadding, kPaddingSame) == kPaddingSame;
+    input           = padSame(input, same, params, 0.0f, where);
+    std::vector<int32_t> inputs = {input, weight};
+    if (op.inputs.size() > 2 && op.inputs[2] >= 0) {
+      inputs.push_back(slot(op.inputs[2]));
+    }
+    return emit(OpKind::CONV2D, inputs, windowOutput(sizesOf(input), channels, params), params,
+                where);
+  }
+
+  int32_t pool2d(const TFLiteOperator& op, const std::string& where) {
+    int32_t input = slot(op.inputs[0]);
+    const auto in = sizesOf(input);
+    if (in.size() != 4) {
+      throw LoweringError("pool2d at '" + where + "' expects NHWC input");
+    }
+    const parser::FlatTable& options = op.options;
+    OpParams params;
+    params.kernel[0] = options.scalar<int32_t>(kPoolFilterH, 1);
+    params.kernel[1] = options.scalar<int32_t>(kPoolFilterW, 1);
+    params.stride[0] = options.scalar<int32_t>(kPoolStrideH, 1);
+    params.stride[1] = options.scalar<int32_t>(kPoolStrideW, 1);
+    const bool same  = options.scalar<int8_t>(kPoolPadding, kPaddingSame) == kPaddingSame;
+
+    if (op.builtin == parser::kTFLiteAveragePool2d) {
+      // 평균 pool 은 전체 창 하나 (global average pooling) 만 있다
+      if (params.kernel[0] != in[2] || params.kernel[1] != in[3] || (same && in[2] * in[3] > 1)) {
+        throw LoweringError("average_pool_2d at '" + where +
+                            "' is only supported as a global pool");
+      }
+      return emit(OpKind::ADAPTIVE_AVG_POOL2D, {input}, {in[0], in[1], 1, 1}, OpParams(), where);
+    }
+    input = padSame(input, same, params, -std::numeric_limits<float>::infinity(), where);
+    return emit(OpKind::MAX_POOL2D, {input}, windowOutput(sizesOf(input), in[1], params), params,
+                where);
+  }
+
+  /**
+   * @brief FULLY_CONNECTED 의 weight 는 이미 [out, in] 이라 view 그대로 쓴다. 입력은 마지막 축이
+   *        in 이 되도록 2 차원으로 편다 (4 차원은 NHWC 와 NCHW 의 편 순서가 같은 H = W = 1 만)
+   */
+  int32_t fullyConnected(const TFLiteOperator& op, const std::string& where) {
+    int32_t input = slot(op.inputs[0]);
+    auto in       = sizesOf(input);
+    if (!isConstant(op.inputs[1])) {
+      throw LoweringError("fully_connected at '" + where + "' expects a constant weight");
+    }
+    const int32_t weight = slot(op.inputs[1]);
+    const auto w         = sizesOf(weight);
+    int64_t numel        = 1;
+    for (int64_t s : in) {
+      numel *= s;
+    }
+    if (w.size() != 2 || w[1] <= 0 || numel % w[1] != 0 ||
+        (in.size() == 4 && in[2] * in[3] != 1)) {
+      throw LoweringError("fully_connected shape mismatch at '" + where + "'");
+    }
+    const bool keep_dims = op.options.scalar<uint8_t>(kFullyConnectedKeepDims, 0) != 0;
+    if (!(keep_dims && in.size() != 4 && in.back() == w[1]) && in.size() != 2) {
+      in    = {numel / w[1], w[1]};
+      input = emit(OpKind::RESHAPE, {input}, in, OpParams(), where);
+    }
+    std::vector<int32_t> inputs = {input, weight};
+    if (op.inputs.size() > 2 && op.inputs[2] >= 0) {
+      inputs.push_back(slot(op.inputs[2]));
+    }
+    std::vector<int64_t> out = in;
+    out.back()               = w[0];
+    return emit(OpKind::LINEAR, inputs, out, OpParams(), where);
+  }
+
+  /**
+   * @brief 4 차원 활성값과 짝지은 낮은 차원 상수 (e.g. 채널별 [C]) 는 NHWC 기준으로 앞을 1 로 채워
+   *        NCHW 로 옮긴다. 원소 하나짜리 상수는 스칼라로 접는다
+   */
+  int32_t binary(OpKind kind, const TFLiteOperator& op, const std::string& where) {
+    int32_t operands[2];
+    int64_t rank = 0;
+    for (int i = 0; i < 2; ++i) {
+      if (!isConstant(op.inputs[i])) {
+        operands[i] = slot(op.inputs[i]);
+        rank        = std::max<int64_t>(rank, sizesOf(operands[i]).size());
+      }
+    }
+    OpParams params;
+    for (int i = 0; i < 2; ++i) {
+      const int32_t t = op.inputs[i];
+      if (!isConstant(t)) {
+        continue;
+      }
+      std::vector<int64_t> shape = fileShape(t);
+      int64_t numel              = 1;
+      for (int64_t s : shape) {
+        numel *= s;
+      }
+      if (numel == 1 && i == 1) {
+        params.has_scalar = true;
+        params.scalar     = mapped(t).data<float>()[0];
+        operands[1]       = -1;
+        continue;
+      }
+      if (rank == 4 && shape.size() < 4) {
+        shape.insert(shape.begin(), 4 - shape.size(), 1);
+        operands[i] = permutedConstant(t, shape, toNCHW(shape), {0, 3, 1, 2});
+      } else {
+        operands[i] = slot(t);
+      }
+    }
+    if (params.has_scalar) {
+      return emit(kind, {operands[0]}, sizesOf(operands[0]), params, where);
+    }
+    const auto a = sizesOf(operands[0]);
+    const auto b = sizesOf(operands[1]);
+    std::vector<int64_t> out(std::max(a.size(), b.size()), 1);
+    if (out.size() > kernels::kMaxRank) {
+      throw LoweringError("broadcast rank above " + std::to_string(kernels::kMaxRank));
+    }
+    for (size_t i = 0; i < out.size(); ++i) {
+      const int64_t da = i < a.size() ? a[a.size() - 1 - i] : 1;
+      const int64_t db = i < b.size() ? b[b.size() - 1 - i] : 1;
+      if (da != db && da != 1 && db != 1) {
+        throw LoweringError("shapes do not broadcast at '" + where + "'");
+      }
+      out[out.size() - 1 - i] = std::max(da, db);
+    }
+    return emit(kind, {operands[0], operands[1]}, out, params, where);
+  }
+
+  int32_t concatenation(const TFLiteOperator& op, const std::string& where) {
+    std::vector<int32_t> inputs;
+    for (uint32_t i = 0; i < op.inputs.size(); ++i) {
+      inputs.push_back(slot(op.inputs[i]));
+    }
+    std::vector<int64_t> out = sizesOf(inputs[0]);
+    const int64_t rank       = static_cast<int64_t>(out.size());
+    int64_t axis             = op.options.scalar<int32_t>(kConcatAxis, 0);
+    if (axis < -rank || axis >= rank) {
+      throw LoweringError("concatenation axis out of range at '" + where + "'");
+    }
+    axis = axis < 0 ? axis + rank : axis;
+    axis = rank == 4 ? nchwAxis(axis) : axis;
+    for (size_t i = 1; i < inputs.size(); ++i) {
+      const auto in = sizesOf(inputs[i]);
+      for (size_t d = 0; d < in.size() && in.size() == out.size(); ++d) {
+        if (static_cast<int64_t>(d) != axis && in[d] != out[d]) {
+          throw LoweringError("concatenation shape mismatch at '" + where + "'");
+        }
+      }
+      if (in.size() != out.size()) {
+        throw LoweringError("concatenation rank mismatch at '" + where + "'");
+      }
+      out[axis] += in[axis];
+    }
+    OpParams params;
+    params.axis = axis;
+    return emit(OpKind::CAT, inputs, out, params, where);
+  }
+
+  /**
+   * @brief NHWC 와 NCHW 는 펴는 순서가 달라서 H * W > 1 인 4 차원 쪽이 있으면 lowering 하지 않는다
+   */
+  int32_t reshape(const TFLiteOperator& op, const std::string& where) {
+    const int32_t input = slot(op.inputs[0]);
+    const auto in       = sizesOf(input);
+    std::vector<int64_t> shape;
+    const parser::FlatVector<int32_t> new_shape = op.options.vector<int32_t>(kReshapeNewShape);
+    if (op.inputs.size() > 1 && op.inputs[1] >= 0) {
+      shape = intConstant(op.inputs[1]);
+    } else if (!new_shape.empty()) {
+      for (uint32_t i = 0; i < new_shape.size(); ++i) {
+        shape.push_back(new_shape[i]);
+      }
+    } else {
+      shape = fileShape(op.outputs[0]);
+    }
+    int64_t numel = 1, known = 1;
+    for (int64_t s : in) {
+      numel *= s;
+    }
+    for (int64_t s : shape) {
+      known *= s < 0 ? 1 : s;
+    }
+    for (int64_t& s : shape) {
+      s = s < 0 && known > 0 ? numel / known : s;
+    }
+    const bool spatial_in  = in.size() == 4 && in[2] * in[3] != 1;
+    const bool spatial_out = shape.size() == 4 && shape[1] * shape[2] != 1;
+    if ((spatial_in || spatial_out) && !(in.size() == 4 && toNCHW(shape) == in)) {
+      throw LoweringError("reshape at '" + where + "' crosses the NHWC layout");
+    }
+    shape = toNCHW(shape);
+    int64_t count = 1;
+    for (int64_t s : shape) {
+      count *= s;
+    }
+    if (count != numel) {
+      throw LoweringError("reshape changes the element count at '" + where + "'");
+    }
+    return emit(OpKind::RESHAPE, {input}, shape, OpParams(), where);
+  }
+
+  int32_t pad(const TFLiteOperator& op, const std::string& where) {
+    const int32_t input             = slot(op.inputs[0]);
+    const auto in                   = sizesOf(input);
+    const std::vector<int64_t> pads = intConstant(op.inputs[1]);  // NHWC 축마다 (앞, 뒤)
+    if (in.size() != 4 || pads.size() != 8 || pads[0] || pads[1] || pads[6] || pads[7]) {
+      throw LoweringError("pad at '" + where + "' only pads H and W of NHWC input");
+    }
+    OpParams params;
+    params.pads[0] = pads[4];
+    params.pads[1] = pads[5];
+    params.pads[2] = pads[2];
+    params.pads[3] = pads[3];
+    const int64_t height = in[2] + pads[2] + pads[3];
+    const int64_t width  = in[3] + pads[4] + pads[5];
+    return emit(OpKind::PAD, {input}, {in[0], in[1], height, width}, params, where);
+  }
+
+  /**
+   * @brief H, W 에 대한 MEAN 은 global average pooling 이다
+   */
+  int32_t mean(const TFLiteOperator& op, const std::string& where) {
+    const int32_t input       = slot(op.inputs[0]);
+    const auto in             = sizesOf(input);
+    std::vector<int64_t> axes = intConstant(op.inputs[1]);
+    for (int64_t& axis : axes) {
+      axis = axis < 0 ? axis + 4 : axis;
+    }
+    std::sort(axes.begin(), axes.end());
+    if (in.size() != 4 || axes != std::vector<int64_t>{1, 2}) {
+      throw LoweringError("mean at '" + where + "' is only supported over H and W");
+    }
+    const int32_t pooled =
+        emit(OpKind::ADAPTIVE_AVG_POOL2D, {input}, {in[0], in[1], 1, 1}, OpParams(), where);
+    if (op.options.scalar<uint8_t>(kReducerKeepDims, 0) != 0) {
+      return pooled;
+    }
+    return emit(OpKind::RESHAPE, {pooled}, {in[0], in[1]}, OpParams(), where);
+  }
+
+  int32_t resizeNearest(const TFLiteOperator& op, const std::string& where) {
+    const int32_t input             = slot(op.inputs[0]);
+    const auto in                   = sizesOf(input);
+    const std::vector<int64_t> size = intConstant(op.inputs[1]);
+    if (in.size() != 4 || size.size() != 2 ||
+        op.options.scalar<uint8_t>(kResizeAlignCorners, 0) != 0 ||
+        op.options.scalar<uint8_t>(kResizeHalfPixel, 0) != 0) {
+      throw LoweringError("resize_nearest_neighbor at '" + where +
+                          "' supports only align_corners = half_pixel_centers = false");
+    }
+    return emit(OpKind::UPSAMPLE_NEAREST2D, {input}, {in[0], in[1], size[0], size[1]}, OpParams(),
+                where);
+  }
+
+  const parser::TFLiteParser& model_;
+  const parser::TFLiteSubgraph& subgraph_;
+  Graph& graph_;
+  std::vector<int32_t> slots_;  // 텐서 index -> slot. 아직 없으면 -1
+};
+
+}  // namespace
+
+Graph lower(const parser::TFLiteParser& model,
+            const std::vector<std::vector<int64_t>>& input_shapes) {
+  Graph graph;
+  TFLiteLowering lowering(model, graph);
+  lowering.run(input_shapes);
+  return graph;
+}
+
+}  // namespace engine
+}  // namespace tfe
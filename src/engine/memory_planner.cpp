@@ -0,0 +1,150 @@
+#include "engine/memory_planner.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "tensor/tensor.h"
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+constexpr size_t kAlignment = tensor::AlignedBuffer::kAlignment;
+
+struct Interval {
+  int32_t slot;
+  int64_t first;  // 정의하는 op 의 시각 (그래프 입력은 -1)
+  int64_t last;   // 마지막으로 읽는 op 의 시각 (그래프 출력은 마지막 op 다음)
+  size_t bytes;
+  int64_t offset = -1;
+};
+
+size_t alignUp(size_t n) { return (n + kAlignment - 1) & ~(kAlignment - 1); }
+
+std::string megabytes(size_t bytes) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.1f MB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+  return buf;
+}
+
+}  // namespace
+
+std::string MemoryPlan::summary() const {
+  size_t count = 0;
+  for (int64_t offset : offsets) {
+    count += offset >= 0;
+  }
+  int percent = naive_bytes ? static_cast<int>(100.0 * arena_bytes / naive_bytes + 0.5) : 0;
+  return "arena " + megabytes(arena_bytes) + " for " + std::to_string(count) +
+         " activations (naive " + megabytes(naive_bytes) + ", " + std::to_string(percent) + "%)";
+}
+
+MemoryPlan planMemory(const Graph& graph, const std::vector<int64_t>& steps) {
+  const size_t num_slots = graph.slots.size();
+
+  // ops[i] 가 도는 시각과 그래프 출력을 읽는 시각 (마지막 op 다음)
+  auto step   = [&](size_t i) { return steps.empty() ? static_cast<int64_t>(i) : steps[i]; };
+  int64_t end = 0;
+  for (size_t i = 0; i < graph.ops.size(); ++i) {
+    end = std::max(end, step(i) + 1);
+  }
+
+  // RESHAPE 출력은 입력 slot 의 별칭. root 가 자리를 대표한다
+  std::vector<int32_t> root(num_slots);
+  for (size_t i = 0; i < num_slots; ++i) {
+    root[i] = static_cast<int32_t>(i);
+  }
+  for (const Op& op : graph.ops) {
+    if (op.kind == OpKind::RESHAPE && !graph.slots[op.inputs[0]].constant) {
+      root[op.output] = root[op.inputs[0]];
+    }
+  }
+
+  std::vector<int64_t> first(num_slots, end + 1);
+  std::vector<int64_t> last(num_slots, -2);
+  auto touch = [&](int32_t slot, int64_t when) {
+    int32_t r = root[slot];
+    first[r]  = std::min(first[r], when);
+    last[r]   = std::max(last[r], when);
+  };
+  for (int32_t input : graph.inputs) {
+    touch(input, -1);
+  }
+  for (size_t i = 0; i < graph.ops.size(); ++i) {
+    const Op& op = graph.ops[i];
+    for (int32_t input : op.inputs) {
+      if (!graph.slots[input].constant) {
+        touch(input, step(i));
+      }
+    }
+    touch(op.output, step(i));
+  }
+  for (int32_t output : graph.outputs) {
+    if (!graph.slots[output].constant) {
+      touch(output, end);
+    }
+  }
+
+  MemoryPlan plan;
+  plan.offsets.assign(num_slots, -1);
+
+  std::vector<Interval> intervals;
+  for (size_t i = 0; i < num_slots; ++i) {
+    if (last[i] < -1) {
+      continue;  // 상수, 별칭, DCE 로 떨어진 slot
+    }
+    size_t bytes = alignUp(static_cast<size_t>(graph.slots[i].numel()) * sizeof(float));
+    intervals.push_back({static_cast<int32_t>(i), first[i], last[i], bytes});
+    plan.naive_bytes += bytes;
+  }
+
+  std::vector<size_t> order(intervals.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return intervals[a].bytes > intervals[b].bytes;
+  });
+
+  std::vector<const Interval*> placed;
+  std::vector<const Interval*> live;
+  for (size_t index : order) {
+    Interval& cur = intervals[index];
+
+    live.clear();
+    for (const Interval* other : placed) {
+      if (other->first <= cur.last && cur.first <= other->last) {
+        live.push_back(other);
+      }
+    }
+    std::sort(live.begin(), live.end(),
+              [](const Interval* a, const Interval* b) { return a->offset < b->offset; });
+
+    // 수명이 겹치는 slot 들 사이에서 들어가는 가장 낮은 틈
+    size_t offset = 0;
+    for (const Interval* other : live) {
+      size_t begin = static_cast<size_t>(other->offset);
+      if (begin >= offset + cur.bytes) {
+        break;
+      }
+      offset = std::max(offset, begin + other->bytes);
+    }
+    cur.offset       = static_cast<int64_t>(offset);
+    plan.arena_bytes = std::max(plan.arena_bytes, offset + cur.bytes);
+    placed.push_back(&cur);
+  }
+
+  for (const Interval& interval : intervals) {
+    plan.offsets[interval.slot] = interval.offset;
+  }
+  for (size_t i = 0; i < num_slots; ++i) {
+    if (root[i] != static_cast<int32_t>(i)) {
+      plan.offsets[i] = plan.offsets[root[i]];
+    }
+  }
+  return plan;
+}
+
+}  // namespace engine
+}  // namespace tfe
@@ -0,0 +1,200 @@
+#include "engine/profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
+
+#include "engine/scheduler.h"
+#include "error/error.h"
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+double slotBytes(const Slot& slot) {
+  const size_t element =
+      slot.constant && slot.tensor.defined() ? tensor::dtypeSize(slot.tensor.dtype()) : 4;
+  return static_cast<double>(slot.numel()) * static_cast<double>(element);
+}
+
+/**
+ * @brief op 가 읽고 쓰는 바이트. cat 출력에 제자리로 쓰는 conv 는 제 채널 몫만 쓴다
+ */
+double opBytes(const Graph& graph, const Op& op) {
+  double bytes = 0.0;
+  for (int32_t input : op.inputs) {
+    bytes += slotBytes(graph.slots[input]);
+  }
+  const Slot& out = graph.slots[op.output];
+  double written  = slotBytes(out);
+  if (op.kind == OpKind::CONV2D && out.sizes.size() == 4) {
+    const int64_t oc = graph.slots[op.inputs[1]].sizes[0];
+    written *= static_cast<double>(oc) / static_cast<double>(out.sizes[1]);
+  }
+  return bytes + written;
+}
+
+double opFlops(const Graph& graph, const Op& op) {
+  switch (op.kind) {
+    case OpKind::CAT:
+    case OpKind::UPSAMPLE_NEAREST2D:
+    case OpKind::PAD:
+    case OpKind::RESHAPE:
+    case OpKind::REORDER:
+      return 0.0;
+    default:
+      return opCost(graph, op);
+  }
+}
+
+void appendEscaped(std::string* out, const std::string& s) {
+  for (char ch : s) {
+    if (ch == '"' || ch == '\\') {
+      out->push_back('\\');
+    }
+    out->push_back(ch);
+  }
+}
+
+}  // namespace
+
+Profiler::Profiler(const Graph& graph, size_t workers, size_t capacity)
+    : workers_(std::max<size_t>(workers, 1)) {
+  ops_.reserve(graph.ops.size());
+  for (const Op& op : graph.ops) {
+    ops_.push_back({op.name.empty() ? opKindToString(op.kind) : op.name, op.kind,
+                    opFlops(graph, op), opBytes(graph, op)});
+  }
+
+  uint64_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  mask_  = size - 1;
+  rings_ = std::make_unique<Ring[]>(workers_);
+  for (size_t i = 0; i < workers_; ++i) {
+    rings_[i].events.resize(size);
+  }
+  origin_ = now();
+}
+
+std::vector<OpEvent> Profiler::events() const {
+  std::vector<OpEvent> out;
+  for (size_t w = 0; w < workers_; ++w) {
+    const Ring& ring    = rings_[w];
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    const uint64_t kept = std::min<uint64_t>(head, mask_ + 1);
+    for (uint64_t i = head - kept; i < head; ++i) {
+      out.push_back(ring.events[i & mask_]);
+    }
+  }
+  std::sort(out.begin(), out.end(), [](const OpEvent& a, const OpEvent& b) {
+    return a.begin != b.begin ? a.begin < b.begin : a.worker < b.worker;
+  });
+  return out;
+}
+
+uint64_t Profiler::dropped() const {
+  uint64_t dropped = 0;
+  for (size_t w = 0; w < workers_; ++w) {
+    const uint64_t head = rings_[w].head.load(std::memory_order_acquire);
+    dropped += head > mask_ + 1 ? head - (mask_ + 1) : 0;
+  }
+  return dropped;
+}
+
+void Profiler::clear() {
+  for (size_t w = 0; w < workers_; ++w) {
+    rings_[w].head.store(0, std::memory_order_release);
+  }
+}
+
+std::vector<ModuleProfile> Profiler::modules() const {
+  std::vector<ModuleProfile> out;
+  std::unordered_map<std::string, size_t> index;
+  for (const OpEvent& event : events()) {
+    const OpInfo& op = ops_[event.op];
+    auto found       = index.emplace(op.name, out.size());
+    if (found.second) {
+      out.push_back(ModuleProfile());
+      out.back().module = op.name;
+    }
+    ModuleProfile& m     = out[found.first->second];
+    const int64_t length = event.end - event.begin;
+    m.calls += 1;
+    m.total += length;
+    m.longest = std::max(m.longest, length);
+    m.flops += op.flops;
+    m.bytes += op.bytes;
+  }
+  std::stable_sort(out.begin(), out.end(), [](const ModuleProfile& a, const ModuleProfile& b) {
+    return a.total > b.total;
+  });
+  return out;
+}
+
+std::string Profiler::table() const {
+  const std::vector<ModuleProfile> profiles = modules();
+  size_t width = 6;
+  int64_t all  = 0;
+  for (const ModuleProfile& m : profiles) {
+    width = std::max(width, m.module.size());
+    all += m.total;
+  }
+
+  char line[512];
+  std::snprintf(line, sizeof(line), "%-*s %8s %10s %6s %10s %9s %8s\n", static_cast<int>(width),
+                "module", "calls", "total ms", "%", "avg us", "GFLOP/s", "GB/s");
+  std::string out = line;
+  for (const ModuleProfile& m : profiles) {
+    // flop / ns == GFLOP/s, byte / ns == GB/s
+    const double ns = static_cast<double>(std::max<int64_t>(m.total, 1));
+    std::snprintf(line, sizeof(line), "%-*s %8zu %10.3f %6.1f %10.2f %9.2f %8.2f\n",
+                  static_cast<int>(width), m.module.c_str(), m.calls, m.total / 1e6,
+                  all > 0 ? 100.0 * m.total / all : 0.0, m.total / 1e3 / m.calls, m.flops / ns,
+                  m.bytes / ns);
+    out += line;
+  }
+  return out;
+}
+
+std::string Profiler::chromeTrace() const {
+  std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  char line[256];
+  for (size_t w = 0; w < workers_; ++w) {
+    std::snprintf(line, sizeof(line),
+                  "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,"
+                  "\"args\":{\"name\":\"worker %zu\"}}",
+                  w ? "," : "", w, w);
+    out += line;
+  }
+  for (const OpEvent& event : events()) {
+    const OpInfo& op = ops_[event.op];
+    out += ",\n{\"name\":\"";
+    appendEscaped(&out, op.name);
+    std::snprintf(line, sizeof(line),
+                  "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,"
+                  "\"args\":{\"op\":%d,\"flops\":%.0f,\"bytes\":%.0f}}",
+                  opKindToString(op.kind), event.begin / 1e3, (event.end - event.begin) / 1e3,
+                  event.worker, event.op, op.flops, op.bytes);
+    out += line;
+  }
+  return out + "\n]}\n";
+}
+
+void Profiler::saveChromeTrace(const std::string& file_name) const {
+  std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw error::ParserException(error::OPEN_FAILED, "Failed to create file: " + file_name);
+  }
+  const std::string trace = chromeTrace();
+  out.write(trace.data(), static_cast<std::streamsize>(trace.size()));
+  if (!out) {
+    throw error::ParserException(error::OPEN_FAILED, "Failed to write file: " + file_name);
+  }
+}
+
+}  // namespace engine
+}  // namespace tfe
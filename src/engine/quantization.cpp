@@ -0,0 +1,198 @@
+#include "engine/quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "tensor/layout.h"
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+bool isFloatConstant(const Slot& slot) {
+  return slot.constant && slot.tensor.dtype() == tensor::DType::FLOAT32;
+}
+
+/**
+ * @brief int8 로 돌릴 수 있는 op. conv 는 groups 1 만 (depthwise 는 GEMM 이 아니다)
+ */
+bool quantizable(const Graph& graph, const Op& op) {
+  if (op.kind == OpKind::CONV2D) {
+    const Slot& w = graph.slots[op.inputs[1]];
+    return op.params.groups == 1 && w.sizes.size() == 4 && isFloatConstant(w);
+  }
+  if (op.kind == OpKind::LINEAR) {
+    const Slot& w = graph.slots[op.inputs[1]];
+    return w.sizes.size() == 2 && isFloatConstant(w);
+  }
+  return false;
+}
+
+}  // namespace
+
+float ActivationRange::low() const { return std::min(min, 0.0f); }
+
+float ActivationRange::high() const { return std::max(max, 0.0f); }
+
+void Calibrator::observe(const std::vector<tensor::Tensor>& inputs) {
+  const Graph& graph = engine_.graph();
+  // REORDER 출력 -> 그 입력. 묶인 layout 으로 옮긴 값도 원래 slot 으로 센다
+  std::vector<int32_t> reordered(graph.slots.size(), -1);
+  for (const Op& op : graph.ops) {
+    if (op.kind == OpKind::REORDER) {
+      reordered[op.output] = op.inputs[0];
+    }
+  }
+  engine_.run(inputs, [&](size_t index) {
+    const Op& op = graph.ops[index];
+    if ((op.kind != OpKind::CONV2D && op.kind != OpKind::LINEAR) || op.params.input_scale > 0.0f) {
+      return;
+    }
+    int32_t value = op.inputs[0];
+    while (reordered[value] >= 0) {
+      value = reordered[value];
+    }
+    // conv 입력은 묶인 layout 일 수 있다 ([N][C/lanes][H][W][lanes]). 남는 lane 은 세지 않는다
+    const Slot& x        = graph.slots[op.inputs[0]];
+    const bool linear    = op.kind == OpKind::LINEAR;
+    const int64_t lanes  = tensor::layoutBlock(x.layout);
+    const int64_t count  = x.numel();
+    const int64_t chans  = linear ? graph.slots[op.inputs[1]].sizes[1] : x.sizes[1];
+    const int64_t inner  = linear ? 1 : x.sizes[2] * x.sizes[3];
+    const int64_t blocks = (chans + lanes - 1) / lanes;
+    const float* data    = engine_.value(op.inputs[0]);
+
+    ActivationRange& range = calibration_.ranges[value];
+    for (int64_t i = 0; i < count; ++i) {
+      const int64_t c = (i / (inner * lanes)) % blocks * lanes + i % lanes;
+      if (c < chans) {
+        range.min = std::min(range.min, data[i]);
+        range.max = std::max(range.max, data[i]);
+      }
+    }
+    ++range.samples;
+  });
+}
+
+void activationQuantization(const ActivationRange& range, float* scale, int32_t* zero) {
+  const float lo = range.low(), hi = range.high();
+  if (!(hi > lo)) {
+    *scale = 1.0f;
+    *zero  = 0;
+    return;
+  }
+  *scale = (hi - lo) / 255.0f;
+  *zero  = static_cast<int32_t>(std::min(255.0f, std::max(0.0f, std::round(-lo / *scale))));
+}
+
+void quantizeRows(const float* a, int64_t rows, int64_t cols, int8_t* q, float* scale) {
+  for (int64_t r = 0; r < rows; ++r) {
+    const float* row = a + r * cols;
+    float peak       = 0.0f;
+    for (int64_t k = 0; k < cols; ++k) {
+      peak = std::max(peak, std::fabs(row[k]));
+    }
+    scale[r]        = peak > 0.0f ? peak / 127.0f : 1.0f;
+    const float inv = 1.0f / scale[r];
+    for (int64_t k = 0; k < cols; ++k) {
+      const float v   = std::round(row[k] * inv);
+      q[r * cols + k] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, v)));
+    }
+  }
+}
+
+void planQuantization(Graph& graph, const Calibration& calibration) {
+  for (Op& op : graph.ops) {
+    if (!quantizable(graph, op)) {
+      continue;
+    }
+    auto it = calibration.ranges.find(op.inputs[0]);
+    if (it == calibration.ranges.end() || it->second.samples == 0) {
+      continue;
+    }
+    activationQuantization(it->second, &op.params.input_scale, &op.params.input_zero);
+  }
+}
+
+void convertQuantizedWeights(Graph& graph) {
+  for (Op& op : graph.ops) {
+    if (op.params.input_scale <= 0.0f || op.params.weight_scale >= 0) {
+      continue;
+    }
+    const Slot& w        = graph.slots[op.inputs[1]];
+    const int64_t rows   = w.sizes[0];
+    const int64_t cols   = w.tensor.numel() / rows;
+    tensor::Tensor src   = tensor::contiguous(w.tensor);
+    tensor::Tensor q     = tensor::empty(w.sizes, tensor::DType::INT8, op.name + ".weight");
+    tensor::Tensor scale = tensor::empty({rows}, tensor::DType::FLOAT32, op.name + ".weight_scale");
+    quantizeRows(src.data<float>(), rows, cols, q.data<int8_t>(), scale.data<float>());
+    op.inputs[1]           = graph.addConstant(op.name + ".weight", std::move(q));
+    op.params.weight_scale = graph.addConstant(op.name + ".weight_scale", std::move(scale));
+  }
+}
+
+std::string AccuracyReport::summary() const {
+  std::string out;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "output %zu: max abs %.3g, mean abs %.3g, SNR %.1f dB\n", i,
+                  outputs[i].max_abs, outputs[i].mean_abs, outputs[i].snr_db);
+    out += line;
+  }
+  return out;
+}
+
+AccuracyReport compareOutputs(Engine& reference, Engine& candidate,
+                              const std::vector<std::vector<tensor::Tensor>>& samples) {
+  AccuracyReport report;
+  std::vector<double> signal, noise;
+  std::vector<std::vector<float>> want;
+  for (const std::vector<tensor::Tensor>& sample : samples) {
+    // 두 Engine 의 출력은 다음 run() 전까지만 유효하므로 기준 쪽을 복사해 둔다
+    const std::vector<tensor::Tensor>& expected = reference.run(sample);
+    want.resize(expected.size());
+    for (size_t k = 0; k < expected.size(); ++k) {
+      tensor::Tensor t = tensor::contiguous(expected[k]);
+      want[k].assign(t.data<float>(), t.data<float>() + t.numel());
+    }
+    const std::vector<tensor::Tensor>& actual = candidate.run(sample);
+    if (actual.size() != want.size()) {
+      throw std::invalid_argument("compareOutputs: engines have different outputs");
+    }
+    report.outputs.resize(want.size());
+    signal.resize(want.size(), 0.0);
+    noise.resize(want.size(), 0.0);
+    for (size_t k = 0; k < want.size(); ++k) {
+      tensor::Tensor t = tensor::contiguous(actual[k]);
+      if (t.numel() != static_cast<int64_t>(want[k].size())) {
+        throw std::invalid_argument("compareOutputs: output " + std::to_string(k) +
+                                    " has a different size");
+      }
+      OutputDiff& diff = report.outputs[k];
+      const float* got = t.data<float>();
+      for (size_t i = 0; i < want[k].size(); ++i) {
+        const double err = std::fabs(static_cast<double>(got[i]) - want[k][i]);
+        diff.max_abs     = std::max(diff.max_abs, err);
+        diff.mean_abs += err;
+        signal[k] += static_cast<double>(want[k][i]) * want[k][i];
+        noise[k] += err * err;
+      }
+      diff.count += static_cast<int64_t>(want[k].size());
+    }
+  }
+  for (size_t k = 0; k < report.outputs.size(); ++k) {
+    OutputDiff& diff = report.outputs[k];
+    diff.mean_abs    = diff.count ? diff.mean_abs / diff.count : 0.0;
+    diff.snr_db      = noise[k] > 0.0 ? 10.0 * std::log10(signal[k] / noise[k])
+                                      : std::numeric_limits<double>::infinity();
+  }
+  return report;
+}
+
+}  // namespace engine
+}  // namespace tfe
@@ -0,0 +1,153 @@
+#include "engine/scheduler.h"
+
+#include <algorithm>
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+// pool 에 일을 한 번 나눠 주고 기다리는 비용을 flop 으로 어림한 값 (수 us)
+constexpr double kDispatchCost = 20000.0;
+
+double numel(const std::vector<int64_t>& sizes) {
+  double n = 1.0;
+  for (int64_t s : sizes) {
+    n *= static_cast<double>(s);
+  }
+  return n;
+}
+
+/**
+ * @brief op 를 pool 로 몇 갈래까지 나눌 수 있는가. ConvKernel 만 나누고 나머지 커널은 한 스레드다
+ */
+double parallelism(const Graph& graph, const Op& op) {
+  if (op.kind != OpKind::CONV2D) {
+    return 1.0;
+  }
+  // 출력 행과 채널 묶음 (16) 정도로 나뉜다
+  const std::vector<int64_t>& out = graph.slots[op.output].sizes;
+  const std::vector<int64_t>& w   = graph.slots[op.inputs[1]].sizes;
+  return static_cast<double>(out[0] * ((w[0] + 15) / 16) * out[2]);
+}
+
+}  // namespace
+
+std::string Schedule::summary() const {
+  size_t ops = 0, concurrent = 0, concurrent_ops = 0;
+  for (const Stage& stage : stages) {
+    ops += stage.ops.size();
+    if (stage.concurrent) {
+      ++concurrent;
+      concurrent_ops += stage.ops.size();
+    }
+  }
+  return std::to_string(stages.size()) + " stages for " + std::to_string(ops) + " ops, " +
+         std::to_string(concurrent) + " concurrent (" + std::to_string(concurrent_ops) + " ops)";
+}
+
+std::vector<std::vector<int32_t>> opDependencies(const Graph& graph) {
+  std::vector<std::vector<int32_t>> deps(graph.ops.size());
+  std::vector<std::vector<int32_t>> writers(graph.slots.size());
+  for (size_t i = 0; i < graph.ops.size(); ++i) {
+    const Op& op = graph.ops[i];
+    for (int32_t input : op.inputs) {
+      deps[i].insert(deps[i].end(), writers[input].begin(), writers[input].end());
+    }
+    deps[i].insert(deps[i].end(), writers[op.output].begin(), writers[op.output].end());
+    std::sort(deps[i].begin(), deps[i].end());
+    deps[i].erase(std::unique(deps[i].begin(), deps[i].end()), deps[i].end());
+    writers[op.output].push_back(static_cast<int32_t>(i));
+  }
+  return deps;
+}
+
+double opCost(const Graph& graph, const Op& op) {
+  const std::vector<int64_t>& out = graph.slots[op.output].sizes;
+  switch (op.kind) {
+    case OpKind::CONV2D: {
+      // 출력 원소마다 (입력 채널 / groups) * KH * KW 번 곱하고 더한다. upsample / cat epilogue 는
+      // 출력 slot 이 conv 출력보다 크므로 weight 의 출력 채널로 센다
+      const std::vector<int64_t>& in = graph.slots[op.inputs[0]].sizes;
+      const std::vector<int64_t>& w  = graph.slots[op.inputs[1]].sizes;
+      const double oh = static_cast<double>(
+          (in[2] + 2 * op.params.padding[0] - op.params.dilation[0] * (w[2] - 1) - 1) /
+              op.params.stride[0] +
+          1);
+      const double ow = static_cast<double>(
+          (in[3] + 2 * op.params.padding[1] - op.params.dilation[1] * (w[3] - 1) - 1) /
+              op.params.stride[1] +
+          1);
+      return 2.0 * numel(w) * static_cast<double>(in[0]) * oh * ow;
+    }
+    case OpKind::LINEAR: {
+      const std::vector<int64_t>& w = graph.slots[op.inputs[1]].sizes;
+      return 2.0 * numel(out) * static_cast<double>(w[1]);
+    }
+    case OpKind::MAX_POOL2D:
+      return numel(out) * static_cast<double>(op.params.kernel[0] * op.params.kernel[1]);
+    case OpKind::ADAPTIVE_AVG_POOL2D:
+      return numel(graph.slots[op.inputs[0]].sizes);
+    case OpKind::RESHAPE:
+      return 0.0;
+    default:
+      return numel(out);
+  }
+}
+
+Schedule scheduleOps(const Graph& graph, size_t concurrency) {
+  const size_t count = graph.ops.size();
+  Schedule schedule;
+  schedule.steps.resize(count);
+
+  if (concurrency <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      schedule.stages.push_back({{static_cast<int32_t>(i)}, false});
+      schedule.steps[i] = static_cast<int64_t>(i);
+    }
+    return schedule;
+  }
+
+  // 입력이 모두 준비되는 가장 이른 level. ops 는 위상 정렬되어 있으므로 한 번 훑으면 된다
+  const std::vector<std::vector<int32_t>> deps = opDependencies(graph);
+  int64_t levels                               = 0;
+  for (size_t i = 0; i < count; ++i) {
+    int64_t level = 0;
+    for (int32_t dep : deps[i]) {
+      level = std::max(level, schedule.steps[dep] + 1);
+    }
+    schedule.steps[i] = level;
+    levels            = std::max(levels, level + 1);
+  }
+
+  std::vector<double> cost(count);
+  for (size_t i = 0; i < count; ++i) {
+    cost[i] = opCost(graph, graph.ops[i]);
+  }
+  schedule.stages.resize(levels);
+  for (size_t i = 0; i < count; ++i) {
+    schedule.stages[schedule.steps[i]].ops.push_back(static_cast<int32_t>(i));
+  }
+
+  const double workers = static_cast<double>(concurrency);
+  for (Stage& stage : schedule.stages) {
+    std::stable_sort(stage.ops.begin(), stage.ops.end(),
+                     [&](int32_t a, int32_t b) { return cost[a] > cost[b]; });
+    if (stage.ops.size() < 2) {
+      continue;
+    }
+    double intra = 0.0, total = 0.0, longest = 0.0;
+    for (int32_t i : stage.ops) {
+      const double ways = std::min(workers, parallelism(graph, graph.ops[i]));
+      intra += cost[i] / ways + (ways > 1.0 ? kDispatchCost : 0.0);
+      total += cost[i];
+      longest = std::max(longest, cost[i]);
+    }
+    const double inter = std::max(longest, total / workers) + kDispatchCost;
+    stage.concurrent   = inter < intra;
+  }
+  return schedule;
+}
+
+}  // namespace engine
+}  // namespace tfe
@@ -0,0 +1,601 @@
+#include "engine/script_source.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace tfe {
+namespace engine {
+
+namespace {
+
+struct Token {
+  enum class Type : uint8_t { NAME, INT, FLOAT, STRING, OP, END };
+
+  Type type = Type::END;
+  std::string text;
+  int64_t i = 0;
+  double f  = 0.0;
+};
+
+struct LogicalLine {
+  int indent = 0;
+  int line   = 0;
+  std::string text;
+};
+
+bool isNameStart(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+bool isNameChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+
+/**
+ * @brief 괄호가 닫히지 않은 줄은 다음 줄과 이어 붙인다 (여러 줄에 걸친 def 헤더, 긴 호출)
+ */
+std::vector<LogicalLine> splitLines(std::string_view text) {
+  std::vector<LogicalLine> lines;
+  LogicalLine current;
+  int depth    = 0;
+  int line_no  = 0;
+  size_t begin = 0;
+  while (begin <= text.size()) {
+    size_t end = text.find('\n', begin);
+    if (end == std::string_view::npos) {
+      end = text.size();
+    }
+    std::string_view raw = text.substr(begin, end - begin);
+    begin                = end + 1;
+    ++line_no;
+
+    if (depth == 0) {
+      size_t indent = raw.find_first_not_of(" \t");
+      if (indent == std::string_view::npos || raw[indent] == '#') {
+        if (end == text.size()) {
+          break;
+        }
+        continue;
+      }
+      current        = LogicalLine();
+      current.indent = static_cast<int>(indent);
+      current.line   = line_no;
+      raw            = raw.substr(indent);
+    } else {
+      current.text += ' ';
+    }
+
+    char quote = 0;
+    for (size_t i = 0; i < raw.size(); ++i) {
+      char c = raw[i];
+      if (quote) {
+        if (c == '\\') {
+          ++i;
+        } else if (c == quote) {
+          quote = 0;
+        }
+        continue;
+      }
+      if (c == '\'' || c == '"') {
+        quote = c;
+      } else if (c == '(' || c == '[' || c == '{') {
+        ++depth;
+      } else if (c == ')' || c == ']' || c == '}') {
+        --depth;
+      } else if (c == '#') {
+        raw = raw.substr(0, i);
+        break;
+      }
+    }
+    current.text.append(raw);
+    if (depth <= 0) {
+      depth = 0;
+      lines.push_back(std::move(current));
+      current = LogicalLine();
+    }
+    if (end == text.size()) {
+      break;
+    }
+  }
+  if (!current.text.empty()) {
+    lines.push_back(std::move(current));
+  }
+  return lines;
+}
+
+std::vector<Token> tokenize(const std::string& text) {
+  std::vector<Token> tokens;
+  size_t i = 0;
+  while (i < text.size()) {
+    char c = text[i];
+    if (c == ' ' || c == '\t') {
+      ++i;
+      continue;
+    }
+
+    Token token;
+    if (isNameStart(c)) {
+      size_t start = i;
+      while (i < text.size() && isNameChar(text[i])) {
+        ++i;
+      }
+      token.type = Token::Type::NAME;
+      token.text = text.substr(start, i - start);
+    } else if (std::isdigit(static_cast<unsigned char>(c)) ||
+               (c == '.' && i + 1 < text.size() &&
+                std::isdigit(static_cast<unsigned char>(text[i + 1])))) {
+      const char* start = text.c_str() + i;
+      char* end         = nullptr;
+      size_t j          = i;
+      bool is_float     = false;
+      while (j < text.size() &&
+             (std::isalnum(static_cast<unsigned char>(text[j])) || text[j] == '.' ||
+              ((text[j] == '-' || text[j] == '+') && (text[j - 1] == 'e' || text[j - 1] == 'E')))) {
+        is_float = is_float || text[j] == '.' || text[j] == 'e' || text[j] == 'E';
+        ++j;
+      }
+      if (is_float) {
+        token.type = Token::Type::FLOAT;
+        token.f    = std::strtod(start, &end);
+      } else {
+        token.type = Token::Type::INT;
+        token.i    = std::strtoll(start, &end, 10);
+      }
+      token.text = text.substr(i, j - i);
+      i          = j;
+    } else if (c == '\'' || c == '"') {
+      ++i;
+      while (i < text.size() && text[i] != c) {
+        if (text[i] == '\\' && i + 1 < text.size()) {
+          char e = text[++i];
+          token.text += e == 'n' ? '\n' : e == 't' ? '\t' : e;
+        } else {
+          token.text += text[i];
+        }
+        ++i;
+      }
+      ++i;
+      token.type = Token::Type::STRING;
+    } else {
+      static const char* kTwoChar[] = {"->", "==", "!=", "<=", ">=", "**", "//"};
+      token.type                    = Token::Type::OP;
+      token.text                    = std::string(1, c);
+      for (const char* op : kTwoChar) {
+        if (text.compare(i, 2, op) == 0) {
+          token.text = op;
+          break;
+        }
+      }
+      i += token.text.size();
+    }
+    tokens.push_back(std::move(token));
+  }
+  tokens.push_back(Token());
+  return tokens;
+}
+
+/**
+ * @brief 토큰 열 하나에 대한 재귀 하강 파서. 지원하지 않는 문법은 std::runtime_error
+ */
+class ExprParser {
+ public:
+  explicit ExprParser(const std::vector<Token>& tokens, size_t pos = 0)
+      : tokens_(tokens), pos_(pos) {}
+
+  std::unique_ptr<Expr> parseList() {
+    std::unique_ptr<Expr> first = parse();
+    if (!isOp(",")) {
+      return first;
+    }
+    auto tuple  = std::make_unique<Expr>();
+    tuple->kind = Expr::Kind::TUPLE;
+    tuple->args.push_back(std::move(first));
+    while (isOp(",")) {
+      ++pos_;
+      if (atEnd()) {
+        break;
+      }
+      tuple->args.push_back(parse());
+    }
+    return tuple;
+  }
+
+  std::unique_ptr<Expr> parse() { return parseAdditive(); }
+
+  bool atEnd() const { return peek().type == Token::Type::END; }
+  size_t pos() const { return pos_; }
+
+ private:
+  const Token& peek() const { return tokens_[pos_]; }
+  bool isOp(const char* op) const { return peek().type == Token::Type::OP && peek().text == op; }
+
+  void expect(const char* op) {
+    if (!isOp(op)) {
+      throw std::runtime_error(std::string("expected '") + op + "' but got '" + peek().text + "'");
+    }
+    ++pos_;
+  }
+
+  static std::unique_ptr<Expr> binary(char op, std::unique_ptr<Expr> lhs,
+                                      std::unique_ptr<Expr> rhs) {
+    auto expr  = std::make_unique<Expr>();
+    expr->kind = Expr::Kind::BINARY;
+    expr->op   = op;
+    expr->args.push_back(std::move(lhs));
+    expr->args.push_back(std::move(rhs));
+    return expr;
+  }
+
+  std::unique_ptr<Expr> parseAdditive() {
+    std::unique_ptr<Expr> lhs = parseTerm();
+    while (isOp("+") || isOp("-")) {
+      char op = peek().text[0];
+      ++pos_;
+      lhs = binary(op, std::move(lhs), parseTerm());
+    }
+    return lhs;
+  }
+
+  std::unique_ptr<Expr> parseTerm() {
+    std::unique_ptr<Expr> lhs = parseUnary();
+    while (isOp("*") || isOp("/") || isOp("//") || isOp("%")) {
+      char op = peek().text == "//" ? 'f' : peek().text[0];
+      ++pos_;
+      lhs = binary(op, std::move(lhs), parseUnary());
+    }
+    return lhs;
+  }
+
+  std::unique_ptr<Expr> parseUnary() {
+    if (!isOp("-")) {
+      return parsePostfix();
+    }
+    ++pos_;
+    std::unique_ptr<Expr> operand = parseUnary();
+    if (operand->kind == Expr::Kind::INT) {
+      operand->i = -operand->i;
+      return operand;
+    }
+    if (operand->kind == Expr::Kind::FLOAT) {
+      operand->f = -operand->f;
+      return operand;
+    }
+    auto expr  = std::make_unique<Expr>();
+    expr->kind = Expr::Kind::NEG;
+    expr->args.push_back(std::move(operand));
+    return expr;
+  }
+
+  std::unique_ptr<Expr> parsePostfix() {
+    std::unique_ptr<Expr> expr = parsePrimary();
+    for (;;) {
+      if (isOp(".")) {
+        ++pos_;
+        if (peek().type != Token::Type::NAME) {
+          throw std::runtime_error("expected attribute name after '.'");
+        }
+        auto attr  = std::make_unique<Expr>();
+        attr->kind = Expr::Kind::ATTR;
+        attr->text = peek().text;
+        attr->args.push_back(std::move(expr));
+        ++pos_;
+        expr = std::move(attr);
+      } else if (isOp("(")) {
+        ++pos_;
+        auto call  = std::make_unique<Expr>();
+        call->kind = Expr::Kind::CALL;
+        call->args.push_back(std::move(expr));
+        while (!isOp(")")) {
+          const Token& next = tokens_[pos_ + 1];
+          if (peek().type == Token::Type::NAME && next.type == Token::Type::OP &&
+              next.text == "=") {
+            call->keywords.push_back(peek().text);
+            pos_ += 2;
+          } else if (!call->keywords.empty()) {
+            throw std::runtime_error("positional argument after keyword argument");
+          }
+          call->args.push_back(parse());
+          if (!isOp(",")) {
+            break;
+          }
+          ++pos_;
+        }
+        expect(")");
+        expr = std::move(call);
+      } else if (isOp("[")) {
+        ++pos_;
+        auto sub  = std::make_unique<Expr>();
+        sub->kind = Expr::Kind::SUBSCRIPT;
+        sub->args.push_back(std::move(expr));
+        sub->args.push_back(parse());
+        expect("]");
+        expr = std::move(sub);
+      } else {
+        return expr;
+      }
+    }
+  }
+
+  std::unique_ptr<Expr> parsePrimary() {
+    const Token& token = peek();
+    auto expr          = std::make_unique<Expr>();
+    switch (token.type) {
+      case Token::Type::INT:
+        expr->kind = Expr::Kind::INT;
+        expr->i    = token.i;
+        ++pos_;
+        return expr;
+      case Token::Type::FLOAT:
+        expr->kind = Expr::Kind::FLOAT;
+        expr->f    = token.f;
+        ++pos_;
+        return expr;
+      case Token::Type::STRING:
+        expr->kind = Expr::Kind::STRING;
+        expr->text = token.text;
+        ++pos_;
+        return expr;
+      case Token::Type::NAME:
+        if (token.text == "None") {
+          expr->kind = Expr::Kind::NONE;
+        } else if (token.text == "True" || token.text == "False") {
+          expr->kind = Expr::Kind::BOOL;
+          expr->b    = token.text == "True";
+        } else if (token.text == "inf") {
+          expr->kind = Expr::Kind::FLOAT;
+          expr->f    = HUGE_VAL;
+        } else {
+          static const char* kKeywords[] = {"if",  "else", "for", "while", "and",
+                                            "or",  "not",  "is",  "in",    "lambda"};
+          for (const char* keyword : kKeywords) {
+            if (token.text == keyword) {
+              throw std::runtime_error("unsupported keyword '" + token.text + "'");
+            }
+          }
+          expr->kind = Expr::Kind::NAME;
+          expr->text = token.text;
+        }
+        ++pos_;
+        return expr;
+      case Token::Type::OP:
+        if (token.text == "(" || token.text == "[") {
+          bool is_list      = token.text == "[";
+          const char* close = is_list ? "]" : ")";
+          ++pos_;
+          expr->kind = is_list ? Expr::Kind::LIST : Expr::Kind::TUPLE;
+          bool comma = false;
+          while (!isOp(close)) {
+            expr->args.push_back(parse());
+            if (!isOp(",")) {
+              break;
+            }
+            comma = true;
+            ++pos_;
+          }
+          expect(close);
+          // (x) 는 튜플이 아니라 괄호
+          if (!is_list && !comma && expr->args.size() == 1) {
+            return std::move(expr->args[0]);
+          }
+          return expr;
+        }
+        break;
+      case Token::Type::END:
+        break;
+    }
+    throw std::runtime_error("unexpected token '" + token.text + "'");
+  }
+
+  const std::vector<Token>& tokens_;
+  size_t pos_;
+};
+
+Stmt parseStatement(const LogicalLine& line) {
+  Stmt stmt;
+  stmt.line = line.line;
+  stmt.text = line.text;
+
+  std::vector<Token> tokens     = tokenize(line.text);
+  const Token& first            = tokens[0];
+  static const char* kControl[] = {"if",    "elif", "else",   "for",  "while", "with", "raise",
+                                   "assert", "try",  "except", "break", "continue", "del"};
+  if (first.type == Token::Type::NAME) {
+    for (const char* keyword : kControl) {
+      if (first.text == keyword) {
+        stmt.kind = Stmt::Kind::UNSUPPORTED;
+        return stmt;
+      }
+    }
+  }
+
+  try {
+    if (first.type == Token::Type::NAME && first.text == "return") {
+      stmt.kind = Stmt::Kind::RETURN;
+      ExprParser parser(tokens, 1);
+      if (parser.atEnd()) {
+        stmt.value       = std::make_unique<Expr>();
+        stmt.value->kind = Expr::Kind::NONE;
+      } else {
+        stmt.value = parser.parseList();
+      }
+      return stmt;
+    }
+
+    // 괄호 밖의 '=' 가 있으면 대입문. 좌변은 이름 (쉼표로 여러 개) 만 허용
+    int depth     = 0;
+    size_t assign = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      const Token& t = tokens[i];
+      if (t.type != Token::Type::OP) {
+        continue;
+      }
+      if (t.text == "(" || t.text == "[" || t.text == "{") {
+        ++depth;
+      } else if (t.text == ")" || t.text == "]" || t.text == "}") {
+        --depth;
+      } else if (t.text == "=" && depth == 0) {
+        assign = i;
+        break;
+      }
+    }
+
+    size_t begin = 0;
+    if (assign) {
+      for (size_t i = 0; i < assign; ++i) {
+        if (tokens[i].type == Token::Type::NAME) {
+          stmt.targets.push_back(tokens[i].text);
+        } else if (!(tokens[i].type == Token::Type::OP && tokens[i].text == ",")) {
+          stmt.kind = Stmt::Kind::UNSUPPORTED;
+          return stmt;
+        }
+      }
+      stmt.kind = Stmt::Kind::ASSIGN;
+      begin     = assign + 1;
+    }
+
+    ExprParser parser(tokens, begin);
+    stmt.value = parser.parseList();
+    if (!parser.atEnd()) {
+      throw std::runtime_error("trailing tokens");
+    }
+  } catch (const std::runtime_error&) {
+    stmt.kind = Stmt::Kind::UNSUPPORTED;
+    stmt.value.reset();
+  }
+  return stmt;
+}
+
+/**
+ * @brief "def forward(self: T, x: Tensor) -> Tensor:" 에서 이름과 인자 이름만 뽑는다
+ */
+Method parseSignature(const std::vector<Token>& tokens) {
+  Method method;
+  method.name      = tokens[1].text;
+  int depth        = 0;
+  bool expect_name = true;
+  for (size_t i = 2; i < tokens.size(); ++i) {
+    const Token& t = tokens[i];
+    if (t.type == Token::Type::OP) {
+      if (t.text == "(" || t.text == "[") {
+        ++depth;
+        continue;
+      }
+      if (t.text == ")" || t.text == "]") {
+        if (--depth == 0) {
+          break;
+        }
+        continue;
+      }
+      if (t.text == "," && depth == 1) {
+        expect_name = true;
+        continue;
+      }
+    }
+    if (depth == 1 && expect_name && t.type == Token::Type::NAME) {
+      method.params.push_back(t.text);
+      expect_name = false;
+    }
+  }
+  return method;
+}
+
+}  // namespace
+
+const Method* ClassDef::method(const std::string& name) const {
+  auto it = methods.find(name);
+  return it == methods.end() ? nullptr : &it->second;
+}
+
+const Expr* ClassDef::constant(const std::string& name) const {
+  auto it = constants.find(name);
+  return it == constants.end() ? nullptr : it->second.get();
+}
+
+std::string ScriptSource::qualifierOf(const std::string& path) {
+  std::string qualifier = path;
+  if (qualifier.compare(0, 5, "code/") == 0) {
+    qualifier.erase(0, 5);
+  }
+  if (qualifier.size() > 3 && qualifier.compare(qualifier.size() - 3, 3, ".py") == 0) {
+    qualifier.erase(qualifier.size() - 3);
+  }
+  for (char& c : qualifier) {
+    if (c == '/') {
+      c = '.';
+    }
+  }
+  return qualifier;
+}
+
+void ScriptSource::add(const std::string& path, std::string_view text) {
+  const std::string qualifier = qualifierOf(path);
+
+  ClassDef* current_class = nullptr;
+  Method* current_method  = nullptr;
+  int class_indent        = -1;
+  int method_indent       = -1;
+
+  for (const LogicalLine& line : splitLines(text)) {
+    if (current_method && line.indent > method_indent) {
+      current_method->body.push_back(parseStatement(line));
+      continue;
+    }
+    current_method = nullptr;
+    if (current_class && line.indent <= class_indent) {
+      current_class = nullptr;
+    }
+
+    std::vector<Token> tokens = tokenize(line.text);
+    if (tokens[0].type != Token::Type::NAME) {
+      continue;
+    }
+
+    if (tokens[0].text == "class" && tokens[1].type == Token::Type::NAME) {
+      auto def            = std::make_unique<ClassDef>();
+      def->name           = qualifier + "." + tokens[1].text;
+      current_class       = def.get();
+      class_indent        = line.indent;
+      classes_[def->name] = std::move(def);
+      continue;
+    }
+    if (!current_class) {
+      continue;
+    }
+
+    if (tokens[0].text == "def" && tokens[1].type == Token::Type::NAME) {
+      Method method    = parseSignature(tokens);
+      std::string name = method.name;
+      current_method   = &(current_class->methods[name] = std::move(method));
+      method_indent    = line.indent;
+      continue;
+    }
+
+    // 클래스 본문: "stride : Final[Tuple[int, int]] = (2, 2)" 처럼 값이 있는 선언만 상수로 둔다
+    if (tokens.size() > 2 && tokens[1].type == Token::Type::OP && tokens[1].text == ":") {
+      int depth = 0;
+      for (size_t i = 2; i < tokens.size(); ++i) {
+        const Token& t = tokens[i];
+        if (t.type != Token::Type::OP) {
+          continue;
+        }
+        if (t.text == "[" || t.text == "(") {
+          ++depth;
+        } else if (t.text == "]" || t.text == ")") {
+          --depth;
+        } else if (t.text == "=" && depth == 0) {
+          try {
+            ExprParser parser(tokens, i + 1);
+            current_class->constants[tokens[0].text] = parser.parseList();
+          } catch (const std::runtime_error&) {
+          }
+          break;
+        }
+      }
+    }
+  }
+}
+
+const ClassDef* ScriptSource::find(std::string_view qualified_name) const {
+  auto it = classes_.find(std::string(qualified_name));
+  return it == classes_.end() ? nullptr : it->second.get();
+}
+
+}  // namespace engine
+}  // namespace tfe
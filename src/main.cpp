@@ -1,25 +1,156 @@
+#include "parser/parser_tflite.h"
 #include "parser/parser_torch.h"
+#include "engine/batcher.h"
+#include "engine/lowering.h"
 #include "error/error.h"
+#include "tensor/tensor_loader.h"
+#include "util/load_stats.h"
+#include "vm/vm_pkl.h"
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+
+namespace {
+
+bool isTFLite(const std::string& file_name) {
+  return file_name.size() > 7 && file_name.compare(file_name.size() - 7, 7, ".tflite") == 0;
+}
+
+/**
+ * @brief "1x3x224x224" -> {1, 3, 224, 224}
+ */
+std::vector<int64_t> parseShape(const std::string& text) {
+  std::vector<int64_t> shape;
+  size_t pos = 0;
+  while (true) {
+    size_t x = text.find('x', pos);
+    shape.push_back(std::strtoll(text.substr(pos, x - pos).c_str(), nullptr, 10));
+    if (x == std::string::npos) {
+      return shape;
+    }
+    pos = x + 1;
+  }
+}
+
+/**
+ * @brief 모델을 올려 둔 채 요청을 배치로 묶어 돌린다. socket 이 비어 있으면 stdin / stdout frame
+ * @note stdout 은 응답 frame 전용이라 로그는 stderr 로만 쓴다
+ */
+int serve(const std::string& file_name, const std::vector<std::vector<int64_t>>& shapes,
+          const std::string& socket, const tfe::engine::BatcherOptions& options) {
+  // 끊긴 연결에 쓰다가 SIGPIPE 로 죽지 않고 write 실패로 받는다
+  std::signal(SIGPIPE, SIG_IGN);
+
+  std::unique_ptr<tfe::model::ScriptModel> model;
+  std::unique_ptr<tfe::parser::TFLiteParser> tflite;
+  std::unique_ptr<tfe::engine::Batcher> batcher;
+  if (isTFLite(file_name)) {
+    tflite = std::make_unique<tfe::parser::TFLiteParser>();
+    tflite->read(file_name);
+    batcher = std::make_unique<tfe::engine::Batcher>(
+        [&](const std::vector<std::vector<int64_t>>& s) { return tfe::engine::lower(*tflite, s); },
+        shapes, options);
+  } else {
+    model   = std::make_unique<tfe::model::ScriptModel>(file_name);
+    batcher = std::make_unique<tfe::engine::Batcher>(*model, shapes, options);
+  }
+
+  std::cerr << "Serving " << file_name << " (max batch " << options.max_batch << ", max delay "
+            << options.max_delay.count() << " us) on " << (socket.empty() ? "stdin" : socket)
+            << std::endl;
+  if (socket.empty()) {
+    tfe::engine::serveStream(*batcher, 0, 1);
+  } else {
+    tfe::engine::serveUnixSocket(*batcher, socket);
+  }
+  const tfe::engine::BatcherStats stats = batcher->stats();
+  std::cerr << "Served " << stats.requests << " requests in " << stats.batches << " batches"
+            << std::endl;
+  return 0;
+}
+
+}  // namespace
 
 int main(int argc, char** argv) {
-  if (argc < 2) {
-    std::cerr << "Usage: " << argv[0] << " <model.pt>" << std::endl;
+  // --stats: data.pkl 을 풀고 텐서까지 채운 뒤 단계별 시간 / 바이트를 찍는다
+  // --serve: --input 마다 batch 1 입력 shape. --socket 이 없으면 stdin / stdout 으로 주고받는다
+  bool stats   = false;
+  bool serving = false;
+  std::string file_name;
+  std::string socket;
+  std::vector<std::vector<int64_t>> shapes;
+  tfe::engine::BatcherOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool has_value  = i + 1 < argc;
+    if (arg == "--stats") {
+      stats = true;
+    } else if (arg == "--serve") {
+      serving = true;
+    } else if (arg == "--input" && has_value) {
+      shapes.push_back(parseShape(argv[++i]));
+    } else if (arg == "--socket" && has_value) {
+      socket = argv[++i];
+    } else if (arg == "--max-batch" && has_value) {
+      options.max_batch = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--max-delay-us" && has_value) {
+      options.max_delay = std::chrono::microseconds(std::strtoll(argv[++i], nullptr, 10));
+    } else {
+      file_name = arg;
+    }
+  }
+  if (file_name.empty() || (serving && shapes.empty())) {
+    std::cerr << "Usage: " << argv[0] << " [--stats] <model.pt | model.tflite>\n"
+              << "       " << argv[0]
+              << " --serve <model> --input 1xCxHxW [--input ...] [--socket path]"
+                 " [--max-batch 8] [--max-delay-us 2000]"
+              << std::endl;
     return 1;
   }
 
   try {
-    tfe::parser::TorchParser parser;
-    parser.read(argv[1]);
+    if (serving) {
+      return serve(file_name, shapes, socket, options);
+    }
 
-    std::cout << "Version: " << parser.getVersion() << std::endl;
-    std::cout << "Byte Order: " << parser.getByteOrder() << std::endl;
-    std::cout << "File Size:" << parser.getFileSize() << std::endl;
-    std::cout << "Buffer is : " << parser.getData() << std::endl;
+    tfe::util::LoadStats::global().setEnabled(stats);
+
+    std::unique_ptr<tfe::parser::BaseParser> parser;
+    tfe::parser::TorchParser* torch = nullptr;
+    if (isTFLite(file_name)) {
+      parser = std::make_unique<tfe::parser::TFLiteParser>();
+    } else {
+      auto torch_parser = std::make_unique<tfe::parser::TorchParser>();
+      torch             = torch_parser.get();
+      parser            = std::move(torch_parser);
+    }
+    parser->read(file_name);
+
+    std::cout << "Version: " << parser->getVersion() << std::endl;
+    std::cout << "Byte Order: " << parser->getByteOrder() << std::endl;
+    std::cout << "File Size:" << parser->getFileSize() << std::endl;
+
+    if (!stats) {
+      std::cout << "Buffer is : " << parser->getData() << std::endl;
+      return 0;
+    }
+    if (torch) {
+      tfe::vm::PickleVM vm(torch->getDataView());
+      const tfe::vm::Value root = vm.load();
+      tfe::tensor::TensorLoader loader(*torch);
+      loader.collect(root);
+      loader.load();
+    }
+    std::cout << tfe::util::LoadStats::global().report();
 
   } catch (const tfe::error::ParserException& e) {
     std::cerr << "Error: " << e.what() << std::endl;
     return 1;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
   }
 
   return 0;
@@ -0,0 +1,293 @@
+#include "model/module.h"
+
+#include <unordered_set>
+
+#include "error/error.h"
+
+namespace tfe {
+namespace model {
+
+const Module::Slot* Module::slot(Symbol name) const {
+  auto it = slots_.find(name);
+  return it == slots_.end() ? nullptr : &it->second;
+}
+
+const Module* Module::child(Symbol name) const {
+  const Slot* s = slot(name);
+  return s && s->kind == SlotKind::CHILD ? children_[s->index].second : nullptr;
+}
+
+const tensor::Tensor* Module::tensor(Symbol name) const {
+  const Slot* s = slot(name);
+  if (!s) {
+    return nullptr;
+  }
+  switch (s->kind) {
+    case SlotKind::PARAMETER:
+      return &parameters_[s->index].second;
+    case SlotKind::BUFFER:
+      return &buffers_[s->index].second;
+    default:
+      return nullptr;
+  }
+}
+
+const Attribute* Module::attribute(Symbol name) const {
+  const Slot* s = slot(name);
+  return s && s->kind == SlotKind::ATTRIBUTE ? &attributes_[s->index].second : nullptr;
+}
+
+ModuleGraph::ModuleGraph(const vm::Value& root, tensor::TensorLoader& loader,
+                         const ClassMemberTable* members)
+    : loader_(loader), members_(members) {
+  training_symbol_ = strings_.intern("training");
+  if (!isModule(root)) {
+    throw error::ParserException(error::PARSE_ERROR,
+                                 std::string("data.pkl root is not a module: ") + root.typeName());
+  }
+  build(root, strings_.intern(""), nullptr);
+  // 같은 객체를 두 번 만나는 것만 막으면 되므로 빌드가 끝나면 필요 없다
+  built_.clear();
+}
+
+bool ModuleGraph::isModule(const vm::Value& value) const {
+  if (!value.isObject() || !value.toObject().cls.isGlobal()) {
+    return false;
+  }
+  std::string_view module = value.toObject().cls.toGlobal().module;
+  return module.compare(0, 9, "__torch__") == 0 && (module.size() == 9 || module[9] == '.');
+}
+
+Module* ModuleGraph::build(const vm::Value& value, Symbol name, const Module* parent) {
+  const vm::Object& object = value.toObject();
+  auto it                  = built_.find(&object);
+  if (it != built_.end()) {
+    // memo 로 공유된 서브모듈은 첫 번째 부모 아래에 한 번만 만든다
+    return it->second;
+  }
+
+  modules_.emplace_back();
+  Module* module = &modules_.back();
+  built_.emplace(&object, module);
+
+  const vm::Global& cls = object.cls.toGlobal();
+  std::string type(cls.module);
+  type.append(".").append(cls.name);
+  module->name_   = name;
+  module->type_   = strings_.intern(type);
+  module->parent_ = parent;
+
+  if (!object.state.isDict()) {
+    return module;
+  }
+  const ClassMembers* declared = nullptr;
+  if (members_) {
+    auto found = members_->find(type);
+    declared   = found == members_->end() ? nullptr : &found->second;
+  }
+
+  const vm::Dict& state = object.state.toDict();
+  for (uint32_t i = 0; i < state.size; ++i) {
+    if (!state.keys[i].isString()) {
+      continue;
+    }
+    Symbol field          = strings_.intern(state.keys[i].toStringView());
+    const vm::Value& item = state.values[i];
+
+    if (loader_.isTensor(item)) {
+      tensor::Tensor t = loader_.tensor(item);
+      const bool parameter = declared ? declared->parameters.count(state.keys[i].toStringView()) > 0
+                                      : t.requiresGrad();
+      if (parameter) {
+        module->add(field, Module::SlotKind::PARAMETER,
+                    static_cast<uint32_t>(module->parameters_.size()));
+        module->parameters_.emplace_back(field, std::move(t));
+      } else {
+        module->add(field, Module::SlotKind::BUFFER,
+                    static_cast<uint32_t>(module->buffers_.size()));
+        module->buffers_.emplace_back(field, std::move(t));
+      }
+    } else if (isModule(item)) {
+      Module* child = build(item, field, module);
+      module->add(field, Module::SlotKind::CHILD, static_cast<uint32_t>(module->children_.size()));
+      module->children_.emplace_back(field, child);
+    } else {
+      Attribute attr = toAttribute(item, strings_);
+      if (field == training_symbol_ && attr.kind == Attribute::Kind::BOOL) {
+        module->training_ = attr.b;
+      }
+      module->add(field, Module::SlotKind::ATTRIBUTE,
+                  static_cast<uint32_t>(module->attributes_.size()));
+      module->attributes_.emplace_back(field, std::move(attr));
+    }
+  }
+  return module;
+}
+
+Attribute toAttribute(const vm::Value& value, StringTable& strings) {
+  Attribute attr;
+  switch (value.type()) {
+    case vm::ValueType::NONE:
+      attr.kind = Attribute::Kind::NONE;
+      break;
+    case vm::ValueType::BOOL:
+      attr.kind = Attribute::Kind::BOOL;
+      attr.b    = value.toBool();
+      break;
+    case vm::ValueType::INT:
+      attr.kind = Attribute::Kind::INT;
+      attr.i    = value.toInt();
+      break;
+    case vm::ValueType::FLOAT:
+      attr.kind = Attribute::Kind::FLOAT;
+      attr.f    = value.toDouble();
+      break;
+    case vm::ValueType::STRING:
+      attr.kind = Attribute::Kind::STRING;
+      attr.s    = strings.intern(value.toStringView());
+      break;
+    case vm::ValueType::TUPLE:
+    case vm::ValueType::LIST: {
+      // (3, 3) 같은 kernel_size/stride/padding 튜플
+      const vm::Sequence& items = value.toSequence();
+      bool all_int              = true;
+      bool all_number           = true;
+      for (const vm::Value& item : items) {
+        all_int    = all_int && item.isInt();
+        all_number = all_number && (item.isInt() || item.isFloat());
+      }
+      if (all_int) {
+        attr.kind = Attribute::Kind::INT_LIST;
+        for (const vm::Value& item : items) {
+          attr.ints.push_back(item.toInt());
+        }
+      } else if (all_number) {
+        attr.kind = Attribute::Kind::FLOAT_LIST;
+        for (const vm::Value& item : items) {
+          attr.floats.push_back(item.toDouble());
+        }
+      } else {
+        attr.kind = Attribute::Kind::OTHER;
+      }
+      break;
+    }
+    default:
+      attr.kind = Attribute::Kind::OTHER;
+      break;
+  }
+  return attr;
+}
+
+const Module::Slot* ModuleGraph::resolve(std::string_view path, const Module** owner) const {
+  const Module* module = &root();
+  size_t begin         = 0;
+  for (;;) {
+    size_t dot               = path.find('.', begin);
+    std::string_view segment =
+        path.substr(begin, dot == std::string_view::npos ? dot : dot - begin);
+    Symbol symbol            = strings_.find(segment);
+    if (symbol == StringTable::kInvalid) {
+      return nullptr;
+    }
+    const Module::Slot* slot = module->slot(symbol);
+    if (!slot) {
+      return nullptr;
+    }
+    if (dot == std::string_view::npos) {
+      *owner = module;
+      return slot;
+    }
+    if (slot->kind != Module::SlotKind::CHILD) {
+      return nullptr;
+    }
+    module = module->children_[slot->index].second;
+    begin  = dot + 1;
+  }
+}
+
+const Module* ModuleGraph::findModule(std::string_view path) const {
+  if (path.empty()) {
+    return &root();
+  }
+  const Module* owner      = nullptr;
+  const Module::Slot* slot = resolve(path, &owner);
+  if (!slot || slot->kind != Module::SlotKind::CHILD) {
+    return nullptr;
+  }
+  return owner->children_[slot->index].second;
+}
+
+const tensor::Tensor* ModuleGraph::findTensor(std::string_view path) const {
+  const Module* owner      = nullptr;
+  const Module::Slot* slot = resolve(path, &owner);
+  if (!slot) {
+    return nullptr;
+  }
+  switch (slot->kind) {
+    case Module::SlotKind::PARAMETER:
+      return &owner->parameters_[slot->index].second;
+    case Module::SlotKind::BUFFER:
+      return &owner->buffers_[slot->index].second;
+    default:
+      return nullptr;
+  }
+}
+
+const Attribute* ModuleGraph::findAttribute(std::string_view path) const {
+  const Module* owner      = nullptr;
+  const Module::Slot* slot = resolve(path, &owner);
+  if (!slot || slot->kind != Module::SlotKind::ATTRIBUTE) {
+    return nullptr;
+  }
+  return &owner->attributes_[slot->index].second;
+}
+
+std::string ModuleGraph::path(const Module& module) const {
+  std::vector<std::string_view> names;
+  for (const Module* m = &module; m && m->parent_; m = m->parent_) {
+    names.push_back(strings_.str(m->name_));
+  }
+  std::string out;
+  for (size_t i = names.size(); i-- > 0;) {
+    out.append(names[i]);
+    if (i) {
+      out += '.';
+    }
+  }
+  return out;
+}
+
+size_t ModuleGraph::prefetch(std::string_view path) {
+  std::vector<tensor::Storage*> storages;
+  if (const tensor::Tensor* t = findTensor(path)) {
+    storages.push_back(t->storage().get());
+    return loader_.prefetch(std::move(storages));
+  }
+
+  const Module* top = findModule(path);
+  if (!top) {
+    return 0;
+  }
+  std::vector<const Module*> stack = {top};
+  std::unordered_set<const Module*> seen;
+  while (!stack.empty()) {
+    const Module* module = stack.back();
+    stack.pop_back();
+    if (!seen.insert(module).second) {
+      continue;
+    }
+    for (const auto& p : module->parameters_) {
+      storages.push_back(p.second.storage().get());
+    }
+    for (const auto& b : module->buffers_) {
+      storages.push_back(b.second.storage().get());
+    }
+    for (const auto& c : module->children_) {
+      stack.push_back(c.second);
+    }
+  }
+  return loader_.prefetch(std::move(storages));
+}
+
+}  // namespace model
+}  // namespace tfe
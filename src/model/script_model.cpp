@@ -0,0 +1,326 @@
+#include "model/script_model.h"
+
+#include <algorithm>
+#include <exception>
+#include <future>
+
+#include "error/error.h"
+#include "vm/vm_pkl.h"
+
+namespace tfe {
+namespace model {
+
+namespace {
+
+Constant toConstant(const vm::Value& value, tensor::TensorLoader& loader, StringTable& strings) {
+  Constant constant;
+  if (loader.isTensor(value)) {
+    constant.tensor = loader.tensor(value);
+  } else {
+    constant.value = toAttribute(value, strings);
+  }
+  return constant;
+}
+
+/**
+ * @brief (("instructions", ...), ("operators", ...)) 처럼 (key, value) 쌍 튜플에서 key 를 찾는다
+ */
+const vm::Value* findTable(const vm::Sequence& tables, std::string_view key) {
+  for (const vm::Value& table : tables) {
+    if (!table.isTuple() || table.toTuple().size != 2) {
+      continue;
+    }
+    const vm::Sequence& pair = table.toTuple();
+    if (pair[0].isString() && pair[0].toStringView() == key) {
+      return &pair[1];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief value 가 항목이 min_size 개 이상인 튜플인지 확인한다. 아니면 what 을 담아 PARSE_ERROR
+ */
+const vm::Sequence& expectTuple(const vm::Value& value, size_t min_size, const char* what) {
+  if (!value.isTuple() || value.toTuple().size < min_size) {
+    throw error::ParserException(error::PARSE_ERROR, std::string("Malformed bytecode ") + what);
+  }
+  return value.toTuple();
+}
+
+/**
+ * @brief value 가 튜플이나 리스트인지 확인한다. 아니면 what 을 담아 PARSE_ERROR
+ */
+const vm::Sequence& expectSequence(const vm::Value& value, const char* what) {
+  if (!value.isTuple() && !value.isList()) {
+    throw error::ParserException(error::PARSE_ERROR, std::string("Malformed bytecode ") + what);
+  }
+  return value.toSequence();
+}
+
+std::string_view expectString(const vm::Value& value, const char* what) {
+  if (!value.isString()) {
+    throw error::ParserException(error::PARSE_ERROR, std::string("Malformed bytecode ") + what);
+  }
+  return value.toStringView();
+}
+
+int64_t expectInt(const vm::Value& value, const char* what) {
+  if (!value.isInt()) {
+    throw error::ParserException(error::PARSE_ERROR, std::string("Malformed bytecode ") + what);
+  }
+  return value.toInt();
+}
+
+BytecodeFunction decodeFunction(const vm::Value& value, tensor::TensorLoader& loader,
+                                StringTable& strings) {
+  const vm::Sequence& fields = expectTuple(value, 2, "function");
+
+  BytecodeFunction function;
+  function.name              = std::string(expectString(fields[0], "function name"));
+  const vm::Sequence& tables = expectTuple(fields[1], 0, "function tables");
+
+  if (const vm::Value* instructions = findTable(tables, "instructions")) {
+    for (const vm::Value& item : expectSequence(*instructions, "instructions")) {
+      // (op, X, N)
+      const vm::Sequence& ins = expectTuple(item, 3, "instruction");
+      function.instructions.push_back(
+          {std::string(expectString(ins[0], "instruction opcode")),
+           static_cast<int32_t>(expectInt(ins[1], "instruction operand")),
+           static_cast<int32_t>(expectInt(ins[2], "instruction operand"))});
+    }
+  }
+  if (const vm::Value* operators = findTable(tables, "operators")) {
+    for (const vm::Value& item : expectSequence(*operators, "operators")) {
+      const vm::Sequence& op = expectTuple(item, 2, "operator");
+      OperatorRef ref;
+      ref.name     = std::string(expectString(op[0], "operator name"));
+      ref.overload = std::string(expectString(op[1], "operator overload"));
+      // v6 부터 (name, overload, num_specified_args). 없으면 -1
+      if (op.size > 2 && op[2].isInt()) {
+        ref.num_args = op[2].toInt();
+      }
+      function.operators.push_back(std::move(ref));
+    }
+  }
+  if (const vm::Value* constants = findTable(tables, "constants")) {
+    for (const vm::Value& item : expectSequence(*constants, "constants")) {
+      function.constants.push_back(toConstant(item, loader, strings));
+    }
+  }
+  if (const vm::Value* types = findTable(tables, "types")) {
+    for (const vm::Value& item : expectSequence(*types, "types")) {
+      function.types.emplace_back(expectString(item, "type"));
+    }
+  }
+  if (const vm::Value* register_size = findTable(tables, "register_size")) {
+    function.register_size = expectInt(*register_size, "register_size");
+  }
+  return function;
+}
+
+/**
+ * @brief text[pos] 의 '[' 부터 짝이 맞는 ']' 까지 따옴표 안의 이름들을 names 에 넣는다.
+ *        줄바꿈, # 주석, 따옴표 안의 \ escape 를 건너뛴다. ']' 다음 위치 (닫히지 않았으면 text 끝)
+ */
+size_t readNameList(std::string_view text, size_t pos, NameSet* names) {
+  std::string name;
+  char quote = 0;
+  for (++pos; pos < text.size(); ++pos) {
+    const char c = text[pos];
+    if (quote) {
+      if (c == '\\' && pos + 1 < text.size()) {
+        name += text[++pos];
+      } else if (c == quote) {
+        names->insert(std::move(name));
+        name.clear();
+        quote = 0;
+      } else {
+        name += c;
+      }
+    } else if (c == '"' || c == '\'') {
+      quote = c;
+    } else if (c == '#') {
+      pos = std::min(text.find('\n', pos), text.size() - 1);
+    } else if (c == ']') {
+      return pos + 1;
+    }
+  }
+  return text.size();
+}
+
+}  // namespace
+
+const BytecodeFunction* Bytecode::find(std::string_view name) const {
+  for (const BytecodeFunction& function : functions) {
+    if (function.name == name) {
+      return &function;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<Constant> decodeConstants(const vm::Value& root, tensor::TensorLoader& loader,
+                                      StringTable& strings) {
+  std::vector<Constant> constants;
+  for (const vm::Value& item : expectSequence(root, "constants")) {
+    constants.push_back(toConstant(item, loader, strings));
+  }
+  return constants;
+}
+
+/**
+ * @brief (version, (name, code, schema), ...). v3 이하는 앞의 version 이 없다
+ */
+Bytecode decodeBytecode(const vm::Value& root, tensor::TensorLoader& loader) {
+  Bytecode bytecode;
+  const vm::Sequence& items = expectTuple(root, 0, "root");
+  size_t begin              = 0;
+  if (!items.empty() && items[0].isInt()) {
+    bytecode.version = items[0].toInt();
+    begin            = 1;
+  }
+  for (size_t i = begin; i < items.size; ++i) {
+    bytecode.functions.push_back(decodeFunction(items[i], loader, bytecode.strings));
+  }
+  return bytecode;
+}
+
+std::vector<SourceFile> readSources(const parser::TorchParser& parser) {
+  std::vector<SourceFile> sources;
+  const size_t prefix = parser.getModelName().size() + 1;
+  for (const parser::ZipEntry* entry : parser.getCodeEntries()) {
+    parser::ZipRecord record = parser.getArchive().read(*entry);
+    sources.push_back({entry->name.substr(prefix), std::string(record.view())});
+  }
+  return sources;
+}
+
+ClassMemberTable readClassMembers(const std::vector<SourceFile>& sources) {
+  ClassMemberTable table;
+  for (const SourceFile& source : sources) {
+    std::string qualifier = source.path;
+    if (qualifier.compare(0, 5, "code/") == 0) {
+      qualifier.erase(0, 5);
+    }
+    if (qualifier.size() > 3 && qualifier.compare(qualifier.size() - 3, 3, ".py") == 0) {
+      qualifier.resize(qualifier.size() - 3);
+    }
+    std::replace(qualifier.begin(), qualifier.end(), '/', '.');
+
+    // 줄 머리만 보고, 목록은 readNameList 가 줄을 넘어 ']' 까지 읽는다
+    std::string_view text = source.text;
+    ClassMembers* current = nullptr;
+    size_t begin          = 0;
+    while (begin < text.size()) {
+      size_t end            = std::min(text.find('\n', begin), text.size());
+      std::string_view line = text.substr(begin, end - begin);
+      const size_t indent   = line.find_first_not_of(" \t");
+      if (line.compare(0, 6, "class ") == 0) {
+        const size_t name_end = line.find_first_of("(:", 6);
+        current = &table[qualifier + "." + std::string(line.substr(6, name_end - 6))];
+      } else if (indent == 0 && line[0] != '#') {
+        // 들여쓰지 않은 다른 문장이면 class 본문이 끝났다
+        current = nullptr;
+      } else if (current && indent != std::string_view::npos && indent > 0) {
+        line           = line.substr(indent);
+        NameSet* names = nullptr;
+        if (line.compare(0, 14, "__parameters__") == 0) {
+          names = &current->parameters;
+        } else if (line.compare(0, 11, "__buffers__") == 0) {
+          names = &current->buffers;
+        }
+        const size_t open = names ? line.find('[') : std::string_view::npos;
+        if (open != std::string_view::npos) {
+          const size_t close = readNameList(text, line.data() + open - text.data(), names);
+          end                = std::min(text.find('\n', close), text.size());
+        }
+      }
+      begin = end + 1;
+    }
+  }
+  return table;
+}
+
+ScriptModel::ScriptModel(const std::string& file_name, size_t num_threads)
+    : parser_(std::make_unique<parser::TorchParser>()) {
+  parser_->read(file_name);
+  data_loader_ = std::make_unique<tensor::TensorLoader>(*parser_, num_threads, "data");
+  // bytecode.pkl 의 텐서 상수도 constants/ 를 가리킨다. loader 를 나누면 같은 key 가 두 번 읽힌다
+  constants_loader_ = std::make_unique<tensor::TensorLoader>(*parser_, num_threads, "constants");
+
+  // 섹션마다 PickleVM 이 따로라 서로 기다릴 일이 없다 (constants 와 bytecode 는 storage() 에서만
+  // 잠깐 락을 잡는다). data.pkl 만은 실행을 마친 뒤 code/ 의 클래스 선언으로 parameter / buffer 를
+  // 나누므로 그때 code 섹션을 기다린다 (작아서 먼저 끝난다)
+  auto decode_code = [this] {
+    sources_       = readSources(*parser_);
+    class_members_ = readClassMembers(sources_);
+  };
+  std::shared_future<void> code = std::async(std::launch::async, decode_code).share();
+
+  auto decode_data = [this, code] {
+    // persistent id 가 나오는 대로 storage 읽기를 pool 에 건다. 끝을 기다리지는 않는다
+    // (data() 가 call_once 로 기다린다)
+    tensor::PrefetchVisitor prefetch(*data_loader_);
+    auto build = [&](const vm::Value& root) {
+      code.wait();
+      const ClassMemberTable* members = class_members_.empty() ? nullptr : &class_members_;
+      graph_ = std::make_unique<ModuleGraph>(root, *data_loader_, members);
+    };
+    if (parser_->getDataEntry().isStored()) {
+      vm::PickleVM vm(parser_->getDataView());
+      vm.setVisitor(&prefetch);
+      build(vm.load());
+      return;
+    }
+    // 압축된 data.pkl 은 통째로 풀지 않고 inflate 되는 chunk 를 바로 실행한다
+    vm::PickleVM vm(&prefetch);
+    parser_->streamRecord("data.pkl",
+                          [&vm](const char* bytes, size_t size) { vm.feed(bytes, size); });
+    build(vm.finish());
+  };
+
+  std::vector<std::shared_future<void>> sections = {code};
+  sections.push_back(std::async(std::launch::async, decode_data).share());
+  if (parser_->hasConstants()) {
+    sections.push_back(std::async(std::launch::async, [this] {
+                         vm::PickleVM vm(parser_->getConstantsView());
+                         constants_ =
+                             decodeConstants(vm.load(), *constants_loader_, constant_strings_);
+                       }).share());
+  }
+  if (parser_->hasBytecode()) {
+    sections.push_back(std::async(std::launch::async, [this] {
+                         vm::PickleVM vm(parser_->getBytecodeView());
+                         bytecode_ = decodeBytecode(vm.load(), *constants_loader_);
+                       }).share());
+  }
+
+  std::exception_ptr first_error;
+  for (const std::shared_future<void>& section : sections) {
+    try {
+      section.get();
+    } catch (...) {
+      if (!first_error) {
+        first_error = std::current_exception();
+      }
+    }
+  }
+  if (first_error) {
+    std::rethrow_exception(first_error);
+  }
+}
+
+ScriptModel::~ScriptModel() = default;
+
+const SourceFile* ScriptModel::source(std::string_view path) const {
+  for (const SourceFile& file : sources_) {
+    if (file.path == path) {
+      return &file;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace model
+}  // namespace tfe
@@ -0,0 +1,24 @@
+#include "model/string_table.h"
+
+namespace tfe {
+namespace model {
+
+Symbol StringTable::intern(std::string_view s) {
+  auto it = index_.find(s);
+  if (it != index_.end()) {
+    return it->second;
+  }
+  Symbol symbol = static_cast<Symbol>(strings_.size());
+  strings_.emplace_back(s);
+  bytes_ += s.size();
+  index_.emplace(std::string_view(strings_.back()), symbol);
+  return symbol;
+}
+
+Symbol StringTable::find(std::string_view s) const {
+  auto it = index_.find(s);
+  return it == index_.end() ? kInvalid : it->second;
+}
+
+}  // namespace model
+}  // namespace tfe
@@ -0,0 +1,354 @@
+#include "parser/parser_tflite.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "error/error.h"
+#include "util/load_stats.h"
+
+namespace tfe {
+namespace parser {
+
+namespace {
+
+constexpr char kIdentifier[4] = {'T', 'F', 'L', '3'};
+
+// schema.fbs 의 필드 id
+constexpr uint16_t kModelVersion       = 0;
+constexpr uint16_t kModelOperatorCodes = 1;
+constexpr uint16_t kModelSubgraphs     = 2;
+constexpr uint16_t kModelDescription   = 3;
+constexpr uint16_t kModelBuffers       = 4;
+
+constexpr uint16_t kCodeDeprecatedBuiltin = 0;
+constexpr uint16_t kCodeCustom            = 1;
+constexpr uint16_t kCodeBuiltin           = 3;
+
+constexpr uint16_t kSubgraphTensors   = 0;
+constexpr uint16_t kSubgraphInputs    = 1;
+constexpr uint16_t kSubgraphOutputs   = 2;
+constexpr uint16_t kSubgraphOperators = 3;
+constexpr uint16_t kSubgraphName      = 4;
+
+constexpr uint16_t kTensorShape        = 0;
+constexpr uint16_t kTensorType         = 1;
+constexpr uint16_t kTensorBuffer       = 2;
+constexpr uint16_t kTensorName         = 3;
+constexpr uint16_t kTensorQuantization = 4;
+constexpr uint16_t kQuantizationScale  = 2;
+
+constexpr uint16_t kBufferData   = 0;
+constexpr uint16_t kBufferOffset = 1;
+constexpr uint16_t kBufferSize   = 2;
+
+constexpr uint16_t kOperatorOpcode  = 0;
+constexpr uint16_t kOperatorInputs  = 1;
+constexpr uint16_t kOperatorOutputs = 2;
+constexpr uint16_t kOperatorOptions = 4;
+
+[[noreturn]] void malformed(const std::string& what) {
+  throw error::ParserException(error::PARSE_ERROR, "Malformed tflite flatbuffer: " + what);
+}
+
+inline uint32_t load32(const char* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint16_t load16(const char* p) {
+  uint16_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+}  // namespace
+
+FlatTable::FlatTable(const char* base, size_t size, uint32_t offset)
+    : base_(base), size_(size), offset_(offset) {
+  if (static_cast<uint64_t>(offset) + 4 > size) {
+    malformed("table offset out of range");
+  }
+  int32_t soffset;
+  std::memcpy(&soffset, base + offset, sizeof(soffset));
+  const int64_t vtable = static_cast<int64_t>(offset) - soffset;
+  if (vtable < 0 || static_cast<uint64_t>(vtable) + 4 > size) {
+    malformed("vtable offset out of range");
+  }
+  vtable_      = static_cast<uint32_t>(vtable);
+  vtable_size_ = load16(base + vtable_);
+  if (vtable_size_ < 4 || vtable_size_ % 2 != 0 ||
+      static_cast<uint64_t>(vtable_) + vtable_size_ > size) {
+    malformed("bad vtable");
+  }
+}
+
+uint32_t FlatTable::fieldOffset(uint16_t field, size_t bytes) const {
+  const uint32_t slot = 4 + 2u * field;
+  if (!base_ || slot + 2 > vtable_size_) {
+    return 0;
+  }
+  const uint16_t relative = load16(base_ + vtable_ + slot);
+  if (relative == 0) {
+    return 0;
+  }
+  const uint64_t at = static_cast<uint64_t>(offset_) + relative;
+  if (at + bytes > size_) {
+    malformed("field out of range");
+  }
+  return static_cast<uint32_t>(at);
+}
+
+uint32_t FlatTable::indirect(uint16_t field) const {
+  const uint32_t at = fieldOffset(field, 4);
+  if (at == 0) {
+    return 0;
+  }
+  const uint64_t target = static_cast<uint64_t>(at) + load32(base_ + at);
+  if (target + 4 > size_) {
+    malformed("offset out of range");
+  }
+  return static_cast<uint32_t>(target);
+}
+
+const char* FlatTable::vectorData(uint16_t field, size_t element, uint32_t* size) const {
+  const uint32_t at = indirect(field);
+  if (at == 0) {
+    *size = 0;
+    return nullptr;
+  }
+  const uint32_t length = load32(base_ + at);
+  if (static_cast<uint64_t>(at) + 4 + static_cast<uint64_t>(length) * element > size_) {
+    malformed("vector out of range");
+  }
+  *size = length;
+  return base_ + at + 4;
+}
+
+FlatTable FlatTable::table(uint16_t field) const {
+  const uint32_t at = indirect(field);
+  return at == 0 ? FlatTable() : FlatTable(base_, size_, at);
+}
+
+std::string_view FlatTable::string(uint16_t field) const {
+  uint32_t length  = 0;
+  const char* data = vectorData(field, 1, &length);
+  return data ? std::string_view(data, length) : std::string_view();
+}
+
+std::vector<FlatTable> FlatTable::tables(uint16_t field) const {
+  uint32_t count   = 0;
+  const char* data = vectorData(field, 4, &count);
+  std::vector<FlatTable> out;
+  out.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint32_t at = static_cast<uint32_t>(data - base_) + 4 * i;
+    out.emplace_back(base_, size_, at + load32(data + 4 * i));
+  }
+  return out;
+}
+
+const char* tfliteTypeToString(TFLiteType type) {
+  switch (type) {
+    case TFLiteType::FLOAT32:
+      return "float32";
+    case TFLiteType::FLOAT16:
+      return "float16";
+    case TFLiteType::INT32:
+      return "int32";
+    case TFLiteType::UINT8:
+      return "uint8";
+    case TFLiteType::INT64:
+      return "int64";
+    case TFLiteType::STRING:
+      return "string";
+    case TFLiteType::BOOL:
+      return "bool";
+    case TFLiteType::INT16:
+      return "int16";
+    case TFLiteType::INT8:
+      return "int8";
+    case TFLiteType::FLOAT64:
+      return "float64";
+  }
+  return "unknown";
+}
+
+struct TFLiteParser::Mapping {
+  char* base  = nullptr;
+  size_t size = 0;
+
+  ~Mapping() {
+    if (base) {
+      munmap(base, size);
+    }
+  }
+};
+
+TFLiteParser::TFLiteParser() {}
+
+TFLiteParser::~TFLiteParser() {}
+
+/**
+ * @brief .tflite 파일을 읽기 전용으로 매핑한다. view 를 adopt 한 텐서에 쓰려면 Storage::mutableData()
+ * @note pipeline: read() -> parse()
+ * @date 2026-10-18
+ * @param file_name
+ */
+void TFLiteParser::read(const std::string& file_name) {
+  file_name_ = file_name;
+  subgraphs_.clear();
+  buffers_.clear();
+
+  int fd = -1;
+  {
+    util::ScopedLoadPhase phase(util::LoadPhase::OPEN);
+    fd = ::open(file_name.c_str(), O_RDONLY);
+  }
+  if (fd < 0) {
+    throw error::ParserException(error::OPEN_FAILED, "Failed to open file: " + file_name);
+  }
+  struct stat st;
+  int stat_result = 0;
+  {
+    util::ScopedLoadPhase phase(util::LoadPhase::STAT);
+    stat_result = fstat(fd, &st);
+  }
+  if (stat_result != 0 || st.st_size <= 0) {
+    ::close(fd);
+    throw error::ParserException(error::OPEN_FAILED, "Failed to stat file: " + file_name);
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  void* mapped      = nullptr;
+  {
+    util::ScopedLoadPhase phase(util::LoadPhase::MMAP, size);
+    mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    throw error::ParserException(error::OPEN_FAILED, "Failed to mmap file: " + file_name);
+  }
+  mapping_       = std::make_shared<Mapping>();
+  mapping_->base = static_cast<char*>(mapped);
+  mapping_->size = size;
+  file_size_     = std::to_string(size);
+  byte_order_    = "little";
+
+  parse();
+}
+
+/**
+ * @brief Model table 을 따라 operator_codes, buffers, subgraphs 의 위치를 모은다
+ * @note 텐서 / op 의 index 는 여기서 모두 범위를 확인하므로 호출자는 다시 보지 않아도 된다
+ * @date 2026-10-18
+ */
+void TFLiteParser::parse() {
+  const char* base  = mapping_->base;
+  const size_t size = mapping_->size;
+  if (size < 8 || std::memcmp(base + 4, kIdentifier, sizeof(kIdentifier)) != 0) {
+    throw error::ParserException(error::PARSE_ERROR, "Not a tflite file: " + file_name_);
+  }
+  const FlatTable model(base, size, load32(base));
+  version_ = std::to_string(model.scalar<uint32_t>(kModelVersion, 0));
+  data_    = std::string(model.string(kModelDescription));
+
+  std::vector<int32_t> builtins;
+  std::vector<std::string_view> customs;
+  for (const FlatTable& code : model.tables(kModelOperatorCodes)) {
+    // 127 을 넘는 op 부터는 builtin_code 에만 있고, 옛 파일은 deprecated_builtin_code 에만 있다
+    const int32_t deprecated = code.scalar<int8_t>(kCodeDeprecatedBuiltin, 0);
+    builtins.push_back(std::max(deprecated, code.scalar<int32_t>(kCodeBuiltin, 0)));
+    customs.push_back(code.string(kCodeCustom));
+  }
+  buffers_ = model.tables(kModelBuffers);
+
+  for (const FlatTable& table : model.tables(kModelSubgraphs)) {
+    TFLiteSubgraph subgraph;
+    subgraph.name = table.string(kSubgraphName);
+    for (const FlatTable& t : table.tables(kSubgraphTensors)) {
+      TFLiteTensor tensor;
+      tensor.name   = t.string(kTensorName);
+      tensor.shape  = t.vector<int32_t>(kTensorShape);
+      tensor.type   = static_cast<TFLiteType>(t.scalar<int8_t>(kTensorType, 0));
+      tensor.buffer = t.scalar<uint32_t>(kTensorBuffer, 0);
+      if (tensor.buffer != 0 && tensor.buffer >= buffers_.size()) {
+        malformed("tensor " + std::string(tensor.name) + " has buffer " +
+                  std::to_string(tensor.buffer));
+      }
+      const FlatTable quantization = t.table(kTensorQuantization);
+      tensor.quantized =
+          quantization.valid() && !quantization.vector<float>(kQuantizationScale).empty();
+      subgraph.tensors.push_back(tensor);
+    }
+
+    const int64_t tensors = static_cast<int64_t>(subgraph.tensors.size());
+
+    auto checkIndices = [&](const FlatVector<int32_t>& indices, bool optional) {
+      for (uint32_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] >= tensors || indices[i] < (optional ? -1 : 0)) {
+          malformed("tensor index " + std::to_string(indices[i]) + " out of range");
+        }
+      }
+      return indices;
+    };
+    subgraph.inputs  = checkIndices(table.vector<int32_t>(kSubgraphInputs), false);
+    subgraph.outputs = checkIndices(table.vector<int32_t>(kSubgraphOutputs), false);
+    for (const FlatTable& o : table.tables(kSubgraphOperators)) {
+      const uint32_t index = o.scalar<uint32_t>(kOperatorOpcode, 0);
+      if (index >= builtins.size()) {
+        malformed("opcode index " + std::to_string(index) + " out of range");
+      }
+      TFLiteOperator op;
+      op.builtin     = builtins[index];
+      op.custom_code = customs[index];
+      op.inputs      = checkIndices(o.vector<int32_t>(kOperatorInputs), true);
+      op.outputs     = checkIndices(o.vector<int32_t>(kOperatorOutputs), false);
+      op.options     = o.table(kOperatorOptions);
+      subgraph.operators.push_back(op);
+    }
+    subgraphs_.push_back(std::move(subgraph));
+  }
+  if (subgraphs_.empty()) {
+    malformed("no subgraph");
+  }
+}
+
+std::string TFLiteParser::getVersion() const { return version_; }
+
+std::string TFLiteParser::getByteOrder() const { return byte_order_; }
+
+std::string TFLiteParser::getFileSize() const { return file_size_; }
+
+std::string TFLiteParser::getData() const { return data_; }
+
+std::string_view TFLiteParser::buffer(uint32_t index) const {
+  if (index >= buffers_.size()) {
+    return std::string_view();
+  }
+  const FlatTable& table   = buffers_[index];
+  FlatVector<uint8_t> data = table.vector<uint8_t>(kBufferData);
+  if (!data.empty()) {
+    return std::string_view(data.data(), data.size());
+  }
+  // offset 이 1 이하면 비어 있다는 뜻이다 (converter 가 채울 자리로 쓴다)
+  const uint64_t offset = table.scalar<uint64_t>(kBufferOffset, 0);
+  const uint64_t bytes  = table.scalar<uint64_t>(kBufferSize, 0);
+  if (offset <= 1) {
+    return std::string_view();
+  }
+  if (offset + bytes > mapping_->size || offset + bytes < offset) {
+    malformed("buffer " + std::to_string(index) + " out of range");
+  }
+  return std::string_view(mapping_->base + offset, bytes);
+}
+
+const char* TFLiteParser::base() const { return mapping_ ? mapping_->base : nullptr; }
+
+size_t TFLiteParser::size() const { return mapping_ ? mapping_->size : 0; }
+
+}  // namespace parser
+}  // namespace tfe
@@ -1,11 +1,10 @@
 #include "parser/parser_torch.h"
 
-#include <sys/stat.h>
-
 #include <cstring>
 #include <iostream>
 
 #include "error/error.h"
+#include "util/load_stats.h"
 
 namespace tfe {
 namespace parser {
@@ -21,28 +20,25 @@ TorchParser::~TorchParser() {}
  * @param file_name
  */
 void TorchParser::read(const std::string& file_name) {
-  struct stat st;
-  if (stat(file_name.c_str(), &st) == 0) {
-    file_size_ = std::to_string(st.st_size);
+  archive_    = std::make_shared<ZipArchive>(file_name);
+  file_size_  = std::to_string(archive_->size());
+  model_name_ = "";
+
+  // 아카이브 루트 디렉터리 이름은 저장 당시 파일명이라 rename 된 파일에서는 다를 수 있다
+  const auto& entries = archive_->entries();
+  if (!entries.empty()) {
+    size_t slash = entries.front().name.find('/');
+    if (slash != std::string::npos) {
+      model_name_ = entries.front().name.substr(0, slash);
+    }
   }
-
-  unzFile zipfile = unzOpen(file_name.c_str());
-  if (!zipfile) {
-    throw error::ParserException(error::OPEN_FAILED, "Failed to open file: " + file_name);
+  if (model_name_.empty()) {
+    size_t last_slash = file_name.find_last_of("/\\");
+    size_t last_dot   = file_name.find_last_of(".");
+    model_name_       = file_name.substr(last_slash + 1, last_dot - last_slash - 1);
   }
 
-  size_t last_slash = file_name.find_last_of("/\\");
-  size_t last_dot   = file_name.find_last_of(".");
-  model_name_       = file_name.substr(last_slash + 1, last_dot - last_slash - 1);
-
-  try {
-    parse(zipfile);
-  } catch (const error::ParserException& e) {
-    unzClose(zipfile);
-    throw;
-  }
-
-  unzClose(zipfile);
+  parse();
 }
 
 /**
@@ -51,15 +47,39 @@ void TorchParser::read(const std::string& file_name) {
  * https://github.com/apache/tvm/blob/main/include/tvm/te/tensor.h 참고
  * @date 2025-10-02
  */
-void TorchParser::parse(unzFile zipfile) {
-  try {
-    version_ = read_file_from_zip(zipfile, model_name_ + "/version");
-    byte_order_ = read_file_from_zip(zipfile, model_name_ + "/byteorder");
-    data_ = read_file_from_zip(zipfile, model_name_ + "/data.pkl");
-
-  } catch (const error::ParserException& e) {
-    unzClose(zipfile);
-    throw;
+void TorchParser::parse() {
+  util::ScopedLoadPhase phase(util::LoadPhase::SECTIONS);
+  version_     = read_file_from_zip(model_name_ + "/version");
+  byte_order_  = read_file_from_zip(model_name_ + "/byteorder");
+
+  // STORED 면 매핑 view 라 바로 잡고, DEFLATED 면 getDataView() 가 처음 불릴 때 푼다.
+  // ScriptModel 처럼 streamRecord() 로 흘려 읽는 쪽은 data.pkl 전체를 메모리에 올리지 않는다
+  data_entry_ = &getRecordEntry("data.pkl");
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    data_record_ = data_entry_->isStored() ? archive_->read(*data_entry_) : ZipRecord();
+  }
+
+  // 나머지 섹션은 위치만 잡아 둔다. STORED 라면 매핑 view 라 비용이 없고 디코딩은 호출자가 따로 한다
+  has_constants_ = false;
+  has_bytecode_  = false;
+  if (const ZipEntry* entry = findRecord("constants.pkl")) {
+    constants_record_ = archive_->read(*entry);
+    has_constants_    = true;
+  }
+  if (const ZipEntry* entry = findRecord("bytecode.pkl")) {
+    bytecode_record_ = archive_->read(*entry);
+    has_bytecode_    = true;
+  }
+
+  code_entries_.clear();
+  const std::string code_dir = model_name_ + "/code/";
+  for (const ZipEntry& entry : archive_->entries()) {
+    const std::string& name = entry.name;
+    if (name.size() > code_dir.size() + 3 && name.compare(0, code_dir.size(), code_dir) == 0 &&
+        name.compare(name.size() - 3, 3, ".py") == 0) {
+      code_entries_.push_back(&entry);
+    }
   }
 }
 
@@ -69,33 +89,68 @@ std::string TorchParser::getByteOrder() const { return byte_order_; }
 
 std::string TorchParser::getFileSize() const { return file_size_; }
 
-std::string TorchParser::getData() const { return data_; }
+std::string TorchParser::getData() const { return std::string(getDataView()); }
 
-std::string TorchParser::read_file_from_zip(unzFile zipfile, const std::string& internal_path) {
-  if (unzLocateFile(zipfile, internal_path.c_str(), 0) != UNZ_OK) {
-    throw error::ParserException(error::ZIP_ERROR, "File not found in ZIP: " + internal_path);
+/**
+ * @brief data.pkl 을 복사 없이 돌려준다 (STORED 면 mmap 영역, 아니면 inflate 버퍼)
+ */
+std::string_view TorchParser::getDataView() const {
+  if (!data_entry_) {
+    throw error::ParserException(error::READ_FAILED, "Archive is not opened");
+  }
+  std::lock_guard<std::mutex> lock(data_mutex_);
+  if (data_record_.empty() && data_entry_->uncompressed_size > 0) {
+    data_record_ = archive_->read(*data_entry_);
   }
+  return data_record_.view();
+}
 
-  if (unzOpenCurrentFile(zipfile) != UNZ_OK) {
-    throw error::ParserException(error::ZIP_ERROR, "Failed to open file: " + internal_path);
+/**
+ * @brief 모델 디렉터리 기준 경로로 엔트리를 읽는다. e.g. getRecord("data/0")
+ */
+ZipRecord TorchParser::getRecord(const std::string& internal_path) const {
+  if (!archive_) {
+    throw error::ParserException(error::READ_FAILED, "Archive is not opened");
   }
+  return archive_->read(model_name_ + "/" + internal_path);
+}
 
-  unz_file_info file_info;
-  if (unzGetCurrentFileInfo(zipfile, &file_info, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK) {
-    unzCloseCurrentFile(zipfile);
-    throw error::ParserException(error::ZIP_ERROR, "Failed to get file info: " + internal_path);
+/**
+ * @brief 모델 디렉터리 기준 경로의 엔트리. 없으면 nullptr
+ */
+const ZipEntry* TorchParser::findRecord(const std::string& internal_path) const {
+  if (!archive_) {
+    throw error::ParserException(error::READ_FAILED, "Archive is not opened");
   }
+  return archive_->find(model_name_ + "/" + internal_path);
+}
 
-  std::vector<char> buffer(file_info.uncompressed_size);
-  int bytes_read = unzReadCurrentFile(zipfile, buffer.data(), buffer.size());
-  if (bytes_read < 0) {
-    unzCloseCurrentFile(zipfile);
-    throw error::ParserException(error::READ_FAILED, "Failed to read file: " + internal_path);
+/**
+ * @brief 모델 디렉터리 기준 경로의 엔트리. 없으면 ZIP_ERROR
+ */
+const ZipEntry& TorchParser::getRecordEntry(const std::string& internal_path) const {
+  const ZipEntry* entry = findRecord(internal_path);
+  if (!entry) {
+    throw error::ParserException(error::ZIP_ERROR,
+                                 "File not found in ZIP: " + model_name_ + "/" + internal_path);
   }
+  return *entry;
+}
 
-  unzCloseCurrentFile(zipfile);
+/**
+ * @brief 엔트리를 chunk 단위로 흘려보낸다. e.g. data.pkl 을 PickleVM::feed 로 바로 넘기는 경우
+ */
+void TorchParser::streamRecord(const std::string& internal_path,
+                               const ZipArchive::ChunkSink& sink) const {
+  archive_->stream(getRecordEntry(internal_path), sink);
+}
 
-  std::string result(buffer.data(), bytes_read);
+/**
+ * @brief version, byteorder 같은 작은 텍스트 엔트리 전용 (끝의 개행 제거)
+ */
+std::string TorchParser::read_file_from_zip(const std::string& internal_path) {
+  ZipRecord record = archive_->read(internal_path);
+  std::string result(record.view());
 
   size_t end = result.find_last_not_of("\n\r");
   if (end != std::string::npos) {
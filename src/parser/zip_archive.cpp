@@ -0,0 +1,414 @@
+#include "parser/zip_archive.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "error/error.h"
+#include "util/load_stats.h"
+
+namespace tfe {
+namespace parser {
+
+namespace {
+
+constexpr uint32_t kLocalHeaderSig       = 0x04034b50;
+constexpr uint32_t kCentralHeaderSig     = 0x02014b50;
+constexpr uint32_t kEndOfCentralSig      = 0x06054b50;
+constexpr uint32_t kZip64EndOfCentralSig = 0x06064b50;
+constexpr uint32_t kZip64LocatorSig      = 0x07064b50;
+constexpr uint16_t kZip64ExtraId         = 0x0001;
+
+constexpr size_t kLocalHeaderSize   = 30;
+constexpr size_t kCentralHeaderSize = 46;
+constexpr size_t kEndOfCentralSize  = 22;
+constexpr size_t kZip64LocatorSize  = 20;
+constexpr size_t kZip64EndSize      = 56;
+constexpr size_t kMaxCommentSize    = 0xFFFF;
+
+inline uint16_t loadLE16(const char* p) {
+  uint8_t b[2];
+  std::memcpy(b, p, 2);
+  return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+inline uint32_t loadLE32(const char* p) {
+  uint8_t b[4];
+  std::memcpy(b, p, 4);
+  return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+         (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+inline uint64_t loadLE64(const char* p) {
+  return static_cast<uint64_t>(loadLE32(p)) | (static_cast<uint64_t>(loadLE32(p + 4)) << 32);
+}
+
+}  // namespace
+
+/**
+ * @brief 아카이브 전체를 매핑하고 central directory 를 읽는다
+ * @date 2026-10-18
+ * @param file_name
+ */
+ZipArchive::ZipArchive(const std::string& file_name) : file_name_(file_name) {
+  {
+    util::ScopedLoadPhase phase(util::LoadPhase::OPEN);
+    fd_ = ::open(file_name.c_str(), O_RDONLY);
+  }
+  if (fd_ < 0) {
+    throw error::ParserException(error::OPEN_FAILED, "Failed to open file: " + file_name);
+  }
+
+  struct stat st;
+  int stat_result = 0;
+  {
+    util::ScopedLoadPhase phase(util::LoadPhase::STAT);
+    stat_result = fstat(fd_, &st);
+  }
+  if (stat_result != 0 || st.st_size <= 0) {
+    ::close(fd_);
+    throw error::ParserException(error::OPEN_FAILED, "Failed to stat file: " + file_name);
+  }
+  size_ = static_cast<size_t>(st.st_size);
+
+  void* mapped = nullptr;
+  {
+    util::ScopedLoadPhase phase(util::LoadPhase::MMAP, size_);
+    mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  }
+  if (mapped == MAP_FAILED) {
+    ::close(fd_);
+    throw error::ParserException(error::OPEN_FAILED, "Failed to mmap file: " + file_name);
+  }
+  base_ = static_cast<const char*>(mapped);
+
+  try {
+    readCentralDirectory();
+  } catch (const error::ParserException& e) {
+    munmap(const_cast<char*>(base_), size_);
+    ::close(fd_);
+    throw;
+  }
+}
+
+ZipArchive::~ZipArchive() {
+  if (base_) {
+    munmap(const_cast<char*>(base_), size_);
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+/**
+ * @brief EOCD (+ ZIP64 EOCD) 를 찾아 central directory 전체를 entries_ 로 옮긴다
+ * @note PyTorch 는 4GB 가 넘는 아카이브에 ZIP64 레코드를 쓴다
+ */
+void ZipArchive::readCentralDirectory() {
+  util::ScopedLoadPhase phase(util::LoadPhase::CENTRAL_DIRECTORY);
+  if (size_ < kEndOfCentralSize) {
+    throw error::ParserException(error::ZIP_ERROR, "Not a ZIP archive: " + file_name_);
+  }
+
+  size_t search_floor = size_ > kEndOfCentralSize + kMaxCommentSize
+                            ? size_ - kEndOfCentralSize - kMaxCommentSize
+                            : 0;
+  size_t eocd         = std::string::npos;
+  for (size_t pos = size_ - kEndOfCentralSize + 1; pos-- > search_floor;) {
+    if (loadLE32(base_ + pos) == kEndOfCentralSig) {
+      eocd = pos;
+      break;
+    }
+  }
+  if (eocd == std::string::npos) {
+    throw error::ParserException(error::ZIP_ERROR,
+                                 "End of central directory not found: " + file_name_);
+  }
+
+  uint64_t entry_count = loadLE16(base_ + eocd + 10);
+  uint64_t cd_size     = loadLE32(base_ + eocd + 12);
+  uint64_t cd_offset   = loadLE32(base_ + eocd + 16);
+
+  if (eocd >= kZip64LocatorSize &&
+      loadLE32(base_ + eocd - kZip64LocatorSize) == kZip64LocatorSig) {
+    uint64_t zip64_eocd = loadLE64(base_ + eocd - kZip64LocatorSize + 8);
+    if (size_ < kZip64EndSize || zip64_eocd > size_ - kZip64EndSize ||
+        loadLE32(base_ + zip64_eocd) != kZip64EndOfCentralSig) {
+      throw error::ParserException(error::ZIP_ERROR, "Corrupt ZIP64 end record: " + file_name_);
+    }
+    entry_count = loadLE64(base_ + zip64_eocd + 32);
+    cd_size     = loadLE64(base_ + zip64_eocd + 40);
+    cd_offset   = loadLE64(base_ + zip64_eocd + 48);
+  }
+
+  // 덧셈이 넘치지 않도록 남은 크기와 비교한다
+  if (cd_offset > size_ || cd_size > size_ - cd_offset) {
+    throw error::ParserException(error::ZIP_ERROR,
+                                 "Central directory out of range: " + file_name_);
+  }
+
+  entries_.clear();
+  entries_.reserve(entry_count);
+
+  const char* p   = base_ + cd_offset;
+  const char* end = p + cd_size;
+  for (uint64_t i = 0; i < entry_count; ++i) {
+    if (end - p < static_cast<ptrdiff_t>(kCentralHeaderSize) || loadLE32(p) != kCentralHeaderSig) {
+      throw error::ParserException(error::ZIP_ERROR, "Corrupt central directory: " + file_name_);
+    }
+
+    uint16_t name_len    = loadLE16(p + 28);
+    uint16_t extra_len   = loadLE16(p + 30);
+    uint16_t comment_len = loadLE16(p + 32);
+    if (end - p < static_cast<ptrdiff_t>(kCentralHeaderSize + name_len + extra_len + comment_len)) {
+      throw error::ParserException(error::ZIP_ERROR, "Corrupt central directory: " + file_name_);
+    }
+
+    ZipEntry entry;
+    entry.method              = loadLE16(p + 10);
+    entry.crc32               = loadLE32(p + 16);
+    entry.compressed_size     = loadLE32(p + 20);
+    entry.uncompressed_size   = loadLE32(p + 24);
+    entry.local_header_offset = loadLE32(p + 42);
+    entry.name.assign(p + kCentralHeaderSize, name_len);
+
+    // ZIP64 extra field: 0xFFFFFFFF 로 표시된 값만 순서대로 들어있다
+    const char* extra     = p + kCentralHeaderSize + name_len;
+    const char* extra_end = extra + extra_len;
+    while (extra_end - extra >= 4) {
+      uint16_t id           = loadLE16(extra);
+      uint16_t size         = loadLE16(extra + 2);
+      const char* field     = extra + 4;
+      const char* field_end = field + std::min<ptrdiff_t>(size, extra_end - field);
+      if (id == kZip64ExtraId) {
+        auto take64 = [&](uint64_t& value) {
+          if (value == 0xFFFFFFFFu && field_end - field >= 8) {
+            value = loadLE64(field);
+            field += 8;
+          }
+        };
+        take64(entry.uncompressed_size);
+        take64(entry.compressed_size);
+        take64(entry.local_header_offset);
+      }
+      extra += 4 + size;
+    }
+
+    entry.data_offset = resolveDataOffset(entry);
+    entries_.push_back(std::move(entry));
+
+    p += kCentralHeaderSize + name_len + extra_len + comment_len;
+  }
+
+  // entries_ 가 더 이상 재할당되지 않은 뒤에 name 을 가리키는 view 로 색인한다.
+  // 이름이 중복되면 central directory 에서 먼저 나온 엔트리를 쓴다.
+  index_.clear();
+  index_.reserve(entries_.size());
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    index_.emplace(std::string_view(entries_[i].name), i);
+  }
+  phase.setBytes(cd_size, 0);
+  util::LoadStats::global().count(util::LoadCounter::ZIP_ENTRIES, entries_.size());
+}
+
+/**
+ * @brief local header 의 name/extra 길이는 central 쪽과 다를 수 있어 직접 읽어야 한다
+ */
+uint64_t ZipArchive::resolveDataOffset(const ZipEntry& entry) const {
+  uint64_t header = entry.local_header_offset;
+  if (header + kLocalHeaderSize > size_ || loadLE32(base_ + header) != kLocalHeaderSig) {
+    throw error::ParserException(error::ZIP_ERROR, "Corrupt local header: " + entry.name);
+  }
+
+  uint64_t data_offset = header + kLocalHeaderSize + loadLE16(base_ + header + 26) +
+                         loadLE16(base_ + header + 28);
+  if (data_offset + entry.compressed_size > size_) {
+    throw error::ParserException(error::ZIP_ERROR, "Entry out of range: " + entry.name);
+  }
+  return data_offset;
+}
+
+const ZipEntry* ZipArchive::find(std::string_view name) const {
+  auto it = index_.find(name);
+  return it == index_.end() ? nullptr : &entries_[it->second];
+}
+
+/**
+ * @brief STORED 엔트리에 대한 매핑 view. DEFLATED 엔트리는 view 를 줄 수 없다
+ */
+std::string_view ZipArchive::view(const ZipEntry& entry) const {
+  if (!entry.isStored()) {
+    throw error::ParserException(error::ZIP_ERROR, "Entry is compressed: " + entry.name);
+  }
+  return std::string_view(base_ + entry.data_offset, entry.compressed_size);
+}
+
+ZipRecord ZipArchive::read(const ZipEntry& entry) const {
+  if (entry.isStored()) {
+    return ZipRecord(view(entry));
+  }
+  return ZipRecord(inflateEntry(entry));
+}
+
+ZipRecord ZipArchive::read(const std::string& name) const {
+  const ZipEntry* entry = find(name);
+  if (!entry) {
+    throw error::ParserException(error::ZIP_ERROR, "File not found in ZIP: " + name);
+  }
+  return read(*entry);
+}
+
+/**
+ * @brief 엔트리를 chunk_size 단위로 sink 에 넘긴다
+ * @note STORED 는 매핑을 잘라서, DEFLATED 는 chunk 하나 크기의 버퍼로 inflate 하면서 넘기므로
+ * 엔트리 전체를 메모리에 올리지 않는다
+ */
+void ZipArchive::stream(const ZipEntry& entry, const ChunkSink& sink, size_t chunk_size) const {
+  if (chunk_size == 0) {
+    throw error::ParserException(error::READ_FAILED,
+                                 "Stream chunk size must be positive: " + entry.name);
+  }
+  if (entry.isStored()) {
+    std::string_view bytes = view(entry);
+    for (size_t offset = 0; offset < bytes.size(); offset += chunk_size) {
+      size_t size = std::min(chunk_size, bytes.size() - offset);
+      sink(bytes.data() + offset, size);
+    }
+    return;
+  }
+
+  if (entry.method != ZipEntry::kDeflated) {
+    throw error::ParserException(error::ZIP_ERROR,
+                                 "Unsupported compression method " + std::to_string(entry.method) +
+                                     ": " + entry.name);
+  }
+
+  util::ScopedLoadPhase phase(util::LoadPhase::INFLATE, entry.compressed_size,
+                              entry.uncompressed_size);
+  if (phase.active()) {
+    phase.setDetail(entry.name);
+  }
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+    throw error::ParserException(error::READ_FAILED, "Failed to init inflate: " + entry.name);
+  }
+
+  std::vector<char> chunk(chunk_size);
+  const uint64_t max_in = 0x40000000;
+  uint64_t in_left      = entry.compressed_size;
+  stream.next_in        = reinterpret_cast<Bytef*>(const_cast<char*>(base_ + entry.data_offset));
+
+  int ret = Z_OK;
+  try {
+    while (ret != Z_STREAM_END) {
+      if (stream.avail_in == 0 && in_left > 0) {
+        stream.avail_in = static_cast<uInt>(std::min(in_left, max_in));
+        in_left -= stream.avail_in;
+      }
+      stream.next_out  = reinterpret_cast<Bytef*>(chunk.data());
+      stream.avail_out = static_cast<uInt>(chunk.size());
+
+      ret = ::inflate(&stream, Z_NO_FLUSH);
+      if (ret != Z_OK && ret != Z_STREAM_END) {
+        throw error::ParserException(error::READ_FAILED, "Failed to inflate: " + entry.name);
+      }
+
+      size_t produced = chunk.size() - stream.avail_out;
+      if (produced) {
+        sink(chunk.data(), produced);
+      }
+    }
+  } catch (...) {
+    inflateEnd(&stream);
+    throw;
+  }
+
+  uint64_t total = stream.total_out;
+  inflateEnd(&stream);
+  if (total != entry.uncompressed_size) {
+    throw error::ParserException(error::READ_FAILED, "Inflated size mismatch: " + entry.name);
+  }
+}
+
+std::vector<char> ZipArchive::inflateEntry(const ZipEntry& entry) const {
+  std::vector<char> buffer(entry.uncompressed_size);
+  ZipInflater inflater;
+  inflater.inflate(*this, entry, buffer.data());
+  return buffer;
+}
+
+void ZipArchive::readInto(const ZipEntry& entry, char* dst, ZipInflater& inflater) const {
+  if (entry.isStored()) {
+    std::string_view bytes = view(entry);
+    std::memcpy(dst, bytes.data(), bytes.size());
+    return;
+  }
+  inflater.inflate(*this, entry, dst);
+}
+
+struct ZipInflater::State {
+  z_stream stream;
+};
+
+ZipInflater::ZipInflater() : state_(new State) {
+  std::memset(&state_->stream, 0, sizeof(state_->stream));
+  if (inflateInit2(&state_->stream, -MAX_WBITS) != Z_OK) {
+    throw error::ParserException(error::READ_FAILED, "Failed to init inflate");
+  }
+}
+
+ZipInflater::~ZipInflater() { inflateEnd(&state_->stream); }
+
+void ZipInflater::inflate(const ZipArchive& archive, const ZipEntry& entry, char* dst) {
+  if (entry.method != ZipEntry::kDeflated) {
+    throw error::ParserException(error::ZIP_ERROR,
+                                 "Unsupported compression method " + std::to_string(entry.method) +
+                                     ": " + entry.name);
+  }
+
+  util::ScopedLoadPhase phase(util::LoadPhase::INFLATE, entry.compressed_size,
+                              entry.uncompressed_size);
+  if (phase.active()) {
+    phase.setDetail(entry.name);
+  }
+  z_stream& stream = state_->stream;
+  inflateReset(&stream);
+
+  // zlib 의 avail_in/out 은 uInt 라 1GB 단위로 나눠서 넣는다
+  const uint64_t chunk = 0x40000000;
+  uint64_t in_left     = entry.compressed_size;
+  uint64_t out_left    = entry.uncompressed_size;
+  stream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(archive.base_ + entry.data_offset));
+  stream.avail_in = 0;
+  stream.next_out = reinterpret_cast<Bytef*>(dst);
+  stream.avail_out = 0;
+
+  int ret = Z_OK;
+  while (ret == Z_OK) {
+    if (stream.avail_in == 0 && in_left > 0) {
+      stream.avail_in = static_cast<uInt>(std::min(in_left, chunk));
+      in_left -= stream.avail_in;
+    }
+    if (stream.avail_out == 0 && out_left > 0) {
+      stream.avail_out = static_cast<uInt>(std::min(out_left, chunk));
+      out_left -= stream.avail_out;
+    }
+    ret = ::inflate(&stream, Z_NO_FLUSH);
+    if (ret == Z_BUF_ERROR && stream.avail_out == 0 && out_left == 0) {
+      break;
+    }
+  }
+
+  if ((ret != Z_STREAM_END && ret != Z_BUF_ERROR) || stream.total_out != entry.uncompressed_size) {
+    throw error::ParserException(error::READ_FAILED, "Failed to inflate: " + entry.name);
+  }
+}
+
+}  // namespace parser
+}  // namespace tfe
@@ -0,0 +1,164 @@
+#include "tensor/layout.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace tfe {
+namespace tensor {
+
+namespace {
+
+/**
+ * @brief (n, c) 평면의 시작과 픽셀 간격. 모든 layout 에서 (n, c, y, x) 는 base + (y * W + x) * step
+ */
+struct Plane {
+  int64_t base;
+  int64_t step;
+};
+
+Plane planeOf(Layout layout, const std::vector<int64_t>& sizes, int64_t n, int64_t c) {
+  const int64_t channels = sizes[1];
+  const int64_t pixels   = sizes[2] * sizes[3];
+  const int64_t b        = layoutBlock(layout);
+  switch (layout) {
+    case Layout::NHWC:
+      return {n * pixels * channels + c, channels};
+    case Layout::NCHW8C:
+    case Layout::NCHW16C: {
+      const int64_t blocks = (channels + b - 1) / b;
+      return {((n * blocks + c / b) * pixels) * b + c % b, b};
+    }
+    default:
+      return {(n * channels + c) * pixels, 1};
+  }
+}
+
+void expect4d(const std::vector<int64_t>& sizes, Layout layout) {
+  if (sizes.size() != 4 && layout != Layout::NCHW) {
+    throw std::invalid_argument(std::string(layoutToString(layout)) +
+                                " layout needs a 4-d tensor, got rank " +
+                                std::to_string(sizes.size()));
+  }
+}
+
+}  // namespace
+
+const char* layoutToString(Layout layout) {
+  switch (layout) {
+    case Layout::NCHW:
+      return "nchw";
+    case Layout::NHWC:
+      return "nhwc";
+    case Layout::NCHW8C:
+      return "nchw8c";
+    case Layout::NCHW16C:
+      return "nchw16c";
+  }
+  return "unknown";
+}
+
+int64_t layoutBlock(Layout layout) {
+  switch (layout) {
+    case Layout::NCHW8C:
+      return 8;
+    case Layout::NCHW16C:
+      return 16;
+    default:
+      return 1;
+  }
+}
+
+std::vector<int64_t> physicalSizes(const std::vector<int64_t>& sizes, Layout layout) {
+  expect4d(sizes, layout);
+  const int64_t b = layoutBlock(layout);
+  switch (layout) {
+    case Layout::NHWC:
+      return {sizes[0], sizes[2], sizes[3], sizes[1]};
+    case Layout::NCHW8C:
+    case Layout::NCHW16C:
+      return {sizes[0], (sizes[1] + b - 1) / b, sizes[2], sizes[3], b};
+    default:
+      return sizes;
+  }
+}
+
+int64_t physicalNumel(const std::vector<int64_t>& sizes, Layout layout) {
+  int64_t n = 1;
+  for (int64_t s : physicalSizes(sizes, layout)) {
+    n *= s;
+  }
+  return n;
+}
+
+void reorder(const float* src, Layout from, float* dst, Layout to,
+             const std::vector<int64_t>& sizes) {
+  if (from == to) {
+    std::memcpy(dst, src, physicalNumel(sizes, to) * sizeof(float));
+    return;
+  }
+  expect4d(sizes, from);
+  expect4d(sizes, to);
+
+  const int64_t channels = sizes[1];
+  const int64_t pixels   = sizes[2] * sizes[3];
+  const int64_t b        = layoutBlock(to);
+  const int64_t padded   = (channels + b - 1) / b * b;
+  for (int64_t n = 0; n < sizes[0]; ++n) {
+    for (int64_t c = 0; c < channels; ++c) {
+      const Plane s = planeOf(from, sizes, n, c);
+      const Plane d = planeOf(to, sizes, n, c);
+      if (s.step == 1 && d.step == 1) {
+        std::memcpy(dst + d.base, src + s.base, pixels * sizeof(float));
+        continue;
+      }
+      for (int64_t p = 0; p < pixels; ++p) {
+        dst[d.base + p * d.step] = src[s.base + p * s.step];
+      }
+    }
+    // 마지막 묶음의 남는 lane
+    for (int64_t c = channels; c < padded; ++c) {
+      const Plane d = planeOf(to, sizes, n, c);
+      for (int64_t p = 0; p < pixels; ++p) {
+        dst[d.base + p * d.step] = 0.0f;
+      }
+    }
+  }
+}
+
+Tensor toLayout(const Tensor& src, Layout layout) {
+  if (src.dtype() != DType::FLOAT32) {
+    throw std::invalid_argument(std::string("toLayout expects float32, got ") +
+                                dtypeToString(src.dtype()));
+  }
+  Tensor nchw = contiguous(src);
+  Tensor dst  = empty(physicalSizes(src.sizes(), layout), DType::FLOAT32, src.storage()->key());
+  reorder(nchw.data<float>(), Layout::NCHW, dst.data<float>(), layout, src.sizes());
+  return dst;
+}
+
+std::vector<int64_t> blockedWeightSizes(const std::vector<int64_t>& w, int64_t ib, int64_t ob) {
+  return {(w[0] + ob - 1) / ob, (w[1] + ib - 1) / ib, w[2], w[3], ib, ob};
+}
+
+void packConvWeight(const float* weight, const std::vector<int64_t>& w, int64_t ib, int64_t ob,
+                    float* dst) {
+  const int64_t ocb = (w[0] + ob - 1) / ob;
+  const int64_t icb = (w[1] + ib - 1) / ib;
+  const int64_t kh = w[2], kw = w[3];
+  for (int64_t bo = 0; bo < ocb; ++bo) {
+    for (int64_t bi = 0; bi < icb; ++bi) {
+      for (int64_t k = 0; k < kh * kw; ++k) {
+        for (int64_t i = 0; i < ib; ++i) {
+          for (int64_t o = 0; o < ob; ++o) {
+            const int64_t oc = bo * ob + o, ic = bi * ib + i;
+            *dst++ = oc < w[0] && ic < w[1] ? weight[(oc * w[1] + ic) * kh * kw + k] : 0.0f;
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace tensor
+}  // namespace tfe
@@ -0,0 +1,248 @@
+#include "tensor/tensor.h"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace tfe {
+namespace tensor {
+
+size_t dtypeSize(DType dtype) {
+  switch (dtype) {
+    case DType::FLOAT64:
+    case DType::INT64:
+      return 8;
+    case DType::FLOAT32:
+    case DType::INT32:
+      return 4;
+    case DType::FLOAT16:
+    case DType::BFLOAT16:
+    case DType::INT16:
+      return 2;
+    case DType::INT8:
+    case DType::UINT8:
+    case DType::BOOL:
+      return 1;
+  }
+  return 0;
+}
+
+const char* dtypeToString(DType dtype) {
+  switch (dtype) {
+    case DType::FLOAT32:
+      return "float32";
+    case DType::FLOAT64:
+      return "float64";
+    case DType::FLOAT16:
+      return "float16";
+    case DType::BFLOAT16:
+      return "bfloat16";
+    case DType::INT64:
+      return "int64";
+    case DType::INT32:
+      return "int32";
+    case DType::INT16:
+      return "int16";
+    case DType::INT8:
+      return "int8";
+    case DType::UINT8:
+      return "uint8";
+    case DType::BOOL:
+      return "bool";
+  }
+  return "unknown";
+}
+
+bool dtypeFromStorageName(std::string_view name, DType* dtype) {
+  static const std::pair<std::string_view, DType> kStorageNames[] = {
+      {"FloatStorage", DType::FLOAT32}, {"DoubleStorage", DType::FLOAT64},
+      {"HalfStorage", DType::FLOAT16},  {"BFloat16Storage", DType::BFLOAT16},
+      {"LongStorage", DType::INT64},    {"IntStorage", DType::INT32},
+      {"ShortStorage", DType::INT16},   {"CharStorage", DType::INT8},
+      {"ByteStorage", DType::UINT8},    {"BoolStorage", DType::BOOL},
+  };
+  for (const auto& entry : kStorageNames) {
+    if (entry.first == name) {
+      *dtype = entry.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+AlignedBuffer::AlignedBuffer(size_t size) : size_(size) {
+  if (size == 0) {
+    return;
+  }
+  size_t rounded = (size + kAlignment - 1) & ~(kAlignment - 1);
+  void* p        = std::aligned_alloc(kAlignment, rounded);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  // 패딩 영역까지 0 으로 두면 꼬리 벡터 로드가 항상 정의된 값을 읽는다
+  std::memset(static_cast<char*>(p) + size, 0, rounded - size);
+  data_.reset(p);
+}
+
+Storage::Storage(std::string key, DType dtype, int64_t numel, std::string device)
+    : key_(std::move(key)), dtype_(dtype), numel_(numel), device_(std::move(device)) {}
+
+void Storage::setSource(std::shared_ptr<const parser::ZipArchive> archive,
+                        const parser::ZipEntry* entry) {
+  archive_ = std::move(archive);
+  entry_   = entry;
+}
+
+bool Storage::mapsSource() const {
+  return entry_ && entry_->isStored() &&
+         reinterpret_cast<uintptr_t>(archive_->base() + entry_->data_offset) %
+                 AlignedBuffer::kAlignment ==
+             0;
+}
+
+void Storage::materialize(const Filler& fill) const {
+  std::call_once(once_, [&] {
+    // 레코드 전체를 그대로 풀어 쓸 수 있게 엔트리 크기만큼 잡는다
+    size_t capacity = entry_ ? static_cast<size_t>(entry_->uncompressed_size) : 0;
+    buffer_         = AlignedBuffer(capacity > nbytes() ? capacity : nbytes());
+    data_           = buffer_.data();
+    if (fill) {
+      fill(static_cast<char*>(data_));
+    }
+    loaded_.store(true, std::memory_order_release);
+  });
+}
+
+void Storage::adopt(const void* data, std::shared_ptr<const void> owner) {
+  std::call_once(once_, [&] {
+    // 읽기 전용이다. 쓰는 쪽은 mutableData() 로 복사본을 만든다
+    data_  = const_cast<void*>(data);
+    owner_ = std::move(owner);
+    loaded_.store(true, std::memory_order_release);
+  });
+}
+
+void Storage::materialize(parser::ZipInflater& inflater) const {
+  if (loaded()) {
+    return;
+  }
+  if (!entry_) {
+    materialize(Filler());
+    return;
+  }
+  if (mapsSource()) {
+    // 읽기 전용 매핑이다 (mutableData() 가 복사한다). archive_ 가 매핑을 붙잡고 있다
+    std::call_once(once_, [this] {
+      data_ = const_cast<char*>(archive_->base() + entry_->data_offset);
+      loaded_.store(true, std::memory_order_release);
+    });
+    return;
+  }
+  materialize([this, &inflater](char* dst) { archive_->readInto(*entry_, dst, inflater); });
+}
+
+void* Storage::mutableData() {
+  materialize();
+  if (data_ != buffer_.data()) {
+    AlignedBuffer copy(nbytes());
+    std::memcpy(copy.data(), data_, nbytes());
+    buffer_ = std::move(copy);
+    data_   = buffer_.data();
+  }
+  return data_;
+}
+
+void Storage::materializeSlow() const {
+  // 처음 건드리는 스레드가 직접 읽는다. inflater 는 스레드마다 하나를 재사용
+  thread_local parser::ZipInflater inflater;
+  materialize(inflater);
+}
+
+Tensor::Tensor(std::shared_ptr<Storage> storage, int64_t offset, std::vector<int64_t> sizes,
+               std::vector<int64_t> strides, bool requires_grad)
+    : storage_(std::move(storage)),
+      offset_(offset),
+      sizes_(std::move(sizes)),
+      strides_(std::move(strides)),
+      requires_grad_(requires_grad) {}
+
+int64_t Tensor::numel() const {
+  int64_t n = 1;
+  for (int64_t s : sizes_) {
+    n *= s;
+  }
+  return n;
+}
+
+bool Tensor::isContiguous() const {
+  int64_t expected = 1;
+  for (size_t i = sizes_.size(); i-- > 0;) {
+    if (sizes_[i] != 1 && strides_[i] != expected) {
+      return false;
+    }
+    expected *= sizes_[i];
+  }
+  return true;
+}
+
+void* Tensor::data() {
+  return static_cast<char*>(storage_->data()) + offset_ * dtypeSize(storage_->dtype());
+}
+
+void* Tensor::mutableData() {
+  return static_cast<char*>(storage_->mutableData()) + offset_ * dtypeSize(storage_->dtype());
+}
+
+const void* Tensor::data() const {
+  return static_cast<const char*>(storage_->data()) + offset_ * dtypeSize(storage_->dtype());
+}
+
+std::vector<int64_t> contiguousStrides(const std::vector<int64_t>& sizes) {
+  std::vector<int64_t> strides(sizes.size(), 1);
+  int64_t stride = 1;
+  for (size_t i = sizes.size(); i-- > 0;) {
+    strides[i] = stride;
+    stride *= sizes[i];
+  }
+  return strides;
+}
+
+Tensor empty(const std::vector<int64_t>& sizes, DType dtype, const std::string& name) {
+  int64_t numel = 1;
+  for (int64_t s : sizes) {
+    numel *= s;
+  }
+  auto storage = std::make_shared<Storage>(name, dtype, numel, "cpu");
+  storage->materialize();
+  return Tensor(std::move(storage), 0, sizes, contiguousStrides(sizes));
+}
+
+Tensor contiguous(const Tensor& src) {
+  if (src.isContiguous()) {
+    return src;
+  }
+  Tensor dst          = empty(src.sizes(), src.dtype(), src.storage()->key());
+  const size_t item   = dtypeSize(src.dtype());
+  const char* in      = static_cast<const char*>(src.data());
+  char* out           = static_cast<char*>(dst.data());
+  const int64_t numel = src.numel();
+  std::vector<int64_t> index(src.sizes().size(), 0);
+  for (int64_t n = 0; n < numel; ++n) {
+    int64_t offset = 0;
+    for (size_t d = 0; d < index.size(); ++d) {
+      offset += index[d] * src.strides()[d];
+    }
+    std::memcpy(out + n * item, in + offset * item, item);
+    for (size_t d = index.size(); d-- > 0;) {
+      if (++index[d] < src.sizes()[d]) {
+        break;
+      }
+      index[d] = 0;
+    }
+  }
+  return dst;
+}
+
+}  // namespace tensor
+}  // namespace tfe
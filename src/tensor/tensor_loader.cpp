@@ -0,0 +1,383 @@
+#include "tensor/tensor_loader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <future>
+
+#include "error/error.h"
+#include "util/load_stats.h"
+
+namespace tfe {
+namespace tensor {
+
+namespace {
+
+std::vector<int64_t> toShape(const vm::Value& value) {
+  std::vector<int64_t> shape;
+  for (const vm::Value& dim : value.toSequence()) {
+    shape.push_back(dim.toInt());
+  }
+  return shape;
+}
+
+bool isRebuildTensor(const vm::Global& g) {
+  return g.is("torch._utils", "_rebuild_tensor_v2") || g.is("torch._utils", "_rebuild_tensor");
+}
+
+bool isRebuildParameter(const vm::Global& g) {
+  return g.is("torch._utils", "_rebuild_parameter");
+}
+
+[[noreturn]] void throwMalformed(const std::string& what) {
+  throw error::ParserException(error::PARSE_ERROR, "Malformed tensor record: " + what);
+}
+
+}  // namespace
+
+TensorLoader::TensorLoader(const parser::TorchParser& parser, size_t num_threads,
+                           std::string record_dir)
+    : parser_(parser),
+      num_threads_(num_threads == 0 ? util::ThreadPool::defaultThreads() : num_threads),
+      record_dir_(std::move(record_dir)) {}
+
+TensorLoader::~TensorLoader() {
+  // worker 가 아직 storages_ 의 Storage 를 채우고 있을 수 있다
+  for (std::future<void>& future : inflight_) {
+    future.wait();
+  }
+}
+
+util::ThreadPool& TensorLoader::pool() {
+  if (!pool_) {
+    pool_ = std::make_unique<util::ThreadPool>(num_threads_);
+    while (inflaters_.size() < pool_->size()) {
+      inflaters_.push_back(std::make_unique<parser::ZipInflater>());
+    }
+  }
+  return *pool_;
+}
+
+std::shared_ptr<Storage> TensorLoader::storage(const vm::Value& persistent_id) {
+  const vm::Value& id =
+      persistent_id.isPersistentId() ? persistent_id.toPersistentId().id : persistent_id;
+  if (!id.isTuple() || id.toTuple().size < 5) {
+    throwMalformed("persistent id is not a 5-tuple");
+  }
+  const vm::Sequence& fields = id.toTuple();
+  if (!fields[0].isString() || fields[0].toStringView() != "storage") {
+    throwMalformed("persistent id tag is not 'storage'");
+  }
+
+  std::string key(fields[2].toStringView());
+  std::lock_guard<std::mutex> lock(storages_mutex_);
+  auto it = storages_.find(key);
+  if (it != storages_.end()) {
+    return it->second;
+  }
+
+  const vm::Global& type = fields[1].toGlobal();
+  DType dtype;
+  if (!dtypeFromStorageName(type.name, &dtype)) {
+    throwMalformed("unsupported storage type " + std::string(type.name));
+  }
+
+  auto storage = std::make_shared<Storage>(key, dtype, fields[4].toInt(),
+                                           std::string(fields[3].toStringView()));
+
+  const parser::ZipEntry& entry = parser_.getRecordEntry(record_dir_ + "/" + key);
+  if (entry.uncompressed_size < storage->nbytes()) {
+    throw error::ParserException(error::READ_FAILED,
+                                 "Storage " + record_dir_ + "/" + key + " has " +
+                                     std::to_string(entry.uncompressed_size) + " bytes, expected " +
+                                     std::to_string(storage->nbytes()));
+  }
+  storage->setSource(parser_.shareArchive(), &entry);
+  storages_.emplace(key, storage);
+  return storage;
+}
+
+void TensorLoader::load() {
+  std::vector<Storage*> all;
+  {
+    std::lock_guard<std::mutex> lock(storages_mutex_);
+    all.reserve(storages_.size());
+    for (const auto& item : storages_) {
+      all.push_back(item.second.get());
+    }
+  }
+  prefetch(std::move(all));
+}
+
+size_t TensorLoader::prefetch(const std::string& prefix) {
+  std::vector<Storage*> selected;
+  for (const auto& item : named_) {
+    const std::string& name = item.first;
+    bool match = prefix.empty() || name == prefix ||
+                 (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+                  name[prefix.size()] == '.');
+    if (match) {
+      selected.push_back(item.second);
+    }
+  }
+  return prefetch(std::move(selected));
+}
+
+size_t TensorLoader::pending() const {
+  std::lock_guard<std::mutex> lock(storages_mutex_);
+  size_t count = 0;
+  for (const auto& item : storages_) {
+    count += item.second->loaded() ? 0 : 1;
+  }
+  return count;
+}
+
+size_t TensorLoader::prefetch(std::vector<Storage*> storages) {
+  // 같은 storage 를 보는 텐서가 여럿일 수 있다
+  std::sort(storages.begin(), storages.end());
+  storages.erase(std::unique(storages.begin(), storages.end()), storages.end());
+  storages.erase(std::remove_if(storages.begin(), storages.end(),
+                                [](const Storage* storage) { return storage->loaded(); }),
+                 storages.end());
+  if (storages.empty()) {
+    return 0;
+  }
+
+  // 큰 것부터 넣어야 마지막에 혼자 도는 worker 가 짧아진다
+  auto size_of = [](const Storage* storage) {
+    return storage->source() ? storage->source()->uncompressed_size : storage->nbytes();
+  };
+  std::sort(storages.begin(), storages.end(),
+            [&](const Storage* a, const Storage* b) { return size_of(a) > size_of(b); });
+  size_t total = 0;
+  for (const Storage* storage : storages) {
+    total += size_of(storage);
+  }
+  util::ScopedLoadPhase phase(util::LoadPhase::MATERIALIZE, 0, total);
+  util::LoadStats::global().count(util::LoadCounter::STORAGES, storages.size());
+  const size_t count = storages.size();
+
+  // 매핑을 그대로 가리키는 레코드는 읽을 것이 없다 (큰 것부터라 뒤쪽 순서는 그대로)
+  total = 0;
+  storages.erase(std::remove_if(storages.begin(), storages.end(),
+                                [](const Storage* storage) {
+                                  if (!storage->mapsSource()) {
+                                    return false;
+                                  }
+                                  storage->materialize();
+                                  return true;
+                                }),
+                 storages.end());
+  for (const Storage* storage : storages) {
+    total += size_of(storage);
+  }
+
+  if (num_threads_ == 1 || total < kSplitBytes) {
+    // 호출 스레드의 thread_local inflater 로 읽는다. inflaters_ 는 pool worker 몫이다
+    for (const Storage* storage : storages) {
+      storage->materialize();
+    }
+    return count;
+  }
+  pool();
+
+  std::vector<std::future<void>> futures;
+  auto wait_all = [](std::vector<std::future<void>>& pending, std::exception_ptr* first_error) {
+    for (std::future<void>& future : pending) {
+      try {
+        future.get();
+      } catch (...) {
+        if (!*first_error) {
+          *first_error = std::current_exception();
+        }
+      }
+    }
+    pending.clear();
+  };
+
+  // 작은 레코드와 DEFLATED 는 레코드 하나가 task 하나
+  std::vector<const Storage*> split;
+  for (const Storage* storage : storages) {
+    const parser::ZipEntry* entry = storage->source();
+    if (entry && entry->isStored() && entry->uncompressed_size > kSplitBytes) {
+      split.push_back(storage);
+      continue;
+    }
+    futures.push_back(pool_->submit(
+        [this, storage](size_t worker) { storage->materialize(*inflaters_[worker]); }));
+  }
+
+  // 정렬이 어긋난 큰 STORED 레코드는 호출 스레드가 call_once 를 잡고 memcpy 만 slice 로 나눠 맡긴다.
+  // worker 는 once 를 기다리지 않으므로 교착은 없다.
+  std::exception_ptr first_error;
+  for (const Storage* storage : split) {
+    const parser::ZipEntry& entry = *storage->source();
+    std::string_view src          = parser_.getArchive().view(entry);
+    try {
+      storage->materialize([&](char* dst) {
+        std::vector<std::future<void>> slices;
+        for (size_t begin = 0; begin < src.size(); begin += kSplitBytes) {
+          size_t end = std::min(src.size(), begin + kSplitBytes);
+          slices.push_back(pool_->submit([=](size_t) {
+            std::memcpy(dst + begin, src.data() + begin, end - begin);
+          }));
+        }
+        std::exception_ptr slice_error;
+        wait_all(slices, &slice_error);
+        if (slice_error) {
+          std::rethrow_exception(slice_error);
+        }
+      });
+    } catch (...) {
+      if (!first_error) {
+        first_error = std::current_exception();
+      }
+    }
+  }
+
+  wait_all(futures, &first_error);
+  if (first_error) {
+    std::rethrow_exception(first_error);
+  }
+  return count;
+}
+
+void TensorLoader::prefetchAsync(std::vector<Storage*> storages) {
+  if (num_threads_ == 1) {
+    return;
+  }
+  util::ThreadPool& workers = pool();
+  for (Storage* storage : storages) {
+    if (storage->mapsSource()) {
+      storage->materialize();
+    } else if (!storage->loaded()) {
+      inflight_.push_back(workers.submit(
+          [this, storage](size_t worker) { storage->materialize(*inflaters_[worker]); }));
+    }
+  }
+}
+
+void TensorLoader::wait() {
+  std::exception_ptr first_error;
+  for (std::future<void>& future : inflight_) {
+    try {
+      future.get();
+    } catch (...) {
+      if (!first_error) {
+        first_error = std::current_exception();
+      }
+    }
+  }
+  inflight_.clear();
+  if (first_error) {
+    std::rethrow_exception(first_error);
+  }
+}
+
+bool TensorLoader::isTensor(const vm::Value& value) const {
+  if (!value.isObject() || !value.toObject().cls.isGlobal()) {
+    return false;
+  }
+  const vm::Global& cls = value.toObject().cls.toGlobal();
+  return isRebuildTensor(cls) || isRebuildParameter(cls);
+}
+
+Tensor TensorLoader::tensor(const vm::Value& value) {
+  if (!isTensor(value)) {
+    throwMalformed(std::string("expected a rebuild call, got ") + value.typeName());
+  }
+  const vm::Object& object = value.toObject();
+  const vm::Sequence& args = object.args.toTuple();
+
+  // _rebuild_parameter(data, requires_grad, backward_hooks)
+  if (isRebuildParameter(object.cls.toGlobal())) {
+    if (args.size < 2) {
+      throwMalformed("_rebuild_parameter takes (data, requires_grad, hooks)");
+    }
+    Tensor data = tensor(args[0]);
+    return Tensor(data.storage(), data.offset(), data.sizes(), data.strides(), args[1].toBool());
+  }
+
+  if (args.size < 4) {
+    throwMalformed("_rebuild_tensor_v2 takes (storage, offset, sizes, strides, ...)");
+  }
+  std::shared_ptr<Storage> backing = storage(args[0]);
+  int64_t offset                   = args[1].toInt();
+  std::vector<int64_t> sizes       = toShape(args[2]);
+  std::vector<int64_t> strides     = toShape(args[3]);
+  bool requires_grad               = args.size > 4 && args[4].isBool() && args[4].toBool();
+  if (sizes.size() != strides.size()) {
+    throwMalformed("sizes and strides differ in rank");
+  }
+
+  // 가장 먼 원소가 storage 안에 있어야 data() 가 경계를 넘지 않는다
+  int64_t last = offset;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    if (sizes[i] == 0) {
+      last = offset - 1;
+      break;
+    }
+    last += (sizes[i] - 1) * strides[i];
+  }
+  if (offset < 0 || last >= backing->numel()) {
+    throwMalformed("view exceeds storage " + backing->key());
+  }
+
+  return Tensor(std::move(backing), offset, std::move(sizes), std::move(strides), requires_grad);
+}
+
+TensorLoader::NamedTensors TensorLoader::collect(const vm::Value& root) {
+  NamedTensors out;
+  collect(root, "", &out);
+  for (const auto& item : out) {
+    named_.emplace_back(item.first, item.second.storage().get());
+  }
+  return out;
+}
+
+void TensorLoader::collect(const vm::Value& value, const std::string& prefix, NamedTensors* out) {
+  auto join = [&prefix](std::string_view name) {
+    return prefix.empty() ? std::string(name) : prefix + "." + std::string(name);
+  };
+
+  if (isTensor(value)) {
+    out->emplace_back(prefix, tensor(value));
+    return;
+  }
+
+  switch (value.type()) {
+    case vm::ValueType::OBJECT:
+      collect(value.toObject().state, prefix, out);
+      break;
+    case vm::ValueType::DICT: {
+      const vm::Dict& dict = value.toDict();
+      for (uint32_t i = 0; i < dict.size; ++i) {
+        if (dict.keys[i].isString()) {
+          collect(dict.values[i], join(dict.keys[i].toStringView()), out);
+        }
+      }
+      break;
+    }
+    case vm::ValueType::LIST:
+    case vm::ValueType::TUPLE: {
+      const vm::Sequence& items = value.toSequence();
+      for (uint32_t i = 0; i < items.size; ++i) {
+        collect(items[i], join(std::to_string(i)), out);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void PrefetchVisitor::onPersistentId(const vm::Value& pid) {
+  // ('storage', ...) 가 아닌 id 는 tensor() 가 만날 때 오류로 알린다
+  if (pid.isTuple() && pid.toTuple().size >= 5 && pid.toTuple()[0].isString() &&
+      pid.toTuple()[0].toStringView() == "storage") {
+    loader_.prefetchAsync({loader_.storage(pid).get()});
+  }
+}
+
+}  // namespace tensor
+}  // namespace tfe
@@ -0,0 +1,140 @@
+#include "util/load_stats.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace tfe {
+namespace util {
+
+const char* loadPhaseToString(LoadPhase phase) {
+  switch (phase) {
+    case LoadPhase::OPEN:
+      return "open";
+    case LoadPhase::STAT:
+      return "stat";
+    case LoadPhase::MMAP:
+      return "mmap";
+    case LoadPhase::CENTRAL_DIRECTORY:
+      return "central_directory";
+    case LoadPhase::SECTIONS:
+      return "sections";
+    case LoadPhase::INFLATE:
+      return "inflate";
+    case LoadPhase::UNPICKLE:
+      return "unpickle";
+    case LoadPhase::MATERIALIZE:
+      return "materialize";
+    default:
+      return "unknown";
+  }
+}
+
+const char* loadCounterToString(LoadCounter counter) {
+  switch (counter) {
+    case LoadCounter::ZIP_ENTRIES:
+      return "zip_entries";
+    case LoadCounter::PICKLE_OPCODES:
+      return "pickle_opcodes";
+    case LoadCounter::PICKLE_MEMO:
+      return "pickle_memo";
+    case LoadCounter::STORAGES:
+      return "storages";
+    default:
+      return "unknown";
+  }
+}
+
+LoadStats::LoadStats() {
+  origin_ = now();
+  reset();
+}
+
+LoadStats& LoadStats::global() {
+  static LoadStats stats;
+  return stats;
+}
+
+void LoadStats::record(LoadPhase phase, int64_t begin, int64_t nanos, uint64_t bytes_in,
+                       uint64_t bytes_out, const std::string& detail) {
+  if (!enabled()) {
+    return;
+  }
+  Totals& totals = phases_[static_cast<size_t>(phase)];
+  totals.count.fetch_add(1, std::memory_order_relaxed);
+  totals.nanos.fetch_add(nanos, std::memory_order_relaxed);
+  totals.bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+  totals.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(spans_mutex_);
+  if (spans_.size() >= kMaxSpans) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  spans_.push_back({phase, detail, begin, nanos, bytes_in, bytes_out});
+}
+
+PhaseStats LoadStats::phase(LoadPhase phase) const {
+  const Totals& totals = phases_[static_cast<size_t>(phase)];
+  PhaseStats out;
+  out.count     = totals.count.load(std::memory_order_relaxed);
+  out.nanos     = totals.nanos.load(std::memory_order_relaxed);
+  out.bytes_in  = totals.bytes_in.load(std::memory_order_relaxed);
+  out.bytes_out = totals.bytes_out.load(std::memory_order_relaxed);
+  return out;
+}
+
+std::vector<LoadSpan> LoadStats::spans() const {
+  std::vector<LoadSpan> out;
+  {
+    std::lock_guard<std::mutex> lock(spans_mutex_);
+    out = spans_;
+  }
+  std::stable_sort(out.begin(), out.end(),
+                   [](const LoadSpan& a, const LoadSpan& b) { return a.begin < b.begin; });
+  return out;
+}
+
+void LoadStats::reset() {
+  for (Totals& totals : phases_) {
+    totals.count.store(0, std::memory_order_relaxed);
+    totals.nanos.store(0, std::memory_order_relaxed);
+    totals.bytes_in.store(0, std::memory_order_relaxed);
+    totals.bytes_out.store(0, std::memory_order_relaxed);
+  }
+  for (std::atomic<uint64_t>& counter : counters_) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+  std::lock_guard<std::mutex> lock(spans_mutex_);
+  spans_.clear();
+  dropped_.store(0, std::memory_order_relaxed);
+}
+
+std::string LoadStats::report() const {
+  char line[256];
+  std::snprintf(line, sizeof(line), "%-18s %8s %10s %10s %10s %10s\n", "phase", "count", "ms",
+                "MB in", "MB out", "MB/s");
+  std::string out = line;
+  for (size_t i = 0; i < static_cast<size_t>(LoadPhase::kCount); ++i) {
+    const PhaseStats p = phase(static_cast<LoadPhase>(i));
+    // 처리량은 큰 쪽 (inflate 는 푼 크기) 을 시간으로 나눈다. mmap 은 페이지를 읽지 않으므로 뺀다
+    const double bytes = static_cast<double>(std::max(p.bytes_in, p.bytes_out));
+    const double rate  = p.nanos > 0 && static_cast<LoadPhase>(i) != LoadPhase::MMAP
+                             ? bytes / 1e6 / (p.nanos / 1e9)
+                             : 0.0;
+    std::snprintf(line, sizeof(line), "%-18s %8llu %10.3f %10.2f %10.2f %10.1f\n",
+                  loadPhaseToString(static_cast<LoadPhase>(i)),
+                  static_cast<unsigned long long>(p.count), p.nanos / 1e6, p.bytes_in / 1e6,
+                  p.bytes_out / 1e6, rate);
+    out += line;
+  }
+  for (size_t i = 0; i < static_cast<size_t>(LoadCounter::kCount); ++i) {
+    std::snprintf(line, sizeof(line), "%-18s %8llu\n",
+                  loadCounterToString(static_cast<LoadCounter>(i)),
+                  static_cast<unsigned long long>(counter(static_cast<LoadCounter>(i))));
+    out += line;
+  }
+  return out;
+}
+
+}  // namespace util
+}  // namespace tfe
@@ -0,0 +1,270 @@
+#include "util/work_stealing_pool.h"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace tfe {
+namespace util {
+
+namespace {
+
+constexpr int64_t kMaxChunks = 0xffffffffLL;
+
+// 이 스레드가 지금 덩어리를 돌리고 있는 pool 과 그 worker 번호 (중첩 호출 감지)
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local size_t t_worker                = 0;
+
+/**
+ * @brief 호출 스레드를 scope 동안 pool 의 worker 0 으로 표시한다 (body 안의 중첩 호출이 제자리에서 돈다)
+ */
+class CallerScope {
+ public:
+  explicit CallerScope(const WorkStealingPool* pool) : outer_(t_pool), outer_worker_(t_worker) {
+    t_pool   = pool;
+    t_worker = 0;
+  }
+  ~CallerScope() {
+    t_pool   = outer_;
+    t_worker = outer_worker_;
+  }
+
+ private:
+  const WorkStealingPool* outer_;
+  size_t outer_worker_;
+};
+
+uint64_t pack(int64_t lo, int64_t hi) {
+  return static_cast<uint64_t>(lo) << 32 | static_cast<uint64_t>(hi);
+}
+int64_t lowOf(uint64_t range) { return static_cast<int64_t>(range >> 32); }
+int64_t highOf(uint64_t range) { return static_cast<int64_t>(range & 0xffffffffULL); }
+
+void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * @brief 이 프로세스가 쓸 수 있는 CPU 중 index 번째 (넘치면 돌아간다) 에 호출 스레드를 고정한다
+ */
+void pinToCpu(size_t index) {
+#if defined(__linux__)
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+    return;
+  }
+  size_t target = index % static_cast<size_t>(CPU_COUNT(&allowed));
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &allowed) || target-- != 0) {
+      continue;
+    }
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    CPU_SET(cpu, &one);
+    pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+    return;
+  }
+#else
+  (void)index;
+#endif
+}
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(size_t num_threads, bool pin, std::chrono::microseconds spin)
+    : concurrency_(num_threads == 0 ? defaultThreads() : num_threads), pin_(pin), spin_(spin) {
+  queues_.reset(new Queue[concurrency_]);
+  workers_.reserve(concurrency_ - 1);
+  for (size_t i = 1; i < concurrency_; ++i) {
+    workers_.emplace_back(&WorkStealingPool::work, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  stopping_.store(true);
+  {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_cv_.notify_all();
+  }
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t WorkStealingPool::defaultThreads() {
+  unsigned n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+std::shared_ptr<WorkStealingPool> WorkStealingPool::shared() {
+  static std::shared_ptr<WorkStealingPool> pool =
+      std::make_shared<WorkStealingPool>(0, true);
+  return pool;
+}
+
+void WorkStealingPool::run(int64_t begin, int64_t end, int64_t grain, Body body,
+                           const void* ctx) {
+  if (end <= begin) {
+    return;
+  }
+  grain          = std::max<int64_t>(grain, 1);
+  int64_t chunks = (end - begin + grain - 1) / grain;
+  if (chunks > kMaxChunks) {
+    grain  = (end - begin + kMaxChunks - 1) / kMaxChunks;
+    chunks = (end - begin + grain - 1) / grain;
+  }
+  // 중첩 호출은 job_mutex_ 를 이미 이 스레드나 같은 job 의 호출 스레드가 쥐고 있다
+  if (t_pool == this) {
+    body(ctx, begin, end, t_worker);
+    return;
+  }
+  // 호출 스레드는 worker 0 으로 돈다. 다른 스레드의 job 과 worker 번호가 겹치지 않게 그 job 이
+  // 끝나기를 기다린다 (혼자 도는 덩어리 하나도 마찬가지)
+  std::lock_guard<std::mutex> lock(job_mutex_);
+  if (chunks == 1 || workers_.empty()) {
+    CallerScope caller(this);
+    body(ctx, begin, end, 0);
+    return;
+  }
+
+  body_  = body;
+  ctx_   = ctx;
+  begin_ = begin;
+  end_   = end;
+  grain_ = grain;
+  error_ = nullptr;
+  remaining_.store(chunks);
+  for (size_t i = 0; i < concurrency_; ++i) {
+    queues_[i].range.store(pack(chunks * static_cast<int64_t>(i) / concurrency_,
+                                chunks * static_cast<int64_t>(i + 1) / concurrency_));
+  }
+  epoch_.fetch_add(1);
+  if (sleeping_.load() > 0) {
+    std::lock_guard<std::mutex> park(park_mutex_);
+    park_cv_.notify_all();
+  }
+
+  {
+    CallerScope caller(this);
+    drain(0);
+  }
+  // worker 가 훔쳐 간 덩어리가 끝나기를 기다린다
+  for (int spins = 0; remaining_.load(std::memory_order_acquire) > 0; ++spins) {
+    if (spins < 4096) {
+      cpuRelax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_                   = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkStealingPool::work(size_t self) {
+  t_pool   = this;
+  t_worker = self;
+  if (pin_) {
+    pinToCpu(self);
+  }
+
+  uint64_t seen = epoch_.load();
+  for (;;) {
+    const auto deadline = std::chrono::steady_clock::now() + spin_;
+    for (int spins = 0; epoch_.load() == seen && !stopping_.load(); ++spins) {
+      if ((spins & 63) != 0 || std::chrono::steady_clock::now() < deadline) {
+        cpuRelax();
+        continue;
+      }
+      // sleeping_ 을 올린 뒤 epoch 를 다시 보므로 run() 의 notify 를 놓치지 않는다
+      std::unique_lock<std::mutex> lock(park_mutex_);
+      sleeping_.fetch_add(1);
+      park_cv_.wait(lock, [&] { return epoch_.load() != seen || stopping_.load(); });
+      sleeping_.fetch_sub(1);
+    }
+    if (stopping_.load()) {
+      return;
+    }
+    seen = epoch_.load();
+    drain(self);
+  }
+}
+
+void WorkStealingPool::drain(size_t self) {
+  int64_t chunk;
+  uint64_t empty;
+  for (;;) {
+    while (pop(self, &chunk, &empty)) {
+      execute(chunk, self);
+    }
+    bool stolen = false;
+    for (size_t k = 1; k < concurrency_ && !stolen; ++k) {
+      stolen = steal(self, (self + k) % concurrency_, empty, &chunk);
+    }
+    if (!stolen) {
+      return;
+    }
+    execute(chunk, self);
+  }
+}
+
+bool WorkStealingPool::pop(size_t self, int64_t* chunk, uint64_t* empty) {
+  std::atomic<uint64_t>& queue = queues_[self].range;
+  uint64_t range               = queue.load();
+  while (lowOf(range) < highOf(range)) {
+    if (queue.compare_exchange_weak(range, pack(lowOf(range) + 1, highOf(range)))) {
+      *chunk = lowOf(range);
+      return true;
+    }
+  }
+  *empty = range;
+  return false;
+}
+
+bool WorkStealingPool::steal(size_t self, size_t victim, uint64_t empty, int64_t* chunk) {
+  std::atomic<uint64_t>& queue = queues_[victim].range;
+  uint64_t range               = queue.load();
+  while (lowOf(range) < highOf(range)) {
+    const int64_t lo = lowOf(range), hi = highOf(range);
+    const int64_t mid = lo + (hi - lo) / 2;
+    if (queue.compare_exchange_weak(range, pack(lo, mid))) {
+      // [mid, hi) 를 가져와 첫 덩어리는 바로 돌고 나머지는 다른 도둑이 볼 수 있게 제 queue 에 둔다.
+      // 그새 다음 parallelFor 가 제 queue 를 채웠다면 (늦게 깬 worker) 덮어쓰지 않고 직접 돈다
+      *chunk = mid;
+      if (!queues_[self].range.compare_exchange_strong(empty, pack(mid + 1, hi))) {
+        for (int64_t c = mid + 1; c < hi; ++c) {
+          execute(c, self);
+        }
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::execute(int64_t chunk, size_t self) {
+  const int64_t lo = begin_ + chunk * grain_;
+  const int64_t hi = std::min(end_, lo + grain_);
+  try {
+    body_(ctx_, lo, hi, self);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    if (!error_) {
+      error_ = std::current_exception();
+    }
+  }
+  remaining_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+}  // namespace util
+}  // namespace tfe
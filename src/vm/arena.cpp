@@ -0,0 +1,34 @@
+#include "vm/arena.h"
+
+namespace tfe {
+namespace vm {
+
+/**
+ * @brief Oversized requests get a dedicated block so that the current block keeps its tail.
+ */
+void* Arena::allocateSlow(size_t size, size_t align) {
+    size_t needed = size + align;
+    if (needed > block_size_ / 4) {
+        blocks_.emplace_back(new char[needed]);
+        bytes_reserved_ += needed;
+        uintptr_t base = reinterpret_cast<uintptr_t>(blocks_.back().get());
+        uintptr_t aligned = (base + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    blocks_.emplace_back(new char[block_size_]);
+    bytes_reserved_ += block_size_;
+    cur_ = blocks_.back().get();
+    end_ = cur_ + block_size_;
+    return allocate(size, align);
+}
+
+void Arena::reset() {
+    blocks_.clear();
+    bytes_reserved_ = 0;
+    cur_ = nullptr;
+    end_ = nullptr;
+}
+
+} // namespace vm
+} // namespace tfe
@@ -0,0 +1,130 @@
+#include "vm/value_pkl.h"
+
+#include <algorithm>
+
+namespace tfe {
+namespace vm {
+
+const char* valueTypeToString(ValueType type) {
+    switch (type) {
+        case ValueType::NONE:
+            return "None";
+        case ValueType::BOOL:
+            return "bool";
+        case ValueType::INT:
+            return "int";
+        case ValueType::FLOAT:
+            return "float";
+        case ValueType::STRING:
+            return "str";
+        case ValueType::BYTES:
+            return "bytes";
+        case ValueType::TUPLE:
+            return "tuple";
+        case ValueType::LIST:
+            return "list";
+        case ValueType::DICT:
+            return "dict";
+        case ValueType::GLOBAL:
+            return "global";
+        case ValueType::OBJECT:
+            return "object";
+        case ValueType::PERSISTENT_ID:
+            return "persistent_id";
+    }
+    return "unknown";
+}
+
+double Value::toDouble() const {
+    if (type_ == ValueType::INT) {
+        return static_cast<double>(i_);
+    }
+    expect(ValueType::FLOAT);
+    return f_;
+}
+
+Sequence& Value::toSequence() const {
+    if (type_ != ValueType::TUPLE && type_ != ValueType::LIST) {
+        throw std::runtime_error(std::string("Expected pickle tuple or list but got ") +
+                                 typeName());
+    }
+    return *seq_;
+}
+
+bool Value::equals(const Value& other) const {
+    if (type_ != other.type_) {
+        return false;
+    }
+    switch (type_) {
+        case ValueType::NONE:
+            return true;
+        case ValueType::BOOL:
+            return b_ == other.b_;
+        case ValueType::INT:
+            return i_ == other.i_;
+        case ValueType::FLOAT:
+            return f_ == other.f_;
+        case ValueType::STRING:
+        case ValueType::BYTES:
+            return std::string_view(str_, length_) == std::string_view(other.str_, other.length_);
+        default:
+            return i_ == other.i_;
+    }
+}
+
+/**
+ * @brief Grow by doubling inside the arena. The old array is left behind as arena garbage, which
+ *        is cheaper than tracking frees for the few containers that actually grow.
+ */
+void Sequence::push(Arena& arena, const Value& value) {
+    if (size == capacity) {
+        uint32_t new_capacity = std::max<uint32_t>(4, capacity * 2);
+        Value* grown = arena.allocateArray<Value>(new_capacity);
+        if (size) {
+            std::memcpy(static_cast<void*>(grown), items, sizeof(Value) * size);
+        }
+        items = grown;
+        capacity = new_capacity;
+    }
+    items[size++] = value;
+}
+
+void Dict::append(Arena& arena, const Value& key, const Value& value) {
+    if (size == capacity) {
+        uint32_t new_capacity = std::max<uint32_t>(4, capacity * 2);
+        Value* grown_keys = arena.allocateArray<Value>(new_capacity);
+        Value* grown_values = arena.allocateArray<Value>(new_capacity);
+        if (size) {
+            std::memcpy(static_cast<void*>(grown_keys), keys, sizeof(Value) * size);
+            std::memcpy(static_cast<void*>(grown_values), values, sizeof(Value) * size);
+        }
+        keys = grown_keys;
+        values = grown_values;
+        capacity = new_capacity;
+    }
+    keys[size] = key;
+    values[size] = value;
+    ++size;
+}
+
+void Dict::set(Arena& arena, const Value& key, const Value& value) {
+    for (uint32_t i = 0; i < size; ++i) {
+        if (keys[i].equals(key)) {
+            values[i] = value;
+            return;
+        }
+    }
+    append(arena, key, value);
+}
+
+const Value* Dict::find(std::string_view key) const {
+    for (uint32_t i = 0; i < size; ++i) {
+        if (keys[i].isString() && keys[i].toStringView() == key) {
+            return &values[i];
+        }
+    }
+    return nullptr;
+}
+
+} // namespace vm
+} // namespace tfe
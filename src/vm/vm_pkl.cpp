@@ -1,7 +1,12 @@
 #include "vm/vm_pkl.h"
+#include <algorithm>
+#include <charconv>
 #include <stdexcept>
 #include <cstring>
 
+#include "error/error.h"
+#include "util/load_stats.h"
+
 namespace tfe {
 namespace vm {
 
@@ -163,60 +168,835 @@ std::vector<std::string> PickleVM::parse() {
     return opcodes;
 }
 
-uint8_t PickleVM::readByte() {
-    if (pos_ >= data_.size()) {
-        throw std::runtime_error("Unexpected end of pickle data");
+/**
+ * @brief Execute opcodes until STOP. Only what TorchScript archives need is interpreted; callables
+ *        are not invoked but recorded as Object{cls, args} for the caller to resolve.
+ */
+Value PickleVM::load(Dispatch dispatch) {
+    util::ScopedLoadPhase phase(util::LoadPhase::UNPICKLE, size_);
+    pos_ = 0;
+    fast_end_ = 0;
+    stopped_ = false;
+    opcodes_ = 0;
+    result_ = Value();
+    stack_.clear();
+    marks_.clear();
+    memo_.clear();
+
+    switch (dispatch) {
+        case Dispatch::SWITCH:
+            runSwitch();
+            break;
+        case Dispatch::TABLE:
+            runTable();
+            break;
+        case Dispatch::COMPUTED_GOTO:
+            runComputedGoto();
+            break;
     }
-    return static_cast<uint8_t>(data_[pos_++]);
+    if (phase.active()) {
+        util::LoadStats& stats = util::LoadStats::global();
+        stats.count(util::LoadCounter::PICKLE_OPCODES, opcodes_);
+        stats.count(util::LoadCounter::PICKLE_MEMO, memo_.size());
+    }
+    return result_;
+}
+
+bool PickleVM::supports(Dispatch dispatch) {
+#if TFE_PKL_HAS_COMPUTED_GOTO
+    static_cast<void>(dispatch);
+    return true;
+#else
+    return dispatch != Dispatch::COMPUTED_GOTO;
+#endif
 }
 
 /**
- * @brief read byte for little endian
+ * @brief Reference dispatch: one switch generated from TFE_PKL_OPCODES
  */
-uint16_t PickleVM::readUint16() {
-    uint8_t b1 = readByte();
-    uint8_t b2 = readByte();
-    return b1 | (b2 << 8); 
+template <bool kChecked>
+void PickleVM::stepSwitch() {
+    switch (static_cast<OpCode>(readLE<uint8_t, kChecked>())) {
+#define TFE_PKL_SWITCH_CASE(name, code) \
+        case OpCode::name:              \
+            exec##name<kChecked>();     \
+            break;
+        TFE_PKL_OPCODES(TFE_PKL_SWITCH_CASE)
+#undef TFE_PKL_SWITCH_CASE
+        default:
+            execUnknown();
+    }
+    ++opcodes_;
+}
+
+void PickleVM::runSwitch() {
+    while (!stopped_) {
+        if (pos_ < fast_end_) {
+            stepSwitch<false>();
+        } else if (hasMore()) {
+            stepSwitch<true>();
+        } else {
+            throw std::runtime_error("Pickle data ended without STOP");
+        }
+    }
 }
 
 /**
- * @brief read byte for little endian
+ * @brief 256 entry member function table built at compile time from TFE_PKL_OPCODES
  */
-uint32_t PickleVM::readUint32() {
-    uint8_t b1 = readByte();
-    uint8_t b2 = readByte();
-    uint8_t b3 = readByte();
-    uint8_t b4 = readByte();
-    return b1 | (b2 << 8) | (b3 << 16) | (b4 << 24); 
+template <bool kChecked>
+constexpr PickleVM::DispatchTable PickleVM::makeDispatchTable() {
+    DispatchTable table{};
+    for (auto& handler : table.handlers) {
+        handler = &PickleVM::execUnknown;
+    }
+#define TFE_PKL_TABLE_ENTRY(name, code) \
+    table.handlers[static_cast<uint8_t>(code)] = &PickleVM::exec##name<kChecked>;
+    TFE_PKL_OPCODES(TFE_PKL_TABLE_ENTRY)
+#undef TFE_PKL_TABLE_ENTRY
+    return table;
 }
 
-int32_t PickleVM::readInt32() {
-    uint32_t val = readUint32();
-    return static_cast<int32_t>(val);
+constexpr PickleVM::DispatchTable PickleVM::kCheckedTable = PickleVM::makeDispatchTable<true>();
+constexpr PickleVM::DispatchTable PickleVM::kUncheckedTable = PickleVM::makeDispatchTable<false>();
+
+void PickleVM::runTable() {
+    while (!stopped_) {
+        if (pos_ < fast_end_) {
+            (this->*kUncheckedTable.handlers[readLE<uint8_t, false>()])();
+        } else if (hasMore()) {
+            (this->*kCheckedTable.handlers[readLE<uint8_t, true>()])();
+        } else {
+            throw std::runtime_error("Pickle data ended without STOP");
+        }
+        ++opcodes_;
+    }
 }
 
-std::string PickleVM::readLine() {
-    std::string line;
-    while (hasMore()) {
-        char c = static_cast<char>(readByte());
-        if (c == '\n') {
-            break;
+/**
+ * @brief Labels-as-values dispatch: every handler ends in its own indirect jump, which gives the
+ *        branch predictor one slot per opcode instead of the single shared one of a loop.
+ */
+void PickleVM::runComputedGoto() {
+#if TFE_PKL_HAS_COMPUTED_GOTO
+    void* checked[256];
+    void* unchecked[256];
+    for (size_t i = 0; i < 256; ++i) {
+        checked[i] = &&op_unknown;
+        unchecked[i] = &&op_unknown;
+    }
+#define TFE_PKL_GOTO_LABEL(name, code)                              \
+    checked[static_cast<uint8_t>(code)] = &&op_checked_##name;      \
+    unchecked[static_cast<uint8_t>(code)] = &&op_unchecked_##name;
+    TFE_PKL_OPCODES(TFE_PKL_GOTO_LABEL)
+#undef TFE_PKL_GOTO_LABEL
+
+#define TFE_PKL_NEXT()                                                  \
+    do {                                                                \
+        if (stopped_) {                                                 \
+            return;                                                     \
+        }                                                               \
+        if (pos_ < fast_end_) {                                         \
+            goto* unchecked[static_cast<uint8_t>(data_[pos_++])];       \
+        }                                                               \
+        if (!hasMore()) {                                               \
+            goto op_eof;                                                \
+        }                                                               \
+        goto* checked[static_cast<uint8_t>(data_[pos_++])];             \
+    } while (0)
+
+    TFE_PKL_NEXT();
+
+#define TFE_PKL_GOTO_HANDLER(name, code) \
+    op_checked_##name:                   \
+    exec##name<true>();                  \
+    ++opcodes_;                          \
+    TFE_PKL_NEXT();                      \
+    op_unchecked_##name:                 \
+    exec##name<false>();                 \
+    ++opcodes_;                          \
+    TFE_PKL_NEXT();
+    TFE_PKL_OPCODES(TFE_PKL_GOTO_HANDLER)
+#undef TFE_PKL_GOTO_HANDLER
+#undef TFE_PKL_NEXT
+
+op_unknown:
+    execUnknown();
+op_eof:
+    throw std::runtime_error("Pickle data ended without STOP");
+#else
+    runTable();
+#endif
+}
+
+void PickleVM::feed(const char* bytes, size_t size) {
+    if (!streaming_) {
+        throw std::runtime_error("PickleVM::feed() requires the streaming constructor");
+    }
+    if (stopped_) {
+        return;
+    }
+
+    // drop what has been executed; only the unfinished tail stays buffered
+    if (pos_ > 0) {
+        stream_buf_.erase(stream_buf_.begin(), stream_buf_.begin() + pos_);
+        fast_end_ = fast_end_ > pos_ ? fast_end_ - pos_ : 0;
+        pos_ = 0;
+    }
+    stream_buf_.insert(stream_buf_.end(), bytes, bytes + size);
+    data_ = stream_buf_.data();
+    size_ = stream_buf_.size();
+
+    pump();
+}
+
+/**
+ * @brief Run every opcode that is complete in the buffer. An underflow rewinds to the start of the
+ *        opcode; handlers read all operands before touching the stack, so nothing else to undo.
+ */
+void PickleVM::pump() {
+    while (!stopped_ && pos_ < size_) {
+        size_t start = pos_;
+        try {
+            if (pos_ < fast_end_) {
+                (this->*kUncheckedTable.handlers[readLE<uint8_t, false>()])();
+            } else {
+                (this->*kCheckedTable.handlers[readLE<uint8_t, true>()])();
+            }
+            ++opcodes_;
+        } catch (const PickleUnderflow&) {
+            pos_ = start;
+            return;
         }
-        line += c;
     }
-    return line;
 }
 
-std::string PickleVM::readBytes(size_t count) {
-    std::string bytes;
-    bytes.reserve(count);
-    for (size_t i = 0; i < count; ++i) {
-        bytes += static_cast<char>(readByte());
+Value PickleVM::finish() {
+    if (!stopped_) {
+        throw std::runtime_error("Pickle stream ended without STOP (" +
+                                 std::to_string(bufferedBytes()) + " bytes pending)");
+    }
+    // time is not recorded here: feed() interleaves decoding with the caller's inflate / I/O
+    util::LoadStats& stats = util::LoadStats::global();
+    stats.count(util::LoadCounter::PICKLE_OPCODES, opcodes_);
+    stats.count(util::LoadCounter::PICKLE_MEMO, memo_.size());
+    return result_;
+}
+
+// Opcode handlers
+void PickleVM::execUnknown() {
+    uint8_t opcode_byte = static_cast<uint8_t>(data_[pos_ - 1]);
+    std::stringstream ss;
+    ss << "Unsupported pickle opcode " << opCodeToString(static_cast<OpCode>(opcode_byte))
+       << " (0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
+       << static_cast<int>(opcode_byte) << ") at offset " << std::dec << (pos_ - 1);
+    throw std::runtime_error(ss.str());
+}
+
+template <bool kChecked>
+void PickleVM::execSTOP() {
+    if (!marks_.empty()) {
+        throw std::runtime_error("Unbalanced MARK at STOP");
+    }
+    result_ = pop();
+    stopped_ = true;
+    if (visitor_) {
+        visitor_->onStop(result_);
+    }
+}
+
+template <bool kChecked>
+void PickleVM::execPROTO() { readLE<uint8_t, kChecked>(); }
+
+/**
+ * @brief Validate the whole frame once. Opcodes inside it then run through the unchecked
+ *        handlers (see fast_end_), only variable length payloads are still checked.
+ */
+template <bool kChecked>
+void PickleVM::execFRAME() {
+    uint64_t frame_size = readLE<uint64_t, kChecked>();
+    if (frame_size > size_ - pos_) {
+        throw PickleUnderflow("Pickle FRAME exceeds data (" + std::to_string(frame_size) +
+                                 " bytes at offset " + std::to_string(pos_) + ")");
+    }
+    // an unchecked opcode reads at most 1 + 8 bytes, keep that much slack before size_
+    size_t frame_end = pos_ + frame_size;
+    size_t safe_end = size_ > kMaxFixedOperand ? size_ - kMaxFixedOperand : 0;
+    fast_end_ = std::min(frame_end, safe_end);
+}
+
+// stack / mark
+template <bool kChecked>
+void PickleVM::execMARK() { marks_.push_back(stack_.size()); }
+
+template <bool kChecked>
+void PickleVM::execPOP() {
+    if (!marks_.empty() && marks_.back() == stack_.size()) {
+        marks_.pop_back();
+    } else {
+        pop();
     }
+}
+
+template <bool kChecked>
+void PickleVM::execPOP_MARK() { stack_.resize(popMark()); }
+
+template <bool kChecked>
+void PickleVM::execDUP() { push(top()); }
+
+// scalars
+template <bool kChecked>
+void PickleVM::execNONE() { push(Value::none()); }
+
+template <bool kChecked>
+void PickleVM::execNEWTRUE() { push(Value::boolean(true)); }
+
+template <bool kChecked>
+void PickleVM::execNEWFALSE() { push(Value::boolean(false)); }
+
+template <bool kChecked>
+void PickleVM::execBININT() {
+    push(Value::integer(static_cast<int32_t>(readLE<uint32_t, kChecked>())));
+}
+
+template <bool kChecked>
+void PickleVM::execBININT1() { push(Value::integer(readLE<uint8_t, kChecked>())); }
+
+template <bool kChecked>
+void PickleVM::execBININT2() { push(Value::integer(readLE<uint16_t, kChecked>())); }
+
+template <bool kChecked>
+void PickleVM::execINT() {
+    std::string_view line = readLine();
+    if (line == "01" || line == "00") {
+        push(Value::boolean(line == "01"));
+    } else {
+        push(Value::integer(parseInteger(line)));
+    }
+}
+
+template <bool kChecked>
+void PickleVM::execLONG() {
+    std::string_view line = readLine();
+    if (!line.empty() && line.back() == 'L') {
+        line.remove_suffix(1);
+    }
+    push(Value::integer(parseInteger(line)));
+}
+
+template <bool kChecked>
+void PickleVM::execLONG1() {
+    uint8_t length = readLE<uint8_t, kChecked>();
+    push(Value::integer(decodeLong(readBytes(length))));
+}
+
+template <bool kChecked>
+void PickleVM::execLONG4() {
+    uint32_t length = readLE<uint32_t, kChecked>();
+    push(Value::integer(decodeLong(readBytes(length))));
+}
+
+template <bool kChecked>
+void PickleVM::execBINFLOAT() {
+    // big endian IEEE 754
+    uint64_t bits = byteSwap64(readLE<uint64_t, kChecked>());
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    push(Value::real(value));
+}
+
+template <bool kChecked>
+void PickleVM::execFLOAT() { push(Value::real(std::stod(std::string(readLine())))); }
+
+// strings / bytes
+template <bool kChecked>
+void PickleVM::execBINUNICODE() {
+    uint32_t length = readLE<uint32_t, kChecked>();
+    push(makeString(readBytes(length)));
+}
+
+template <bool kChecked>
+void PickleVM::execBINSTRING() { execBINUNICODE<kChecked>(); }
+
+template <bool kChecked>
+void PickleVM::execSHORT_BINUNICODE() {
+    uint8_t length = readLE<uint8_t, kChecked>();
+    push(makeString(readBytes(length)));
+}
+
+template <bool kChecked>
+void PickleVM::execSHORT_BINSTRING() { execSHORT_BINUNICODE<kChecked>(); }
+
+template <bool kChecked>
+void PickleVM::execBINUNICODE8() {
+    uint64_t length = readLE<uint64_t, kChecked>();
+    push(makeString(readBytes(length)));
+}
+
+template <bool kChecked>
+void PickleVM::execUNICODE() { push(makeString(readLine())); }
+
+template <bool kChecked>
+void PickleVM::execSTRING() {
+    std::string_view line = readLine();
+    if (line.size() >= 2 && (line.front() == '\'' || line.front() == '"')) {
+        line = line.substr(1, line.size() - 2);
+    }
+    push(makeString(line));
+}
+
+template <bool kChecked>
+void PickleVM::execBINBYTES() {
+    uint32_t length = readLE<uint32_t, kChecked>();
+    push(makeBytes(readBytes(length)));
+}
+
+template <bool kChecked>
+void PickleVM::execSHORT_BINBYTES() {
+    uint8_t length = readLE<uint8_t, kChecked>();
+    push(makeBytes(readBytes(length)));
+}
+
+template <bool kChecked>
+void PickleVM::execBINBYTES8() {
+    uint64_t length = readLE<uint64_t, kChecked>();
+    push(makeBytes(readBytes(length)));
+}
+
+template <bool kChecked>
+void PickleVM::execBYTEARRAY8() { execBINBYTES8<kChecked>(); }
+
+// containers
+template <bool kChecked>
+void PickleVM::execEMPTY_TUPLE() { push(Value::tuple(arena_.create<Sequence>())); }
+
+template <bool kChecked>
+void PickleVM::execTUPLE() {
+    size_t from = popMark();
+    Value tuple = Value::tuple(collect(from));
+    stack_.resize(from);
+    push(tuple);
+}
+
+template <bool kChecked>
+void PickleVM::execTUPLE1() {
+    Value a = pop();
+    push(makeTuple({a}));
+}
+
+template <bool kChecked>
+void PickleVM::execTUPLE2() {
+    Value b = pop();
+    Value a = pop();
+    push(makeTuple({a, b}));
+}
+
+template <bool kChecked>
+void PickleVM::execTUPLE3() {
+    Value c = pop();
+    Value b = pop();
+    Value a = pop();
+    push(makeTuple({a, b, c}));
+}
+
+template <bool kChecked>
+void PickleVM::execEMPTY_LIST() { push(Value::list(arena_.create<Sequence>())); }
+
+template <bool kChecked>
+void PickleVM::execEMPTY_SET() { execEMPTY_LIST<kChecked>(); }
+
+template <bool kChecked>
+void PickleVM::execLIST() {
+    size_t from = popMark();
+    Value list = Value::list(collect(from));
+    stack_.resize(from);
+    push(list);
+}
+
+template <bool kChecked>
+void PickleVM::execFROZENSET() { execLIST<kChecked>(); }
+
+template <bool kChecked>
+void PickleVM::execAPPEND() {
+    Value item = pop();
+    top().toList().push(arena_, item);
+}
+
+template <bool kChecked>
+void PickleVM::execAPPENDS() { appendItems(popMark()); }
+
+template <bool kChecked>
+void PickleVM::execADDITEMS() { appendItems(popMark()); }
+
+template <bool kChecked>
+void PickleVM::execEMPTY_DICT() { push(Value::dict(arena_.create<Dict>())); }
+
+template <bool kChecked>
+void PickleVM::execDICT() {
+    size_t from = popMark();
+    if ((stack_.size() - from) % 2 != 0) {
+        throw error::ParserException(error::PARSE_ERROR, "Malformed DICT: odd number of items");
+    }
+    Value dict = Value::dict(arena_.create<Dict>());
+    for (size_t i = from; i < stack_.size(); i += 2) {
+        dict.toDict().set(arena_, stack_[i], stack_[i + 1]);
+        if (visitor_) {
+            visitor_->onDictEntry(dict, stack_[i], stack_[i + 1]);
+        }
+    }
+    stack_.resize(from);
+    push(dict);
+}
+
+template <bool kChecked>
+void PickleVM::execSETITEM() {
+    Value value = pop();
+    Value key = pop();
+    top().toDict().set(arena_, key, value);
+    if (visitor_) {
+        visitor_->onDictEntry(top(), key, value);
+    }
+}
+
+template <bool kChecked>
+void PickleVM::execSETITEMS() { setItems(popMark()); }
+
+// memo
+template <bool kChecked>
+void PickleVM::execBINPUT() { memoPut(readLE<uint8_t, kChecked>()); }
+
+template <bool kChecked>
+void PickleVM::execLONG_BINPUT() { memoPut(readLE<uint32_t, kChecked>()); }
+
+template <bool kChecked>
+void PickleVM::execPUT() { memoPut(static_cast<size_t>(parseInteger(readLine()))); }
+
+template <bool kChecked>
+void PickleVM::execMEMOIZE() { memoPut(memo_.size()); }
+
+template <bool kChecked>
+void PickleVM::execBINGET() { push(memoGet(readLE<uint8_t, kChecked>())); }
+
+template <bool kChecked>
+void PickleVM::execLONG_BINGET() { push(memoGet(readLE<uint32_t, kChecked>())); }
+
+template <bool kChecked>
+void PickleVM::execGET() { push(memoGet(static_cast<size_t>(parseInteger(readLine())))); }
+
+// globals / objects
+template <bool kChecked>
+void PickleVM::execGLOBAL() {
+    std::string_view module = readLine();
+    std::string_view name = readLine();
+    push(makeGlobal(module, name));
+}
+
+template <bool kChecked>
+void PickleVM::execSTACK_GLOBAL() {
+    Value name = pop();
+    Value module = pop();
+    push(makeGlobal(module.toStringView(), name.toStringView()));
+}
+
+template <bool kChecked>
+void PickleVM::execREDUCE() {
+    Value args = pop();
+    Value callable = pop();
+    push(makeObject(callable, args));
+}
+
+template <bool kChecked>
+void PickleVM::execNEWOBJ() {
+    Value args = pop();
+    Value cls = pop();
+    push(makeObject(cls, args));
+}
+
+template <bool kChecked>
+void PickleVM::execNEWOBJ_EX() {
+    pop();  // kwargs
+    Value args = pop();
+    Value cls = pop();
+    push(makeObject(cls, args));
+}
+
+template <bool kChecked>
+void PickleVM::execOBJ() {
+    size_t from = popMark();
+    if (from >= stack_.size()) {
+        throw std::runtime_error("OBJ without class");
+    }
+    Value cls = stack_[from];
+    Sequence* args = collect(from + 1);
+    stack_.resize(from);
+    push(makeObject(cls, Value::tuple(args)));
+}
+
+template <bool kChecked>
+void PickleVM::execINST() {
+    std::string_view module = readLine();
+    std::string_view name = readLine();
+    size_t from = popMark();
+    Sequence* args = collect(from);
+    stack_.resize(from);
+    push(makeObject(makeGlobal(module, name), Value::tuple(args)));
+}
+
+template <bool kChecked>
+void PickleVM::execBUILD() { build(); }
+
+template <bool kChecked>
+void PickleVM::execBINPERSID() {
+    PersistentId* pid = arena_.create<PersistentId>();
+    pid->id = pop();
+    push(Value::persistentId(pid));
+    if (visitor_) {
+        visitor_->onPersistentId(pid->id);
+    }
+}
+
+template <bool kChecked>
+void PickleVM::execPERSID() {
+    PersistentId* pid = arena_.create<PersistentId>();
+    pid->id = makeString(readLine());
+    push(Value::persistentId(pid));
+    if (visitor_) {
+        visitor_->onPersistentId(pid->id);
+    }
+}
+
+// not produced by torch.save / torch.jit.save
+template <bool kChecked>
+void PickleVM::execEXT1() { execUnknown(); }
+
+template <bool kChecked>
+void PickleVM::execEXT2() { execUnknown(); }
+
+template <bool kChecked>
+void PickleVM::execEXT4() { execUnknown(); }
+
+template <bool kChecked>
+void PickleVM::execNEXT_BUFFER() { execUnknown(); }
+
+template <bool kChecked>
+void PickleVM::execREADONLY_BUFFER() { execUnknown(); }
+
+Value PickleVM::pop() {
+    if (stack_.empty() || (!marks_.empty() && marks_.back() >= stack_.size())) {
+        throw std::runtime_error("Pickle stack underflow");
+    }
+    Value value = stack_.back();
+    stack_.pop_back();
+    return value;
+}
+
+Value& PickleVM::top() {
+    if (stack_.empty() || (!marks_.empty() && marks_.back() >= stack_.size())) {
+        throw std::runtime_error("Pickle stack underflow");
+    }
+    return stack_.back();
+}
+
+size_t PickleVM::popMark() {
+    if (marks_.empty()) {
+        throw std::runtime_error("Pickle mark stack underflow");
+    }
+    size_t mark = marks_.back();
+    marks_.pop_back();
+    return mark;
+}
+
+/**
+ * @brief Copy stack_[from:] into a new arena sequence (the caller trims the stack).
+ */
+Sequence* PickleVM::collect(size_t from) {
+    Sequence* seq = arena_.create<Sequence>();
+    size_t count = stack_.size() - from;
+    if (count) {
+        seq->items = arena_.allocateArray<Value>(count);
+        std::memcpy(static_cast<void*>(seq->items), &stack_[from], sizeof(Value) * count);
+        seq->size = static_cast<uint32_t>(count);
+        seq->capacity = static_cast<uint32_t>(count);
+    }
+    return seq;
+}
+
+Value PickleVM::makeTuple(std::initializer_list<Value> items) {
+    Sequence* seq = arena_.create<Sequence>();
+    seq->items = arena_.allocateArray<Value>(items.size());
+    for (const Value& item : items) {
+        seq->items[seq->size++] = item;
+    }
+    seq->capacity = seq->size;
+    return Value::tuple(seq);
+}
+
+Value PickleVM::makeGlobal(std::string_view module, std::string_view name) {
+    Global* global = arena_.create<Global>();
+    global->module = keep(module);
+    global->name = keep(name);
+    if (visitor_) {
+        visitor_->onGlobal(*global);
+    }
+    return Value::global(global);
+}
+
+/**
+ * @brief REDUCE/NEWOBJ. collections.OrderedDict() is materialized as a plain dict since torch
+ *        uses it for (empty) hook tables that later receive SETITEMS.
+ */
+Value PickleVM::makeObject(const Value& cls, const Value& args) {
+    if (cls.isGlobal() && cls.toGlobal().is("collections", "OrderedDict") &&
+        args.toSequence().empty()) {
+        return Value::dict(arena_.create<Dict>());
+    }
+
+    Object* object = arena_.create<Object>();
+    object->cls = cls;
+    object->args = args;
+    Value value = Value::object(object);
+    if (visitor_) {
+        visitor_->onObject(value);
+    }
+    return value;
+}
+
+void PickleVM::memoPut(size_t index) {
+    if (index >= memo_.size()) {
+        // each slot is written by an opcode of its own, so a real pickler never puts past the
+        // opcode count; the bound keeps a forged LONG_BINPUT from sizing the memo
+        if (index > opcodes_) {
+            throw error::ParserException(
+                error::PARSE_ERROR, "Pickle memo index out of range: " + std::to_string(index));
+        }
+        memo_.resize(index + 1);
+    }
+    memo_[index] = top();
+}
+
+Value PickleVM::memoGet(size_t index) const {
+    if (index >= memo_.size()) {
+        throw std::runtime_error("Pickle memo index out of range: " + std::to_string(index));
+    }
+    return memo_[index];
+}
+
+void PickleVM::setItems(size_t from) {
+    if (from == 0 || (stack_.size() - from) % 2 != 0) {
+        throw std::runtime_error("Malformed SETITEMS");
+    }
+    Dict& dict = stack_[from - 1].toDict();
+    for (size_t i = from; i < stack_.size(); i += 2) {
+        dict.set(arena_, stack_[i], stack_[i + 1]);
+        if (visitor_) {
+            visitor_->onDictEntry(stack_[from - 1], stack_[i], stack_[i + 1]);
+        }
+    }
+    stack_.resize(from);
+}
+
+void PickleVM::appendItems(size_t from) {
+    if (from == 0) {
+        throw std::runtime_error("Malformed APPENDS");
+    }
+    Sequence& list = stack_[from - 1].toList();
+    for (size_t i = from; i < stack_.size(); ++i) {
+        list.push(arena_, stack_[i]);
+    }
+    stack_.resize(from);
+}
+
+/**
+ * @brief BUILD on an object stores the state; on a dict the state's items are merged.
+ */
+void PickleVM::build() {
+    Value state = pop();
+    Value& target = top();
+    if (target.isObject()) {
+        target.toObject().state = state;
+        if (visitor_) {
+            visitor_->onBuild(target);
+        }
+    } else if (target.isDict() && state.isDict()) {
+        const Dict& items = state.toDict();
+        for (uint32_t i = 0; i < items.size; ++i) {
+            target.toDict().set(arena_, items.keys[i], items.values[i]);
+        }
+    } else {
+        throw std::runtime_error(std::string("BUILD on unsupported target ") + target.typeName());
+    }
+}
+
+/**
+ * @brief LONG1/LONG4 payload: little endian two's complement
+ */
+int64_t PickleVM::decodeLong(std::string_view bytes) const {
+    if (bytes.size() > 8) {
+        throw std::runtime_error("Pickle LONG wider than 64 bits");
+    }
+    if (bytes.empty()) {
+        return 0;
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (i * 8);
+    }
+    if (bytes.size() < 8 && (static_cast<uint8_t>(bytes.back()) & 0x80)) {
+        value |= ~uint64_t(0) << (bytes.size() * 8);
+    }
+    return static_cast<int64_t>(value);
+}
+
+uint8_t PickleVM::readByte() { return readLE<uint8_t>(); }
+
+/**
+ * @brief read byte for little endian
+ */
+uint16_t PickleVM::readUint16() { return readLE<uint16_t>(); }
+
+/**
+ * @brief read byte for little endian
+ */
+uint32_t PickleVM::readUint32() { return readLE<uint32_t>(); }
+
+int32_t PickleVM::readInt32() { return static_cast<int32_t>(readLE<uint32_t>()); }
+
+/**
+ * @brief Slice up to the next '\n' (which is consumed)
+ */
+std::string_view PickleVM::readLine() {
+    const char* begin = data_ + pos_;
+    const void* newline = std::memchr(begin, '\n', size_ - pos_);
+    if (!newline) {
+        throw PickleUnderflow("Unterminated line in pickle data");
+    }
+    size_t length = static_cast<const char*>(newline) - begin;
+    pos_ += length + 1;
+    return std::string_view(begin, length);
+}
+
+/**
+ * @brief One bounds check, then a view into the input. No bytes are copied.
+ */
+std::string_view PickleVM::readBytes(size_t count) {
+    if (count > size_ - pos_) {
+        throw PickleUnderflow("Unexpected end of pickle data");
+    }
+    std::string_view bytes(data_ + pos_, count);
+    pos_ += count;
     return bytes;
 }
 
-std::string PickleVM::bytesToHex(const std::string& bytes) {
+int64_t PickleVM::parseInteger(std::string_view text) const {
+    int64_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc()) {
+        throw std::runtime_error("Invalid pickle integer: " + std::string(text));
+    }
+    return value;
+}
+
+std::string PickleVM::bytesToHex(std::string_view bytes) {
     std::stringstream ss;
     ss << std::hex << std::uppercase << std::setfill('0');
     for (unsigned char c : bytes) {
@@ -232,26 +1012,26 @@ std::string PickleVM::parseProto() {
 }
 
 std::string PickleVM::parseGlobal() {
-    std::string module = readLine();
-    std::string name = readLine();
-    return "GLOBAL('" + module + "' '" + name + "')";
+    std::string_view module = readLine();
+    std::string_view name = readLine();
+    return "GLOBAL('" + std::string(module) + "' '" + std::string(name) + "')";
 }
 
 std::string PickleVM::parseBinunicode() {
     uint32_t length = readUint32();
-    std::string str = readBytes(length);
-    return "BINUNICODE('" + str + "')";
+    std::string_view str = readBytes(length);
+    return "BINUNICODE('" + std::string(str) + "')";
 }
 
 std::string PickleVM::parseBinstring() {
     uint32_t length = readUint32();
-    std::string str = readBytes(length);
+    readBytes(length);
     return "BINSTRING(len=" + std::to_string(length) + ")";
 }
 
 std::string PickleVM::parseShortBinstring() {
     uint8_t length = readByte();
-    std::string str = readBytes(length);
+    readBytes(length);
     return "SHORT_BINSTRING(len=" + std::to_string(length) + ")";
 }
 
@@ -295,62 +1075,54 @@ std::string PickleVM::parseBinpersid() {
 }
 
 std::string PickleVM::parseGet() {
-    std::string index = readLine();
-    return "GET(" + index + ")";
+    std::string_view index = readLine();
+    return "GET(" + std::string(index) + ")";
 }
 
 std::string PickleVM::parsePut() {
-    std::string index = readLine();
-    return "PUT(" + index + ")";
+    std::string_view index = readLine();
+    return "PUT(" + std::string(index) + ")";
 }
 
 std::string PickleVM::parseBinbytes() {
     uint32_t length = readUint32();
-    std::string bytes = readBytes(length);
+    readBytes(length);
     return "BINBYTES(len=" + std::to_string(length) + ")";
 }
 
 std::string PickleVM::parseShortBinbytes() {
     uint8_t length = readByte();
-    std::string bytes = readBytes(length);
+    readBytes(length);
     return "SHORT_BINBYTES(len=" + std::to_string(length) + ")";
 }
 
 std::string PickleVM::parseShortBinunicode() {
     uint8_t length = readByte();
-    std::string str = readBytes(length);
-    return "SHORT_BINUNICODE('" + str + "')";
+    std::string_view str = readBytes(length);
+    return "SHORT_BINUNICODE('" + std::string(str) + "')";
 }
 
 std::string PickleVM::parseBinunicode8() {
-    // Read 8 bytes for length (uint64_t)
-    uint64_t length = 0;
-    for (int i = 0; i < 8; ++i) {
-        length |= (static_cast<uint64_t>(readByte()) << (i * 8));
-    }
-    std::string str = readBytes(length);
+    uint64_t length = readLE<uint64_t>();
+    readBytes(length);
     return "BINUNICODE8(len=" + std::to_string(length) + ")";
 }
 
 std::string PickleVM::parseBinbytes8() {
-    // Read 8 bytes for length (uint64_t)
-    uint64_t length = 0;
-    for (int i = 0; i < 8; ++i) {
-        length |= (static_cast<uint64_t>(readByte()) << (i * 8));
-    }
-    std::string bytes = readBytes(length);
+    uint64_t length = readLE<uint64_t>();
+    readBytes(length);
     return "BINBYTES8(len=" + std::to_string(length) + ")";
 }
 
 std::string PickleVM::parseLong1() {
     uint8_t length = readByte();
-    std::string bytes = readBytes(length);
+    readBytes(length);
     return "LONG1(len=" + std::to_string(length) + ")";
 }
 
 std::string PickleVM::parseLong4() {
     uint32_t length = readUint32();
-    std::string bytes = readBytes(length);
+    readBytes(length);
     return "LONG4(len=" + std::to_string(length) + ")";
 }
 
@@ -358,11 +1130,7 @@ std::string PickleVM::parseLong4() {
  * @brief read 8 bytes for frame size (uint64_t)
  */
 std::string PickleVM::parseFrame() {
-    
-    uint64_t frame_size = 0;
-    for (int i = 0; i < 8; ++i) {
-        frame_size |= (static_cast<uint64_t>(readByte()) << (i * 8));
-    }
+    uint64_t frame_size = readLE<uint64_t>();
     return "FRAME(" + std::to_string(frame_size) + ")";
 }
 
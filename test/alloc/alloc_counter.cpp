@@ -0,0 +1,36 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> g_count_allocations{false};
+std::atomic<size_t> g_allocations{0};
+
+}  // namespace
+
+AllocationCounter::AllocationCounter() {
+  g_allocations.store(0, std::memory_order_relaxed);
+  g_count_allocations.store(true, std::memory_order_release);
+}
+
+AllocationCounter::~AllocationCounter() {
+  g_count_allocations.store(false, std::memory_order_release);
+}
+
+size_t AllocationCounter::count() const { return g_allocations.load(std::memory_order_relaxed); }
+
+void* operator new(size_t size) {
+  if (g_count_allocations.load(std::memory_order_relaxed)) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
@@ -0,0 +1,23 @@
+#ifndef ALLOC_COUNTER_H_
+#define ALLOC_COUNTER_H_
+
+#include <cstddef>
+
+/**
+ * @brief 살아 있는 동안 전역 operator new 호출을 센다 (모든 스레드)
+ *
+ * 대체 operator new / delete 는 alloc_counter.cpp 에 있고 tfe_alloc_tests 에만 링크된다.
+ * 호출하는 쪽과 다른 번역 단위라서 new 와 free 가 한 함수로 inline 되지 않는다.
+ */
+class AllocationCounter {
+ public:
+  AllocationCounter();
+  ~AllocationCounter();
+
+  AllocationCounter(const AllocationCounter&)            = delete;
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  size_t count() const;
+};
+
+#endif  // ALLOC_COUNTER_H_
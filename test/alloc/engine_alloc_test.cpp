@@ -0,0 +1,66 @@
+#include "engine_alloc_test.h"
+
+#include <memory>
+
+#include "alloc_counter.h"
+#include "util/work_stealing_pool.h"
+
+void EngineAllocTest::SetUp() {
+  using tfe::engine::OpKind;
+  int32_t x = graph_.addSlot("x", {1, 8, 10, 10});
+  graph_.inputs.push_back(x);
+
+  int32_t relu = graph_.addSlot("encoder.relu", {1, 16, 10, 10});
+  graph_.addOp(OpKind::RELU, {conv(x, 16, 3, "encoder.conv1")}, relu, "encoder.relu");
+  int32_t sum = graph_.addSlot("add", {1, 8, 10, 10});
+  graph_.addOp(OpKind::ADD, {conv(relu, 8, 1, "head.conv"), x}, sum, "add");
+  int32_t out = graph_.addSlot("sigmoid", {1, 8, 10, 10});
+  graph_.addOp(OpKind::SIGMOID, {sum}, out, "sigmoid");
+  graph_.outputs.push_back(out);
+}
+
+tfe::tensor::Tensor EngineAllocTest::random(const std::vector<int64_t>& sizes) {
+  std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+  tfe::tensor::Tensor t = tfe::tensor::empty(sizes);
+  for (int64_t i = 0; i < t.numel(); ++i) {
+    t.data<float>()[i] = dist(rng_);
+  }
+  return t;
+}
+
+int32_t EngineAllocTest::conv(int32_t x, int64_t oc, int64_t k, const std::string& name) {
+  const std::vector<int64_t> in = graph_.slots[x].sizes;
+  int32_t out                   = graph_.addSlot(name, {in[0], oc, in[2], in[3]});
+  tfe::engine::Op& op =
+      graph_.addOp(tfe::engine::OpKind::CONV2D,
+                   {x, graph_.addConstant(name + ".weight", random({oc, in[1], k, k})),
+                    graph_.addConstant(name + ".bias", random({oc}))},
+                   out, name);
+  op.params.padding[0] = op.params.padding[1] = k / 2;
+  return out;
+}
+
+TEST_F(EngineAllocTest, RunDoesNotAllocate) {
+  tfe::engine::Engine engine(graph_);
+  std::vector<tfe::tensor::Tensor> inputs = {random({1, 8, 10, 10})};
+  engine.run(inputs);
+
+  AllocationCounter counter;
+  engine.run(inputs);
+  EXPECT_EQ(counter.count(), 0u);
+}
+
+TEST_F(EngineAllocTest, ProfiledRunDoesNotAllocate) {
+  tfe::engine::EngineOptions options;
+  options.pool = std::make_shared<tfe::util::WorkStealingPool>(2, false);
+  tfe::engine::Engine engine(graph_, options);
+  engine.enableProfiling();
+  std::vector<tfe::tensor::Tensor> inputs = {random({1, 8, 10, 10})};
+  engine.run(inputs);
+
+  // 켜 둔 뒤에도 run() 은 heap 을 건드리지 않는다
+  AllocationCounter counter;
+  engine.run(inputs);
+  EXPECT_EQ(counter.count(), 0u);
+  EXPECT_FALSE(engine.profiler()->events().empty());
+}
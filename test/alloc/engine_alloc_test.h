@@ -0,0 +1,33 @@
+#ifndef ENGINE_ALLOC_TEST_H_
+#define ENGINE_ALLOC_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "engine/engine.h"
+
+/**
+ * @brief Engine::run() 이 heap 을 건드리지 않는지 본다. 전역 operator new 를 바꾸므로
+ *        tfe_tests 와 따로 tfe_alloc_tests 로 빌드된다
+ */
+class EngineAllocTest : public ::testing::Test {
+ protected:
+  tfe::engine::Graph graph_;
+
+  /**
+   * @brief x(1, 8, 10, 10) -> conv(16, 3x3) -> relu -> conv(8, 1x1) -> (+x) -> sigmoid
+   */
+  void SetUp() override;
+
+  tfe::tensor::Tensor random(const std::vector<int64_t>& sizes);
+
+ private:
+  int32_t conv(int32_t x, int64_t oc, int64_t k, const std::string& name);
+
+  std::mt19937 rng_{7};
+};
+
+#endif  // ENGINE_ALLOC_TEST_H_
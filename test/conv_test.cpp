@@ -0,0 +1,294 @@
+#include "conv_test.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "engine/kernels.h"
+#include "tensor/layout.h"
+
+namespace {
+
+const tfe::engine::ConvAlgo kAlgos[] = {
+    tfe::engine::ConvAlgo::IM2COL_GEMM, tfe::engine::ConvAlgo::DIRECT_1X1,
+    tfe::engine::ConvAlgo::DEPTHWISE, tfe::engine::ConvAlgo::WINOGRAD_3X3};
+
+int64_t numel(const std::vector<int64_t>& shape) {
+  int64_t n = 1;
+  for (int64_t s : shape) {
+    n *= s;
+  }
+  return n;
+}
+
+}  // namespace
+
+std::vector<float> ConvTest::random(int64_t n) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> values(n);
+  for (float& v : values) {
+    v = dist(rng_);
+  }
+  return values;
+}
+
+int ConvTest::checkAllVariants(const Case& c) {
+  using tfe::tensor::Layout;
+  tfe::engine::OpParams params;
+  params.stride[0]   = params.stride[1]   = c.stride;
+  params.padding[0]  = params.padding[1]  = c.padding;
+  params.dilation[0] = params.dilation[1] = c.dilation;
+  params.groups      = c.groups;
+
+  std::vector<float> input  = random(numel(c.in));
+  std::vector<float> weight = random(numel(c.w));
+  std::vector<float> bias   = random(c.w[0]);
+
+  tfe::engine::ConvKernel reference(c.in, c.w, weight.data(), bias.data(), params,
+                                    tfe::engine::ConvAlgo::REFERENCE);
+  const std::vector<int64_t>& out = reference.outputShape();
+  std::vector<float> expected(numel(out));
+  reference.run(input.data(), expected.data(), nullptr);
+
+  int checked = 0;
+  for (tfe::engine::ConvAlgo algo : kAlgos) {
+    if (!tfe::engine::convAlgoApplies(algo, c.in, c.w, params)) {
+      continue;
+    }
+    for (tfe::engine::Isa isa : tfe::engine::supportedIsas()) {
+      tfe::engine::ConvKernel kernel(c.in, c.w, weight.data(), bias.data(), params, algo, isa,
+                                     Layout::NCHW, Layout::NCHW, {}, pool_);
+      std::vector<float> workspace(kernel.workspaceBytes() / sizeof(float));
+      std::vector<float> actual(expected.size(), NAN);
+      kernel.run(input.data(), actual.data(), workspace.data());
+
+      // Winograd 는 변환에서 반올림 오차가 조금 더 쌓인다
+      const float tolerance = algo == tfe::engine::ConvAlgo::WINOGRAD_3X3 ? 1e-3f : 1e-4f;
+      for (size_t i = 0; i < expected.size(); ++i) {
+        float scale = std::max(1.0f, std::fabs(expected[i]));
+        if (!(std::fabs(actual[i] - expected[i]) <= tolerance * scale)) {
+          ADD_FAILURE() << tfe::engine::convAlgoToString(algo) << "/"
+                        << tfe::engine::isaToString(isa) << " at " << i << ": " << actual[i]
+                        << " vs " << expected[i];
+          return checked;
+        }
+      }
+      ++checked;
+    }
+  }
+  return checked;
+}
+
+int ConvTest::checkBlocked(const Case& c) {
+  using tfe::tensor::Layout;
+  tfe::engine::OpParams params;
+  params.stride[0]   = params.stride[1]   = c.stride;
+  params.padding[0]  = params.padding[1]  = c.padding;
+  params.dilation[0] = params.dilation[1] = c.dilation;
+  params.groups      = c.groups;
+
+  std::vector<float> input  = random(numel(c.in));
+  std::vector<float> weight = random(numel(c.w));
+  std::vector<float> bias   = random(c.w[0]);
+
+  tfe::engine::ConvKernel reference(c.in, c.w, weight.data(), bias.data(), params,
+                                    tfe::engine::ConvAlgo::REFERENCE);
+  const std::vector<int64_t>& out = reference.outputShape();
+  std::vector<float> expected(numel(out));
+  reference.run(input.data(), expected.data(), nullptr);
+
+  int checked = 0;
+  for (Layout blocked : {Layout::NCHW8C, Layout::NCHW16C}) {
+    std::vector<float> packed(tfe::tensor::physicalNumel(c.in, blocked));
+    tfe::tensor::reorder(input.data(), Layout::NCHW, packed.data(), blocked, c.in);
+    for (Layout in_layout : {Layout::NCHW, blocked}) {
+      if (!tfe::engine::convLayoutApplies(c.in, c.w, params, in_layout, blocked)) {
+        continue;
+      }
+      const float* src = in_layout == Layout::NCHW ? input.data() : packed.data();
+      for (tfe::engine::Isa isa : tfe::engine::supportedIsas()) {
+        tfe::engine::ConvKernel kernel(c.in, c.w, weight.data(), bias.data(), params,
+                                       tfe::engine::ConvAlgo::AUTO, isa, in_layout, blocked,
+                                       {}, pool_);
+        EXPECT_EQ(kernel.algo(), tfe::engine::ConvAlgo::DIRECT_NCHWC);
+        EXPECT_EQ(kernel.workspaceBytes(), 0u);
+        std::vector<float> result(tfe::tensor::physicalNumel(out, blocked), NAN);
+        std::vector<float> actual(expected.size());
+        kernel.run(src, result.data(), nullptr);
+        tfe::tensor::reorder(result.data(), blocked, actual.data(), Layout::NCHW, out);
+
+        for (size_t i = 0; i < expected.size(); ++i) {
+          float scale = std::max(1.0f, std::fabs(expected[i]));
+          if (!(std::fabs(actual[i] - expected[i]) <= 1e-4f * scale)) {
+            ADD_FAILURE() << tfe::tensor::layoutToString(in_layout) << " -> "
+                          << tfe::tensor::layoutToString(blocked) << "/"
+                          << tfe::engine::isaToString(isa) << " at " << i << ": " << actual[i]
+                          << " vs " << expected[i];
+            return checked;
+          }
+        }
+        ++checked;
+      }
+    }
+  }
+  return checked;
+}
+
+int ConvTest::checkInt8(const Case& c) {
+  tfe::engine::OpParams params;
+  params.stride[0]   = params.stride[1]   = c.stride;
+  params.padding[0]  = params.padding[1]  = c.padding;
+  params.dilation[0] = params.dilation[1] = c.dilation;
+  params.input_scale = 0.01f;
+  params.input_zero  = 37;
+
+  // 입력과 weight 를 격자 위에서 고르면 양자화가 정확하므로 정수 GEMM 은 float 참조와 반올림
+  // 오차만큼만 다르다
+  std::uniform_int_distribution<int> u8(0, 255), s8(-127, 127);
+  std::vector<float> input(numel(c.in));
+  for (float& v : input) {
+    v = params.input_scale * static_cast<float>(u8(rng_) - params.input_zero);
+  }
+  const int64_t taps = numel(c.w) / c.w[0];
+  std::vector<int8_t> quantized(numel(c.w));
+  std::vector<float> scales(c.w[0]), weight(numel(c.w));
+  for (int64_t o = 0; o < c.w[0]; ++o) {
+    scales[o] = 0.001f * static_cast<float>(1 + o % 5);
+    for (int64_t k = 0; k < taps; ++k) {
+      quantized[o * taps + k] = static_cast<int8_t>(s8(rng_));
+      weight[o * taps + k]    = scales[o] * quantized[o * taps + k];
+    }
+  }
+  std::vector<float> bias = random(c.w[0]);
+
+  tfe::engine::ConvKernel reference(c.in, c.w, weight.data(), bias.data(), params,
+                                    tfe::engine::ConvAlgo::REFERENCE);
+  std::vector<float> expected(numel(reference.outputShape()));
+  reference.run(input.data(), expected.data(), nullptr);
+
+  int checked = 0;
+  for (tfe::engine::Isa isa : tfe::engine::supportedIsas()) {
+    tfe::engine::ConvKernel kernel(c.in, c.w, quantized.data(), scales.data(), bias.data(), params,
+                                   isa, {}, pool_);
+    EXPECT_EQ(kernel.algo(), tfe::engine::ConvAlgo::INT8_GEMM);
+    std::vector<float> workspace(kernel.workspaceBytes() / sizeof(float));
+    std::vector<float> actual(expected.size(), NAN);
+    kernel.run(input.data(), actual.data(), workspace.data());
+
+    for (size_t i = 0; i < expected.size(); ++i) {
+      float scale = std::max(1.0f, std::fabs(expected[i]));
+      if (!(std::fabs(actual[i] - expected[i]) <= 1e-4f * scale)) {
+        ADD_FAILURE() << tfe::engine::isaToString(isa) << " ("
+                      << tfe::engine::int8KernelName(isa) << ") at " << i << ": " << actual[i]
+                      << " vs " << expected[i];
+        return checked;
+      }
+    }
+    ++checked;
+  }
+  return checked;
+}
+
+TEST_F(ConvTest, Winograd3x3MatchesReference) {
+  // 홀수 크기라 마지막 tile 이 출력 밖으로 반쯤 나간다
+  EXPECT_GE(checkAllVariants({{2, 16, 13, 11}, {20, 16, 3, 3}, 1, 1}), 2);
+  EXPECT_GE(checkAllVariants({{1, 8, 9, 10}, {7, 8, 3, 3}, 1, 0}), 2);
+  // tile 행이 벡터 폭보다 넓어 SIMD 변환과 나머지 열이 함께 돈다
+  EXPECT_GE(checkAllVariants({{1, 16, 6, 37}, {16, 16, 3, 3}, 1, 1}), 2);
+}
+
+TEST_F(ConvTest, Im2colGemmMatchesReference) {
+  EXPECT_GE(checkAllVariants({{1, 3, 23, 31}, {10, 3, 7, 7}, 2, 3}), 1);
+  EXPECT_GE(checkAllVariants({{1, 8, 12, 12}, {6, 4, 3, 3}, 1, 1, 1, 2}), 1);
+  EXPECT_GE(checkAllVariants({{1, 5, 17, 19}, {9, 5, 3, 3}, 1, 2, 2}), 1);
+  EXPECT_GE(checkAllVariants({{1, 24, 9, 9}, {13, 24, 1, 1}, 2, 0}), 1);
+  // K > kGemmKC, N > kGemmNC: B 블록이 여러 개로 나뉜다
+  EXPECT_GE(checkAllVariants({{1, 32, 26, 25}, {10, 32, 3, 3}}), 2);
+}
+
+TEST_F(ConvTest, Direct1x1MatchesReference) {
+  EXPECT_GE(checkAllVariants({{2, 24, 7, 9}, {13, 24, 1, 1}}), 2);
+}
+
+TEST_F(ConvTest, DepthwiseMatchesReference) {
+  EXPECT_GE(checkAllVariants({{1, 12, 15, 14}, {12, 1, 3, 3}, 1, 1, 1, 12}), 2);
+  EXPECT_GE(checkAllVariants({{1, 12, 15, 14}, {12, 1, 5, 5}, 2, 2, 1, 12}), 2);
+  // stride 가 있는 넓은 행: stride 2 는 짝수 열 골라 내기, stride 3 은 gather / vld3
+  EXPECT_GE(checkAllVariants({{1, 8, 6, 41}, {8, 1, 3, 3}, 2, 1, 1, 8}), 2);
+  EXPECT_GE(checkAllVariants({{1, 8, 7, 50}, {8, 1, 3, 3}, 3, 1, 1, 8}), 2);
+}
+
+TEST_F(ConvTest, BlockedMatchesReference) {
+  // 묶음 8 / 16 둘 다, 입력은 NCHW 와 묶인 layout 둘 다
+  EXPECT_GE(checkBlocked({{2, 32, 13, 11}, {32, 32, 3, 3}, 1, 1}), 4);
+  // 첫 conv 처럼 3 채널 NCHW 입력, stride 2 / 7x7 로 가장자리 픽셀이 넓다
+  EXPECT_GE(checkBlocked({{1, 3, 23, 30}, {16, 3, 7, 7}, 2, 3}), 2);
+  EXPECT_GE(checkBlocked({{1, 16, 9, 31}, {48, 16, 1, 1}}), 4);
+  EXPECT_GE(checkBlocked({{1, 16, 17, 19}, {16, 16, 3, 3}, 1, 2, 2}), 4);
+  // depthwise 는 묶인 입력만
+  EXPECT_GE(checkBlocked({{1, 32, 15, 14}, {32, 1, 3, 3}, 1, 1, 1, 32}), 2);
+  EXPECT_GE(checkBlocked({{1, 32, 15, 14}, {32, 1, 5, 5}, 2, 2, 1, 32}), 2);
+
+  tfe::engine::OpParams params;
+  EXPECT_FALSE(tfe::engine::convLayoutApplies({1, 16, 8, 8}, {20, 16, 3, 3}, params,
+                                              tfe::tensor::Layout::NCHW,
+                                              tfe::tensor::Layout::NCHW8C));
+  EXPECT_THROW(tfe::engine::ConvKernel({1, 16, 8, 8}, {16, 16, 3, 3}, nullptr, nullptr, params,
+                                       tfe::engine::ConvAlgo::IM2COL_GEMM,
+                                       tfe::engine::bestIsa(), tfe::tensor::Layout::NCHW,
+                                       tfe::tensor::Layout::NCHW8C),
+               std::invalid_argument);
+}
+
+TEST_F(ConvTest, SplitsAcrossPoolWorkers) {
+  // 코어 수와 상관없이 worker 3 개 + 호출 스레드로 나눠 돌려도 참조와 같아야 한다
+  tfe::util::WorkStealingPool pool(4, false);
+  pool_ = &pool;
+  EXPECT_GE(checkAllVariants({{2, 16, 13, 11}, {20, 16, 3, 3}, 1, 1}), 2);
+  // 열 블록이 하나뿐이라 출력 채널 panel 로 나뉜다
+  EXPECT_GE(checkAllVariants({{1, 32, 7, 7}, {64, 32, 1, 1}}), 2);
+  EXPECT_GE(checkAllVariants({{1, 32, 26, 25}, {30, 32, 3, 3}, 2, 1}), 1);
+  EXPECT_GE(checkAllVariants({{2, 12, 15, 14}, {12, 1, 3, 3}, 1, 1, 1, 12}), 2);
+  EXPECT_GE(checkBlocked({{2, 32, 13, 11}, {32, 32, 3, 3}, 1, 1}), 4);
+  EXPECT_GE(checkBlocked({{1, 32, 15, 14}, {32, 1, 3, 3}, 1, 1, 1, 32}), 2);
+}
+
+TEST_F(ConvTest, Int8MatchesDequantizedReference) {
+  // 출력 채널이 panel (8 행) 의 배수가 아니고, 열은 32 열 panel 의 배수가 아니다
+  EXPECT_GE(checkInt8({{1, 16, 9, 11}, {20, 16, 3, 3}, 1, 1}), 1);
+  // K 가 4 의 배수가 아니고 (3 x 1 x 1), 열 블록이 여러 개다
+  EXPECT_GE(checkInt8({{2, 3, 20, 30}, {8, 3, 1, 1}}), 1);
+  EXPECT_GE(checkInt8({{1, 5, 17, 19}, {9, 5, 3, 3}, 2, 2, 2}), 1);
+  tfe::util::WorkStealingPool pool(4, false);
+  pool_ = &pool;
+  EXPECT_GE(checkInt8({{1, 32, 26, 25}, {30, 32, 3, 3}, 1, 1}), 1);
+
+  tfe::engine::OpParams params;
+  const int8_t weight[16] = {};
+  const float scale[1]    = {1.0f};
+  EXPECT_THROW(tfe::engine::ConvKernel({1, 16, 8, 8}, {1, 16, 1, 1}, weight, scale, nullptr,
+                                       params),
+               std::invalid_argument);
+}
+
+TEST_F(ConvTest, SelectsAlgoByShape) {
+  using tfe::engine::ConvAlgo;
+  tfe::engine::OpParams params;
+  EXPECT_EQ(tfe::engine::selectConvAlgo({1, 64, 56, 56}, {64, 64, 1, 1}, params),
+            ConvAlgo::DIRECT_1X1);
+  EXPECT_EQ(tfe::engine::selectConvAlgo({1, 3, 64, 64}, {16, 3, 3, 3}, params),
+            ConvAlgo::IM2COL_GEMM);
+  params.padding[0] = params.padding[1] = 1;
+  EXPECT_EQ(tfe::engine::selectConvAlgo({1, 64, 56, 56}, {64, 64, 3, 3}, params),
+            ConvAlgo::WINOGRAD_3X3);
+  params.groups = 64;
+  EXPECT_EQ(tfe::engine::selectConvAlgo({1, 64, 56, 56}, {64, 1, 3, 3}, params),
+            ConvAlgo::DEPTHWISE);
+  params.groups    = 1;
+  params.stride[0] = params.stride[1] = 2;
+  EXPECT_EQ(tfe::engine::selectConvAlgo({1, 64, 56, 56}, {64, 64, 3, 3}, params),
+            ConvAlgo::IM2COL_GEMM);
+
+  EXPECT_THROW(tfe::engine::ConvKernel({1, 64, 8, 8}, {64, 64, 3, 3}, nullptr, nullptr, params,
+                                       ConvAlgo::WINOGRAD_3X3),
+               std::invalid_argument);
+}
@@ -0,0 +1,47 @@
+#ifndef CONV_TEST_H_
+#define CONV_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "engine/conv.h"
+#include "util/work_stealing_pool.h"
+
+/**
+ * @brief 모든 conv algo / ISA 조합을 scalar 참조 커널 (kernels::conv2d) 과 비교한다
+ */
+class ConvTest : public ::testing::Test {
+ protected:
+  struct Case {
+    std::vector<int64_t> in;  // N, C, H, W
+    std::vector<int64_t> w;   // OC, C / groups, KH, KW
+    int64_t stride   = 1;
+    int64_t padding  = 0;
+    int64_t dilation = 1;
+    int64_t groups   = 1;
+  };
+
+  std::vector<float> random(int64_t n);
+  /**
+   * @return 비교한 (algo, isa) 조합 수
+   */
+  int checkAllVariants(const Case& c);
+  /**
+   * @brief DIRECT_NCHWC 를 ISA / 묶음 layout / 입력 layout (NCHW, 묶음) 마다 참조와 비교한다
+   * @return 비교한 조합 수
+   */
+  int checkBlocked(const Case& c);
+  /**
+   * @brief INT8_GEMM 을 ISA 마다, 양자화 격자 위의 입력 / weight 로 돈 float 참조와 비교한다
+   * @return 비교한 ISA 수
+   */
+  int checkInt8(const Case& c);
+
+  std::mt19937 rng_{1234};
+  tfe::util::WorkStealingPool* pool_ = nullptr;  // 비교할 커널을 돌릴 pool (없으면 호출 스레드)
+};
+
+#endif  // CONV_TEST_H_
@@ -0,0 +1,336 @@
+#!/usr/bin/env python3
+"""EngineTest.MatchesGoldenOutput 의 고정 입력 / 모델 / 기대 출력을 만든다.
+
+    python3 make_golden.py           # PyTorch 가 있으면 torch.jit.trace / torch.jit.save 와 libtorch 출력
+    python3 make_golden.py --no-torch  # torch 없이 같은 아카이브 배치를 직접 쓰고 float64 참조로 계산
+
+만드는 파일 (이 디렉터리):
+    tiny_net.pt            conv(3->8, 3x3, pad 1) -> bn -> relu -> max_pool(2) -> flatten -> linear(128->5)
+                           -> sigmoid 를 trace 한 모듈
+    tiny_net_input.bin     [1, 3, 8, 8] float32 little-endian
+    tiny_net_expected.bin  [1, 5] float32 little-endian
+
+weight 와 입력은 난수가 아니라 아래 식으로 정하므로 두 경로가 같은 값을 쓴다.
+"""
+
+import argparse
+import math
+import os
+import struct
+import sys
+import types
+import zipfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+NAME = "tiny_net"
+
+IN_SHAPE = (1, 3, 8, 8)
+CONV_OUT = 8
+FC_OUT   = 5
+FC_IN    = CONV_OUT * 4 * 4
+EPS      = 1e-5
+
+
+def pattern(n, mul, mod, scale):
+    """[-(mod // 2), mod // 2] 를 도는 정수열을 scale 로 나눈 값. float32 로 정확히 표현된다"""
+    return [((i * mul) % mod - mod // 2) / scale for i in range(n)]
+
+
+def parameters():
+    return {
+        "conv.weight": pattern(CONV_OUT * 3 * 3 * 3, 7, 13, 32.0),
+        "conv.bias": pattern(CONV_OUT, 3, 5, 16.0),
+        "bn.weight": [1.0 + v for v in pattern(CONV_OUT, 5, 7, 16.0)],
+        "bn.bias": pattern(CONV_OUT, 2, 9, 16.0),
+        "bn.running_mean": pattern(CONV_OUT, 3, 11, 32.0),
+        "bn.running_var": [0.5 + abs(v) for v in pattern(CONV_OUT, 5, 9, 8.0)],
+        "fc.weight": pattern(FC_OUT * FC_IN, 11, 17, 64.0),
+        "fc.bias": pattern(FC_OUT, 1, 5, 8.0),
+    }
+
+
+def inputs():
+    return pattern(math.prod(IN_SHAPE), 5, 23, 8.0)
+
+
+def reference(p, x):
+    """float64 로 계산한 forward"""
+    _, c_in, h, w = IN_SHAPE
+    at = lambda t, c, y, xx: t[(c * h + y) * w + xx]
+    y = []
+    for o in range(CONV_OUT):
+        scale = p["bn.weight"][o] / math.sqrt(p["bn.running_var"][o] + EPS)
+        for oy in range(h):
+            for ox in range(w):
+                acc = p["conv.bias"][o]
+                for c in range(c_in):
+                    for ky in range(3):
+                        for kx in range(3):
+                            iy, ix = oy + ky - 1, ox + kx - 1
+                            if 0 <= iy < h and 0 <= ix < w:
+                                k = ((o * c_in + c) * 3 + ky) * 3 + kx
+                                acc += p["conv.weight"][k] * at(x, c, iy, ix)
+                v = (acc - p["bn.running_mean"][o]) * scale + p["bn.bias"][o]
+                y.append(max(v, 0.0))
+    pooled = []
+    for o in range(CONV_OUT):
+        for py in range(h // 2):
+            for px in range(w // 2):
+                pooled.append(max(at(y, o, 2 * py + dy, 2 * px + dx)
+                                  for dy in range(2) for dx in range(2)))
+    out = []
+    for f in range(FC_OUT):
+        acc = p["fc.bias"][f] + sum(p["fc.weight"][f * FC_IN + i] * pooled[i]
+                                    for i in range(FC_IN))
+        out.append(1.0 / (1.0 + math.exp(-acc)))
+    return out
+
+
+def write_floats(path, values):
+    with open(path, "wb") as f:
+        f.write(struct.pack("<%df" % len(values), *values))
+
+
+# --- torch 경로 -------------------------------------------------------------------------------
+
+
+def export_with_torch(p, x):
+    import torch
+    from torch import nn
+
+    class TinyNet(nn.Module):
+        def __init__(self):
+            super().__init__()
+            self.conv = nn.Conv2d(3, CONV_OUT, 3, padding=1)
+            self.bn   = nn.BatchNorm2d(CONV_OUT)
+            self.pool = nn.MaxPool2d(2)
+            self.fc   = nn.Linear(FC_IN, FC_OUT)
+
+        def forward(self, x):
+            y = torch.relu(self.bn(self.conv(x)))
+            return torch.sigmoid(self.fc(torch.flatten(self.pool(y), 1)))
+
+    net = TinyNet().eval()
+    with torch.no_grad():
+        for name, tensor in net.state_dict().items():
+            if name in p:
+                tensor.copy_(torch.tensor(p[name]).reshape(tensor.shape))
+    inp = torch.tensor(x, dtype=torch.float32).reshape(IN_SHAPE)
+    traced = torch.jit.trace(net, inp)
+    torch.jit.save(traced, os.path.join(HERE, NAME + ".pt"))
+    with torch.no_grad():
+        return traced(inp).flatten().tolist()
+
+
+# --- torch 없는 경로: torch.jit.save 와 같은 배치의 아카이브를 직접 쓴다 ----------------------------
+
+CODE = {
+    "code/__torch__.py": """class TinyNet(Module):
+  __parameters__ = []
+  __buffers__ = []
+  training : bool
+  _is_full_backward_hook : Optional[bool]
+  conv : __torch__.torch.nn.modules.conv.Conv2d
+  bn : __torch__.torch.nn.modules.batchnorm.BatchNorm2d
+  pool : __torch__.torch.nn.modules.pooling.MaxPool2d
+  fc : __torch__.torch.nn.modules.linear.Linear
+  def forward(self: __torch__.TinyNet,
+    x: Tensor) -> Tensor:
+    fc = self.fc
+    pool = self.pool
+    bn = self.bn
+    conv = self.conv
+    _0 = (bn).forward((conv).forward(x, ), )
+    input = torch.relu(_0)
+    _1 = torch.flatten((pool).forward(input, ), 1)
+    _2 = torch.sigmoid((fc).forward(_1, ))
+    return _2
+""",
+    "code/__torch__/torch/nn/modules/conv.py": """class Conv2d(Module):
+  __parameters__ = ["weight", "bias", ]
+  __buffers__ = []
+  weight : Tensor
+  bias : Tensor
+  training : bool
+  _is_full_backward_hook : Optional[bool]
+  def forward(self: __torch__.torch.nn.modules.conv.Conv2d,
+    x: Tensor) -> Tensor:
+    bias = self.bias
+    weight = self.weight
+    input = torch._convolution(x, weight, bias, [1, 1], [1, 1], [1, 1], False, [0, 0], 1, False, False, True, True)
+    return input
+""",
+    "code/__torch__/torch/nn/modules/batchnorm.py": """class BatchNorm2d(Module):
+  __parameters__ = ["weight", "bias", ]
+  __buffers__ = ["running_mean", "running_var", "num_batches_tracked", ]
+  weight : Tensor
+  bias : Tensor
+  running_mean : Tensor
+  running_var : Tensor
+  num_batches_tracked : Tensor
+  training : bool
+  _is_full_backward_hook : Optional[bool]
+  def forward(self: __torch__.torch.nn.modules.batchnorm.BatchNorm2d,
+    argument_1: Tensor) -> Tensor:
+    running_var = self.running_var
+    running_mean = self.running_mean
+    bias = self.bias
+    weight = self.weight
+    input = torch.batch_norm(argument_1, weight, bias, running_mean, running_var, False, 0.10000000000000001, 1.0000000000000001e-05, True)
+    return input
+""",
+    "code/__torch__/torch/nn/modules/pooling.py": """class MaxPool2d(Module):
+  __parameters__ = []
+  __buffers__ = []
+  training : bool
+  _is_full_backward_hook : Optional[bool]
+  def forward(self: __torch__.torch.nn.modules.pooling.MaxPool2d,
+    input: Tensor) -> Tensor:
+    _0 = torch.max_pool2d(input, [2, 2], [2, 2], [0, 0], [1, 1], False)
+    return _0
+""",
+    "code/__torch__/torch/nn/modules/linear.py": """class Linear(Module):
+  __parameters__ = ["weight", "bias", ]
+  __buffers__ = []
+  weight : Tensor
+  bias : Tensor
+  training : bool
+  _is_full_backward_hook : Optional[bool]
+  def forward(self: __torch__.torch.nn.modules.linear.Linear,
+    argument_1: Tensor) -> Tensor:
+    bias = self.bias
+    weight = self.weight
+    return torch.linear(argument_1, weight, bias)
+""",
+}
+
+
+def fake_module(name, **members):
+    module = types.ModuleType(name)
+    for key, value in members.items():
+        value.__module__   = name
+        value.__qualname__ = key
+        setattr(module, key, value)
+    sys.modules[name] = module
+    return module
+
+
+class Tensor:
+    def __init__(self, key, sizes, values, storage, requires_grad):
+        self.key, self.sizes, self.values = key, sizes, values
+        self.storage, self.requires_grad  = storage, requires_grad
+
+
+def export_without_torch(p):
+    def _rebuild_tensor_v2(*args):
+        raise NotImplementedError
+
+    float_storage = type("FloatStorage", (), {})
+    long_storage  = type("LongStorage", (), {})
+    fake_module("torch", FloatStorage=float_storage, LongStorage=long_storage)
+    fake_module("torch._utils", _rebuild_tensor_v2=_rebuild_tensor_v2)
+    classes = {}
+    for module, cls in [("__torch__", "TinyNet"),
+                        ("__torch__.torch.nn.modules.conv", "Conv2d"),
+                        ("__torch__.torch.nn.modules.batchnorm", "BatchNorm2d"),
+                        ("__torch__.torch.nn.modules.pooling", "MaxPool2d"),
+                        ("__torch__.torch.nn.modules.linear", "Linear")]:
+        classes[cls] = type(cls, (), {})
+        fake_module(module, **{cls: classes[cls]})
+
+    storages = []
+
+    def tensor(name, sizes, storage=float_storage, requires_grad=True, values=None):
+        values = p[name] if values is None else values
+        storages.append((storage, values))
+        return Tensor(str(len(storages) - 1), sizes, values, storage, requires_grad)
+
+    def module(cls, **state):
+        obj          = classes[cls].__new__(classes[cls])
+        obj.__dict__ = dict(training=False, _is_full_backward_hook=None, **state)
+        return obj
+
+    net = module(
+        "TinyNet",
+        conv=module("Conv2d", weight=tensor("conv.weight", (CONV_OUT, 3, 3, 3)),
+                    bias=tensor("conv.bias", (CONV_OUT,))),
+        bn=module("BatchNorm2d", weight=tensor("bn.weight", (CONV_OUT,)),
+                  bias=tensor("bn.bias", (CONV_OUT,)),
+                  running_mean=tensor("bn.running_mean", (CONV_OUT,), requires_grad=False),
+                  running_var=tensor("bn.running_var", (CONV_OUT,), requires_grad=False),
+                  num_batches_tracked=tensor("", (), long_storage, False, [0])),
+        pool=module("MaxPool2d"),
+        fc=module("Linear", weight=tensor("fc.weight", (FC_OUT, FC_IN)),
+                  bias=tensor("fc.bias", (FC_OUT,))))
+
+    import collections
+    import io
+    import pickle
+
+    class Pickler(pickle.Pickler):
+        def persistent_id(self, obj):
+            if isinstance(obj, tuple) and len(obj) == 2 and obj[0] == "__storage__":
+                t = obj[1]
+                return ("storage", t.storage, t.key, "cpu", len(t.values))
+            return None
+
+        def reducer_override(self, obj):
+            if not isinstance(obj, Tensor):
+                return NotImplemented
+            strides, step = [], 1
+            for size in reversed(obj.sizes):
+                strides.insert(0, step)
+                step *= size
+            return (_rebuild_tensor_v2, (("__storage__", obj), 0, tuple(obj.sizes),
+                                         tuple(strides), obj.requires_grad,
+                                         collections.OrderedDict()))
+
+    data = io.BytesIO()
+    Pickler(data, protocol=2).dump(net)
+
+    path = os.path.join(HERE, NAME + ".pt")
+    with zipfile.ZipFile(path, "w", zipfile.ZIP_STORED) as archive:
+        def add(name, payload):
+            # torch 처럼 local header 의 "FB" extra field 로 데이터를 64 byte 경계에 맞춘다
+            name   = NAME + "/" + name
+            header = 30 + len(name.encode()) + 4
+            pad    = -(archive.fp.tell() + header) % 64
+            info   = zipfile.ZipInfo(name, date_time=(1980, 1, 1, 0, 0, 0))
+            info.extra = b"FB" + struct.pack("<H", pad) + b"Z" * pad
+            archive.writestr(info, payload)
+
+        add("data.pkl", data.getvalue())
+        for source, text in CODE.items():
+            add(source, text.encode())
+        for key, (storage, values) in enumerate(storages):
+            fmt = "<%d%s" % (len(values), "q" if storage is long_storage else "f")
+            add("data/%d" % key, struct.pack(fmt, *values))
+        add("version", b"3\n")
+        add("byteorder", b"little")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--no-torch", action="store_true", help="PyTorch 가 있어도 쓰지 않는다")
+    args = parser.parse_args()
+
+    p, x = parameters(), inputs()
+    use_torch = not args.no_torch
+    if use_torch:
+        try:
+            import torch  # noqa: F401
+        except ImportError:
+            use_torch = False
+    if use_torch:
+        expected = export_with_torch(p, x)
+    else:
+        export_without_torch(p)
+        expected = reference(p, x)
+    write_floats(os.path.join(HERE, NAME + "_input.bin"), x)
+    write_floats(os.path.join(HERE, NAME + "_expected.bin"), expected)
+    print("wrote %s (%s)" % (NAME, "torch " + __import__("torch").__version__ if use_torch
+                             else "reference"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,1064 @@
+#include "engine_test.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <random>
+#include <thread>
+
+#include "engine/batcher.h"
+#include "engine/compiled_model.h"
+#include "engine/layout_pass.h"
+#include "engine/lowering.h"
+#include "engine/quantization.h"
+#include "engine/script_source.h"
+#include "error/error.h"
+
+#ifndef TFE_TEST_DATA_DIR
+#define TFE_TEST_DATA_DIR "test/data"
+#endif
+
+namespace {
+
+const char* kConv       = "__torch__.torch.nn.modules.conv";
+const char* kBatchNorm  = "__torch__.torch.nn.modules.batchnorm";
+const char* kActivation = "__torch__.torch.nn.modules.activation";
+
+// torch.jit.trace 가 쓰는 모양 그대로 (여러 줄 def 헤더, 위치 인자만 쓰는 aten 호출)
+const char* kTracedNet =
+    "class Net(Module):\n"
+    "  __parameters__ = []\n"
+    "  __buffers__ = []\n"
+    "  training : bool\n"
+    "  conv : __torch__.torch.nn.modules.conv.Conv2d\n"
+    "  bn : __torch__.torch.nn.modules.batchnorm.BatchNorm2d\n"
+    "  def forward(self: __torch__.Net,\n"
+    "    x: Tensor) -> Tensor:\n"
+    "    _0 = self.bn\n"
+    "    _1 = (self.conv).forward(x, )\n"
+    "    y = torch.relu((_0).forward(_1, ))\n"
+    "    z = torch.add(y, x, alpha=1)\n"
+    "    _2 = torch.upsample_nearest2d(z, None, [2., 2.])\n"
+    "    return torch.sigmoid(_2)\n";
+
+const char* kTracedConv =
+    "class Conv2d(Module):\n"
+    "  __parameters__ = [\"weight\", ]\n"
+    "  weight : Tensor\n"
+    "  def forward(self: __torch__.torch.nn.modules.conv.Conv2d,\n"
+    "    x: Tensor) -> Tensor:\n"
+    "    _0 = torch._convolution(x, self.weight, None, [1, 1], [1, 1], [1, 1], False, [0, 0], 1,"
+    " False, False, True, True)\n"
+    "    return _0\n";
+
+const char* kTracedBatchNorm =
+    "class BatchNorm2d(Module):\n"
+    "  def forward(self: __torch__.torch.nn.modules.batchnorm.BatchNorm2d,\n"
+    "    input: Tensor) -> Tensor:\n"
+    "    _0 = torch.batch_norm(input, self.weight, self.bias, self.running_mean, self.running_var,"
+    " False, 0.10000000000000001, 0., True)\n"
+    "    return _0\n";
+
+/**
+ * @brief 난수 weight 로 Graph 를 손으로 쌓는다
+ */
+struct GraphBuilder {
+  tfe::engine::Graph graph;
+  std::mt19937 rng{7};
+  std::uniform_real_distribution<float> dist{-0.5f, 0.5f};
+
+  tfe::tensor::Tensor random(const std::vector<int64_t>& sizes) {
+    tfe::tensor::Tensor t = tfe::tensor::empty(sizes);
+    for (int64_t i = 0; i < t.numel(); ++i) {
+      t.data<float>()[i] = dist(rng);
+    }
+    return t;
+  }
+  int32_t input(const std::string& name, const std::vector<int64_t>& sizes) {
+    int32_t slot = graph.addSlot(name, sizes);
+    graph.inputs.push_back(slot);
+    return slot;
+  }
+  int32_t constant(const std::string& name, const std::vector<int64_t>& sizes) {
+    return graph.addConstant(name, random(sizes));
+  }
+  int32_t conv(int32_t x, int64_t oc, int64_t k, int64_t groups, const std::string& name,
+               int64_t stride = 1) {
+    const std::vector<int64_t> in = graph.slots[x].sizes;
+    const int64_t pad             = k / 2;
+    int32_t out                   = graph.addSlot(
+        name, {in[0], oc, (in[2] + 2 * pad - k) / stride + 1, (in[3] + 2 * pad - k) / stride + 1});
+    tfe::engine::Op& op =
+        graph.addOp(tfe::engine::OpKind::CONV2D,
+                    {x, constant(name + ".weight", {oc, in[1] / groups, k, k}),
+                     constant(name + ".bias", {oc})},
+                    out, name);
+    op.params.padding[0] = op.params.padding[1] = pad;
+    op.params.stride[0] = op.params.stride[1] = stride;
+    op.params.groups                          = groups;
+    return out;
+  }
+  int32_t batchNorm(int32_t x, const std::string& name) {
+    const int64_t channels = graph.slots[x].sizes[1];
+    int32_t out            = graph.addSlot(name, graph.slots[x].sizes);
+    graph.addOp(tfe::engine::OpKind::BATCH_NORM,
+                {x, constant(name + ".scale", {channels}), constant(name + ".shift", {channels})},
+                out, name);
+    return out;
+  }
+  int32_t unary(tfe::engine::OpKind kind, int32_t x, const std::string& name) {
+    int32_t out = graph.addSlot(name, graph.slots[x].sizes);
+    graph.addOp(kind, {x}, out, name);
+    return out;
+  }
+  int32_t binary(tfe::engine::OpKind kind, int32_t a, int32_t b, const std::string& name) {
+    int32_t out = graph.addSlot(name, graph.slots[a].sizes);
+    graph.addOp(kind, {a, b}, out, name);
+    return out;
+  }
+};
+
+}  // namespace
+
+void EngineTest::SetUp() { path_ = ::testing::TempDir() + "tfe_engine_test.pt"; }
+
+void EngineTest::TearDown() { std::remove(path_.c_str()); }
+
+void EngineTest::save(const PickleWriter& data, const std::vector<std::vector<float>>& storages,
+                      const std::vector<std::pair<std::string, std::string>>& sources) {
+  ZipWriter writer;
+  writer.add("net/version", "6\n");
+  writer.add("net/byteorder", "little");
+  writer.add("net/data.pkl", data.bytes());
+  for (size_t i = 0; i < storages.size(); ++i) {
+    writer.add("net/data/" + std::to_string(i),
+               std::string(reinterpret_cast<const char*>(storages[i].data()),
+                           storages[i].size() * sizeof(float)));
+  }
+  for (const auto& source : sources) {
+    writer.add("net/" + source.first, source.second, true);
+  }
+  writer.save(path_);
+}
+
+void EngineTest::saveTracedNet() {
+  PickleWriter data;
+  data.proto();
+  data.beginModule("__torch__", "Net");
+  data.str("training").boolean(false);
+  data.str("conv").beginModule(kConv, "Conv2d");
+  data.str("training").boolean(false);
+  data.str("weight").tensor("0", {1, 1, 3, 3}, "FloatStorage", 0, true);
+  data.str("bias").none();
+  data.endModule();
+  data.str("bn").beginModule(kBatchNorm, "BatchNorm2d");
+  data.str("training").boolean(false);
+  data.str("weight").tensor("1", {1}, "FloatStorage", 0, true);
+  data.str("bias").tensor("2", {1}, "FloatStorage", 0, true);
+  data.str("running_mean").tensor("3", {1});
+  data.str("running_var").tensor("4", {1});
+  data.endModule();
+  data.endModule();
+  data.stop();
+  save(data, {std::vector<float>(9, 1.0f), {2.0f}, {-10.0f}, {0.0f}, {1.0f}},
+       {{"code/__torch__.py", kTracedNet},
+        {"code/__torch__/torch/nn/modules/conv.py", kTracedConv},
+        {"code/__torch__/torch/nn/modules/batchnorm.py", kTracedBatchNorm}});
+}
+
+tfe::tensor::Tensor EngineTest::filled(const std::vector<int64_t>& sizes, float value) {
+  tfe::tensor::Tensor t = tfe::tensor::empty(sizes);
+  for (int64_t i = 0; i < t.numel(); ++i) {
+    t.data<float>()[i] = value;
+  }
+  return t;
+}
+
+TEST_F(EngineTest, RunsTracedConvBatchNormResidual) {
+  saveTracedNet();
+
+  tfe::model::ScriptModel model(path_);
+  tfe::engine::Engine engine(model, {{1, 1, 3, 3}});
+  // conv -> batch_norm -> relu -> add -> upsample -> sigmoid. batch_norm 과 relu 는 conv 로 접힌다
+  EXPECT_EQ(tfe::engine::lower(model, {{1, 1, 3, 3}}).ops.size(), 6u);
+  EXPECT_EQ(engine.graph().ops.size(), 4u) << engine.graph().dump();
+
+  std::vector<tfe::tensor::Tensor> outputs = engine.run({filled({1, 1, 3, 3}, 1.0f)});
+  ASSERT_EQ(outputs.size(), 1u);
+  EXPECT_EQ(outputs[0].sizes(), (std::vector<int64_t>{1, 1, 6, 6}));
+
+  // relu(2 * conv(x) - 10) + x = [[1,3,1],[3,9,3],[1,3,1]], 2 배 nearest upsample 후 sigmoid
+  const float expected[3][3] = {{1, 3, 1}, {3, 9, 3}, {1, 3, 1}};
+  const float* out           = outputs[0].data<float>();
+  for (int y = 0; y < 6; ++y) {
+    for (int x = 0; x < 6; ++x) {
+      float want = 1.0f / (1.0f + std::exp(-expected[y / 2][x / 2]));
+      EXPECT_NEAR(out[y * 6 + x], want, 1e-6f) << y << "," << x;
+    }
+  }
+}
+
+TEST_F(EngineTest, MatchesGoldenOutput) {
+  // test/data/golden/make_golden.py 가 만든 trace 모듈과 입력, 기대 출력 (float32 little-endian)
+  const std::string dir = std::string(TFE_TEST_DATA_DIR) + "/golden/";
+  auto readFloats       = [&](const std::string& name, size_t count) {
+    std::ifstream in(dir + name, std::ios::binary);
+    std::vector<float> values(count);
+    in.read(reinterpret_cast<char*>(values.data()), count * sizeof(float));
+    EXPECT_EQ(static_cast<size_t>(in.gcount()), count * sizeof(float)) << dir + name;
+    return values;
+  };
+  const std::vector<float> input    = readFloats("tiny_net_input.bin", 3 * 8 * 8);
+  const std::vector<float> expected = readFloats("tiny_net_expected.bin", 5);
+
+  tfe::model::ScriptModel model(dir + "tiny_net.pt");
+  for (bool blocked : {false, true}) {
+    tfe::engine::EngineOptions options;
+    options.blocked_layout = blocked;
+    tfe::engine::Engine engine(model, {{1, 3, 8, 8}}, options);
+    tfe::tensor::Tensor x = tfe::tensor::empty({1, 3, 8, 8});
+    std::copy(input.begin(), input.end(), x.data<float>());
+
+    const tfe::tensor::Tensor& y = engine.run({x})[0];
+    ASSERT_EQ(y.sizes(), (std::vector<int64_t>{1, 5}));
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_NEAR(y.data<float>()[i], expected[i], 1e-5f) << blocked << " " << i;
+    }
+  }
+}
+
+TEST_F(EngineTest, ScriptedLeafFallsBackToAttributes) {
+  // 분기가 있는 scripted Conv2d 와 소스가 없는 ReLU 는 속성 / 클래스 상수로 lowering 한다
+  const char* net =
+      "class Net(Module):\n"
+      "  def forward(self, x: Tensor) -> Tensor:\n"
+      "    y = (self.conv).forward(x)\n"
+      "    return (self.act).forward(y)\n";
+  const char* conv =
+      "class Conv2d(Module):\n"
+      "  stride : Final[Tuple[int, int]] = (2, 2)\n"
+      "  padding : Final[Tuple[int, int]] = (1, 1)\n"
+      "  def forward(self, input: Tensor) -> Tensor:\n"
+      "    if torch.eq(self.padding_mode, \"zeros\"):\n"
+      "      _0 = torch.conv2d(input, self.weight, self.bias)\n"
+      "    else:\n"
+      "      _0 = input\n"
+      "    return _0\n";
+
+  PickleWriter data;
+  data.proto();
+  data.beginModule("__torch__", "Net");
+  data.str("training").boolean(false);
+  data.str("conv").beginModule(kConv, "Conv2d");
+  data.str("training").boolean(false);
+  data.str("weight").tensor("0", {1, 1, 3, 3}, "FloatStorage", 0, true);
+  data.str("bias").tensor("1", {1}, "FloatStorage", 0, true);
+  data.endModule();
+  data.str("act").beginModule(kActivation, "ReLU");
+  data.str("training").boolean(false);
+  data.endModule();
+  data.endModule();
+  data.stop();
+
+  save(data, {std::vector<float>(9, 1.0f), {-5.0f}},
+       {{"code/__torch__.py", net}, {"code/__torch__/torch/nn/modules/conv.py", conv}});
+
+  tfe::model::ScriptModel model(path_);
+  tfe::engine::Graph lowered = tfe::engine::lower(model, {{1, 1, 4, 4}});
+  ASSERT_EQ(lowered.ops.size(), 2u) << lowered.dump();
+  EXPECT_EQ(lowered.ops[0].params.stride[0], 2);
+
+  tfe::engine::Engine engine(model, {{1, 1, 4, 4}});
+
+  std::vector<tfe::tensor::Tensor> outputs = engine.run({filled({1, 1, 4, 4}, 1.0f)});
+  ASSERT_EQ(outputs[0].sizes(), (std::vector<int64_t>{1, 1, 2, 2}));
+  const float* out = outputs[0].data<float>();
+  EXPECT_FLOAT_EQ(out[0], 0.0f);
+  EXPECT_FLOAT_EQ(out[1], 1.0f);
+  EXPECT_FLOAT_EQ(out[2], 1.0f);
+  EXPECT_FLOAT_EQ(out[3], 4.0f);
+
+  EXPECT_THROW(engine.run({filled({1, 1, 5, 5}, 1.0f)}), std::invalid_argument);
+}
+
+TEST_F(EngineTest, UnsupportedOperatorIsReported) {
+  PickleWriter data;
+  data.proto().beginModule("__torch__", "Net").str("training").boolean(false).endModule().stop();
+  save(data, {},
+       {{"code/__torch__.py",
+         "class Net(Module):\n  def forward(self, x: Tensor) -> Tensor:\n"
+         "    return torch.gelu(x)\n"}});
+
+  tfe::model::ScriptModel model(path_);
+  EXPECT_THROW(tfe::engine::lower(model, {{1, 3, 8, 8}}), tfe::engine::LoweringError);
+}
+
+TEST_F(EngineTest, MemoryPlanReusesActivations) {
+  using tfe::engine::OpKind;
+  // x -> relu -> relu -> relu -> relu, 그리고 마지막에 x 를 다시 더한다
+  tfe::engine::Graph graph;
+  const std::vector<int64_t> shape = {1, 4, 16, 16};
+  int32_t x                        = graph.addSlot("x", shape);
+  graph.inputs.push_back(x);
+  int32_t cur = x;
+  for (int i = 0; i < 4; ++i) {
+    int32_t next = graph.addSlot("relu" + std::to_string(i), shape);
+    graph.addOp(OpKind::RELU, {cur}, next, "");
+    cur = next;
+  }
+  int32_t sum = graph.addSlot("sum", shape);
+  graph.addOp(OpKind::ADD, {cur, x}, sum, "");
+  int32_t flat = graph.addSlot("flat", {1, 4 * 16 * 16});
+  graph.addOp(OpKind::RESHAPE, {sum}, flat, "");
+  graph.outputs.push_back(flat);
+
+  tfe::engine::MemoryPlan plan = tfe::engine::planMemory(graph);
+  const size_t bytes           = 4 * 16 * 16 * sizeof(float);
+  EXPECT_EQ(plan.naive_bytes, 6 * bytes);
+  // x 는 끝까지 살아 있고 relu 사슬은 두 자리를 번갈아 쓴다
+  EXPECT_EQ(plan.arena_bytes, 3 * bytes) << plan.summary();
+  EXPECT_EQ(plan.offsets[flat], plan.offsets[sum]);
+  EXPECT_NE(plan.offsets[sum], plan.offsets[x]);
+
+  tfe::engine::Engine engine(std::move(graph));
+  tfe::tensor::Tensor input = filled(shape, -1.0f);
+  for (int64_t i = 0; i < input.numel(); i += 2) {
+    input.data<float>()[i] = static_cast<float>(i);
+  }
+  const tfe::tensor::Tensor& out = engine.run({input})[0];
+  EXPECT_EQ(out.sizes(), (std::vector<int64_t>{1, 4 * 16 * 16}));
+  for (int64_t i = 0; i < out.numel(); ++i) {
+    float v = input.data<float>()[i];
+    ASSERT_FLOAT_EQ(out.data<float>()[i], (v > 0 ? v : 0) + v) << i;
+  }
+}
+
+TEST_F(EngineTest, PlansActivationsIntoArena) {
+  saveTracedNet();
+
+  tfe::model::ScriptModel model(path_);
+  tfe::engine::Engine engine(model, {{1, 1, 3, 3}});
+  EXPECT_LT(engine.memoryPlan().arena_bytes, engine.memoryPlan().naive_bytes);
+
+  std::vector<tfe::tensor::Tensor> inputs = {filled({1, 1, 3, 3}, 1.0f)};
+  // run() 이 heap 을 건드리지 않는지는 tfe_alloc_tests (test/alloc) 가 본다
+  const tfe::tensor::Tensor& out = engine.run(inputs)[0];
+  EXPECT_EQ(out.sizes(), (std::vector<int64_t>{1, 1, 6, 6}));
+}
+
+TEST_F(EngineTest, ParsesScriptSource) {
+  tfe::engine::ScriptSource source;
+  source.add("code/__torch__/a/b.py",
+             "class Block(Module):\n"
+             "  kernel : Final[int] = 3\n"
+             "  def forward(self: __torch__.a.b.Block,\n"
+             "    x: Tensor,\n"
+             "    y: Tensor) -> Tuple[Tensor, Tensor]:\n"
+             "    _0, _1 = (x, torch.cat([x, y], 1))\n"
+             "    return (_0, -_1 // 2)\n");
+
+  const tfe::engine::ClassDef* block = source.find("__torch__.a.b.Block");
+  ASSERT_NE(block, nullptr);
+  ASSERT_NE(block->constant("kernel"), nullptr);
+  EXPECT_EQ(block->constant("kernel")->i, 3);
+
+  const tfe::engine::Method* forward = block->method("forward");
+  ASSERT_NE(forward, nullptr);
+  EXPECT_EQ(forward->params, (std::vector<std::string>{"self", "x", "y"}));
+  ASSERT_EQ(forward->body.size(), 2u);
+  EXPECT_EQ(forward->body[0].targets, (std::vector<std::string>{"_0", "_1"}));
+  EXPECT_EQ(forward->body[1].kind, tfe::engine::Stmt::Kind::RETURN);
+  EXPECT_EQ(forward->body[1].value->kind, tfe::engine::Expr::Kind::TUPLE);
+}
+
+TEST_F(EngineTest, BlockedLayoutConvertsOnlyAtGraphEdges) {
+  using tfe::engine::OpKind;
+  GraphBuilder b;
+  tfe::engine::Graph& graph = b.graph;
+
+  // 3 채널 입력 -> conv -> bn -> relu -> conv (+ residual) -> maxpool -> 1x1 conv -> depthwise
+  // -> cat(채널) -> sigmoid. 모든 채널이 16 의 배수라 안쪽은 전부 묶인 layout 이어야 한다.
+  // conv2 는 Winograd 후보가 되지 않도록 5x5 로 둔다
+  int32_t x    = b.input("x", {1, 3, 12, 12});
+  int32_t r1   = b.unary(OpKind::RELU, b.batchNorm(b.conv(x, 16, 3, 1, "conv1"), "bn"), "relu1");
+  int32_t sum  = b.binary(OpKind::ADD, b.conv(r1, 16, 5, 1, "conv2"), r1, "add");
+  int32_t pool = graph.addSlot("pool", {1, 16, 6, 6});
+  tfe::engine::Op& pool_op = graph.addOp(OpKind::MAX_POOL2D, {sum}, pool, "pool");
+  pool_op.params.kernel[0] = pool_op.params.kernel[1] = 2;
+  pool_op.params.stride[0] = pool_op.params.stride[1] = 2;
+  int32_t c3  = b.conv(pool, 32, 1, 1, "conv3");
+  int32_t dw  = b.conv(c3, 32, 3, 32, "dw");
+  int32_t cat = graph.addSlot("cat", {1, 64, 6, 6});
+  graph.addOp(OpKind::CAT, {c3, dw}, cat, "cat");
+  graph.outputs.push_back(b.unary(OpKind::SIGMOID, cat, "sigmoid"));
+
+  tfe::tensor::Tensor input = b.random({1, 3, 12, 12});
+
+  tfe::engine::EngineOptions nchw;
+  nchw.blocked_layout = false;
+  nchw.fuse           = false;
+  tfe::engine::Engine reference(graph, nchw);
+  tfe::engine::Engine engine(graph);
+  const tfe::tensor::Layout blocked = tfe::engine::blockedLayoutFor(engine.options().isa);
+
+  // 그래프 출력 앞의 REORDER 하나뿐. 첫 conv 는 NCHW 입력을 그대로 읽는다
+  const tfe::engine::Graph& lowered = engine.graph();
+  int reorders                      = 0;
+  for (size_t i = 0; i < lowered.ops.size(); ++i) {
+    const tfe::engine::Op& op = lowered.ops[i];
+    if (op.kind == OpKind::REORDER) {
+      ++reorders;
+    } else {
+      EXPECT_EQ(lowered.slots[op.output].layout, blocked) << lowered.dump();
+    }
+    if (op.kind == OpKind::CONV2D) {
+      EXPECT_EQ(engine.convKernel(i)->algo(), tfe::engine::ConvAlgo::DIRECT_NCHWC);
+    }
+  }
+  EXPECT_EQ(reorders, 1) << lowered.dump();
+  EXPECT_EQ(lowered.slots[lowered.outputs[0]].layout, tfe::tensor::Layout::NCHW);
+
+  const tfe::tensor::Tensor& want = reference.run({input})[0];
+  const tfe::tensor::Tensor& got  = engine.run({input})[0];
+  ASSERT_EQ(got.sizes(), want.sizes());
+  for (int64_t i = 0; i < got.numel(); ++i) {
+    ASSERT_NEAR(got.data<float>()[i], want.data<float>()[i], 1e-5f) << i;
+  }
+}
+
+TEST_F(EngineTest, BlockedLayoutKeepsWinogradOnNarrowBlocks) {
+  using tfe::engine::OpKind;
+  using tfe::tensor::Layout;
+  for (Layout blocked : {Layout::NCHW8C, Layout::NCHW16C}) {
+    GraphBuilder b;
+    int32_t x = b.input("x", {1, 16, 8, 8});
+    int32_t y = b.conv(b.conv(x, 16, 1, 1, "pw"), 16, 3, 1, "conv3x3");
+    b.graph.outputs.push_back(y);
+    tfe::engine::assignLayouts(b.graph, blocked);
+
+    // 8 lane 이면 3x3 conv 는 NCHW (Winograd) 로 남고, 16 lane 이면 묶인 layout 으로 간다
+    const Layout want = blocked == Layout::NCHW8C ? Layout::NCHW : blocked;
+    for (const tfe::engine::Op& op : b.graph.ops) {
+      if (op.name == "conv3x3") {
+        EXPECT_EQ(b.graph.slots[op.output].layout, want) << b.graph.dump();
+      } else if (op.name == "pw") {
+        EXPECT_EQ(b.graph.slots[op.output].layout, blocked) << b.graph.dump();
+      }
+    }
+  }
+}
+
+TEST_F(EngineTest, FusesIntoConvEpilogue) {
+  using tfe::engine::OpKind;
+  GraphBuilder b;
+  tfe::engine::Graph& graph = b.graph;
+
+  // ResNet block (conv-bn-relu -> conv-bn, downsample conv-bn, add -> relu) 뒤에 depth decoder
+  // (conv-elu -> upsample -> cat(skip) -> conv-sigmoid). conv 마다 NCHW algo 가 다르다
+  int32_t x    = b.input("x", {1, 16, 8, 8});
+  int32_t skip = b.input("skip", {1, 16, 16, 16});
+  int32_t r1   = b.unary(OpKind::RELU, b.batchNorm(b.conv(x, 16, 3, 1, "conv1"), "bn1"), "relu1");
+  int32_t y    = b.batchNorm(b.conv(r1, 16, 3, 1, "conv2"), "bn2");
+  int32_t down = b.batchNorm(b.conv(x, 16, 1, 1, "downsample"), "bn3");
+  int32_t r2   = b.unary(OpKind::RELU, b.binary(OpKind::ADD, y, down, "add"), "relu2");
+  int32_t elu  = b.unary(OpKind::ELU, b.conv(r2, 16, 3, 1, "upconv"), "elu");
+  int32_t up   = graph.addSlot("up", {1, 16, 16, 16});
+  graph.addOp(OpKind::UPSAMPLE_NEAREST2D, {elu}, up, "up");
+  int32_t cat = graph.addSlot("cat", {1, 32, 16, 16});
+  graph.addOp(OpKind::CAT, {up, skip}, cat, "cat");
+  int32_t disp = b.unary(OpKind::SIGMOID, b.conv(cat, 32, 3, 32, "dispconv"), "sigmoid");
+  graph.outputs.push_back(b.unary(OpKind::RELU, b.conv(disp, 16, 3, 1, "stride2", 2), "relu3"));
+
+  const std::vector<tfe::tensor::Tensor> inputs = {b.random({1, 16, 8, 8}),
+                                                   b.random({1, 16, 16, 16})};
+  for (bool blocked : {false, true}) {
+    tfe::engine::EngineOptions options;
+    options.blocked_layout = blocked;
+    options.fuse           = false;
+    tfe::engine::Engine reference(graph, options);
+    options.fuse = true;
+    tfe::engine::Engine engine(graph, options);
+
+    // batch_norm, 활성 함수, add, upsample 은 모두 conv 로 접히고 cat 은 skip 만 잇는다
+    const tfe::engine::Graph& fused = engine.graph();
+    const std::string dump          = fused.dump();
+    for (const tfe::engine::Op& op : fused.ops) {
+      EXPECT_TRUE(op.kind == OpKind::CONV2D || op.kind == OpKind::CAT ||
+                  op.kind == OpKind::REORDER)
+          << dump;
+      if (op.kind == OpKind::CAT) {
+        EXPECT_EQ(op.inputs.size(), 1u) << dump;
+        EXPECT_EQ(op.params.offset, 16);
+      }
+    }
+    EXPECT_NE(dump.find("conv2d+add+relu"), std::string::npos) << dump;
+    EXPECT_NE(dump.find("conv2d+elu+upsample_nearest2d+cat"), std::string::npos) << dump;
+    EXPECT_LT(engine.memoryPlan().naive_bytes, reference.memoryPlan().naive_bytes);
+
+    const tfe::tensor::Tensor& want = reference.run(inputs)[0];
+    const tfe::tensor::Tensor& got  = engine.run(inputs)[0];
+    ASSERT_EQ(got.sizes(), want.sizes());
+    for (int64_t i = 0; i < got.numel(); ++i) {
+      ASSERT_NEAR(got.data<float>()[i], want.data<float>()[i], 1e-4f) << blocked << " " << i;
+    }
+  }
+}
+
+TEST_F(EngineTest, RunsIndependentBranchesConcurrently) {
+  using tfe::engine::OpKind;
+  GraphBuilder b;
+  tfe::engine::Graph& graph = b.graph;
+
+  // multi-scale head 처럼 서로 기다리지 않는 가지 셋: conv -> elu -> conv -> sigmoid.
+  // 한 스레드로 도는 elu / sigmoid 는 가지끼리 동시에 도는 편이 낫다
+  std::vector<tfe::tensor::Tensor> inputs;
+  for (int i = 0; i < 3; ++i) {
+    const std::string name = "scale" + std::to_string(i);
+    int32_t x              = b.input(name, {1, 16, 48, 48});
+    int32_t conv           = b.conv(x, 16, 3, 1, name + ".conv");
+    int32_t elu            = b.unary(OpKind::ELU, conv, name + ".elu");
+    graph.outputs.push_back(
+        b.unary(OpKind::SIGMOID, b.conv(elu, 4, 3, 1, name + ".disp"), name + ".sigmoid"));
+    inputs.push_back(b.random({1, 16, 48, 48}));
+  }
+
+  tfe::engine::EngineOptions options;
+  options.fuse     = false;
+  options.inter_op = false;
+  options.pool     = std::make_shared<tfe::util::WorkStealingPool>(4, false);
+  tfe::engine::Engine sequential(graph, options);
+  EXPECT_EQ(sequential.schedule().stages.size(), sequential.graph().ops.size());
+  options.inter_op = true;
+  tfe::engine::Engine engine(graph, options);
+
+  // 가지마다 op 4 개 (묶인 layout 이면 출력 앞 REORDER 까지) 가 같은 stage 에 셋씩 놓인다
+  const tfe::engine::Schedule& schedule = engine.schedule();
+  EXPECT_LT(schedule.stages.size(), engine.graph().ops.size()) << schedule.summary();
+  bool concurrent = false;
+  for (const tfe::engine::Stage& stage : schedule.stages) {
+    EXPECT_EQ(stage.ops.size(), 3u) << schedule.summary();
+    concurrent = concurrent || stage.concurrent;
+
+    // 같은 stage 의 op 출력은 다른 op 의 입출력과 arena 에서 겹치지 않는다
+    auto range = [&](int32_t slot) {
+      const int64_t offset = engine.memoryPlan().offsets[slot];
+      return std::make_pair(offset, offset + engine.graph().slots[slot].numel() * 4);
+    };
+    for (int32_t i : stage.ops) {
+      for (int32_t j : stage.ops) {
+        const tfe::engine::Op& a = engine.graph().ops[i];
+        const tfe::engine::Op& c = engine.graph().ops[j];
+        if (i == j) {
+          continue;
+        }
+        std::vector<int32_t> touched = c.inputs;
+        touched.push_back(c.output);
+        for (int32_t slot : touched) {
+          if (engine.graph().slots[slot].constant) {
+            continue;
+          }
+          EXPECT_TRUE(range(a.output).second <= range(slot).first ||
+                      range(slot).second <= range(a.output).first)
+              << a.name << " / " << engine.graph().slots[slot].name;
+        }
+      }
+    }
+  }
+  EXPECT_TRUE(concurrent) << schedule.summary();
+
+  const std::vector<tfe::tensor::Tensor>& want = sequential.run(inputs);
+  const std::vector<tfe::tensor::Tensor>& got  = engine.run(inputs);
+  ASSERT_EQ(got.size(), 3u);
+  for (size_t k = 0; k < got.size(); ++k) {
+    for (int64_t i = 0; i < got[k].numel(); ++i) {
+      ASSERT_NEAR(got[k].data<float>()[i], want[k].data<float>()[i], 1e-5f) << k << " " << i;
+    }
+  }
+}
+
+TEST_F(EngineTest, QuantizesCalibratedConvAndLinear) {
+  using tfe::engine::OpKind;
+  GraphBuilder b;
+  tfe::engine::Graph& graph = b.graph;
+
+  // conv-bn-relu -> conv(stride 2)-relu -> depthwise -> pool -> linear. depthwise 는 float 로 남는다
+  int32_t x  = b.input("x", {1, 16, 16, 16});
+  int32_t c1 = b.unary(OpKind::RELU, b.batchNorm(b.conv(x, 32, 3, 1, "conv1"), "bn1"), "relu1");
+  int32_t c2 = b.unary(OpKind::RELU, b.conv(c1, 32, 3, 1, "conv2", 2), "relu2");
+  int32_t dw = b.conv(c2, 32, 3, 32, "dw");
+  int32_t pool = graph.addSlot("pool", {1, 32, 1, 1});
+  graph.addOp(OpKind::ADAPTIVE_AVG_POOL2D, {dw}, pool, "pool");
+  int32_t fc = graph.addSlot("fc", {1, 10});
+  graph.addOp(OpKind::LINEAR,
+              {pool, b.constant("fc.weight", {10, 32}), b.constant("fc.bias", {10})}, fc, "fc");
+  graph.outputs.push_back(fc);
+
+  std::vector<std::vector<tfe::tensor::Tensor>> samples;
+  for (int i = 0; i < 6; ++i) {
+    samples.push_back({b.random({1, 16, 16, 16})});
+  }
+  for (bool blocked : {false, true}) {
+    tfe::engine::EngineOptions options;
+    options.blocked_layout = blocked;
+    tfe::engine::Engine reference(graph, options);
+    tfe::engine::Calibrator calibrator(reference);
+    for (size_t i = 0; i < 4; ++i) {
+      calibrator.observe(samples[i]);
+    }
+    const tfe::engine::Calibration& calibration = calibrator.calibration();
+    ASSERT_EQ(calibration.ranges.size(), 4u);
+    // conv2 가 읽는 c1 은 묶인 layout 이면 REORDER 를 거치지만 원래 slot 으로 잡힌다
+    EXPECT_EQ(calibration.ranges.at(c1).samples, 4);
+    // relu 뒤라 음수가 없다
+    EXPECT_GE(calibration.ranges.at(c1).low(), 0.0f);
+    EXPECT_GT(calibration.ranges.at(c1).high(), 0.0f);
+
+    options.quantize = std::make_shared<tfe::engine::Calibration>(calibration);
+    tfe::engine::Engine engine(graph, options);
+    const std::string dump = engine.graph().dump();
+    int quantized          = 0;
+    for (size_t i = 0; i < engine.graph().ops.size(); ++i) {
+      const tfe::engine::Op& op = engine.graph().ops[i];
+      if (op.params.input_scale <= 0.0f) {
+        continue;
+      }
+      ++quantized;
+      ASSERT_NE(engine.convKernel(i), nullptr) << dump;
+      EXPECT_EQ(engine.convKernel(i)->algo(), tfe::engine::ConvAlgo::INT8_GEMM);
+      EXPECT_EQ(engine.graph().slots[op.inputs[1]].tensor.dtype(), tfe::tensor::DType::INT8);
+      EXPECT_EQ(op.params.input_zero == 0, op.name == "conv2") << op.name;
+    }
+    EXPECT_EQ(quantized, 3) << dump;
+    EXPECT_NE(dump.find("conv2d+relu:int8"), std::string::npos) << dump;
+    EXPECT_NE(dump.find("linear:int8"), std::string::npos) << dump;
+
+    // calibration 에 쓰지 않은 입력까지 float 경로와 가깝다
+    const tfe::engine::AccuracyReport report = compareOutputs(reference, engine, samples);
+    ASSERT_EQ(report.outputs.size(), 1u);
+    EXPECT_EQ(report.outputs[0].count, 60);
+    EXPECT_GT(report.outputs[0].max_abs, 0.0);
+    EXPECT_GT(report.outputs[0].snr_db, 30.0) << report.summary();
+  }
+}
+
+TEST_F(EngineTest, CalibratesRepeatedModulePerInput) {
+  using tfe::engine::OpKind;
+  GraphBuilder b;
+  // 같은 모듈 ("block") 을 두 번 부른다. 두 번째 입력은 relu 뒤라 범위가 다르다
+  int32_t x     = b.input("x", {1, 4, 8, 8});
+  int32_t first = b.unary(OpKind::RELU, b.conv(x, 4, 3, 1, "block"), "relu");
+  int32_t y     = b.conv(first, 4, 3, 1, "block");
+  b.graph.outputs.push_back(y);
+
+  tfe::engine::Engine reference(b.graph);
+  tfe::engine::Calibrator calibrator(reference);
+  calibrator.observe({b.random({1, 4, 8, 8})});
+  const tfe::engine::Calibration& calibration = calibrator.calibration();
+  ASSERT_EQ(calibration.ranges.size(), 2u);
+  EXPECT_LT(calibration.ranges.at(x).low(), 0.0f);
+  EXPECT_EQ(calibration.ranges.at(first).low(), 0.0f);
+
+  tfe::engine::EngineOptions options;
+  options.quantize = std::make_shared<tfe::engine::Calibration>(calibration);
+  tfe::engine::Engine engine(b.graph, options);
+  std::vector<int32_t> zeros;
+  for (const tfe::engine::Op& op : engine.graph().ops) {
+    if (op.params.input_scale > 0.0f) {
+      zeros.push_back(op.params.input_zero);
+    }
+  }
+  ASSERT_EQ(zeros.size(), 2u);
+  EXPECT_GT(zeros[0], 0);
+  EXPECT_EQ(zeros[1], 0);
+}
+
+TEST_F(EngineTest, CompiledModelRestoresPlannedEngine) {
+  using tfe::engine::OpKind;
+  GraphBuilder b;
+  tfe::engine::Graph& graph = b.graph;
+
+  // Winograd / 1x1 / depthwise / NCHWc conv, 접힌 batch_norm, 그리고 linear 까지 한 번씩
+  int32_t x  = b.input("x", {1, 8, 12, 12});
+  int32_t c1 = b.unary(OpKind::RELU, b.batchNorm(b.conv(x, 16, 3, 1, "conv1"), "bn1"), "relu1");
+  int32_t c2 = b.conv(b.conv(c1, 16, 1, 1, "proj"), 16, 3, 16, "dw");
+  int32_t pool = graph.addSlot("pool", {1, 16, 1, 1});
+  graph.addOp(OpKind::ADAPTIVE_AVG_POOL2D, {c2}, pool, "pool");
+  int32_t fc = graph.addSlot("fc", {1, 10});
+  graph.addOp(OpKind::LINEAR,
+              {pool, b.constant("fc.weight", {10, 16}), b.constant("fc.bias", {10})}, fc, "fc");
+  graph.outputs.push_back(c1);
+  graph.outputs.push_back(fc);
+  const std::vector<tfe::tensor::Tensor> inputs = {b.random({1, 8, 12, 12})};
+
+  const std::string file = ::testing::TempDir() + "tfe_engine_test.tfe";
+  for (bool quantize : {false, true}) {
+    tfe::engine::EngineOptions options;
+    options.blocked_layout = !quantize;
+    if (quantize) {
+      tfe::engine::Engine reference(graph, options);
+      tfe::engine::Calibrator calibrator(reference);
+      calibrator.observe(inputs);
+      options.quantize = std::make_shared<tfe::engine::Calibration>(calibrator.calibration());
+    }
+    tfe::engine::Engine engine(graph, options);
+    tfe::engine::saveCompiledModel(engine, file, 42);
+
+    auto compiled = std::make_shared<const tfe::engine::CompiledModel>(file);
+    EXPECT_EQ(compiled->sourceHash(), 42u);
+    EXPECT_EQ(compiled->options().blocked_layout, options.blocked_layout);
+    tfe::engine::Engine restored(compiled);
+    EXPECT_EQ(restored.compiled(), compiled);
+    EXPECT_EQ(restored.graph().dump(), engine.graph().dump());
+    EXPECT_EQ(restored.schedule().summary(), engine.schedule().summary());
+    EXPECT_EQ(restored.memoryPlan().offsets, engine.memoryPlan().offsets);
+
+    // 되살린 커널은 파일 매핑 안의 묶은 weight 를 그대로 빌리고, 바이트는 처음 묶은 것과 같다
+    int convs = 0;
+    for (size_t i = 0; i < engine.graph().ops.size(); ++i) {
+      const tfe::engine::ConvKernel* want = engine.convKernel(i);
+      const tfe::engine::ConvKernel* got  = restored.convKernel(i);
+      ASSERT_EQ(want == nullptr, got == nullptr) << i;
+      if (!want) {
+        continue;
+      }
+      ++convs;
+      EXPECT_EQ(got->algo(), want->algo()) << engine.graph().ops[i].name;
+      const std::vector<tfe::engine::PackedWeight> a = want->packedWeights();
+      const std::vector<tfe::engine::PackedWeight> p = got->packedWeights();
+      ASSERT_EQ(a.size(), p.size());
+      for (size_t k = 0; k < a.size(); ++k) {
+        ASSERT_EQ(a[k].bytes, p[k].bytes);
+        EXPECT_EQ(std::memcmp(a[k].data, p[k].data, a[k].bytes), 0) << engine.graph().ops[i].name;
+        EXPECT_EQ(p[k].data, compiled->conv(i)->packed[k].data);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(p[k].data) % 64, 0u);
+      }
+    }
+    EXPECT_EQ(convs, quantize ? 4 : 3) << engine.graph().dump();
+
+    const std::vector<tfe::tensor::Tensor>& want = engine.run(inputs);
+    const std::vector<tfe::tensor::Tensor>& got  = restored.run(inputs);
+    ASSERT_EQ(got.size(), want.size());
+    for (size_t k = 0; k < got.size(); ++k) {
+      ASSERT_EQ(got[k].sizes(), want[k].sizes());
+      for (int64_t i = 0; i < got[k].numel(); ++i) {
+        ASSERT_EQ(got[k].data<float>()[i], want[k].data<float>()[i]) << k << " " << i;
+      }
+    }
+  }
+
+  // 잘리거나 메타데이터가 깨진 파일은 열지 않는다
+  std::string bytes;
+  {
+    std::ifstream in(file, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  auto rewrite = [&](const std::string& content) {
+    std::ofstream(file, std::ios::binary | std::ios::trunc) << content;
+  };
+  rewrite(bytes.substr(0, bytes.size() / 2));
+  EXPECT_THROW(tfe::engine::CompiledModel{file}, tfe::error::ParserException);
+  std::string flipped = bytes;
+  flipped[80] ^= 1;
+  rewrite(flipped);
+  EXPECT_THROW(tfe::engine::CompiledModel{file}, tfe::error::ParserException);
+
+  // hash 를 다시 맞춰도 범위 밖 enum 은 받지 않는다. 메타데이터는 64 byte 헤더 뒤에서 옵션 3 byte,
+  // slot 수, 첫 slot ("x", 4 차원) 의 이름과 sizes 다음이 layout 이다. 메타데이터만 담은 파일의
+  // hashFile() 이 헤더의 meta_hash 다
+  uint64_t meta_size;
+  std::memcpy(&meta_size, bytes.data() + 32, sizeof(meta_size));
+  std::string forged = bytes;
+  const size_t layout = 64 + 3 + 8 + (8 + 1) + (8 + 4 * 8);
+  ASSERT_EQ(forged[layout], 0);
+  forged[layout] = 100;
+  rewrite(forged.substr(64, meta_size));
+  const uint64_t meta_hash = tfe::engine::hashFile(file);
+  std::memcpy(&forged[40], &meta_hash, sizeof(meta_hash));
+  rewrite(forged);
+  try {
+    tfe::engine::CompiledModel{file};
+    FAIL() << "out of range layout was accepted";
+  } catch (const tfe::error::ParserException& e) {
+    EXPECT_NE(std::string(e.what()).find("layout 100"), std::string::npos) << e.what();
+  }
+  std::remove(file.c_str());
+}
+
+TEST_F(EngineTest, LoadEngineReusesCompiledCache) {
+  saveTracedNet();
+  const std::string cache = ::testing::TempDir() + "tfe_engine_cache";
+  std::filesystem::remove_all(cache);
+
+  tfe::model::ScriptModel model(path_);
+  tfe::engine::Engine reference(model, {{1, 1, 3, 3}});
+  const std::vector<tfe::tensor::Tensor> inputs = {filled({1, 1, 3, 3}, 1.0f)};
+  const float* expected = reference.run(inputs)[0].data<float>();
+  const std::vector<float> want(expected, expected + 36);
+
+  auto check = [&](tfe::engine::Engine& engine) {
+    ASSERT_NE(engine.compiled(), nullptr);
+    const tfe::tensor::Tensor& out = engine.run(inputs)[0];
+    ASSERT_EQ(out.numel(), 36);
+    for (int64_t i = 0; i < 36; ++i) {
+      EXPECT_EQ(out.data<float>()[i], want[i]) << i;
+    }
+  };
+  // 처음에는 lowering 해 저장하고, 다음부터는 저장한 파일만 연다
+  std::unique_ptr<tfe::engine::Engine> first =
+      tfe::engine::loadEngine(path_, {{1, 1, 3, 3}}, {}, cache);
+  check(*first);
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::directory_iterator(cache)) {
+    files.push_back(entry.path());
+  }
+  ASSERT_EQ(files.size(), 1u);
+  EXPECT_EQ(files[0].extension(), ".tfe");
+  EXPECT_EQ(first->compiled()->sourceHash(), tfe::engine::sourceKey(path_));
+  std::unique_ptr<tfe::engine::Engine> second =
+      tfe::engine::loadEngine(path_, {{1, 1, 3, 3}}, {}, cache);
+  check(*second);
+
+  // 입력 shape 가 다르면 key 가 다르고, 깨진 cache 는 다시 만든다
+  EXPECT_NE(tfe::engine::compiledModelPath(cache, 1, {{1, 1, 3, 3}}, {}),
+            tfe::engine::compiledModelPath(cache, 1, {{1, 1, 4, 4}}, {}));
+  std::ofstream(files[0], std::ios::binary | std::ios::trunc) << "TFEMODEL";
+  std::unique_ptr<tfe::engine::Engine> rebuilt =
+      tfe::engine::loadEngine(path_, {{1, 1, 3, 3}}, {}, cache);
+  check(*rebuilt);
+  std::filesystem::remove_all(cache);
+}
+
+TEST_F(EngineTest, SourceKeyFollowsRecordContents) {
+  auto write = [&](char fill) {
+    ZipWriter writer;
+    writer.add("net/version", "3\n");
+    writer.add("net/data.pkl", std::string("\x80\x02K\x07.", 5));
+    writer.add("net/data/0", std::string(256, fill));
+    writer.save(path_);
+  };
+  write('a');
+  const uint64_t key = tfe::engine::sourceKey(path_);
+  write('a');
+  EXPECT_EQ(tfe::engine::sourceKey(path_), key);
+  write('b');
+  EXPECT_NE(tfe::engine::sourceKey(path_), key);
+
+  // ZIP 이 아니면 stat 으로 본다
+  const std::string flat = ::testing::TempDir() + "tfe_engine_key.tflite";
+  std::ofstream(flat, std::ios::binary | std::ios::trunc) << "TFL3";
+  const uint64_t flat_key = tfe::engine::sourceKey(flat);
+  EXPECT_EQ(tfe::engine::sourceKey(flat), flat_key);
+  std::ofstream(flat, std::ios::binary | std::ios::trunc) << "TFL3 changed";
+  EXPECT_NE(tfe::engine::sourceKey(flat), flat_key);
+  std::remove(flat.c_str());
+  EXPECT_THROW(tfe::engine::sourceKey(flat), tfe::error::ParserException);
+}
+
+TEST_F(EngineTest, ProfilesOpsPerModule) {
+  using tfe::engine::OpKind;
+  GraphBuilder b;
+  tfe::engine::Graph& graph = b.graph;
+
+  // encoder.conv1 -> encoder.relu -> head.conv. 가지가 없으니 op 는 모두 호출 스레드 (worker 0) 에서 돈다
+  int32_t x    = b.input("x", {1, 8, 10, 10});
+  int32_t relu = b.unary(OpKind::RELU, b.conv(x, 16, 3, 1, "encoder.conv1"), "encoder.relu");
+  graph.outputs.push_back(b.conv(relu, 4, 1, 1, "head.conv"));
+
+  tfe::engine::EngineOptions options;
+  options.blocked_layout = false;
+  options.fuse           = false;
+  options.pool           = std::make_shared<tfe::util::WorkStealingPool>(2, false);
+  tfe::engine::Engine engine(graph, options);
+  EXPECT_EQ(engine.profiler(), nullptr);
+
+  std::vector<tfe::tensor::Tensor> inputs = {b.random({1, 8, 10, 10})};
+  const tfe::engine::Profiler& profiler   = engine.enableProfiling();
+  engine.run(inputs);
+  engine.run(inputs);
+
+  const std::vector<tfe::engine::OpEvent> events = profiler.events();
+  ASSERT_EQ(events.size(), 6u);
+  for (size_t i = 0; i < events.size(); ++i) {
+    EXPECT_EQ(events[i].op, static_cast<int32_t>(i % 3));
+    EXPECT_EQ(events[i].worker, 0u);
+    EXPECT_LE(events[i].begin, events[i].end);
+    if (i > 0) {
+      EXPECT_LE(events[i - 1].end, events[i].begin);
+    }
+  }
+
+  const std::vector<tfe::engine::ModuleProfile> modules = profiler.modules();
+  ASSERT_EQ(modules.size(), 3u);
+  for (const tfe::engine::ModuleProfile& m : modules) {
+    EXPECT_EQ(m.calls, 2u) << m.module;
+    if (m.module == "encoder.conv1") {
+      // 2 * (16 * 8 * 3 * 3) * 10 * 10 번, 두 번 돌았다
+      EXPECT_DOUBLE_EQ(m.flops, 2 * 2.0 * 16 * 8 * 9 * 100);
+      // 입력 + weight + bias + 출력
+      EXPECT_DOUBLE_EQ(m.bytes, 2 * 4.0 * (800 + 16 * 8 * 9 + 16 + 1600));
+    } else if (m.module == "encoder.relu") {
+      EXPECT_DOUBLE_EQ(m.flops, 2 * 1600.0);
+    } else {
+      EXPECT_EQ(m.module, "head.conv");
+    }
+  }
+  for (size_t i = 1; i < modules.size(); ++i) {
+    EXPECT_GE(modules[i - 1].total, modules[i].total);
+  }
+  EXPECT_NE(profiler.table().find("encoder.conv1"), std::string::npos);
+
+  const std::string trace = profiler.chromeTrace();
+  size_t spans            = 0;
+  size_t at               = trace.find("\"ph\":\"X\"");
+  while (at != std::string::npos) {
+    ++spans;
+    at = trace.find("\"ph\":\"X\"", at + 1);
+  }
+  EXPECT_EQ(spans, 6u);
+  EXPECT_NE(trace.find("\"name\":\"head.conv\",\"cat\":\"conv2d\""), std::string::npos);
+
+  // ring 이 차면 오래된 기록부터 덮는다
+  const tfe::engine::Profiler& small = engine.enableProfiling(2);
+  engine.run(inputs);
+  EXPECT_EQ(small.events().size(), 2u);
+  EXPECT_EQ(small.events().back().op, 2);
+  EXPECT_EQ(small.dropped(), 1u);
+
+  engine.disableProfiling();
+  engine.run(inputs);
+  EXPECT_EQ(engine.profiler(), nullptr);
+}
+
+namespace {
+
+/**
+ * @brief x -> conv(8, 3x3) -> relu. GraphBuilder 의 seed 가 같아서 batch 크기가 달라도 weight 가 같다
+ */
+tfe::engine::Graph batchedConvRelu(const std::vector<std::vector<int64_t>>& shapes) {
+  GraphBuilder b;
+  int32_t x = b.input("x", shapes[0]);
+  b.graph.outputs.push_back(
+      b.unary(tfe::engine::OpKind::RELU, b.conv(x, 8, 3, 1, "conv"), "relu"));
+  return b.graph;
+}
+
+std::vector<float> values(const tfe::tensor::Tensor& t) {
+  return std::vector<float>(t.data<float>(), t.data<float>() + t.numel());
+}
+
+}  // namespace
+
+TEST_F(EngineTest, BatcherCoalescesRequests) {
+  tfe::engine::EngineOptions engine_options;
+  engine_options.pool = std::make_shared<tfe::util::WorkStealingPool>(2, false);
+  tfe::engine::Engine reference(batchedConvRelu({{1, 4, 6, 6}}), engine_options);
+
+  // 배치가 차거나 멈출 때만 돈다
+  tfe::engine::BatcherOptions options;
+  options.max_batch = 4;
+  options.max_delay = std::chrono::seconds(30);
+  options.engine    = engine_options;
+  const std::vector<std::vector<int64_t>> sample = {{1, 4, 6, 6}};
+  auto batcher = std::make_unique<tfe::engine::Batcher>(batchedConvRelu, sample, options);
+  EXPECT_EQ(batcher->outputShapes(), (std::vector<std::vector<int64_t>>{{1, 8, 6, 6}}));
+  EXPECT_THROW(batcher->submit({filled({2, 4, 6, 6}, 1.0f)}), std::invalid_argument);
+
+  GraphBuilder inputs_rng;
+  std::vector<tfe::tensor::Tensor> inputs;
+  std::vector<std::future<std::vector<tfe::tensor::Tensor>>> results;
+  for (int i = 0; i < 5; ++i) {
+    inputs.push_back(inputs_rng.random({1, 4, 6, 6}));
+    results.push_back(batcher->submit({inputs.back()}));
+  }
+
+  // 앞의 넷은 한 배치로 돌고, 다섯 번째는 기한 전이라 큐에 남는다
+  for (int i = 0; i < 4; ++i) {
+    std::vector<tfe::tensor::Tensor> got = results[i].get();
+    ASSERT_EQ(got.size(), 1u);
+    EXPECT_EQ(values(got[0]), values(reference.run({inputs[i]})[0])) << i;
+  }
+  tfe::engine::BatcherStats stats = batcher->stats();
+  EXPECT_EQ(stats.requests, 4u);
+  EXPECT_EQ(stats.batches, 1u);
+  EXPECT_EQ(stats.padded, 0u);
+  EXPECT_EQ(results[4].wait_for(std::chrono::milliseconds(20)), std::future_status::timeout);
+
+  // 멈출 때 남은 요청까지 돌린다 (bucket 1)
+  batcher.reset();
+  EXPECT_EQ(values(results[4].get()[0]), values(reference.run({inputs[4]})[0]));
+}
+
+TEST_F(EngineTest, ServesFramedRequestsInOrder) {
+  tfe::engine::EngineOptions engine_options;
+  engine_options.pool = std::make_shared<tfe::util::WorkStealingPool>(2, false);
+  tfe::engine::Engine reference(batchedConvRelu({{1, 4, 6, 6}}), engine_options);
+
+  tfe::engine::BatcherOptions options;
+  options.max_batch = 4;
+  options.max_delay = std::chrono::milliseconds(1);
+  options.engine    = engine_options;
+  tfe::engine::Batcher batcher(batchedConvRelu, {{1, 4, 6, 6}}, options);
+
+  int requests[2];
+  int responses[2];
+  ASSERT_EQ(pipe(requests), 0);
+  ASSERT_EQ(pipe(responses), 0);
+
+  // 요청 셋, 크기가 틀린 요청 하나, 다시 요청 하나를 몰아서 보낸다
+  GraphBuilder inputs_rng;
+  std::vector<tfe::tensor::Tensor> inputs;
+  auto send = [&](const void* data, uint32_t bytes) {
+    ASSERT_EQ(write(requests[1], &bytes, 4), 4);
+    ASSERT_EQ(write(requests[1], data, bytes), static_cast<ssize_t>(bytes));
+  };
+  for (int i = 0; i < 4; ++i) {
+    inputs.push_back(inputs_rng.random({1, 4, 6, 6}));
+    send(inputs.back().data(), 4 * 6 * 6 * sizeof(float));
+    if (i == 2) {
+      const float junk[2] = {1.0f, 2.0f};
+      send(junk, sizeof(junk));
+    }
+  }
+  close(requests[1]);
+
+  std::thread server([&] {
+    tfe::engine::serveStream(batcher, requests[0], responses[1]);
+    close(responses[1]);
+  });
+
+  size_t next = 0;
+  for (int frame = 0; frame < 5; ++frame) {
+    uint32_t header[2];
+    ASSERT_EQ(read(responses[0], header, sizeof(header)), static_cast<ssize_t>(sizeof(header)));
+    std::string payload(header[1], '\0');
+    for (size_t got = 0; got < payload.size();) {
+      const ssize_t n = read(responses[0], &payload[got], payload.size() - got);
+      ASSERT_GT(n, 0);
+      got += static_cast<size_t>(n);
+    }
+    if (frame == 3) {
+      EXPECT_EQ(header[0], 1u);
+      EXPECT_NE(payload.find("expected 576"), std::string::npos) << payload;
+      continue;
+    }
+    ASSERT_EQ(header[0], 0u) << payload;
+    ASSERT_EQ(header[1], 8 * 6 * 6 * sizeof(float));
+    std::vector<float> got(8 * 6 * 6);
+    std::memcpy(got.data(), payload.data(), payload.size());
+    EXPECT_EQ(got, values(reference.run({inputs[next]})[0])) << frame;
+    ++next;
+  }
+  char extra;
+  EXPECT_EQ(read(responses[0], &extra, 1), 0);
+  server.join();
+  close(requests[0]);
+  close(responses[0]);
+  EXPECT_EQ(batcher.stats().requests, 4u);
+}
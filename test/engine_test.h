@@ -0,0 +1,32 @@
+#ifndef ENGINE_TEST_H_
+#define ENGINE_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "engine/engine.h"
+#include "pkl_writer.h"
+#include "zip_writer.h"
+
+class EngineTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override;
+  void TearDown() override;
+
+  /**
+   * @brief data.pkl 과 float32 storage 들, code/ 소스로 모델 아카이브를 만든다
+   */
+  void save(const PickleWriter& data, const std::vector<std::vector<float>>& storages,
+            const std::vector<std::pair<std::string, std::string>>& sources);
+  /**
+   * @brief trace 된 conv -> bn -> relu -> (+x) -> upsample -> sigmoid 모델
+   */
+  void saveTracedNet();
+  static tfe::tensor::Tensor filled(const std::vector<int64_t>& sizes, float value);
+};
+
+#endif  // ENGINE_TEST_H_
@@ -0,0 +1,173 @@
+#include "module_test.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "parser/parser_torch.h"
+#include "vm/vm_pkl.h"
+
+namespace {
+
+/**
+ * @brief torchvision Conv2d 의 state 중 일부 (weight, bias=None, stride, padding, training)
+ */
+void conv(PickleWriter& pkl, const std::string& key, int64_t out_ch, int64_t in_ch) {
+  pkl.beginModule("__torch__.torch.nn.modules.conv", "Conv2d");
+  pkl.str("training").boolean(false);
+  pkl.str("_is_full_backward_hook").none();
+  pkl.str("weight").tensor(key, {out_ch, in_ch, 3, 3}, "FloatStorage", 0, true);
+  pkl.str("bias").none();
+  pkl.str("stride").intTuple({2, 2});
+  pkl.str("padding").intTuple({1, 1});
+  pkl.endModule();
+}
+
+}  // namespace
+
+/**
+ * @brief EncoderWrapper -> encoder: ResNet -> {conv1: Conv2d, bn1: BatchNorm2d,
+ *        layer1: Sequential{0: Conv2d, 1: Conv2d}}
+ */
+void ModuleTest::SetUp() {
+  path_ = ::testing::TempDir() + "tfe_module_test.pt";
+
+  PickleWriter pkl;
+  pkl.proto();
+  pkl.beginModule("__torch__", "EncoderWrapper");
+  pkl.str("training").boolean(true);
+  pkl.str("_is_full_backward_hook").none();
+  pkl.str("encoder");
+  pkl.beginModule("__torch__.torchvision.models.resnet", "ResNet");
+  pkl.str("training").boolean(false);
+  pkl.str("conv1");
+  conv(pkl, "0", 4, 3);
+  pkl.str("bn1");
+  pkl.beginModule("__torch__.torch.nn.modules.batchnorm", "BatchNorm2d");
+  pkl.str("training").boolean(false);
+  pkl.str("weight").tensor("1", {4}, "FloatStorage", 0, true);
+  pkl.str("running_mean").tensor("2", {4});
+  pkl.str("num_batches_tracked").tensor("3", {}, "LongStorage");
+  pkl.str("eps").real(1e-5);
+  pkl.endModule();
+  pkl.str("layer1");
+  pkl.beginModule("__torch__.torch.nn.modules.container", "Sequential");
+  pkl.str("training").boolean(false);
+  pkl.str("0");
+  conv(pkl, "4", 4, 4);
+  pkl.str("1");
+  conv(pkl, "5", 4, 4);
+  pkl.endModule();
+  pkl.endModule();
+  pkl.endModule();
+  pkl.stop();
+
+  ZipWriter writer;
+  writer.add("enc/version", "3\n");
+  writer.add("enc/byteorder", "little");
+  writer.add("enc/data.pkl", pkl.bytes());
+  writer.add("enc/data/0", std::string(4 * 3 * 9 * sizeof(float), '\0'));
+  writer.add("enc/data/1", std::string(4 * sizeof(float), '\0'));
+  writer.add("enc/data/2", std::string(4 * sizeof(float), '\0'));
+  writer.add("enc/data/3", std::string(sizeof(int64_t), '\0'));
+  writer.add("enc/data/4", std::string(4 * 4 * 9 * sizeof(float), '\0'));
+  writer.add("enc/data/5", std::string(4 * 4 * 9 * sizeof(float), '\0'));
+  writer.save(path_);
+}
+
+void ModuleTest::TearDown() { std::remove(path_.c_str()); }
+
+TEST_F(ModuleTest, BuildsNamedTree) {
+  tfe::parser::TorchParser parser;
+  parser.read(path_);
+  tfe::vm::PickleVM vm(parser.getDataView());
+  tfe::tensor::TensorLoader loader(parser);
+  tfe::model::ModuleGraph graph(vm.load(), loader);
+
+  EXPECT_EQ(graph.size(), 7u);
+  const tfe::model::Module& root = graph.root();
+  EXPECT_EQ(graph.str(root.type()), "__torch__.EncoderWrapper");
+  EXPECT_TRUE(root.training());
+  ASSERT_EQ(root.children().size(), 1u);
+
+  const tfe::model::Module* resnet = graph.findModule("encoder");
+  ASSERT_NE(resnet, nullptr);
+  EXPECT_FALSE(resnet->training());
+  EXPECT_EQ(resnet->parent(), &root);
+  ASSERT_EQ(resnet->children().size(), 3u);
+  EXPECT_EQ(graph.str(resnet->children()[2].first), "layer1");
+
+  const tfe::model::Module* conv = graph.findModule("encoder.layer1.1");
+  ASSERT_NE(conv, nullptr);
+  EXPECT_EQ(graph.str(conv->type()), "__torch__.torch.nn.modules.conv.Conv2d");
+  EXPECT_EQ(graph.path(*conv), "encoder.layer1.1");
+  EXPECT_EQ(conv->parameters().size(), 1u);
+  EXPECT_TRUE(conv->buffers().empty());
+}
+
+TEST_F(ModuleTest, DottedPathLookup) {
+  tfe::parser::TorchParser parser;
+  parser.read(path_);
+  tfe::vm::PickleVM vm(parser.getDataView());
+  tfe::tensor::TensorLoader loader(parser);
+  tfe::model::ModuleGraph graph(vm.load(), loader);
+
+  const tfe::tensor::Tensor* weight = graph.findTensor("encoder.conv1.weight");
+  ASSERT_NE(weight, nullptr);
+  EXPECT_EQ(weight->sizes(), (std::vector<int64_t>{4, 3, 3, 3}));
+
+  const tfe::model::Module* bn = graph.findModule("encoder.bn1");
+  ASSERT_NE(bn, nullptr);
+  EXPECT_EQ(bn->parameters().size(), 1u);
+  EXPECT_EQ(bn->buffers().size(), 2u);
+  EXPECT_EQ(graph.findTensor("encoder.bn1.num_batches_tracked")->dtype(),
+            tfe::tensor::DType::INT64);
+
+  const tfe::model::Attribute* stride = graph.findAttribute("encoder.layer1.0.stride");
+  ASSERT_NE(stride, nullptr);
+  EXPECT_EQ(stride->kind, tfe::model::Attribute::Kind::INT_LIST);
+  EXPECT_EQ(stride->ints, (std::vector<int64_t>{2, 2}));
+  EXPECT_EQ(graph.findAttribute("encoder.bn1.eps")->kind, tfe::model::Attribute::Kind::FLOAT);
+  EXPECT_EQ(graph.findAttribute("encoder.conv1.bias")->kind, tfe::model::Attribute::Kind::NONE);
+
+  EXPECT_EQ(graph.findModule("encoder.conv1.weight"), nullptr);
+  EXPECT_EQ(graph.findTensor("encoder.conv1"), nullptr);
+  EXPECT_EQ(graph.findTensor("encoder.conv1.weight.x"), nullptr);
+  EXPECT_EQ(graph.findTensor("encoder.missing.weight"), nullptr);
+  EXPECT_EQ(graph.findModule(""), &graph.root());
+}
+
+TEST_F(ModuleTest, NamesAreInterned) {
+  tfe::parser::TorchParser parser;
+  parser.read(path_);
+  tfe::vm::PickleVM vm(parser.getDataView());
+  tfe::tensor::TensorLoader loader(parser);
+  tfe::model::ModuleGraph graph(vm.load(), loader);
+
+  tfe::model::Symbol training = graph.strings().find("training");
+  ASSERT_NE(training, tfe::model::StringTable::kInvalid);
+  EXPECT_EQ(graph.findModule("encoder.conv1")->attribute(training)->kind,
+            tfe::model::Attribute::Kind::BOOL);
+
+  // "training" 은 7 번, "_is_full_backward_hook" 은 4 번 나오지만 테이블에는 한 번씩만 있다
+  size_t count = 0;
+  for (tfe::model::Symbol s = 0; s < graph.strings().size(); ++s) {
+    count += graph.str(s) == "training" || graph.str(s) == "_is_full_backward_hook";
+  }
+  EXPECT_EQ(count, 2u);
+}
+
+TEST_F(ModuleTest, PrefetchSubtree) {
+  tfe::parser::TorchParser parser;
+  parser.read(path_);
+  tfe::vm::PickleVM vm(parser.getDataView());
+  tfe::tensor::TensorLoader loader(parser);
+  tfe::model::ModuleGraph graph(vm.load(), loader);
+
+  EXPECT_EQ(loader.pending(), 6u);
+  EXPECT_EQ(graph.prefetch("encoder.layer1"), 2u);
+  EXPECT_TRUE(graph.findTensor("encoder.layer1.0.weight")->storage()->loaded());
+  EXPECT_FALSE(graph.findTensor("encoder.conv1.weight")->storage()->loaded());
+  EXPECT_EQ(graph.prefetch("encoder.bn1.weight"), 1u);
+  EXPECT_EQ(graph.prefetch(""), 3u);
+  EXPECT_EQ(loader.pending(), 0u);
+}
@@ -0,0 +1,20 @@
+#ifndef MODULE_TEST_H_
+#define MODULE_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "model/module.h"
+#include "pkl_writer.h"
+#include "zip_writer.h"
+
+class ModuleTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override;
+  void TearDown() override;
+};
+
+#endif  // MODULE_TEST_H_
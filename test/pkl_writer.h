@@ -0,0 +1,228 @@
+#ifndef PKL_WRITER_TEST_H_
+#define PKL_WRITER_TEST_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "vm/op_pkl.h"
+
+/**
+ * @brief 테스트/벤치마크용 pickle 작성기
+ *
+ * torch.jit.save 가 만드는 data.pkl 과 같은 protocol 2 opcode 열을 손으로 만든다.
+ */
+class PickleWriter {
+ public:
+  using OpCode = tfe::vm::OpCode;
+
+  PickleWriter& op(OpCode opcode) {
+    boundaries_.push_back(out_.size());
+    out_ += static_cast<char>(opcode);
+    return *this;
+  }
+
+  PickleWriter& proto(uint8_t version = 2) {
+    op(OpCode::PROTO);
+    out_ += static_cast<char>(version);
+    return *this;
+  }
+
+  PickleWriter& frame(uint64_t size) {
+    op(OpCode::FRAME);
+    put64(size);
+    return *this;
+  }
+
+  PickleWriter& global(const std::string& module, const std::string& name) {
+    op(OpCode::GLOBAL);
+    out_ += module + "\n" + name + "\n";
+    return *this;
+  }
+
+  PickleWriter& str(const std::string& s) {
+    op(OpCode::BINUNICODE);
+    put32(static_cast<uint32_t>(s.size()));
+    out_ += s;
+    return *this;
+  }
+
+  PickleWriter& integer(int64_t v) {
+    if (v >= 0 && v < 256) {
+      op(OpCode::BININT1);
+      out_ += static_cast<char>(v);
+    } else if (v >= 0 && v < 65536) {
+      op(OpCode::BININT2);
+      put16(static_cast<uint16_t>(v));
+    } else if (v >= INT32_MIN && v <= INT32_MAX) {
+      op(OpCode::BININT);
+      put32(static_cast<uint32_t>(v));
+    } else {
+      op(OpCode::LONG1);
+      out_ += static_cast<char>(8);
+      put64(static_cast<uint64_t>(v));
+    }
+    return *this;
+  }
+
+  PickleWriter& real(double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    op(OpCode::BINFLOAT);
+    for (int i = 7; i >= 0; --i) {
+      out_ += static_cast<char>((bits >> (i * 8)) & 0xFF);
+    }
+    return *this;
+  }
+
+  PickleWriter& boolean(bool b) { return op(b ? OpCode::NEWTRUE : OpCode::NEWFALSE); }
+  PickleWriter& none() { return op(OpCode::NONE); }
+  PickleWriter& mark() { return op(OpCode::MARK); }
+  PickleWriter& stop() { return op(OpCode::STOP); }
+
+  PickleWriter& put(uint32_t index) {
+    if (index < 256) {
+      op(OpCode::BINPUT);
+      out_ += static_cast<char>(index);
+    } else {
+      op(OpCode::LONG_BINPUT);
+      put32(index);
+    }
+    return *this;
+  }
+
+  PickleWriter& get(uint32_t index) {
+    if (index < 256) {
+      op(OpCode::BINGET);
+      out_ += static_cast<char>(index);
+    } else {
+      op(OpCode::LONG_BINGET);
+      put32(index);
+    }
+    return *this;
+  }
+
+  PickleWriter& intTuple(const std::vector<int64_t>& values) {
+    if (values.empty()) {
+      return op(OpCode::EMPTY_TUPLE);
+    }
+    mark();
+    for (int64_t v : values) {
+      integer(v);
+    }
+    return op(OpCode::TUPLE);
+  }
+
+  /**
+   * @brief torch._utils._rebuild_tensor_v2(persistent_load(('storage', <dtype>, key, device,
+   *        numel)), offset, sizes, strides, requires_grad, OrderedDict())
+   *
+   * storage_numel 을 주지 않으면 storage 가 이 텐서에서 끝난다고 본다.
+   */
+  PickleWriter& tensor(const std::string& key, const std::vector<int64_t>& sizes,
+                       const std::string& storage_type = "FloatStorage", int64_t offset = 0,
+                       bool requires_grad = false, int64_t storage_numel = -1) {
+    std::vector<int64_t> strides(sizes.size(), 1);
+    int64_t numel = 1;
+    for (size_t i = sizes.size(); i-- > 0;) {
+      strides[i] = numel;
+      numel *= sizes[i];
+    }
+
+    global("torch._utils", "_rebuild_tensor_v2");
+    mark();
+    mark();
+    str("storage");
+    global("torch", storage_type);
+    str(key);
+    str("cpu");
+    integer(storage_numel < 0 ? offset + numel : storage_numel);
+    op(OpCode::TUPLE);
+    op(OpCode::BINPERSID);
+    integer(offset);
+    intTuple(sizes);
+    intTuple(strides);
+    boolean(requires_grad);
+    global("collections", "OrderedDict");
+    op(OpCode::EMPTY_TUPLE);
+    op(OpCode::REDUCE);
+    op(OpCode::TUPLE);
+    return op(OpCode::REDUCE);
+  }
+
+  /**
+   * @brief __torch__.<module>.<name>() 객체를 열고 state dict 의 MARK 까지 쓴다.
+   *        endModule() 로 SETITEMS/BUILD 를 닫는다.
+   */
+  PickleWriter& beginModule(const std::string& module, const std::string& name, int memo = -1) {
+    global(module, name);
+    if (memo >= 0) {
+      put(static_cast<uint32_t>(memo));
+    }
+    op(OpCode::EMPTY_TUPLE);
+    op(OpCode::NEWOBJ);
+    op(OpCode::EMPTY_DICT);
+    return mark();
+  }
+
+  PickleWriter& endModule() {
+    op(OpCode::SETITEMS);
+    return op(OpCode::BUILD);
+  }
+
+  const std::string& bytes() const { return out_; }
+  std::vector<char> data() const { return std::vector<char>(out_.begin(), out_.end()); }
+
+  /**
+   * @brief protocol 4 처럼 opcode 경계에서 FRAME 으로 나눈 사본. 맨 앞 PROTO 는 프레임 밖에 둔다.
+   */
+  std::string framedBytes(size_t frame_size = 64 * 1024) const {
+    std::string framed;
+    size_t begin = 0;
+    if (!out_.empty() && static_cast<OpCode>(out_[0]) == OpCode::PROTO) {
+      framed.append(out_, 0, 2);
+      framed[1] = 4;
+      begin     = 2;
+    }
+
+    std::vector<size_t> cuts;
+    for (size_t boundary : boundaries_) {
+      if (boundary >= begin) {
+        cuts.push_back(boundary);
+      }
+    }
+    cuts.push_back(out_.size());
+
+    size_t start = begin;
+    for (size_t i = 1; i < cuts.size(); ++i) {
+      if (cuts[i] - start >= frame_size || i + 1 == cuts.size()) {
+        PickleWriter header;
+        header.frame(cuts[i] - start);
+        framed += header.bytes();
+        framed.append(out_, start, cuts[i] - start);
+        start = cuts[i];
+      }
+    }
+    return framed;
+  }
+
+ private:
+  void put16(uint16_t v) {
+    out_ += static_cast<char>(v & 0xFF);
+    out_ += static_cast<char>(v >> 8);
+  }
+  void put32(uint32_t v) {
+    put16(static_cast<uint16_t>(v & 0xFFFF));
+    put16(static_cast<uint16_t>(v >> 16));
+  }
+  void put64(uint64_t v) {
+    put32(static_cast<uint32_t>(v & 0xFFFFFFFF));
+    put32(static_cast<uint32_t>(v >> 32));
+  }
+
+  std::string out_;
+  std::vector<size_t> boundaries_;
+};
+
+#endif  // PKL_WRITER_TEST_H_
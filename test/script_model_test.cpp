@@ -0,0 +1,371 @@
+#include "script_model_test.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "error/error.h"
+
+namespace {
+
+using OpCode = tfe::vm::OpCode;
+
+/**
+ * @brief ("key", value) 쌍. value 는 fn 이 쓴다
+ */
+template <typename Fn>
+void table(PickleWriter& pkl, const std::string& key, Fn&& fn) {
+  pkl.mark().str(key);
+  fn();
+  pkl.op(OpCode::TUPLE);
+}
+
+std::string bytecodePickle() {
+  PickleWriter pkl;
+  pkl.proto().mark().integer(6);
+  pkl.mark().str("__torch__.Net.forward");
+  pkl.mark();
+  table(pkl, "instructions", [&] {
+    pkl.mark();
+    pkl.mark().str("STOREN").integer(1).integer(2).op(OpCode::TUPLE);
+    pkl.mark().str("MOVE").integer(2).integer(0).op(OpCode::TUPLE);
+    pkl.mark().str("OP").integer(0).integer(0).op(OpCode::TUPLE);
+    pkl.mark().str("RET").integer(0).integer(0).op(OpCode::TUPLE);
+    pkl.op(OpCode::TUPLE);
+  });
+  table(pkl, "operators", [&] {
+    pkl.mark();
+    pkl.mark().str("aten::relu").str("").integer(1).op(OpCode::TUPLE);
+    pkl.op(OpCode::TUPLE);
+  });
+  table(pkl, "constants", [&] { pkl.mark().real(0.5).op(OpCode::TUPLE); });
+  table(pkl, "types", [&] { pkl.mark().str("Tensor").op(OpCode::TUPLE); });
+  table(pkl, "register_size", [&] { pkl.integer(2); });
+  pkl.op(OpCode::TUPLE);
+  pkl.op(OpCode::TUPLE);
+  pkl.op(OpCode::TUPLE);
+  pkl.stop();
+  return pkl.bytes();
+}
+
+/**
+ * @brief (6, ("f", (tables...))) 한 함수짜리 bytecode. tables 는 fn 이 쓴다
+ */
+template <typename Fn>
+std::string singleFunctionPickle(Fn&& fn) {
+  PickleWriter pkl;
+  pkl.proto().mark().integer(6);
+  pkl.mark().str("f").mark();
+  fn(pkl);
+  pkl.op(OpCode::TUPLE).op(OpCode::TUPLE).op(OpCode::TUPLE).stop();
+  return pkl.bytes();
+}
+
+}  // namespace
+
+void ScriptModelTest::SetUp() {
+  path_ = ::testing::TempDir() + "tfe_script_model_test.pt";
+
+  PickleWriter data;
+  data.proto();
+  data.beginModule("__torch__", "Net");
+  data.str("training").boolean(false);
+  data.str("weight").tensor("0", {2}, "FloatStorage", 0, true);
+  data.endModule();
+  data.stop();
+
+  PickleWriter constants;
+  constants.proto().mark();
+  constants.tensor("0", {3});
+  constants.integer(42);
+  constants.str("relu");
+  constants.op(OpCode::TUPLE).stop();
+
+  float values[3] = {1.5f, 2.5f, 3.5f};
+
+  ZipWriter writer;
+  writer.add("net/version", "6\n");
+  writer.add("net/byteorder", "little");
+  writer.add("net/data.pkl", data.bytes());
+  writer.add("net/data/0", std::string(2 * sizeof(float), '\0'));
+  writer.add("net/constants.pkl", constants.bytes());
+  writer.add("net/constants/0", std::string(reinterpret_cast<const char*>(values), sizeof(values)));
+  writer.add("net/bytecode.pkl", bytecodePickle());
+  writer.add("net/code/__torch__.py",
+             "class Net(Module):\n  def forward(self, x: Tensor) -> Tensor:\n"
+             "    return torch.relu(x)\n",
+             true);
+  writer.add("net/code/__torch__.py.debug_pkl", std::string("\x80\x02).", 4));
+  writer.save(path_);
+}
+
+void ScriptModelTest::TearDown() { std::remove(path_.c_str()); }
+
+TEST_F(ScriptModelTest, DecodesAllSections) {
+  tfe::model::ScriptModel model(path_, 2);
+
+  EXPECT_NE(model.modules().findTensor("weight"), nullptr);
+
+  const auto& constants = model.constants();
+  ASSERT_EQ(constants.size(), 3u);
+  ASSERT_TRUE(constants[0].isTensor());
+  EXPECT_EQ(constants[0].tensor.data<float>()[2], 3.5f);
+  EXPECT_EQ(constants[1].value.kind, tfe::model::Attribute::Kind::INT);
+  EXPECT_EQ(constants[1].value.i, 42);
+  EXPECT_EQ(constants[2].value.kind, tfe::model::Attribute::Kind::STRING);
+
+  ASSERT_TRUE(model.hasBytecode());
+  const tfe::model::Bytecode& bytecode = model.bytecode();
+  EXPECT_EQ(bytecode.version, 6);
+  const tfe::model::BytecodeFunction* forward = bytecode.find("__torch__.Net.forward");
+  ASSERT_NE(forward, nullptr);
+  ASSERT_EQ(forward->instructions.size(), 4u);
+  EXPECT_EQ(forward->instructions[0].op, "STOREN");
+  EXPECT_EQ(forward->instructions[0].n, 2);
+  ASSERT_EQ(forward->operators.size(), 1u);
+  EXPECT_EQ(forward->operators[0].name, "aten::relu");
+  EXPECT_EQ(forward->operators[0].num_args, 1);
+  ASSERT_EQ(forward->constants.size(), 1u);
+  EXPECT_EQ(forward->constants[0].value.f, 0.5);
+  EXPECT_EQ(forward->types, (std::vector<std::string>{"Tensor"}));
+  EXPECT_EQ(forward->register_size, 2);
+
+  ASSERT_EQ(model.sources().size(), 1u);
+  const tfe::model::SourceFile* source = model.source("code/__torch__.py");
+  ASSERT_NE(source, nullptr);
+  EXPECT_NE(source->text.find("torch.relu(x)"), std::string::npos);
+}
+
+TEST_F(ScriptModelTest, SectionsAreOptional) {
+  const std::string path = ::testing::TempDir() + "tfe_script_model_minimal.pt";
+  PickleWriter data;
+  data.proto().beginModule("__torch__", "Empty").str("training").boolean(false).endModule().stop();
+
+  ZipWriter writer;
+  writer.add("m/version", "3\n");
+  writer.add("m/byteorder", "little");
+  writer.add("m/data.pkl", data.bytes());
+  writer.save(path);
+
+  tfe::model::ScriptModel model(path);
+  EXPECT_EQ(model.modules().size(), 1u);
+  EXPECT_TRUE(model.constants().empty());
+  EXPECT_FALSE(model.hasBytecode());
+  EXPECT_TRUE(model.sources().empty());
+  std::remove(path.c_str());
+}
+
+TEST_F(ScriptModelTest, RejectsMalformedBytecode) {
+  const std::string path = ::testing::TempDir() + "tfe_script_model_bad_bytecode.pt";
+  PickleWriter data;
+  data.proto().beginModule("__torch__", "Net").str("training").boolean(false).endModule().stop();
+
+  const auto expectRejected = [&](const std::string& bytecode) {
+    ZipWriter writer;
+    writer.add("m/version", "6\n");
+    writer.add("m/byteorder", "little");
+    writer.add("m/data.pkl", data.bytes());
+    writer.add("m/bytecode.pkl", bytecode);
+    writer.save(path);
+    EXPECT_THROW(tfe::model::ScriptModel{path}, tfe::error::ParserException);
+  };
+
+  // (op, X) 처럼 항목이 모자란 instruction
+  expectRejected(singleFunctionPickle([](PickleWriter& pkl) {
+    table(pkl, "instructions", [&] {
+      pkl.mark().mark().str("RET").integer(0).op(OpCode::TUPLE).op(OpCode::TUPLE);
+    });
+  }));
+  // opcode 자리에 문자열 대신 정수
+  expectRejected(singleFunctionPickle([](PickleWriter& pkl) {
+    table(pkl, "instructions", [&] {
+      pkl.mark().mark().integer(1).integer(0).integer(0).op(OpCode::TUPLE).op(OpCode::TUPLE);
+    });
+  }));
+  // overload 가 없는 operator
+  expectRejected(singleFunctionPickle([](PickleWriter& pkl) {
+    table(pkl, "operators", [&] {
+      pkl.mark().mark().str("aten::relu").op(OpCode::TUPLE).op(OpCode::TUPLE);
+    });
+  }));
+  // type 자리에 문자열 대신 정수
+  expectRejected(singleFunctionPickle([](PickleWriter& pkl) {
+    table(pkl, "types", [&] { pkl.mark().integer(3).op(OpCode::TUPLE); });
+  }));
+  // register_size 자리에 문자열
+  expectRejected(singleFunctionPickle([](PickleWriter& pkl) {
+    table(pkl, "register_size", [&] { pkl.str("2"); });
+  }));
+  // instructions 가 튜플이 아닌 정수
+  expectRejected(singleFunctionPickle([](PickleWriter& pkl) {
+    table(pkl, "instructions", [&] { pkl.integer(0); });
+  }));
+  // 함수 이름 자리에 정수
+  PickleWriter pkl;
+  pkl.proto().mark().integer(6).mark().integer(7).mark().op(OpCode::TUPLE);
+  pkl.op(OpCode::TUPLE).op(OpCode::TUPLE).stop();
+  expectRejected(pkl.bytes());
+  std::remove(path.c_str());
+}
+
+TEST_F(ScriptModelTest, BytecodeConstantsShareConstantStorages) {
+  const std::string path = ::testing::TempDir() + "tfe_script_model_shared_constants.pt";
+  PickleWriter data;
+  data.proto().beginModule("__torch__", "Net").str("training").boolean(false).endModule().stop();
+  PickleWriter constants;
+  constants.proto().mark().tensor("0", {3}).op(OpCode::TUPLE).stop();
+  const std::string bytecode = singleFunctionPickle([](PickleWriter& pkl) {
+    table(pkl, "constants", [&] { pkl.mark().tensor("0", {2}).op(OpCode::TUPLE); });
+  });
+
+  const float values[3] = {1.0f, 2.0f, 3.0f};
+  ZipWriter writer;
+  writer.add("m/version", "6\n");
+  writer.add("m/byteorder", "little");
+  writer.add("m/data.pkl", data.bytes());
+  writer.add("m/constants.pkl", constants.bytes());
+  writer.add("m/constants/0", std::string(reinterpret_cast<const char*>(values), sizeof(values)));
+  writer.add("m/bytecode.pkl", bytecode);
+  writer.save(path);
+
+  // 두 섹션이 동시에 디코딩돼도 constants/0 은 Storage 하나로 읽힌다
+  tfe::model::ScriptModel model(path, 2);
+  ASSERT_EQ(model.constants().size(), 1u);
+  const tfe::model::BytecodeFunction* f = model.bytecode().find("f");
+  ASSERT_NE(f, nullptr);
+  ASSERT_EQ(f->constants.size(), 1u);
+  const tfe::tensor::Tensor& shared = f->constants[0].tensor;
+  EXPECT_TRUE(shared.sharesStorage(model.constants()[0].tensor));
+  EXPECT_EQ(shared.data<float>()[1], 2.0f);
+  std::remove(path.c_str());
+}
+
+TEST_F(ScriptModelTest, StreamsDeflatedDataPickle) {
+  const std::string path = ::testing::TempDir() + "tfe_script_model_deflated.pt";
+  PickleWriter data;
+  data.proto().beginModule("__torch__", "Net").str("training").boolean(false);
+  data.str("weight").tensor("0", {4});
+  data.str("bias").tensor("1", {2});
+  data.endModule().stop();
+
+  const float weight[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+  const float bias[2]   = {-1.0f, -2.0f};
+  ZipWriter writer;
+  writer.add("net/version", "3\n");
+  writer.add("net/byteorder", "little");
+  writer.add("net/data.pkl", data.bytes(), true);
+  writer.add("net/data/0", std::string(reinterpret_cast<const char*>(weight), sizeof(weight)));
+  writer.add("net/data/1", std::string(reinterpret_cast<const char*>(bias), sizeof(bias)), true);
+  writer.save(path);
+
+  // data.pkl 은 inflate 되는 대로 실행되고, 그 사이 storage 읽기가 pool 에 걸린다
+  tfe::model::ScriptModel model(path, 2);
+  EXPECT_FALSE(model.parser().getDataEntry().isStored());
+  model.tensors().wait();
+  EXPECT_EQ(model.tensors().storages().size(), 2u);
+  EXPECT_EQ(model.tensors().pending(), 0u);
+  EXPECT_EQ(model.modules().findTensor("weight")->data<float>()[3], 4.0f);
+  EXPECT_EQ(model.modules().findTensor("bias")->data<float>()[1], -2.0f);
+  std::remove(path.c_str());
+}
+
+TEST_F(ScriptModelTest, ClassifiesTensorsByDeclaredMembers) {
+  const std::string path = ::testing::TempDir() + "tfe_script_model_frozen.pt";
+  // requires_grad_(False) 로 얼린 모델: weight 의 requires_grad 가 모두 꺼져 있다
+  PickleWriter data;
+  data.proto().beginModule("__torch__", "Net").str("training").boolean(false);
+  data.str("weight").tensor("0", {2});
+  data.str("running_mean").tensor("1", {2});
+  data.str("bn");
+  data.beginModule("__torch__.torch.nn.modules.batchnorm", "BatchNorm2d");
+  data.str("weight").tensor("2", {2});
+  data.str("running_var").tensor("3", {2});
+  data.endModule();
+  data.endModule().stop();
+
+  auto write = [&](bool with_code) {
+    ZipWriter writer;
+    writer.add("net/version", "3\n");
+    writer.add("net/byteorder", "little");
+    writer.add("net/data.pkl", data.bytes());
+    for (int i = 0; i < 4; ++i) {
+      writer.add("net/data/" + std::to_string(i), std::string(2 * sizeof(float), '\0'));
+    }
+    if (with_code) {
+      writer.add("net/code/__torch__.py",
+                 "class Net(Module):\n"
+                 "  __parameters__ = [\"weight\", ]\n"
+                 "  __buffers__ = [\"running_mean\", ]\n"
+                 "  weight : Tensor\n"
+                 "  bn : __torch__.torch.nn.modules.batchnorm.BatchNorm2d\n",
+                 true);
+      writer.add("net/code/__torch__/torch/nn/modules/batchnorm.py",
+                 "class BatchNorm2d(Module):\n"
+                 "  __parameters__ = [\n"
+                 "    \"weight\",\n"
+                 "    ]\n"
+                 "  __buffers__ = [\"running_var\", ]\n");
+    }
+    writer.save(path);
+  };
+
+  write(true);
+  {
+    tfe::model::ScriptModel model(path);
+    const tfe::model::Module& root = model.modules().root();
+    ASSERT_EQ(root.parameters().size(), 1u);
+    EXPECT_EQ(model.modules().str(root.parameters()[0].first), "weight");
+    ASSERT_EQ(root.buffers().size(), 1u);
+    EXPECT_EQ(model.modules().str(root.buffers()[0].first), "running_mean");
+    const tfe::model::Module* bn = model.modules().findModule("bn");
+    ASSERT_NE(bn, nullptr);
+    ASSERT_EQ(bn->parameters().size(), 1u);
+    EXPECT_EQ(model.modules().str(bn->parameters()[0].first), "weight");
+    EXPECT_EQ(bn->buffers().size(), 1u);
+  }
+
+  // code/ 가 없으면 requires_grad 로 나누므로 얼린 weight 는 buffer 가 된다
+  write(false);
+  {
+    tfe::model::ScriptModel model(path);
+    EXPECT_TRUE(model.modules().root().parameters().empty());
+    EXPECT_EQ(model.modules().root().buffers().size(), 2u);
+  }
+  std::remove(path.c_str());
+}
+
+TEST_F(ScriptModelTest, ReadsClassMembersFromSources) {
+  const tfe::model::ClassMemberTable table = tfe::model::readClassMembers(
+      {{"code/__torch__/a/b.py",
+        "class C(Module):\n  __parameters__ = [\"w\", \"b\", ]\n  __buffers__ = []\n"
+        "  def forward(self: __torch__.a.b.C) -> None:\n    return None\n"
+        "class D(Module):\n  __parameters__ = []\n  __buffers__ = [\"mean\", ]\n"}});
+  ASSERT_EQ(table.size(), 2u);
+  const tfe::model::ClassMembers& c = table.at("__torch__.a.b.C");
+  EXPECT_EQ(c.parameters, (tfe::model::NameSet{"w", "b"}));
+  EXPECT_TRUE(c.buffers.empty());
+  EXPECT_EQ(table.at("__torch__.a.b.D").buffers, (tfe::model::NameSet{"mean"}));
+}
+
+TEST_F(ScriptModelTest, ReadsClassMemberListsAcrossLines) {
+  // 목록이 여러 줄에 걸치고, 줄 안에서 닫히고, 주석 안의 따옴표나 ']' 가 있어도 된다
+  const tfe::model::ClassMemberTable table = tfe::model::readClassMembers(
+      {{"code/__torch__/m.py",
+        "class E(Module):\n"
+        "  __parameters__ = [\"weight\",\n"
+        "    # don't [stop] here\n"
+        "    \"bias\", \"a]b\"]\n"
+        "  __buffers__ = [\n"
+        "\n"
+        "    \"running_mean\",\n"
+        "    ]\n"
+        "  weight : Tensor\n"
+        "def helper(x: Tensor) -> Tensor:\n"
+        "  __parameters__ = [\"not_a_member\", ]\n"
+        "  return x\n"}});
+  ASSERT_EQ(table.size(), 1u);
+  const tfe::model::ClassMembers& e = table.at("__torch__.m.E");
+  EXPECT_EQ(e.parameters, (tfe::model::NameSet{"weight", "bias", "a]b"}));
+  EXPECT_EQ(e.buffers, (tfe::model::NameSet{"running_mean"}));
+}
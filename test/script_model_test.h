@@ -0,0 +1,20 @@
+#ifndef SCRIPT_MODEL_TEST_H_
+#define SCRIPT_MODEL_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "model/script_model.h"
+#include "pkl_writer.h"
+#include "zip_writer.h"
+
+class ScriptModelTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override;
+  void TearDown() override;
+};
+
+#endif  // SCRIPT_MODEL_TEST_H_
@@ -0,0 +1,409 @@
+#include "tensor_test.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "error/error.h"
+#include "parser/parser_torch.h"
+#include "tensor/layout.h"
+#include "util/load_stats.h"
+#include "vm/vm_pkl.h"
+
+namespace {
+
+std::string floatBytes(const std::vector<float>& values) {
+  std::string bytes(values.size() * sizeof(float), '\0');
+  std::memcpy(&bytes[0], values.data(), bytes.size());
+  return bytes;
+}
+
+}  // namespace
+
+/**
+ * @brief Net { conv: Conv { weight: data/0[0:6] (2x3), bias: data/0[6:8] }, scale: data/1 }
+ *        conv.weight 와 conv.bias 는 같은 storage 를 offset 만 달리해서 본다.
+ */
+void TensorTest::SetUp() {
+  path_ = ::testing::TempDir() + "tfe_tensor_test.pt";
+
+  PickleWriter pkl;
+  pkl.proto();
+  pkl.beginModule("__torch__", "Net", 0);
+  pkl.str("conv");
+  pkl.beginModule("__torch__", "Conv", 1);
+  pkl.str("weight").tensor("0", {2, 3}, "FloatStorage", 0, true, 8);
+  pkl.str("bias").tensor("0", {2}, "FloatStorage", 6, false, 8);
+  pkl.endModule();
+  pkl.str("scale").tensor("1", {4}, "LongStorage");
+  pkl.str("training").boolean(false);
+  pkl.endModule();
+  pkl.stop();
+
+  std::vector<int64_t> scale = {1, 2, 3, 4};
+
+  ZipWriter writer;
+  writer.add("net/version", "3\n");
+  writer.add("net/byteorder", "little");
+  writer.add("net/data.pkl", pkl.bytes());
+  writer.add("net/data/0", floatBytes({0, 1, 2, 3, 4, 5, 6, 7}));
+  writer.add("net/data/1", std::string(reinterpret_cast<const char*>(scale.data()),
+                                       scale.size() * sizeof(int64_t)));
+  writer.save(path_);
+}
+
+void TensorTest::TearDown() { std::remove(path_.c_str()); }
+
+TEST_F(TensorTest, CollectNamesTensorsByPath) {
+  tfe::parser::TorchParser parser;
+  parser.read(path_);
+  tfe::vm::PickleVM vm(parser.getDataView());
+  tfe::vm::Value root = vm.load();
+
+  tfe::tensor::TensorLoader loader(parser);
+  auto tensors = loader.collect(root);
+  ASSERT_EQ(tensors.size(), 3u);
+  EXPECT_EQ(tensors[0].first, "conv.weight");
+  EXPECT_EQ(tensors[1].first, "conv.bias");
+  EXPECT_EQ(tensors[2].first, "scale");
+
+  const tfe::tensor::Tensor& weight = tensors[0].second;
+  EXPECT_EQ(weight.dtype(), tfe::tensor::DType::FLOAT32);
+  EXPECT_EQ(weight.sizes(), (std::vector<int64_t>{2, 3}));
+  EXPECT_EQ(weight.strides(), (std::vector<int64_t>{3, 1}));
+  EXPECT_TRUE(weight.isContiguous());
+  EXPECT_TRUE(weight.requiresGrad());
+  EXPECT_EQ(weight.data<float>()[5], 5.0f);
+
+  const tfe::tensor::Tensor& scale = tensors[2].second;
+  EXPECT_EQ(scale.dtype(), tfe::tensor::DType::INT64);
+  EXPECT_EQ(scale.data<int64_t>()[3], 4);
+}
+
+TEST_F(TensorTest, SharedStorageIsAliased) {
+  tfe::parser::TorchParser parser;
+  parser.read(path_);
+  tfe::vm::PickleVM vm(parser.getDataView());
+
+  tfe::tensor::TensorLoader loader(parser);
+  auto tensors = loader.collect(vm.load());
+  const tfe::tensor::Tensor& weight = tensors[0].second;
+  const tfe::tensor::Tensor& bias   = tensors[1].second;
+
+  EXPECT_EQ(loader.storages().size(), 2u);
+  EXPECT_TRUE(weight.sharesStorage(bias));
+  EXPECT_EQ(bias.data<float>(), weight.data<float>() + 6);
+  EXPECT_EQ(bias.data<float>()[1], 7.0f);
+
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(weight.storage()->data()) %
+                tfe::tensor::AlignedBuffer::kAlignment,
+            0u);
+}
+
+TEST_F(TensorTest, StorageLargerThanRecordThrows) {
+  tfe::parser::TorchParser parser;
+  parser.read(path_);
+
+  PickleWriter pkl;
+  pkl.proto().tensor("1", {64}, "FloatStorage").stop();
+  tfe::vm::PickleVM vm(pkl.bytes());
+
+  tfe::tensor::TensorLoader loader(parser);
+  EXPECT_THROW(loader.tensor(vm.load()), tfe::error::ParserException);
+}
+
+/**
+ * @brief STORED/DEFLATED 가 섞이고 kSplitBytes 보다 큰 storage 가 있는 아카이브를 여러 worker 로 읽는다
+ */
+TEST_F(TensorTest, ParallelLoadMatchesSerial) {
+  const std::string path = ::testing::TempDir() + "tfe_tensor_parallel_test.pt";
+  const int64_t kLarge   = tfe::tensor::TensorLoader::kSplitBytes / sizeof(float) * 2 + 3;
+
+  PickleWriter pkl;
+  pkl.proto();
+  pkl.beginModule("__torch__", "Net", 0);
+  ZipWriter writer;
+  for (int i = 0; i < 16; ++i) {
+    int64_t numel = i == 0 ? kLarge : 1000 + i;
+    std::vector<float> values(numel);
+    for (int64_t j = 0; j < numel; ++j) {
+      values[j] = static_cast<float>(i * 7 + j % 1013);
+    }
+    pkl.str("p" + std::to_string(i)).tensor(std::to_string(i), {numel});
+    // 큰 레코드는 정렬을 어긋나게 둬서 매핑 대신 나눠 복사하는 경로를 탄다
+    writer.add("net/data/" + std::to_string(i), floatBytes(values), i % 2 == 1, i != 0);
+  }
+  pkl.endModule();
+  pkl.stop();
+  writer.add("net/version", "3\n");
+  writer.add("net/byteorder", "little");
+  writer.add("net/data.pkl", pkl.bytes());
+  writer.save(path);
+
+  tfe::parser::TorchParser parser;
+  parser.read(path);
+  tfe::vm::PickleVM vm(parser.getDataView());
+  tfe::vm::Value root = vm.load();
+
+  tfe::tensor::TensorLoader serial(parser, 1);
+  tfe::tensor::TensorLoader parallel(parser, 4);
+  auto expected = serial.collect(root);
+  auto actual   = parallel.collect(root);
+  EXPECT_EQ(parallel.pending(), 16u);
+  parallel.load();
+  EXPECT_EQ(parallel.pending(), 0u);
+
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual[i].first, expected[i].first);
+    const tfe::tensor::Tensor& a = actual[i].second;
+    const tfe::tensor::Tensor& e = expected[i].second;
+    ASSERT_EQ(a.numel(), e.numel());
+    EXPECT_EQ(std::memcmp(a.data(), e.data(), a.numel() * sizeof(float)), 0) << actual[i].first;
+  }
+  EXPECT_EQ(actual[0].second.data<float>()[kLarge - 1], static_cast<float>((kLarge - 1) % 1013));
+
+  std::remove(path.c_str());
+}
+
+TEST_F(TensorTest, LoadStatsCoverEachPhase) {
+  using tfe::util::LoadCounter;
+  using tfe::util::LoadPhase;
+  const std::string path = ::testing::TempDir() + "tfe_tensor_stats_test.pt";
+
+  // data/0 은 STORED, data/1 은 DEFLATED
+  PickleWriter pkl;
+  pkl.proto();
+  pkl.beginModule("__torch__", "Net", 0);
+  pkl.str("a").tensor("0", {256});
+  pkl.str("b").tensor("1", {1024});
+  pkl.endModule();
+  pkl.stop();
+  ZipWriter writer;
+  writer.add("net/version", "3\n");
+  writer.add("net/byteorder", "little");
+  writer.add("net/data.pkl", pkl.bytes());
+  writer.add("net/data/0", floatBytes(std::vector<float>(256, 1.0f)));
+  writer.add("net/data/1", floatBytes(std::vector<float>(1024, 2.0f)), true);
+  writer.save(path);
+
+  auto loadAll = [&](tfe::parser::TorchParser* parser) {
+    parser->read(path);
+    auto vm             = std::make_unique<tfe::vm::PickleVM>(parser->getDataView());
+    tfe::vm::Value root = vm->load();
+    tfe::tensor::TensorLoader loader(*parser, 1);
+    loader.collect(root);
+    loader.load();
+    return vm;
+  };
+
+  // 꺼져 있으면 (기본값) 아무것도 남지 않는다
+  tfe::util::LoadStats& stats = tfe::util::LoadStats::global();
+  stats.reset();
+  {
+    tfe::parser::TorchParser parser;
+    loadAll(&parser);
+  }
+  for (size_t i = 0; i < static_cast<size_t>(LoadPhase::kCount); ++i) {
+    EXPECT_EQ(stats.phase(static_cast<LoadPhase>(i)).count, 0u) << i;
+  }
+  EXPECT_TRUE(stats.spans().empty());
+
+  stats.setEnabled(true);
+  tfe::parser::TorchParser parser;
+  std::unique_ptr<tfe::vm::PickleVM> vm = loadAll(&parser);
+  stats.setEnabled(false);
+
+  for (LoadPhase phase : {LoadPhase::OPEN, LoadPhase::STAT, LoadPhase::MMAP,
+                          LoadPhase::CENTRAL_DIRECTORY, LoadPhase::SECTIONS, LoadPhase::INFLATE,
+                          LoadPhase::UNPICKLE, LoadPhase::MATERIALIZE}) {
+    EXPECT_EQ(stats.phase(phase).count, 1u) << tfe::util::loadPhaseToString(phase);
+  }
+  EXPECT_EQ(stats.phase(LoadPhase::MMAP).bytes_in, parser.getArchive().size());
+  EXPECT_GT(stats.phase(LoadPhase::CENTRAL_DIRECTORY).bytes_in, 0u);
+  EXPECT_EQ(stats.counter(LoadCounter::ZIP_ENTRIES), 5u);
+
+  const tfe::parser::ZipEntry& deflated = parser.getRecordEntry("data/1");
+  const tfe::util::PhaseStats inflate   = stats.phase(LoadPhase::INFLATE);
+  EXPECT_EQ(inflate.bytes_in, deflated.compressed_size);
+  EXPECT_EQ(inflate.bytes_out, 1024u * sizeof(float));
+  EXPECT_LT(inflate.bytes_in, inflate.bytes_out);
+
+  EXPECT_EQ(stats.phase(LoadPhase::UNPICKLE).bytes_in, parser.getDataView().size());
+  EXPECT_GT(vm->opcodeCount(), 0u);
+  EXPECT_EQ(stats.counter(LoadCounter::PICKLE_OPCODES), vm->opcodeCount());
+  EXPECT_EQ(stats.counter(LoadCounter::PICKLE_MEMO), vm->memoSize());
+  EXPECT_EQ(stats.phase(LoadPhase::MATERIALIZE).bytes_out, (256u + 1024u) * sizeof(float));
+  EXPECT_EQ(stats.counter(LoadCounter::STORAGES), 2u);
+
+  // span 은 시작 순이고 inflate 는 엔트리 이름을 단다
+  const std::vector<tfe::util::LoadSpan> spans = stats.spans();
+  ASSERT_EQ(spans.size(), 8u);
+  EXPECT_EQ(spans.front().phase, LoadPhase::OPEN);
+  for (size_t i = 1; i < spans.size(); ++i) {
+    EXPECT_LE(spans[i - 1].begin, spans[i].begin);
+  }
+  bool named = false;
+  for (const tfe::util::LoadSpan& span : spans) {
+    named = named || (span.phase == LoadPhase::INFLATE && span.detail == "net/data/1");
+  }
+  EXPECT_TRUE(named);
+  EXPECT_NE(stats.report().find("inflate"), std::string::npos);
+
+  stats.reset();
+  std::remove(path.c_str());
+}
+
+TEST_F(TensorTest, StorageIsReadOnFirstTouch) {
+  tfe::parser::TorchParser parser;
+  parser.read(path_);
+  tfe::vm::PickleVM vm(parser.getDataView());
+
+  tfe::tensor::TensorLoader loader(parser);
+  auto tensors = loader.collect(vm.load());
+  EXPECT_EQ(loader.pending(), 2u);
+
+  const tfe::tensor::Storage& storage = *tensors[0].second.storage();
+  const tfe::parser::ZipEntry& entry  = parser.getRecordEntry("data/0");
+  EXPECT_FALSE(storage.loaded());
+  EXPECT_EQ(storage.archiveOffset(), entry.data_offset);
+  EXPECT_EQ(storage.archiveSize(), entry.compressed_size);
+
+  // 여러 스레드가 동시에 처음 건드려도 한 번만 읽고 같은 포인터를 본다
+  std::vector<const float*> seen(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < seen.size(); ++i) {
+    threads.emplace_back([&, i] { seen[i] = tensors[1].second.data<float>(); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (const float* p : seen) {
+    EXPECT_EQ(p, seen[0]);
+  }
+  EXPECT_TRUE(storage.loaded());
+  EXPECT_EQ(seen[0][1], 7.0f);
+  EXPECT_FALSE(tensors[2].second.storage()->loaded());
+  EXPECT_EQ(loader.pending(), 1u);
+}
+
+TEST_F(TensorTest, AlignedStoredRecordUsesMapping) {
+  const std::string path = ::testing::TempDir() + "tfe_tensor_mapping_test.pt";
+  PickleWriter pkl;
+  pkl.proto();
+  pkl.beginModule("__torch__", "Net", 0);
+  pkl.str("mapped").tensor("0", {4});
+  pkl.str("shifted").tensor("1", {4});
+  pkl.str("deflated").tensor("2", {4});
+  pkl.endModule();
+  pkl.stop();
+  ZipWriter writer;
+  writer.add("net/version", "3\n");
+  writer.add("net/byteorder", "little");
+  writer.add("net/data.pkl", pkl.bytes());
+  writer.add("net/data/0", floatBytes({1, 2, 3, 4}));
+  writer.add("net/data/1", floatBytes({5, 6, 7, 8}), false, false);
+  writer.add("net/data/2", floatBytes({9, 10, 11, 12}), true);
+  writer.save(path);
+
+  auto parser = std::make_unique<tfe::parser::TorchParser>();
+  parser->read(path);
+  const char* base = parser->getArchive().base();
+  const uint64_t mapped_offset = parser->getRecordEntry("data/0").data_offset;
+  tfe::tensor::TensorLoader::NamedTensors tensors;
+  {
+    tfe::vm::PickleVM vm(parser->getDataView());
+    tfe::tensor::TensorLoader loader(*parser, 2);
+    tensors = loader.collect(vm.load());
+    EXPECT_EQ(loader.prefetch(""), 3u);
+  }
+  ASSERT_EQ(tensors.size(), 3u);
+  EXPECT_TRUE(tensors[0].second.storage()->mapsSource());
+  EXPECT_FALSE(tensors[1].second.storage()->mapsSource());
+  EXPECT_FALSE(tensors[2].second.storage()->mapsSource());
+  EXPECT_EQ(tensors[0].second.data(), base + mapped_offset);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(tensors[1].second.data()) % 64, 0u);
+
+  // Storage 가 아카이브를 붙잡고 있으므로 파서가 먼저 사라져도 된다
+  parser.reset();
+  EXPECT_EQ(tensors[0].second.data<float>()[3], 4.0f);
+  EXPECT_EQ(tensors[1].second.data<float>()[0], 5.0f);
+  EXPECT_EQ(tensors[2].second.data<float>()[2], 11.0f);
+
+  // 매핑은 읽기 전용이다. 쓰는 Storage 만 자기 버퍼로 복사되고 매핑과 파일은 그대로다
+  EXPECT_FALSE(tensors[0].second.storage()->ownsData());
+  EXPECT_TRUE(tensors[1].second.storage()->ownsData());
+  const float* mapped = tensors[0].second.data<float>();
+  tensors[0].second.mutableData<float>()[0] = 42.0f;
+  EXPECT_TRUE(tensors[0].second.storage()->ownsData());
+  EXPECT_NE(tensors[0].second.data<float>(), mapped);
+  EXPECT_EQ(tensors[0].second.data<float>()[0], 42.0f);
+  EXPECT_EQ(tensors[0].second.data<float>()[3], 4.0f);
+  EXPECT_EQ(mapped[0], 1.0f);
+  const void* owned = tensors[1].second.data();
+  EXPECT_EQ(tensors[1].second.mutableData(), owned);
+  tfe::parser::TorchParser reopened;
+  reopened.read(path);
+  EXPECT_EQ(reopened.getRecord("data/0").view(), floatBytes({1, 2, 3, 4}));
+
+  tensors.clear();
+  std::remove(path.c_str());
+}
+
+TEST_F(TensorTest, PrefetchLoadsOnlySubtree) {
+  tfe::parser::TorchParser parser;
+  parser.read(path_);
+  tfe::vm::PickleVM vm(parser.getDataView());
+
+  tfe::tensor::TensorLoader loader(parser);
+  auto tensors = loader.collect(vm.load());
+
+  EXPECT_EQ(loader.prefetch("con"), 0u);
+  EXPECT_EQ(loader.prefetch("conv"), 1u);
+  EXPECT_TRUE(tensors[0].second.storage()->loaded());
+  EXPECT_FALSE(tensors[2].second.storage()->loaded());
+  EXPECT_EQ(loader.prefetch("conv.bias"), 0u);
+  EXPECT_EQ(loader.prefetch(""), 1u);
+  EXPECT_EQ(loader.pending(), 0u);
+}
+
+TEST_F(TensorTest, LayoutReorderRoundTrips) {
+  using tfe::tensor::Layout;
+  // 20 채널은 8 / 16 의 배수가 아니므로 마지막 묶음에 0 lane 이 생긴다
+  const std::vector<int64_t> sizes = {2, 20, 3, 5};
+  tfe::tensor::Tensor nchw         = tfe::tensor::empty(sizes);
+  float* src                       = nchw.data<float>();
+  for (int64_t i = 0; i < nchw.numel(); ++i) {
+    src[i] = static_cast<float>(i + 1);
+  }
+
+  tfe::tensor::Tensor nhwc = tfe::tensor::toLayout(nchw, Layout::NHWC);
+  EXPECT_EQ(nhwc.sizes(), (std::vector<int64_t>{2, 3, 5, 20}));
+  EXPECT_EQ(nhwc.data<float>()[((1 * 3 + 2) * 5 + 4) * 20 + 7],
+            src[((1 * 20 + 7) * 3 + 2) * 5 + 4]);
+
+  tfe::tensor::Tensor c8 = tfe::tensor::toLayout(nchw, Layout::NCHW8C);
+  EXPECT_EQ(c8.sizes(), (std::vector<int64_t>{2, 3, 3, 5, 8}));
+  // (n 1, c 18, y 2, x 4) 는 묶음 2 의 lane 2
+  EXPECT_EQ(c8.data<float>()[(((1 * 3 + 2) * 3 + 2) * 5 + 4) * 8 + 2],
+            src[((1 * 20 + 18) * 3 + 2) * 5 + 4]);
+  EXPECT_EQ(c8.data<float>()[(((1 * 3 + 2) * 3 + 2) * 5 + 4) * 8 + 4], 0.0f);
+
+  // 어느 layout 을 거쳐도 NCHW 로 돌아오면 같다
+  const Layout layouts[] = {Layout::NHWC, Layout::NCHW8C, Layout::NCHW16C};
+  for (Layout from : layouts) {
+    for (Layout to : layouts) {
+      std::vector<float> a(tfe::tensor::physicalNumel(sizes, from));
+      std::vector<float> b(tfe::tensor::physicalNumel(sizes, to));
+      std::vector<float> back(nchw.numel());
+      tfe::tensor::reorder(src, Layout::NCHW, a.data(), from, sizes);
+      tfe::tensor::reorder(a.data(), from, b.data(), to, sizes);
+      tfe::tensor::reorder(b.data(), to, back.data(), Layout::NCHW, sizes);
+      EXPECT_EQ(std::memcmp(back.data(), src, back.size() * sizeof(float)), 0)
+          << tfe::tensor::layoutToString(from) << " -> " << tfe::tensor::layoutToString(to);
+    }
+  }
+}
@@ -0,0 +1,20 @@
+#ifndef TENSOR_TEST_H_
+#define TENSOR_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "tensor/tensor_loader.h"
+#include "pkl_writer.h"
+#include "zip_writer.h"
+
+class TensorTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override;
+  void TearDown() override;
+};
+
+#endif  // TENSOR_TEST_H_
@@ -0,0 +1,288 @@
+#include "tflite_parser_test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include "engine/engine.h"
+#include "engine/lowering.h"
+#include "error/error.h"
+
+namespace {
+
+using tfe::parser::TFLiteParser;
+
+std::vector<float> values(size_t n, float salt, float scale = 0.5f) {
+  std::vector<float> out(n);
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = std::sin(static_cast<float>(i) * 0.7f + salt) * scale;
+  }
+  return out;
+}
+
+/**
+ * @brief writeNet() 의 그래프를 NHWC 그대로 naive 하게 돌린다
+ */
+std::vector<float> reference(const std::vector<float>& x) {
+  const std::vector<float> w1 = values(4 * 3 * 3 * 3, 1.0f), b1 = values(4, 2.0f);
+  const std::vector<float> w2 = values(2 * 2 * 4, 3.0f), b2 = values(4, 4.0f);
+  const std::vector<float> shift = values(8, 5.0f);
+  const std::vector<float> fw = values(2 * 8, 6.0f), fb = values(2, 7.0f);
+
+  // conv 3x3 stride 2, SAME 은 아래 / 오른쪽으로만 한 칸 채운다
+  std::vector<float> c1(3 * 3 * 4);
+  for (int oh = 0; oh < 3; ++oh) {
+    for (int ow = 0; ow < 3; ++ow) {
+      for (int o = 0; o < 4; ++o) {
+        float acc = b1[o];
+        for (int kh = 0; kh < 3; ++kh) {
+          for (int kw = 0; kw < 3; ++kw) {
+            const int ih = oh * 2 + kh, iw = ow * 2 + kw;
+            if (ih >= 6 || iw >= 6) {
+              continue;
+            }
+            for (int c = 0; c < 3; ++c) {
+              acc += x[(ih * 6 + iw) * 3 + c] * w1[((o * 3 + kh) * 3 + kw) * 3 + c];
+            }
+          }
+        }
+        c1[(oh * 3 + ow) * 4 + o] = std::max(acc, 0.0f);
+      }
+    }
+  }
+  std::vector<float> cat(2 * 2 * 8);
+  for (int oh = 0; oh < 2; ++oh) {
+    for (int ow = 0; ow < 2; ++ow) {
+      for (int c = 0; c < 4; ++c) {
+        float acc  = b2[c];
+        float peak = -std::numeric_limits<float>::infinity();
+        for (int kh = 0; kh < 2; ++kh) {
+          for (int kw = 0; kw < 2; ++kw) {
+            acc += c1[((oh + kh) * 3 + ow + kw) * 4 + c] * w2[(kh * 2 + kw) * 4 + c];
+            const int ph = oh * 2 + kh, pw = ow * 2 + kw;
+            if (ph < 3 && pw < 3) {
+              peak = std::max(peak, c1[(ph * 3 + pw) * 4 + c]);
+            }
+          }
+        }
+        cat[(oh * 2 + ow) * 8 + c]     = acc + shift[c];
+        cat[(oh * 2 + ow) * 8 + 4 + c] = peak + shift[4 + c];
+      }
+    }
+  }
+  std::vector<float> mean(8, 0.0f);
+  for (int i = 0; i < 4; ++i) {
+    for (int c = 0; c < 8; ++c) {
+      mean[c] += cat[i * 8 + c] / 4.0f;
+    }
+  }
+  std::vector<float> y(2);
+  for (int o = 0; o < 2; ++o) {
+    y[o] = fb[o];
+    for (int k = 0; k < 8; ++k) {
+      y[o] += fw[o * 8 + k] * mean[k];
+    }
+  }
+  return y;
+}
+
+TFLiteWriter::Node convOptions(int8_t padding, int32_t stride, int8_t activation) {
+  TFLiteWriter::Node options = FlatNode::table();
+  options->add<int8_t>(0, padding).add<int32_t>(1, stride).add<int32_t>(2, stride);
+  options->add<int8_t>(3, activation);
+  return options;
+}
+
+bool inside(const void* p, const char* base, size_t size) {
+  const char* c = static_cast<const char*>(p);
+  return c >= base && c < base + size;
+}
+
+}  // namespace
+
+void TFLiteParserTest::SetUp() {
+  path_ = ::testing::TempDir() + "tfe_tflite_parser_test.tflite";
+  TFLiteWriter writer;
+  writeNet(writer);
+  writer.save(path_);
+}
+
+void TFLiteParserTest::TearDown() { std::remove(path_.c_str()); }
+
+void TFLiteParserTest::writeNet(TFLiteWriter& writer, int8_t conv_activation) {
+  using namespace tfe::parser;
+  const int32_t x      = writer.tensor("x", {1, 6, 6, 3});
+  const int32_t conv_w = writer.floats("conv.weight", {4, 3, 3, 3}, values(4 * 3 * 3 * 3, 1.0f));
+  const int32_t conv_b = writer.floats("conv.bias", {4}, values(4, 2.0f));
+  const int32_t conv   = writer.tensor("conv", {1, 3, 3, 4});
+  writer.op(kTFLiteConv2d, {x, conv_w, conv_b}, {conv}, convOptions(0, 2, conv_activation));
+
+  TFLiteWriter::Node dw_options = convOptions(1, 1, 0);
+  dw_options->add<int32_t>(3, 1).add<int8_t>(4, 0);
+  const int32_t dw_w = writer.floats("dw.weight", {1, 2, 2, 4}, values(2 * 2 * 4, 3.0f));
+  const int32_t dw_b = writer.floats("dw.bias", {4}, values(4, 4.0f));
+  const int32_t dw   = writer.tensor("dw", {1, 2, 2, 4});
+  writer.op(kTFLiteDepthwiseConv2d, {conv, dw_w, dw_b}, {dw}, dw_options);
+
+  TFLiteWriter::Node pool_options = FlatNode::table();
+  pool_options->add<int8_t>(0, 0).add<int32_t>(1, 2).add<int32_t>(2, 2);
+  pool_options->add<int32_t>(3, 2).add<int32_t>(4, 2);
+  const int32_t pool = writer.tensor("pool", {1, 2, 2, 4});
+  writer.op(kTFLiteMaxPool2d, {conv}, {pool}, pool_options);
+
+  TFLiteWriter::Node cat_options = FlatNode::table();
+  cat_options->add<int32_t>(0, 3);
+  const int32_t cat = writer.tensor("cat", {1, 2, 2, 8});
+  writer.op(kTFLiteConcatenation, {dw, pool}, {cat}, cat_options);
+
+  const int32_t shift = writer.floats("shift", {8}, values(8, 5.0f));
+  const int32_t added = writer.tensor("added", {1, 2, 2, 8});
+  writer.op(kTFLiteAdd, {cat, shift}, {added});
+
+  const int32_t axes = writer.ints("axes", {1, 2});
+  const int32_t mean = writer.tensor("mean", {1, 8});
+  writer.op(kTFLiteMean, {added, axes}, {mean});
+
+  const int32_t fc_w = writer.floats("fc.weight", {2, 8}, values(2 * 8, 6.0f));
+  const int32_t fc_b = writer.floats("fc.bias", {2}, values(2, 7.0f));
+  const int32_t y    = writer.tensor("y", {1, 2});
+  writer.op(kTFLiteFullyConnected, {mean, fc_w, fc_b}, {y});
+  writer.io({x}, {y});
+}
+
+TEST_F(TFLiteParserTest, ReadsTablesInPlace) {
+  TFLiteParser parser;
+  parser.read(path_);
+  EXPECT_EQ(parser.getVersion(), "3");
+  EXPECT_EQ(parser.getByteOrder(), "little");
+  EXPECT_EQ(parser.getData(), "tfe test");
+  ASSERT_EQ(parser.subgraphs().size(), 1u);
+
+  const tfe::parser::TFLiteSubgraph& main = parser.subgraphs()[0];
+  EXPECT_EQ(main.name, "main");
+  ASSERT_EQ(main.operators.size(), 7u);
+  ASSERT_EQ(main.inputs.size(), 1u);
+  EXPECT_EQ(main.tensors[main.inputs[0]].name, "x");
+  EXPECT_TRUE(inside(main.tensors[0].name.data(), parser.base(), parser.size()));
+
+  const tfe::parser::TFLiteOperator& conv = main.operators[0];
+  EXPECT_EQ(conv.builtin, tfe::parser::kTFLiteConv2d);
+  ASSERT_EQ(conv.inputs.size(), 3u);
+  EXPECT_EQ(conv.options.scalar<int32_t>(2, 1), 2);
+  EXPECT_EQ(main.operators[5].builtin, tfe::parser::kTFLiteMean);
+
+  // weight 는 매핑 안 16 byte 경계의 view 다
+  const tfe::parser::TFLiteTensor& weight = main.tensors[conv.inputs[1]];
+  EXPECT_EQ(weight.name, "conv.weight");
+  ASSERT_EQ(weight.shape.size(), 4u);
+  EXPECT_EQ(weight.shape[3], 3);
+  const std::string_view bytes = parser.buffer(weight.buffer);
+  ASSERT_EQ(bytes.size(), 4u * 3 * 3 * 3 * sizeof(float));
+  EXPECT_TRUE(inside(bytes.data(), parser.base(), parser.size()));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(bytes.data()) % 16, 0u);
+  const std::vector<float> expected = values(4 * 3 * 3 * 3, 1.0f);
+  EXPECT_EQ(std::memcmp(bytes.data(), expected.data(), bytes.size()), 0);
+  EXPECT_TRUE(parser.buffer(main.tensors[main.inputs[0]].buffer).empty());
+}
+
+TEST_F(TFLiteParserTest, LowersToEngineGraph) {
+  tfe::engine::Graph graph;
+  const char* base = nullptr;
+  size_t size      = 0;
+  {
+    TFLiteParser parser;
+    parser.read(path_);
+    base  = parser.base();
+    size  = parser.size();
+    graph = tfe::engine::lower(parser);
+  }
+  // parser 가 없어도 상수가 매핑을 쥐고 있다
+  ASSERT_EQ(graph.inputs.size(), 1u);
+  EXPECT_EQ(graph.slots[graph.inputs[0]].sizes, (std::vector<int64_t>{1, 3, 6, 6}));
+  int pads = 0;
+  for (const tfe::engine::Op& op : graph.ops) {
+    pads += op.kind == tfe::engine::OpKind::PAD;
+  }
+  EXPECT_EQ(pads, 2);  // 앞뒤가 다른 SAME padding (conv, max pool)
+  for (const tfe::engine::Slot& slot : graph.slots) {
+    if (slot.name == "fc.weight" || slot.name == "dw.bias") {
+      EXPECT_TRUE(inside(slot.tensor.data(), base, size)) << slot.name;
+    }
+    if (slot.name == "conv.weight") {
+      EXPECT_EQ(slot.sizes, (std::vector<int64_t>{4, 3, 3, 3}));
+      EXPECT_FALSE(inside(slot.tensor.data(), base, size));  // OHWI -> OIHW 로 옮겼다
+    }
+    if (slot.name == "shift") {
+      EXPECT_EQ(slot.sizes, (std::vector<int64_t>{1, 8, 1, 1}));
+    }
+  }
+
+  const std::vector<float> x = values(6 * 6 * 3, 0.3f, 1.0f);
+  tfe::tensor::Tensor input  = tfe::tensor::empty({1, 3, 6, 6});
+  float* data                = input.data<float>();
+  for (int h = 0; h < 6; ++h) {
+    for (int w = 0; w < 6; ++w) {
+      for (int c = 0; c < 3; ++c) {
+        data[(c * 6 + h) * 6 + w] = x[(h * 6 + w) * 3 + c];
+      }
+    }
+  }
+  tfe::engine::Engine engine(std::move(graph));
+  const std::vector<tfe::tensor::Tensor>& outputs = engine.run({input});
+  ASSERT_EQ(outputs.size(), 1u);
+  ASSERT_EQ(outputs[0].sizes(), (std::vector<int64_t>{1, 2}));
+  const std::vector<float> want = reference(x);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_NEAR(outputs[0].data<float>()[i], want[i], 1e-4f);
+  }
+}
+
+TEST_F(TFLiteParserTest, RejectsMalformedFiles) {
+  std::ifstream in(path_, std::ios::binary);
+  const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  auto expectThrows = [&](const std::string& content) {
+    {
+      std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+      out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+    TFLiteParser parser;
+    EXPECT_THROW(parser.read(path_), tfe::error::ParserException);
+  };
+
+  expectThrows(bytes.substr(0, bytes.size() / 3));
+  std::string identifier = bytes;
+  identifier[4]          = 'X';
+  expectThrows(identifier);
+  std::string root = bytes;
+  root[3]          = '\x7f';
+  expectThrows(root);
+
+  TFLiteParser parser;
+  EXPECT_THROW(parser.read(path_ + ".missing"), tfe::error::ParserException);
+}
+
+TEST_F(TFLiteParserTest, UnsupportedModelsAreReported) {
+  {
+    TFLiteWriter writer;
+    writeNet(writer, 3);  // RELU6
+    writer.save(path_);
+    TFLiteParser parser;
+    parser.read(path_);
+    EXPECT_THROW(tfe::engine::lower(parser), tfe::engine::LoweringError);
+  }
+  {
+    TFLiteWriter writer;
+    const int32_t x = writer.tensor("x", {1, 4}, 9);  // INT8
+    const int32_t y = writer.tensor("y", {1, 4}, 9);
+    writer.op(tfe::parser::kTFLiteRelu, {x}, {y});
+    writer.io({x}, {y});
+    writer.save(path_);
+    TFLiteParser parser;
+    parser.read(path_);
+    EXPECT_EQ(parser.subgraphs()[0].tensors[0].type, tfe::parser::TFLiteType::INT8);
+    EXPECT_THROW(tfe::engine::lower(parser), tfe::engine::LoweringError);
+  }
+}
@@ -0,0 +1,25 @@
+#ifndef TFLITE_PARSER_TEST_H_
+#define TFLITE_PARSER_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "parser/parser_tflite.h"
+#include "tflite_writer.h"
+
+class TFLiteParserTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override;
+  void TearDown() override;
+
+  /**
+   * @brief x[1,6,6,3] -> conv 3x3/2 SAME + relu -> { depthwise 2x2 VALID, max pool 2x2/2 SAME }
+   *        -> concat -> (+ 채널 상수) -> mean(H, W) -> fully connected [2, 8]
+   */
+  static void writeNet(TFLiteWriter& writer, int8_t conv_activation = 1);
+};
+
+#endif  // TFLITE_PARSER_TEST_H_
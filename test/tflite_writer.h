@@ -0,0 +1,244 @@
+#ifndef TFLITE_WRITER_TEST_H_
+#define TFLITE_WRITER_TEST_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 테스트용 최소 flatbuffer 노드. table / 스칼라 벡터 / table 벡터 / 문자열
+ */
+struct FlatNode {
+  enum class Kind { TABLE, VECTOR, TABLES, STRING };
+
+  struct Field {
+    uint16_t id;
+    std::string scalar;  // 비어 있으면 child 를 가리키는 uoffset
+    std::shared_ptr<FlatNode> child;
+  };
+
+  Kind kind = Kind::TABLE;
+  std::vector<Field> fields;
+  std::string bytes;  // VECTOR / STRING 의 원소 바이트
+  size_t element = 1;
+  size_t align   = 4;
+  std::vector<std::shared_ptr<FlatNode>> items;
+
+  template <typename T>
+  FlatNode& add(uint16_t id, T value) {
+    fields.push_back({id, std::string(reinterpret_cast<const char*>(&value), sizeof(T)), nullptr});
+    return *this;
+  }
+  FlatNode& add(uint16_t id, std::shared_ptr<FlatNode> node) {
+    fields.push_back({id, std::string(), std::move(node)});
+    return *this;
+  }
+
+  static std::shared_ptr<FlatNode> table() { return std::make_shared<FlatNode>(); }
+  static std::shared_ptr<FlatNode> string(const std::string& s) {
+    auto node   = std::make_shared<FlatNode>();
+    node->kind  = Kind::STRING;
+    node->bytes = s;
+    return node;
+  }
+  template <typename T>
+  static std::shared_ptr<FlatNode> vector(const std::vector<T>& values, size_t align = 4) {
+    auto node     = std::make_shared<FlatNode>();
+    node->kind    = Kind::VECTOR;
+    node->element = sizeof(T);
+    node->align   = align;
+    node->bytes.assign(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    return node;
+  }
+  static std::shared_ptr<FlatNode> tables(std::vector<std::shared_ptr<FlatNode>> items) {
+    auto node   = std::make_shared<FlatNode>();
+    node->kind  = Kind::TABLES;
+    node->items = std::move(items);
+    return node;
+  }
+};
+
+/**
+ * @brief 테스트용 최소 .tflite writer
+ *
+ * flatcc / flatbuffers 처럼 뒤에서 앞으로 쌓지 않고 부모를 먼저 쓰고 자식을 뒤에 붙인 뒤 uoffset 을
+ * 채운다 (uoffset 은 항상 앞을 가리키므로 읽는 쪽에는 차이가 없다). weight buffer 는 16 byte 에 맞춘다.
+ */
+class TFLiteWriter {
+ public:
+  using Node = std::shared_ptr<FlatNode>;
+
+  TFLiteWriter() { buffers_.push_back(FlatNode::table()); }
+
+  /**
+   * @brief data 가 있으면 buffer 를 하나 붙인다. type 은 schema 의 TensorType
+   */
+  int32_t tensor(const std::string& name, const std::vector<int32_t>& shape, int8_t type = 0,
+                 const std::string& data = std::string()) {
+    uint32_t buffer = 0;
+    if (!data.empty()) {
+      Node node = FlatNode::table();
+      node->add(0, FlatNode::vector(std::vector<uint8_t>(data.begin(), data.end()), 16));
+      buffer = static_cast<uint32_t>(buffers_.size());
+      buffers_.push_back(node);
+    }
+    Node t = FlatNode::table();
+    t->add(0, FlatNode::vector(shape)).add<int8_t>(1, type).add<uint32_t>(2, buffer);
+    t->add(3, FlatNode::string(name));
+    tensors_.push_back(t);
+    return static_cast<int32_t>(tensors_.size() - 1);
+  }
+  int32_t floats(const std::string& name, const std::vector<int32_t>& shape,
+                 const std::vector<float>& values) {
+    return tensor(name, shape, 0,
+                  std::string(reinterpret_cast<const char*>(values.data()), values.size() * 4));
+  }
+  int32_t ints(const std::string& name, const std::vector<int32_t>& values) {
+    return tensor(name, {static_cast<int32_t>(values.size())}, 2,
+                  std::string(reinterpret_cast<const char*>(values.data()), values.size() * 4));
+  }
+
+  void op(int32_t builtin, const std::vector<int32_t>& inputs, const std::vector<int32_t>& outputs,
+          Node options = nullptr) {
+    uint32_t index = 0;
+    while (index < codes_.size() && codes_[index] != builtin) {
+      ++index;
+    }
+    if (index == codes_.size()) {
+      codes_.push_back(builtin);
+    }
+    Node o = FlatNode::table();
+    o->add<uint32_t>(0, index).add(1, FlatNode::vector(inputs)).add(2, FlatNode::vector(outputs));
+    if (options) {
+      o->add<uint8_t>(3, 1).add(4, options);
+    }
+    operators_.push_back(o);
+  }
+
+  void io(const std::vector<int32_t>& inputs, const std::vector<int32_t>& outputs) {
+    inputs_  = inputs;
+    outputs_ = outputs;
+  }
+
+  std::string finish() {
+    std::vector<Node> codes;
+    for (int32_t code : codes_) {
+      Node c = FlatNode::table();
+      c->add<int8_t>(0, static_cast<int8_t>(code < 127 ? code : 127)).add<int32_t>(3, code);
+      codes.push_back(c);
+    }
+    Node subgraph = FlatNode::table();
+    subgraph->add(0, FlatNode::tables(tensors_))
+        .add(1, FlatNode::vector(inputs_))
+        .add(2, FlatNode::vector(outputs_))
+        .add(3, FlatNode::tables(operators_))
+        .add(4, FlatNode::string("main"));
+    Node model = FlatNode::table();
+    model->add<uint32_t>(0, 3)
+        .add(1, FlatNode::tables(codes))
+        .add(2, FlatNode::tables({subgraph}))
+        .add(3, FlatNode::string("tfe test"))
+        .add(4, FlatNode::tables(buffers_));
+
+    out_.assign(8, '\0');
+    std::memcpy(&out_[4], "TFL3", 4);
+    const uint32_t root = write(*model);
+    std::memcpy(&out_[0], &root, 4);
+    return out_;
+  }
+
+  void save(const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    const std::string bytes = finish();
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  }
+
+ private:
+  void pad(size_t align, size_t extra = 0) {
+    while ((out_.size() + extra) % align != 0) {
+      out_.push_back('\0');
+    }
+  }
+
+  void patch(size_t at, uint32_t target) {
+    const uint32_t relative = target - static_cast<uint32_t>(at);
+    std::memcpy(&out_[at], &relative, 4);
+  }
+
+  /**
+   * @return 노드 위치 (table 은 soffset 자리, 벡터 / 문자열은 길이 자리)
+   */
+  uint32_t write(const FlatNode& node) {
+    if (node.kind == FlatNode::Kind::VECTOR || node.kind == FlatNode::Kind::STRING) {
+      pad(node.align, 4);
+      const uint32_t at    = static_cast<uint32_t>(out_.size());
+      const uint32_t count = static_cast<uint32_t>(node.bytes.size() / node.element);
+      out_.append(reinterpret_cast<const char*>(&count), 4);
+      out_ += node.bytes;
+      if (node.kind == FlatNode::Kind::STRING) {
+        out_.push_back('\0');
+      }
+      return at;
+    }
+    if (node.kind == FlatNode::Kind::TABLES) {
+      pad(4);
+      const uint32_t at    = static_cast<uint32_t>(out_.size());
+      const uint32_t count = static_cast<uint32_t>(node.items.size());
+      out_.append(reinterpret_cast<const char*>(&count), 4);
+      out_.append(4 * count, '\0');
+      for (uint32_t i = 0; i < count; ++i) {
+        patch(at + 4 + 4 * i, write(*node.items[i]));
+      }
+      return at;
+    }
+
+    // vtable, 그 뒤에 table (soffset, 필드). 필드는 크기에 맞춰 정렬한다
+    uint16_t max_id = 0;
+    for (const FlatNode::Field& field : node.fields) {
+      max_id = std::max<uint16_t>(max_id, field.id + 1);
+    }
+    pad(2);
+    const size_t vtable = out_.size();
+    out_.append(4 + 2 * max_id, '\0');
+    pad(8);
+    const size_t table    = out_.size();
+    const int32_t soffset = static_cast<int32_t>(table - vtable);
+    out_.append(reinterpret_cast<const char*>(&soffset), 4);
+    std::vector<std::pair<size_t, const FlatNode*>> children;
+    for (const FlatNode::Field& field : node.fields) {
+      const size_t bytes = field.scalar.empty() ? 4 : field.scalar.size();
+      pad(bytes);
+      const uint16_t relative = static_cast<uint16_t>(out_.size() - table);
+      std::memcpy(&out_[vtable + 4 + 2 * field.id], &relative, 2);
+      if (field.scalar.empty()) {
+        children.push_back({out_.size(), field.child.get()});
+        out_.append(4, '\0');
+      } else {
+        out_ += field.scalar;
+      }
+    }
+    const uint16_t vtable_size = static_cast<uint16_t>(4 + 2 * max_id);
+    const uint16_t table_size  = static_cast<uint16_t>(out_.size() - table);
+    std::memcpy(&out_[vtable], &vtable_size, 2);
+    std::memcpy(&out_[vtable + 2], &table_size, 2);
+    for (const auto& child : children) {
+      patch(child.first, write(*child.second));
+    }
+    return static_cast<uint32_t>(table);
+  }
+
+  std::string out_;
+  std::vector<Node> buffers_;
+  std::vector<Node> tensors_;
+  std::vector<Node> operators_;
+  std::vector<int32_t> codes_;
+  std::vector<int32_t> inputs_;
+  std::vector<int32_t> outputs_;
+};
+
+#endif  // TFLITE_WRITER_TEST_H_
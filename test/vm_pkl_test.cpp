@@ -2,7 +2,9 @@
 
 #include <iostream>
 #include <fstream>
+#include "error/error.h"
 #include "parser/parser_torch.h"
+#include "pkl_writer.h"
 #include "vm/op_pkl.h"
 #include "vm/vm_pkl.h"
 
@@ -42,4 +44,255 @@ TEST_F(VmPickleTest, ParseOpCodesTest) {
 
   EXPECT_FALSE(opcodes.empty());
   EXPECT_EQ(opcodes.back(), "STOP");
-}
\ No newline at end of file
+}
+
+TEST_F(VmPickleTest, LoadModuleTreeTest) {
+  PickleWriter w;
+  w.proto(2);
+  w.beginModule("__torch__", "EncoderWrapper", 0);
+  w.str("training").put(1).boolean(true);
+  w.str("conv1").beginModule("__torch__.torch.nn.modules.conv", "Conv2d");
+  w.get(1).boolean(false);
+  w.str("weight").tensor("0", {4, 3, 3, 3});
+  w.str("stride").intTuple({2, 2});
+  w.str("eps").real(1e-5);
+  w.endModule();
+  w.endModule();
+  w.stop();
+
+  std::vector<char> data = w.data();
+  tfe::vm::PickleVM pkl_vm(data);
+  tfe::vm::Value root;
+  ASSERT_NO_THROW({ root = pkl_vm.load(); });
+
+  ASSERT_TRUE(root.isObject());
+  const tfe::vm::Object& wrapper = root.toObject();
+  EXPECT_TRUE(wrapper.cls.toGlobal().is("__torch__", "EncoderWrapper"));
+  EXPECT_TRUE(wrapper.state.toDict().find("training")->toBool());
+
+  const tfe::vm::Object& conv = wrapper.state.toDict().find("conv1")->toObject();
+  EXPECT_FALSE(conv.state.toDict().find("training")->toBool());
+  EXPECT_DOUBLE_EQ(conv.state.toDict().find("eps")->toDouble(), 1e-5);
+  EXPECT_EQ(conv.state.toDict().find("stride")->toTuple()[1].toInt(), 2);
+
+  const tfe::vm::Object& weight = conv.state.toDict().find("weight")->toObject();
+  EXPECT_TRUE(weight.cls.toGlobal().is("torch._utils", "_rebuild_tensor_v2"));
+  const tfe::vm::Sequence& args = weight.args.toTuple();
+  ASSERT_EQ(args.size, 6u);
+  const tfe::vm::Sequence& pid = args[0].toPersistentId().id.toTuple();
+  EXPECT_EQ(pid[0].toStringView(), "storage");
+  EXPECT_TRUE(pid[1].toGlobal().is("torch", "FloatStorage"));
+  EXPECT_EQ(pid[2].toStringView(), "0");
+  EXPECT_EQ(pid[4].toInt(), 108);
+  EXPECT_EQ(args[2].toTuple().size, 4u);
+  EXPECT_TRUE(args[5].isDict());
+
+  EXPECT_EQ(pkl_vm.memoSize(), 2u);
+  EXPECT_GT(pkl_vm.arena().bytesReserved(), 0u);
+}
+
+TEST_F(VmPickleTest, LoadMemoAliasesContainersTest) {
+  PickleWriter w;
+  w.proto(2).op(tfe::vm::OpCode::EMPTY_LIST).put(0);
+  w.mark().integer(-5).integer(70000).integer(int64_t(1) << 40).op(tfe::vm::OpCode::APPENDS);
+  w.get(0).op(tfe::vm::OpCode::TUPLE2).stop();
+
+  std::vector<char> data = w.data();
+  tfe::vm::PickleVM pkl_vm(data);
+  tfe::vm::Value root = pkl_vm.load();
+
+  const tfe::vm::Sequence& pair = root.toTuple();
+  ASSERT_EQ(pair.size, 2u);
+  EXPECT_EQ(&pair[0].toList(), &pair[1].toList());
+  EXPECT_EQ(pair[0].toList()[0].toInt(), -5);
+  EXPECT_EQ(pair[0].toList()[1].toInt(), 70000);
+  EXPECT_EQ(pair[0].toList()[2].toInt(), int64_t(1) << 40);
+}
+
+TEST_F(VmPickleTest, LoadRejectsTruncatedPickleTest) {
+  PickleWriter w;
+  w.proto(2).mark().integer(1);
+
+  std::vector<char> data = w.data();
+  tfe::vm::PickleVM pkl_vm(data);
+  EXPECT_THROW(pkl_vm.load(), std::runtime_error);
+}
+
+TEST_F(VmPickleTest, LoadRepeatedDictKeyKeepsLastValueTest) {
+  using tfe::vm::OpCode;
+  // DICT, SETITEM, SETITEMS 모두 Python 처럼 나중 값으로 덮어쓴다
+  PickleWriter w;
+  w.proto(2).mark();
+  w.mark().str("a").integer(1).str("a").integer(2).op(OpCode::DICT);
+  w.op(OpCode::EMPTY_DICT).str("b").integer(3).op(OpCode::SETITEM);
+  w.str("b").integer(4).op(OpCode::SETITEM);
+  w.op(OpCode::EMPTY_DICT).mark().str("c").integer(5).str("d").integer(6).str("c").integer(7);
+  w.op(OpCode::SETITEMS).op(OpCode::TUPLE).stop();
+  std::vector<char> data = w.data();
+
+  using Dispatch = tfe::vm::PickleVM::Dispatch;
+  for (Dispatch dispatch : {Dispatch::SWITCH, Dispatch::TABLE, Dispatch::COMPUTED_GOTO}) {
+    tfe::vm::PickleVM pkl_vm(data);
+    const tfe::vm::Sequence& dicts = pkl_vm.load(dispatch).toTuple();
+    ASSERT_EQ(dicts.size, 3u);
+    EXPECT_EQ(dicts[0].toDict().size, 1u);
+    EXPECT_EQ(dicts[0].toDict().find("a")->toInt(), 2);
+    EXPECT_EQ(dicts[1].toDict().size, 1u);
+    EXPECT_EQ(dicts[1].toDict().find("b")->toInt(), 4);
+    EXPECT_EQ(dicts[2].toDict().size, 2u);
+    EXPECT_EQ(dicts[2].toDict().find("c")->toInt(), 7);
+    EXPECT_EQ(dicts[2].toDict().find("d")->toInt(), 6);
+  }
+}
+
+TEST_F(VmPickleTest, LoadRejectsOddDictTest) {
+  PickleWriter w;
+  w.proto(2).mark().str("a").integer(1).str("b").op(tfe::vm::OpCode::DICT).stop();
+
+  std::vector<char> data = w.data();
+  tfe::vm::PickleVM pkl_vm(data);
+  try {
+    pkl_vm.load();
+    FAIL() << "odd DICT was accepted";
+  } catch (const tfe::error::ParserException& e) {
+    EXPECT_EQ(e.error_code(), tfe::error::PARSE_ERROR);
+  }
+}
+
+TEST_F(VmPickleTest, LoadRejectsForgedMemoIndexTest) {
+  // 몇 바이트짜리 입력이 memo 를 수십억 칸으로 키우지 못해야 한다
+  PickleWriter w;
+  w.proto(2).op(tfe::vm::OpCode::EMPTY_LIST).put(0xFFFFFFF0u).stop();
+
+  std::vector<char> data = w.data();
+  tfe::vm::PickleVM pkl_vm(data);
+  EXPECT_THROW(pkl_vm.load(), tfe::error::ParserException);
+  EXPECT_LT(pkl_vm.memoSize(), 16u);
+}
+
+TEST_F(VmPickleTest, ArenaMoveLeavesSourceEmptyTest) {
+  tfe::vm::Arena source(256);
+  source.copy("first block");
+  tfe::vm::Arena moved(std::move(source));
+  EXPECT_EQ(moved.blockCount(), 1u);
+  EXPECT_EQ(source.blockCount(), 0u);
+  EXPECT_EQ(source.bytesReserved(), 0u);
+
+  // 옮겨진 쪽은 옛 블록에 쓰지 않고 새 블록을 받는다
+  std::string_view fresh = source.copy("second");
+  EXPECT_EQ(fresh, "second");
+  EXPECT_EQ(source.blockCount(), 1u);
+  EXPECT_EQ(moved.blockCount(), 1u);
+
+  tfe::vm::Arena assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.blockCount(), 1u);
+  EXPECT_EQ(moved.blockCount(), 0u);
+}
+
+TEST_F(VmPickleTest, LoadDispatchModesAgreeTest) {
+  PickleWriter w;
+  w.proto(2).beginModule("__torch__", "M", 0);
+  w.str("training").put(1).boolean(true);
+  w.str("weight").tensor("3", {8, 2});
+  w.endModule().stop();
+  std::vector<char> data = w.data();
+
+  using Dispatch = tfe::vm::PickleVM::Dispatch;
+  for (Dispatch dispatch : {Dispatch::SWITCH, Dispatch::TABLE, Dispatch::COMPUTED_GOTO}) {
+    tfe::vm::PickleVM pkl_vm(data);
+    tfe::vm::Value root = pkl_vm.load(dispatch);
+    const tfe::vm::Dict& state = root.toObject().state.toDict();
+    EXPECT_TRUE(state.find("training")->toBool());
+    EXPECT_EQ(state.find("weight")->toObject().args.toTuple()[2].toTuple()[0].toInt(), 8);
+  }
+
+  std::vector<char> bad = {static_cast<char>(0x80), 2, static_cast<char>(0xFF)};
+  tfe::vm::PickleVM bad_vm(bad);
+  EXPECT_THROW(bad_vm.load(), std::runtime_error);
+}
+
+TEST_F(VmPickleTest, LoadFramedPickleTest) {
+  PickleWriter w;
+  w.proto(2).beginModule("__torch__", "M", 0);
+  w.str("training").put(1).boolean(false);
+  for (int i = 0; i < 64; ++i) {
+    w.str("w" + std::to_string(i)).tensor(std::to_string(i), {i + 1, 3});
+  }
+  w.str("eps").real(0.25);
+  w.endModule().stop();
+
+  std::string framed = w.framedBytes(256);
+  tfe::vm::PickleVM pkl_vm{std::string_view(framed)};
+  tfe::vm::Value root = pkl_vm.load();
+
+  const tfe::vm::Dict& state = root.toObject().state.toDict();
+  EXPECT_EQ(state.size, 66u);
+  EXPECT_DOUBLE_EQ(state.find("eps")->toDouble(), 0.25);
+  EXPECT_EQ(state.find("w63")->toObject().args.toTuple()[2].toTuple()[0].toInt(), 64);
+
+  std::string truncated = framed.substr(0, framed.size() - 40);
+  tfe::vm::PickleVM truncated_vm{std::string_view(truncated)};
+  EXPECT_THROW(truncated_vm.load(), std::runtime_error);
+}
+
+namespace {
+
+class CountingVisitor : public tfe::vm::PickleVisitor {
+ public:
+  void onGlobal(const tfe::vm::Global& /*global*/) override { ++globals; }
+  void onPersistentId(const tfe::vm::Value& pid) override {
+    keys.emplace_back(pid.toTuple()[2].toStringView());
+  }
+  void onDictEntry(const tfe::vm::Value& /*dict*/, const tfe::vm::Value& /*key*/,
+                   const tfe::vm::Value& /*value*/) override {
+    ++dict_entries;
+  }
+  void onStop(const tfe::vm::Value& /*root*/) override { stopped = true; }
+
+  int globals       = 0;
+  int dict_entries  = 0;
+  bool stopped      = false;
+  std::vector<std::string> keys;
+};
+
+}  // namespace
+
+TEST_F(VmPickleTest, StreamChunksTest) {
+  PickleWriter w;
+  w.proto(2).beginModule("__torch__", "M", 0);
+  w.str("training").put(1).boolean(true);
+  for (int i = 0; i < 8; ++i) {
+    w.str("w" + std::to_string(i)).tensor(std::to_string(i), {4, 4});
+  }
+  w.endModule().stop();
+
+  for (const std::string& bytes : {w.bytes(), w.framedBytes(64)}) {
+    for (size_t chunk : {size_t(1), size_t(7), bytes.size()}) {
+      CountingVisitor visitor;
+      tfe::vm::PickleVM pkl_vm(&visitor);
+      for (size_t offset = 0; offset < bytes.size(); offset += chunk) {
+        pkl_vm.feed(bytes.data() + offset, std::min(chunk, bytes.size() - offset));
+        EXPECT_LT(pkl_vm.bufferedBytes(), chunk + 128);
+      }
+      tfe::vm::Value root = pkl_vm.finish();
+
+      EXPECT_TRUE(visitor.stopped);
+      EXPECT_EQ(visitor.dict_entries, 9);
+      ASSERT_EQ(visitor.keys.size(), 8u);
+      EXPECT_EQ(visitor.keys[7], "7");
+      EXPECT_EQ(root.toObject().state.toDict().size, 9u);
+      EXPECT_TRUE(root.toObject().state.toDict().find("training")->toBool());
+    }
+  }
+}
+
+TEST_F(VmPickleTest, StreamWithoutStopThrowsTest) {
+  PickleWriter w;
+  w.proto(2).op(tfe::vm::OpCode::EMPTY_LIST);
+
+  tfe::vm::PickleVM pkl_vm(nullptr);
+  pkl_vm.feed(w.bytes().data(), w.bytes().size());
+  EXPECT_FALSE(pkl_vm.done());
+  EXPECT_THROW(pkl_vm.finish(), std::runtime_error);
+}
@@ -0,0 +1,103 @@
+#include "work_stealing_pool_test.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+std::vector<int> WorkStealingPoolTest::coverage(tfe::util::WorkStealingPool& pool, int64_t n,
+                                                int64_t grain) {
+  std::vector<std::atomic<int>> hits(n);
+  std::vector<std::atomic<int>> busy(pool.concurrency());
+  pool.parallelFor(0, n, grain, [&](int64_t lo, int64_t hi, size_t worker) {
+    // 같은 worker 번호로 동시에 도는 구간은 없다
+    EXPECT_LT(worker, pool.concurrency());
+    EXPECT_EQ(busy[worker].fetch_add(1), 0);
+    for (int64_t i = lo; i < hi; ++i) {
+      hits[i].fetch_add(1);
+    }
+    busy[worker].fetch_sub(1);
+  });
+  std::vector<int> counts;
+  for (std::atomic<int>& hit : hits) {
+    counts.push_back(hit.load());
+  }
+  return counts;
+}
+
+TEST_F(WorkStealingPoolTest, CoversEveryIndexOnce) {
+  tfe::util::WorkStealingPool pool(4, false);
+  EXPECT_EQ(pool.concurrency(), 4u);
+  for (int64_t grain : {1, 3, 64}) {
+    // 덩어리 수가 worker 보다 적은 경우, 많아서 훔쳐 가는 경우
+    for (int64_t n : {1, 2, 5, 1000}) {
+      EXPECT_EQ(coverage(pool, n, grain), std::vector<int>(n, 1)) << n << " / " << grain;
+    }
+  }
+  // 연달아 부르면 spin 중인 worker 가 바로 받는다
+  for (int round = 0; round < 200; ++round) {
+    ASSERT_EQ(coverage(pool, 37, 1), std::vector<int>(37, 1));
+  }
+}
+
+TEST_F(WorkStealingPoolTest, RunsInlineWhenNested) {
+  tfe::util::WorkStealingPool pool(3, false);
+  std::atomic<int> total{0};
+  pool.parallelFor(0, 6, 1, [&](int64_t, int64_t, size_t outer) {
+    // 중첩 호출은 바깥 worker 번호로 한 번에 돈다
+    pool.parallelFor(0, 10, 1, [&](int64_t lo, int64_t hi, size_t inner) {
+      EXPECT_EQ(inner, outer);
+      EXPECT_EQ(hi - lo, 10);
+      total += static_cast<int>(hi - lo);
+    });
+  });
+  EXPECT_EQ(total.load(), 60);
+
+}
+
+TEST_F(WorkStealingPoolTest, ConcurrentCallersNeverShareWorker) {
+  // 모델 둘이 한 pool 을 같이 쓴다. 두 호출에 걸쳐서도 같은 worker 번호로 동시에 도는 구간은 없다
+  tfe::util::WorkStealingPool pool(3, false);
+  std::vector<std::atomic<int>> busy(pool.concurrency());
+  auto run = [&](int64_t n, int64_t grain) {
+    std::vector<std::atomic<int>> hits(n);
+    pool.parallelFor(0, n, grain, [&](int64_t lo, int64_t hi, size_t worker) {
+      EXPECT_LT(worker, pool.concurrency());
+      EXPECT_EQ(busy[worker].fetch_add(1), 0);
+      for (int64_t i = lo; i < hi; ++i) {
+        hits[i].fetch_add(1);
+      }
+      busy[worker].fetch_sub(1);
+    });
+    for (std::atomic<int>& hit : hits) {
+      EXPECT_EQ(hit.load(), 1);
+    }
+  };
+  std::thread other([&] {
+    for (int round = 0; round < 50; ++round) {
+      run(5000, 7);
+      run(3, 8);  // 덩어리 하나라 호출 스레드 혼자 도는 경우
+    }
+  });
+  for (int round = 0; round < 50; ++round) {
+    run(5000, 7);
+    run(3, 8);
+  }
+  other.join();
+}
+
+TEST_F(WorkStealingPoolTest, RethrowsFirstError) {
+  tfe::util::WorkStealingPool pool(2, false, std::chrono::microseconds(0));
+  std::atomic<int> done{0};
+  EXPECT_THROW(pool.parallelFor(0, 8, 1,
+                                [&](int64_t lo, int64_t, size_t) {
+                                  if (lo == 5) {
+                                    throw std::runtime_error("chunk 5");
+                                  }
+                                  ++done;
+                                }),
+               std::runtime_error);
+  EXPECT_EQ(done.load(), 7);
+  // 잠든 worker 도 다음 호출에 깨어난다
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(coverage(pool, 100, 1), std::vector<int>(100, 1));
+}
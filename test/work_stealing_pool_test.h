@@ -0,0 +1,19 @@
+#ifndef WORK_STEALING_POOL_TEST_H_
+#define WORK_STEALING_POOL_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "util/work_stealing_pool.h"
+
+class WorkStealingPoolTest : public ::testing::Test {
+ protected:
+  /**
+   * @brief pool 에서 [0, n) 을 grain 으로 돌려 index 마다 몇 번 불렸는지 센다
+   */
+  static std::vector<int> coverage(tfe::util::WorkStealingPool& pool, int64_t n, int64_t grain);
+};
+
+#endif  // WORK_STEALING_POOL_TEST_H_
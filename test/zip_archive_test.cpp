@@ -0,0 +1,143 @@
+#include "zip_archive_test.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <type_traits>
+
+#include "error/error.h"
+#include "parser/parser_torch.h"
+
+void ZipArchiveTest::SetUp() {
+  path_ = ::testing::TempDir() + "tfe_zip_archive_test.pt";
+
+  ZipWriter writer;
+  writer.add("model/version", "3\n");
+  writer.add("model/byteorder", "little");
+  writer.add("model/data.pkl", std::string("\x80\x02K\x07.", 5));
+  writer.add("model/data/0", std::string(4096, 'a'));
+  writer.add("model/code/model.py", std::string(2000, 'x') + "def forward(self):\n", true);
+  writer.save(path_);
+}
+
+void ZipArchiveTest::TearDown() { std::remove(path_.c_str()); }
+
+TEST_F(ZipArchiveTest, StoredEntryIsMappedView) {
+  tfe::parser::ZipArchive archive(path_);
+  ASSERT_EQ(archive.entries().size(), 5u);
+
+  const tfe::parser::ZipEntry* entry = archive.find("model/data/0");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_TRUE(entry->isStored());
+  EXPECT_EQ(entry->data_offset % 64, 0u);
+
+  tfe::parser::ZipRecord record = archive.read(*entry);
+  EXPECT_TRUE(record.isMapped());
+  EXPECT_EQ(record.data(), archive.base() + entry->data_offset);
+  EXPECT_EQ(record.view(), std::string(4096, 'a'));
+}
+
+TEST_F(ZipArchiveTest, DeflatedEntryIsInflated) {
+  tfe::parser::ZipArchive archive(path_);
+
+  const tfe::parser::ZipEntry* entry = archive.find("model/code/model.py");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->method, tfe::parser::ZipEntry::kDeflated);
+  EXPECT_LT(entry->compressed_size, entry->uncompressed_size);
+
+  tfe::parser::ZipRecord record = archive.read(*entry);
+  EXPECT_FALSE(record.isMapped());
+  EXPECT_EQ(record.view(), std::string(2000, 'x') + "def forward(self):\n");
+  EXPECT_THROW(archive.view(*entry), tfe::error::ParserException);
+}
+
+TEST_F(ZipArchiveTest, MissingEntryThrows) {
+  tfe::parser::ZipArchive archive(path_);
+  EXPECT_EQ(archive.find("model/missing"), nullptr);
+  EXPECT_THROW(archive.read("model/missing"), tfe::error::ParserException);
+}
+
+TEST_F(ZipArchiveTest, TorchParserReadsFromMapping) {
+  tfe::parser::TorchParser parser;
+  ASSERT_NO_THROW({ parser.read(path_); });
+
+  EXPECT_EQ(parser.getModelName(), "model");
+  EXPECT_EQ(parser.getVersion(), "3");
+  EXPECT_EQ(parser.getByteOrder(), "little");
+  EXPECT_EQ(parser.getDataView().size(), 5u);
+  EXPECT_EQ(parser.getRecord("data/0").size(), 4096u);
+}
+
+TEST_F(ZipArchiveTest, StreamMatchesRead) {
+  tfe::parser::ZipArchive archive(path_);
+
+  for (const char* name : {"model/data/0", "model/code/model.py"}) {
+    const tfe::parser::ZipEntry* entry = archive.find(name);
+    ASSERT_NE(entry, nullptr);
+
+    std::string streamed;
+    size_t chunks = 0;
+    archive.stream(
+        *entry,
+        [&](const char* data, size_t size) {
+          EXPECT_LE(size, 100u);
+          streamed.append(data, size);
+          ++chunks;
+        },
+        100);
+
+    EXPECT_EQ(streamed, archive.read(*entry).view());
+    EXPECT_GT(chunks, 1u);
+  }
+}
+
+TEST_F(ZipArchiveTest, StreamRejectsZeroChunk) {
+  tfe::parser::ZipArchive archive(path_);
+  for (const char* name : {"model/data/0", "model/code/model.py"}) {
+    EXPECT_THROW(archive.stream(*archive.find(name), [](const char*, size_t) {}, 0),
+                 tfe::error::ParserException);
+  }
+}
+
+TEST_F(ZipArchiveTest, MovedRecordKeepsOwnedBytes) {
+  tfe::parser::ZipArchive archive(path_);
+  const std::string expected = std::string(2000, 'x') + "def forward(self):\n";
+
+  tfe::parser::ZipRecord moved;
+  {
+    tfe::parser::ZipRecord record = archive.read("model/code/model.py");
+    moved                         = std::move(record);
+    EXPECT_TRUE(record.empty());
+  }
+  EXPECT_EQ(moved.view(), expected);
+  static_assert(!std::is_copy_constructible<tfe::parser::ZipRecord>::value,
+                "ZipRecord view 가 소유 버퍼를 가리키므로 복사하면 안 된다");
+}
+
+TEST_F(ZipArchiveTest, IndexFindsEveryEntry) {
+  const std::string path = ::testing::TempDir() + "tfe_zip_index_test.pt";
+  const int kEntries     = 5000;
+
+  ZipWriter writer;
+  writer.add("big/version", "3\n");
+  writer.add("big/byteorder", "little");
+  writer.add("big/data.pkl", std::string("\x80\x02K\x07.", 5));
+  for (int i = 0; i < kEntries; ++i) {
+    writer.add("big/data/" + std::to_string(i), std::to_string(i));
+  }
+  writer.save(path);
+
+  tfe::parser::TorchParser parser;
+  parser.read(path);
+  ASSERT_EQ(parser.getEntries().size(), static_cast<size_t>(kEntries + 3));
+
+  for (int i = 0; i < kEntries; ++i) {
+    const tfe::parser::ZipEntry* entry = parser.findRecord("data/" + std::to_string(i));
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->name, "big/data/" + std::to_string(i));
+    EXPECT_EQ(parser.getArchive().view(*entry), std::to_string(i));
+  }
+  EXPECT_EQ(parser.findRecord("data/" + std::to_string(kEntries)), nullptr);
+  EXPECT_THROW(parser.getRecordEntry("data/missing"), tfe::error::ParserException);
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,19 @@
+#ifndef ZIP_ARCHIVE_TEST_H_
+#define ZIP_ARCHIVE_TEST_H_
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "parser/zip_archive.h"
+#include "zip_writer.h"
+
+class ZipArchiveTest : public ::testing::Test {
+ protected:
+  std::string path_;
+
+  void SetUp() override;
+  void TearDown() override;
+};
+
+#endif  // ZIP_ARCHIVE_TEST_H_
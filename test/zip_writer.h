@@ -0,0 +1,140 @@
+#ifndef ZIP_WRITER_TEST_H_
+#define ZIP_WRITER_TEST_H_
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 테스트용 최소 ZIP writer
+ *
+ * PyTorch (miniz) 처럼 local extra field 를 패딩으로 써서 payload 를 64 byte 경계에 맞춘다.
+ * align 을 끄면 STORED payload 를 일부러 64 byte 경계에서 어긋나게 둔다.
+ */
+class ZipWriter {
+ public:
+  void add(const std::string& name, const std::string& bytes, bool deflate = false,
+           bool align = true) {
+    Entry entry;
+    entry.name              = name;
+    entry.offset            = out_.size();
+    entry.crc               = crc32(0L, reinterpret_cast<const Bytef*>(bytes.data()), bytes.size());
+    entry.uncompressed_size = bytes.size();
+    entry.method            = deflate ? 8 : 0;
+
+    std::string payload = deflate ? deflateRaw(bytes) : bytes;
+    entry.compressed_size = payload.size();
+
+    size_t header_end = entry.offset + 30 + name.size();
+    size_t padding    = 0;
+    if (!deflate) {
+      size_t aligned = (header_end + 4 + 63) & ~size_t(63);
+      padding        = align ? aligned - header_end : aligned + 8 - header_end;
+    }
+
+    put32(0x04034b50);
+    put16(20);
+    put16(0);
+    put16(entry.method);
+    put16(0);
+    put16(0);
+    put32(entry.crc);
+    put32(static_cast<uint32_t>(entry.compressed_size));
+    put32(static_cast<uint32_t>(entry.uncompressed_size));
+    put16(static_cast<uint16_t>(name.size()));
+    put16(static_cast<uint16_t>(padding));
+    out_ += name;
+    if (padding) {
+      put16(0x4246);  // "FB"
+      put16(static_cast<uint16_t>(padding - 4));
+      out_.append(padding - 4, 'Z');
+    }
+    out_ += payload;
+
+    entries_.push_back(entry);
+  }
+
+  std::string finish() {
+    size_t cd_offset = out_.size();
+    for (const auto& entry : entries_) {
+      put32(0x02014b50);
+      put16(20);
+      put16(20);
+      put16(0);
+      put16(entry.method);
+      put16(0);
+      put16(0);
+      put32(entry.crc);
+      put32(static_cast<uint32_t>(entry.compressed_size));
+      put32(static_cast<uint32_t>(entry.uncompressed_size));
+      put16(static_cast<uint16_t>(entry.name.size()));
+      put16(0);
+      put16(0);
+      put16(0);
+      put16(0);
+      put32(0);
+      put32(static_cast<uint32_t>(entry.offset));
+      out_ += entry.name;
+    }
+    size_t cd_size = out_.size() - cd_offset;
+
+    put32(0x06054b50);
+    put16(0);
+    put16(0);
+    put16(static_cast<uint16_t>(entries_.size()));
+    put16(static_cast<uint16_t>(entries_.size()));
+    put32(static_cast<uint32_t>(cd_size));
+    put32(static_cast<uint32_t>(cd_offset));
+    put16(0);
+    return out_;
+  }
+
+  void save(const std::string& path) {
+    std::string bytes = finish();
+    std::ofstream out(path, std::ios::binary);
+    out.write(bytes.data(), bytes.size());
+  }
+
+ private:
+  struct Entry {
+    std::string name;
+    size_t offset;
+    uint32_t crc;
+    size_t compressed_size;
+    size_t uncompressed_size;
+    uint16_t method;
+  };
+
+  static std::string deflateRaw(const std::string& bytes) {
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&stream, bytes.size()), '\0');
+    stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(bytes.data()));
+    stream.avail_in  = static_cast<uInt>(bytes.size());
+    stream.next_out  = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+  }
+
+  void put16(uint16_t v) {
+    out_ += static_cast<char>(v & 0xFF);
+    out_ += static_cast<char>(v >> 8);
+  }
+  void put32(uint32_t v) {
+    put16(static_cast<uint16_t>(v & 0xFFFF));
+    put16(static_cast<uint16_t>(v >> 16));
+  }
+
+  std::string out_;
+  std::vector<Entry> entries_;
+};
+
+#endif  // ZIP_WRITER_TEST_H_